@@ -103,6 +103,19 @@ FIRM_API void be_set_after_transform_func(after_transform_func func);
  */
 FIRM_API void be_main(FILE *output, const char *compilation_unit_name);
 
+/**
+ * Enables caching the code generated for each function in @p directory,
+ * which has to exist. NULL disables the cache.
+ *
+ * be_main() looks up every function by the fingerprint of its graph (see
+ * ir_fingerprint_irg()) and emits the cached assembler text instead of
+ * generating code again. Functions whose code refers to entities the backend
+ * creates for the compilation unit, like constant pools, are not cached. The
+ * cache is only used by backends whose code is self-contained per function
+ * and not when debug information or profiling is enabled.
+ */
+FIRM_API void be_set_compile_cache(const char *directory);
+
 /**
  * parse assembler constraint strings and returns flags (so the frontend knows
  * which operands are inputs/outputs and whether memory is required)
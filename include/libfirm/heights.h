@@ -64,6 +64,22 @@ FIRM_API unsigned heights_recompute_block(ir_heights_t *h, ir_node *block);
  */
 FIRM_API ir_heights_t *heights_new(ir_graph *irg);
 
+/**
+ * Weight of a node for heights_new_weighted(), e.g. its latency.
+ */
+typedef unsigned (ir_height_weight_func)(const ir_node *node);
+
+/**
+ * Creates a new heights object, where the height of a node is the maximal sum
+ * of the weights of the nodes on a path from the node (inclusive) to a sink
+ * node in its block. With instruction latencies as weights this is the length
+ * of the critical path.
+ * @param irg    The graph.
+ * @param weight The weight function.
+ */
+FIRM_API ir_heights_t *heights_new_weighted(ir_graph *irg,
+                                            ir_height_weight_func *weight);
+
 /**
  * Frees a heights object.
  * @param h The heights object.
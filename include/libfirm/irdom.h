@@ -192,6 +192,38 @@ FIRM_API void compute_doms(ir_graph *irg);
  */
 FIRM_API void compute_postdoms(ir_graph *irg);
 
+/**
+ * Updates the dominance information after control flow edges have been
+ * changed inside the dominator subtree of @p root.
+ *
+ * All blocks whose predecessors changed, and all blocks that lost or gained
+ * a successor, must have been dominated by @p root before the change (blocks
+ * created since then are fine). Only the dominator subtree of @p root is
+ * recomputed; if the change turns out to reach beyond it the dominance
+ * information of the whole graph is recomputed instead.
+ *
+ * @param root  A block that dominates all changed edges.
+ */
+FIRM_API void dom_update_subtree(ir_node *root);
+
+/**
+ * Updates the dominance information after the control flow edge from
+ * block @p from to block @p to has been inserted.
+ */
+FIRM_API void dom_insert_edge(ir_node *from, ir_node *to);
+
+/**
+ * Updates the dominance information after the control flow edge from
+ * block @p from to block @p to has been deleted.
+ */
+FIRM_API void dom_delete_edge(ir_node *from, ir_node *to);
+
+/**
+ * Enables or disables checking each incremental dominance update against a
+ * full recomputation. A mismatch results in a panic.
+ */
+FIRM_API void dom_set_verify_updates(int enable);
+
 /**
  * Compute the dominance frontiers for a given graph.
  * The information is freed automatically when dominance info is freed.
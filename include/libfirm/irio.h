@@ -52,6 +52,22 @@ FIRM_API int ir_import(const char *filename);
  */
 FIRM_API int ir_import_file(FILE *input, const char *inputname);
 
+/**
+ * Computes a fingerprint of @p irg for caching the code generated for it.
+ *
+ * The fingerprint covers the graph in the order ir_export() writes it,
+ * including all node attributes, the entities and types referenced by the
+ * graph, the target and platform settings, the values of all options and
+ * the libFirm version. It does not depend on node, entity or type numbers,
+ * so structurally equal graphs of different compilations get the same
+ * fingerprint. Initializers of referenced entities and debug information are
+ * not covered.
+ *
+ * @return the fingerprint or 0 if @p irg contains nodes which cannot be
+ *         exported
+ */
+FIRM_API unsigned long long ir_fingerprint_irg(ir_graph *irg);
+
 /** @} */
 
 #include "end.h"
@@ -133,6 +133,35 @@ FIRM_API void set_irg_memory_disambiguator_options(ir_graph *irg,
  */
 FIRM_API void set_irp_memory_disambiguator_options(ir_disambiguator_options options);
 
+/** The algorithm of the whole-program points-to analysis. */
+typedef enum ir_points_to_mode {
+	/** unification based, field insensitive, almost linear time */
+	ir_points_to_steensgaard,
+	/** inclusion based and field sensitive, more precise but slower */
+	ir_points_to_andersen,
+} ir_points_to_mode;
+
+/**
+ * Computes for every address of the program the set of objects it may point
+ * to. The objects are global variables, functions, frame entities,
+ * allocation sites and an unknown object for all memory accessible by code
+ * outside the program.
+ *
+ * While the result exists, get_alias_relation() reports no alias for
+ * addresses with disjoint points-to sets and the callee analysis resolves
+ * indirect calls with it. The result stays valid under transformations
+ * preserving the values of the analysed nodes; new nodes have no points-to
+ * set. Dead node elimination drops the result of a graph.
+ *
+ * @param mode  the algorithm to use
+ */
+FIRM_API void compute_irp_points_to(ir_points_to_mode mode);
+
+/**
+ * Frees the result of compute_irp_points_to().
+ */
+FIRM_API void free_irp_points_to(void);
+
 /**
  * Mark all private methods, i.e. those of which all call sites are known.
  * We use a very conservative estimation yet: If the address of a method is
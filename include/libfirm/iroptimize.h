@@ -10,6 +10,8 @@
 #ifndef FIRM_IROPTIMIZE_H
 #define FIRM_IROPTIMIZE_H
 
+#include <stdio.h>
+
 #include "firm_types.h"
 
 #include "begin.h"
@@ -190,6 +192,26 @@ FIRM_API void combine_memops(ir_graph *irg);
  */
 FIRM_API void opt_ldst(ir_graph *irg);
 
+/**
+ * Removes Stores to local variables whose address is never taken if the
+ * stored bytes are overwritten on every path or never read again before the
+ * function returns. Stores whose bytes are only read after some successors of
+ * their block are sunk into these successors.
+ *
+ * @param irg  the graph
+ */
+FIRM_API void opt_dse(ir_graph *irg);
+
+/**
+ * Replaces comparisons and values decided by value range propagation with
+ * constants. This removes bounds checks of induction variables against the
+ * loop bound and checks for overflow of additions with a constant, if the
+ * ranges show that they cannot fail.
+ *
+ * @param irg  the graph
+ */
+FIRM_API void opt_vrp(ir_graph *irg);
+
 /**
  * Optimize the frame type of an irg by removing
  * never touched entities.
@@ -301,6 +323,30 @@ FIRM_API void remove_phi_cycles(ir_graph *irg);
  */
 FIRM_API void proc_cloning(float threshold);
 
+/**
+ * Performs interprocedural sparse conditional constant propagation.
+ *
+ * Constants are propagated through the arguments of private methods and the
+ * results of all methods, unreachable control flow is removed.  Private
+ * methods which are called with constant arguments are specialized for them
+ * if the estimated benefit is bigger than threshold (see proc_cloning()).
+ *
+ * @param threshold   the threshold for specializing a method
+ */
+FIRM_API void ipsccp(float threshold);
+
+/**
+ * Performs an interprocedural escape analysis and moves objects to the stack
+ * frame.
+ *
+ * Objects allocated by an Alloc node or a call of malloc() with a constant
+ * size are replaced by frame entities, if their address does not escape the
+ * allocating method.  Arguments passed to a method of the program only escape
+ * if the method lets the parameter escape.  Frees of the objects are removed
+ * and the entities are scalar replaced where possible.
+ */
+FIRM_API void escape_analysis(void);
+
 /**
  * Reassociation.
  *
@@ -480,6 +526,24 @@ FIRM_API void garbage_collect_entities(void);
  */
 FIRM_API void dead_node_elimination(ir_graph *irg);
 
+/**
+ * Performs dead node elimination without copying the ir graph.
+ *
+ *  The memory of all nodes, which are not reachable from the End node,
+ *  is reused for new nodes of the graph.  The reachable nodes keep their
+ *  address, attributes and node number, but get dense node indices, so
+ *  any data indexed by node index becomes invalid.  Id nodes are removed.
+ *  Unlike dead_node_elimination() other memory on the graph obstack, like
+ *  outdated in arrays, is not freed.
+ *
+ *  The graph may not be in state phase_building.  The outs data
+ *  structure is freed, the outs state set to outs_none.  Callee
+ *  information is freed.
+ *
+ * @param irg  The graph to be optimized.
+ */
+FIRM_API void dead_node_compaction(ir_graph *irg);
+
 /**
  * Code Placement.
  *
@@ -496,6 +560,23 @@ FIRM_API void dead_node_elimination(ir_graph *irg);
  */
 FIRM_API void place_code(ir_graph *irg);
 
+/**
+ * Loop invariant code motion for memory operations.
+ *
+ * Hoists Loads from loop invariant addresses into the loop preheader if no
+ * memory operation inside the loop may modify the loaded location. A Load
+ * that might trap is only hoisted if it is executed in every iteration before
+ * any other side effect. Stores to loop invariant addresses that are executed
+ * in every iteration are sunk into the single loop exit if no other memory
+ * operation inside the loop may access the stored location.
+ *
+ * Hoisting stops when the estimated register pressure inside a loop exceeds
+ * the number of general purpose registers of the target.
+ *
+ * @param irg  the graph
+ */
+FIRM_API void opt_licm(ir_graph *irg);
+
 /**
  * This optimization finds values where the bits are either constant or irrelevant
  * and exchanges them for a corresponding constant.
@@ -527,6 +608,112 @@ FIRM_API ir_tarval *computed_value_Cmp_Confirm(ir_node *left, ir_node *right,
  */
 FIRM_API ir_entity *create_compilerlib_entity(char const *name, ir_type *mt);
 
+/** An interprocedural step of a parallel pipeline. */
+typedef void (*prog_opt_ptr)(void *data);
+
+/** A pipeline of optimizations applied to all graphs of the program. */
+typedef struct ir_parallel_pipeline ir_parallel_pipeline;
+
+/**
+ * Creates an empty parallel optimization pipeline.
+ */
+FIRM_API ir_parallel_pipeline *new_parallel_pipeline(void);
+
+/**
+ * Frees a parallel optimization pipeline.
+ */
+FIRM_API void free_parallel_pipeline(ir_parallel_pipeline *pipeline);
+
+/**
+ * Appends an optimization working on a single graph to @p pipeline.
+ *
+ * Consecutive graph optimizations form a stage: every graph runs through all
+ * optimizations of a stage before the next stage starts. The graphs of a
+ * stage are distributed over the threads, so an optimization must neither
+ * look at nor modify other graphs, and must not use ircons functions working
+ * on current_ir_graph. The optimizations in this header working on a single
+ * graph may be used, with the exception of those working interprocedurally
+ * like inline_functions(). Creating identifiers, tarvals, modes, types and
+ * entities is allowed. Graph dumping, statistics and timers are not
+ * synchronized and must be disabled.
+ */
+FIRM_API void parallel_pipeline_add_graph_opt(ir_parallel_pipeline *pipeline,
+                                              opt_ptr opt);
+
+/**
+ * Appends an interprocedural optimization to @p pipeline.
+ *
+ * It ends the current stage and runs on the calling thread while no graph
+ * optimization is active, so it may access all graphs and call for example
+ * inline_functions() or garbage_collect_entities().
+ *
+ * @param pipeline  the pipeline
+ * @param opt       the optimization
+ * @param data      passed to @p opt
+ */
+FIRM_API void parallel_pipeline_add_prog_opt(ir_parallel_pipeline *pipeline,
+                                             prog_opt_ptr opt, void *data);
+
+/**
+ * Appends the passes named in @p description to @p pipeline.
+ *
+ * The description is a comma separated list of pass names, for example
+ * "local,combo,gvn_pre,ldst,ifconv,place". Graph passes are
+ * local (optimize_graph_df()), combo, cf (optimize_cf()), gvn_pre, ldst
+ * (optimize_load_store()), dse (opt_dse()), vrp (opt_vrp()), ifconv, place
+ * (place_code()), scalar_replace, jumpthreading, bool, conv, reassoc, licm,
+ * frame (opt_frame_irg()), tailrec, parallelize_mem, loop_inversion,
+ * loop_unrolling, loop_peeling, confirm (construct_confirms()),
+ * remove_confirms, dead_nodes (dead_node_elimination()), compact_nodes
+ * (dead_node_compaction()), unreachable, bads, tuples, critical_edges,
+ * one_return and many_returns. Program passes are funccalls
+ * (optimize_funccalls()), private_methods (mark_private_methods()), escape
+ * (escape_analysis()), ipsccp (ipsccp() with a threshold of 20), gc
+ * (garbage_collect_entities()), points_to and points_to_steensgaard
+ * (compute_irp_points_to() with Andersen's or Steensgaard's algorithm) and
+ * free_points_to (free_irp_points_to()). The passes following points_to use
+ * its result in their alias queries until free_points_to.
+ *
+ * The pipeline knows which graph properties a named pass requires and which
+ * it preserves. It establishes the required ones before the pass runs and
+ * records which of them were still valid (dominance, loops, outs, ...) and
+ * which had to be computed.
+ *
+ * @return non-zero on success, 0 if a name is unknown, in which case the
+ *         pipeline is not changed
+ */
+FIRM_API int parallel_pipeline_add_passes(ir_parallel_pipeline *pipeline,
+                                          char const *description);
+
+/**
+ * Prints for every step of @p pipeline how often it ran, how many of its
+ * required analyses were already valid when it started or had to be
+ * computed, and how many analyses it invalidated. The numbers accumulate
+ * over all runs of the pipeline.
+ *
+ * A valid analysis is not a saving of the pipeline: the passes assure their
+ * analyses themselves and would find it valid as well. The columns show
+ * where analyses are computed and which passes destroy them.
+ *
+ * The recomputations avoided are the calls of assure_irg_properties() and the
+ * other assure functions during a step which found an analysis valid. They
+ * are printed per step in the avoided column and per analysis in a second
+ * table.
+ */
+FIRM_API void parallel_pipeline_print_statistics(
+	ir_parallel_pipeline const *pipeline, FILE *out);
+
+/**
+ * Runs @p pipeline on all graphs of the program using @p n_threads threads.
+ *
+ * Graphs are processed in order of decreasing size. Each thread starts with
+ * the optimization flags (see irflag.h) and the integer overflow mode (see
+ * tarval_set_wrap_on_overflow()) of the calling thread. With a single thread
+ * the pipeline runs on the calling thread only.
+ */
+FIRM_API void run_parallel_pipeline(ir_parallel_pipeline *pipeline,
+                                    unsigned n_threads);
+
 /** @} */
 
 #include "end.h"
@@ -501,7 +501,9 @@ typedef enum ir_initializer_kind_t {
 	/** initializes type with default values (usually 0) */
 	IR_INITIALIZER_NULL,
 	/** list of initializers used to initialize a compound or array type */
-	IR_INITIALIZER_COMPOUND
+	IR_INITIALIZER_COMPOUND,
+	/** raw memory image of (a prefix of) the initialized object */
+	IR_INITIALIZER_BYTES
 } ir_initializer_kind_t;
 
 /** Returns the kind of an initializer */
@@ -545,6 +547,33 @@ FIRM_API void set_initializer_compound_value(ir_initializer_t *initializer,
 FIRM_API ir_initializer_t *get_initializer_compound_value(
 		const ir_initializer_t *initializer, size_t index);
 
+/**
+ * Creates an initializer holding the raw memory image of an object.
+ *
+ * The @p size bytes at @p data are copied and describe the first @p size
+ * bytes of the initialized object in target byte order, any remaining bytes
+ * are zero. This is a compact alternative to a compound initializer with one
+ * tarval per element for large constant tables and embedded data. The image
+ * cannot contain relocations.
+ */
+FIRM_API ir_initializer_t *create_initializer_bytes(size_t size,
+                                                    const void *data);
+
+/**
+ * Like create_initializer_bytes() but does not copy the data. @p data (which
+ * may for example point into a mapped file) must stay valid as long as the
+ * initializer is used.
+ */
+FIRM_API ir_initializer_t *create_initializer_bytes_ref(size_t size,
+                                                        const void *data);
+
+/** Returns the number of bytes in a bytes initializer */
+FIRM_API size_t get_initializer_bytes_size(const ir_initializer_t *initializer);
+
+/** Returns the data of a bytes initializer */
+FIRM_API const unsigned char *get_initializer_bytes_data(
+		const ir_initializer_t *initializer);
+
 /** @} */
 
 /** Sets the initializer of an entity. */
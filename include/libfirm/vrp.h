@@ -46,6 +46,12 @@ typedef struct {
 
 /**
  * Sets vrp data on the graph irg
+ *
+ * The ranges are computed by a sparse propagation, which widens the ranges of
+ * loop header Phis and narrows them again afterwards. Comparisons controlling
+ * loops refine the ranges of induction variables, Confirm nodes refine the
+ * ranges of their values.
+ *
  * @param irg graph on which to set vrp data
  */
 FIRM_API void set_vrp_data(ir_graph *irg);
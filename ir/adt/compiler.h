@@ -45,12 +45,23 @@
  */
 #define ENUMBF(type)  __extension__ type
 
+/**
+ * Gives each thread its own instance of a variable with static storage
+ * duration.
+ */
+#define FIRM_THREAD_LOCAL __thread
+
 #else
 #define LIKELY(x)   x
 #define UNLIKELY(x) x
 #define PURE
 #define UNUSED
 #define ENUMBF(type)  unsigned
+#ifdef _MSC_VER
+#define FIRM_THREAD_LOCAL __declspec(thread)
+#else
+#define FIRM_THREAD_LOCAL _Thread_local
+#endif
 #endif
 
 /**
@@ -46,6 +46,11 @@
  *  <li><b>SetRangeEmpty(ptr,count)</b> Efficiently sets a range of elements to
  *                                      the Null value</li>
  *  <li><b>ADDITIONAL_DATA<b>   Additional fields appended to the hashset struct</li>
+ *  <li><b>GROUP_PROBING</b>    Probe groups of 16 buckets at once. A control
+ *                              byte per bucket caches 7 bits of the hash, so
+ *                              most mismatches are rejected without looking
+ *                              at the bucket. Uses SSE2 if available. Must be
+ *                              defined for hashset.h, too.</li>
  * </ul>
  */
 #ifdef HashSet
@@ -159,6 +164,180 @@
 
 #define ILLEGAL_POS       ((size_t)-1)
 
+#ifdef GROUP_PROBING
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include <string.h>
+#include "xmalloc.h"
+
+/* A full bucket has the 7 hash bits in its control byte, empty and deleted
+ * buckets have the high bit set. */
+#define CTRL_EMPTY        ((unsigned char)0x80)
+#define CTRL_DELETED      ((unsigned char)0xFE)
+#define GROUP_WIDTH       16
+
+/* As in the linear probing engine the low bits of the hash select the
+ * buckets. The control byte mixes in higher bits, so that the elements of a
+ * group rarely share it. */
+#define GroupFromHash(hash) ((size_t)(hash) / GROUP_WIDTH)
+#define CtrlFromHash(hash)  ((unsigned char)(((hash) ^ ((hash) >> 7)) & 0x7F))
+
+#ifdef __SSE2__
+typedef __m128i group_t;
+
+static inline group_t group_load(const unsigned char *ctrl)
+{
+	return _mm_loadu_si128((const __m128i*)ctrl);
+}
+
+/**
+ * Returns a bitmask of the buckets in @p group, whose control byte is @p c.
+ * @internal
+ */
+static inline unsigned group_match(group_t group, unsigned char c)
+{
+	__m128i const match = _mm_cmpeq_epi8(group, _mm_set1_epi8((char)c));
+	return (unsigned)_mm_movemask_epi8(match);
+}
+
+/**
+ * Returns a bitmask of the empty and deleted buckets in @p group.
+ * @internal
+ */
+static inline unsigned group_match_free(group_t group)
+{
+	return (unsigned)_mm_movemask_epi8(group);
+}
+#else
+typedef const unsigned char *group_t;
+
+static inline group_t group_load(const unsigned char *ctrl)
+{
+	return ctrl;
+}
+
+static inline unsigned group_match(group_t group, unsigned char c)
+{
+	unsigned mask = 0;
+	for (unsigned i = 0; i < GROUP_WIDTH; ++i)
+		mask |= (unsigned)(group[i] == c) << i;
+	return mask;
+}
+
+static inline unsigned group_match_free(group_t group)
+{
+	unsigned mask = 0;
+	for (unsigned i = 0; i < GROUP_WIDTH; ++i)
+		mask |= (unsigned)(group[i] >> 7) << i;
+	return mask;
+}
+#endif
+
+#ifdef DO_REHASH
+#define EntryMatches(self,entry,hash,key) \
+	KeysEqual(self, GetKey(EntryGetValue(entry)), key)
+#else
+#define EntryMatches(self,entry,hash,key) \
+	(EntryGetHash(self, entry) == (hash) \
+	 && KeysEqual(self, GetKey(EntryGetValue(entry)), key))
+#endif
+
+/**
+ * Returns the bucket number of the element with key @p key or ILLEGAL_POS.
+ * If @p free_pos is not NULL, it receives the first empty or deleted bucket
+ * in the probe sequence, where the element would be inserted.
+ * @internal
+ */
+static inline size_t find_pos(const HashSet *self, ConstKeyType key,
+                              unsigned hash, size_t *free_pos)
+{
+	unsigned char const c          = CtrlFromHash(hash);
+	size_t        const group_mask = self->num_buckets / GROUP_WIDTH - 1;
+	size_t              group_nr   = GroupFromHash(hash) & group_mask;
+	size_t              insert_pos = ILLEGAL_POS;
+
+	for (size_t num_probes = 0;;) {
+		size_t  const base  = group_nr * GROUP_WIDTH;
+		group_t const group = group_load(&self->ctrl[base]);
+		for (unsigned match = group_match(group, c); match != 0;
+		     match &= match - 1) {
+			size_t const pos = base + ntz(match);
+			if (EntryMatches(self, self->entries[pos], hash, key))
+				return pos;
+		}
+		unsigned const free = group_match_free(group);
+		if (free != 0 && insert_pos == ILLEGAL_POS)
+			insert_pos = base + ntz(free);
+		/* the element would have been put into an empty bucket */
+		if (group_match(group, CTRL_EMPTY) != 0) {
+			if (free_pos != NULL)
+				*free_pos = insert_pos;
+			return ILLEGAL_POS;
+		}
+
+		++num_probes;
+		group_nr = (group_nr + num_probes) & group_mask;
+		assert(num_probes <= group_mask);
+	}
+}
+
+/**
+ * Returns the first empty bucket in the probe sequence of @p hash. The
+ * hashset must not contain deleted buckets.
+ * @internal
+ */
+static inline size_t find_empty_pos(const HashSet *self, unsigned hash)
+{
+	size_t const group_mask = self->num_buckets / GROUP_WIDTH - 1;
+	size_t       group_nr   = GroupFromHash(hash) & group_mask;
+
+	for (size_t num_probes = 0;;) {
+		size_t   const base = group_nr * GROUP_WIDTH;
+		unsigned const free = group_match_free(group_load(&self->ctrl[base]));
+		if (free != 0)
+			return base + ntz(free);
+
+		++num_probes;
+		group_nr = (group_nr + num_probes) & group_mask;
+		assert(num_probes <= group_mask);
+	}
+}
+
+/**
+ * Marks bucket @p pos as full for an element with hash @p hash.
+ * @internal
+ */
+static inline void set_full(HashSet *self, size_t pos, unsigned hash)
+{
+	if (self->ctrl[pos] == CTRL_DELETED) {
+		self->num_deleted--;
+	} else {
+		self->num_elements++;
+	}
+	self->ctrl[pos] = CtrlFromHash(hash);
+}
+
+/**
+ * Removes the element in bucket @p pos.
+ * @internal
+ */
+static inline void remove_pos(HashSet *self, size_t pos)
+{
+	/* If the group still has an empty bucket, no probe sequence continues
+	 * behind it, so the bucket may become empty as well. */
+	size_t const base = pos & ~(size_t)(GROUP_WIDTH - 1);
+	if (group_match(group_load(&self->ctrl[base]), CTRL_EMPTY) != 0) {
+		self->ctrl[pos] = CTRL_EMPTY;
+		self->num_elements--;
+	} else {
+		self->ctrl[pos] = CTRL_DELETED;
+		self->num_deleted++;
+	}
+	self->consider_shrink = 1;
+}
+#endif /* GROUP_PROBING */
+
 #ifdef hashset_size
 /**
  * Returns the number of elements in the hashset
@@ -181,6 +360,22 @@ static inline size_t hashset_size(const HashSet *self)
  * @note also see comments for hashset_insert()
  * @internal
  */
+#ifdef GROUP_PROBING
+static inline FindReturnValue insert_nogrow(HashSet *self, KeyType key)
+{
+	unsigned const hash = Hash(self, key);
+	size_t         pos;
+	size_t   const found = find_pos(self, key, hash, &pos);
+	if (found != ILLEGAL_POS)
+		return GetFindReturnValue(self->entries[found], true);
+
+	set_full(self, pos, hash);
+	HashSetEntry *const nentry = &self->entries[pos];
+	InitData(self, EntryGetValue(*nentry), key);
+	EntrySetHash(*nentry, hash);
+	return GetFindReturnValue(*nentry, false);
+}
+#else
 static inline FindReturnValue insert_nogrow(HashSet *self, KeyType key)
 {
 	size_t   num_probes  = 0;
@@ -226,6 +421,7 @@ static inline FindReturnValue insert_nogrow(HashSet *self, KeyType key)
 		assert(num_probes < num_buckets);
 	}
 }
+#endif
 
 /**
  * calculate shrink and enlarge limits
@@ -239,6 +435,54 @@ static inline void reset_thresholds(HashSet *self)
 }
 
 #ifndef HAVE_OWN_RESIZE
+#ifdef GROUP_PROBING
+/**
+ * Inserts an element into a hashset under the assumption that the hashset
+ * contains no deleted entries and the element doesn't exist in the hashset yet.
+ * @internal
+ */
+static void insert_new(HashSet *self, unsigned hash, ValueType value)
+{
+	size_t const pos = find_empty_pos(self, hash);
+	set_full(self, pos, hash);
+	EntryGetValue(self->entries[pos]) = value;
+	EntrySetHash(self->entries[pos], hash);
+}
+
+/**
+ * Resize the hashset
+ * @internal
+ */
+static inline void resize(HashSet *self, size_t new_size)
+{
+	size_t         const num_buckets = self->num_buckets;
+	HashSetEntry  *const old_entries = self->entries;
+	unsigned char *const old_ctrl    = self->ctrl;
+
+	assert(new_size >= GROUP_WIDTH);
+	self->entries      = Alloc(new_size);
+	self->ctrl         = XMALLOCN(unsigned char, new_size);
+	memset(self->ctrl, CTRL_EMPTY, new_size);
+	self->num_buckets  = new_size;
+	self->num_elements = 0;
+	self->num_deleted  = 0;
+#ifndef NDEBUG
+	self->entries_version++;
+#endif
+	reset_thresholds(self);
+
+	/* reinsert all elements */
+	for (size_t i = 0; i < num_buckets; ++i) {
+		if (old_ctrl[i] & CTRL_EMPTY)
+			continue;
+		HashSetEntry *entry = &old_entries[i];
+		insert_new(self, EntryGetHash(self, *entry), EntryGetValue(*entry));
+	}
+
+	Free(old_entries);
+	free(old_ctrl);
+}
+#else
 /**
  * Inserts an element into a hashset under the assumption that the hashset
  * contains no deleted entries and the element doesn't exist in the hashset yet.
@@ -318,6 +562,7 @@ static inline void resize(HashSet *self, size_t new_size)
 	/* now we can free the old array */
 	Free(old_entries);
 }
+#endif
 #else
 
 /* resize must be defined outside */
@@ -368,10 +613,17 @@ static inline void maybe_shrink(HashSet *self)
 	if (LIKELY(size > self->shrink_threshold))
 		return;
 
+#ifdef GROUP_PROBING
+	/* leave room below the enlarge threshold */
+	resize_to = ceil_po2(size * HT_1_DIV_OCCUPANCY_FLT);
+	if (resize_to < GROUP_WIDTH)
+		resize_to = GROUP_WIDTH;
+#else
 	resize_to = ceil_po2(size);
 
 	if (resize_to < 4)
 		resize_to = 4;
+#endif
 
 	resize(self, resize_to);
 }
@@ -409,6 +661,12 @@ FindReturnValue hashset_insert(HashSet *self, KeyType key)
  */
 FindReturnValue hashset_find(const HashSet *self, ConstKeyType key)
 {
+#ifdef GROUP_PROBING
+	size_t const pos = find_pos(self, key, Hash(self, key), NULL);
+	if (pos == ILLEGAL_POS)
+		return NullReturnValue;
+	return GetFindReturnValue(self->entries[pos], true);
+#else
 	size_t   num_probes  = 0;
 	size_t   num_buckets = self->num_buckets;
 	size_t   hashmask    = num_buckets - 1;
@@ -434,6 +692,7 @@ FindReturnValue hashset_find(const HashSet *self, ConstKeyType key)
 		bucknum = (bucknum + JUMP(num_probes)) & hashmask;
 		assert(num_probes < num_buckets);
 	}
+#endif
 }
 #endif
 
@@ -447,16 +706,21 @@ FindReturnValue hashset_find(const HashSet *self, ConstKeyType key)
  */
 void hashset_remove(HashSet *self, ConstKeyType key)
 {
+#ifndef NDEBUG
+	self->entries_version++;
+#endif
+
+#ifdef GROUP_PROBING
+	size_t const pos = find_pos(self, key, Hash(self, key), NULL);
+	if (pos != ILLEGAL_POS)
+		remove_pos(self, pos);
+#else
 	size_t   num_probes  = 0;
 	size_t   num_buckets = self->num_buckets;
 	size_t   hashmask    = num_buckets - 1;
 	unsigned hash        = Hash(self, key);
 	size_t   bucknum     = hash & hashmask;
 
-#ifndef NDEBUG
-	self->entries_version++;
-#endif
-
 	for (;;) {
 		HashSetEntry *entry = & self->entries[bucknum];
 
@@ -478,6 +742,7 @@ void hashset_remove(HashSet *self, ConstKeyType key)
 		bucknum = (bucknum + JUMP(num_probes)) & hashmask;
 		assert(num_probes < num_buckets);
 	}
+#endif
 }
 #endif
 
@@ -487,11 +752,20 @@ void hashset_remove(HashSet *self, ConstKeyType key)
  */
 static inline void init_size(HashSet *self, size_t initial_size)
 {
+#ifdef GROUP_PROBING
+	if (initial_size < GROUP_WIDTH)
+		initial_size = GROUP_WIDTH;
+
+	self->entries         = Alloc(initial_size);
+	self->ctrl            = XMALLOCN(unsigned char, initial_size);
+	memset(self->ctrl, CTRL_EMPTY, initial_size);
+#else
 	if (initial_size < 4)
 		initial_size = 4;
 
 	self->entries         = Alloc(initial_size);
 	SetRangeEmpty(self->entries, initial_size);
+#endif
 	self->num_buckets     = initial_size;
 	self->consider_shrink = 0;
 	self->num_elements    = 0;
@@ -528,6 +802,9 @@ void hashset_destroy(HashSet *self)
 	ADDITIONAL_TERM
 #endif
 	Free(self->entries);
+#ifdef GROUP_PROBING
+	free(self->ctrl);
+#endif
 #ifndef NDEBUG
 	self->entries = NULL;
 #endif
@@ -563,6 +840,9 @@ void hashset_iterator_init(HashSetIterator *self, const HashSet *hashset)
 {
 	self->current_bucket = hashset->entries - 1;
 	self->end            = hashset->entries + hashset->num_buckets;
+#ifdef GROUP_PROBING
+	self->current_ctrl   = hashset->ctrl - 1;
+#endif
 #ifndef NDEBUG
 	self->set             = hashset;
 	self->entries_version = hashset->entries_version;
@@ -584,11 +864,23 @@ ValueType hashset_iterator_next(HashSetIterator *self)
 	/* using hashset_insert or hashset_remove is not allowed while iterating */
 	assert(self->entries_version == self->set->entries_version);
 
+#ifdef GROUP_PROBING
+	const unsigned char *current_ctrl = self->current_ctrl;
+	do {
+		current_bucket++;
+		current_ctrl++;
+		if (current_bucket >= end)
+			return NullValue;
+	} while (*current_ctrl & CTRL_EMPTY);
+
+	self->current_ctrl   = current_ctrl;
+#else
 	do {
 		current_bucket++;
 		if (current_bucket >= end)
 			return NullValue;
 	} while (EntryIsEmpty(*current_bucket) || EntryIsDeleted(*current_bucket));
+#endif
 
 	self->current_bucket = current_bucket;
 	return EntryGetValue(*current_bucket);
@@ -609,12 +901,20 @@ void hashset_remove_iterator(HashSet *self, const HashSetIterator *iter)
 	/* needs to be on a valid element */
 	assert(entry < self->entries + self->num_buckets);
 
+#ifdef GROUP_PROBING
+	size_t const pos = (size_t)(entry - self->entries);
+	if (self->ctrl[pos] & CTRL_EMPTY)
+		return;
+
+	remove_pos(self, pos);
+#else
 	if (EntryIsDeleted(*entry))
 		return;
 
 	EntrySetDeleted(*entry);
 	self->num_deleted++;
 	self->consider_shrink = 1;
+#endif
 }
 #endif
 
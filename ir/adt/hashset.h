@@ -10,7 +10,8 @@
  * @author  Matthias Braun
  *
  * You have to specialize this header by defining HashSet, HashSetIterator and
- * ValueType
+ * ValueType. Define GROUP_PROBING to get the control bytes used by the group
+ * probing engine of hashset.c.h.
  */
 #ifdef HashSet
 
@@ -27,6 +28,9 @@ typedef struct HashSetEntry {
 
 struct HashSet {
 	HashSetEntry *entries;
+#ifdef GROUP_PROBING
+	unsigned char *ctrl;
+#endif
 	size_t num_buckets;
 	size_t enlarge_threshold;
 	size_t shrink_threshold;
@@ -45,6 +49,9 @@ struct HashSet {
 struct HashSetIterator {
 	HashSetEntry *current_bucket;
 	HashSetEntry *end;
+#ifdef GROUP_PROBING
+	const unsigned char *current_ctrl;
+#endif
 #ifndef NDEBUG
 	const struct HashSet *set;
 	unsigned entries_version;
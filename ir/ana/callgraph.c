@@ -9,7 +9,7 @@
  * @author      Goetz Lindenmaier
  * @date        21.7.2004
  */
-#include "callgraph.h"
+#include "callgraph_t.h"
 
 #include "array.h"
 #include "cgana.h"
@@ -154,7 +154,6 @@ size_t get_irg_callee_loop_depth(const ir_graph *irg, size_t pos)
 	return irg->callees ? irg->callees[pos]->max_depth : 0;
 }
 
-
 /**
  * Pre-Walker called by compute_callgraph(), analyses all Call nodes.
  */
@@ -269,6 +268,52 @@ void free_callgraph(void)
 	set_irp_callgraph_state(irp_callgraph_none);
 }
 
+void cg_worklist_init(cg_worklist_t *const wl)
+{
+	ir_entity **free_methods;
+	cgana(&free_methods);
+	free(free_methods);
+	compute_callgraph();
+
+	wl->irgs   = NEW_ARR_F(ir_graph*, 0);
+	wl->queued = rbitset_malloc(get_irp_last_idx());
+	foreach_irp_irg_r(i, irg) {
+		cg_worklist_push(wl, irg);
+	}
+}
+
+void cg_worklist_free(cg_worklist_t *const wl)
+{
+	DEL_ARR_F(wl->irgs);
+	free(wl->queued);
+	free_callgraph();
+}
+
+void cg_worklist_push(cg_worklist_t *const wl, ir_graph *const irg)
+{
+	if (rbitset_is_set(wl->queued, get_irg_idx(irg)))
+		return;
+	rbitset_set(wl->queued, get_irg_idx(irg));
+	ARR_APP1(ir_graph*, wl->irgs, irg);
+}
+
+void cg_worklist_push_callers(cg_worklist_t *const wl, ir_graph const *const irg)
+{
+	for (size_t i = 0, n = get_irg_n_callers(irg); i < n; ++i)
+		cg_worklist_push(wl, get_irg_caller(irg, i));
+}
+
+ir_graph *cg_worklist_pop(cg_worklist_t *const wl)
+{
+	size_t const n = ARR_LEN(wl->irgs);
+	if (n == 0)
+		return NULL;
+	ir_graph *const irg = wl->irgs[n - 1];
+	ARR_SHRINKLEN(wl->irgs, n - 1);
+	rbitset_clear(wl->queued, get_irg_idx(irg));
+	return irg;
+}
+
 /**
  * Returns non-zero if a graph was already visited.
  */
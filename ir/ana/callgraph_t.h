@@ -0,0 +1,43 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Worklist of graphs for interprocedural fixpoint iterations.
+ */
+#ifndef FIRM_ANA_CALLGRAPH_T_H
+#define FIRM_ANA_CALLGRAPH_T_H
+
+#include "callgraph.h"
+
+/**
+ * The graphs whose summary must be (re-)computed.  A graph is queued at most
+ * once, so a graph whose callee summary changes several times before it is
+ * evaluated again is evaluated once.
+ */
+typedef struct cg_worklist_t {
+	ir_graph **irgs;    /**< the queued graphs, the last one is next */
+	unsigned  *queued;  /**< graphs in irgs, by graph index */
+} cg_worklist_t;
+
+/**
+ * Computes the callee information and the call graph and queues all graphs,
+ * such that they are evaluated in program order.
+ */
+void cg_worklist_init(cg_worklist_t *wl);
+
+/** Frees the worklist and the call graph. */
+void cg_worklist_free(cg_worklist_t *wl);
+
+/** Queues @p irg unless it is already queued. */
+void cg_worklist_push(cg_worklist_t *wl, ir_graph *irg);
+
+/** Queues all callers of @p irg, whose summaries depend on the one of @p irg. */
+void cg_worklist_push_callers(cg_worklist_t *wl, ir_graph const *irg);
+
+/** Removes the next graph from the worklist, returns NULL if it is empty. */
+ir_graph *cg_worklist_pop(cg_worklist_t *wl);
+
+#endif
@@ -27,7 +27,7 @@ typedef struct cdep_info {
 	struct obstack obst;     /**< An obstack where all cdep data lives on. */
 } cdep_info;
 
-static cdep_info *cdep_data;
+static FIRM_THREAD_LOCAL cdep_info *cdep_data;
 
 ir_node *(get_cdep_node)(const ir_cdep *cdep)
 {
@@ -25,6 +25,7 @@
 #include "irflag_t.h"
 #include "irgmod.h"
 #include "irgwalk.h"
+#include "irmemory_t.h"
 #include "irmode_t.h"
 #include "irnode_t.h"
 #include "iropt.h"
@@ -400,6 +401,7 @@ static void add_method_address_inititializer(ir_initializer_t const *const initi
 	}
 	case IR_INITIALIZER_TARVAL:
 	case IR_INITIALIZER_NULL:
+	case IR_INITIALIZER_BYTES:
 		return;
 	case IR_INITIALIZER_COMPOUND:
 		for (size_t i = 0; i < initializer->compound.n_initializers; ++i) {
@@ -611,8 +613,17 @@ static void callee_walker(ir_node *call, void *env)
 	if (!is_Call(call))
 		return;
 
-	pset *methods = pset_new_ptr_default();
-	callee_ana_node(get_Call_ptr(call), methods);
+	pset       *methods = pset_new_ptr_default();
+	ir_node    *ptr     = get_Call_ptr(call);
+	/* the points-to sets also know functions stored in memory */
+	ir_entity **callees = get_points_to_callees(ptr);
+	if (callees != NULL) {
+		for (size_t i = 0, n = ARR_LEN(callees); i < n; ++i)
+			pset_insert_ptr(methods, callees[i]);
+		DEL_ARR_F(callees);
+	} else {
+		callee_ana_node(ptr, methods);
+	}
 	ir_entity **arr = NEW_ARR_F(ir_entity*, pset_count(methods));
 	size_t      i   = 0;
 	foreach_pset(methods, ir_entity, ent) {
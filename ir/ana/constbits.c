@@ -204,7 +204,8 @@ static bitinfo *get_bitinfo_recursive(ir_node const *const irn)
 	return b;
 }
 
-static bitinfo *(*get_bitinfo_func)(ir_node const*) = &get_bitinfo_null;
+static FIRM_THREAD_LOCAL bitinfo *(*get_bitinfo_func)(ir_node const*)
+	= &get_bitinfo_null;
 
 bitinfo *get_bitinfo(ir_node const *const irn)
 {
@@ -27,7 +27,7 @@
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 
-static deq_t worklist;
+static FIRM_THREAD_LOCAL deq_t worklist;
 
 /**
  * Set cared for bits in irn, possibly putting it on the worklist.
@@ -14,7 +14,7 @@
 #include "irdump.h"
 #include "iredges_t.h"
 #include "irgwalk.h"
-#include "irnodemap.h"
+#include "irnodetable.h"
 #include "list.h"
 #include "util.h"
 #include <stdbool.h>
@@ -22,10 +22,10 @@
 #include <stdlib.h>
 
 struct ir_heights_t {
-	ir_nodemap      data;
-	unsigned        visited;
-	hook_entry_t   *dump_handle;
-	struct obstack  obst;
+	ir_nodetable           data;
+	ir_height_weight_func *weight;  /**< NULL for unweighted heights */
+	unsigned               visited;
+	hook_entry_t          *dump_handle;
 };
 
 typedef struct {
@@ -36,17 +36,14 @@ typedef struct {
 static irn_height_t *maybe_get_height_data(const ir_heights_t *heights,
                                            const ir_node *node)
 {
-	irn_height_t *height = ir_nodemap_get(irn_height_t, &heights->data, node);
-	return height;
+	return ir_nodetable_get(irn_height_t, &heights->data, node);
 }
 
 static irn_height_t *get_height_data(ir_heights_t *heights, const ir_node *node)
 {
-	irn_height_t *height = ir_nodemap_get(irn_height_t, &heights->data, node);
-	if (height == NULL) {
-		height = OALLOCZ(&heights->obst, irn_height_t);
-		ir_nodemap_insert(&heights->data, node, height);
-	}
+	irn_height_t *height = ir_nodetable_get(irn_height_t, &heights->data, node);
+	if (height == NULL)
+		height = ir_nodetable_insert(irn_height_t, &heights->data, node);
 	return height;
 }
 
@@ -134,14 +131,17 @@ static unsigned compute_height(ir_heights_t *h, ir_node *irn, const ir_node *bl)
 	ih->visited = h->visited;
 	ih->height  = 0;
 
+	unsigned const edge_weight = h->weight != NULL ? 0 : 1;
 	foreach_out_edge(irn, edge) {
 		ir_node *dep = get_edge_src_irn(edge);
 
 		if (!is_Block(dep) && !is_Phi(dep) && get_nodes_block(dep) == bl) {
 			unsigned dep_height = compute_height(h, dep, bl);
-			ih->height          = MAX(ih->height, dep_height+1);
+			ih->height          = MAX(ih->height, dep_height + edge_weight);
 		}
 	}
+	if (h->weight != NULL)
+		ih->height += h->weight(irn);
 
 	return ih->height;
 }
@@ -181,20 +181,20 @@ unsigned heights_recompute_block(ir_heights_t *h, ir_node *block)
 
 	/* reset data for all nodes in the block */
 	foreach_out_edge(block, edge) {
-		ir_node      *irn = get_edge_src_irn(edge);
-		irn_height_t *ih  = get_height_data(h, irn);
-		memset(ih, 0, sizeof(*ih));
+		ir_node *irn = get_edge_src_irn(edge);
+		ir_nodetable_insert(irn_height_t, &h->data, irn);
 	}
 
 	h->visited = 0;
 	return compute_heights_in_block(block, h);
 }
 
-ir_heights_t *heights_new(ir_graph *irg)
+ir_heights_t *heights_new_weighted(ir_graph *irg,
+                                   ir_height_weight_func *weight)
 {
 	ir_heights_t *res = XMALLOCZ(ir_heights_t);
-	ir_nodemap_init(&res->data, irg);
-	obstack_init(&res->obst);
+	ir_nodetable_init(&res->data, irg, sizeof(irn_height_t));
+	res->weight      = weight;
 	res->dump_handle = dump_add_node_info_callback(height_dump_cb, res);
 
 	assure_edges(irg);
@@ -203,10 +203,14 @@ ir_heights_t *heights_new(ir_graph *irg)
 	return res;
 }
 
+ir_heights_t *heights_new(ir_graph *irg)
+{
+	return heights_new_weighted(irg, NULL);
+}
+
 void heights_free(ir_heights_t *h)
 {
 	dump_remove_node_info_callback(h->dump_handle);
-	obstack_free(&h->obst, NULL);
-	ir_nodemap_destroy(&h->data);
+	ir_nodetable_destroy(&h->data);
 	free(h);
 }
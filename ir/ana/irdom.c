@@ -17,7 +17,9 @@
 #include "irgraph_t.h"
 #include "irgwalk.h"
 #include "irnode_t.h"
+#include "irnodehashmap.h"
 #include "irouts_t.h"
+#include "panic.h"
 #include "util.h"
 #include "xmalloc.h"
 #include <string.h>
@@ -311,31 +313,6 @@ static void assign_tree_dom_pre_order_max(ir_node *block, void *data)
 	assert(bi->max_subtree_pre_num >= bi->tree_pre_num);
 }
 
-static void assign_tree_postdom_pre_order(ir_node *block, void *data)
-{
-	unsigned    *num = (unsigned*)data;
-	ir_dom_info *bi  = get_pdom_info(block);
-
-	bi->tree_pre_num = (*num)++;
-}
-
-static void assign_tree_postdom_pre_order_max(ir_node *block, void *data)
-{
-	(void)data;
-	ir_dom_info *bi           = get_pdom_info(block);
-	unsigned     max          = 0;
-	bool         has_children = false;
-
-	for (ir_node *p = bi->first; p; p = get_pdom_info(p)->next) {
-		unsigned max_p = get_pdom_info(p)->max_subtree_pre_num;
-		max          = MAX(max, max_p);
-		has_children = true;
-	}
-
-	bi->max_subtree_pre_num = has_children ? max : bi->tree_pre_num;
-	assert(bi->max_subtree_pre_num >= bi->tree_pre_num);
-}
-
 /**
  * count the number of blocks and clears the post dominance info
  */
@@ -350,137 +327,235 @@ static void count_and_init_blocks_pdom(ir_node *block, void *env)
 	set_Block_postdom_depth(block, -1);
 }
 
-/** temporary type used while constructing the dominator / post dominator tree. */
-typedef struct tmp_dom_info {
-	ir_node *block;               /**< backlink */
-
-	struct tmp_dom_info *semi;    /**< semidominator */
-	struct tmp_dom_info *parent;
-	struct tmp_dom_info *label;   /**< used for LINK and EVAL */
-	struct tmp_dom_info *ancestor;/**< used for LINK and EVAL */
-	struct tmp_dom_info *dom;     /**< After step 3, if the semidominator of w
-	                                   is its immediate dominator, then w->dom
-	                                   is the immediate dominator of w.
-	                                   Otherwise w->dom is a vertex v whose
-	                                   number is smaller than w and whose
-	                                   immediate dominator is also w's
-	                                   immediate dominator. After step 4,
-	                                   w->dom is the immediate dominator of w.*/
-	struct tmp_dom_info *bucket;  /**< set of vertices with same semidominator */
-	int unreachable : 1; /**< node is not reachable by control flow edges */
-} tmp_dom_info;
-
 /**
- * Walks Blocks along the out data structure.  If recursion started with
- * Start block misses control dead blocks.
+ * Dense representation of the graph a (post) dominator tree is computed for.
+ * Nodes are the blocks numbered in DFS preorder with the root at 0, the
+ * predecessors of node i are preds[pred_start[i]] .. preds[pred_start[i+1]-1].
  */
-static void init_tmp_dom_info(ir_node *block, tmp_dom_info *parent,
-                              tmp_dom_info *tdi_list, int *used, int n_blocks)
+typedef struct dom_graph_t {
+	int       n;           /**< number of nodes */
+	ir_node **blocks;      /**< block of each node */
+	int      *parent;      /**< DFS tree parent, -1 for the root */
+	int      *pred_start;  /**< start of the predecessors of each node */
+	int      *preds;       /**< predecessor numbers of all nodes */
+	int      *idom;        /**< immediate dominator, -1 for the root */
+} dom_graph_t;
+
+static void dom_graph_init(dom_graph_t *g, int max_n)
 {
-	if (Block_block_visited(block)) {
-		return;
-	}
-	mark_Block_block_visited(block);
-	set_Block_dom_pre_num(block, *used);
-
-	assert(*used < n_blocks);
-	tmp_dom_info *tdi = &tdi_list[*used];
-	++(*used);
-
-	tdi->block       = block;
-	tdi->semi        = tdi;
-	tdi->parent      = parent;
-	tdi->label       = tdi;
-	tdi->ancestor    = NULL;
-	tdi->dom         = NULL;
-	tdi->bucket      = NULL;
-	tdi->unreachable = 0;
-
-	/* Iterate */
-	for (unsigned i = get_Block_n_cfg_outs_ka(block); i-- != 0;) {
-		ir_node *pred = get_Block_cfg_out_ka(block, i);
-		/* can happen for half-optimized dead code */
-		if (!is_Block(pred))
-			continue;
+	g->n          = 0;
+	g->blocks     = XMALLOCN(ir_node*, max_n);
+	g->parent     = XMALLOCN(int, max_n);
+	g->pred_start = XMALLOCN(int, max_n + 1);
+	g->preds      = NEW_ARR_F(int, 0);
+	g->idom       = XMALLOCN(int, max_n);
+}
 
-		init_tmp_dom_info(pred, tdi, tdi_list, used, n_blocks);
-	}
+static void dom_graph_free(dom_graph_t *g)
+{
+	free(g->blocks);
+	free(g->parent);
+	free(g->pred_start);
+	DEL_ARR_F(g->preds);
+	free(g->idom);
 }
 
 /**
- * Walks Blocks along the control flow.  If recursion started with
- * End block misses blocks in endless loops.
+ * Semi-NCA: computes the immediate dominators of a graph in DFS preorder.
+ * The semidominators are computed with path compression as in
+ * Lengauer-Tarjan, the immediate dominators are then found as the nearest
+ * common ancestor of parent and semidominator in the partially built tree.
  */
-static void init_tmp_pdom_info(ir_node *block, tmp_dom_info *parent,
-                               tmp_dom_info *tdi_list, int* used, int n_blocks,
-                               int unreachable)
+static void semi_nca(dom_graph_t *g)
 {
-	if (Block_block_visited(block))
-		return;
-	mark_Block_block_visited(block);
-	set_Block_postdom_pre_num(block, *used);
-
-	assert(*used < n_blocks);
-	tmp_dom_info *tdi = &tdi_list[*used];
-	++(*used);
-
-	tdi->block       = block;
-	tdi->semi        = tdi;
-	tdi->parent      = parent;
-	tdi->label       = tdi;
-	tdi->ancestor    = NULL;
-	tdi->dom         = NULL;
-	tdi->bucket      = NULL;
-	tdi->unreachable = unreachable;
-
-	/* Iterate */
-	for (int i = get_Block_n_cfgpreds(block) - 1; i >= 0; --i) {
-		ir_node *pred = get_Block_cfgpred_block(block, i);
-		if (pred == NULL)
-			continue;
-		init_tmp_pdom_info(pred, tdi, tdi_list, used, n_blocks, unreachable);
+	int  n        = g->n;
+	int *semi     = XMALLOCN(int, n);
+	int *label    = XMALLOCN(int, n);
+	int *ancestor = XMALLOCN(int, n);
+	int *stack    = XMALLOCN(int, n);
+
+	for (int i = 0; i < n; ++i) {
+		semi[i]     = i;
+		label[i]    = i;
+		ancestor[i] = g->parent[i];
 	}
 
-	/* All remaining block keep-alives are edges to endless loops.
-	 * Mark the following unvisited blocks as unreachable.
-	 * Later, we will treat the keep-alive edges as normal control flow. */
-	const ir_graph *irg = get_irn_irg(block);
-	if (block == get_irg_end_block(irg)) {
-		foreach_irn_in_r(get_irg_end(irg), i, pred) {
-			if (is_Block(pred))
-				init_tmp_pdom_info(pred, tdi, tdi_list, used, n_blocks, 1);
+	/* Nodes with a number >= i+1 have been linked into the forest when
+	 * processing node i. */
+	for (int i = n; i-- > 1; ) {
+		int s = g->parent[i];
+		for (int p = g->pred_start[i]; p < g->pred_start[i + 1]; ++p) {
+			int v = g->preds[p];
+			if (v > i) {
+				/* evaluate v: compress the path to the first unlinked
+				 * ancestor and take the label with minimal semi */
+				int sp = 0;
+				for (int a = v; ancestor[a] > i; a = ancestor[a])
+					stack[sp++] = a;
+				while (sp-- > 0) {
+					int w = stack[sp];
+					int a = ancestor[w];
+					if (semi[label[a]] < semi[label[w]])
+						label[w] = label[a];
+					ancestor[w] = ancestor[a];
+				}
+				v = label[v];
+			}
+			if (semi[v] < s)
+				s = semi[v];
 		}
+		semi[i]  = s;
+		label[i] = i;
+	}
+
+	g->idom[0] = -1;
+	for (int i = 1; i < n; ++i) {
+		int idom = g->parent[i];
+		while (idom > semi[i])
+			idom = g->idom[idom];
+		g->idom[i] = idom;
 	}
+
+	free(stack);
+	free(ancestor);
+	free(label);
+	free(semi);
 }
 
-static void dom_compress(tmp_dom_info *v)
+/**
+ * Computes tree preorder numbers and the largest number in each subtree from
+ * the idom array. Children are visited in decreasing DFS order, which is the
+ * order of the dominated lists built by set_Block_idom().
+ */
+static void number_dom_tree(const dom_graph_t *g, unsigned *tree_pre,
+                            unsigned *tree_max)
 {
-	assert(v->ancestor);
-	if (v->ancestor->ancestor) {
-		dom_compress(v->ancestor);
-		if (v->ancestor->label->semi < v->label->semi) {
-			v->label = v->ancestor->label;
-		}
-		v->ancestor = v->ancestor->ancestor;
+	int  n           = g->n;
+	int *child_start = XMALLOCNZ(int, n + 1);
+	int *children    = XMALLOCN(int, n);
+	int *fill        = XMALLOCN(int, n);
+	int *stack       = XMALLOCN(int, n);
+	int *order       = XMALLOCN(int, n);
+
+	for (int i = 1; i < n; ++i)
+		++child_start[g->idom[i] + 1];
+	for (int i = 0; i < n; ++i) {
+		child_start[i + 1] += child_start[i];
+		fill[i]             = child_start[i];
 	}
+	for (int i = n; i-- > 1; )
+		children[fill[g->idom[i]]++] = i;
+
+	/* iterative preorder walk */
+	int      sp  = 0;
+	int      pos = 0;
+	unsigned num = 0;
+	stack[sp++] = 0;
+	while (sp > 0) {
+		int v = stack[--sp];
+		order[pos++] = v;
+		tree_pre[v]  = num++;
+		for (int c = child_start[v + 1]; c-- > child_start[v]; )
+			stack[sp++] = children[c];
+	}
+	/* the subtree of v ends at the last number of its last child */
+	for (int p = n; p-- > 0; ) {
+		int v = order[p];
+		int e = child_start[v + 1];
+		tree_max[v] = e > child_start[v] ? tree_max[children[e - 1]]
+		                                 : tree_pre[v];
+	}
+
+	free(order);
+	free(stack);
+	free(fill);
+	free(children);
+	free(child_start);
+}
+
+/** Returns the number of DFS successors of @p block. */
+static int get_n_dfs_succs(const ir_graph *irg, const ir_node *block, bool post)
+{
+	if (!post)
+		return get_Block_n_cfg_outs_ka(block);
+	int n = get_Block_n_cfgpreds(block);
+	if (block == get_irg_end_block(irg))
+		n += get_irn_arity(get_irg_end(irg));
+	return n;
 }
 
 /**
- * if V is a root, return v, else return the vertex u, not being the
- * root, with minimum u->semi on the path from v to its root.
+ * Returns the @p i-th DFS successor of @p block or NULL. Successors are
+ * visited with decreasing @p i. For post dominance the keep-alive edges of
+ * End have the lowest numbers, so they are visited after all control flow
+ * predecessors; they lead to endless loops.
  */
-inline static tmp_dom_info *dom_eval(tmp_dom_info *v)
+static ir_node *get_dfs_succ(const ir_graph *irg, ir_node *block, bool post,
+                             int i, bool *keep_alive)
 {
-	if (!v->ancestor)
-		return v;
-	dom_compress(v);
-	return v->label;
+	*keep_alive = false;
+	if (!post) {
+		ir_node *succ = get_Block_cfg_out_ka(block, i);
+		/* can happen for half-optimized dead code */
+		return is_Block(succ) ? succ : NULL;
+	}
+	int n_kept = block == get_irg_end_block(irg)
+	           ? get_irn_arity(get_irg_end(irg)) : 0;
+	if (i >= n_kept)
+		return get_Block_cfgpred_block(block, i - n_kept);
+	ir_node *kept = get_irn_n(get_irg_end(irg), i);
+	*keep_alive   = true;
+	return is_Block(kept) ? kept : NULL;
 }
 
-/** make V W's ancestor */
-inline static void dom_link(tmp_dom_info *v, tmp_dom_info *w)
+/**
+ * Numbers the blocks reachable from @p root in DFS preorder. Successors are
+ * visited in reverse order. Blocks only reached through keep-alive edges are
+ * marked in @p unreachable.
+ */
+static void dfs_number_blocks(ir_graph *irg, ir_node *root, bool post,
+                              dom_graph_t *g, bool *unreachable)
 {
-	w->ancestor = v;
+	typedef struct frame_t {
+		ir_node *block;
+		int      next;   /**< next successor, counting down */
+		int      num;
+	} frame_t;
+	frame_t *stack = NEW_ARR_F(frame_t, 0);
+
+	ir_reserve_resources(irg, IR_RESOURCE_BLOCK_VISITED);
+	inc_irg_block_visited(irg);
+
+	mark_Block_block_visited(root);
+	g->blocks[0]   = root;
+	g->parent[0]   = -1;
+	unreachable[0] = false;
+	g->n           = 1;
+	frame_t first = { root, get_n_dfs_succs(irg, root, post), 0 };
+	ARR_APP1(frame_t, stack, first);
+	while (ARR_LEN(stack) > 0) {
+		frame_t *top = &stack[ARR_LEN(stack) - 1];
+		if (top->next == 0) {
+			ARR_SHRINKLEN(stack, ARR_LEN(stack) - 1);
+			continue;
+		}
+		bool     keep_alive;
+		ir_node *succ = get_dfs_succ(irg, top->block, post, --top->next,
+		                             &keep_alive);
+		if (succ == NULL || Block_block_visited(succ))
+			continue;
+		mark_Block_block_visited(succ);
+
+		int num = g->n++;
+		g->blocks[num]   = succ;
+		g->parent[num]   = top->num;
+		unreachable[num] = unreachable[top->num] || keep_alive;
+		frame_t frame = { succ, get_n_dfs_succs(irg, succ, post), num };
+		ARR_APP1(frame_t, stack, frame);
+	}
+
+	ir_free_resources(irg, IR_RESOURCE_BLOCK_VISITED);
+	DEL_ARR_F(stack);
 }
 
 /**
@@ -497,6 +572,14 @@ static void count_and_init_blocks_dom(ir_node *block, void *env)
 	set_Block_dom_depth(block, -1);
 }
 
+/** Appends @p pred_block to the predecessors of the current node. */
+static void add_dom_pred(dom_graph_t *g, const ir_node *pred_block)
+{
+	int num = get_Block_dom_pre_num(pred_block);
+	if (num != -1)
+		ARR_APP1(int, g->preds, num);
+}
+
 void compute_doms(ir_graph *irg)
 {
 	assert(!irg_is_constrained(irg, IR_GRAPH_CONSTRAINT_CONSTRUCTION));
@@ -509,112 +592,71 @@ void compute_doms(ir_graph *irg)
 	int n_blocks = 0;
 	irg_block_walk_graph(irg, count_and_init_blocks_dom, NULL, &n_blocks);
 
-	/* Memory for temporary information. */
-	tmp_dom_info *tdi_list = XMALLOCN(tmp_dom_info, n_blocks);
-
-	/* this with a standard walker as passing the parent to the sons isn't
-	   simple. */
-	ir_reserve_resources(irg, IR_RESOURCE_BLOCK_VISITED);
-	inc_irg_block_visited(irg);
-	int used = 0;
-	init_tmp_dom_info(get_irg_start_block(irg), NULL, tdi_list, &used, n_blocks);
-	ir_free_resources(irg, IR_RESOURCE_BLOCK_VISITED);
-	/* If not all blocks are reachable from Start by out edges this assertion
-	   fails. */
-	assert(used <= n_blocks);
-	n_blocks = used;
-
-	for (int i = n_blocks; i-- > 1; ) {  /* Don't iterate the root, it's done. */
-		tmp_dom_info  *w     = &tdi_list[i];
-		const ir_node *block = w->block;
+	dom_graph_t g;
+	dom_graph_init(&g, n_blocks);
+	bool *unreachable = XMALLOCN(bool, n_blocks);
+	/* If not all blocks are reachable from Start by out edges the DFS
+	 * misses them. */
+	dfs_number_blocks(irg, get_irg_start_block(irg), false, &g, unreachable);
+	free(unreachable);
+	assert(g.n <= n_blocks);
+	for (int i = 0; i < g.n; ++i)
+		set_Block_dom_pre_num(g.blocks[i], i);
 
-		/* Step 2 */
+	ir_node *end_block = get_irg_end_block(irg);
+	for (int i = 0; i < g.n; ++i) {
+		g.pred_start[i] = (int)ARR_LEN(g.preds);
+		const ir_node *block = g.blocks[i];
 		for (int j = 0, arity = get_irn_arity(block); j < arity; j++) {
-			const ir_node *pred       = get_Block_cfgpred(block, j);
-			const ir_node *pred_block = get_nodes_block(pred);
-
-			if (is_Bad(pred) || get_Block_dom_pre_num(pred_block) == -1)
-				continue;    /* unreachable */
-
-			const tmp_dom_info *u = dom_eval(&tdi_list[get_Block_dom_pre_num(pred_block)]);
-			if (u->semi < w->semi)
-				w->semi = u->semi;
+			const ir_node *pred = get_Block_cfgpred(block, j);
+			if (!is_Bad(pred))
+				add_dom_pred(&g, get_nodes_block(pred));
 		}
 
 		/* handle keep-alives if we are at the end block */
-		if (block == get_irg_end_block(irg)) {
+		if (block == end_block) {
 			foreach_irn_in(get_irg_end(irg), j, pred) {
-				if (!is_Block(pred) || get_Block_dom_pre_num(pred) == -1)
-					continue;   /* unreachable */
-
-				const tmp_dom_info *u = dom_eval(&tdi_list[get_Block_dom_pre_num(pred)]);
-				if (u->semi < w->semi)
-					w->semi = u->semi;
+				if (is_Block(pred))
+					add_dom_pred(&g, pred);
 			}
 		}
-
-		/* Add w to w->semi's bucket.  w is in exactly one bucket, so
-		   buckets can been implemented as linked lists. */
-		w->bucket = w->semi->bucket;
-		w->semi->bucket = w;
-
-		dom_link(w->parent, w);
-
-		/* Step 3 */
-		while (w->parent->bucket) {
-			tmp_dom_info *v = w->parent->bucket;
-			/* remove v from w->parent->bucket */
-			w->parent->bucket = v->bucket;
-			v->bucket         = NULL;
-
-			tmp_dom_info *u = dom_eval(v);
-			if (u->semi < v->semi)
-				v->dom = u;
-			else
-				v->dom = w->parent;
-		}
 	}
-	/* Step 4 */
-	tdi_list[0].dom = NULL;
-	set_Block_idom(tdi_list[0].block, NULL);
-	set_Block_dom_depth(tdi_list[0].block, 1);
-	for (int i = 1; i < n_blocks; i++) {
-		tmp_dom_info *w = &tdi_list[i];
-		if (w->dom == NULL)
-			continue; /* control dead */
+	g.pred_start[g.n] = (int)ARR_LEN(g.preds);
 
-		if (w->dom != w->semi)
-			w->dom = w->dom->dom;
-		set_Block_idom(w->block, w->dom->block);
+	semi_nca(&g);
+
+	set_Block_idom(g.blocks[0], NULL);
+	set_Block_dom_depth(g.blocks[0], 1);
+	for (int i = 1; i < g.n; i++) {
+		ir_node *idom = g.blocks[g.idom[i]];
+		set_Block_idom(g.blocks[i], idom);
+		set_Block_dom_depth(g.blocks[i], get_Block_dom_depth(idom) + 1);
+	}
 
-		/* blocks dominated by dead one's are still dead */
-		int depth = get_Block_dom_depth(w->dom->block);
-		if (depth > 0)
-			++depth;
-		set_Block_dom_depth(w->block, depth);
+	unsigned *tree_pre = XMALLOCN(unsigned, g.n);
+	unsigned *tree_max = XMALLOCN(unsigned, g.n);
+	number_dom_tree(&g, tree_pre, tree_max);
+	for (int i = 0; i < g.n; ++i) {
+		ir_dom_info *info = get_dom_info(g.blocks[i]);
+		info->tree_pre_num        = tree_pre[i];
+		info->max_subtree_pre_num = tree_max[i];
 	}
 
 	/* clean up */
-	free(tdi_list);
+	free(tree_max);
+	free(tree_pre);
+	dom_graph_free(&g);
 
 	add_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
-
-	/* Do a walk over the tree and assign the tree pre orders. */
-	unsigned tree_pre_order = 0;
-	dom_tree_walk(get_irg_start_block(irg), assign_tree_dom_pre_order,
-	              assign_tree_dom_pre_order_max, &tree_pre_order);
 }
 
-static void update_pdom_semi(tmp_dom_info *tdi_list, tmp_dom_info *w,
-                             ir_node *succ_block)
+/** Appends @p succ_block to the predecessors in the reverse graph. */
+static void add_pdom_pred(dom_graph_t *g, ir_node *succ_block)
 {
 	assert(is_Block(succ_block));
-	const int           pre_num = get_Block_postdom_pre_num(succ_block);
+	const int pre_num = get_Block_postdom_pre_num(succ_block);
 	assert(pre_num != -1);
-	const tmp_dom_info *u       = dom_eval(&tdi_list[pre_num]);
-	if (u->semi < w->semi) {
-		w->semi = u->semi;
-	}
+	ARR_APP1(int, g->preds, pre_num);
 }
 
 void compute_postdoms(ir_graph *irg)
@@ -629,82 +671,653 @@ void compute_postdoms(ir_graph *irg)
 	int n_blocks = 0;
 	irg_block_walk_graph(irg, count_and_init_blocks_pdom, NULL, &n_blocks);
 
-	/* memory for temporary information. */
-	tmp_dom_info *tdi_list = XMALLOCN(tmp_dom_info, n_blocks);
-
-	/* this with a standard walker as passing the parent to the sons isn't
-	   simple. */
-	ir_reserve_resources(irg, IR_RESOURCE_BLOCK_VISITED);
-	inc_irg_block_visited(irg);
-	int used = 0;
-	ir_node *end_block = get_irg_end_block(irg);
-	init_tmp_pdom_info(end_block, NULL, tdi_list, &used, n_blocks, 0);
-	ir_free_resources(irg, IR_RESOURCE_BLOCK_VISITED);
-	assert(used <= n_blocks);
-	n_blocks = used;
-
-	for (int i = n_blocks; i-- > 1; ) {  /* Don't iterate the root, it's done. */
-		tmp_dom_info *w = &tdi_list[i];
-
-		/* Step 2 */
-		ir_node  *block       = w->block;
-		bool      unreachable = w->unreachable;
+	dom_graph_t g;
+	dom_graph_init(&g, n_blocks);
+	/* All blocks only reached through keep-alives are in endless loops. We
+	 * treat the keep-alive edges as normal control flow for them. */
+	bool    *unreachable = XMALLOCN(bool, n_blocks);
+	ir_node *end_block   = get_irg_end_block(irg);
+	dfs_number_blocks(irg, end_block, true, &g, unreachable);
+	assert(g.n <= n_blocks);
+	for (int i = 0; i < g.n; ++i)
+		set_Block_postdom_pre_num(g.blocks[i], i);
+
+	for (int i = 0; i < g.n; ++i) {
+		g.pred_start[i] = (int)ARR_LEN(g.preds);
+		ir_node *block = g.blocks[i];
 		foreach_irn_out(block, j, succ) {
 			if (get_irn_mode(succ) != mode_X || is_Bad(succ))
 				continue;
 			if (is_End(succ)) {
-				if (unreachable && end_block != block)
-					/* Handle keep-alive edges to unreachable
-					 * blocks as normal control flow. */
-					update_pdom_semi(tdi_list, w, end_block);
+				if (unreachable[i] && end_block != block)
+					add_pdom_pred(&g, end_block);
 				continue;
 			}
 			foreach_irn_out(succ, k, succ_block) {
-				update_pdom_semi(tdi_list, w, succ_block);
+				add_pdom_pred(&g, succ_block);
 			}
 		}
+	}
+	g.pred_start[g.n] = (int)ARR_LEN(g.preds);
+	free(unreachable);
 
-		/* Add w to w->semi's bucket.  w is in exactly one bucket, so
-		   buckets can be implemented as linked lists. */
-		w->bucket = w->semi->bucket;
-		w->semi->bucket = w;
-
-		dom_link(w->parent, w);
-
-		/* Step 3 */
-		while (w->parent->bucket) {
-			tmp_dom_info *v = w->parent->bucket;
-			/* remove v from w->parent->bucket */
-			w->parent->bucket = v->bucket;
-			v->bucket         = NULL;
-
-			tmp_dom_info *u = dom_eval(v);
-			if (u->semi < v->semi)
-				v->dom = u;
-			else
-				v->dom = w->parent;
-		}
+	semi_nca(&g);
+
+	set_Block_ipostdom(g.blocks[0], NULL);
+	set_Block_postdom_depth(g.blocks[0], 1);
+	for (int i = 1; i < g.n; i++) {
+		ir_node *ipdom = g.blocks[g.idom[i]];
+		set_Block_ipostdom(g.blocks[i], ipdom);
+		set_Block_postdom_depth(g.blocks[i], get_Block_postdom_depth(ipdom) + 1);
 	}
-	/* Step 4 */
-	tdi_list[0].dom = NULL;
-	set_Block_ipostdom(tdi_list[0].block, NULL);
-	set_Block_postdom_depth(tdi_list[0].block, 1);
-	for (int i = 1; i < n_blocks; i++) {
-		tmp_dom_info *w = &tdi_list[i];
 
-		if (w->dom != w->semi)
-			w->dom = w->dom->dom;
-		set_Block_ipostdom(w->block, w->dom->block);
-		set_Block_postdom_depth(w->block, get_Block_postdom_depth(w->dom->block) + 1);
+	unsigned *tree_pre = XMALLOCN(unsigned, g.n);
+	unsigned *tree_max = XMALLOCN(unsigned, g.n);
+	number_dom_tree(&g, tree_pre, tree_max);
+	for (int i = 0; i < g.n; ++i) {
+		ir_dom_info *info = get_pdom_info(g.blocks[i]);
+		info->tree_pre_num        = tree_pre[i];
+		info->max_subtree_pre_num = tree_max[i];
 	}
 
 	/* clean up */
-	free(tdi_list);
+	free(tree_max);
+	free(tree_pre);
+	dom_graph_free(&g);
 
 	add_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_POSTDOMINANCE);
+}
+
+/*
+ * Incremental dominance maintenance.
+ *
+ * Inserting or deleting a CFG edge (a, b) can only change the immediate
+ * dominators of blocks inside the dominator subtree of the nearest common
+ * dominator of a and b. dom_update_subtree() exploits this: it collects the
+ * blocks reachable from the subtree root without leaving the old subtree and
+ * runs a Semi-NCA pass on just that region. Everything outside the region
+ * keeps its dominance information including the tree numbering.
+ */
+
+static bool verify_dom_updates;
+
+void dom_set_verify_updates(int enable)
+{
+	verify_dom_updates = enable;
+}
+
+/** Per-block state of an incremental dominance update. */
+typedef struct upd_block_t {
+	ir_node  *block;
+	ir_node **succs;     /**< successor blocks, NULL if not collected yet */
+	int       dfs_num;   /**< number in the region DFS, -1 if not reached */
+	int       parent;    /**< dfs number of the DFS tree parent */
+	int       idom;      /**< dfs number of the immediate dominator */
+} upd_block_t;
+
+typedef struct upd_env_t {
+	ir_graph        *irg;
+	ir_node         *root;
+	struct obstack   obst;
+	ir_nodehashmap_t infos;
+	bool             use_edges;  /**< use block out edges to find successors */
+	upd_block_t    **order;      /**< region blocks in DFS preorder */
+	upd_block_t    **members;    /**< blocks of the old subtree below root */
+	dom_graph_t     *graph;      /**< region graph while computing idoms */
+} upd_env_t;
+
+/** Position of a block relative to the subtree being updated. */
+typedef enum upd_class_t {
+	UPD_INSIDE,       /**< in the old subtree of root or created since */
+	UPD_OUTSIDE,      /**< reachable but not dominated by root */
+	UPD_UNREACHABLE,  /**< was unreachable before the update */
+} upd_class_t;
+
+/** Accesses dominance info of blocks that may already have been exchanged. */
+static ir_dom_info *get_dom_info_raw(ir_node *node)
+{
+	return &node->attr.block.dom;
+}
+
+static upd_block_t *get_upd_block(upd_env_t *env, ir_node *block)
+{
+	upd_block_t *info = ir_nodehashmap_get(upd_block_t, &env->infos, block);
+	if (info == NULL) {
+		info = OALLOCZ(&env->obst, upd_block_t);
+		info->block   = block;
+		info->dfs_num = -1;
+		ir_nodehashmap_insert(&env->infos, block, info);
+	}
+	return info;
+}
+
+static upd_class_t classify_block(const upd_env_t *env, const ir_node *block)
+{
+	int depth = get_dom_info_const(block)->dom_depth;
+	if (depth < 0)
+		return UPD_UNREACHABLE;
+	/* blocks created after the last dominance computation have zeroed info */
+	if (depth == 0)
+		return UPD_INSIDE;
+	return block_dominates(env->root, block) ? UPD_INSIDE : UPD_OUTSIDE;
+}
+
+static void add_succ(upd_env_t *env, ir_node *pred_block, ir_node *block)
+{
+	upd_block_t *info = get_upd_block(env, pred_block);
+	if (info->succs == NULL)
+		info->succs = NEW_ARR_F(ir_node*, 0);
+	ARR_APP1(ir_node*, info->succs, block);
+}
+
+/** Block walker collecting successor lists if no block edges are available. */
+static void collect_succs(ir_node *block, void *data)
+{
+	upd_env_t *env = (upd_env_t*)data;
+	for (int i = 0, arity = get_Block_n_cfgpreds(block); i < arity; ++i) {
+		ir_node *pred = get_Block_cfgpred(block, i);
+		if (is_Bad(pred))
+			continue;
+		add_succ(env, get_nodes_block(pred), block);
+	}
+	if (block == get_irg_end_block(env->irg)) {
+		foreach_irn_in(get_irg_end(env->irg), i, kept) {
+			if (is_Block(kept))
+				add_succ(env, kept, block);
+		}
+	}
+}
+
+static ir_node **get_succs(upd_env_t *env, upd_block_t *info)
+{
+	if (info->succs != NULL || !env->use_edges)
+		return info->succs;
+
+	info->succs = NEW_ARR_F(ir_node*, 0);
+	foreach_block_succ(info->block, edge) {
+		ARR_APP1(ir_node*, info->succs, get_edge_src_irn(edge));
+	}
+	ir_node *end = get_irg_end(env->irg);
+	foreach_irn_in(end, i, kept) {
+		if (kept == info->block)
+			ARR_APP1(ir_node*, info->succs, get_irg_end_block(env->irg));
+	}
+	return info->succs;
+}
+
+/** Calls @p func for every predecessor block of @p block. Returns false if
+ * @p func asked to abort. */
+typedef bool (*pred_func)(upd_env_t *env, upd_block_t *info, ir_node *pred);
+
+static bool foreach_pred_block(upd_env_t *env, upd_block_t *info,
+                               pred_func func)
+{
+	ir_node *block = info->block;
+	for (int i = 0, arity = get_Block_n_cfgpreds(block); i < arity; ++i) {
+		ir_node *pred = get_Block_cfgpred(block, i);
+		if (is_Bad(pred))
+			continue;
+		if (!func(env, info, get_nodes_block(pred)))
+			return false;
+	}
+	if (block == get_irg_end_block(env->irg)) {
+		foreach_irn_in(get_irg_end(env->irg), i, kept) {
+			if (is_Block(kept) && !func(env, info, kept))
+				return false;
+		}
+	}
+	return true;
+}
 
-	/* Do a walk over the tree and assign the tree pre orders. */
-	unsigned tree_pre_order = 0;
-	postdom_tree_walk(get_irg_end_block(irg), assign_tree_postdom_pre_order,
-	                  assign_tree_postdom_pre_order_max, &tree_pre_order);
+/** Collects the blocks of the old dominator subtree below root. Blocks which
+ * have been exchanged in the meantime are skipped but their children are
+ * still visited. */
+static void collect_members(upd_env_t *env)
+{
+	ir_node **stack = NEW_ARR_F(ir_node*, 0);
+	ARR_APP1(ir_node*, stack, env->root);
+	while (ARR_LEN(stack) > 0) {
+		ir_node *node = stack[ARR_LEN(stack) - 1];
+		ARR_SHRINKLEN(stack, ARR_LEN(stack) - 1);
+		for (ir_node *c = get_dom_info_raw(node)->first; c != NULL;
+		     c = get_dom_info_raw(c)->next) {
+			if (is_Block(c))
+				ARR_APP1(upd_block_t*, env->members, get_upd_block(env, c));
+			ARR_APP1(ir_node*, stack, c);
+		}
+	}
+	DEL_ARR_F(stack);
+}
+
+/** Numbers the blocks reachable from root without leaving the subtree in DFS
+ * preorder. Returns false if a formerly unreachable block became reachable. */
+static bool number_region(upd_env_t *env)
+{
+	typedef struct frame_t {
+		upd_block_t *info;
+		size_t       next_succ;
+	} frame_t;
+	frame_t *stack = NEW_ARR_F(frame_t, 0);
+
+	upd_block_t *root = get_upd_block(env, env->root);
+	root->dfs_num = 0;
+	root->parent  = -1;
+	ARR_APP1(upd_block_t*, env->order, root);
+	ARR_APP1(frame_t, stack, ((frame_t) { root, 0 }));
+
+	bool ok = true;
+	while (ok && ARR_LEN(stack) > 0) {
+		frame_t  *top   = &stack[ARR_LEN(stack) - 1];
+		ir_node **succs = get_succs(env, top->info);
+		size_t    n     = succs != NULL ? ARR_LEN(succs) : 0;
+		if (top->next_succ >= n) {
+			ARR_SHRINKLEN(stack, ARR_LEN(stack) - 1);
+			continue;
+		}
+
+		ir_node     *succ = succs[top->next_succ++];
+		upd_block_t *info = get_upd_block(env, succ);
+		if (info->dfs_num >= 0)
+			continue;
+		switch (classify_block(env, succ)) {
+		case UPD_OUTSIDE:
+			continue;
+		case UPD_UNREACHABLE:
+			ok = false;
+			continue;
+		case UPD_INSIDE:
+			break;
+		}
+		info->dfs_num = (int)ARR_LEN(env->order);
+		info->parent  = top->info->dfs_num;
+		ARR_APP1(upd_block_t*, env->order, info);
+		ARR_APP1(frame_t, stack, ((frame_t) { info, 0 }));
+	}
+	DEL_ARR_F(stack);
+	return ok;
+}
+
+static bool check_dead_pred(upd_env_t *env, upd_block_t *info, ir_node *pred)
+{
+	(void)info;
+	return classify_block(env, pred) != UPD_OUTSIDE;
+}
+
+/** Checks that subtree blocks which are not reached from root anymore are
+ * really dead and were only connected to the rest of the graph through the
+ * region. */
+static bool check_dead_members(upd_env_t *env)
+{
+	for (size_t i = 0, n = ARR_LEN(env->members); i < n; ++i) {
+		upd_block_t *info = env->members[i];
+		if (info->dfs_num >= 0)
+			continue;
+		if (!foreach_pred_block(env, info, check_dead_pred))
+			return false;
+		ir_node **succs = get_succs(env, info);
+		for (size_t s = 0, n_succs = succs != NULL ? ARR_LEN(succs) : 0;
+		     s < n_succs; ++s) {
+			if (classify_block(env, succs[s]) == UPD_OUTSIDE)
+				return false;
+		}
+	}
+	return true;
+}
+
+static bool add_region_pred(upd_env_t *env, upd_block_t *info, ir_node *pred)
+{
+	(void)info;
+	upd_block_t *pred_info = ir_nodehashmap_get(upd_block_t, &env->infos, pred);
+	if (pred_info == NULL || pred_info->dfs_num < 0) {
+		/* dead preds do not matter, preds from outside the region may only
+		 * enter through root */
+		return classify_block(env, pred) != UPD_OUTSIDE;
+	}
+	ARR_APP1(int, env->graph->preds, pred_info->dfs_num);
+	return true;
+}
+
+/** Semi-NCA on the numbered region. Returns false if a block of the region is
+ * entered from outside the subtree. */
+static bool compute_region_idoms(upd_env_t *env)
+{
+	int         n = (int)ARR_LEN(env->order);
+	dom_graph_t g;
+	dom_graph_init(&g, n);
+	g.n        = n;
+	env->graph = &g;
+
+	bool ok = true;
+	for (int i = 0; i < n && ok; ++i) {
+		upd_block_t *info = env->order[i];
+		g.blocks[i]     = info->block;
+		g.parent[i]     = info->parent;
+		g.pred_start[i] = (int)ARR_LEN(g.preds);
+		/* the root is the only block which may be entered from outside */
+		if (i > 0)
+			ok = foreach_pred_block(env, info, add_region_pred);
+	}
+	if (ok) {
+		g.pred_start[n] = (int)ARR_LEN(g.preds);
+		semi_nca(&g);
+		for (int i = 0; i < n; ++i)
+			env->order[i]->idom = g.idom[i];
+	}
+
+	env->graph = NULL;
+	dom_graph_free(&g);
+	return ok;
+}
+
+static void clear_block_dom(ir_node *block)
+{
+	memset(get_dom_info(block), 0, sizeof(ir_dom_info));
+	set_Block_dom_pre_num(block, -1);
+	set_Block_dom_depth(block, -1);
+}
+
+static void renumber_dom_tree(ir_graph *irg)
+{
+	unsigned num = 0;
+	dom_tree_walk(get_irg_start_block(irg), assign_tree_dom_pre_order,
+	              assign_tree_dom_pre_order_max, &num);
+}
+
+/** Removes @p block from the child list of its immediate dominator. */
+static void unlink_dom_child(ir_node *block)
+{
+	ir_dom_info *info      = get_dom_info(block);
+	ir_dom_info *idom_info = get_dom_info(info->idom);
+	for (ir_node **p = &idom_info->first; *p != NULL;
+	     p = &get_dom_info(*p)->next) {
+		if (*p == block) {
+			*p = info->next;
+			break;
+		}
+	}
+	info->next = NULL;
+}
+
+/**
+ * The End block has no successors, so its immediate dominator is simply the
+ * deepest common dominator of its predecessors and kept blocks. Returns true
+ * if it changed.
+ */
+static bool update_end_idom(ir_graph *irg)
+{
+	ir_node *end_block = get_irg_end_block(irg);
+	ir_node *idom      = NULL;
+	for (int i = 0, arity = get_Block_n_cfgpreds(end_block); i < arity; ++i) {
+		ir_node *pred = get_Block_cfgpred(end_block, i);
+		if (is_Bad(pred))
+			continue;
+		ir_node *pred_block = get_nodes_block(pred);
+		if (get_Block_dom_depth(pred_block) <= 0)
+			continue;
+		idom = idom == NULL ? pred_block
+		                    : ir_deepest_common_dominator(idom, pred_block);
+	}
+	foreach_irn_in(get_irg_end(irg), i, kept) {
+		if (!is_Block(kept) || kept == end_block
+		    || get_Block_dom_depth(kept) <= 0)
+			continue;
+		idom = idom == NULL ? kept : ir_deepest_common_dominator(idom, kept);
+	}
+
+	ir_dom_info *info = get_dom_info(end_block);
+	if (idom == info->idom)
+		return false;
+	if (info->idom != NULL)
+		unlink_dom_child(end_block);
+	if (idom == NULL) {
+		clear_block_dom(end_block);
+	} else {
+		set_Block_idom(end_block, idom);
+		set_Block_dom_depth(end_block, get_Block_dom_depth(idom) + 1);
+	}
+	return true;
+}
+
+/** Writes the computed region back into the block dominance info. */
+static void apply_region(upd_env_t *env)
+{
+	ir_node     *root      = env->root;
+	ir_dom_info *root_info = get_dom_info(root);
+	root_info->first = NULL;
+	for (size_t i = 0, n = ARR_LEN(env->members); i < n; ++i) {
+		upd_block_t *info = env->members[i];
+		if (info->dfs_num < 0)
+			clear_block_dom(info->block);
+		else
+			get_dom_info(info->block)->first = NULL;
+	}
+
+	size_t n = ARR_LEN(env->order);
+	for (size_t i = 1; i < n; ++i) {
+		upd_block_t *info  = env->order[i];
+		ir_node     *block = info->block;
+		ir_node     *idom  = env->order[info->idom]->block;
+		set_Block_idom(block, idom);
+		set_Block_dom_depth(block, get_Block_dom_depth(idom) + 1);
+	}
+
+	/* Renumber the subtree in place if it still fits into its old interval,
+	 * otherwise renumber the whole tree. */
+	unsigned first = root_info->tree_pre_num;
+	unsigned max   = root_info->max_subtree_pre_num;
+	if (n <= max - first + 1) {
+		unsigned num = first;
+		dom_tree_walk(root, assign_tree_dom_pre_order,
+		              assign_tree_dom_pre_order_max, &num);
+		root_info->max_subtree_pre_num = max;
+	} else {
+		renumber_dom_tree(env->irg);
+	}
+
+	/* Keep-alive edges added inside the region may have changed the
+	 * dominator of the End block even if it lies outside. */
+	ir_node *end_block = get_irg_end_block(env->irg);
+	upd_block_t *end_info
+		= ir_nodehashmap_get(upd_block_t, &env->infos, end_block);
+	if ((end_info == NULL || end_info->dfs_num < 0) && update_end_idom(env->irg))
+		renumber_dom_tree(env->irg);
+}
+
+typedef struct dom_snapshot_t {
+	ir_node *block;
+	ir_node *idom;
+	int      depth;
+	unsigned tree_pre_num;
+	unsigned max_subtree_pre_num;
+} dom_snapshot_t;
+
+static void snapshot_block(ir_node *block, void *data)
+{
+	dom_snapshot_t **snapshot = (dom_snapshot_t**)data;
+	const ir_dom_info *info = get_dom_info_const(block);
+	dom_snapshot_t entry = {
+		block, info->idom, info->dom_depth, info->tree_pre_num,
+		info->max_subtree_pre_num
+	};
+	ARR_APP1(dom_snapshot_t, *snapshot, entry);
+}
+
+/** Answers block_dominates() from the maintained tree numbering. */
+static bool snapshot_dominates(const dom_snapshot_t *a,
+                               const dom_snapshot_t *b)
+{
+	return a->tree_pre_num <= b->tree_pre_num
+	    && b->tree_pre_num <= a->max_subtree_pre_num;
+}
+
+static void recompute_doms(ir_graph *irg)
+{
+	/* outs are not maintained by the CFG transformations using this */
+	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
+	compute_doms(irg);
+}
+
+/** Compares the maintained dominance info against a full recomputation. The
+ * tree numbers may legitimately differ, so the intervals are compared by the
+ * dominance relation they encode. */
+static void verify_dom_update(ir_graph *irg)
+{
+	dom_snapshot_t *snapshot = NEW_ARR_F(dom_snapshot_t, 0);
+	irg_block_walk_graph(irg, snapshot_block, NULL, &snapshot);
+	recompute_doms(irg);
+	size_t n = ARR_LEN(snapshot);
+	for (size_t i = 0; i < n; ++i) {
+		const dom_snapshot_t *entry = &snapshot[i];
+		const ir_dom_info    *info  = get_dom_info_const(entry->block);
+		bool reachable     = info->dom_depth > 0;
+		bool was_reachable = entry->depth > 0;
+		if (reachable != was_reachable
+		    || (reachable && (info->idom != entry->idom
+		                      || info->dom_depth != entry->depth)))
+			panic("incremental dominance update of %+F is wrong at %+F",
+			      irg, entry->block);
+	}
+	for (size_t i = 0; i < n; ++i) {
+		const dom_snapshot_t *a = &snapshot[i];
+		if (a->depth <= 0)
+			continue;
+		for (size_t j = 0; j < n; ++j) {
+			const dom_snapshot_t *b = &snapshot[j];
+			if (b->depth <= 0)
+				continue;
+			bool dominates = block_dominates(a->block, b->block);
+			if (snapshot_dominates(a, b) != dominates)
+				panic("incremental dominance update of %+F misnumbers %+F and %+F",
+				      irg, a->block, b->block);
+		}
+	}
+	DEL_ARR_F(snapshot);
+}
+
+static void free_upd_env(upd_env_t *env)
+{
+	ir_nodehashmap_entry_t    entry;
+	ir_nodehashmap_iterator_t iter;
+	foreach_ir_nodehashmap(&env->infos, entry, iter) {
+		upd_block_t *info = (upd_block_t*)entry.data;
+		if (info->succs != NULL)
+			DEL_ARR_F(info->succs);
+	}
+	ir_nodehashmap_destroy(&env->infos);
+	DEL_ARR_F(env->order);
+	DEL_ARR_F(env->members);
+	obstack_free(&env->obst, NULL);
+}
+
+void dom_update_subtree(ir_node *root)
+{
+	ir_graph *irg = get_irn_irg(root);
+	assert(irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE));
+
+	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE_FRONTIERS);
+	ir_free_dominance_frontiers(irg);
+
+	if (!is_Block(root) || get_Block_dom_depth(root) <= 0) {
+		recompute_doms(irg);
+		return;
+	}
+
+	upd_env_t env;
+	env.irg       = irg;
+	env.root      = root;
+	env.use_edges = edges_activated_kind(irg, EDGE_KIND_BLOCK);
+	env.order     = NEW_ARR_F(upd_block_t*, 0);
+	env.members   = NEW_ARR_F(upd_block_t*, 0);
+	env.graph     = NULL;
+	obstack_init(&env.obst);
+	ir_nodehashmap_init(&env.infos);
+
+	if (!env.use_edges)
+		irg_block_walk_graph(irg, collect_succs, NULL, &env);
+
+	collect_members(&env);
+	bool ok = number_region(&env)
+	       && check_dead_members(&env)
+	       && compute_region_idoms(&env);
+	if (ok)
+		apply_region(&env);
+	free_upd_env(&env);
+
+	if (!ok) {
+		/* The caller changed edges outside the subtree or made dead code
+		 * reachable again: fall back to a full recomputation. */
+		recompute_doms(irg);
+	} else if (verify_dom_updates) {
+		verify_dom_update(irg);
+	}
+}
+
+/** Returns the root of the subtree affected by a change of edge (from, to),
+ * or NULL if the whole tree must be recomputed. */
+static ir_node *get_edge_update_root(ir_node *from, ir_node *to)
+{
+	if (get_Block_dom_depth(from) <= 0 || get_Block_dom_depth(to) <= 0)
+		return NULL;
+	return ir_deepest_common_dominator(from, to);
+}
+
+void dom_insert_edge(ir_node *from, ir_node *to)
+{
+	/* an edge out of dead code changes nothing */
+	if (get_Block_dom_depth(from) < 0)
+		return;
+	ir_node *root = get_edge_update_root(from, to);
+	if (root != NULL)
+		dom_update_subtree(root);
+	else
+		recompute_doms(get_irn_irg(from));
+}
+
+void dom_delete_edge(ir_node *from, ir_node *to)
+{
+	if (get_Block_dom_depth(from) < 0)
+		return;
+	ir_node *root = get_edge_update_root(from, to);
+	if (root != NULL)
+		dom_update_subtree(root);
+	else
+		recompute_doms(get_irn_irg(from));
+}
+
+void dom_remove_block(ir_node *block)
+{
+	ir_dom_info *info = get_dom_info(block);
+	ir_node     *idom = info->idom;
+	/* unreachable blocks are not part of the tree */
+	if (idom == NULL) {
+		assert(info->first == NULL);
+		return;
+	}
+
+	unlink_dom_child(block);
+	/* The children keep their tree numbers: their intervals are nested in
+	 * the interval of idom anyway. */
+	for (ir_node *child = info->first, *next; child != NULL; child = next) {
+		next = get_dom_info(child)->next;
+		set_Block_idom(child, idom);
+	}
+	clear_block_dom(block);
+}
+
+static void update_depth_and_number(ir_node *block, void *data)
+{
+	ir_node *idom = get_dom_info(block)->idom;
+	if (idom != NULL)
+		set_Block_dom_depth(block, get_Block_dom_depth(idom) + 1);
+	assign_tree_dom_pre_order(block, data);
+}
+
+void dom_repair_tree(ir_graph *irg)
+{
+	update_end_idom(irg);
+	unsigned num = 0;
+	dom_tree_walk_irg(irg, update_depth_and_number, assign_tree_dom_pre_order_max,
+	                  &num);
+	if (verify_dom_updates)
+		verify_dom_update(irg);
 }
@@ -57,6 +57,21 @@ unsigned get_Block_pdom_max_subtree_pre_num(const ir_node *bl);
 
 void ir_free_dominance_frontiers(ir_graph *irg);
 
+/**
+ * Removes @p block from the dominator tree, its children are attached to its
+ * immediate dominator. This is correct if the block is merged into its only
+ * successor or its only predecessor. The dominator depths below the block are
+ * stale until dom_repair_tree() is called.
+ */
+void dom_remove_block(ir_node *block);
+
+/**
+ * Recomputes the dominator tree depths and numbering after dom_remove_block()
+ * calls. Also updates the dominator of the End block which can change when
+ * kept blocks are merged.
+ */
+void dom_repair_tree(ir_graph *irg);
+
 /**
  * Iterate over all nodes which are immediately dominated by a given
  * node.
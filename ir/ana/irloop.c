@@ -79,7 +79,11 @@ loop_element get_loop_element(const ir_loop *loop, size_t pos)
 
 void set_irn_loop(ir_node *n, ir_loop *loop)
 {
+#ifdef FIRM_COMPACT_NODES
+	get_irn_cold(n)->loop = loop;
+#else
 	n->loop = loop;
+#endif
 }
 
 ir_loop *(get_irn_loop)(const ir_node *n)
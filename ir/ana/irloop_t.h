@@ -107,7 +107,11 @@ static inline unsigned _get_loop_depth(const ir_loop *loop)
 /* Uses temporary information to get the loop */
 static inline ir_loop *_get_irn_loop(const ir_node *n)
 {
+#ifdef FIRM_COMPACT_NODES
+	return get_irn_cold(n)->loop;
+#else
 	return n->loop;
+#endif
 }
 
 #endif
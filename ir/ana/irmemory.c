@@ -19,13 +19,17 @@
 #include "irgraph_t.h"
 #include "irgwalk.h"
 #include "irnode_t.h"
+#include "irnodemap.h"
 #include "irouts_t.h"
 #include "irprintf.h"
 #include "irprog_t.h"
 #include "panic.h"
+#include "set.h"
+#include "statev_t.h"
 #include "type_t.h"
 #include "typerep.h"
 #include "util.h"
+#include "xmalloc.h"
 #include <stdbool.h>
 #include <stdlib.h>
 
@@ -294,13 +298,41 @@ follow_ptr:
 	}
 }
 
-static ir_alias_relation _get_alias_relation(const ir_node *addr1, const ir_type *const objt1, unsigned size1,
-                                             const ir_node *addr2, const ir_type *const objt2, unsigned size2)
+/**
+ * Everything the disambiguator needs to know about a single address.
+ */
+typedef struct alias_addr_info {
+	address_info             info;  /**< the address as base plus offsets */
+	ir_node const           *base;  /**< the base without Sels/Members */
+	ir_entity               *ent;   /**< the outermost selected member */
+	ir_storage_class_class_t mod;   /**< storage class of the address */
+} alias_addr_info;
+
+static alias_addr_info get_alias_addr_info(ir_node const *const addr)
+{
+	alias_addr_info res;
+	res.info = get_address_info(addr);
+	res.ent  = NULL;
+	res.base = find_base_addr(res.info.base, &res.ent);
+	res.mod  = classify_pointer(res.info.base, res.base);
+	return res;
+}
+
+ir_entity *get_nottaken_entity(ir_node const *const addr)
+{
+	alias_addr_info const info = get_alias_addr_info(addr);
+	if (!(info.mod & ir_sc_modifier_nottaken))
+		return NULL;
+	return is_Address(info.base) ? get_Address_entity(info.base)
+	                             : get_Member_entity(info.base);
+}
+
+static ir_alias_relation _get_alias_relation(
+		alias_addr_info const *const adr1, const ir_type *const objt1,
+		unsigned const size1, alias_addr_info const *const adr2,
+		const ir_type *const objt2, unsigned const size2,
+		unsigned const options)
 {
-	if (addr1 == addr2)
-		return ir_sure_alias;
-	ir_graph *const irg     = get_irn_irg(addr1);
-	unsigned  const options = get_irg_memory_disambiguator_options(irg);
 	if (options & aa_opt_always_alias)
 		return ir_may_alias;
 	/* The Armageddon switch */
@@ -315,16 +347,15 @@ static ir_alias_relation _get_alias_relation(const ir_node *addr1, const ir_type
 	 * offset can be handled.  To extend this, change
 	 * sym_offset to be a set, and compare the sets.
 	 */
-	address_info const info1   = get_address_info(addr1);
-	address_info const info2   = get_address_info(addr2);
-	long               offset1 = info1.offset;
-	long               offset2 = info2.offset;
-	addr1 = info1.base;
-	addr2 = info2.base;
+	address_info const *const info1   = &adr1->info;
+	address_info const *const info2   = &adr2->info;
+	long                      offset1 = info1->offset;
+	long                      offset2 = info2->offset;
 
 	/* same base address -> compare offsets if possible.
 	 * FIXME: type long is not sufficient for this task ... */
-	if (addr1 == addr2 && info1.sym_offset == info2.sym_offset && info1.has_const_offset && info2.has_const_offset) {
+	if (info1->base == info2->base && info1->sym_offset == info2->sym_offset
+	    && info1->has_const_offset && info2->has_const_offset) {
 		unsigned long first_offset;
 		unsigned long last_offset;
 		unsigned first_size;
@@ -344,10 +375,10 @@ static ir_alias_relation _get_alias_relation(const ir_node *addr1, const ir_type
 	}
 
 	/* skip Sels/Members */
-	ir_entity     *ent1  = NULL;
-	ir_entity     *ent2  = NULL;
-	const ir_node *base1 = find_base_addr(addr1, &ent1);
-	const ir_node *base2 = find_base_addr(addr2, &ent2);
+	ir_entity     *ent1  = adr1->ent;
+	ir_entity     *ent2  = adr2->ent;
+	const ir_node *base1 = adr1->base;
+	const ir_node *base2 = adr2->base;
 
 	/* two struct accesses -> compare entities */
 	if (ent1 != NULL && ent2 != NULL) {
@@ -380,8 +411,8 @@ static ir_alias_relation _get_alias_relation(const ir_node *addr1, const ir_type
 
 check_classes:;
 	/* no alias if 1 is a primitive object and the other a compound object */
-	const ir_storage_class_class_t mod1 = classify_pointer(addr1, base1);
-	const ir_storage_class_class_t mod2 = classify_pointer(addr2, base2);
+	const ir_storage_class_class_t mod1 = adr1->mod;
+	const ir_storage_class_class_t mod2 = adr2->mod;
 	if (((mod1 | mod2) & (ir_sc_modifier_obj_comp | ir_sc_modifier_obj_prim))
 	    == (ir_sc_modifier_obj_comp | ir_sc_modifier_obj_prim))
 		return ir_no_alias;
@@ -474,10 +505,217 @@ leave_type_based_alias:;
 	return ir_may_alias;
 }
 
+/**
+ * Refines a may alias result of the local disambiguation with the
+ * whole-program points-to sets.
+ */
+static ir_alias_relation refine_alias_relation(
+		ir_alias_relation const rel, const ir_node *const addr1,
+		unsigned const size1, const ir_node *const addr2, unsigned const size2,
+		unsigned const options)
+{
+	if (rel != ir_may_alias || (options & aa_opt_always_alias))
+		return rel;
+	return get_points_to_relation(addr1, size1, addr2, size2);
+}
+
+/**
+ * The alias oracle of a graph. It caches the decomposed addresses and the
+ * results of alias queries as long as
+ * IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_ORACLE is set. Passes like
+ * optimize_load_store() exchange nodes while the oracle is in use: Node
+ * indices are not reused, so the entries of an exchanged node are merely
+ * unreachable, but exchanging an address invalidates the whole cache, as
+ * cached decompositions of other addresses may use it as their base. This
+ * only starts a new generation, entries of older generations are recomputed
+ * when they are used again.
+ */
+typedef struct ir_alias_oracle {
+	struct obstack     obst;       /**< obstack for the address infos */
+	ir_nodemap         addresses;  /**< cached_addr_info of each address */
+	set               *relations;  /**< memoized alias_query results */
+	unsigned           generation; /**< current generation of the cache */
+	unsigned long long n_queries;  /**< number of queries */
+	unsigned long long n_hits;     /**< number of queries answered by memo */
+} ir_alias_oracle;
+
+/** A decomposed address in the alias oracle. */
+typedef struct cached_addr_info {
+	alias_addr_info info;
+	unsigned        generation; /**< generation the info was computed in */
+} cached_addr_info;
+
+/** A memoized alias query. The first address has the smaller node index. */
+typedef struct alias_query {
+	ir_type const    *type1;
+	ir_type const    *type2;
+	unsigned          idx1;
+	unsigned          idx2;
+	unsigned          size1;
+	unsigned          size2;
+	unsigned          options;
+	ir_alias_relation rel;        /**< the result, not part of the key */
+	unsigned          generation; /**< generation of rel, not part of the key */
+} alias_query;
+
+static int cmp_alias_query(void const *const elt, void const *const key,
+                           size_t const size)
+{
+	(void)size;
+	alias_query const *const q1 = (alias_query const*)elt;
+	alias_query const *const q2 = (alias_query const*)key;
+	return q1->type1 != q2->type1 || q1->type2 != q2->type2
+	    || q1->idx1 != q2->idx1 || q1->idx2 != q2->idx2
+	    || q1->size1 != q2->size1 || q1->size2 != q2->size2
+	    || q1->options != q2->options;
+}
+
+static unsigned hash_alias_query(alias_query const *const query)
+{
+	unsigned hash = hash_combine(hash_ptr(query->type1),
+	                             hash_ptr(query->type2));
+	hash = hash_combine(hash, query->idx1 * 0x9E3779B1U ^ query->idx2);
+	hash = hash_combine(hash, query->size1 << 16 ^ query->size2);
+	return hash_combine(hash, query->options);
+}
+
+static alias_addr_info const *get_cached_addr_info(ir_alias_oracle *const oracle,
+                                                   ir_node const *const addr)
+{
+	cached_addr_info *info
+		= ir_nodemap_get(cached_addr_info, &oracle->addresses, addr);
+	if (info == NULL) {
+		info = OALLOC(&oracle->obst, cached_addr_info);
+		ir_nodemap_insert(&oracle->addresses, addr, info);
+	} else if (info->generation == oracle->generation) {
+		return &info->info;
+	}
+	info->info       = get_alias_addr_info(addr);
+	info->generation = oracle->generation;
+	return &info->info;
+}
+
+void ir_compute_alias_oracle(ir_graph *const irg)
+{
+	ir_free_alias_oracle(irg);
+
+	ir_alias_oracle *const oracle = XMALLOCZ(ir_alias_oracle);
+	obstack_init(&oracle->obst);
+	ir_nodemap_init(&oracle->addresses, irg);
+	oracle->relations = new_set(cmp_alias_query, 64);
+	irg->alias_oracle = oracle;
+
+	add_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_ORACLE);
+}
+
+void ir_alias_oracle_exchanged(ir_graph *const irg, ir_node const *const old)
+{
+	/* A replaced integer only turns an offset into another expression for
+	 * the same value, so the cached relations stay true. A replaced address
+	 * may be the base of cached decompositions, which compare bases by
+	 * identity and would consider the old and the new base distinct. */
+	if (!mode_is_reference(get_irn_mode(old)))
+		return;
+	if (!irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_ORACLE))
+		return;
+	++irg->alias_oracle->generation;
+}
+
+void ir_free_alias_oracle(ir_graph *const irg)
+{
+	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_ORACLE);
+
+	ir_alias_oracle *const oracle = irg->alias_oracle;
+	if (oracle == NULL)
+		return;
+
+	if (stat_ev_enabled && oracle->n_queries > 0) {
+		stat_ev_ull("alias_oracle_queries", oracle->n_queries);
+		stat_ev_ull("alias_oracle_hits", oracle->n_hits);
+		stat_ev_dbl("alias_oracle_hit_rate",
+		            (double)oracle->n_hits / oracle->n_queries);
+	}
+
+	del_set(oracle->relations);
+	ir_nodemap_destroy(&oracle->addresses);
+	obstack_free(&oracle->obst, NULL);
+	free(oracle);
+	irg->alias_oracle = NULL;
+}
+
+/**
+ * Answers an alias query with the alias oracle. The relation is symmetric, so
+ * both orders of the addresses share one memo entry.
+ */
+static ir_alias_relation query_alias_oracle(
+		ir_alias_oracle *const oracle, const ir_node *addr1,
+		const ir_type *type1, unsigned size1, const ir_node *addr2,
+		const ir_type *type2, unsigned size2, unsigned const options)
+{
+	if (get_irn_idx(addr1) > get_irn_idx(addr2)) {
+		const ir_node *const addr = addr1;
+		const ir_type *const type = type1;
+		unsigned       const size = size1;
+		addr1 = addr2;
+		type1 = type2;
+		size1 = size2;
+		addr2 = addr;
+		type2 = type;
+		size2 = size;
+	}
+
+	alias_query key = {
+		.type1   = type1,
+		.type2   = type2,
+		.idx1    = get_irn_idx(addr1),
+		.idx2    = get_irn_idx(addr2),
+		.size1   = size1,
+		.size2   = size2,
+		.options = options,
+	};
+	unsigned const hash = hash_alias_query(&key);
+	++oracle->n_queries;
+	alias_query *found
+		= set_find(alias_query, oracle->relations, &key, sizeof(key), hash);
+	if (found != NULL && found->generation == oracle->generation) {
+		++oracle->n_hits;
+		return found->rel;
+	}
+
+	alias_addr_info const *const adr1 = get_cached_addr_info(oracle, addr1);
+	alias_addr_info const *const adr2 = get_cached_addr_info(oracle, addr2);
+	ir_alias_relation rel = _get_alias_relation(adr1, type1, size1, adr2,
+	                                            type2, size2, options);
+	rel = refine_alias_relation(rel, addr1, size1, addr2, size2, options);
+	if (found == NULL)
+		found = set_insert(alias_query, oracle->relations, &key, sizeof(key),
+		                   hash);
+	found->rel        = rel;
+	found->generation = oracle->generation;
+	return rel;
+}
+
 ir_alias_relation get_alias_relation(const ir_node *const addr1, const ir_type *const type1, unsigned size1,
                                      const ir_node *const addr2, const ir_type *const type2, unsigned size2)
 {
-	ir_alias_relation rel = _get_alias_relation(addr1, type1, size1, addr2, type2, size2);
+	ir_alias_relation rel;
+	if (addr1 == addr2) {
+		rel = ir_sure_alias;
+	} else {
+		ir_graph *const irg     = get_irn_irg(addr1);
+		unsigned  const options = get_irg_memory_disambiguator_options(irg);
+		if (irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_ORACLE)) {
+			rel = query_alias_oracle(irg->alias_oracle, addr1, type1, size1,
+			                         addr2, type2, size2, options);
+		} else {
+			alias_addr_info const adr1 = get_alias_addr_info(addr1);
+			alias_addr_info const adr2 = get_alias_addr_info(addr2);
+			rel = _get_alias_relation(&adr1, type1, size1, &adr2, type2, size2,
+			                          options);
+			rel = refine_alias_relation(rel, addr1, size1, addr2, size2,
+			                            options);
+		}
+	}
 	DB((dbg, LEVEL_1, "alias(%+F, %+F) = %s\n", addr1, addr2,
 	    get_ir_alias_relation_name(rel)));
 	return rel;
@@ -668,8 +906,10 @@ static void analyse_irg_entity_usage(ir_graph *irg)
 
 void assure_irg_entity_usage_computed(ir_graph *irg)
 {
-	if (irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE))
+	if (irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE)) {
+		irg_count_assure_hits(IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE);
 		return;
+	}
 
 	analyse_irg_entity_usage(irg);
 }
@@ -732,6 +972,7 @@ static void check_initializer_nodes(ir_initializer_t *initializer)
 	}
 	case IR_INITIALIZER_TARVAL:
 	case IR_INITIALIZER_NULL:
+	case IR_INITIALIZER_BYTES:
 		return;
 	case IR_INITIALIZER_COMPOUND:
 		for (size_t i = 0; i < initializer->compound.n_initializers; ++i) {
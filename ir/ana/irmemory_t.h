@@ -22,6 +22,64 @@ void firm_init_memory_disambiguator(void);
 
 bool is_partly_volatile(ir_node *ptr);
 
+/**
+ * Creates the alias oracle of @p irg, which caches the decomposed addresses
+ * and the results of get_alias_relation() queries for the graph, and sets
+ * IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_ORACLE.
+ *
+ * Use assure_irg_properties() instead of calling this directly.
+ */
+void ir_compute_alias_oracle(ir_graph *irg);
+
+/**
+ * Frees the alias oracle of @p irg and clears
+ * IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_ORACLE.
+ */
+void ir_free_alias_oracle(ir_graph *irg);
+
+/**
+ * Drops the cached addresses and alias relations of @p irg after the address
+ * @p old has been exchanged, as cached decompositions may still refer to it
+ * as their base. Exchanging nodes of other modes keeps the cache.
+ */
+void ir_alias_oracle_exchanged(ir_graph *irg, ir_node const *old);
+
+/**
+ * Compares the points-to sets of two addresses.
+ *
+ * @return ir_no_alias if the accesses of @p size1 bytes at @p addr1 and
+ *         @p size2 bytes at @p addr2 cannot overlap according to
+ *         compute_irp_points_to(), ir_may_alias otherwise
+ */
+ir_alias_relation get_points_to_relation(ir_node const *addr1, unsigned size1,
+                                         ir_node const *addr2, unsigned size2);
+
+/**
+ * Returns a flexible array of the functions @p ptr may point to or NULL if it
+ * may point to anything else.
+ */
+ir_entity **get_points_to_callees(ir_node const *ptr);
+
+/**
+ * Returns a flexible array of the objects @p addr may point to or NULL if
+ * nothing is known about @p addr. An object is identified by its entity or by
+ * its allocating node. NULL stands for all memory which code outside of the
+ * program may access.
+ */
+void const **get_points_to_objects(ir_node const *addr);
+
+/**
+ * Frees the points-to sets of the nodes of @p irg.
+ */
+void free_irg_points_to(ir_graph *irg);
+
+/**
+ * Returns the entity whose address is never taken which @p addr points into or
+ * NULL if there is none. Such an entity is only accessed through addresses
+ * based on itself.
+ */
+ir_entity *get_nottaken_entity(ir_node const *addr);
+
 /**
  * Classify storage locations.
  * Except ir_sc_pointer they are all disjoint.
@@ -316,7 +316,9 @@ void compute_irg_outs(ir_graph *irg)
 
 void assure_irg_outs(ir_graph *irg)
 {
-	if (!irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS))
+	if (irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS))
+		irg_count_assure_hits(IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
+	else
 		compute_irg_outs(irg);
 }
 
@@ -0,0 +1,711 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Memory SSA overlay partitioning memory into alias classes.
+ *
+ * The classes are the sets of a union-find structure over memory objects: an
+ * entity whose address is never taken, a points-to object, or the rest of
+ * memory. Each Load, Store and CopyB address unites the objects it may access.
+ *
+ * The memory operations are split into runs, in which each operation consumes
+ * the memory of its predecessor. For each run a sorted list of positions is
+ * kept per class and kind of query, so the nearest relevant operation in a
+ * run is found by binary search. Removed operations are skipped with a
+ * union-find over the list entries. If a run contains nothing relevant, the
+ * query continues above it and the result is memoized for the top of the run.
+ *
+ * A Phi or Sync is marked while its predecessors are resolved, so a query
+ * reaching it again through a loop yields the node itself. If all other
+ * predecessors resolve to the same node, it is trivial for the class and
+ * resolves to that node, too (the trivial Phi removal of Braun et al.).
+ * Results naming a Phi or Sync which turned out to be trivial are forwarded on
+ * lookup.
+ */
+#include "memssa.h"
+
+#include "array.h"
+#include "debug.h"
+#include "hashptr.h"
+#include "irgraph_t.h"
+#include "irgwalk.h"
+#include "irmemory_t.h"
+#include "irnode_t.h"
+#include "pmap.h"
+#include "set.h"
+#include "typerep.h"
+#include "unionfind.h"
+#include "util.h"
+#include "xmalloc.h"
+#include <string.h>
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+
+/** A sorted list of positions in a run. */
+typedef struct memssa_stops {
+	unsigned *pos;  /**< the positions, NULL if empty */
+	int      *link; /**< the nearest entry at or before which may be valid */
+} memssa_stops;
+
+/** A sequence of memory operations, each consuming its predecessor's memory. */
+typedef struct memssa_run {
+	ir_node      **nodes;            /**< the operations from top to bottom */
+	unsigned       top;              /**< first operation which may be valid */
+	memssa_stops   wild[2];          /**< accesses of MEMSSA_ANY_CLASS */
+	memssa_stops   accesses[2];      /**< accesses of all classes */
+	memssa_stops   barriers[2][3];   /**< other operations by locality, query */
+} memssa_run;
+
+/** The stops of a class in a run, index 0 for writes and 1 for accesses. */
+typedef struct memssa_class_stops {
+	unsigned     run;
+	unsigned     cls;
+	memssa_stops stops[2];
+} memssa_class_stops;
+
+/** The position of a memory operation. */
+typedef struct memssa_pos {
+	unsigned generation; /**< valid if it matches the overlay's */
+	unsigned run;
+	unsigned index;
+} memssa_pos;
+
+struct ir_memssa_t {
+	ir_graph    *irg;
+	int         *uf;          /**< union-find over the objects */
+	bool        *local;       /**< object is a local variable never addressed */
+	pmap        *objs;        /**< entity or allocating node -> object */
+	unsigned    *classes;     /**< class + 1 of the address with each index */
+	memssa_pos  *positions;   /**< position of the operation with each index */
+	memssa_run **runs;        /**< the runs built so far */
+	set         *class_stops; /**< (run, class) -> stops */
+	set         *memo;        /**< memoized queries */
+	ir_node    **path;        /**< operations not yet placed in a run */
+	unsigned     generation;  /**< incremented on invalidation */
+	bool         any;         /**< every address may alias all memory */
+	bool         use_pts;     /**< partition with the points-to sets */
+};
+
+/** A memoized query. */
+typedef struct memssa_entry {
+	ir_node const *mem;   /**< the memory operation queried */
+	unsigned       query; /**< class and kind of the query */
+	ir_node       *def;   /**< the result or NULL while it is computed */
+} memssa_entry;
+
+/** The object standing for all memory without an object of its own. */
+#define REST_OBJ 0
+
+static int cmp_memssa_entry(void const *const elt, void const *const key,
+                            size_t const size)
+{
+	(void)size;
+	memssa_entry const *const e1 = (memssa_entry const*)elt;
+	memssa_entry const *const e2 = (memssa_entry const*)key;
+	return e1->mem != e2->mem || e1->query != e2->query;
+}
+
+static int cmp_class_stops(void const *const elt, void const *const key,
+                           size_t const size)
+{
+	(void)size;
+	memssa_class_stops const *const s1 = (memssa_class_stops const*)elt;
+	memssa_class_stops const *const s2 = (memssa_class_stops const*)key;
+	return s1->run != s2->run || s1->cls != s2->cls;
+}
+
+static unsigned new_obj(ir_memssa_t *const ms, bool const local)
+{
+	unsigned const obj = ARR_LEN(ms->uf);
+	ARR_APP1(int, ms->uf, -1);
+	ARR_APP1(bool, ms->local, local);
+	return obj;
+}
+
+static unsigned get_obj(ir_memssa_t *const ms, void const *const key,
+                        bool const local)
+{
+	if (key == NULL)
+		return REST_OBJ;
+	void *const found = pmap_get(void, ms->objs, key);
+	if (found != NULL)
+		return PTR_TO_INT(found) - 1;
+	unsigned const obj = new_obj(ms, local);
+	pmap_insert(ms->objs, key, INT_TO_PTR(obj + 1));
+	return obj;
+}
+
+static void unite(ir_memssa_t *const ms, unsigned const obj1,
+                  unsigned const obj2)
+{
+	int const repr1 = uf_find(ms->uf, obj1);
+	int const repr2 = uf_find(ms->uf, obj2);
+	if (repr1 == repr2)
+		return;
+	int const repr = uf_union(ms->uf, repr1, repr2);
+	ms->local[repr] = false;
+}
+
+/**
+ * Returns the object of @p addr if it is based on an entity whose address is
+ * never taken, or -1 otherwise.
+ */
+static int get_nottaken_obj(ir_memssa_t *const ms, ir_node const *const addr)
+{
+	ir_entity *const ent = get_nottaken_entity(addr);
+	if (ent == NULL)
+		return -1;
+	/* only Loads, Stores and CopyBs can reach a local variable */
+	bool const local = get_entity_owner(ent) == get_irg_frame_type(ms->irg)
+	                && !is_parameter_entity(ent);
+	return get_obj(ms, ent, local);
+}
+
+/**
+ * Returns an object of the class of @p addr or -1 if it may alias all
+ * memory. If @p unite_objs is set, the objects @p addr may point to are put
+ * into one class.
+ */
+static int get_addr_obj(ir_memssa_t *const ms, ir_node const *const addr,
+                        bool const unite_objs)
+{
+	int const obj = get_nottaken_obj(ms, addr);
+	if (obj >= 0)
+		return obj;
+	if (!ms->use_pts)
+		return REST_OBJ;
+
+	void const **const keys = get_points_to_objects(addr);
+	if (keys == NULL)
+		return -1;
+	unsigned const first = get_obj(ms, keys[0], false);
+	if (unite_objs) {
+		for (size_t i = 1, n = ARR_LEN(keys); i < n; ++i)
+			unite(ms, first, get_obj(ms, keys[i], false));
+	}
+	DEL_ARR_F(keys);
+	return first;
+}
+
+static void collect_address(ir_node *const node, void *const env)
+{
+	ir_node ***const addrs = (ir_node***)env;
+	switch (get_irn_opcode(node)) {
+	case iro_Load:
+		ARR_APP1(ir_node*, *addrs, get_Load_ptr(node));
+		break;
+	case iro_Store:
+		ARR_APP1(ir_node*, *addrs, get_Store_ptr(node));
+		break;
+	case iro_CopyB:
+		ARR_APP1(ir_node*, *addrs, get_CopyB_src(node));
+		ARR_APP1(ir_node*, *addrs, get_CopyB_dst(node));
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * A Call reads an aggregate argument passed by value through its address
+ * without taking it, so the variable is no longer local.
+ */
+static void mark_call_args(ir_node *const node, void *const env)
+{
+	if (!is_Call(node))
+		return;
+	ir_memssa_t *const ms = (ir_memssa_t*)env;
+	for (int i = 0, n = get_Call_n_params(node); i < n; ++i) {
+		int const obj = get_nottaken_obj(ms, get_Call_param(node, i));
+		if (obj >= 0)
+			ms->local[uf_find(ms->uf, obj)] = false;
+	}
+}
+
+ir_memssa_t *memssa_new(ir_graph *const irg)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.ana.memssa");
+
+	ir_memssa_t *const ms = XMALLOCZ(ir_memssa_t);
+	ms->irg         = irg;
+	ms->uf          = NEW_ARR_F(int, 0);
+	ms->local       = NEW_ARR_F(bool, 0);
+	ms->objs        = pmap_create();
+	ms->classes     = NEW_ARR_FZ(unsigned, get_irg_last_idx(irg));
+	ms->positions   = NEW_ARR_FZ(memssa_pos, get_irg_last_idx(irg));
+	ms->runs        = NEW_ARR_F(memssa_run*, 0);
+	ms->class_stops = new_set(cmp_class_stops, 64);
+	ms->memo        = new_set(cmp_memssa_entry, 256);
+	ms->path        = NEW_ARR_F(ir_node*, 0);
+	ms->generation  = 1;
+	new_obj(ms, false);
+
+	ir_disambiguator_options const opts
+		= get_irg_memory_disambiguator_options(irg);
+	if (opts & aa_opt_always_alias) {
+		ms->any = true;
+		return ms;
+	}
+	assert(irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE));
+
+	ir_node **addrs = NEW_ARR_F(ir_node*, 0);
+	irg_walk_graph(irg, NULL, collect_address, &addrs);
+
+	/* the points-to sets only help if every access has one, otherwise they
+	 * would have to be merged with the rest of memory anyway */
+	ms->use_pts = true;
+	for (size_t i = 0, n = ARR_LEN(addrs); i < n && ms->use_pts; ++i) {
+		ir_node *const addr = addrs[i];
+		if (get_nottaken_entity(addr) != NULL)
+			continue;
+		void const **const keys = get_points_to_objects(addr);
+		if (keys == NULL)
+			ms->use_pts = false;
+		else
+			DEL_ARR_F(keys);
+	}
+	for (size_t i = 0, n = ARR_LEN(addrs); i < n; ++i)
+		(void)get_addr_obj(ms, addrs[i], true);
+	DEL_ARR_F(addrs);
+	irg_walk_graph(irg, NULL, mark_call_args, ms);
+
+	DB((dbg, LEVEL_1, "%+F: %zu objects, points-to sets %s\n", irg,
+	    ARR_LEN(ms->uf), ms->use_pts ? "used" : "unused"));
+	return ms;
+}
+
+unsigned memssa_get_class(ir_memssa_t *const ms, ir_node const *const addr)
+{
+	if (ms->any)
+		return MEMSSA_ANY_CLASS;
+
+	unsigned const idx = get_irn_idx(addr);
+	size_t   const len = ARR_LEN(ms->classes);
+	if (idx >= len) {
+		ARR_RESIZE(unsigned, ms->classes, idx + 1);
+		memset(&ms->classes[len], 0, (idx + 1 - len) * sizeof(*ms->classes));
+	}
+	unsigned cls = ms->classes[idx];
+	if (cls == 0) {
+		int const obj = get_addr_obj(ms, addr, false);
+		cls = obj < 0 ? MEMSSA_ANY_CLASS : (unsigned)uf_find(ms->uf, obj) + 1;
+		ms->classes[idx] = cls + 1;
+	} else {
+		--cls;
+	}
+	return cls;
+}
+
+/** Returns true if only Loads, Stores and CopyBs may access class @p cls. */
+static bool is_local_class(ir_memssa_t const *const ms, unsigned const cls)
+{
+	return cls != MEMSSA_ANY_CLASS && ms->local[cls - 1];
+}
+
+static bool may_throw(ir_node const *const node)
+{
+	return is_fragile_op(node) && ir_throws_exception(node);
+}
+
+static mtp_additional_properties get_call_properties(ir_node const *const call)
+{
+	mtp_additional_properties props
+		= get_method_additional_properties(get_Call_type(call));
+	ir_entity *const callee = get_Call_callee(call);
+	if (callee != NULL)
+		props |= get_entity_additional_properties(callee);
+	return props;
+}
+
+/**
+ * Returns true if a query of kind @p query stops at the memory operation
+ * @p node, which is no Load, Store or CopyB. If @p local is set, the query is
+ * for a class of local variables.
+ */
+static bool is_barrier(ir_node const *const node, bool const local,
+                       memssa_query_t const query)
+{
+	if (is_Call(node)) {
+		if (!local) {
+			mtp_additional_properties const props
+				= get_call_properties(node);
+			if (props & mtp_property_no_write)
+				return query == memssa_access || !(props & mtp_property_pure);
+			if (!(props & mtp_property_pure))
+				return true;
+		}
+	} else if (!is_irn_const_memory(node) && !local) {
+		return true;
+	}
+	/* the exception handler may observe the memory */
+	return query == memssa_access && may_throw(node);
+}
+
+static memssa_pos *get_pos_entry(ir_memssa_t *const ms,
+                                 ir_node const *const node)
+{
+	unsigned const idx = get_irn_idx(node);
+	size_t   const len = ARR_LEN(ms->positions);
+	if (idx >= len) {
+		ARR_RESIZE(memssa_pos, ms->positions, idx + 1);
+		memset(&ms->positions[len], 0,
+		       (idx + 1 - len) * sizeof(*ms->positions));
+	}
+	return &ms->positions[idx];
+}
+
+static void add_stop(memssa_stops *const stops, unsigned const pos)
+{
+	if (stops->pos == NULL) {
+		stops->pos  = NEW_ARR_F(unsigned, 0);
+		stops->link = NEW_ARR_F(int, 0);
+	}
+	size_t const n = ARR_LEN(stops->pos);
+	if (n > 0 && stops->pos[n - 1] == pos)
+		return;
+	ARR_APP1(unsigned, stops->pos, pos);
+	ARR_APP1(int, stops->link, (int)n);
+}
+
+static void free_stops(memssa_stops *const stops)
+{
+	if (stops->pos != NULL) {
+		DEL_ARR_F(stops->pos);
+		DEL_ARR_F(stops->link);
+	}
+}
+
+static memssa_class_stops *get_class_stops(ir_memssa_t *const ms,
+                                           unsigned const run,
+                                           unsigned const cls,
+                                           bool const create)
+{
+	memssa_class_stops const key  = { .run = run, .cls = cls };
+	unsigned           const hash = hash_combine(run, cls);
+	if (create)
+		return set_insert(memssa_class_stops, ms->class_stops, &key,
+		                  sizeof(key), hash);
+	return set_find(memssa_class_stops, ms->class_stops, &key, sizeof(key),
+	                hash);
+}
+
+static void add_access(ir_memssa_t *const ms, unsigned const run_nr,
+                       ir_node const *const addr, unsigned const pos,
+                       bool const write)
+{
+	memssa_run   *const run    = ms->runs[run_nr];
+	unsigned      const cls    = memssa_get_class(ms, addr);
+	memssa_stops *const stops  = cls == MEMSSA_ANY_CLASS ? run->wild
+		: get_class_stops(ms, run_nr, cls, true)->stops;
+	if (write) {
+		add_stop(&stops[0], pos);
+		add_stop(&run->accesses[0], pos);
+	}
+	add_stop(&stops[1], pos);
+	add_stop(&run->accesses[1], pos);
+}
+
+static void append_node(ir_memssa_t *const ms, unsigned const run_nr,
+                        ir_node *const node)
+{
+	memssa_run *const run = ms->runs[run_nr];
+	unsigned    const pos = ARR_LEN(run->nodes);
+	ARR_APP1(ir_node*, run->nodes, node);
+	*get_pos_entry(ms, node) = (memssa_pos){
+		.generation = ms->generation,
+		.run        = run_nr,
+		.index      = pos,
+	};
+
+	switch (get_irn_opcode(node)) {
+	case iro_Load:
+		add_access(ms, run_nr, get_Load_ptr(node), pos, false);
+		break;
+	case iro_Store:
+		add_access(ms, run_nr, get_Store_ptr(node), pos, true);
+		break;
+	case iro_CopyB:
+		add_access(ms, run_nr, get_CopyB_dst(node), pos, true);
+		add_access(ms, run_nr, get_CopyB_src(node), pos, false);
+		break;
+	default:
+		for (unsigned local = 0; local < 2; ++local) {
+			for (unsigned query = 0; query < 3; ++query) {
+				if (is_barrier(node, local, (memssa_query_t)query))
+					add_stop(&run->barriers[local][query], pos);
+			}
+		}
+		break;
+	}
+}
+
+static unsigned new_run(ir_memssa_t *const ms)
+{
+	memssa_run *const run = XMALLOCZ(memssa_run);
+	run->nodes = NEW_ARR_F(ir_node*, 0);
+	ARR_APP1(memssa_run*, ms->runs, run);
+	return ARR_LEN(ms->runs) - 1;
+}
+
+static void free_runs(ir_memssa_t *const ms)
+{
+	for (size_t i = 0, n = ARR_LEN(ms->runs); i < n; ++i) {
+		memssa_run *const run = ms->runs[i];
+		for (unsigned j = 0; j < 2; ++j) {
+			free_stops(&run->wild[j]);
+			free_stops(&run->accesses[j]);
+			for (unsigned query = 0; query < 3; ++query)
+				free_stops(&run->barriers[j][query]);
+		}
+		DEL_ARR_F(run->nodes);
+		free(run);
+	}
+	ARR_SHRINKLEN(ms->runs, 0);
+	foreach_set(ms->class_stops, memssa_class_stops, stops) {
+		free_stops(&stops->stops[0]);
+		free_stops(&stops->stops[1]);
+	}
+}
+
+void memssa_free(ir_memssa_t *const ms)
+{
+	free_runs(ms);
+	DEL_ARR_F(ms->path);
+	del_set(ms->memo);
+	del_set(ms->class_stops);
+	DEL_ARR_F(ms->runs);
+	DEL_ARR_F(ms->positions);
+	DEL_ARR_F(ms->classes);
+	pmap_destroy(ms->objs);
+	DEL_ARR_F(ms->local);
+	DEL_ARR_F(ms->uf);
+	free(ms);
+}
+
+void memssa_invalidate(ir_memssa_t *const ms)
+{
+	free_runs(ms);
+	del_set(ms->class_stops);
+	ms->class_stops = new_set(cmp_class_stops, 64);
+	++ms->generation;
+	del_set(ms->memo);
+	ms->memo = new_set(cmp_memssa_entry, 256);
+}
+
+/**
+ * Returns the position of the memory operation @p node. The runs are built
+ * lazily: the operations above @p node without a position are appended to
+ * the run of the first operation with one if it ends there, or form a new
+ * run.
+ */
+static memssa_pos const *get_pos(ir_memssa_t *const ms, ir_node *const node)
+{
+	if (get_pos_entry(ms, node)->generation == ms->generation)
+		return get_pos_entry(ms, node);
+
+	size_t const start = ARR_LEN(ms->path);
+	unsigned     run_nr;
+	for (ir_node *op = node;;) {
+		ARR_APP1(ir_node*, ms->path, op);
+		ir_node *const pred = skip_Proj(get_memop_mem(op));
+		if (!is_memop(pred)) {
+			run_nr = new_run(ms);
+			break;
+		}
+		memssa_pos const *const pred_pos = get_pos_entry(ms, pred);
+		if (pred_pos->generation == ms->generation) {
+			memssa_run const *const run = ms->runs[pred_pos->run];
+			run_nr = pred_pos->index + 1 == ARR_LEN(run->nodes)
+			       ? pred_pos->run : new_run(ms);
+			break;
+		}
+		op = pred;
+	}
+	for (size_t i = ARR_LEN(ms->path); i-- > start;)
+		append_node(ms, run_nr, ms->path[i]);
+	ARR_SHRINKLEN(ms->path, start);
+	return get_pos_entry(ms, node);
+}
+
+static bool is_removed(ir_node const *const node)
+{
+	return is_Deleted(node) || is_Id(node);
+}
+
+/**
+ * Returns the last position in @p stops which is at most @p index and holds
+ * an operation which was not removed from the graph, or -1. Removed ones are
+ * unlinked like in a union-find structure, so they are skipped only once.
+ */
+static int find_stop(memssa_run const *const run, memssa_stops *const stops,
+                     unsigned const index)
+{
+	if (stops->pos == NULL)
+		return -1;
+
+	/* binary search for the last entry at most index */
+	int lo = 0;
+	int hi = (int)ARR_LEN(stops->pos);
+	while (lo < hi) {
+		int const mid = lo + (hi - lo) / 2;
+		if (stops->pos[mid] <= index)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	int const first = lo - 1;
+	int       live  = first;
+	while (live >= 0) {
+		int const link = stops->link[live];
+		if (link != live) {
+			live = link;
+		} else if (is_removed(run->nodes[stops->pos[live]])) {
+			stops->link[live] = live - 1;
+			--live;
+		} else {
+			break;
+		}
+	}
+	for (int i = first; i > live;) {
+		int const next = stops->link[i];
+		stops->link[i] = live;
+		i = next;
+	}
+	return live < 0 ? -1 : (int)stops->pos[live];
+}
+
+static memssa_entry *find_memo(ir_memssa_t *const ms, ir_node const *const mem,
+                               unsigned const query)
+{
+	memssa_entry const key = { .mem = mem, .query = query };
+	unsigned     const hash = hash_combine(hash_ptr(mem), query);
+	return set_find(memssa_entry, ms->memo, &key, sizeof(key), hash);
+}
+
+static void set_memo(ir_memssa_t *const ms, ir_node const *const mem,
+                     unsigned const query, ir_node *const def)
+{
+	memssa_entry const key = { .mem = mem, .query = query };
+	unsigned     const hash = hash_combine(hash_ptr(mem), query);
+	memssa_entry *const entry
+		= set_insert(memssa_entry, ms->memo, &key, sizeof(key), hash);
+	entry->def = def;
+}
+
+/**
+ * Returns the memoized result for @p mem, forwarded through trivial Phis and
+ * Syncs, @p mem itself while it is being resolved, or NULL if there is no
+ * valid result.
+ */
+static ir_node *lookup(ir_memssa_t *const ms, ir_node *const mem,
+                       unsigned const query)
+{
+	memssa_entry const *entry = find_memo(ms, mem, query);
+	if (entry == NULL)
+		return NULL;
+	if (entry->def == NULL)
+		return mem;
+
+	ir_node *def = entry->def;
+	while (!is_removed(def) && def != mem && (is_Phi(def) || is_Sync(def))) {
+		entry = find_memo(ms, def, query);
+		if (entry == NULL || entry->def == NULL || entry->def == def)
+			break;
+		def = entry->def;
+	}
+	return is_removed(def) ? NULL : def;
+}
+
+static ir_node *resolve(ir_memssa_t *ms, ir_node *mem, unsigned cls,
+                        memssa_query_t query);
+
+/**
+ * Resolves a Phi or Sync: it is trivial if all predecessors besides the node
+ * itself resolve to the same node.
+ */
+static ir_node *resolve_merge(ir_memssa_t *const ms, ir_node *const merge,
+                              unsigned const cls, memssa_query_t const query,
+                              unsigned const key)
+{
+	set_memo(ms, merge, key, NULL);
+	ir_node *same = NULL;
+	foreach_irn_in(merge, i, pred) {
+		ir_node *const def = resolve(ms, pred, cls, query);
+		if (def == merge || def == same)
+			continue;
+		if (same != NULL) {
+			same = merge;
+			break;
+		}
+		same = def;
+	}
+	if (same == NULL)
+		same = merge;
+	set_memo(ms, merge, key, same);
+	return same;
+}
+
+/**
+ * Resolves the memory operation @p node: the last relevant operation in its
+ * run up to @p node, or the result above the run, which is memoized for the
+ * top operation of the run.
+ */
+static ir_node *resolve_op(ir_memssa_t *const ms, ir_node *const node,
+                           unsigned const cls, memssa_query_t const query,
+                           unsigned const key)
+{
+	memssa_pos   const *const pos    = get_pos(ms, node);
+	unsigned            const run_nr = pos->run;
+	unsigned            const index  = pos->index;
+	memssa_run         *const run    = ms->runs[run_nr];
+	unsigned            const kind   = query != memssa_clobber;
+
+	int found = find_stop(run, &run->barriers[is_local_class(ms, cls)][query],
+	                      index);
+	if (cls == MEMSSA_ANY_CLASS) {
+		found = MAX(found, find_stop(run, &run->accesses[kind], index));
+	} else {
+		found = MAX(found, find_stop(run, &run->wild[kind], index));
+		memssa_class_stops *const stops
+			= get_class_stops(ms, run_nr, cls, false);
+		if (stops != NULL)
+			found = MAX(found, find_stop(run, &stops->stops[kind], index));
+	}
+	if (found >= 0)
+		return run->nodes[found];
+
+	/* nothing relevant in the run, continue above it */
+	while (run->top < index && is_removed(run->nodes[run->top]))
+		++run->top;
+	ir_node *const top = run->nodes[run->top];
+	ir_node       *def = lookup(ms, top, key);
+	if (def == NULL) {
+		def = resolve(ms, get_memop_mem(top), cls, query);
+		set_memo(ms, top, key, def);
+	}
+	return def;
+}
+
+static ir_node *resolve(ir_memssa_t *const ms, ir_node *mem,
+                        unsigned const cls, memssa_query_t const query)
+{
+	unsigned const key = cls * 3 + query;
+	mem = skip_Proj(mem);
+	if (is_Phi(mem) || is_Sync(mem)) {
+		ir_node *const def = lookup(ms, mem, key);
+		return def != NULL ? def : resolve_merge(ms, mem, cls, query, key);
+	}
+	if (!is_memop(mem))
+		return mem;
+	return resolve_op(ms, mem, cls, query, key);
+}
+
+ir_node *memssa_skip(ir_memssa_t *const ms, ir_node *const mem,
+                     unsigned const cls, memssa_query_t const query)
+{
+	return resolve(ms, mem, cls, query);
+}
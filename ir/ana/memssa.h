@@ -0,0 +1,73 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Memory SSA overlay partitioning memory into alias classes.
+ *
+ * Firm threads all memory operations of a graph through one memory chain.
+ * The overlay partitions the accessed memory into alias classes, such that
+ * accesses of different classes never alias, and answers which memory
+ * operation above a memory value is the nearest one relevant for a class.
+ * Operations of other classes are skipped, and Phi and Sync nodes whose
+ * predecessors all lead to the same operation are looked through, so the
+ * remaining ones act as the memory Phis of the class. Results are memoized,
+ * so a sequence of queries costs almost constant time each.
+ */
+#ifndef FIRM_ANA_MEMSSA_H
+#define FIRM_ANA_MEMSSA_H
+
+#include "firm_types.h"
+
+typedef struct ir_memssa_t ir_memssa_t;
+
+/** The class of addresses which may alias all memory. */
+#define MEMSSA_ANY_CLASS 0
+
+/** The memory operations a query stops at. */
+typedef enum memssa_query_t {
+	/** nodes which may write memory of the class */
+	memssa_clobber,
+	/** additionally Loads from the class */
+	memssa_def,
+	/** additionally nodes which may read memory of the class or may throw an
+	 * exception */
+	memssa_access,
+} memssa_query_t;
+
+/**
+ * Creates the overlay for @p irg. Entities whose address is not taken get
+ * their own class, which needs IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE. The
+ * other memory is partitioned with the result of compute_irp_points_to() if
+ * it covers all accesses of the graph.
+ */
+ir_memssa_t *memssa_new(ir_graph *irg);
+
+/** Frees the overlay @p ms. */
+void memssa_free(ir_memssa_t *ms);
+
+/**
+ * Returns the alias class of the memory accessed through @p addr. Addresses
+ * created after memssa_new() may get MEMSSA_ANY_CLASS.
+ */
+unsigned memssa_get_class(ir_memssa_t *ms, ir_node const *addr);
+
+/**
+ * Returns the nearest node above the memory value @p mem relevant for the
+ * alias class @p cls, i.e. a Load, Store or CopyB of the class as selected by
+ * @p query, a Phi or Sync merging different states of the class, or any other
+ * node which may access the class. Projs are skipped.
+ */
+ir_node *memssa_skip(ir_memssa_t *ms, ir_node *mem, unsigned cls,
+                     memssa_query_t query);
+
+/**
+ * Forgets all memoized queries. Must be called after a memory operation was
+ * inserted into the memory chain or moved. Removing a memory operation by
+ * exchanging its memory Proj and killing it needs no invalidation.
+ */
+void memssa_invalidate(ir_memssa_t *ms);
+
+#endif
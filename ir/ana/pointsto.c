@@ -0,0 +1,1857 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Whole-program points-to analysis.
+ *
+ * The analysis maps every address of the program to the set of abstract
+ * locations it may point to. An abstract object is a global or thread local
+ * variable, a function, a frame entity, an allocation site or the unknown
+ * object, which stands for all memory outside of the program. A location is
+ * an object together with a byte offset or "any offset".
+ *
+ * The graphs are translated into constraints over points-to variables:
+ *   ADDR   dst >= { (obj, offset) }
+ *   COPY   dst >= src
+ *   OFFSET dst >= src shifted by an offset
+ *   LOAD   dst >= *ptr
+ *   STORE  *ptr >= src
+ *   CALL   binds the arguments and results of a call to each function
+ *          found in the points-to set of the call address
+ * Memory reachable by code outside the program is modelled by loads and
+ * stores through a pointer to the unknown object. An object escapes when its
+ * address is stored there.
+ *
+ * Two solvers are available: Steensgaard's unification based algorithm,
+ * which ignores offsets and runs in almost linear time, and Andersen's
+ * inclusion based algorithm, which tracks fields and propagates differences
+ * of sparse bitsets along the copy edges.
+ */
+#include "irmemory_t.h"
+
+#include "array.h"
+#include "bitfiddle.h"
+#include "debug.h"
+#include "hashptr.h"
+#include "irgraph_t.h"
+#include "irgwalk.h"
+#include "irnode_t.h"
+#include "irnodemap.h"
+#include "irprog_t.h"
+#include "panic.h"
+#include "pdeq.h"
+#include "pmap.h"
+#include "set.h"
+#include "tv.h"
+#include "typerep.h"
+#include "unionfind.h"
+#include "util.h"
+#include "xmalloc.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
+
+#define PTA_NONE        UINT_MAX /**< no points-to variable */
+#define PTA_ANY         LONG_MIN /**< unknown offset in a constraint */
+#define PTA_ANY_OFFSET  UINT_MAX /**< location at any offset of an object */
+#define PTA_UNKNOWN     0        /**< the unknown object */
+#define PTA_MAX_FIELDS  64       /**< maximal number of fields per object */
+#define PTA_HEAP_LIMIT  4096     /**< fields of allocations below this */
+
+typedef enum pta_obj_kind {
+	PTA_OBJ_UNKNOWN,
+	PTA_OBJ_GLOBAL,
+	PTA_OBJ_FUNCTION,
+	PTA_OBJ_FRAME,
+	PTA_OBJ_ALLOC,
+} pta_obj_kind;
+
+/** An abstract memory object. */
+typedef struct pta_obj {
+	pta_obj_kind   kind;
+	ir_entity     *ent;     /**< the entity or NULL */
+	ir_node const *site;    /**< the allocating node or NULL */
+	unsigned       limit;   /**< fields are tracked below this offset */
+	bool           escaped; /**< code outside the program may access it */
+} pta_obj;
+
+typedef enum pta_cons_kind {
+	PTA_ADDR,   /**< dst >= { (src, offset) } */
+	PTA_COPY,   /**< dst >= src */
+	PTA_OFFSET, /**< dst >= src + offset */
+	PTA_LOAD,   /**< dst >= *src */
+	PTA_STORE,  /**< *dst >= src */
+	PTA_CALL,   /**< call number src through the address dst */
+} pta_cons_kind;
+
+/** A points-to constraint. */
+typedef struct pta_cons {
+	pta_cons_kind kind;
+	unsigned      dst;
+	unsigned      src;
+	long          offset;
+} pta_cons;
+
+/** A function with a graph. */
+typedef struct pta_func {
+	ir_entity *ent;
+	unsigned  *params;    /**< variables of the parameters */
+	unsigned  *results;   /**< variables of the results */
+	bool       escaped;   /**< already callable from outside */
+} pta_func;
+
+/** A call site. */
+typedef struct pta_call {
+	ir_node const *call;
+	unsigned      *args;     /**< variables of the arguments or PTA_NONE */
+	unsigned      *results;  /**< variables of the results */
+	bool           no_write; /**< external callees do not write memory */
+	bool           external; /**< already bound to external code */
+} pta_call;
+
+/** A call bound to a function. */
+typedef struct pta_binding {
+	unsigned call;
+	unsigned obj;
+} pta_binding;
+
+/** Constraint generation state, shared with the solvers. */
+typedef struct pta_env {
+	pta_obj   *objs;        /**< all objects, PTA_UNKNOWN first */
+	pmap      *obj_map;     /**< entity or allocating node -> object + 1 */
+	ir_node  **var_nodes;   /**< the node of each variable or NULL */
+	pta_cons  *cons;        /**< all constraints */
+	pta_call  *calls;       /**< all call sites */
+	pmap      *funcs;       /**< method entity -> pta_func */
+	set       *bindings;    /**< calls already bound to functions */
+	unsigned   unknown_ptr; /**< variable pointing to the unknown object */
+	struct obstack obst;
+	/* state while generating a graph */
+	ir_graph  *irg;
+	pta_func  *func;
+	unsigned  *node_ids;    /**< variable of a value or number of a Call */
+} pta_env;
+
+static pta_env pta;
+
+/** A location in a points-to result. */
+typedef struct pts_location {
+	unsigned obj;
+	unsigned offset; /**< PTA_ANY_OFFSET for any offset */
+} pts_location;
+
+/** A points-to result, shared by all nodes with the same set. */
+typedef struct points_to_set {
+	unsigned     n_locs;
+	pts_location locs[];
+} points_to_set;
+
+/** The objects of the computed result or NULL. */
+static pta_obj *points_to_objs;
+/** Hash-consed points-to results. */
+static set     *points_to_sets;
+
+/*--------------------------------------------------------------------------*/
+/* Sparse bitsets                                                           */
+/*--------------------------------------------------------------------------*/
+
+/**
+ * A word of a sparse bitset. A set is a flexible array of words sorted by
+ * their base or NULL if it is empty.
+ */
+typedef struct pts_word {
+	unsigned base;
+	uint32_t bits;
+} pts_word;
+
+static size_t pts_n_words(pts_word const *const set)
+{
+	return set != NULL ? ARR_LEN(set) : 0;
+}
+
+static bool pts_insert(pts_word **const set, unsigned const bit)
+{
+	unsigned const base = bit / 32;
+	uint32_t const mask = 1u << (bit % 32);
+	size_t   const n    = pts_n_words(*set);
+	size_t         lo   = 0;
+	size_t         hi   = n;
+	while (lo < hi) {
+		size_t const mid = (lo + hi) / 2;
+		if ((*set)[mid].base < base)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo < n && (*set)[lo].base == base) {
+		if ((*set)[lo].bits & mask)
+			return false;
+		(*set)[lo].bits |= mask;
+		return true;
+	}
+	if (*set == NULL)
+		*set = NEW_ARR_F(pts_word, 0);
+	ARR_APP1(pts_word, *set, ((pts_word){ 0, 0 }));
+	memmove(&(*set)[lo + 1], &(*set)[lo], (n - lo) * sizeof(**set));
+	(*set)[lo] = (pts_word){ base, mask };
+	return true;
+}
+
+/**
+ * Adds @p src to @p dst. Returns true if @p dst changed.
+ */
+static bool pts_union(pts_word **const dst, pts_word const *const src)
+{
+	size_t const n_dst = pts_n_words(*dst);
+	size_t const n_src = pts_n_words(src);
+	size_t       n_new = 0;
+	bool         grows = false;
+	for (size_t d = 0, s = 0; s < n_src;) {
+		if (d < n_dst && (*dst)[d].base < src[s].base) {
+			++d;
+		} else if (d < n_dst && (*dst)[d].base == src[s].base) {
+			if (src[s].bits & ~(*dst)[d].bits)
+				grows = true;
+			++d;
+			++s;
+		} else {
+			++n_new;
+			++s;
+		}
+	}
+	if (n_new == 0) {
+		if (!grows)
+			return false;
+		for (size_t d = 0, s = 0; s < n_src; ++d) {
+			if ((*dst)[d].base == src[s].base)
+				(*dst)[d].bits |= src[s++].bits;
+		}
+		return true;
+	}
+
+	pts_word *const res = NEW_ARR_F(pts_word, n_dst + n_new);
+	size_t          r   = 0;
+	size_t          d   = 0;
+	size_t          s   = 0;
+	while (d < n_dst || s < n_src) {
+		if (s == n_src || (d < n_dst && (*dst)[d].base < src[s].base)) {
+			res[r++] = (*dst)[d++];
+		} else if (d == n_dst || src[s].base < (*dst)[d].base) {
+			res[r++] = src[s++];
+		} else {
+			res[r++] = (pts_word){ src[s].base, (*dst)[d++].bits | src[s++].bits };
+		}
+	}
+	if (*dst != NULL)
+		DEL_ARR_F(*dst);
+	*dst = res;
+	return true;
+}
+
+/**
+ * Returns the elements of @p a missing in @p b or NULL if there are none.
+ */
+static pts_word *pts_difference(pts_word const *const a,
+                                pts_word const *const b)
+{
+	pts_word    *res = NULL;
+	size_t const n_a = pts_n_words(a);
+	size_t const n_b = pts_n_words(b);
+	for (size_t i = 0, j = 0; i < n_a; ++i) {
+		while (j < n_b && b[j].base < a[i].base)
+			++j;
+		uint32_t bits = a[i].bits;
+		if (j < n_b && b[j].base == a[i].base)
+			bits &= ~b[j].bits;
+		if (bits == 0)
+			continue;
+		if (res == NULL)
+			res = NEW_ARR_F(pts_word, 0);
+		ARR_APP1(pts_word, res, ((pts_word){ a[i].base, bits }));
+	}
+	return res;
+}
+
+#define foreach_pts(set, bit) \
+	for (size_t bit##_w = 0; bit##_w < pts_n_words(set); ++bit##_w) \
+		for (uint32_t bit##_b = (set)[bit##_w].bits; bit##_b != 0; bit##_b &= bit##_b - 1) \
+			for (unsigned bit = (set)[bit##_w].base * 32 + ntz(bit##_b), bit##_once = 1; bit##_once; bit##_once = 0)
+
+/*--------------------------------------------------------------------------*/
+/* Constraint generation                                                    */
+/*--------------------------------------------------------------------------*/
+
+static unsigned new_var(ir_node *const node)
+{
+	unsigned const var = ARR_LEN(pta.var_nodes);
+	ARR_APP1(ir_node*, pta.var_nodes, node);
+	return var;
+}
+
+static void add_cons(pta_cons_kind const kind, unsigned const dst,
+                     unsigned const src, long const offset)
+{
+	if (dst == PTA_NONE || (src == PTA_NONE && kind != PTA_ADDR))
+		return;
+	pta_cons const cons = { kind, dst, src, offset };
+	ARR_APP1(pta_cons, pta.cons, cons);
+}
+
+static unsigned new_obj(pta_obj_kind const kind, ir_entity *const ent,
+                        ir_node const *const site, unsigned const limit)
+{
+	unsigned const obj = ARR_LEN(pta.objs);
+	pta_obj  const o   = { kind, ent, site, limit, false };
+	ARR_APP1(pta_obj, pta.objs, o);
+	return obj;
+}
+
+/**
+ * Returns the object of a global variable, function or frame entity.
+ */
+static unsigned get_entity_obj(ir_entity *const ent)
+{
+	void *const entry = pmap_get(void, pta.obj_map, ent);
+	if (entry != NULL)
+		return PTR_TO_INT(entry) - 1;
+
+	unsigned obj;
+	if (is_method_entity(ent)) {
+		obj = new_obj(PTA_OBJ_FUNCTION, ent, NULL, 0);
+	} else {
+		ir_type     *const type  = get_entity_type(ent);
+		unsigned     const limit = get_type_state(type) == layout_fixed
+		                           ? get_type_size(type) : 0;
+		pta_obj_kind const kind  = is_frame_type(get_entity_owner(ent))
+		                           ? PTA_OBJ_FRAME : PTA_OBJ_GLOBAL;
+		obj = new_obj(kind, ent, NULL, limit);
+	}
+	pmap_insert(pta.obj_map, ent, INT_TO_PTR(obj + 1));
+	return obj;
+}
+
+/**
+ * Returns the object allocated by @p site.
+ */
+static unsigned get_alloc_obj(ir_node const *const site)
+{
+	void *const entry = pmap_get(void, pta.obj_map, site);
+	if (entry != NULL)
+		return PTR_TO_INT(entry) - 1;
+	unsigned const obj = new_obj(PTA_OBJ_ALLOC, NULL, site, PTA_HEAP_LIMIT);
+	pmap_insert(pta.obj_map, site, INT_TO_PTR(obj + 1));
+	return obj;
+}
+
+/**
+ * Returns a fresh variable pointing to @p obj at @p offset.
+ */
+static unsigned new_addr_var(unsigned const obj, long const offset)
+{
+	unsigned const var = new_var(NULL);
+	add_cons(PTA_ADDR, var, obj, offset);
+	return var;
+}
+
+/** Lets code outside the program see the value of @p var. */
+static void add_escape(unsigned const var)
+{
+	add_cons(PTA_STORE, pta.unknown_ptr, var, 0);
+}
+
+static void add_any_offset(unsigned const dst, unsigned const src)
+{
+	add_cons(PTA_OFFSET, dst, src, PTA_ANY);
+}
+
+static bool is_tracked_mode(ir_mode const *const mode)
+{
+	return mode_is_int(mode) || mode_is_reference(mode);
+}
+
+/**
+ * Returns true if @p node is a value which may carry a pointer. Constant
+ * integers and null pointers never point to an object.
+ */
+static bool is_tracked(ir_node const *const node)
+{
+	if (!is_tracked_mode(get_irn_mode(node)))
+		return false;
+	switch (get_irn_opcode(node)) {
+	case iro_Align:
+	case iro_Bad:
+	case iro_Dummy:
+	case iro_Offset:
+	case iro_Size:
+	case iro_Unknown:
+		return false;
+	case iro_Const:
+		return mode_is_reference(get_irn_mode(node))
+		    && !tarval_is_null(get_Const_tarval(node));
+	default:
+		return true;
+	}
+}
+
+/**
+ * Returns the variable of a node of the current graph or PTA_NONE.
+ */
+static unsigned get_node_var(ir_node *const node)
+{
+	if (!is_tracked(node))
+		return PTA_NONE;
+	unsigned *const id = &pta.node_ids[get_irn_idx(node)];
+	if (*id == PTA_NONE)
+		*id = new_var(node);
+	return *id;
+}
+
+/**
+ * Returns the variable of an address used for a memory access. Addresses
+ * computed from constants point to the unknown object.
+ */
+static unsigned get_address_var(ir_node *const node)
+{
+	unsigned const var = get_node_var(node);
+	return var != PTA_NONE ? var : pta.unknown_ptr;
+}
+
+static pta_func *get_func(ir_entity *const ent)
+{
+	return pmap_get(pta_func, pta.funcs, ent);
+}
+
+static unsigned *new_vars(size_t const n)
+{
+	unsigned *const vars = NEW_ARR_F(unsigned, n);
+	for (size_t i = 0; i < n; ++i)
+		vars[i] = new_var(NULL);
+	return vars;
+}
+
+static void create_func(ir_graph *const irg)
+{
+	ir_entity *const ent  = get_irg_entity(irg);
+	ir_type   *const type = get_entity_type(ent);
+	pta_func  *const func = OALLOCZ(&pta.obst, pta_func);
+	func->ent     = ent;
+	func->params  = new_vars(get_method_n_params(type));
+	func->results = new_vars(get_method_n_ress(type));
+	pmap_insert(pta.funcs, ent, func);
+}
+
+/**
+ * Returns the record of the Call @p call of the current graph.
+ */
+static pta_call *get_call(ir_node *const call)
+{
+	unsigned *const id = &pta.node_ids[get_irn_idx(call)];
+	if (*id != PTA_NONE)
+		return &pta.calls[*id];
+
+	ir_type *const type  = get_Call_type(call);
+	ir_node *const ptr   = get_Call_ptr(call);
+	unsigned       props = get_method_additional_properties(type);
+	ir_entity     *ent   = NULL;
+	if (is_Address(ptr)) {
+		ent    = get_Address_entity(ptr);
+		props |= get_entity_additional_properties(ent);
+	}
+
+	size_t   const n_args = get_Call_n_params(call);
+	unsigned      *args   = NEW_ARR_F(unsigned, n_args);
+	for (size_t i = 0; i < n_args; ++i)
+		args[i] = get_node_var(get_Call_param(call, i));
+
+	pta_call const record = {
+		.call     = call,
+		.args     = args,
+		.results  = new_vars(get_method_n_ress(type)),
+		.no_write = props & (mtp_property_no_write | mtp_property_pure),
+		.external = false,
+	};
+	*id = ARR_LEN(pta.calls);
+	ARR_APP1(pta_call, pta.calls, record);
+
+	pta_call *const res = &pta.calls[*id];
+	if (props & mtp_property_malloc) {
+		/* a fresh allocation, which is not reachable from the arguments */
+		if (ARR_LEN(res->results) > 0)
+			add_cons(PTA_ADDR, res->results[0], get_alloc_obj(call), 0);
+	} else {
+		add_cons(PTA_CALL, get_address_var(ptr), *id, 0);
+	}
+	return res;
+}
+
+/**
+ * Binds the call @p call_nr to code outside the program.
+ */
+static void bind_external(unsigned const call_nr)
+{
+	pta_call *const call = &pta.calls[call_nr];
+	if (call->external)
+		return;
+	call->external = true;
+
+	unsigned const *const args    = call->args;
+	unsigned const *const results = call->results;
+	for (size_t i = 0, n = ARR_LEN(args); i < n; ++i) {
+		if (args[i] == PTA_NONE)
+			continue;
+		if (call->no_write) {
+			/* the callee may return pointers into and read through the
+			 * arguments */
+			unsigned const any = new_var(NULL);
+			add_any_offset(any, args[i]);
+			for (size_t r = 0, n_res = ARR_LEN(results); r < n_res; ++r) {
+				add_cons(PTA_COPY, results[r], any, 0);
+				add_cons(PTA_LOAD, results[r], any, 0);
+			}
+		} else {
+			add_escape(args[i]);
+		}
+	}
+	for (size_t r = 0, n_res = ARR_LEN(results); r < n_res; ++r)
+		add_cons(PTA_LOAD, results[r], pta.unknown_ptr, 0);
+}
+
+/**
+ * Makes @p func callable from code outside the program.
+ */
+static void escape_func(pta_func *const func)
+{
+	if (func->escaped)
+		return;
+	func->escaped = true;
+	for (size_t i = 0, n = ARR_LEN(func->params); i < n; ++i)
+		add_cons(PTA_LOAD, func->params[i], pta.unknown_ptr, 0);
+	for (size_t i = 0, n = ARR_LEN(func->results); i < n; ++i)
+		add_escape(func->results[i]);
+}
+
+/**
+ * Called by the solvers for each object found in the points-to set of the
+ * address of call @p call_nr. Appends the constraints binding the call to
+ * the object.
+ */
+static void bind_call(unsigned const call_nr, unsigned const obj)
+{
+	pta_obj const *const o = &pta.objs[obj];
+	if (o->kind != PTA_OBJ_FUNCTION) {
+		bind_external(call_nr);
+		return;
+	}
+
+	pta_binding const key  = { call_nr, obj };
+	unsigned    const hash = hash_combine(call_nr, obj);
+	if (set_find(pta_binding, pta.bindings, &key, sizeof(key), hash) != NULL)
+		return;
+	(void)set_insert(pta_binding, pta.bindings, &key, sizeof(key), hash);
+
+	ir_entity *const ent  = o->ent;
+	pta_func  *const func = get_func(ent);
+	/* weak definitions may be replaced by external code at link time */
+	if (func == NULL || get_entity_linktime_irg(ent) == NULL)
+		bind_external(call_nr);
+	if (func == NULL)
+		return;
+
+	DB((dbg, LEVEL_3, "bind %+F to %+F\n", pta.calls[call_nr].call, ent));
+	pta_call const *const call    = &pta.calls[call_nr];
+	size_t          const n_param = ARR_LEN(func->params);
+	for (size_t i = 0, n = ARR_LEN(call->args); i < n; ++i) {
+		if (i < n_param)
+			add_cons(PTA_COPY, func->params[i], call->args[i], 0);
+		else
+			add_escape(call->args[i]); /* variadic argument */
+	}
+	size_t const n_res = MIN(ARR_LEN(call->results), ARR_LEN(func->results));
+	for (size_t i = 0; i < n_res; ++i)
+		add_cons(PTA_COPY, call->results[i], func->results[i], 0);
+}
+
+static bool is_pure_builtin(ir_builtin_kind const kind)
+{
+	switch (kind) {
+	case ir_bk_bswap:
+	case ir_bk_clz:
+	case ir_bk_ctz:
+	case ir_bk_ffs:
+	case ir_bk_may_alias:
+	case ir_bk_parity:
+	case ir_bk_popcount:
+	case ir_bk_saturating_increment:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static void generate_builtin(ir_node *const node)
+{
+	ir_builtin_kind const kind = get_Builtin_kind(node);
+	switch (kind) {
+	case ir_bk_debugbreak:
+	case ir_bk_frame_address:
+	case ir_bk_inport:
+	case ir_bk_outport:
+	case ir_bk_prefetch:
+	case ir_bk_return_address:
+	case ir_bk_trap:
+		return;
+	case ir_bk_compare_swap:
+		add_cons(PTA_STORE, get_address_var(get_Builtin_param(node, 0)),
+		         get_node_var(get_Builtin_param(node, 2)), 0);
+		return;
+	default:
+		if (is_pure_builtin(kind))
+			return;
+		for (int i = 0, n = get_Builtin_n_params(node); i < n; ++i)
+			add_escape(get_node_var(get_Builtin_param(node, i)));
+		return;
+	}
+}
+
+static void generate_builtin_result(ir_node *const node, unsigned const var)
+{
+	ir_builtin_kind const kind = get_Builtin_kind(node);
+	if (is_pure_builtin(kind)) {
+		for (int i = 0, n = get_Builtin_n_params(node); i < n; ++i)
+			add_any_offset(var, get_node_var(get_Builtin_param(node, i)));
+	} else if (kind == ir_bk_compare_swap) {
+		add_cons(PTA_LOAD, var, get_address_var(get_Builtin_param(node, 0)), 0);
+	} else {
+		add_cons(PTA_LOAD, var, pta.unknown_ptr, 0);
+	}
+}
+
+static void generate_proj(ir_node *const node, unsigned const var)
+{
+	ir_node *const pred = get_Proj_pred(node);
+	unsigned const num  = get_Proj_num(node);
+	switch (get_irn_opcode(pred)) {
+	case iro_Start:
+		if (num == pn_Start_P_frame_base) {
+			ir_type *const frame = get_irg_frame_type(pta.irg);
+			for (size_t i = 0, n = get_compound_n_members(frame); i < n; ++i) {
+				ir_entity *const member = get_compound_member(frame, i);
+				add_cons(PTA_ADDR, var, get_entity_obj(member), PTA_ANY);
+			}
+		}
+		return;
+
+	case iro_Load:
+		if (num == pn_Load_res)
+			add_cons(PTA_LOAD, var, get_address_var(get_Load_ptr(pred)), 0);
+		return;
+
+	case iro_Alloc:
+		if (num == pn_Alloc_res)
+			add_cons(PTA_ADDR, var, get_alloc_obj(pred), 0);
+		return;
+
+	case iro_Builtin:
+		generate_builtin_result(pred, var);
+		return;
+
+	case iro_ASM:
+		add_cons(PTA_LOAD, var, pta.unknown_ptr, 0);
+		return;
+
+	case iro_Tuple:
+		add_cons(PTA_COPY, var, get_node_var(get_Tuple_pred(pred, num)), 0);
+		return;
+
+	case iro_Proj: {
+		ir_node *const tuple = get_Proj_pred(pred);
+		if (is_Start(tuple)) {
+			unsigned const *const params = pta.func->params;
+			if (num < ARR_LEN(params))
+				add_cons(PTA_COPY, var, params[num], 0);
+		} else if (is_Call(tuple)) {
+			unsigned const *const results = get_call(tuple)->results;
+			if (num < ARR_LEN(results))
+				add_cons(PTA_COPY, var, results[num], 0);
+		} else {
+			panic("unexpected Proj of %+F", pred);
+		}
+		return;
+	}
+
+	default:
+		/* data results of Div, Mod and the like */
+		foreach_irn_in(pred, i, op) {
+			add_any_offset(var, get_node_var(op));
+		}
+		return;
+	}
+}
+
+/**
+ * Returns the constant value of @p node in @p value if there is one.
+ */
+static bool get_const_offset(ir_node const *const node, long *const value)
+{
+	if (!is_Const(node))
+		return false;
+	ir_tarval *const tv = get_Const_tarval(node);
+	if (!tarval_is_long(tv))
+		return false;
+	*value = get_tarval_long(tv);
+	return true;
+}
+
+static void generate_value(ir_node *const node, unsigned const var)
+{
+	switch (get_irn_opcode(node)) {
+	case iro_Address: {
+		ir_entity *const ent = get_Address_entity(node);
+		add_cons(PTA_ADDR, var, get_entity_obj(ent), 0);
+		return;
+	}
+
+	case iro_Const:
+		/* addresses from integer constants */
+		add_cons(PTA_ADDR, var, PTA_UNKNOWN, PTA_ANY);
+		return;
+
+	case iro_Member: {
+		ir_node   *const ptr = get_Member_ptr(node);
+		ir_entity *const ent = get_Member_entity(node);
+		if (ptr == get_irg_frame(pta.irg)) {
+			add_cons(PTA_ADDR, var, get_entity_obj(ent), 0);
+		} else {
+			long const offset = is_method_entity(ent) ? PTA_ANY
+			                                          : get_entity_offset(ent);
+			add_cons(PTA_OFFSET, var, get_node_var(ptr), offset);
+		}
+		return;
+	}
+
+	case iro_Sel: {
+		ir_type *const type     = get_Sel_type(node);
+		ir_type *const elem     = get_array_element_type(type);
+		long           offset   = PTA_ANY;
+		long           index;
+		if (get_type_state(elem) == layout_fixed
+		    && get_const_offset(get_Sel_index(node), &index))
+			offset = index * (long)get_type_size(elem);
+		add_cons(PTA_OFFSET, var, get_node_var(get_Sel_ptr(node)), offset);
+		return;
+	}
+
+	case iro_Add:
+	case iro_Sub: {
+		ir_node *const left  = get_binop_left(node);
+		ir_node *const right = get_binop_right(node);
+		long           offset;
+		if (get_const_offset(right, &offset)) {
+			if (is_Sub(node))
+				offset = -offset;
+			add_cons(PTA_OFFSET, var, get_node_var(left), offset);
+		} else if (is_Add(node) && get_const_offset(left, &offset)) {
+			add_cons(PTA_OFFSET, var, get_node_var(right), offset);
+		} else {
+			add_any_offset(var, get_node_var(left));
+			add_any_offset(var, get_node_var(right));
+		}
+		return;
+	}
+
+	case iro_Proj:
+		generate_proj(node, var);
+		return;
+
+	case iro_Conv:
+	case iro_Bitcast: {
+		ir_node *const op = get_irn_n(node, 0);
+		if (is_Const(op) && !tarval_is_null(get_Const_tarval(op))
+		    && mode_is_reference(get_irn_mode(node)))
+			add_cons(PTA_ADDR, var, PTA_UNKNOWN, PTA_ANY);
+		else
+			add_cons(PTA_COPY, var, get_node_var(op), 0);
+		return;
+	}
+
+	case iro_Confirm:
+		add_cons(PTA_COPY, var, get_node_var(get_Confirm_value(node)), 0);
+		return;
+
+	case iro_Id:
+	case iro_Mux:
+	case iro_Phi:
+	case iro_Pin:
+		foreach_irn_in(node, i, op) {
+			add_cons(PTA_COPY, var, get_node_var(op), 0);
+		}
+		return;
+
+	default:
+		foreach_irn_in(node, i, op) {
+			add_any_offset(var, get_node_var(op));
+		}
+		return;
+	}
+}
+
+static void generate_node(ir_node *node, void *env)
+{
+	(void)env;
+	switch (get_irn_opcode(node)) {
+	case iro_Call:
+		(void)get_call(node);
+		return;
+
+	case iro_Store:
+		add_cons(PTA_STORE, get_address_var(get_Store_ptr(node)),
+		         get_node_var(get_Store_value(node)), 0);
+		return;
+
+	case iro_CopyB: {
+		unsigned const src   = new_var(NULL);
+		unsigned const dst   = new_var(NULL);
+		unsigned const value = new_var(NULL);
+		add_any_offset(src, get_address_var(get_CopyB_src(node)));
+		add_any_offset(dst, get_address_var(get_CopyB_dst(node)));
+		add_cons(PTA_LOAD, value, src, 0);
+		add_cons(PTA_STORE, dst, value, 0);
+		return;
+	}
+
+	case iro_Return: {
+		unsigned const *const results = pta.func->results;
+		for (size_t i = 0, n = get_Return_n_ress(node); i < n; ++i) {
+			if (i < ARR_LEN(results))
+				add_cons(PTA_COPY, results[i], get_node_var(get_Return_res(node, i)), 0);
+		}
+		return;
+	}
+
+	case iro_Builtin:
+		generate_builtin(node);
+		return;
+
+	case iro_ASM:
+		for (int i = 0, n = get_ASM_n_inputs(node); i < n; ++i)
+			add_escape(get_node_var(get_ASM_input(node, i)));
+		return;
+
+	default:
+		break;
+	}
+
+	unsigned const var = get_node_var(node);
+	if (var != PTA_NONE)
+		generate_value(node, var);
+}
+
+/**
+ * Generates the constraints initializing the parameter entities of the
+ * current graph with the arguments.
+ */
+static void generate_parameter_entities(void)
+{
+	ir_type        *const frame  = get_irg_frame_type(pta.irg);
+	unsigned const *const params = pta.func->params;
+	for (size_t i = 0, n = get_compound_n_members(frame); i < n; ++i) {
+		ir_entity *const member = get_compound_member(frame, i);
+		if (!is_parameter_entity(member))
+			continue;
+		unsigned const obj = get_entity_obj(member);
+		size_t   const num = get_entity_parameter_number(member);
+		if (num >= ARR_LEN(params)) {
+			/* the variadic arguments */
+			add_escape(new_addr_var(obj, PTA_ANY));
+		} else if (is_compound_type(get_entity_type(member))) {
+			/* compound arguments are passed as a pointer to a copy */
+			unsigned const src   = new_var(NULL);
+			unsigned const value = new_var(NULL);
+			add_any_offset(src, params[num]);
+			add_cons(PTA_LOAD, value, src, 0);
+			add_cons(PTA_STORE, new_addr_var(obj, PTA_ANY), value, 0);
+		} else {
+			add_cons(PTA_STORE, new_addr_var(obj, 0), params[num], 0);
+		}
+	}
+}
+
+static void generate_graph(ir_graph *const irg)
+{
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_NO_TUPLES);
+
+	unsigned const n_nodes = get_irg_last_idx(irg);
+	pta.irg      = irg;
+	pta.func     = get_func(get_irg_entity(irg));
+	pta.node_ids = XMALLOCN(unsigned, n_nodes);
+	memset(pta.node_ids, 0xff, n_nodes * sizeof(*pta.node_ids));
+
+	generate_parameter_entities();
+	irg_walk_graph(irg, NULL, generate_node, NULL);
+
+	free(pta.node_ids);
+	pta.node_ids = NULL;
+}
+
+static void generate_initializer(unsigned obj, long offset, ir_type *type,
+                                 ir_initializer_t const *initializer);
+
+/**
+ * Collects the entities whose addresses are used in @p value.
+ */
+static void generate_initializer_addresses(unsigned const obj,
+                                           ir_node const *const value)
+{
+	if (is_Address(value)) {
+		unsigned const target = get_entity_obj(get_Address_entity(value));
+		add_cons(PTA_STORE, new_addr_var(obj, PTA_ANY),
+		         new_addr_var(target, PTA_ANY), 0);
+	}
+	foreach_irn_in(value, i, op) {
+		generate_initializer_addresses(obj, op);
+	}
+}
+
+static void generate_initializer(unsigned const obj, long const offset,
+                                 ir_type *const type,
+                                 ir_initializer_t const *const initializer)
+{
+	switch (get_initializer_kind(initializer)) {
+	case IR_INITIALIZER_CONST: {
+		ir_node *const value = get_initializer_const_value(initializer);
+		if (is_Address(value) && offset != PTA_ANY) {
+			unsigned const target = get_entity_obj(get_Address_entity(value));
+			add_cons(PTA_STORE, new_addr_var(obj, offset),
+			         new_addr_var(target, 0), 0);
+		} else {
+			generate_initializer_addresses(obj, value);
+		}
+		return;
+	}
+
+	case IR_INITIALIZER_TARVAL:
+	case IR_INITIALIZER_NULL:
+	case IR_INITIALIZER_BYTES:
+		return;
+
+	case IR_INITIALIZER_COMPOUND:
+		for (size_t i = 0, n = get_initializer_compound_n_entries(initializer);
+		     i < n; ++i) {
+			ir_initializer_t *const sub
+				= get_initializer_compound_value(initializer, i);
+			ir_type *sub_type   = NULL;
+			long     sub_offset = PTA_ANY;
+			if (is_Array_type(type)) {
+				sub_type = get_array_element_type(type);
+				if (offset != PTA_ANY && get_type_state(sub_type) == layout_fixed)
+					sub_offset = offset + (long)(i * get_type_size(sub_type));
+			} else if (is_compound_type(type) && i < get_compound_n_members(type)) {
+				ir_entity *const member = get_compound_member(type, i);
+				sub_type = get_entity_type(member);
+				if (offset != PTA_ANY)
+					sub_offset = offset + get_entity_offset(member);
+			}
+			generate_initializer(obj, sub_offset, sub_type, sub);
+		}
+		return;
+	}
+	panic("invalid initializer");
+}
+
+static void generate_initializers(ir_type *const segment)
+{
+	for (size_t i = 0, n = get_compound_n_members(segment); i < n; ++i) {
+		ir_entity *const ent = get_compound_member(segment, i);
+		if (get_entity_kind(ent) != IR_ENTITY_NORMAL)
+			continue;
+		ir_initializer_t const *const initializer
+			= get_entity_initializer(ent);
+		if (initializer != NULL)
+			generate_initializer(get_entity_obj(ent), 0, get_entity_type(ent),
+			                     initializer);
+	}
+}
+
+/**
+ * Lets code outside the program access the entities of @p segment visible
+ * to it.
+ */
+static void generate_visible_entities(ir_type *const segment)
+{
+	for (size_t i = 0, n = get_compound_n_members(segment); i < n; ++i) {
+		ir_entity *const ent = get_compound_member(segment, i);
+		if (entity_is_externally_visible(ent))
+			add_escape(new_addr_var(get_entity_obj(ent), PTA_ANY));
+	}
+}
+
+static int cmp_binding(void const *const elt, void const *const key,
+                       size_t const size)
+{
+	(void)size;
+	pta_binding const *const a = (pta_binding const*)elt;
+	pta_binding const *const b = (pta_binding const*)key;
+	return a->call != b->call || a->obj != b->obj;
+}
+
+static void generate_program(void)
+{
+	obstack_init(&pta.obst);
+	pta.objs      = NEW_ARR_F(pta_obj, 0);
+	pta.obj_map   = pmap_create();
+	pta.var_nodes = NEW_ARR_F(ir_node*, 0);
+	pta.cons      = NEW_ARR_F(pta_cons, 0);
+	pta.calls     = NEW_ARR_F(pta_call, 0);
+	pta.funcs     = pmap_create();
+	pta.bindings  = new_set(cmp_binding, 64);
+
+	/* the unknown object contains pointers to itself */
+	(void)new_obj(PTA_OBJ_UNKNOWN, NULL, NULL, 0);
+	pta.unknown_ptr = new_addr_var(PTA_UNKNOWN, PTA_ANY);
+	add_escape(pta.unknown_ptr);
+
+	foreach_irp_irg(i, irg) {
+		create_func(irg);
+	}
+	generate_visible_entities(get_glob_type());
+	generate_visible_entities(get_tls_type());
+	ir_graph *const main_irg = get_irp_main_irg();
+	if (main_irg != NULL)
+		add_escape(new_addr_var(get_entity_obj(get_irg_entity(main_irg)), 0));
+
+	generate_initializers(get_glob_type());
+	generate_initializers(get_tls_type());
+	foreach_irp_irg(i, irg) {
+		generate_graph(irg);
+	}
+}
+
+static void free_program(void)
+{
+	foreach_pmap(pta.funcs, entry) {
+		pta_func *const func = (pta_func*)entry->value;
+		DEL_ARR_F(func->params);
+		DEL_ARR_F(func->results);
+	}
+	for (size_t i = 0, n = ARR_LEN(pta.calls); i < n; ++i) {
+		DEL_ARR_F(pta.calls[i].args);
+		DEL_ARR_F(pta.calls[i].results);
+	}
+	del_set(pta.bindings);
+	pmap_destroy(pta.funcs);
+	DEL_ARR_F(pta.calls);
+	DEL_ARR_F(pta.cons);
+	DEL_ARR_F(pta.var_nodes);
+	pmap_destroy(pta.obj_map);
+	obstack_free(&pta.obst, NULL);
+	/* the objects live on as part of the result */
+	pta.objs = NULL;
+}
+
+/*--------------------------------------------------------------------------*/
+/* Results                                                                  */
+/*--------------------------------------------------------------------------*/
+
+static int cmp_pts_location(void const *const a, void const *const b)
+{
+	pts_location const *const la = (pts_location const*)a;
+	pts_location const *const lb = (pts_location const*)b;
+	if (la->obj != lb->obj)
+		return la->obj < lb->obj ? -1 : 1;
+	if (la->offset != lb->offset)
+		return la->offset < lb->offset ? -1 : 1;
+	return 0;
+}
+
+static int cmp_points_to_set(void const *const elt, void const *const key,
+                             size_t const size)
+{
+	return memcmp(elt, key, size);
+}
+
+/**
+ * Returns the shared points-to result with the @p n locations in @p set.
+ * Sorts @p set.
+ */
+static points_to_set const *intern_points_to_set(points_to_set *const set)
+{
+	QSORT(set->locs, set->n_locs, cmp_pts_location);
+	size_t   const size = sizeof(*set) + set->n_locs * sizeof(set->locs[0]);
+	unsigned const hash = hash_data((unsigned char const*)set, size);
+	return set_insert(points_to_set, points_to_sets, set, size, hash);
+}
+
+static void set_node_points_to(ir_node *const node,
+                               points_to_set const *const set)
+{
+	ir_graph *const irg = get_irn_irg(node);
+	ir_nodemap_insert(&irg->points_to, node, (void*)set);
+}
+
+static bool has_result(unsigned const var)
+{
+	ir_node *const node = pta.var_nodes[var];
+	return node != NULL && mode_is_reference(get_irn_mode(node));
+}
+
+/*--------------------------------------------------------------------------*/
+/* Andersen's algorithm                                                     */
+/*--------------------------------------------------------------------------*/
+
+typedef struct andersen_var {
+	pts_word *pts;    /**< the points-to set */
+	pts_word *done;   /**< part of the set already propagated */
+	unsigned *succs;  /**< variables including this one */
+	unsigned *cons;   /**< complex constraints with this pointer */
+	bool      queued;
+} andersen_var;
+
+typedef struct andersen_loc {
+	unsigned obj;
+	unsigned offset;  /**< PTA_ANY_OFFSET for any offset */
+	unsigned content; /**< variable holding the content */
+} andersen_loc;
+
+typedef struct andersen_obj {
+	unsigned  any;     /**< location at any offset */
+	unsigned *fields;  /**< locations at fixed offsets */
+	unsigned *readers; /**< variables loading at any offset */
+	bool      escaped;
+} andersen_obj;
+
+/** An entry mapping a field or a copy edge. */
+typedef struct andersen_pair {
+	unsigned a;
+	unsigned b;
+	unsigned value;
+} andersen_pair;
+
+typedef struct andersen_env {
+	andersen_var *vars;
+	andersen_loc *locs;
+	andersen_obj *objs;
+	set          *fields;  /**< (object, offset) -> location */
+	set          *edges;   /**< (from, to) copy edges */
+	deq_t         worklist;
+	size_t        n_cons;  /**< constraints already added */
+	unsigned      unknown_content;
+} andersen_env;
+
+static int cmp_andersen_pair(void const *const elt, void const *const key,
+                             size_t const size)
+{
+	(void)size;
+	andersen_pair const *const a = (andersen_pair const*)elt;
+	andersen_pair const *const b = (andersen_pair const*)key;
+	return a->a != b->a || a->b != b->b;
+}
+
+/** Returns the state of @p var, allocating it if it is new. */
+static andersen_var *andersen_get_var(andersen_env *const env,
+                                      unsigned const var)
+{
+	while (ARR_LEN(env->vars) <= var) {
+		andersen_var const fresh = { NULL, NULL, NULL, NULL, false };
+		ARR_APP1(andersen_var, env->vars, fresh);
+	}
+	return &env->vars[var];
+}
+
+static void andersen_push(andersen_env *const env, unsigned const var)
+{
+	andersen_var *const v = andersen_get_var(env, var);
+	if (v->queued)
+		return;
+	v->queued = true;
+	*(unsigned*)deq_alloc_right(&env->worklist, sizeof(unsigned)) = var;
+}
+
+static void andersen_add_loc(andersen_env *const env, unsigned const var,
+                             unsigned const loc)
+{
+	if (pts_insert(&andersen_get_var(env, var)->pts, loc))
+		andersen_push(env, var);
+}
+
+static void andersen_add_edge(andersen_env *const env, unsigned const from,
+                              unsigned const to)
+{
+	if (from == to)
+		return;
+	andersen_pair const key  = { from, to, 0 };
+	unsigned      const hash = hash_combine(from, to);
+	if (set_find(andersen_pair, env->edges, &key, sizeof(key), hash) != NULL)
+		return;
+	(void)set_insert(andersen_pair, env->edges, &key, sizeof(key), hash);
+
+	andersen_get_var(env, to);
+	andersen_var *const f = andersen_get_var(env, from);
+	if (f->succs == NULL)
+		f->succs = NEW_ARR_F(unsigned, 0);
+	ARR_APP1(unsigned, f->succs, to);
+	if (pts_union(&env->vars[to].pts, f->pts))
+		andersen_push(env, to);
+}
+
+static unsigned andersen_new_loc(andersen_env *const env, unsigned const obj,
+                                 unsigned const offset)
+{
+	unsigned     const loc = ARR_LEN(env->locs);
+	andersen_loc const l   = { obj, offset, new_var(NULL) };
+	ARR_APP1(andersen_loc, env->locs, l);
+	return loc;
+}
+
+static void andersen_add_reader(andersen_env *const env, unsigned const obj,
+                                unsigned const var)
+{
+	andersen_obj *const o = &env->objs[obj];
+	for (size_t i = 0, n = ARR_LEN(o->readers); i < n; ++i) {
+		if (o->readers[i] == var)
+			return;
+	}
+	ARR_APP1(unsigned, o->readers, var);
+	andersen_add_edge(env, env->locs[o->any].content, var);
+	for (size_t i = 0; i < ARR_LEN(env->objs[obj].fields); ++i) {
+		unsigned const field = env->objs[obj].fields[i];
+		andersen_add_edge(env, env->locs[field].content, var);
+	}
+}
+
+/**
+ * Returns the location of @p obj at @p offset.
+ */
+static unsigned andersen_get_loc(andersen_env *const env, unsigned const obj,
+                                 long const offset)
+{
+	andersen_obj *const o = &env->objs[obj];
+	if (offset < 0 || (unsigned long)offset >= pta.objs[obj].limit
+	    || ARR_LEN(o->fields) >= PTA_MAX_FIELDS)
+		return o->any;
+
+	andersen_pair const key  = { obj, (unsigned)offset, 0 };
+	unsigned      const hash = hash_combine(obj, (unsigned)offset);
+	andersen_pair const *const found
+		= set_find(andersen_pair, env->fields, &key, sizeof(key), hash);
+	if (found != NULL)
+		return found->value;
+
+	unsigned const loc = andersen_new_loc(env, obj, (unsigned)offset);
+	andersen_pair const entry = { obj, (unsigned)offset, loc };
+	(void)set_insert(andersen_pair, env->fields, &entry, sizeof(entry), hash);
+	ARR_APP1(unsigned, env->objs[obj].fields, loc);
+
+	/* stores at any offset reach the field, loads at any offset read it */
+	unsigned const content = env->locs[loc].content;
+	andersen_add_edge(env, env->locs[env->objs[obj].any].content, content);
+	for (size_t i = 0; i < ARR_LEN(env->objs[obj].readers); ++i)
+		andersen_add_edge(env, content, env->objs[obj].readers[i]);
+	return loc;
+}
+
+static unsigned andersen_shift(andersen_env *const env, unsigned const loc,
+                               long const offset)
+{
+	andersen_loc const l = env->locs[loc];
+	if (l.offset == PTA_ANY_OFFSET || offset == PTA_ANY)
+		return env->objs[l.obj].any;
+	return andersen_get_loc(env, l.obj, (long)l.offset + offset);
+}
+
+/**
+ * Lets code outside the program access @p obj.
+ */
+static void andersen_escape(andersen_env *const env, unsigned const obj)
+{
+	if (env->objs[obj].escaped)
+		return;
+	env->objs[obj].escaped = true;
+	DB((dbg, LEVEL_2, "escaped: object %u\n", obj));
+
+	unsigned const unknown = env->unknown_content;
+	andersen_add_reader(env, obj, unknown);
+	andersen_add_edge(env, unknown, env->locs[env->objs[obj].any].content);
+	andersen_add_loc(env, unknown, env->objs[obj].any);
+
+	pta_obj const *const o = &pta.objs[obj];
+	if (o->kind == PTA_OBJ_FUNCTION) {
+		pta_func *const func = get_func(o->ent);
+		if (func != NULL)
+			escape_func(func);
+	}
+}
+
+static void andersen_apply(andersen_env *const env, pta_cons const *const cons,
+                           unsigned const loc)
+{
+	switch (cons->kind) {
+	case PTA_LOAD: {
+		andersen_loc const l = env->locs[loc];
+		andersen_add_edge(env, l.content, cons->dst);
+		if (l.offset == PTA_ANY_OFFSET)
+			andersen_add_reader(env, l.obj, cons->dst);
+		return;
+	}
+	case PTA_STORE:
+		andersen_add_edge(env, cons->src, env->locs[loc].content);
+		return;
+	case PTA_OFFSET:
+		andersen_add_loc(env, cons->dst, andersen_shift(env, loc, cons->offset));
+		return;
+	case PTA_CALL:
+		bind_call(cons->src, env->locs[loc].obj);
+		return;
+	case PTA_ADDR:
+	case PTA_COPY:
+		break;
+	}
+	panic("invalid complex constraint");
+}
+
+static void andersen_add_cons(andersen_env *const env, unsigned const idx)
+{
+	pta_cons const cons = pta.cons[idx];
+	switch (cons.kind) {
+	case PTA_ADDR: {
+		unsigned const loc = cons.offset == PTA_ANY
+			? env->objs[cons.src].any
+			: andersen_get_loc(env, cons.src, cons.offset);
+		andersen_add_loc(env, cons.dst, loc);
+		return;
+	}
+	case PTA_COPY:
+		andersen_add_edge(env, cons.src, cons.dst);
+		return;
+	case PTA_OFFSET:
+	case PTA_LOAD:
+	case PTA_STORE:
+	case PTA_CALL: {
+		unsigned const ptr = cons.kind == PTA_STORE || cons.kind == PTA_CALL
+		                     ? cons.dst : cons.src;
+		andersen_var *const v = andersen_get_var(env, ptr);
+		if (v->cons == NULL)
+			v->cons = NEW_ARR_F(unsigned, 0);
+		ARR_APP1(unsigned, v->cons, idx);
+		/* the rest is applied when the variable is processed */
+		pts_word const *const done = v->done;
+		foreach_pts(done, loc) {
+			andersen_apply(env, &cons, loc);
+		}
+		return;
+	}
+	}
+	panic("invalid constraint");
+}
+
+static void andersen_process(andersen_env *const env, unsigned const var)
+{
+	andersen_var *v = &env->vars[var];
+	v->queued = false;
+	pts_word *const delta = pts_difference(v->pts, v->done);
+	if (delta == NULL)
+		return;
+	pts_union(&v->done, delta);
+
+	if (var == env->unknown_content) {
+		foreach_pts(delta, loc) {
+			andersen_escape(env, env->locs[loc].obj);
+		}
+	}
+	for (size_t i = 0; env->vars[var].cons != NULL
+	     && i < ARR_LEN(env->vars[var].cons); ++i) {
+		pta_cons const cons = pta.cons[env->vars[var].cons[i]];
+		foreach_pts(delta, loc) {
+			andersen_apply(env, &cons, loc);
+		}
+	}
+	for (size_t i = 0; env->vars[var].succs != NULL
+	     && i < ARR_LEN(env->vars[var].succs); ++i) {
+		unsigned const succ = env->vars[var].succs[i];
+		if (pts_union(&env->vars[succ].pts, delta))
+			andersen_push(env, succ);
+	}
+	DEL_ARR_F(delta);
+}
+
+static void andersen_build_results(andersen_env *const env)
+{
+	size_t const n_objs = ARR_LEN(pta.objs);
+	for (size_t i = 0; i < n_objs; ++i)
+		pta.objs[i].escaped = env->objs[i].escaped;
+
+	pts_location  *locs = NEW_ARR_F(pts_location, 0);
+	points_to_set *buf  = NULL;
+	for (size_t var = 0, n = ARR_LEN(pta.var_nodes); var < n; ++var) {
+		if (!has_result(var) || var >= ARR_LEN(env->vars))
+			continue;
+		pts_word const *const pts = env->vars[var].pts;
+		ARR_SHRINKLEN(locs, 0);
+		foreach_pts(pts, loc) {
+			pts_location const l = { env->locs[loc].obj, env->locs[loc].offset };
+			ARR_APP1(pts_location, locs, l);
+		}
+		size_t const n_locs = ARR_LEN(locs);
+		buf = xrealloc(buf, sizeof(*buf) + n_locs * sizeof(buf->locs[0]));
+		buf->n_locs = n_locs;
+		memcpy(buf->locs, locs, n_locs * sizeof(locs[0]));
+		set_node_points_to(pta.var_nodes[var], intern_points_to_set(buf));
+	}
+	free(buf);
+	DEL_ARR_F(locs);
+}
+
+static void solve_andersen(void)
+{
+	andersen_env env;
+	env.vars   = NEW_ARR_F(andersen_var, 0);
+	env.locs   = NEW_ARR_F(andersen_loc, 0);
+	env.objs   = NEW_ARR_F(andersen_obj, ARR_LEN(pta.objs));
+	env.fields = new_set(cmp_andersen_pair, 256);
+	env.edges  = new_set(cmp_andersen_pair, 1024);
+	env.n_cons = 0;
+	deq_init(&env.worklist);
+	for (size_t i = 0, n = ARR_LEN(pta.objs); i < n; ++i) {
+		env.objs[i].any     = andersen_new_loc(&env, i, PTA_ANY_OFFSET);
+		env.objs[i].fields  = NEW_ARR_F(unsigned, 0);
+		env.objs[i].readers = NEW_ARR_F(unsigned, 0);
+		env.objs[i].escaped = false;
+	}
+	env.unknown_content = env.locs[env.objs[PTA_UNKNOWN].any].content;
+
+	for (;;) {
+		while (env.n_cons < ARR_LEN(pta.cons))
+			andersen_add_cons(&env, env.n_cons++);
+		if (deq_empty(&env.worklist))
+			break;
+		unsigned const var = *(unsigned*)deq_left_end(&env.worklist);
+		deq_shrink_left(&env.worklist, sizeof(unsigned));
+		andersen_process(&env, var);
+	}
+	DB((dbg, LEVEL_1, "andersen: %zu variables, %zu locations, %zu edges\n",
+	    ARR_LEN(env.vars), ARR_LEN(env.locs), set_count(env.edges)));
+
+	andersen_build_results(&env);
+
+	for (size_t i = 0, n = ARR_LEN(env.vars); i < n; ++i) {
+		andersen_var *const v = &env.vars[i];
+		if (v->pts != NULL)
+			DEL_ARR_F(v->pts);
+		if (v->done != NULL)
+			DEL_ARR_F(v->done);
+		if (v->succs != NULL)
+			DEL_ARR_F(v->succs);
+		if (v->cons != NULL)
+			DEL_ARR_F(v->cons);
+	}
+	for (size_t i = 0, n = ARR_LEN(env.objs); i < n; ++i) {
+		DEL_ARR_F(env.objs[i].fields);
+		DEL_ARR_F(env.objs[i].readers);
+	}
+	deq_free(&env.worklist);
+	del_set(env.edges);
+	del_set(env.fields);
+	DEL_ARR_F(env.objs);
+	DEL_ARR_F(env.locs);
+	DEL_ARR_F(env.vars);
+}
+
+/*--------------------------------------------------------------------------*/
+/* Steensgaard's algorithm                                                  */
+/*--------------------------------------------------------------------------*/
+
+/**
+ * Every variable and object is an element of the union-find structure. The
+ * representative of a class knows the class all its members point to.
+ */
+typedef struct steensgaard_env {
+	int *uf;        /**< union-find data of the elements */
+	int *pointee;   /**< the pointee class of a representative or -1 */
+	int *var_elems; /**< the element of each variable or -1 */
+	int *obj_elems; /**< the element of each object */
+	int *pending;   /**< pairs of classes to join */
+} steensgaard_env;
+
+static int steensgaard_new_elem(steensgaard_env *const env)
+{
+	int const elem = ARR_LEN(env->uf);
+	ARR_APP1(int, env->uf, -1);
+	ARR_APP1(int, env->pointee, -1);
+	return elem;
+}
+
+static int steensgaard_var_elem(steensgaard_env *const env, unsigned const var)
+{
+	while (ARR_LEN(env->var_elems) <= var)
+		ARR_APP1(int, env->var_elems, -1);
+	if (env->var_elems[var] < 0)
+		env->var_elems[var] = steensgaard_new_elem(env);
+	return env->var_elems[var];
+}
+
+/** Returns the class @p elem points to, creating it if necessary. */
+static int steensgaard_pointee(steensgaard_env *const env, int const elem)
+{
+	int const repr = uf_find(env->uf, elem);
+	if (env->pointee[repr] < 0) {
+		int const pointee = steensgaard_new_elem(env);
+		env->pointee[repr] = pointee;
+	}
+	return uf_find(env->uf, env->pointee[repr]);
+}
+
+static void steensgaard_join(steensgaard_env *const env, int const a,
+                             int const b)
+{
+	ARR_APP1(int, env->pending, a);
+	ARR_APP1(int, env->pending, b);
+	while (ARR_LEN(env->pending) > 0) {
+		size_t const n = ARR_LEN(env->pending);
+		int    const x = uf_find(env->uf, env->pending[n - 2]);
+		int    const y = uf_find(env->uf, env->pending[n - 1]);
+		ARR_SHRINKLEN(env->pending, n - 2);
+		if (x == y)
+			continue;
+		int const px   = env->pointee[x];
+		int const py   = env->pointee[y];
+		int const repr = uf_union(env->uf, x, y);
+		if (px >= 0 && py >= 0) {
+			env->pointee[repr] = px;
+			ARR_APP1(int, env->pending, px);
+			ARR_APP1(int, env->pending, py);
+		} else {
+			env->pointee[repr] = px >= 0 ? px : py;
+		}
+	}
+}
+
+static void steensgaard_add_cons(steensgaard_env *const env,
+                                 pta_cons const *const cons)
+{
+	int const dst = steensgaard_var_elem(env, cons->dst);
+	switch (cons->kind) {
+	case PTA_ADDR:
+		steensgaard_join(env, steensgaard_pointee(env, dst),
+		                 env->obj_elems[cons->src]);
+		return;
+	case PTA_COPY:
+	case PTA_OFFSET: {
+		int const src = steensgaard_var_elem(env, cons->src);
+		steensgaard_join(env, steensgaard_pointee(env, dst),
+		                 steensgaard_pointee(env, src));
+		return;
+	}
+	case PTA_LOAD: {
+		int const src     = steensgaard_var_elem(env, cons->src);
+		int const content = steensgaard_pointee(env, steensgaard_pointee(env, src));
+		steensgaard_join(env, steensgaard_pointee(env, dst), content);
+		return;
+	}
+	case PTA_STORE: {
+		int const src     = steensgaard_var_elem(env, cons->src);
+		int const content = steensgaard_pointee(env, steensgaard_pointee(env, dst));
+		steensgaard_join(env, content, steensgaard_pointee(env, src));
+		return;
+	}
+	case PTA_CALL:
+		/* resolved in rounds */
+		(void)steensgaard_pointee(env, dst);
+		return;
+	}
+	panic("invalid constraint");
+}
+
+/**
+ * Returns the first object of each class in @p heads and the next object of
+ * the same class in @p next.
+ */
+static void steensgaard_classes(steensgaard_env *const env, int **const heads,
+                                int **const next)
+{
+	size_t const n_elems = ARR_LEN(env->uf);
+	size_t const n_objs  = ARR_LEN(pta.objs);
+	*heads = XMALLOCN(int, n_elems);
+	*next  = XMALLOCN(int, n_objs);
+	memset(*heads, 0xff, n_elems * sizeof(**heads));
+	for (size_t i = n_objs; i-- > 0;) {
+		int const repr = uf_find(env->uf, env->obj_elems[i]);
+		(*next)[i]     = (*heads)[repr];
+		(*heads)[repr] = i;
+	}
+}
+
+/**
+ * Binds all calls to the objects their addresses point to. Returns true if
+ * new constraints were generated.
+ */
+static bool steensgaard_bind_calls(steensgaard_env *const env)
+{
+	size_t const n_cons = ARR_LEN(pta.cons);
+	int         *heads;
+	int         *next;
+	steensgaard_classes(env, &heads, &next);
+
+	for (size_t i = 0; i < n_cons; ++i) {
+		pta_cons const cons = pta.cons[i];
+		if (cons.kind != PTA_CALL)
+			continue;
+		int const elem    = steensgaard_var_elem(env, cons.dst);
+		int const pointee = steensgaard_pointee(env, elem);
+		for (int obj = heads[pointee]; obj >= 0; obj = next[obj])
+			bind_call(cons.src, obj);
+	}
+
+	/* functions reachable from outside */
+	int const unknown = uf_find(env->uf, env->obj_elems[PTA_UNKNOWN]);
+	for (int obj = heads[unknown]; obj >= 0; obj = next[obj]) {
+		pta_obj const *const o = &pta.objs[obj];
+		if (o->kind == PTA_OBJ_FUNCTION) {
+			pta_func *const func = get_func(o->ent);
+			if (func != NULL)
+				escape_func(func);
+		}
+	}
+
+	free(next);
+	free(heads);
+	return ARR_LEN(pta.cons) > n_cons;
+}
+
+static void steensgaard_build_results(steensgaard_env *const env)
+{
+	int *heads;
+	int *next;
+	steensgaard_classes(env, &heads, &next);
+
+	size_t const n_objs  = ARR_LEN(pta.objs);
+	int    const unknown = uf_find(env->uf, env->obj_elems[PTA_UNKNOWN]);
+	for (size_t i = 0; i < n_objs; ++i)
+		pta.objs[i].escaped = uf_find(env->uf, env->obj_elems[i]) == unknown;
+
+	/* all members of a class share the result */
+	size_t                const n_elems = ARR_LEN(env->uf);
+	points_to_set const **const sets    = XMALLOCNZ(points_to_set const*, n_elems);
+	points_to_set        *const buf
+		= xmalloc(sizeof(*buf) + n_objs * sizeof(buf->locs[0]));
+	for (size_t var = 0, n = ARR_LEN(pta.var_nodes); var < n; ++var) {
+		if (!has_result(var) || var >= ARR_LEN(env->var_elems)
+		    || env->var_elems[var] < 0)
+			continue;
+		int const repr = uf_find(env->uf, env->var_elems[var]);
+		if (env->pointee[repr] < 0)
+			continue;
+		int const pointee = uf_find(env->uf, env->pointee[repr]);
+		if (sets[pointee] == NULL) {
+			buf->n_locs = 0;
+			for (int obj = heads[pointee]; obj >= 0; obj = next[obj])
+				buf->locs[buf->n_locs++] = (pts_location){ obj, PTA_ANY_OFFSET };
+			sets[pointee] = intern_points_to_set(buf);
+		}
+		set_node_points_to(pta.var_nodes[var], sets[pointee]);
+	}
+	free(buf);
+	free(sets);
+	free(next);
+	free(heads);
+}
+
+static void solve_steensgaard(void)
+{
+	steensgaard_env env;
+	env.uf        = NEW_ARR_F(int, 0);
+	env.pointee   = NEW_ARR_F(int, 0);
+	env.var_elems = NEW_ARR_F(int, 0);
+	env.obj_elems = NEW_ARR_F(int, ARR_LEN(pta.objs));
+	env.pending   = NEW_ARR_F(int, 0);
+	for (size_t i = 0, n = ARR_LEN(pta.objs); i < n; ++i)
+		env.obj_elems[i] = steensgaard_new_elem(&env);
+
+	size_t n_cons = 0;
+	unsigned n_rounds = 0;
+	do {
+		for (; n_cons < ARR_LEN(pta.cons); ++n_cons) {
+			pta_cons const cons = pta.cons[n_cons];
+			steensgaard_add_cons(&env, &cons);
+		}
+		++n_rounds;
+	} while (steensgaard_bind_calls(&env));
+	DB((dbg, LEVEL_1, "steensgaard: %zu elements, %u rounds\n",
+	    ARR_LEN(env.uf), n_rounds));
+
+	steensgaard_build_results(&env);
+
+	DEL_ARR_F(env.pending);
+	DEL_ARR_F(env.obj_elems);
+	DEL_ARR_F(env.var_elems);
+	DEL_ARR_F(env.pointee);
+	DEL_ARR_F(env.uf);
+}
+
+/*--------------------------------------------------------------------------*/
+/* Interface                                                                */
+/*--------------------------------------------------------------------------*/
+
+static void free_alias_oracles(void)
+{
+	/* cached alias relations may change */
+	foreach_irp_irg(i, irg) {
+		ir_free_alias_oracle(irg);
+	}
+}
+
+void compute_irp_points_to(ir_points_to_mode const mode)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.ana.pointsto");
+
+	free_irp_points_to();
+	generate_program();
+	DB((dbg, LEVEL_1, "%zu objects, %zu variables, %zu constraints\n",
+	    ARR_LEN(pta.objs), ARR_LEN(pta.var_nodes), ARR_LEN(pta.cons)));
+
+	points_to_sets = new_set(cmp_points_to_set, 256);
+	foreach_irp_irg(i, irg) {
+		ir_nodemap_init(&irg->points_to, irg);
+	}
+	switch (mode) {
+	case ir_points_to_steensgaard: solve_steensgaard(); break;
+	case ir_points_to_andersen:    solve_andersen();    break;
+	}
+	points_to_objs = pta.objs;
+	DB((dbg, LEVEL_1, "%zu distinct points-to sets\n",
+	    set_count(points_to_sets)));
+
+	free_program();
+	free_alias_oracles();
+}
+
+void free_irg_points_to(ir_graph *const irg)
+{
+	if (irg->points_to.data != NULL)
+		ir_nodemap_destroy(&irg->points_to);
+}
+
+void free_irp_points_to(void)
+{
+	if (points_to_objs == NULL)
+		return;
+	foreach_irp_irg(i, irg) {
+		free_irg_points_to(irg);
+	}
+	del_set(points_to_sets);
+	DEL_ARR_F(points_to_objs);
+	points_to_sets = NULL;
+	points_to_objs = NULL;
+	free_alias_oracles();
+}
+
+static points_to_set const *get_points_to_set(ir_node const *const node)
+{
+	ir_graph const *const irg = get_irn_irg(node);
+	if (irg->points_to.data == NULL)
+		return NULL;
+	points_to_set const *const set
+		= ir_nodemap_get(points_to_set const, &irg->points_to, node);
+	if (set == NULL || set->n_locs == 0)
+		return NULL;
+	return set;
+}
+
+/**
+ * Returns true if an address in @p set may point to memory accessible by
+ * code outside the program.
+ */
+static bool may_point_to_escaped(points_to_set const *const set)
+{
+	for (unsigned i = 0; i < set->n_locs; ++i) {
+		if (points_to_objs[set->locs[i].obj].escaped)
+			return true;
+	}
+	return false;
+}
+
+static bool overlap(pts_location const *const l1, unsigned const size1,
+                    pts_location const *const l2, unsigned const size2)
+{
+	if (l1->offset == PTA_ANY_OFFSET || l2->offset == PTA_ANY_OFFSET
+	    || size1 == 0 || size2 == 0)
+		return true;
+	unsigned long const begin1 = l1->offset;
+	unsigned long const begin2 = l2->offset;
+	return begin1 < begin2 + size2 && begin2 < begin1 + size1;
+}
+
+ir_alias_relation get_points_to_relation(ir_node const *const addr1,
+                                         unsigned const size1,
+                                         ir_node const *const addr2,
+                                         unsigned const size2)
+{
+	points_to_set const *const set1 = get_points_to_set(addr1);
+	if (set1 == NULL)
+		return ir_may_alias;
+	points_to_set const *const set2 = get_points_to_set(addr2);
+	if (set2 == NULL)
+		return ir_may_alias;
+
+	/* the unknown object is the first one in a set */
+	bool const unknown1 = set1->locs[0].obj == PTA_UNKNOWN;
+	bool const unknown2 = set2->locs[0].obj == PTA_UNKNOWN;
+	if ((unknown1 && may_point_to_escaped(set2))
+	    || (unknown2 && may_point_to_escaped(set1)))
+		return ir_may_alias;
+
+	for (unsigned i = 0, j = 0; i < set1->n_locs && j < set2->n_locs;) {
+		pts_location const *const l1 = &set1->locs[i];
+		pts_location const *const l2 = &set2->locs[j];
+		if (l1->obj < l2->obj) {
+			++i;
+		} else if (l2->obj < l1->obj) {
+			++j;
+		} else {
+			for (unsigned k = j; k < set2->n_locs
+			     && set2->locs[k].obj == l1->obj; ++k) {
+				if (overlap(l1, size1, &set2->locs[k], size2))
+					return ir_may_alias;
+			}
+			++i;
+		}
+	}
+	return ir_no_alias;
+}
+
+ir_entity **get_points_to_callees(ir_node const *const ptr)
+{
+	points_to_set const *const set = get_points_to_set(ptr);
+	if (set == NULL)
+		return NULL;
+	for (unsigned i = 0; i < set->n_locs; ++i) {
+		if (points_to_objs[set->locs[i].obj].kind != PTA_OBJ_FUNCTION)
+			return NULL;
+	}
+	ir_entity **const callees = NEW_ARR_F(ir_entity*, set->n_locs);
+	for (unsigned i = 0; i < set->n_locs; ++i)
+		callees[i] = points_to_objs[set->locs[i].obj].ent;
+	return callees;
+}
+
+void const **get_points_to_objects(ir_node const *const addr)
+{
+	points_to_set const *const set = get_points_to_set(addr);
+	if (set == NULL)
+		return NULL;
+	void const **objs = NEW_ARR_F(void const*, 0);
+	for (unsigned i = 0; i < set->n_locs; ++i) {
+		pta_obj const *const obj = &points_to_objs[set->locs[i].obj];
+		void const    *key       = NULL;
+		if (obj->kind != PTA_OBJ_UNKNOWN && !obj->escaped)
+			key = obj->ent != NULL ? (void const*)obj->ent : obj->site;
+		/* the locations of an object are adjacent */
+		size_t const n = ARR_LEN(objs);
+		if (n == 0 || objs[n - 1] != key)
+			ARR_APP1(void const*, objs, key);
+	}
+	return objs;
+}
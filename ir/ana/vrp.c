@@ -7,48 +7,98 @@
  * @file
  * @brief   analyze graph to provide value range information
  * @author  Jonas Fietz
+ *
+ * Ranges are computed by sparse propagation over the SSA graph: a worklist
+ * holds the nodes whose operands changed, and only their users are visited
+ * again. Ranges start empty and grow (ascending phase). To terminate on
+ * loops, the ranges of Phis in loop headers are widened to the bounds of
+ * their mode after a few changes. A following descending phase recomputes
+ * all nodes and intersects the result with the old range, which recovers the
+ * bounds established by the loop tests (narrowing).
+ *
+ * Confirm nodes refine ranges by their relation to the bound. Additionally,
+ * induction variables, i.e. loop header Phis incremented by a constant on
+ * every back edge, are matched with the comparison against a loop-invariant
+ * bound which controls the loop. This refines the incremented value even if
+ * no Confirm exists and gives the symbolic relation of the induction variable
+ * to the bound, which vrp_cmp() reports.
  */
 #include "vrp.h"
 
-#include "bitset.h"
+#include "array.h"
 #include "debug.h"
-#include "iredges_t.h"
-#include "irgopt.h"
+#include "irdom.h"
 #include "irgraph_t.h"
 #include "irgwalk.h"
 #include "irhooks.h"
 #include "irnodemap.h"
-#include "iroptimize.h"
 #include "irouts_t.h"
 #include "irprintf.h"
+#include "irthread.h"
 #include "pdeq.h"
 #include "tv.h"
+#include "util.h"
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 
+/** Number of range changes of a loop header Phi before it is widened. */
+#define WIDEN_DELAY  2
+/** Number of range changes of any node before it is given up. */
+#define MAX_UPDATES  16
+/** Number of range changes of a node while narrowing. */
+#define NARROW_STEPS 4
+
+/** The VRP information of a node together with the analysis state. */
+typedef struct vrp_node_t {
+	vrp_attr     attr;         /**< the result, must be the first member */
+	unsigned     n_updates;    /**< number of range changes so far */
+	bool         in_queue;     /**< node is in the workqueue */
+	bool         is_header;    /**< node is a Phi of a loop header */
+	bool         is_iv_bound;  /**< node is the bound of an induction
+	                                variable */
+	ir_tarval   *iv_step;      /**< step of an induction variable or NULL */
+	ir_node     *iv_bound;     /**< loop-invariant bound of the loop test */
+	ir_relation  iv_relation;  /**< relation of the induction variable to the
+	                                bound, which holds on the back edges */
+	ir_relation  iv_possible;  /**< possible relations of the induction
+	                                variable to the bound */
+} vrp_node_t;
+
 typedef struct vrp_env_t {
 	deq_t        workqueue;
-	bitset_t    *visited;
 	ir_vrp_info *info;
+	ir_node    **ivs;       /**< the induction variables */
+	bool         narrowing; /**< in the descending phase */
 } vrp_env_t;
 
-static vrp_attr *vrp_get_or_set_info(ir_vrp_info *info, const ir_node *node)
+/** A range of values including both bounds, empty if lo is NULL. */
+typedef struct range_t {
+	ir_tarval *lo;
+	ir_tarval *hi;
+} range_t;
+
+static const range_t empty_range = { NULL, NULL };
+
+typedef ir_tarval *(*tarval_binop)(ir_tarval const *a, ir_tarval const *b);
+
+static vrp_node_t *get_vrp_node(ir_vrp_info *info, const ir_node *node)
 {
-	vrp_attr *attr = ir_nodemap_get(vrp_attr, &info->infos, node);
-	if (attr == NULL) {
+	vrp_node_t *vrp = ir_nodemap_get(vrp_node_t, &info->infos, node);
+	if (vrp == NULL) {
 		ir_mode *mode = get_irn_mode(node);
 		assert(mode_is_int(mode));
 
-		attr = OALLOCZ(&info->obst, vrp_attr);
-		attr->range_type   = VRP_UNDEFINED;
-		attr->bits_set     = get_mode_null(mode);
-		attr->bits_not_set = get_mode_all_one(mode);
-		attr->range_bottom = tarval_bad;
-		attr->range_top    = tarval_bad;
+		vrp = OALLOCZ(&info->obst, vrp_node_t);
+		vrp->attr.range_type   = VRP_UNDEFINED;
+		vrp->attr.bits_set     = get_mode_null(mode);
+		vrp->attr.bits_not_set = get_mode_all_one(mode);
+		vrp->attr.range_bottom = tarval_bad;
+		vrp->attr.range_top    = tarval_bad;
+		vrp->iv_possible       = ir_relation_true;
 
-		ir_nodemap_insert(&info->infos, node, attr);
+		ir_nodemap_insert(&info->infos, node, vrp);
 	}
-	return attr;
+	return vrp;
 }
 
 vrp_attr *vrp_get_info(const ir_node *node)
@@ -56,177 +106,489 @@ vrp_attr *vrp_get_info(const ir_node *node)
 	ir_graph *irg = get_irn_irg(node);
 	if (irg->vrp.infos.data == NULL)
 		return NULL;
-	return ir_nodemap_get(vrp_attr, &irg->vrp.infos, node);
+	vrp_node_t *vrp = ir_nodemap_get(vrp_node_t, &irg->vrp.infos, node);
+	return vrp != NULL ? &vrp->attr : NULL;
 }
 
-static int vrp_update_node(ir_vrp_info *info, ir_node *node)
+static range_t make_range(ir_tarval *lo, ir_tarval *hi)
 {
-	ir_tarval       *new_bits_set      = get_tarval_bad();
-	ir_tarval       *new_bits_not_set  = get_tarval_bad();
-	ir_tarval       *new_range_bottom  = get_tarval_bad();
-	ir_tarval       *new_range_top     = get_tarval_bad();
-	enum range_types new_range_type    = VRP_UNDEFINED;
-	bool             something_changed = false;
-	if (!mode_is_int(get_irn_mode(node))) {
-		return 0; /* we don't optimize for non-int-nodes*/
-	}
+	range_t range = { lo, hi };
+	return range;
+}
 
-	vrp_attr *vrp = vrp_get_or_set_info(info, node);
+static range_t full_range(ir_mode *mode)
+{
+	return make_range(get_mode_min(mode), get_mode_max(mode));
+}
 
-	/* TODO: Check if all predecessors have valid VRP information*/
+static bool is_less(ir_tarval *a, ir_tarval *b)
+{
+	return tarval_cmp(a, b) == ir_relation_less;
+}
 
-	switch (get_irn_opcode(node)) {
-	case iro_Const: {
-		ir_tarval *tv = get_Const_tarval(node);
-		new_bits_set = tv;
-		new_bits_not_set = tv;
-		new_range_bottom = tv;
-		new_range_top = tv;
-		new_range_type = VRP_RANGE;
-		break;
-	}
-	case iro_And: {
-		const vrp_attr *vrp_left, *vrp_right;
-		const ir_node *left, *right;
+static ir_tarval *tv_min(ir_tarval *a, ir_tarval *b)
+{
+	return is_less(b, a) ? b : a;
+}
+
+static ir_tarval *tv_max(ir_tarval *a, ir_tarval *b)
+{
+	return is_less(a, b) ? b : a;
+}
+
+/** Returns the smallest range containing @p a and @p b. */
+static range_t join(range_t a, range_t b)
+{
+	if (a.lo == NULL)
+		return b;
+	if (b.lo == NULL)
+		return a;
+	return make_range(tv_min(a.lo, b.lo), tv_max(a.hi, b.hi));
+}
+
+/** Returns the intersection of @p a and @p b. */
+static range_t meet(range_t a, range_t b)
+{
+	if (a.lo == NULL || b.lo == NULL)
+		return empty_range;
+	ir_tarval *const lo = tv_max(a.lo, b.lo);
+	ir_tarval *const hi = tv_min(a.hi, b.hi);
+	return is_less(hi, lo) ? empty_range : make_range(lo, hi);
+}
 
-		left = get_And_left(node);
-		right = get_And_right(node);
-		vrp_left = vrp_get_or_set_info(info, left);
-		vrp_right = vrp_get_or_set_info(info, right);
-		new_bits_set = tarval_and(vrp_left->bits_set, vrp_right->bits_set);
-		new_bits_not_set = tarval_and(vrp_left->bits_not_set, vrp_right->bits_not_set);
+/** Computes @p op without wrap around, returns tarval_bad on overflow. */
+static ir_tarval *exact(tarval_binop op, ir_tarval *a, ir_tarval *b)
+{
+	int const wrap = tarval_get_wrap_on_overflow();
+	tarval_set_wrap_on_overflow(false);
+	ir_tarval *const res = op(a, b);
+	tarval_set_wrap_on_overflow(wrap);
+	return res;
+}
 
+/** Returns the range from @p lo to @p hi, or the full range of @p mode if one
+ * of the bounds overflowed. */
+static range_t checked_range(ir_tarval *lo, ir_tarval *hi, ir_mode *mode)
+{
+	if (lo == tarval_bad || hi == tarval_bad)
+		return full_range(mode);
+	return make_range(lo, hi);
+}
+
+/** Converts @p tv to @p mode, returns NULL if the value changes. */
+static ir_tarval *convert_exact(ir_tarval *tv, ir_mode *mode)
+{
+	ir_tarval *const res = tarval_convert_to(tv, mode);
+	if (tarval_is_negative(res) != tarval_is_negative(tv)
+	    || tarval_convert_to(res, get_tarval_mode(tv)) != tv)
+		return NULL;
+	return res;
+}
+
+static range_t get_attr_range(vrp_attr const *attr, ir_mode *mode)
+{
+	switch (attr->range_type) {
+	case VRP_UNDEFINED:
+		return empty_range;
+	case VRP_RANGE:
+	case VRP_VARYING:
+		return make_range(attr->range_bottom, attr->range_top);
+	case VRP_ANTIRANGE:
 		break;
 	}
+	return full_range(mode);
+}
 
-	case iro_Add: {
-		const vrp_attr *vrp_left  = vrp_get_or_set_info(info, get_Add_left(node));
-		const vrp_attr *vrp_right = vrp_get_or_set_info(info, get_Add_right(node));
+static range_t get_range(ir_vrp_info *info, ir_node const *node)
+{
+	ir_mode          *const mode = get_irn_mode(node);
+	vrp_node_t const *const vrp  = ir_nodemap_get(vrp_node_t, &info->infos,
+	                                               node);
+	if (vrp == NULL)
+		return full_range(mode);
+	return get_attr_range(&vrp->attr, mode);
+}
 
-		if (vrp_left->range_type == VRP_UNDEFINED
-		 || vrp_right->range_type == VRP_UNDEFINED
-		 || vrp_left->range_type == VRP_VARYING
-		 || vrp_right->range_type == VRP_VARYING) {
-			return 0;
-		}
+static void set_range(vrp_node_t *vrp, range_t range, ir_mode *mode)
+{
+	assert(range.lo != NULL);
+	vrp->attr.range_bottom = range.lo;
+	vrp->attr.range_top    = range.hi;
+	vrp->attr.range_type   = range.lo == get_mode_min(mode)
+	                      && range.hi == get_mode_max(mode)
+		? VRP_VARYING : VRP_RANGE;
+}
 
-		if (vrp_left->range_type == VRP_RANGE
-		 && vrp_right->range_type == VRP_RANGE) {
-			int old_wrap_on_overflow = tarval_get_wrap_on_overflow();
-			tarval_set_wrap_on_overflow(false);
-			ir_tarval *new_top
-				= tarval_add(vrp_left->range_top, vrp_right->range_top);
-			ir_tarval *new_bottom
-				= tarval_add(vrp_left->range_bottom, vrp_right->range_bottom);
-			tarval_set_wrap_on_overflow(old_wrap_on_overflow);
-
-			if (new_top != tarval_bad && new_bottom != tarval_bad) {
-				new_range_bottom = new_bottom;
-				new_range_top    = new_top;
-				new_range_type   = VRP_RANGE;
-			} else {
-				/* TODO Implement overflow handling*/
-				new_range_type = VRP_UNDEFINED;
-			}
+/** Returns the range of values allowed by the known bits. */
+static range_t get_bits_range(vrp_attr const *attr, ir_mode *mode)
+{
+	/* the order of the bit patterns matches the order of the values, if the
+	 * sign is known */
+	if (!mode_is_signed(mode) || !tarval_is_negative(attr->bits_not_set)
+	    || tarval_is_negative(attr->bits_set))
+		return make_range(attr->bits_set, attr->bits_not_set);
+	return full_range(mode);
+}
+
+/**
+ * Restricts the values of @p range to those having the relation @p relation
+ * to any value of @p bound.
+ */
+static range_t refine(range_t range, ir_relation relation, range_t bound,
+                      ir_mode *mode)
+{
+	if (range.lo == NULL || bound.lo == NULL)
+		return range;
+
+	ir_tarval *const one = get_mode_one(mode);
+	ir_tarval       *lo  = range.lo;
+	ir_tarval       *hi  = range.hi;
+	switch (relation & ir_relation_less_equal_greater) {
+	case ir_relation_equal:
+		return meet(range, bound);
+	case ir_relation_less: {
+		ir_tarval *const max = exact(tarval_sub, bound.hi, one);
+		if (max == tarval_bad)
+			return empty_range;
+		hi = tv_min(hi, max);
+		break;
+	}
+	case ir_relation_less_equal:
+		hi = tv_min(hi, bound.hi);
+		break;
+	case ir_relation_greater: {
+		ir_tarval *const min = exact(tarval_add, bound.lo, one);
+		if (min == tarval_bad)
+			return empty_range;
+		lo = tv_max(lo, min);
+		break;
+	}
+	case ir_relation_greater_equal:
+		lo = tv_max(lo, bound.lo);
+		break;
+	case ir_relation_less_greater:
+		if (bound.lo != bound.hi)
+			break;
+		if (lo == bound.lo) {
+			if (lo == hi)
+				return empty_range;
+			lo = tarval_add(lo, one);
+		} else if (hi == bound.lo) {
+			hi = tarval_sub(hi, one);
 		}
 		break;
+	default:
+		break;
 	}
+	return is_less(hi, lo) ? empty_range : make_range(lo, hi);
+}
 
-	case iro_Sub: {
-		ir_node *left  = get_Sub_left(node);
-		ir_node *right = get_Sub_right(node);
-
-		if (!mode_is_int(get_irn_mode(left)))
-			return 0;
+/** Checks whether the @p pos'th control flow predecessor of @p block is a
+ * back edge. */
+static bool is_back_edge(ir_node const *block, int pos)
+{
+	ir_node *const pred = get_Block_cfgpred_block(block, pos);
+	return pred != NULL && get_Block_dom_depth(pred) >= 0
+	    && block_dominates(block, pred);
+}
 
-		const vrp_attr *vrp_left  = vrp_get_or_set_info(info, left);
-		const vrp_attr *vrp_right = vrp_get_or_set_info(info, right);
+static bool is_loop_header(ir_node const *block)
+{
+	for (int i = get_Block_n_cfgpreds(block); i-- > 0;) {
+		if (is_back_edge(block, i))
+			return true;
+	}
+	return false;
+}
 
-		if (vrp_left->range_type == VRP_UNDEFINED
-		 || vrp_right->range_type == VRP_UNDEFINED
-		 || vrp_left->range_type == VRP_VARYING
-		 || vrp_right->range_type == VRP_VARYING) {
-			return 0;
-		}
+static range_t compute_binop(ir_vrp_info *info, ir_node *node)
+{
+	ir_mode *const mode  = get_irn_mode(node);
+	range_t  const left  = get_range(info, get_binop_left(node));
+	range_t  const right = get_range(info, get_binop_right(node));
+	if (left.lo == NULL || right.lo == NULL)
+		return empty_range;
 
-		if (vrp_left->range_type == VRP_RANGE
-		 && vrp_right->range_type == VRP_RANGE) {
-			int old_wrap_on_overflow = tarval_get_wrap_on_overflow();
-			tarval_set_wrap_on_overflow(false);
-			ir_tarval *new_top = tarval_sub(vrp_left->range_top, vrp_right->range_bottom);
-			ir_tarval *new_bottom = tarval_sub(vrp_left->range_bottom, vrp_right->range_top);
-			tarval_set_wrap_on_overflow(old_wrap_on_overflow);
-
-			if (new_top != tarval_bad && new_bottom != tarval_bad) {
-				new_range_bottom = new_bottom;
-				new_range_top = new_top;
-				new_range_type = VRP_RANGE;
-			} else {
-				/* TODO Implement overflow handling*/
-				new_range_type = VRP_UNDEFINED;
-			}
+	switch (get_irn_opcode(node)) {
+	case iro_Add:
+		return checked_range(exact(tarval_add, left.lo, right.lo),
+		                     exact(tarval_add, left.hi, right.hi), mode);
+	case iro_Sub:
+		return checked_range(exact(tarval_sub, left.lo, right.hi),
+		                     exact(tarval_sub, left.hi, right.lo), mode);
+	case iro_Mul: {
+		ir_tarval *const products[] = {
+			exact(tarval_mul, left.lo, right.lo),
+			exact(tarval_mul, left.lo, right.hi),
+			exact(tarval_mul, left.hi, right.lo),
+			exact(tarval_mul, left.hi, right.hi),
+		};
+		ir_tarval *lo = products[0];
+		ir_tarval *hi = products[0];
+		for (size_t i = 0; i < ARRAY_SIZE(products); ++i) {
+			if (products[i] == tarval_bad)
+				return full_range(mode);
+			lo = tv_min(lo, products[i]);
+			hi = tv_max(hi, products[i]);
 		}
-		break;
+		return make_range(lo, hi);
+	}
+	case iro_And: {
+		/* a non-negative operand bounds the result */
+		ir_tarval *const null   = get_mode_null(mode);
+		range_t          result = full_range(mode);
+		if (!tarval_is_negative(left.lo))
+			result = make_range(null, left.hi);
+		if (!tarval_is_negative(right.lo))
+			result = meet(result, make_range(null, right.hi));
+		return result;
+	}
+	default:
+		return full_range(mode);
 	}
+}
 
-	case iro_Or: {
-		const vrp_attr *vrp_left, *vrp_right;
+static range_t compute_shift(ir_vrp_info *info, ir_node *node)
+{
+	ir_mode *const mode  = get_irn_mode(node);
+	ir_node *const right = get_binop_right(node);
+	range_t  const left  = get_range(info, get_binop_left(node));
+	if (left.lo == NULL)
+		return empty_range;
+	if (!is_Const(right))
+		return full_range(mode);
+
+	ir_tarval *const count = get_Const_tarval(right);
+	if (!tarval_is_long(count) || get_tarval_long(count) < 0
+	    || get_tarval_long(count) >= (long)get_mode_size_bits(mode))
+		return full_range(mode);
+	if (is_Shrs(node))
+		return make_range(tarval_shrs(left.lo, count),
+		                  tarval_shrs(left.hi, count));
+	if (tarval_is_negative(left.lo))
+		return full_range(mode);
+	return make_range(tarval_shr(left.lo, count), tarval_shr(left.hi, count));
+}
 
-		vrp_left = vrp_get_or_set_info(info, get_Or_left(node));
-		vrp_right = vrp_get_or_set_info(info, get_Or_right(node));
+static range_t compute_proj(ir_vrp_info *info, ir_node *node)
+{
+	ir_mode *const mode = get_irn_mode(node);
+	ir_node *const pred = get_Proj_pred(node);
+	ir_node *right;
+	ir_node *left;
+	if (is_Div(pred) && get_Proj_num(node) == pn_Div_res) {
+		left  = get_Div_left(pred);
+		right = get_Div_right(pred);
+	} else if (is_Mod(pred) && get_Proj_num(node) == pn_Mod_res) {
+		left  = get_Mod_left(pred);
+		right = get_Mod_right(pred);
+	} else {
+		return full_range(mode);
+	}
 
-		new_bits_set = tarval_or(vrp_left->bits_set, vrp_right->bits_set);
-		new_bits_not_set = tarval_or(vrp_left->bits_not_set, vrp_right->bits_not_set);
+	/* only positive constant divisors are handled */
+	if (!is_Const(right) || get_irn_mode(left) != mode)
+		return full_range(mode);
+	ir_tarval *const divisor = get_Const_tarval(right);
+	if (tarval_is_negative(divisor) || tarval_is_null(divisor))
+		return full_range(mode);
+
+	range_t const dividend = get_range(info, left);
+	if (dividend.lo == NULL)
+		return empty_range;
+	if (is_Div(pred))
+		return make_range(tarval_div(dividend.lo, divisor),
+		                  tarval_div(dividend.hi, divisor));
+
+	/* the remainder has the sign of the dividend and is not farther away from
+	 * zero */
+	ir_tarval *const null = get_mode_null(mode);
+	ir_tarval *const max  = tarval_sub(divisor, get_mode_one(mode));
+	if (!tarval_is_negative(dividend.lo))
+		return make_range(null, tv_min(dividend.hi, max));
+	return make_range(tv_max(dividend.lo, tarval_neg(max)),
+	                  tv_max(null, tv_min(dividend.hi, max)));
+}
 
-		break;
+static range_t compute_phi(ir_vrp_info *info, ir_node *phi)
+{
+	vrp_node_t const *const vrp    = get_vrp_node(info, phi);
+	ir_node          *const block  = get_nodes_block(phi);
+	ir_mode          *const mode   = get_irn_mode(phi);
+	range_t                 result = empty_range;
+	foreach_irn_in(phi, i, pred) {
+		if (is_Bad(get_Block_cfgpred(block, i)))
+			continue;
+
+		range_t range = get_range(info, pred);
+		if (vrp->iv_step != NULL && is_back_edge(block, i)) {
+			/* the back edge is only taken if the loop test holds, and the
+			 * tested value is incremented afterwards */
+			range_t const bound = get_range(info, vrp->iv_bound);
+			range_t const taken = refine(get_range(info, phi),
+			                             vrp->iv_relation, bound, mode);
+			if (taken.lo == NULL)
+				continue;
+			ir_tarval *const step = vrp->iv_step;
+			range_t    const next = checked_range(
+				exact(tarval_add, taken.lo, step),
+				exact(tarval_add, taken.hi, step), mode);
+			range = meet(range, next);
+		}
+		result = join(result, range);
 	}
+	return result;
+}
 
-	case iro_Shl: {
-		const vrp_attr *vrp_left;
-		const ir_node *right = get_Shl_right(node);
-		vrp_left = vrp_get_or_set_info(info, get_Shl_left(node));
+static range_t compute_range(ir_vrp_info *info, ir_node *node)
+{
+	ir_mode *const mode = get_irn_mode(node);
+	switch (get_irn_opcode(node)) {
+	case iro_Const: {
+		ir_tarval *const tv = get_Const_tarval(node);
+		return make_range(tv, tv);
+	}
+	case iro_Id:
+		return get_range(info, get_Id_pred(node));
+	case iro_Sub:
+		if (!mode_is_int(get_irn_mode(get_Sub_left(node))))
+			return full_range(mode);
+		/* FALLTHROUGH */
+	case iro_Add:
+	case iro_Mul:
+	case iro_And:
+		return compute_binop(info, node);
+	case iro_Shr:
+	case iro_Shrs:
+		return compute_shift(info, node);
+	case iro_Minus: {
+		range_t const op = get_range(info, get_Minus_op(node));
+		if (op.lo == NULL)
+			return empty_range;
+		if (!mode_is_signed(mode) || op.lo == get_mode_min(mode))
+			return full_range(mode);
+		return make_range(tarval_neg(op.hi), tarval_neg(op.lo));
+	}
+	case iro_Conv: {
+		ir_node *const op = get_Conv_op(node);
+		if (!mode_is_int(get_irn_mode(op)))
+			return full_range(mode);
+		range_t const range = get_range(info, op);
+		if (range.lo == NULL)
+			return empty_range;
+		ir_tarval *const lo = convert_exact(range.lo, mode);
+		ir_tarval *const hi = convert_exact(range.hi, mode);
+		if (lo == NULL || hi == NULL)
+			return full_range(mode);
+		return make_range(lo, hi);
+	}
+	case iro_Confirm: {
+		range_t const value = get_range(info, get_Confirm_value(node));
+		range_t const bound = get_range(info, get_Confirm_bound(node));
+		return refine(value, get_Confirm_relation(node), bound, mode);
+	}
+	case iro_Mux:
+		return join(get_range(info, get_Mux_false(node)),
+		            get_range(info, get_Mux_true(node)));
+	case iro_Phi:
+		return compute_phi(info, node);
+	case iro_Proj:
+		return compute_proj(info, node);
+	default:
+		return full_range(mode);
+	}
+}
 
-		/* We can only compute this if the right value is a constant*/
-		if (is_Const(right)) {
-			new_bits_set = tarval_shl(vrp_left->bits_set, get_Const_tarval(right));
-			new_bits_not_set = tarval_shl(vrp_left->bits_not_set, get_Const_tarval(right));
+static bool update_range(vrp_env_t *env, ir_node *node)
+{
+	vrp_node_t *const vrp    = get_vrp_node(env->info, node);
+	ir_mode    *const mode   = get_irn_mode(node);
+	range_t     const old    = get_attr_range(&vrp->attr, mode);
+	range_t           result = compute_range(env->info, node);
+
+	/* the known bits hold in every step */
+	range_t const bits = meet(result, get_bits_range(&vrp->attr, mode));
+	if (bits.lo != NULL)
+		result = bits;
+
+	if (env->narrowing) {
+		if (vrp->n_updates >= NARROW_STEPS)
+			return false;
+		result = meet(old, result);
+		if (result.lo == NULL)
+			return false;
+	} else {
+		result = join(old, result);
+		if (result.lo == NULL)
+			return false;
+		if (vrp->n_updates >= MAX_UPDATES) {
+			result = full_range(mode);
+		} else if (vrp->is_header && vrp->n_updates >= WIDEN_DELAY) {
+			/* widen the bounds, which are still moving */
+			if (is_less(result.lo, old.lo))
+				result.lo = get_mode_min(mode);
+			if (is_less(old.hi, result.hi))
+				result.hi = get_mode_max(mode);
 		}
-		break;
 	}
+	if (result.lo == old.lo && result.hi == old.hi)
+		return false;
 
-	case iro_Shr: {
-		const vrp_attr *vrp_left;
-		const ir_node *right = get_Shr_right(node);
+	DB((dbg, LEVEL_3, "%+F: [%T, %T]\n", node, result.lo, result.hi));
+	++vrp->n_updates;
+	set_range(vrp, result, mode);
+	return true;
+}
 
-		vrp_left = vrp_get_or_set_info(info, get_Shr_left(node));
+static bool update_bits(ir_vrp_info *info, ir_node *node)
+{
+	ir_tarval  *new_bits_set     = tarval_bad;
+	ir_tarval  *new_bits_not_set = tarval_bad;
+	vrp_node_t *vrp              = get_vrp_node(info, node);
 
-		/* We can only compute this if the right value is a constant*/
-		if (is_Const(right)) {
-			new_bits_set = tarval_shr(vrp_left->bits_set, get_Const_tarval(right));
-			new_bits_not_set = tarval_shr(vrp_left->bits_not_set, get_Const_tarval(right));
-		}
+	switch (get_irn_opcode(node)) {
+	case iro_Const: {
+		ir_tarval *tv = get_Const_tarval(node);
+		new_bits_set = tv;
+		new_bits_not_set = tv;
+		break;
+	}
+	case iro_And: {
+		const vrp_node_t *vrp_left  = get_vrp_node(info, get_And_left(node));
+		const vrp_node_t *vrp_right = get_vrp_node(info, get_And_right(node));
+		new_bits_set = tarval_and(vrp_left->attr.bits_set, vrp_right->attr.bits_set);
+		new_bits_not_set = tarval_and(vrp_left->attr.bits_not_set, vrp_right->attr.bits_not_set);
 		break;
 	}
 
-	case iro_Shrs: {
-		const vrp_attr *vrp_left;
-		const ir_node *right = get_Shrs_right(node);
+	case iro_Or: {
+		const vrp_node_t *vrp_left  = get_vrp_node(info, get_Or_left(node));
+		const vrp_node_t *vrp_right = get_vrp_node(info, get_Or_right(node));
+		new_bits_set = tarval_or(vrp_left->attr.bits_set, vrp_right->attr.bits_set);
+		new_bits_not_set = tarval_or(vrp_left->attr.bits_not_set, vrp_right->attr.bits_not_set);
+		break;
+	}
 
-		vrp_left = vrp_get_or_set_info(info, get_Shrs_left(node));
+	case iro_Shl:
+	case iro_Shr:
+	case iro_Shrs: {
+		const ir_node    *right    = get_binop_right(node);
+		const vrp_node_t *vrp_left = get_vrp_node(info, get_binop_left(node));
 
 		/* We can only compute this if the right value is a constant*/
 		if (is_Const(right)) {
-			new_bits_set = tarval_shrs(vrp_left->bits_set, get_Const_tarval(right));
-			new_bits_not_set = tarval_shrs(vrp_left->bits_not_set, get_Const_tarval(right));
+			ir_tarval   *count = get_Const_tarval(right);
+			tarval_binop shift = is_Shl(node) ? tarval_shl
+			                   : is_Shr(node) ? tarval_shr : tarval_shrs;
+			new_bits_set = shift(vrp_left->attr.bits_set, count);
+			new_bits_not_set = shift(vrp_left->attr.bits_not_set, count);
 		}
 		break;
 	}
 
 	case iro_Eor: {
-		const vrp_attr *vrp_left, *vrp_right;
-
-		vrp_left = vrp_get_or_set_info(info, get_Eor_left(node));
-		vrp_right = vrp_get_or_set_info(info, get_Eor_right(node));
+		const vrp_attr *vrp_left  = &get_vrp_node(info, get_Eor_left(node))->attr;
+		const vrp_attr *vrp_right = &get_vrp_node(info, get_Eor_right(node))->attr;
 
 		new_bits_set = tarval_or(tarval_and(vrp_left->bits_set, tarval_not(vrp_right->bits_not_set)),
 		                         tarval_and(tarval_not(vrp_left->bits_not_set), vrp_right->bits_set));
@@ -234,246 +596,311 @@ static int vrp_update_node(ir_vrp_info *info, ir_node *node)
 		new_bits_not_set = tarval_not(tarval_or(tarval_and(vrp_left->bits_set,vrp_right->bits_set),
 		                                        tarval_and(tarval_not(vrp_left->bits_not_set),
 		                                                   tarval_not(vrp_right->bits_not_set))));
-
 		break;
 	}
 
 	case iro_Id: {
-		const vrp_attr *vrp_pred = vrp_get_or_set_info(info, get_Id_pred(node));
-		new_bits_set = vrp_pred->bits_set;
-		new_bits_not_set = vrp_pred->bits_not_set;
-		new_range_top = vrp_pred->range_top;
-		new_range_bottom = vrp_pred->range_bottom;
-		new_range_type = vrp_pred->range_type;
+		const vrp_node_t *vrp_pred = get_vrp_node(info, get_Id_pred(node));
+		new_bits_set = vrp_pred->attr.bits_set;
+		new_bits_not_set = vrp_pred->attr.bits_not_set;
 		break;
 	}
 
 	case iro_Not: {
-		const vrp_attr *vrp_pred = vrp_get_or_set_info(info, get_Not_op(node));
-		new_bits_set = tarval_not(vrp_pred->bits_not_set);
-		new_bits_not_set = tarval_not(vrp_pred->bits_set);
+		const vrp_node_t *vrp_pred = get_vrp_node(info, get_Not_op(node));
+		new_bits_set = tarval_not(vrp_pred->attr.bits_not_set);
+		new_bits_not_set = tarval_not(vrp_pred->attr.bits_set);
 		break;
 	}
 
 	case iro_Conv: {
-		const ir_node *pred = get_Conv_op(node);
-		ir_mode *old_mode = get_irn_mode(pred);
-		const vrp_attr *vrp_pred;
-
-		ir_mode *new_mode;
-
+		const ir_node *pred     = get_Conv_op(node);
+		ir_mode       *old_mode = get_irn_mode(pred);
 		if (!mode_is_int(old_mode))
-			return 0;
+			return false;
 
-		vrp_pred = vrp_get_or_set_info(info, pred);
-		new_mode = get_irn_mode(node);
+		const vrp_node_t *vrp_pred = get_vrp_node(info, pred);
+		ir_mode          *new_mode = get_irn_mode(node);
 
 		/* The second and is needed if target type is smaller*/
 		new_bits_not_set = tarval_convert_to(get_mode_all_one(old_mode), new_mode);
-		new_bits_not_set = tarval_and(new_bits_not_set, tarval_convert_to(vrp_pred->bits_not_set, new_mode));
+		new_bits_not_set = tarval_and(new_bits_not_set, tarval_convert_to(vrp_pred->attr.bits_not_set, new_mode));
 		new_bits_set = tarval_and(new_bits_not_set,
-		                          tarval_convert_to(vrp_pred->bits_set, new_mode));
-
-		/* Matze: TODO, BUGGY, tarval_cmp never returns ir_relation_less_equal */
-		if (tarval_cmp(vrp_pred->range_top, get_mode_max(new_mode)) == ir_relation_less_equal) {
-			vrp->range_top = vrp_pred->range_top;
-		}
-
-		/* Matze: TODO, BUGGY, tarval_cmp never returns ir_relation_greater_equal */
-		if (tarval_cmp(vrp_pred->range_bottom, get_mode_min(new_mode)) == ir_relation_greater_equal) {
-			vrp->range_bottom = vrp_pred->range_bottom;
-		}
-		break;
-	}
-
-	case iro_Confirm: {
-		const ir_relation relation = get_Confirm_relation(node);
-		const ir_node    *bound    = get_Confirm_bound(node);
-
-
-		if (relation == ir_relation_less_greater) {
-			/** @todo: Handle non-Const bounds */
-			if (is_Const(bound)) {
-				new_range_type = VRP_ANTIRANGE;
-				new_range_top = get_Const_tarval(bound);
-				new_range_bottom = get_Const_tarval(bound);
-			}
-		} else if (relation == ir_relation_less_equal) {
-			if (is_Const(bound)) {
-				new_range_type = VRP_RANGE;
-				new_range_top = get_Const_tarval(bound);
-				new_range_bottom = get_mode_min(get_irn_mode(node));
-			}
-		}
+		                          tarval_convert_to(vrp_pred->attr.bits_set, new_mode));
 		break;
 	}
 
 	case iro_Phi: {
-		/* combine all ranges*/
-		const ir_node *pred = get_Phi_pred(node,0);
-		const vrp_attr *vrp_pred = vrp_get_or_set_info(info, pred);
-		new_range_top    = vrp_pred->range_top;
-		new_range_bottom = vrp_pred->range_bottom;
-		new_range_type   = vrp_pred->range_type;
-		new_bits_set     = vrp_pred->bits_set;
-		new_bits_not_set = vrp_pred->bits_not_set;
-
-		for (int i = 1, num = get_Phi_n_preds(node); i < num; i++) {
-			pred = get_Phi_pred(node, i);
-			vrp_pred = vrp_get_or_set_info(info, pred);
-			if (new_range_type == VRP_RANGE && vrp_pred->range_type == VRP_RANGE) {
-				ir_relation relation = tarval_cmp(new_range_top, vrp_pred->range_top);
-				if (relation == ir_relation_less) {
-					new_range_top = vrp_pred->range_top;
-				}
-				relation = tarval_cmp(new_range_bottom, vrp_pred->range_bottom);
-				if (relation == ir_relation_greater) {
-					new_range_bottom = vrp_pred->range_bottom;
-				}
-			} else {
-				new_range_type = VRP_VARYING;
-			}
-			new_bits_set = tarval_and(new_bits_set, vrp_pred->bits_set);
+		/* combine the bits of all predecessors */
+		new_bits_set     = get_mode_all_one(get_irn_mode(node));
+		new_bits_not_set = get_mode_null(get_irn_mode(node));
+		foreach_irn_in(node, i, pred) {
+			const vrp_node_t *vrp_pred = get_vrp_node(info, pred);
+			new_bits_set = tarval_and(new_bits_set, vrp_pred->attr.bits_set);
 			new_bits_not_set = tarval_or(new_bits_not_set,
-			                             vrp_pred->bits_not_set);
+			                             vrp_pred->attr.bits_not_set);
 		}
-
 		break;
 	}
 	default:
 		/* unhandled, therefore never updated */
-		break;
-	}
-
-
-
-	/* TODO: Check, if there can be information derived from any of these:
-	is_Abs(node) is_Address(node) is_Alloc(node) is_Anchor(node) is_Borrow(node)
-	is_Bound(node) is_Break(node) is_Builtin(node) is_Call(node)
-	is_Carry(node) is_Cmp(node) is_Cond(node)
-	is_CopyB(node) is_Div(node) is_Dummy(node)
-	is_End(node) is_Free(node)
-	is_IJmp(node) is_Jmp(node) is_Load(node) is_Minus(node) is_Member(node)
-	is_Mod(node) is_Mul(node) is_Mulh(node) is_Mux(node) is_NoMem(node)
-	is_Offset(node) is_Pin(node) is_Proj(node)
-	is_Raise(node) is_Return(node) is_Sel(node) is_Start(node) is_Store(node)
-	is_Sync(node) is_Tuple(node) is_TypeConst(node)
-	*/
-
-	/* @todo: At this place, we check if the mode of the variable changed. A
-	 * better place for this might be in the convopt.c file
-	 */
-
-	if (new_bits_set != tarval_bad && get_tarval_mode(new_bits_set) != get_tarval_mode(vrp->bits_set)) {
-		vrp->bits_set = tarval_convert_to(vrp->bits_set, get_irn_mode(node));
-	}
-	if (new_bits_not_set != tarval_bad && get_tarval_mode(new_bits_not_set) != get_tarval_mode(vrp->bits_not_set)) {
-		vrp->bits_not_set = tarval_convert_to(vrp->bits_not_set, get_irn_mode(node));
-	}
-
-	if (vrp->range_type != VRP_UNDEFINED && new_range_type != VRP_UNDEFINED && get_tarval_mode(new_range_top) != get_tarval_mode(vrp->range_top)) {
-		/* @todo: We might be able to preserve this range information if it
-		 * fits in */
-		vrp->range_type = VRP_VARYING;
+		return false;
 	}
 
 	/* Merge the newly calculated values with those that might already exist*/
+	bool something_changed = false;
 	if (new_bits_set != tarval_bad) {
-		new_bits_set = tarval_or(new_bits_set, vrp->bits_set);
-		if (new_bits_set != vrp->bits_set) {
-			something_changed = true;
-			vrp->bits_set     = new_bits_set;
+		new_bits_set = tarval_or(new_bits_set, vrp->attr.bits_set);
+		if (new_bits_set != vrp->attr.bits_set) {
+			something_changed  = true;
+			vrp->attr.bits_set = new_bits_set;
 		}
 	}
 	if (new_bits_not_set != tarval_bad) {
-		new_bits_not_set = tarval_and(new_bits_not_set, vrp->bits_not_set);
-
-		if (new_bits_not_set != vrp->bits_not_set) {
-			something_changed = true;
-			vrp->bits_not_set = new_bits_not_set;
+		new_bits_not_set = tarval_and(new_bits_not_set, vrp->attr.bits_not_set);
+		if (new_bits_not_set != vrp->attr.bits_not_set) {
+			something_changed      = true;
+			vrp->attr.bits_not_set = new_bits_not_set;
 		}
 	}
 
-	if (vrp->range_type == VRP_UNDEFINED &&
-	    new_range_type != VRP_UNDEFINED) {
-		something_changed = true;
-		vrp->range_type = new_range_type;
-		vrp->range_bottom = new_range_bottom;
-		vrp->range_top = new_range_top;
+	assert(tarval_is_null(tarval_and(vrp->attr.bits_set, tarval_not(vrp->attr.bits_not_set))));
+	return something_changed;
+}
 
-	} else if (vrp->range_type == VRP_RANGE) {
-		if (new_range_type == VRP_RANGE) {
-			if (tarval_cmp(vrp->range_bottom, new_range_bottom) == ir_relation_less) {
-				something_changed = true;
-				vrp->range_bottom = new_range_bottom;
-			}
-			if (tarval_cmp(vrp->range_top, new_range_top) == ir_relation_greater) {
-				something_changed = true;
-				vrp->range_top    = new_range_top;
-			}
+/**
+ * Returns the loop test on the path from @p block up to the loop header
+ * @p header, which decides whether the loop is continued, or NULL.
+ */
+static ir_node *find_loop_test(ir_node *block, ir_node *header,
+                               ir_relation *relation)
+{
+	for (; block != NULL && block != header; block = get_Block_idom(block)) {
+		if (get_Block_n_cfgpreds(block) != 1)
+			continue;
+		ir_node *const proj = get_Block_cfgpred(block, 0);
+		if (!is_Proj(proj))
+			continue;
+		ir_node *const cond = get_Proj_pred(proj);
+		if (!is_Cond(cond) || !block_dominates(header, get_nodes_block(cond)))
+			continue;
+		ir_node *const cmp = get_Cond_selector(cond);
+		if (!is_Cmp(cmp))
+			continue;
+
+		*relation = get_Cmp_relation(cmp);
+		if (get_Proj_num(proj) == pn_Cond_false)
+			*relation = get_negated_relation(*relation);
+		return cmp;
+	}
+	return NULL;
+}
+
+/** Returns the constant step of @p pred incrementing @p phi, or NULL. */
+static ir_tarval *get_iv_step(ir_node const *phi, ir_node *pred)
+{
+	if (!is_Add(pred) && !is_Sub(pred))
+		return NULL;
+	ir_node *const left  = get_binop_left(pred);
+	ir_node *const right = get_binop_right(pred);
+	if (is_Add(pred) && is_Const(left) && skip_Confirm(right) == phi)
+		return get_Const_tarval(left);
+	if (!is_Const(right) || skip_Confirm(left) != phi)
+		return NULL;
+	ir_tarval *const step = get_Const_tarval(right);
+	return is_Add(pred) ? step : tarval_neg(step);
+}
+
+/**
+ * Checks whether the loop header Phi @p phi is incremented by a constant on
+ * each back edge, and the loop is controlled by a comparison of @p phi with a
+ * loop-invariant value.
+ */
+static void find_induction_variable(vrp_env_t *env, ir_node *phi)
+{
+	ir_node *const block    = get_nodes_block(phi);
+	ir_tarval     *step     = NULL;
+	ir_node       *bound    = NULL;
+	ir_relation    relation = ir_relation_false;
+	foreach_irn_in(phi, i, pred) {
+		if (!is_back_edge(block, i))
+			continue;
+
+		ir_tarval *const pred_step = get_iv_step(phi, pred);
+		if (pred_step == NULL || tarval_is_null(pred_step)
+		    || (step != NULL && pred_step != step))
+			return;
+		step = pred_step;
+
+		ir_relation    pred_relation;
+		ir_node *const pred_block = get_Block_cfgpred_block(block, i);
+		ir_node *const cmp        = find_loop_test(pred_block, block,
+		                                           &pred_relation);
+		if (cmp == NULL)
+			return;
+		ir_node *pred_bound;
+		if (get_Cmp_left(cmp) == phi) {
+			pred_bound = get_Cmp_right(cmp);
+		} else if (get_Cmp_right(cmp) == phi) {
+			pred_bound    = get_Cmp_left(cmp);
+			pred_relation = get_inversed_relation(pred_relation);
+		} else {
+			return;
 		}
+		pred_relation &= ir_relation_less_equal_greater;
+		if (bound != NULL && (pred_bound != bound || pred_relation != relation))
+			return;
+		bound    = pred_bound;
+		relation = pred_relation;
+	}
+	if (step == NULL)
+		return;
 
-		if (new_range_type == VRP_ANTIRANGE) {
-			/* if they are overlapping, cut the range.*/
-			/* TODO: Maybe we can preserve more information here*/
-			if (tarval_cmp(vrp->range_bottom, new_range_top) == ir_relation_greater &&
-			    tarval_cmp(vrp->range_bottom, new_range_bottom) == ir_relation_greater) {
-				something_changed = true;
-				vrp->range_bottom = new_range_top;
-
-			} else if (tarval_cmp(vrp->range_top, new_range_bottom) == ir_relation_greater &&
-			           tarval_cmp(vrp->range_top, new_range_top) == ir_relation_less) {
-				something_changed = true;
-				vrp->range_top    = new_range_bottom;
-			}
+	/* the bound must not change inside the loop */
+	ir_node *const bound_block = get_nodes_block(bound);
+	if (bound_block == block || !block_dominates(bound_block, block))
+		return;
 
-			/* We can not handle the case where the anti range is in the*/
-			/* range*/
+	DB((dbg, LEVEL_2, "%+F: induction variable, step %T, %+F %s %+F\n", phi,
+	    step, phi, get_relation_string(relation), bound));
+	vrp_node_t *const vrp = get_vrp_node(env->info, phi);
+	vrp->iv_step     = step;
+	vrp->iv_bound    = bound;
+	vrp->iv_relation = relation;
+	get_vrp_node(env->info, bound)->is_iv_bound = true;
+	ARR_APP1(ir_node*, env->ivs, phi);
+}
 
-		}
-	} else if (vrp->range_type == VRP_ANTIRANGE) {
-		if (new_range_type == VRP_ANTIRANGE) {
-			if (tarval_cmp(vrp->range_bottom, new_range_bottom) == ir_relation_greater) {
-				something_changed = true;
-				vrp->range_bottom = new_range_bottom;
-			}
-			if (tarval_cmp(vrp->range_top, new_range_top) == ir_relation_less) {
-				something_changed = true;
-				vrp->range_top    = new_range_top;
-			}
-		}
+static void push_node(vrp_env_t *env, ir_node *node)
+{
+	if (!mode_is_int(get_irn_mode(node)))
+		return;
+	vrp_node_t *const vrp = get_vrp_node(env->info, node);
+	if (vrp->in_queue)
+		return;
+	vrp->in_queue = true;
+	deq_push_pointer_right(&env->workqueue, node);
+}
 
-		if (new_range_type == VRP_RANGE) {
-			if (tarval_cmp(vrp->range_bottom, new_range_top) == ir_relation_greater) {
-				something_changed = true;
-				vrp->range_bottom = new_range_top;
-			}
-			if (tarval_cmp(vrp->range_top, new_range_bottom) == ir_relation_less) {
-				something_changed = true;
-				vrp->range_top    = new_range_bottom;
+static void vrp_init_node(ir_node *node, void *e)
+{
+	vrp_env_t *env = (vrp_env_t*)e;
+	if (!mode_is_int(get_irn_mode(node)))
+		return;
+
+	vrp_node_t *const vrp = get_vrp_node(env->info, node);
+	if (is_Phi(node) && is_loop_header(get_nodes_block(node))) {
+		vrp->is_header = true;
+		find_induction_variable(env, node);
+	}
+	push_node(env, node);
+}
+
+static void vrp_push_node(ir_node *node, void *e)
+{
+	vrp_env_t *env = (vrp_env_t*)e;
+	if (!mode_is_int(get_irn_mode(node)))
+		return;
+	get_vrp_node(env->info, node)->n_updates = 0;
+	push_node(env, node);
+}
+
+/** Propagates ranges until the workqueue is empty. */
+static void vrp_solve(vrp_env_t *env)
+{
+	while (!deq_empty(&env->workqueue)) {
+		ir_node    *const node = deq_pop_pointer_left(ir_node, &env->workqueue);
+		vrp_node_t *const vrp  = get_vrp_node(env->info, node);
+		vrp->in_queue = false;
+
+		bool changed = update_bits(env->info, node);
+		changed |= update_range(env, node);
+		if (!changed)
+			continue;
+
+		foreach_irn_out_r(node, i, succ) {
+			if (get_irn_mode(succ) == mode_T) {
+				/* the results of Div and Mod */
+				foreach_irn_out_r(succ, j, proj) {
+					push_node(env, proj);
+				}
+			} else {
+				push_node(env, succ);
 			}
 		}
+		/* induction variables depend on their own range and their bound */
+		if (vrp->iv_step != NULL)
+			push_node(env, node);
+		if (vrp->is_iv_bound) {
+			for (size_t i = 0, n = ARR_LEN(env->ivs); i < n; ++i)
+				push_node(env, env->ivs[i]);
+		}
 	}
-
-	assert(tarval_is_null(tarval_and(vrp->bits_set, tarval_not(vrp->bits_not_set))));
-	return something_changed;
 }
 
-static void vrp_first_pass(ir_node *n, void *e)
+/**
+ * Computes the relation of the induction variable @p phi to its bound, which
+ * holds in the whole loop.
+ */
+static void compute_iv_relation(ir_vrp_info *info, ir_node *phi)
 {
-	if (is_Block(n))
+	vrp_node_t *const vrp   = get_vrp_node(info, phi);
+	range_t     const bound = get_range(info, vrp->iv_bound);
+	if (bound.lo == NULL)
 		return;
 
-	vrp_env_t *env = (vrp_env_t*) e;
-	bitset_set(env->visited, get_irn_idx(n));
+	/* The loop is continued while phi < bound (or phi != bound), so stepping
+	 * by one never steps over the bound: it stays valid if the initial
+	 * values are below the bound. Equivalently for counting downwards. */
+	ir_relation possible;
+	if (tarval_is_one(vrp->iv_step)
+	    && (vrp->iv_relation == ir_relation_less
+	        || vrp->iv_relation == ir_relation_less_greater)) {
+		possible = ir_relation_less_equal;
+	} else if (tarval_is_all_one(vrp->iv_step) && mode_is_signed(get_irn_mode(phi))
+	           && (vrp->iv_relation == ir_relation_greater
+	               || vrp->iv_relation == ir_relation_less_greater)) {
+		possible = ir_relation_greater_equal;
+	} else {
+		return;
+	}
 
-	vrp_update_node(env->info, n);
+	ir_node *const block = get_nodes_block(phi);
+	foreach_irn_in(phi, i, pred) {
+		if (is_Bad(get_Block_cfgpred(block, i)) || is_back_edge(block, i))
+			continue;
+		range_t const init = get_range(info, pred);
+		if (init.lo == NULL)
+			continue;
+		if (possible == ir_relation_less_equal
+		    ? is_less(bound.lo, init.hi) : is_less(init.lo, bound.hi))
+			return;
+	}
+	vrp->iv_possible = possible;
+}
 
-	foreach_irn_out_r(n, i, succ) {
-		if (bitset_is_set(env->visited, get_irn_idx(succ))) {
-			/* we found a loop*/
-			deq_push_pointer_right(&env->workqueue, succ);
-		}
+static void vrp_finish_node(ir_node *node, void *e)
+{
+	vrp_env_t *env = (vrp_env_t*)e;
+	if (!mode_is_int(get_irn_mode(node)))
+		return;
+
+	vrp_node_t *const vrp = get_vrp_node(env->info, node);
+	if (vrp->attr.range_type != VRP_RANGE)
+		return;
+
+	/* derive known bits from the range */
+	ir_tarval *const lo = vrp->attr.range_bottom;
+	ir_tarval *const hi = vrp->attr.range_top;
+	if (lo == hi) {
+		vrp->attr.bits_set     = lo;
+		vrp->attr.bits_not_set = lo;
+	} else if (!tarval_is_negative(lo)) {
+		ir_mode   *const mode = get_irn_mode(node);
+		unsigned   const bits = get_mode_size_bits(mode);
+		ir_tarval *const mask = tarval_shr_unsigned(get_mode_all_one(mode),
+			bits - 1 - get_tarval_highest_bit(hi));
+		vrp->attr.bits_not_set = tarval_and(vrp->attr.bits_not_set, mask);
 	}
 }
 
@@ -505,36 +932,39 @@ void set_vrp_data(ir_graph *irg)
 
 	FIRM_DBG_REGISTER(dbg, "ir.ana.vrp");
 
-	assure_irg_outs(irg); /* ensure that out edges are consistent*/
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS
+	                         | IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
 	ir_nodemap_init(&irg->vrp.infos, irg);
 	obstack_init(&irg->vrp.obst);
-	ir_vrp_info *info = &irg->vrp;
 
+	ir_lock();
 	if (dump_hook.hook._hook_node_info == NULL) {
 		dump_hook.hook._hook_node_info = dump_vrp_info;
 		register_hook(hook_node_info, &dump_hook);
 	}
+	ir_unlock();
 
-	vrp_env_t *env = OALLOCZ(&irg->vrp.obst, vrp_env_t);
-	env->info      = info;
-	deq_init(&env->workqueue);
+	vrp_env_t env;
+	env.info      = &irg->vrp;
+	env.ivs       = NEW_ARR_F(ir_node*, 0);
+	env.narrowing = false;
+	deq_init(&env.workqueue);
 
-	env->visited = bitset_malloc(get_irg_last_idx(irg));
-	irg_walk_graph(irg, NULL, vrp_first_pass, env);
-	free(env->visited);
+	/* ascending phase, visiting operands before their users */
+	irg_walk_graph(irg, NULL, vrp_init_node, &env);
+	vrp_solve(&env);
 
-	/* while there are entries in the worklist, continue*/
-	while (!deq_empty(&env->workqueue)) {
-		ir_node *node = deq_pop_pointer_left(ir_node, &env->workqueue);
+	/* descending phase */
+	env.narrowing = true;
+	irg_walk_graph(irg, NULL, vrp_push_node, &env);
+	vrp_solve(&env);
 
-		if (vrp_update_node(info, node)) {
-			/* if something changed, add successors to worklist*/
-			foreach_irn_out_r(node, i, succ) {
-				deq_push_pointer_right(&env->workqueue, succ);
-			}
-		}
-	}
-	deq_free(&env->workqueue);
+	for (size_t i = 0, n = ARR_LEN(env.ivs); i < n; ++i)
+		compute_iv_relation(env.info, env.ivs[i]);
+	irg_walk_graph(irg, NULL, vrp_finish_node, &env);
+
+	deq_free(&env.workqueue);
+	DEL_ARR_F(env.ivs);
 }
 
 void free_vrp_data(ir_graph *irg)
@@ -545,30 +975,92 @@ void free_vrp_data(ir_graph *irg)
 	ir_nodemap_destroy(&irg->vrp.infos);
 }
 
+/**
+ * Returns the possible relations of @p node to @p base, if @p node adds a
+ * constant to @p base, which cannot overflow for the range of @p base.
+ */
+static ir_relation get_offset_relation(const ir_node *node,
+                                       const ir_node *base)
+{
+	if (!is_Add(node) && !is_Sub(node))
+		return ir_relation_true;
+
+	ir_node *const left  = get_binop_left(node);
+	ir_node *const right = get_binop_right(node);
+	ir_node       *offset;
+	if (left == base)
+		offset = right;
+	else if (is_Add(node) && right == base)
+		offset = left;
+	else
+		return ir_relation_true;
+	if (!is_Const(offset))
+		return ir_relation_true;
+
+	vrp_attr const *const vrp = vrp_get_info(base);
+	if (vrp == NULL || vrp->range_type != VRP_RANGE)
+		return ir_relation_true;
+
+	ir_tarval    *const tv = get_Const_tarval(offset);
+	tarval_binop  const op = is_Add(node) ? tarval_add : tarval_sub;
+	if (tarval_is_null(tv))
+		return ir_relation_equal;
+	if (exact(op, vrp->range_bottom, tv) == tarval_bad
+	    || exact(op, vrp->range_top, tv) == tarval_bad)
+		return ir_relation_true;
+	return is_Add(node) != tarval_is_negative(tv)
+		? ir_relation_greater : ir_relation_less;
+}
+
+/** Returns the possible relations of @p node to @p bound, if @p node is an
+ * induction variable bounded by @p bound. */
+static ir_relation get_iv_relation(const ir_node *node, const ir_node *bound)
+{
+	vrp_attr const *const attr = vrp_get_info(node);
+	if (attr == NULL)
+		return ir_relation_true;
+	vrp_node_t const *const vrp = (vrp_node_t const*)attr;
+	if (vrp->iv_bound != bound)
+		return ir_relation_true;
+	return vrp->iv_possible;
+}
+
 ir_relation vrp_cmp(const ir_node *left, const ir_node *right)
 {
 	if (!mode_is_int(get_irn_mode(left)))
 		return ir_relation_true;
 
+	ir_relation possible = ir_relation_true;
+	possible &= get_iv_relation(left, right);
+	possible &= get_inversed_relation(get_iv_relation(right, left));
+	possible &= get_offset_relation(left, right);
+	possible &= get_inversed_relation(get_offset_relation(right, left));
+
 	vrp_attr *vrp_left  = vrp_get_info(left);
 	vrp_attr *vrp_right = vrp_get_info(right);
 	if (vrp_left == NULL || vrp_right == NULL)
-		return ir_relation_true;
-
-	if (vrp_left->range_type == VRP_RANGE && vrp_right->range_type == VRP_RANGE) {
-		if (tarval_cmp(vrp_left->range_top, vrp_right->range_bottom) == ir_relation_less) {
-			return ir_relation_less;
-		}
-		if (tarval_cmp(vrp_left->range_bottom, vrp_right->range_top) == ir_relation_greater) {
-			return ir_relation_greater;
+		return possible;
+
+	if (vrp_left->range_type == VRP_RANGE || vrp_right->range_type == VRP_RANGE) {
+		ir_mode *const mode = get_irn_mode(left);
+		range_t  const l    = get_attr_range(vrp_left, mode);
+		range_t  const r    = get_attr_range(vrp_right, mode);
+		if (l.lo != NULL && r.lo != NULL) {
+			if (is_less(l.hi, r.lo))
+				possible &= ir_relation_less;
+			else if (l.hi == r.lo)
+				possible &= ir_relation_less_equal;
+			if (is_less(r.hi, l.lo))
+				possible &= ir_relation_greater;
+			else if (r.hi == l.lo)
+				possible &= ir_relation_greater_equal;
 		}
 	}
 
 	if (!tarval_is_null(tarval_and(vrp_left->bits_set, tarval_not(vrp_right->bits_not_set))) ||
 	    !tarval_is_null(tarval_and(tarval_not(vrp_left->bits_not_set), vrp_right->bits_set))) {
-		return ir_relation_less_greater;
+		possible &= ir_relation_less_greater;
 	}
 
-	/* TODO: We can get way more information here*/
-	return ir_relation_true;
+	return possible;
 }
@@ -23,11 +23,17 @@ $mode_fp = "mode_F";  # mode used by floatingpoint registers
 #   init      => "emit attribute initialization template",         # optional
 #   hash_func => "name of the hash function for this operation",   # optional, get the default hash function else
 #   attr_type => "name of the attribute struct",                   # optional
+#   latency   => cycles until the results are available,           # optional, machine model
+#   throughput => cycles until the unit accepts the next node,     # optional, default 1
+#   units     => [ "execution unit", ... ],                        # optional, any unit by default
 # },
 #
 # ... # (all nodes you need to describe)
 #
 # );
+#
+# The execution units used by the machine model are listed in
+# @execution_units = ( "unit0", "unit1", ... );
 
 %reg_classes = (
 	gp => {
@@ -19,6 +19,7 @@
 #include "beflags.h"
 #include "beirg.h"
 #include "bemodule.h"
+#include "bepostsched.h"
 #include "bera.h"
 #include "besched.h"
 #include "bespillslots.h"
@@ -634,6 +635,9 @@ static void amd64_finish_and_emit(ir_graph *irg)
 
 	amd64_peephole_optimization(irg);
 
+	be_postsched_graph(irg, &amd64_reg_classes[CLASS_amd64_flags],
+	                   &amd64_reg_classes[CLASS_amd64_x87]);
+
 	/* emit code */
 	be_timer_push(T_EMIT);
 	amd64_emit_function(irg);
@@ -817,6 +821,7 @@ arch_isa_if_t const amd64_isa_if = {
 	.big_endian            = false,
 	.po2_biggest_alignment = 4,
 	.pic_supported         = true,
+	.cacheable_code        = true,
 	.n_registers           = N_AMD64_REGISTERS,
 	.registers             = amd64_registers,
 	.n_register_classes    = N_AMD64_CLASSES,
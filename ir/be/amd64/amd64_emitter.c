@@ -221,12 +221,13 @@ static void amd64_emit_immediate64(const amd64_imm64_t *const imm)
 {
 	if (imm->kind == X86_IMM_VALUE) {
 		assert(imm->entity == NULL);
-		be_emit_irprintf("0x%" PRIX64, imm->offset);
+		be_emit_cstring("0x");
+		be_emit_hex(imm->offset);
 		return;
 	}
 	x86_emit_relocation_no_offset(imm->kind, imm->entity);
 	if (imm->offset != 0)
-		be_emit_irprintf("%+" PRId64, imm->offset);
+		be_emit_offset(imm->offset);
 }
 
 static void amd64_emit_am(const ir_node *const node, bool indirect_star)
@@ -328,7 +329,9 @@ static void emit_shiftop(const ir_node *const node)
 
 	switch (attr->base.op_mode) {
 	case AMD64_OP_SHIFT_IMM: {
-		be_emit_irprintf("$%u, ", attr->immediate);
+		be_emit_char('$');
+		be_emit_unsigned(attr->immediate);
+		be_emit_cstring(", ");
 		const arch_register_t *reg = arch_get_irn_register_in(node, 0);
 		emit_register_mode(reg, attr->base.size);
 		return;
@@ -372,9 +375,12 @@ end_of_mods:
 				case 'F': {
 					x87_attr_t const *const attr
 						= amd64_get_x87_attr_const(node);
-					char const *const fmt
-						= attr->res_in_reg ? "%%st, %%%s" : "%%%s, %%st";
-					be_emit_irprintf(fmt, attr->reg->name);
+					if (attr->res_in_reg)
+						be_emit_cstring("%st, ");
+					be_emit_char('%');
+					be_emit_string(attr->reg->name);
+					if (!attr->res_in_reg)
+						be_emit_cstring(", %st");
 					break;
 				}
 				case 'M':
@@ -827,6 +833,8 @@ static void amd64_register_emitters(void)
  */
 static void amd64_gen_block(ir_node *block)
 {
+	if (be_should_align_loop_header(block))
+		be_gas_emit_code_alignment(4, 10);
 	be_gas_begin_block(block);
 
 	if (omit_fp) {
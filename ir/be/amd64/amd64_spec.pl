@@ -109,6 +109,19 @@ $mode_x87   = "x86_mode_E";
 		."\tattr->base.base.base.op_mode = AMD64_OP_X87_ADDR_REG;\n",
 );
 
+# Execution units of the machine model, loosely following the ports of current
+# out-of-order x86 cores.
+@execution_units = ( "p0", "p1", "p2", "p3", "p4", "p5", "p6" );
+
+my $alu_units    = [ "p0", "p1", "p5", "p6" ];
+my $shift_units  = [ "p0", "p6" ];
+my $mul_units    = [ "p1" ];
+my $div_units    = [ "p0" ];
+my $fp_units     = [ "p0", "p1" ];
+my $load_units   = [ "p2", "p3" ];
+my $store_units  = [ "p4" ];
+my $branch_units = [ "p6" ];
+
 my $binop = {
 	irn_flags => [ "modify_flags" ],
 	state     => "exc_pinned",
@@ -118,6 +131,8 @@ my $binop = {
 	attr_type => "amd64_binop_addr_attr_t",
 	attr      => "const amd64_binop_addr_attr_t *attr_init",
 	emit      => "{name}%M %AM",
+	latency   => 1,
+	units     => $alu_units,
 };
 
 my $binop_commutative = {
@@ -129,6 +144,8 @@ my $binop_commutative = {
 	attr_type => "amd64_binop_addr_attr_t",
 	attr      => "const amd64_binop_addr_attr_t *attr_init",
 	emit      => "{name}%M %AM",
+	latency   => 1,
+	units     => $alu_units,
 };
 
 my $cmpop = {
@@ -140,6 +157,8 @@ my $cmpop = {
 	attr_type => "amd64_binop_addr_attr_t",
 	attr      => "const amd64_binop_addr_attr_t *attr_init",
 	emit      => "{name}%M %AM",
+	latency   => 1,
+	units     => $alu_units,
 };
 
 my $sextop = {
@@ -148,6 +167,8 @@ my $sextop = {
 	ins      => [ "val" ],
 	init     => "arch_set_additional_pressure(res, &amd64_reg_classes[CLASS_amd64_gp], 1);",
 	emit     => "{name}",
+	latency  => 1,
+	units    => $alu_units,
 };
 
 my $divop = {
@@ -161,6 +182,9 @@ my $divop = {
 	            ."amd64_op_mode_t op_mode = AMD64_OP_REG;\n",
 	attr      => "x86_insn_size_t size",
 	emit      => "{name}%M %AM",
+	latency   => 26,
+	throughput => 6,
+	units     => $div_units,
 };
 
 my $mulop = {
@@ -176,6 +200,8 @@ my $mulop = {
 	attr_type => "amd64_addr_attr_t",
 	attr      => "x86_insn_size_t size, amd64_op_mode_t op_mode, x86_addr_t addr",
 	emit      => "{name}%M %AM",
+	latency   => 3,
+	units     => $mul_units,
 };
 
 my $shiftop = {
@@ -186,6 +212,8 @@ my $shiftop = {
 	attr_type => "amd64_shift_attr_t",
 	attr      => "const amd64_shift_attr_t *attr_init",
 	emit      => "{name}%M %SO",
+	latency   => 1,
+	units     => $shift_units,
 };
 
 my $unop = {
@@ -199,6 +227,8 @@ my $unop = {
 	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_REG;\n"
 	            ."x86_addr_t addr = { .base_input = 0, .variant = X86_ADDR_REG };",
 	emit      => "{name}%M %AM",
+	latency   => 1,
+	units     => $alu_units,
 };
 
 my $unop_out = {
@@ -209,6 +239,8 @@ my $unop_out = {
 	attr_type => "amd64_addr_attr_t",
 	attr      => "x86_insn_size_t size, amd64_op_mode_t op_mode, x86_addr_t addr",
 	emit      => "{name}%M %AM, %D0",
+	latency   => 3,
+	units     => $mul_units,
 };
 
 my $binopx = {
@@ -220,6 +252,8 @@ my $binopx = {
 	attr_type => "amd64_binop_addr_attr_t",
 	attr      => "const amd64_binop_addr_attr_t *attr_init",
 	emit      => "{name} %AM",
+	latency   => 4,
+	units     => $fp_units,
 };
 
 my $binopx_commutative = {
@@ -231,6 +265,8 @@ my $binopx_commutative = {
 	attr_type => "amd64_binop_addr_attr_t",
 	attr      => "const amd64_binop_addr_attr_t *attr_init",
 	emit      => "{name}%MX %AM",
+	latency   => 4,
+	units     => $fp_units,
 };
 
 my $cvtop2x = {
@@ -241,6 +277,8 @@ my $cvtop2x = {
 	attr_type => "amd64_addr_attr_t",
 	attr      => "x86_insn_size_t size, amd64_op_mode_t op_mode, x86_addr_t addr",
 	emit      => "{name} %AM, %^D0",
+	latency   => 4,
+	units     => $fp_units,
 };
 
 my $cvtopx2i = {
@@ -251,6 +289,8 @@ my $cvtopx2i = {
 	attr_type => "amd64_addr_attr_t",
 	attr      => "x86_insn_size_t size, amd64_op_mode_t op_mode, x86_addr_t addr",
 	emit      => "{name} %AM, %D0",
+	latency   => 6,
+	units     => $fp_units,
 };
 
 my $movopx = {
@@ -261,6 +301,8 @@ my $movopx = {
 	attr_type => "amd64_addr_attr_t",
 	attr      => "amd64_op_mode_t op_mode, x86_addr_t addr",
 	emit      => "{name} %AM, %D0",
+	latency   => 5,
+	units     => $load_units,
 };
 
 my $x87const = {
@@ -271,6 +313,7 @@ my $x87const = {
 	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_X87;\n"
 	            ."x86_insn_size_t size    = X86_SIZE_80;\n",
 	emit      => "{name}",
+	latency   => 1,
 };
 
 my $x87unop = {
@@ -280,6 +323,7 @@ my $x87unop = {
 	ins       => [ "value" ],
 	attr_type => "amd64_x87_attr_t",
 	emit      => "{name}",
+	latency   => 1,
 };
 
 my $x87binop = {
@@ -289,6 +333,8 @@ my $x87binop = {
 	out_reqs  => [ "x87" ],
 	ins       => [ "left", "right" ],
 	attr_type => "amd64_x87_attr_t",
+	latency   => 5,
+	units     => $fp_units,
 };
 
 my $x87store = {
@@ -299,6 +345,8 @@ my $x87store = {
 	outs      => [ "M" ],
 	attr_type => "amd64_x87_binop_addr_attr_t",
 	attr      => "const amd64_binop_addr_attr_t *attr_init",
+	latency   => 4,
+	units     => $store_units,
 };
 
 my $fmaop = {
@@ -309,6 +357,8 @@ my $fmaop = {
 	attr_type => "amd64_addr_attr_t",
 	attr      => "x86_insn_size_t size, amd64_op_mode_t op_mode, x86_addr_t addr",
 	emit      => "{name}%MX %AM",
+	latency   => 4,
+	units     => $fp_units,
 };
 
 %nodes = (
@@ -322,6 +372,8 @@ push_am => {
 	attr      => "x86_insn_size_t size, x86_addr_t addr",
 	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_ADDR;\n",
 	emit      => "push%M %A",
+	latency   => 2,
+	units     => $store_units,
 },
 
 push_reg => {
@@ -333,6 +385,8 @@ push_reg => {
 	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_NONE;\n",
 	attr      => "x86_insn_size_t size",
 	emit      => "push%M %^S2",
+	latency   => 1,
+	units     => $store_units,
 },
 
 pop_am => {
@@ -345,6 +399,8 @@ pop_am => {
 	attr      => "x86_insn_size_t size, x86_addr_t addr",
 	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_ADDR;\n",
 	emit      => "pop%M %A",
+	latency   => 2,
+	units     => $load_units,
 },
 
 sub_sp => {
@@ -358,6 +414,8 @@ sub_sp => {
 	attr      => "const amd64_binop_addr_attr_t *attr_init",
 	emit      => "subq %AM\n".
 	             "movq %%rsp, %D1",
+	latency   => 1,
+	units     => $alu_units,
 },
 
 leave => {
@@ -368,6 +426,8 @@ leave => {
 	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_NONE;\n"
 	            ."x86_insn_size_t size    = X86_SIZE_64;\n",
 	emit      => "leave",
+	latency   => 3,
+	units     => $load_units,
 },
 
 add => { template => $binop_commutative },
@@ -390,7 +450,11 @@ div => { template => $divop },
 
 idiv => { template => $divop },
 
-imul => { template => $binop_commutative },
+imul => {
+	template => $binop_commutative,
+	latency  => 3,
+	units    => $mul_units,
+},
 
 imul_1op => {
 	template => $mulop,
@@ -428,6 +492,7 @@ xor_0 => {
 	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_NONE;",
 	attr      => "x86_insn_size_t size",
 	emit      => "xor%M %3D0, %3D0",
+	latency   => 1,
 },
 
 mov_imm => {
@@ -438,6 +503,8 @@ mov_imm => {
 	attr_type => "amd64_movimm_attr_t",
 	attr      => "x86_insn_size_t size, const amd64_imm64_t *imm",
 	emit      => 'mov%M $%C, %D0',
+	latency   => 1,
+	units     => $alu_units,
 },
 
 movs => {
@@ -448,6 +515,8 @@ movs => {
 	attr_type => "amd64_addr_attr_t",
 	attr      => "x86_insn_size_t size, amd64_op_mode_t op_mode, x86_addr_t addr",
 	emit      => "movs%Mq %AM, %^D0",
+	latency   => 4,
+	units     => $load_units,
 },
 
 mov_gp => {
@@ -457,6 +526,8 @@ mov_gp => {
 	outs      => [ "res", "unused", "M" ],
 	attr_type => "amd64_addr_attr_t",
 	attr      => "x86_insn_size_t size, amd64_op_mode_t op_mode, x86_addr_t addr",
+	latency   => 4,
+	units     => $load_units,
 },
 
 ijmp => {
@@ -468,6 +539,8 @@ ijmp => {
 	attr_type => "amd64_addr_attr_t",
 	attr      => "x86_insn_size_t size, amd64_op_mode_t op_mode, x86_addr_t addr",
 	emit      => "jmp %*AM",
+	latency   => 1,
+	units     => $branch_units,
 },
 
 jmp => {
@@ -477,6 +550,8 @@ jmp => {
 	out_reqs  => [ "exec" ],
 	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_NONE;\n"
 	            ."x86_insn_size_t size    = X86_SIZE_64;\n",
+	latency   => 1,
+	units     => $branch_units,
 },
 
 cmp => { template => $cmpop },
@@ -492,6 +567,8 @@ cmpxchg => {
 	attr_type => "amd64_binop_addr_attr_t",
 	attr      => "const amd64_binop_addr_attr_t *attr_init",
 	emit      => "lock cmpxchg%M %AM",
+	latency   => 5,
+	units     => $alu_units,
 },
 
 # TODO Setcc can also operate on memory
@@ -505,6 +582,8 @@ setcc => {
 	attr      => "x86_condition_code_t cc",
 	fixed     => "x86_insn_size_t size = X86_SIZE_8;",
 	emit      => "set%P0 %D0",
+	latency   => 1,
+	units     => $shift_units,
 },
 
 lea => {
@@ -516,6 +595,8 @@ lea => {
 	attr      => "x86_insn_size_t size, x86_addr_t addr",
 	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_ADDR;\n",
 	emit      => "lea%M %A, %D0",
+	latency   => 1,
+	units     => $alu_units,
 },
 
 jcc => {
@@ -528,6 +609,8 @@ jcc => {
 	attr_type => "amd64_cc_attr_t",
 	attr      => "x86_condition_code_t cc",
 	fixed     => "x86_insn_size_t size = X86_SIZE_64;",
+	latency   => 1,
+	units     => $branch_units,
 },
 
 mov_store => {
@@ -539,6 +622,8 @@ mov_store => {
 	attr_type => "amd64_binop_addr_attr_t",
 	attr      => "const amd64_binop_addr_attr_t *attr_init",
 	emit      => "mov%M %AM",
+	latency   => 1,
+	units     => $store_units,
 },
 
 jmp_switch => {
@@ -548,6 +633,8 @@ jmp_switch => {
 	out_reqs  => "...",
 	attr_type => "amd64_switch_jmp_attr_t",
 	attr      => "amd64_op_mode_t op_mode, x86_insn_size_t size, const x86_addr_t *addr, const ir_switch_table *table, ir_entity *table_entity",
+	latency   => 1,
+	units     => $branch_units,
 },
 
 call => {
@@ -559,6 +646,8 @@ call => {
 	attr_type => "amd64_call_addr_attr_t",
 	attr      => "const amd64_call_addr_attr_t *attr_init",
 	emit      => "call %*AM",
+	latency   => 1,
+	units     => $branch_units,
 },
 
 ret => {
@@ -570,6 +659,8 @@ ret => {
 	fixed    => "amd64_op_mode_t op_mode = AMD64_OP_NONE;\n"
 	           ."x86_insn_size_t size    = X86_SIZE_64;\n",
 	emit     => "ret",
+	latency  => 1,
+	units    => $branch_units,
 },
 
 bsf => { template => $unop_out },
@@ -583,6 +674,9 @@ adds => { template => $binopx_commutative },
 divs => {
 	template => $binopx,
 	emit     => "divs%MX %AM",
+	latency  => 13,
+	throughput => 4,
+	units    => $div_units,
 },
 
 movs_xmm => {
@@ -602,6 +696,8 @@ movs_store_xmm => {
 	attr_type => "amd64_binop_addr_attr_t",
 	attr      => "const amd64_binop_addr_attr_t *attr_init",
 	emit      => "movs%MX %^S0, %A",
+	latency   => 1,
+	units     => $store_units,
 },
 
 subs => {
@@ -618,6 +714,8 @@ ucomis => {
 	attr_type => "amd64_binop_addr_attr_t",
 	attr      => "const amd64_binop_addr_attr_t *attr_init",
 	emit      => "ucomis%MX %AM",
+	latency   => 2,
+	units     => $fp_units,
 },
 
 xorp_0 => {
@@ -628,9 +726,14 @@ xorp_0 => {
 	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_NONE;",
 	attr      => "x86_insn_size_t size",
 	emit      => "xorp%MX %^D0, %^D0",
+	latency   => 1,
 },
 
-xorp => { template => $binopx_commutative },
+xorp => {
+	template => $binopx_commutative,
+	latency  => 1,
+	units    => $alu_units,
+},
 
 movd_xmm_gp => {
 	state     => "exc_pinned",
@@ -640,7 +743,9 @@ movd_xmm_gp => {
 	out_reqs  => [ "gp" ],
 	attr_type => "amd64_addr_attr_t",
 	attr      => "x86_insn_size_t size, amd64_op_mode_t op_mode, x86_addr_t addr",
-	emit      => "movd %S0, %D0"
+	emit      => "movd %S0, %D0",
+	latency   => 2,
+	units     => $fp_units,
 },
 
 movd_gp_xmm => {
@@ -651,7 +756,9 @@ movd_gp_xmm => {
 	out_reqs  => [ "xmm" ],
 	attr_type => "amd64_addr_attr_t",
 	attr      => "x86_insn_size_t size, amd64_op_mode_t op_mode, x86_addr_t addr",
-	emit      => "movd %S0, %D0"
+	emit      => "movd %S0, %D0",
+	latency   => 2,
+	units     => $fp_units,
 },
 
 pxor_0 => {
@@ -662,6 +769,7 @@ pxor_0 => {
 	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_NONE;",
 	attr      => "x86_insn_size_t size",
 	emit      => "pxor %^D0, %^D0",
+	latency   => 1,
 },
 
 # Conversion operations
@@ -706,6 +814,8 @@ movdqu_store => {
 	attr_type => "amd64_binop_addr_attr_t",
 	attr      => "const amd64_binop_addr_attr_t *attr_init",
 	emit      => "movdqu %^S0, %A",
+	latency   => 1,
+	units     => $store_units,
 },
 
 copyB => {
@@ -716,6 +826,7 @@ copyB => {
 	attr_type => "amd64_copyb_attr_t",
 	attr      => "unsigned size",
 	latency   => 250,
+	units     => $store_units,
 },
 
 copyB_i => {
@@ -726,6 +837,7 @@ copyB_i => {
 	attr_type => "amd64_copyb_attr_t",
 	attr      => "unsigned size",
 	latency   => 3,
+	units     => $store_units,
 },
 
 l_punpckldq => {
@@ -772,6 +884,8 @@ fld => {
 	attr_type => "amd64_x87_addr_attr_t",
 	attr      => "x86_insn_size_t size, amd64_op_mode_t op_mode, x86_addr_t addr",
 	emit      => "fld%FM %AM",
+	latency   => 4,
+	units     => $load_units,
 },
 
 fild => {
@@ -784,6 +898,8 @@ fild => {
 	attr_type => "amd64_x87_addr_attr_t",
 	attr      => "x86_insn_size_t size, amd64_op_mode_t op_mode, x86_addr_t addr",
 	emit      => "fild%M %AM",
+	latency   => 6,
+	units     => $load_units,
 },
 
 fisttp => {
@@ -809,6 +925,9 @@ fadd => {
 fdiv => {
 	template => $x87binop,
 	emit     => "fdiv%FR%FP %AF",
+	latency  => 15,
+	throughput => 4,
+	units    => $div_units,
 },
 
 fmul => {
@@ -831,6 +950,8 @@ fucomi => {
 	outs      => [ "flags" ],
 	attr_type => "amd64_x87_attr_t",
 	emit      => "fucom%FPi %F0",
+	latency   => 2,
+	units     => $fp_units,
 },
 
 fdup => {
@@ -842,6 +963,7 @@ fdup => {
 	attr        => "const arch_register_t *reg",
 	init        => "attr->x87.reg = reg;",
 	emit        => "fld %F0",
+	latency     => 1,
 },
 
 fxch => {
@@ -852,6 +974,7 @@ fxch => {
 	attr        => "const arch_register_t *reg",
 	init        => "attr->x87.reg = reg;",
 	emit        => "fxch %F0",
+	latency     => 1,
 },
 
 fpop => {
@@ -862,6 +985,7 @@ fpop => {
 	attr        => "const arch_register_t *reg",
 	init        => "attr->x87.reg = reg;",
 	emit        => "fstp %F0",
+	latency     => 1,
 },
 
 # FMA instructions
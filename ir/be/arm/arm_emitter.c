@@ -77,8 +77,10 @@ static void arm_emit_address_mode(ir_node const *const node)
 	arm_load_store_attr_t const *const attr = get_arm_load_store_attr_const(node);
 	assert(attr->base.is_load_store);
 	long const offset = attr->offset;
-	if (offset != 0)
-		be_emit_irprintf(", #%ld", attr->offset);
+	if (offset != 0) {
+		be_emit_cstring(", #");
+		be_emit_signed(offset);
+	}
 
 	be_emit_char(']');
 }
@@ -179,7 +181,8 @@ static void arm_emit_shifter_operand(const ir_node *node)
 		val = (val >> attr->shift_immediate)
 			| (val << ((32-attr->shift_immediate) & 31));
 		val &= 0xFFFFFFFF;
-		be_emit_irprintf("#0x%X", val);
+		be_emit_cstring("#0x");
+		be_emit_hex(val);
 		return;
 	}
 	case ARM_SHF_ASR_IMM:
@@ -188,7 +191,10 @@ static void arm_emit_shifter_operand(const ir_node *node)
 	case ARM_SHF_ROR_IMM: {
 		arm_emit_source_register(node, attr->shifter_op_input);
 		char const *const mod = get_shf_mod_name(attr->shift_modifier);
-		be_emit_irprintf(", %s #%u", mod, attr->shift_immediate);
+		be_emit_cstring(", ");
+		be_emit_string(mod);
+		be_emit_cstring(" #");
+		be_emit_unsigned(attr->shift_immediate);
 		return;
 	}
 
@@ -448,12 +454,12 @@ static void emit_arm_asm_operand(ir_node const *const node, char const modifier,
 				be_emit_char('~');
 			be_gas_emit_entity(op->ent);
 			if (op->val != 0)
-				be_emit_irprintf("%+" PRId32, op->val);
+				be_emit_offset(op->val);
 		} else {
 			int32_t val = op->val;
 			if (modifier == 'B')
 				val = ~val;
-			be_emit_irprintf("%" PRId32, val);
+			be_emit_signed(val);
 		}
 		return;
 
@@ -10,6 +10,7 @@
  */
 #include "bearch.h"
 
+#include "array.h"
 #include "be_t.h"
 #include "beinfo.h"
 #include "beirg.h"
@@ -21,6 +22,7 @@
 #include "raw_bitset.h"
 #include "target_t.h"
 #include "util.h"
+#include <string.h>
 
 arch_register_class_t arch_exec_cls = {
 	.name      = "exec",
@@ -146,6 +148,53 @@ be_add_pressure_t arch_get_additional_pressure(ir_node const *const node, arch_r
 	return 0;
 }
 
+/** Machine models indexed by opcode, throughput 0 marks missing entries. */
+static arch_machine_info_t *machine_infos;
+
+static arch_machine_info_t const default_machine_info = {
+	.latency    = 1,
+	.throughput = 1,
+	.units      = 0,
+};
+
+void arch_set_op_machine_info(ir_op const *const op, unsigned const latency,
+                              unsigned const throughput, unsigned const units)
+{
+	if (machine_infos == NULL)
+		machine_infos = NEW_ARR_F(arch_machine_info_t, 0);
+	unsigned const code  = get_op_code(op);
+	size_t   const n_old = ARR_LEN(machine_infos);
+	if (code >= n_old) {
+		ARR_RESIZE(arch_machine_info_t, machine_infos, code + 1);
+		memset(&machine_infos[n_old], 0,
+		       (code + 1 - n_old) * sizeof(machine_infos[0]));
+	}
+	machine_infos[code] = (arch_machine_info_t) {
+		.latency    = latency,
+		.throughput = throughput,
+		.units      = units,
+	};
+}
+
+arch_machine_info_t const *arch_get_irn_machine_info(ir_node const *const node)
+{
+	unsigned const code = get_irn_opcode(node);
+	if (machine_infos != NULL && code < ARR_LEN(machine_infos)) {
+		arch_machine_info_t const *const info = &machine_infos[code];
+		if (info->throughput != 0)
+			return info;
+	}
+	return &default_machine_info;
+}
+
+void arch_free_machine_infos(void)
+{
+	if (machine_infos != NULL) {
+		DEL_ARR_F(machine_infos);
+		machine_infos = NULL;
+	}
+}
+
 void arch_copy_irn_out_info(ir_node *const dst, unsigned const dst_pos, ir_node const *const src)
 {
 	reg_out_info_t *const src_info = get_out_info(src);
@@ -138,6 +138,37 @@ void arch_set_additional_pressure(ir_node *node, arch_register_class_t const *,
 
 be_add_pressure_t arch_get_additional_pressure(ir_node const *node, arch_register_class_t const *cls);
 
+/**
+ * Machine model of an instruction, used by latency aware schedulers.
+ */
+typedef struct arch_machine_info_t {
+	/** Cycles until the results are available to dependent instructions. */
+	unsigned latency;
+	/** Cycles until the execution unit accepts the next instruction. */
+	unsigned throughput;
+	/** Bitmask of the execution units able to execute the instruction,
+	 * 0 if any unit can. */
+	unsigned units;
+} arch_machine_info_t;
+
+/**
+ * Sets the machine model for all nodes with opcode @p op. This is called
+ * from the generated opcode initialization for nodes with a latency.
+ */
+void arch_set_op_machine_info(ir_op const *op, unsigned latency,
+                              unsigned throughput, unsigned units);
+
+/**
+ * Returns the machine model of @p node. Nodes without a model get a latency
+ * and throughput of 1 on any execution unit.
+ */
+arch_machine_info_t const *arch_get_irn_machine_info(ir_node const *node);
+
+/**
+ * Frees the machine models set with arch_set_op_machine_info().
+ */
+void arch_free_machine_infos(void);
+
 /**
  * Returns true if the given node should not be scheduled (has
  * arch_irn_flag_not_scheduled flag set)
@@ -268,6 +299,9 @@ struct arch_isa_if_t {
 	                                         necessary/recommended for any data
 	                                         type on the target. */
 	bool        pic_supported;
+	/** The code emitted for a function only depends on its graph, so it may
+	 * be reused from the compile cache. */
+	bool        cacheable_code;
 
 	unsigned                     n_registers;        /**< number of registers */
 	arch_register_t       const *registers;          /**< register array */
@@ -18,12 +18,20 @@
  * to change as many edges to fallthroughs as possible, this is done by setting
  * a next and prev pointers on blocks. The greedy algorithm sorts the edges by
  * execution frequencies and tries to transform them to fallthroughs in this order
+ *
+ * The Ext-TSP algorithm instead maximizes the extended TSP score of the
+ * layout: Besides fallthroughs, short forward and backward jumps count with a
+ * smaller weight decreasing with the jump distance. It starts with one chain
+ * per block and repeatedly performs the merge of two chains increasing the
+ * score the most. Merges may split one of the chains and put the other one in
+ * between or in front of its parts.
  */
 #include "beblocksched.h"
 
 #include "bearch.h"
 #include "beirg.h"
 #include "bemodule.h"
+#include "begnuas.h"
 #include "besched.h"
 #include "debug.h"
 #include "execfreq.h"
@@ -31,11 +39,40 @@
 #include "irgmod.h"
 #include "irgwalk.h"
 #include "irnode_t.h"
+#include "irtools.h"
+#include "lc_opts.h"
+#include "lc_opts_enum.h"
 #include "pdeq.h"
 #include "util.h"
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
 
+typedef enum blocksched_algo_t {
+	BLOCKSCHED_GREEDY,
+	BLOCKSCHED_EXTTSP,
+} blocksched_algo_t;
+
+static int    algo            = BLOCKSCHED_GREEDY;
+static bool   split_cold      = false;
+static double loop_align_trip = 0;
+
+static const lc_opt_enum_int_items_t algo_items[] = {
+	{ "greedy", BLOCKSCHED_GREEDY },
+	{ "exttsp", BLOCKSCHED_EXTTSP },
+	{ NULL,     0 }
+};
+
+static lc_opt_enum_int_var_t algo_var = {
+	&algo, algo_items
+};
+
+static const lc_opt_table_entry_t be_blocksched_options[] = {
+	LC_OPT_ENT_ENUM_INT("algo",      "block scheduling algorithm", &algo_var),
+	LC_OPT_ENT_BOOL    ("splitcold", "move rarely executed blocks into a separate section", &split_cold),
+	LC_OPT_ENT_DBL     ("loopalign", "align loop headers iterating at least this often per entry (0 disables)", &loop_align_trip),
+	LC_OPT_LAST
+};
+
 static bool blocks_removed;
 
 /**
@@ -532,6 +569,591 @@ static ir_node **create_blocksched_array(blocksched_env_t *const env)
 	return block_list;
 }
 
+/** Estimated size of an instruction in bytes, used for jump distances. */
+#define EXTTSP_INSN_SIZE          4
+#define EXTTSP_FALLTHROUGH_WEIGHT 1.0
+#define EXTTSP_FORWARD_WEIGHT     0.1
+#define EXTTSP_BACKWARD_WEIGHT    0.1
+/** Maximum distance in bytes of a forward jump contributing to the score. */
+#define EXTTSP_FORWARD_DISTANCE   1024
+/** Maximum distance in bytes of a backward jump contributing to the score. */
+#define EXTTSP_BACKWARD_DISTANCE  640
+/** Chains with more blocks are not split when merging. */
+#define EXTTSP_SPLIT_THRESHOLD    32
+/** Merges need to improve the score at least this much. */
+#define EXTTSP_MIN_GAIN           1e-12
+
+typedef struct layout_block_t {
+	ir_node  *block;
+	unsigned  size;   /**< estimated size in bytes */
+	double    freq;
+	unsigned  chain;  /**< the chain containing the block */
+	unsigned  offset; /**< offset in the layout being scored */
+} layout_block_t;
+
+typedef struct layout_jump_t {
+	unsigned src;  /**< the source block */
+	unsigned dst;  /**< the target block */
+	double   freq; /**< how often the jump is taken */
+} layout_jump_t;
+
+/** Orders for merging chain X, which may be split into X1 X2, with Y. */
+typedef enum merge_kind_t {
+	MERGE_X_Y,
+	MERGE_X1_Y_X2,
+	MERGE_X2_X1_Y,
+	MERGE_Y_X2_X1,
+	MERGE_X2_Y_X1,
+} merge_kind_t;
+
+typedef struct merge_t {
+	double       gain;  /**< increase of the score */
+	unsigned     x;     /**< the chain which may be split */
+	unsigned     y;
+	unsigned     split; /**< number of blocks in X1 */
+	merge_kind_t kind;
+} merge_t;
+
+typedef struct chain_edge_t {
+	unsigned  a;     /**< one of the connected chains */
+	unsigned  b;     /**< the other one */
+	unsigned *jumps; /**< jumps between the two chains */
+	bool      valid; /**< whether merge is up to date */
+	merge_t   merge; /**< the best merge of the two chains */
+} chain_edge_t;
+
+typedef struct layout_chain_t {
+	unsigned      *blocks; /**< blocks in layout order */
+	unsigned      *jumps;  /**< jumps within the chain */
+	chain_edge_t **edges;  /**< edges to other chains */
+	double         score;
+	double         freq;   /**< sum of the block frequencies */
+	unsigned       size;
+	bool           merged; /**< whether it was merged into another chain */
+} layout_chain_t;
+
+typedef struct exttsp_env_t {
+	struct obstack  obst;
+	layout_block_t *blocks;
+	layout_jump_t  *jumps;
+	layout_chain_t *chains;
+} exttsp_env_t;
+
+/**
+ * Estimates how often the control flow edge from @p pred to @p block is
+ * taken. Critical edges are split, so one of the blocks has only this edge.
+ */
+static double get_jump_freq(ir_node const *const pred, ir_node const *const block)
+{
+	double const pred_freq  = get_block_execfreq(pred);
+	double const block_freq = get_block_execfreq(block);
+	if (get_irn_n_edges_kind(pred, EDGE_KIND_BLOCK) == 1)
+		return pred_freq;
+	if (get_Block_n_cfgpreds(block) == 1)
+		return block_freq;
+	return MIN(pred_freq, block_freq);
+}
+
+static layout_block_t *get_layout_block(ir_node const *const block)
+{
+	return (layout_block_t*)get_irn_link(block);
+}
+
+/** Collects the blocks reachable from the start block in depth first order. */
+static void collect_layout_blocks(exttsp_env_t *const env, ir_graph *const irg)
+{
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_VISITED);
+	inc_irg_visited(irg);
+	/* Exclude the end block from the block schedule. */
+	mark_irn_visited(get_irg_end_block(irg));
+
+	ir_node **stack = NEW_ARR_F(ir_node*, 0);
+	ir_node  *start = get_irg_start_block(irg);
+	mark_irn_visited(start);
+	ARR_APP1(ir_node*, stack, start);
+	while (ARR_LEN(stack) > 0) {
+		ir_node *const block = stack[ARR_LEN(stack) - 1];
+		ARR_SHRINKLEN(stack, ARR_LEN(stack) - 1);
+
+		unsigned n_insns = 1;
+		sched_foreach(block, node) {
+			++n_insns;
+		}
+		layout_block_t const layout_block = {
+			.block = block,
+			.size  = n_insns * EXTTSP_INSN_SIZE,
+			.freq  = get_block_execfreq(block),
+			.chain = ARR_LEN(env->blocks),
+		};
+		ARR_APP1(layout_block_t, env->blocks, layout_block);
+
+		foreach_block_succ(block, edge) {
+			ir_node *const succ = get_edge_src_irn(edge);
+			if (!irn_visited_else_mark(succ))
+				ARR_APP1(ir_node*, stack, succ);
+		}
+	}
+	DEL_ARR_F(stack);
+	ir_free_resources(irg, IR_RESOURCE_IRN_VISITED);
+
+	for (size_t i = 0, n = ARR_LEN(env->blocks); i < n; ++i) {
+		set_irn_link(env->blocks[i].block, &env->blocks[i]);
+	}
+}
+
+static chain_edge_t *find_chain_edge(exttsp_env_t const *const env,
+                                     unsigned const chain, unsigned const other)
+{
+	chain_edge_t **const edges = env->chains[chain].edges;
+	for (size_t i = 0, n = ARR_LEN(edges); i < n; ++i) {
+		chain_edge_t *const edge = edges[i];
+		if (edge->a == other || edge->b == other)
+			return edge;
+	}
+	return NULL;
+}
+
+static void remove_chain_edge(exttsp_env_t *const env, unsigned const chain,
+                              chain_edge_t const *const edge)
+{
+	chain_edge_t **const edges = env->chains[chain].edges;
+	size_t         const n     = ARR_LEN(edges);
+	for (size_t i = 0; i < n; ++i) {
+		if (edges[i] == edge) {
+			edges[i] = edges[n - 1];
+			ARR_SHRINKLEN(edges, n - 1);
+			return;
+		}
+	}
+	panic("chain edge not found");
+}
+
+/** Creates a chain for each block and connects the chains by the jumps. */
+static void init_chains(exttsp_env_t *const env)
+{
+	size_t const n_blocks = ARR_LEN(env->blocks);
+	for (size_t i = 0; i < n_blocks; ++i) {
+		ir_node *const block = env->blocks[i].block;
+		for (int p = 0, arity = get_Block_n_cfgpreds(block); p < arity; ++p) {
+			ir_node *const pred = get_Block_cfgpred(block, p);
+			if (is_Bad(pred))
+				continue;
+			ir_node        *const pred_block = get_nodes_block(pred);
+			layout_block_t *const src        = get_layout_block(pred_block);
+			layout_jump_t   const jump       = {
+				.src  = src - env->blocks,
+				.dst  = i,
+				.freq = get_jump_freq(pred_block, block),
+			};
+			ARR_APP1(layout_jump_t, env->jumps, jump);
+		}
+	}
+
+	for (size_t i = 0; i < n_blocks; ++i) {
+		layout_block_t const *const block = &env->blocks[i];
+		layout_chain_t        const chain = {
+			.blocks = NEW_ARR_F(unsigned, 1),
+			.jumps  = NEW_ARR_F(unsigned, 0),
+			.edges  = NEW_ARR_F(chain_edge_t*, 0),
+			.freq   = block->freq,
+			.size   = block->size,
+		};
+		chain.blocks[0] = i;
+		ARR_APP1(layout_chain_t, env->chains, chain);
+	}
+
+	for (size_t j = 0, n = ARR_LEN(env->jumps); j < n; ++j) {
+		layout_jump_t const *const jump = &env->jumps[j];
+		if (jump->src == jump->dst) {
+			ARR_APP1(unsigned, env->chains[jump->src].jumps, j);
+			continue;
+		}
+		chain_edge_t *edge = find_chain_edge(env, jump->src, jump->dst);
+		if (edge == NULL) {
+			edge        = OALLOCZ(&env->obst, chain_edge_t);
+			edge->a     = jump->src;
+			edge->b     = jump->dst;
+			edge->jumps = NEW_ARR_F(unsigned, 0);
+			ARR_APP1(chain_edge_t*, env->chains[jump->src].edges, edge);
+			ARR_APP1(chain_edge_t*, env->chains[jump->dst].edges, edge);
+		}
+		ARR_APP1(unsigned, edge->jumps, j);
+	}
+}
+
+static double get_jump_score(exttsp_env_t const *const env, unsigned const j)
+{
+	layout_jump_t  const *const jump    = &env->jumps[j];
+	layout_block_t const *const src     = &env->blocks[jump->src];
+	unsigned              const src_end = src->offset + src->size;
+	unsigned              const dst     = env->blocks[jump->dst].offset;
+	if (dst == src_end)
+		return jump->freq * EXTTSP_FALLTHROUGH_WEIGHT;
+	if (dst > src_end) {
+		unsigned const distance = dst - src_end;
+		if (distance <= EXTTSP_FORWARD_DISTANCE) {
+			return jump->freq * EXTTSP_FORWARD_WEIGHT
+			     * (1.0 - (double)distance / EXTTSP_FORWARD_DISTANCE);
+		}
+	} else {
+		unsigned const distance = src_end - dst;
+		if (distance <= EXTTSP_BACKWARD_DISTANCE) {
+			return jump->freq * EXTTSP_BACKWARD_WEIGHT
+			     * (1.0 - (double)distance / EXTTSP_BACKWARD_DISTANCE);
+		}
+	}
+	return 0;
+}
+
+static double get_jumps_score(exttsp_env_t const *const env,
+                              unsigned const *const jumps)
+{
+	double score = 0;
+	for (size_t i = 0, n = ARR_LEN(jumps); i < n; ++i) {
+		score += get_jump_score(env, jumps[i]);
+	}
+	return score;
+}
+
+/** Appends the blocks @p begin to @p end to the layout at @p offset. */
+static void place_blocks(exttsp_env_t *const env, unsigned const *const begin,
+                         unsigned const *const end, unsigned *const offset)
+{
+	for (unsigned const *b = begin; b != end; ++b) {
+		layout_block_t *const block = &env->blocks[*b];
+		block->offset = *offset;
+		*offset      += block->size;
+	}
+}
+
+/**
+ * Lays out the blocks of the merge of chains @p m->x and @p m->y. Appends
+ * them to @p order, if it is not NULL. Returns the first block.
+ */
+static unsigned place_merge(exttsp_env_t *const env, merge_t const *const m,
+                            unsigned **const order)
+{
+	unsigned const *const x  = env->chains[m->x].blocks;
+	unsigned const *const y  = env->chains[m->y].blocks;
+	unsigned const *const x1 = x;
+	unsigned const *const x2 = x + m->split;
+	unsigned const *const xe = x + ARR_LEN(x);
+	unsigned const *const ye = y + ARR_LEN(y);
+
+	unsigned const *parts[3][2];
+	switch (m->kind) {
+	case MERGE_X_Y:
+		parts[0][0] = x;  parts[0][1] = xe;
+		parts[1][0] = y;  parts[1][1] = ye;
+		parts[2][0] = ye; parts[2][1] = ye;
+		break;
+	case MERGE_X1_Y_X2:
+		parts[0][0] = x1; parts[0][1] = x2;
+		parts[1][0] = y;  parts[1][1] = ye;
+		parts[2][0] = x2; parts[2][1] = xe;
+		break;
+	case MERGE_X2_X1_Y:
+		parts[0][0] = x2; parts[0][1] = xe;
+		parts[1][0] = x1; parts[1][1] = x2;
+		parts[2][0] = y;  parts[2][1] = ye;
+		break;
+	case MERGE_Y_X2_X1:
+		parts[0][0] = y;  parts[0][1] = ye;
+		parts[1][0] = x2; parts[1][1] = xe;
+		parts[2][0] = x1; parts[2][1] = x2;
+		break;
+	case MERGE_X2_Y_X1:
+		parts[0][0] = x2; parts[0][1] = xe;
+		parts[1][0] = y;  parts[1][1] = ye;
+		parts[2][0] = x1; parts[2][1] = x2;
+		break;
+	default:
+		panic("invalid merge kind");
+	}
+
+	unsigned offset = 0;
+	for (size_t p = 0; p < ARRAY_SIZE(parts); ++p) {
+		place_blocks(env, parts[p][0], parts[p][1], &offset);
+		if (order != NULL) {
+			for (unsigned const *b = parts[p][0]; b != parts[p][1]; ++b) {
+				ARR_APP1(unsigned, *order, *b);
+			}
+		}
+	}
+	return *parts[0][0];
+}
+
+static void evaluate_merge(exttsp_env_t *const env,
+                           chain_edge_t const *const edge, merge_t *const m,
+                           merge_t *const best)
+{
+	/* The start block has to stay in front. */
+	unsigned const first = place_merge(env, m, NULL);
+	if (first != 0 && (env->chains[m->x].blocks[0] == 0
+	                || env->chains[m->y].blocks[0] == 0))
+		return;
+
+	layout_chain_t const *const x = &env->chains[m->x];
+	layout_chain_t const *const y = &env->chains[m->y];
+	double const score = get_jumps_score(env, x->jumps)
+	                   + get_jumps_score(env, y->jumps)
+	                   + get_jumps_score(env, edge->jumps);
+	m->gain = score - x->score - y->score;
+	if (m->gain > best->gain)
+		*best = *m;
+}
+
+/** Computes the best merge of the chains connected by @p edge. */
+static void compute_merge(exttsp_env_t *const env, chain_edge_t *const edge)
+{
+	merge_t best = { .gain = -1.0 };
+	for (unsigned d = 0; d < 2; ++d) {
+		merge_t m = {
+			.x    = d == 0 ? edge->a : edge->b,
+			.y    = d == 0 ? edge->b : edge->a,
+			.kind = MERGE_X_Y,
+		};
+		evaluate_merge(env, edge, &m, &best);
+
+		size_t const n_x = ARR_LEN(env->chains[m.x].blocks);
+		if (n_x > EXTTSP_SPLIT_THRESHOLD)
+			continue;
+		for (m.split = 1; m.split < n_x; ++m.split) {
+			for (m.kind = MERGE_X1_Y_X2; m.kind <= MERGE_X2_Y_X1; ++m.kind) {
+				evaluate_merge(env, edge, &m, &best);
+			}
+		}
+	}
+	edge->merge = best;
+	edge->valid = true;
+}
+
+static void append_jumps(unsigned **const dst, unsigned const *const src)
+{
+	for (size_t i = 0, n = ARR_LEN(src); i < n; ++i) {
+		ARR_APP1(unsigned, *dst, src[i]);
+	}
+}
+
+static void merge_chains(exttsp_env_t *const env, chain_edge_t *const edge)
+{
+	merge_t         const m = edge->merge;
+	layout_chain_t *const x = &env->chains[m.x];
+	layout_chain_t *const y = &env->chains[m.y];
+	DB((dbg, LEVEL_2, "Merge chains of %+F and %+F (kind %d, gain %.3g)\n",
+	    env->blocks[x->blocks[0]].block, env->blocks[y->blocks[0]].block,
+	    (int)m.kind, m.gain));
+
+	unsigned *order = NEW_ARR_F(unsigned, 0);
+	place_merge(env, &m, &order);
+	for (size_t i = 0, n = ARR_LEN(y->blocks); i < n; ++i) {
+		env->blocks[y->blocks[i]].chain = m.x;
+	}
+	DEL_ARR_F(x->blocks);
+	x->blocks = order;
+	append_jumps(&x->jumps, y->jumps);
+	append_jumps(&x->jumps, edge->jumps);
+	x->score += y->score + m.gain;
+	x->freq  += y->freq;
+	x->size  += y->size;
+
+	remove_chain_edge(env, m.x, edge);
+	remove_chain_edge(env, m.y, edge);
+	DEL_ARR_F(edge->jumps);
+
+	/* Move the edges of Y to X. */
+	for (size_t i = 0, n = ARR_LEN(y->edges); i < n; ++i) {
+		chain_edge_t *const y_edge = y->edges[i];
+		unsigned      const other  = y_edge->a == m.y ? y_edge->b : y_edge->a;
+		chain_edge_t *const x_edge = find_chain_edge(env, m.x, other);
+		if (x_edge != NULL) {
+			append_jumps(&x_edge->jumps, y_edge->jumps);
+			remove_chain_edge(env, other, y_edge);
+			DEL_ARR_F(y_edge->jumps);
+		} else {
+			y_edge->a = m.x;
+			y_edge->b = other;
+			ARR_APP1(chain_edge_t*, x->edges, y_edge);
+		}
+	}
+	for (size_t i = 0, n = ARR_LEN(x->edges); i < n; ++i) {
+		x->edges[i]->valid = false;
+	}
+
+	DEL_ARR_F(y->blocks);
+	DEL_ARR_F(y->jumps);
+	DEL_ARR_F(y->edges);
+	y->merged = true;
+}
+
+static double get_chain_density(layout_chain_t const *const chain)
+{
+	return chain->freq / chain->size;
+}
+
+static exttsp_env_t *sort_env;
+
+/** Sorts the chain of the start block first, then by density. */
+static int cmp_chains(const void *d1, const void *d2)
+{
+	unsigned const c1 = *(unsigned const*)d1;
+	unsigned const c2 = *(unsigned const*)d2;
+	layout_chain_t const *const chain1 = &sort_env->chains[c1];
+	layout_chain_t const *const chain2 = &sort_env->chains[c2];
+	if ((chain1->blocks[0] == 0) != (chain2->blocks[0] == 0))
+		return chain1->blocks[0] == 0 ? -1 : 1;
+	double const density1 = get_chain_density(chain1);
+	double const density2 = get_chain_density(chain2);
+	if (density1 != density2)
+		return density1 > density2 ? -1 : 1;
+	return QSORT_CMP(c1, c2);
+}
+
+static ir_node **create_exttsp_block_schedule(ir_graph *const irg)
+{
+	exttsp_env_t env = {
+		.blocks = NEW_ARR_F(layout_block_t, 0),
+		.jumps  = NEW_ARR_F(layout_jump_t, 0),
+		.chains = NEW_ARR_F(layout_chain_t, 0),
+	};
+	obstack_init(&env.obst);
+
+	collect_layout_blocks(&env, irg);
+	init_chains(&env);
+
+	size_t const n_chains = ARR_LEN(env.chains);
+	for (;;) {
+		chain_edge_t *best = NULL;
+		for (size_t c = 0; c < n_chains; ++c) {
+			layout_chain_t const *const chain = &env.chains[c];
+			if (chain->merged)
+				continue;
+			for (size_t i = 0, n = ARR_LEN(chain->edges); i < n; ++i) {
+				chain_edge_t *const edge = chain->edges[i];
+				if (edge->a != c)
+					continue;
+				if (!edge->valid)
+					compute_merge(&env, edge);
+				if (edge->merge.gain > EXTTSP_MIN_GAIN
+				 && (best == NULL || edge->merge.gain > best->merge.gain))
+					best = edge;
+			}
+		}
+		if (best == NULL)
+			break;
+		merge_chains(&env, best);
+	}
+
+	unsigned *chains = NEW_ARR_F(unsigned, 0);
+	for (size_t c = 0; c < n_chains; ++c) {
+		if (!env.chains[c].merged)
+			ARR_APP1(unsigned, chains, c);
+	}
+	sort_env = &env;
+	QSORT_ARR(chains, cmp_chains);
+	sort_env = NULL;
+
+	DB((dbg, LEVEL_1, "Blockschedule:\n"));
+	struct obstack *const obst       = be_get_be_obst(irg);
+	ir_node       **const block_list = NEW_ARR_D(ir_node*, obst, ARR_LEN(env.blocks));
+	size_t                i          = 0;
+	for (size_t c = 0, n = ARR_LEN(chains); c < n; ++c) {
+		layout_chain_t *const chain = &env.chains[chains[c]];
+		for (size_t b = 0, n_blocks = ARR_LEN(chain->blocks); b < n_blocks; ++b) {
+			block_list[i++] = env.blocks[chain->blocks[b]].block;
+			DB((dbg, LEVEL_1, "\t%+F\n", block_list[i - 1]));
+		}
+		for (size_t e = 0, n_edges = ARR_LEN(chain->edges); e < n_edges; ++e) {
+			chain_edge_t *const edge = chain->edges[e];
+			/* Free each edge only once. */
+			if (edge->a == chains[c])
+				DEL_ARR_F(edge->jumps);
+		}
+		DEL_ARR_F(chain->blocks);
+		DEL_ARR_F(chain->jumps);
+		DEL_ARR_F(chain->edges);
+	}
+	assert(i == ARR_LEN(env.blocks));
+
+	DEL_ARR_F(chains);
+	obstack_free(&env.obst, NULL);
+	DEL_ARR_F(env.chains);
+	DEL_ARR_F(env.jumps);
+	DEL_ARR_F(env.blocks);
+	return block_list;
+}
+
+/** Blocks executed less often than this per function call are cold. */
+#define COLD_BLOCK_FREQ 0.001
+
+/**
+ * Moves the rarely executed blocks to the end of @p block_list and marks the
+ * first of them to start the part of the function in a separate section.
+ */
+static void move_cold_blocks(ir_graph *const irg, ir_node **const block_list)
+{
+	be_irg_t *const birg = be_birg_from_irg(irg);
+	birg->cold_block = NULL;
+	if (!split_cold || !be_gas_can_split_function(get_irg_entity(irg)))
+		return;
+
+	double const threshold
+		= get_block_execfreq(get_irg_start_block(irg)) * COLD_BLOCK_FREQ;
+	ir_node    **cold  = NEW_ARR_F(ir_node*, 0);
+	size_t       n_hot = 0;
+	for (size_t i = 0, n = ARR_LEN(block_list); i < n; ++i) {
+		ir_node *const block = block_list[i];
+		if (i > 0 && get_block_execfreq(block) < threshold)
+			ARR_APP1(ir_node*, cold, block);
+		else
+			block_list[n_hot++] = block;
+	}
+	if (ARR_LEN(cold) > 0) {
+		MEMCPY(&block_list[n_hot], cold, ARR_LEN(cold));
+		birg->cold_block = block_list[n_hot];
+		DB((dbg, LEVEL_1, "Cold part starts at %+F\n", birg->cold_block));
+	}
+	DEL_ARR_F(cold);
+}
+
+/** Returns whether @p block is contained in @p loop. */
+static bool is_in_loop(ir_node const *const block, ir_loop const *const loop)
+{
+	unsigned const depth = get_loop_depth(loop);
+	ir_loop       *l     = get_irn_loop(block);
+	while (l != NULL && get_loop_depth(l) > depth) {
+		l = get_loop_outer_loop(l);
+	}
+	return l == loop;
+}
+
+bool be_should_align_loop_header(ir_node const *const block)
+{
+	if (loop_align_trip <= 0)
+		return false;
+	assert(irg_has_properties(get_irn_irg(block),
+	                          IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO));
+	ir_loop const *const loop = get_irn_loop(block);
+	if (loop == NULL || get_loop_depth(loop) == 0)
+		return false;
+
+	/* The ratio of the header frequency and the frequency of the entries
+	 * estimates the trip count. */
+	double entry_freq   = 0;
+	bool   has_backedge = false;
+	for (int i = 0, arity = get_Block_n_cfgpreds(block); i < arity; ++i) {
+		ir_node const *const pred = get_Block_cfgpred_block(block, i);
+		if (pred == NULL)
+			continue;
+		if (is_in_loop(pred, loop))
+			has_backedge = true;
+		else
+			entry_freq += get_jump_freq(pred, block);
+	}
+	return has_backedge && entry_freq > 0
+	    && get_block_execfreq(block) >= entry_freq * loop_align_trip;
+}
+
 ir_node **be_create_block_schedule(ir_graph *irg)
 {
 	blocksched_env_t env = {
@@ -549,11 +1171,22 @@ ir_node **be_create_block_schedule(ir_graph *irg)
 
 	remove_empty_blocks(irg);
 
-	coalesce_blocks(&env);
-
-	ir_node **const block_list = create_blocksched_array(&env);
+	ir_node **block_list;
+	if (algo == BLOCKSCHED_EXTTSP) {
+		block_list = create_exttsp_block_schedule(irg);
+	} else {
+		coalesce_blocks(&env);
+		block_list = create_blocksched_array(&env);
+	}
 	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
 
+	/* Removing empty blocks invalidates the loop information, which the
+	 * emitters query through be_should_align_loop_header(). */
+	if (loop_align_trip > 0)
+		assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+
+	move_cold_blocks(irg, block_list);
+
 	DEL_ARR_F(env.edges);
 	obstack_free(&env.obst, NULL);
 
@@ -563,5 +1196,9 @@ ir_node **be_create_block_schedule(ir_graph *irg)
 BE_REGISTER_MODULE_CONSTRUCTOR(be_init_blocksched)
 void be_init_blocksched(void)
 {
+	lc_opt_entry_t *be_grp         = lc_opt_get_grp(firm_opt_get_root(), "be");
+	lc_opt_entry_t *blocksched_grp = lc_opt_get_grp(be_grp, "blocksched");
+	lc_opt_add_table(blocksched_grp, be_blocksched_options);
+
 	FIRM_DBG_REGISTER(dbg, "firm.be.blocksched");
 }
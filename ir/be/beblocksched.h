@@ -13,7 +13,16 @@
 #define FIRM_BE_BEBLOCKSCHED_H
 
 #include "firm_types.h"
+#include <stdbool.h>
 
 ir_node **be_create_block_schedule(ir_graph *irg);
 
+/**
+ * Returns whether the loop header @p block should be aligned, because the
+ * loop is estimated to iterate often enough per entry. Controlled by the
+ * be.blocksched.loopalign option. Uses the loop information established by
+ * be_create_block_schedule().
+ */
+bool be_should_align_loop_header(ir_node const *block);
+
 #endif
@@ -0,0 +1,325 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   On-disk cache for the code emitted for a function.
+ *
+ * The cache maps the fingerprint of a graph (see ir_fingerprint_irg()) to
+ * the assembler text emitted for it. Block labels are numbered per
+ * compilation unit, so they are stored relative to the first label of the
+ * function and renumbered when the text is emitted again.
+ */
+#include "becache.h"
+
+#include "be.h"
+#include "be_t.h"
+#include "bedwarf.h"
+#include "beemitter.h"
+#include "begnuas.h"
+#include "hashptr.h"
+#include "irgwalk.h"
+#include "irio.h"
+#include "irprog_t.h"
+#include "obst.h"
+#include "target_t.h"
+#include "util.h"
+#include "xmalloc.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+/** Version of the cache file format. */
+#define CACHE_VERSION 1
+/** Marks a block label in a cache file, followed by its relative number. */
+#define LABEL_MARKER  '\1'
+
+static char *cache_directory;
+
+/** Types owning the global entities. */
+static ir_type *global_owners[IR_SEGMENT_LAST + 4];
+/** Number of members of the global owners when code generation started. */
+static size_t   n_unit_members[ARRAY_SIZE(global_owners)];
+
+static bool               recording;
+static unsigned long long recording_key;
+static unsigned           first_block_nr;
+static struct obstack     recorded;
+
+void be_set_compile_cache(char const *const directory)
+{
+	free(cache_directory);
+	cache_directory = directory != NULL ? xstrdup(directory) : NULL;
+}
+
+void be_cache_begin_compilation_unit(be_main_env_t const *const env)
+{
+	size_t n = 0;
+	for (ir_segment_t s = IR_SEGMENT_FIRST; s <= IR_SEGMENT_LAST; ++s) {
+		global_owners[n++] = get_segment_type(s);
+	}
+	global_owners[n++] = irp->dummy_owner;
+	global_owners[n++] = env->pic_trampolines_type;
+	global_owners[n++] = env->pic_symbols_type;
+	assert(n == ARRAY_SIZE(global_owners));
+
+	for (size_t i = 0; i < n; ++i) {
+		ir_type *const owner = global_owners[i];
+		n_unit_members[i] = owner != NULL ? get_compound_n_members(owner) : 0;
+	}
+}
+
+static void check_block_entity(ir_node *const block, void *const data)
+{
+	bool *const has_entity = (bool*)data;
+	if (get_Block_entity(block) != NULL)
+		*has_entity = true;
+}
+
+static bool can_cache(ir_graph *const irg)
+{
+	if (cache_directory == NULL || !ir_target.isa->cacheable_code
+	 || be_dwarf_enabled() || be_options.opt_profile_generate
+	 || be_options.opt_profile_use)
+		return false;
+
+	/* Label entities are numbered per program. */
+	bool has_entity = false;
+	irg_block_walk_graph(irg, check_block_entity, NULL, &has_entity);
+	return !has_entity;
+}
+
+static char *get_cache_path(unsigned long long const key,
+                            char const *const suffix)
+{
+	size_t const len  = strlen(cache_directory) + 32;
+	char  *const path = XMALLOCN(char, len);
+	snprintf(path, len, "%s/%016llx%s", cache_directory, key, suffix);
+	return path;
+}
+
+static bool is_symbol_char(char const c)
+{
+	return isalnum((unsigned char)c) || c == '_' || c == '.' || c == '$';
+}
+
+/** Returns whether the symbol @p prefix @p name appears in @p text. */
+static bool mentions_symbol(char const *const text, size_t const len,
+                            char const *const prefix, char const *const name)
+{
+	size_t const prefix_len = strlen(prefix);
+	size_t const name_len   = strlen(name);
+	size_t const symbol_len = prefix_len + name_len;
+	for (size_t i = 0; i + symbol_len <= len; ++i) {
+		if (i > 0 && is_symbol_char(text[i - 1]))
+			continue;
+		if (memcmp(text + i, prefix, prefix_len) != 0
+		 || memcmp(text + i + prefix_len, name, name_len) != 0)
+			continue;
+		if (i + symbol_len < len && is_symbol_char(text[i + symbol_len]))
+			continue;
+		return true;
+	}
+	return false;
+}
+
+/**
+ * Returns whether @p text refers to a global entity the backend created for
+ * this compilation unit, like a constant pool entry. Another compilation
+ * unit does not have it.
+ */
+static bool uses_unit_entities(char const *const text, size_t const len)
+{
+	char const *const private_prefix = be_gas_get_private_prefix();
+	for (size_t i = 0; i < ARRAY_SIZE(global_owners); ++i) {
+		ir_type *const owner = global_owners[i];
+		if (owner == NULL)
+			continue;
+		size_t const n = get_compound_n_members(owner);
+		if (n < n_unit_members[i])
+			return true;
+		for (size_t m = n_unit_members[i]; m < n; ++m) {
+			ir_entity  *const entity = get_compound_member(owner, m);
+			char const *const prefix
+				= get_entity_visibility(entity) == ir_visibility_private
+				? private_prefix : "";
+			if (mentions_symbol(text, len, prefix, get_entity_ld_name(entity)))
+				return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Appends @p text to @p out, replacing the block labels numbered from
+ * @p first to @p last (exclusive) by markers with the relative number.
+ */
+static void append_normalized(struct obstack *const out,
+                              char const *const text, size_t const len,
+                              unsigned const first, unsigned const last)
+{
+	char const *const prefix     = be_gas_get_private_prefix();
+	size_t      const prefix_len = strlen(prefix);
+	for (size_t i = 0; i < len;) {
+		if ((i == 0 || !is_symbol_char(text[i - 1]))
+		 && i + prefix_len < len
+		 && memcmp(text + i, prefix, prefix_len) == 0
+		 && isdigit((unsigned char)text[i + prefix_len])) {
+			unsigned long nr  = 0;
+			size_t        end = i + prefix_len;
+			for (; end < len && isdigit((unsigned char)text[end]); ++end) {
+				if (nr <= last)
+					nr = nr * 10 + (text[end] - '0');
+			}
+			if ((end == len || !is_symbol_char(text[end]))
+			 && first <= nr && nr < last) {
+				obstack_printf(out, "%c%lu", LABEL_MARKER, nr - first);
+				i = end;
+				continue;
+			}
+		}
+		obstack_1grow(out, text[i]);
+		++i;
+	}
+}
+
+/** Emits cached text, numbering its block labels from the next free one. */
+static void emit_cached(char const *const text, size_t const len)
+{
+	char const *const prefix = be_gas_get_private_prefix();
+	unsigned    const base   = be_gas_get_next_block_nr();
+	char const *const end    = text + len;
+	for (char const *c = text;;) {
+		char const *const marker = (char const*)memchr(c, LABEL_MARKER, end - c);
+		be_emit_string_len(c, (marker != NULL ? marker : end) - c);
+		if (marker == NULL)
+			break;
+
+		unsigned nr = 0;
+		for (c = marker + 1; c != end && isdigit((unsigned char)*c); ++c) {
+			nr = nr * 10 + (*c - '0');
+		}
+		be_emit_string(prefix);
+		be_emit_unsigned(base + nr);
+	}
+	be_emit_write_line();
+}
+
+static bool load_function(unsigned long long const key)
+{
+	char *const path = get_cache_path(key, ".s");
+	FILE *const file = fopen(path, "rb");
+	free(path);
+	if (file == NULL)
+		return false;
+
+	char          header[128];
+	unsigned      version;
+	unsigned      n_block_nrs;
+	unsigned long size;
+	unsigned      checksum;
+	bool ok = fgets(header, sizeof(header), file) != NULL
+	       && sscanf(header, "libfirm-cache %u %u %lu %u", &version,
+	                 &n_block_nrs, &size, &checksum) == 4
+	       && version == CACHE_VERSION;
+
+	struct obstack obst;
+	obstack_init(&obst);
+	if (ok) {
+		char buf[4096];
+		for (size_t n; (n = fread(buf, 1, sizeof(buf), file)) != 0;) {
+			obstack_grow(&obst, buf, n);
+		}
+		ok = !ferror(file);
+	}
+	fclose(file);
+
+	size_t const len  = obstack_object_size(&obst);
+	char  *const text = (char*)obstack_finish(&obst);
+	if (ok && len == size
+	 && hash_data((unsigned char const*)text, len) == checksum) {
+		emit_cached(text, len);
+		be_gas_skip_block_nrs(n_block_nrs);
+		/* The section after the cached code is not known. */
+		be_gas_forget_section();
+	} else {
+		ok = false;
+	}
+	obstack_free(&obst, NULL);
+	return ok;
+}
+
+/**
+ * Writes an entry to the cache. A temporary file is renamed, so readers never
+ * see a partial entry. Failing to write an entry is not an error.
+ */
+static void store_function(unsigned long long const key,
+                           char const *const text, size_t const len,
+                           unsigned const n_block_nrs)
+{
+	char *const tmp_path = get_cache_path(key, ".tmp");
+	FILE *const file     = fopen(tmp_path, "wb");
+	if (file != NULL) {
+		unsigned const checksum = hash_data((unsigned char const*)text, len);
+		fprintf(file, "libfirm-cache %u %u %lu %u\n", CACHE_VERSION,
+		        n_block_nrs, (unsigned long)len, checksum);
+		fwrite(text, 1, len, file);
+		bool ok = !ferror(file);
+		if (fclose(file) != 0)
+			ok = false;
+
+		char *const path = get_cache_path(key, ".s");
+		if (!ok || rename(tmp_path, path) != 0)
+			remove(tmp_path);
+		free(path);
+	}
+	free(tmp_path);
+}
+
+bool be_cache_begin_function(ir_graph *const irg)
+{
+	assert(!recording);
+	if (!can_cache(irg))
+		return false;
+
+	unsigned long long const key = ir_fingerprint_irg(irg);
+	if (key == 0)
+		return false;
+	if (load_function(key))
+		return true;
+
+	recording      = true;
+	recording_key  = key;
+	first_block_nr = be_gas_get_next_block_nr();
+	obstack_init(&recorded);
+	/* The recorded code has to switch to its section on its own. */
+	be_gas_forget_section();
+	be_emit_set_capture(&recorded);
+	return false;
+}
+
+void be_cache_end_function(void)
+{
+	if (!recording)
+		return;
+	recording = false;
+	be_emit_set_capture(NULL);
+
+	size_t const len  = obstack_object_size(&recorded);
+	char  *const text = (char*)obstack_finish(&recorded);
+	if (!uses_unit_entities(text, len)) {
+		unsigned const last_block_nr = be_gas_get_next_block_nr();
+		struct obstack normalized;
+		obstack_init(&normalized);
+		append_normalized(&normalized, text, len, first_block_nr,
+		                  last_block_nr);
+		size_t const normalized_len = obstack_object_size(&normalized);
+		char  *const normalized_text = (char*)obstack_finish(&normalized);
+		store_function(recording_key, normalized_text, normalized_len,
+		               last_block_nr - first_block_nr);
+		obstack_free(&normalized, NULL);
+	}
+	obstack_free(&recorded, NULL);
+}
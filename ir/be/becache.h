@@ -0,0 +1,34 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   On-disk cache for the code emitted for a function.
+ */
+#ifndef FIRM_BE_BECACHE_H
+#define FIRM_BE_BECACHE_H
+
+#include "be_types.h"
+#include "firm_types.h"
+#include <stdbool.h>
+
+/**
+ * Prepares the compile cache for a compilation unit. Entities the backend
+ * creates after this call are private to the compilation unit, code
+ * referencing them is not cached.
+ */
+void be_cache_begin_compilation_unit(be_main_env_t const *env);
+
+/**
+ * Looks up @p irg in the compile cache. On a hit the cached code is emitted
+ * and true is returned. Otherwise the code emitted until
+ * be_cache_end_function() is recorded, if it can be cached.
+ */
+bool be_cache_begin_function(ir_graph *irg);
+
+/** Stores the code recorded for the current function in the compile cache. */
+void be_cache_end_function(void);
+
+#endif
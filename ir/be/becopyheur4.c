@@ -23,7 +23,7 @@
 #include "irnode_t.h"
 #include "bitset.h"
 #include "raw_bitset.h"
-#include "irnodemap.h"
+#include "irnodetable.h"
 #include "pqueue.h"
 #include "xmalloc.h"
 #include "pdeq.h"
@@ -94,7 +94,7 @@ typedef struct aff_edge_t {
 /* main coalescing environment */
 typedef struct co_mst_env_t {
 	bitset_t const  *allocatable_regs; /**< set containing all global ignore registers */
-	ir_nodemap       map;              /**< phase object holding data for nodes */
+	ir_nodetable     map;              /**< co_mst_irn_t of the nodes */
 	struct obstack   obst;
 	pqueue_t        *chunks;           /**< priority queue for chunks */
 	list_head        chunklist;        /**< list holding all chunks */
@@ -126,7 +126,7 @@ typedef struct co_mst_irn_t {
  */
 static co_mst_irn_t *co_mst_irn_init(co_mst_env_t *env, const ir_node *irn)
 {
-	co_mst_irn_t *const res = OALLOC(&env->obst, co_mst_irn_t);
+	co_mst_irn_t *const res = ir_nodetable_insert(co_mst_irn_t, &env->map, irn);
 	res->irn           = irn;
 	res->chunk         = NULL;
 	res->fixed         = 0;
@@ -170,11 +170,9 @@ static co_mst_irn_t *co_mst_irn_init(co_mst_env_t *env, const ir_node *irn)
 
 static co_mst_irn_t *get_co_mst_irn(co_mst_env_t *env, const ir_node *node)
 {
-	co_mst_irn_t *res = ir_nodemap_get(co_mst_irn_t, &env->map, node);
-	if (res == NULL) {
+	co_mst_irn_t *res = ir_nodetable_get(co_mst_irn_t, &env->map, node);
+	if (res == NULL)
 		res = co_mst_irn_init(env, node);
-		ir_nodemap_insert(&env->map, node, res);
-	}
 	return res;
 }
 
@@ -641,8 +639,8 @@ static void build_affinity_chunks(co_mst_env_t *env)
 		pqueue_put(env->chunks, curr_chunk, curr_chunk->weight);
 	}
 
-	for (size_t pn = 0, n = ARR_LEN(env->map.data); pn < n; ++pn) {
-		co_mst_irn_t *mirn = (co_mst_irn_t*)env->map.data[pn];
+	for (unsigned pn = 0, n = get_irg_last_idx(env->co->irg); pn < n; ++pn) {
+		co_mst_irn_t *mirn = ir_nodetable_get_idx(co_mst_irn_t, &env->map, pn);
 		if (mirn == NULL)
 			continue;
 		if (mirn->chunk != NULL)
@@ -1241,7 +1239,7 @@ static int co_solve_heuristic_mst(copy_opt_t *co)
 
 	/* init phase */
 	co_mst_env_t mst_env;
-	ir_nodemap_init(&mst_env.map, co->irg);
+	ir_nodetable_init(&mst_env.map, co->irg, sizeof(co_mst_irn_t));
 	obstack_init(&mst_env.obst);
 
 	unsigned const n_regs = co->cls->n_regs;
@@ -1285,8 +1283,8 @@ static int co_solve_heuristic_mst(copy_opt_t *co)
 	}
 
 	/* apply coloring */
-	for (size_t pn = 0; pn < ARR_LEN(mst_env.map.data); ++pn) {
-		co_mst_irn_t *mirn = (co_mst_irn_t*)mst_env.map.data[pn];
+	for (unsigned pn = 0, n = get_irg_last_idx(co->irg); pn < n; ++pn) {
+		co_mst_irn_t *mirn = ir_nodetable_get_idx(co_mst_irn_t, &mst_env.map, pn);
 		if (mirn == NULL)
 			continue;
 		/* skip nodes where color hasn't changed */
@@ -1301,7 +1299,7 @@ static int co_solve_heuristic_mst(copy_opt_t *co)
 	/* free allocated memory */
 	del_pqueue(mst_env.chunks);
 	obstack_free(&mst_env.obst, NULL);
-	ir_nodemap_destroy(&mst_env.map);
+	ir_nodetable_destroy(&mst_env.map);
 
 	stat_ev_tim_pop("heur4_total");
 
@@ -935,6 +935,11 @@ void be_dwarf_close(void)
 	pset_new_destroy(&env.emitted_types);
 }
 
+bool be_dwarf_enabled(void)
+{
+	return debug_level > LEVEL_NONE;
+}
+
 /* Opens a dwarf handler */
 void be_dwarf_open(void)
 {
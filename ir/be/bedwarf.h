@@ -12,6 +12,7 @@
 #define FIRM_BE_BEDWARF_H
 
 #include "be_types.h"
+#include <stdbool.h>
 
 typedef struct parameter_dbg_info_t {
 	const ir_entity       *entity;
@@ -24,6 +25,9 @@ void be_dwarf_open(void);
 /** close a debug handler. */
 void be_dwarf_close(void);
 
+/** returns whether any debug information is emitted */
+bool be_dwarf_enabled(void);
+
 /** start a compilation unit */
 void be_dwarf_unit_begin(const char *filename);
 
@@ -0,0 +1,1058 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief       Writes ELF relocatable object files directly.
+ *
+ * The layout follows what GNU as produces for the output of begnuas.c:
+ * relocations against local symbols are expressed relative to the section
+ * symbol and PC relative references to local code in the same section are
+ * resolved right away.
+ */
+#include "beelf.h"
+
+#include "array.h"
+#include "begnuas.h"
+#include "bitfiddle.h"
+#include "entity_t.h"
+#include "irnode_t.h"
+#include "obst.h"
+#include "panic.h"
+#include "platform_t.h"
+#include "pmap.h"
+#include "target_t.h"
+#include "typerep.h"
+#include "util.h"
+#include <assert.h>
+#include <string.h>
+
+enum {
+	ELFCLASS32    = 1,
+	ELFCLASS64    = 2,
+	ELFDATA2LSB   = 1,
+	ELFDATA2MSB   = 2,
+	EV_CURRENT    = 1,
+	ET_REL        = 1,
+
+	SHN_UNDEF     = 0,
+	SHN_COMMON    = 0xFFF2,
+
+	SHT_PROGBITS  = 1,
+	SHT_SYMTAB    = 2,
+	SHT_STRTAB    = 3,
+	SHT_RELA      = 4,
+	SHT_NOBITS    = 8,
+	SHT_REL       = 9,
+
+	SHF_WRITE     = 0x1,
+	SHF_ALLOC     = 0x2,
+	SHF_EXECINSTR = 0x4,
+	SHF_INFO_LINK = 0x40,
+	SHF_TLS       = 0x400,
+
+	STB_LOCAL     = 0,
+	STB_GLOBAL    = 1,
+	STB_WEAK      = 2,
+
+	STT_NOTYPE    = 0,
+	STT_OBJECT    = 1,
+	STT_FUNC      = 2,
+	STT_SECTION   = 3,
+	STT_TLS       = 6,
+
+	STV_DEFAULT   = 0,
+	STV_HIDDEN    = 2,
+	STV_PROTECTED = 3,
+};
+
+typedef struct elf_section_t elf_section_t;
+
+typedef struct elf_reloc_t {
+	uint64_t         offset;  /**< offset in the section */
+	ir_entity const *entity;  /**< target entity, NULL for section relative */
+	elf_section_t   *target;  /**< target section if entity is NULL */
+	int64_t          addend;
+	uint32_t         type;
+	uint8_t          size;    /**< size of the relocated field in bytes */
+	unsigned         symbol;  /**< symbol table index after resolving */
+} elf_reloc_t;
+
+struct elf_section_t {
+	char const      *name;
+	uint32_t         type;      /**< SHT_* */
+	uint32_t         flags;     /**< SHF_* */
+	be_gas_section_t kind;
+	unsigned         alignment;
+	char            *data;      /**< contents, unused for SHT_NOBITS */
+	size_t           size;
+	size_t           capacity;
+	elf_reloc_t     *relocs;    /**< flexible array */
+	unsigned         index;     /**< section header index */
+	unsigned         rel_index; /**< header index of the relocation section */
+	unsigned         symbol;    /**< symbol table index of section symbol */
+};
+
+typedef struct elf_symbol_t {
+	ir_entity const *entity;
+	elf_section_t   *section; /**< NULL for undefined symbols */
+	uint64_t         value;
+	uint64_t         size;
+	uint8_t          type;    /**< STT_* */
+	bool             common;  /**< a common symbol, value is the alignment */
+	ir_entity const *alias;   /**< aliased entity for alias entities */
+	unsigned         index;   /**< symbol table index */
+} elf_symbol_t;
+
+typedef struct elf_sectioninfo_t {
+	char const *name;
+	uint32_t    type;
+	uint32_t    flags;
+} elf_sectioninfo_t;
+
+static elf_sectioninfo_t const elf_sectioninfos[] = {
+	[GAS_SECTION_TEXT]          = { ".text",              SHT_PROGBITS, SHF_ALLOC | SHF_EXECINSTR },
+	[GAS_SECTION_TEXT_HOT]      = { ".text.hot",          SHT_PROGBITS, SHF_ALLOC | SHF_EXECINSTR },
+	[GAS_SECTION_TEXT_UNLIKELY] = { ".text.unlikely",     SHT_PROGBITS, SHF_ALLOC | SHF_EXECINSTR },
+	[GAS_SECTION_DATA]          = { ".data",              SHT_PROGBITS, SHF_ALLOC | SHF_WRITE     },
+	[GAS_SECTION_RODATA]        = { ".rodata",            SHT_PROGBITS, SHF_ALLOC                 },
+	[GAS_SECTION_REL_RO_LOCAL]  = { ".data.rel.ro.local", SHT_PROGBITS, SHF_ALLOC | SHF_WRITE     },
+	[GAS_SECTION_REL_RO]        = { ".data.rel.ro",       SHT_PROGBITS, SHF_ALLOC | SHF_WRITE     },
+	[GAS_SECTION_BSS]           = { ".bss",               SHT_NOBITS,   SHF_ALLOC | SHF_WRITE     },
+	[GAS_SECTION_CONSTRUCTORS]  = { ".ctors",             SHT_PROGBITS, SHF_ALLOC | SHF_WRITE     },
+	[GAS_SECTION_DESTRUCTORS]   = { ".dtors",             SHT_PROGBITS, SHF_ALLOC | SHF_WRITE     },
+	[GAS_SECTION_JCR]           = { ".jcr",               SHT_PROGBITS, SHF_ALLOC | SHF_WRITE     },
+};
+
+static FILE                   *output;
+static be_elf_machine_t const *machine;
+static struct obstack          obst;
+static elf_section_t         **sections;
+static elf_symbol_t          **symbols;
+static pmap                   *entity_symbols;
+static elf_section_t          *current_section;
+
+static elf_section_t *get_section(be_gas_section_t const kind)
+{
+	for (size_t i = 0, n = ARR_LEN(sections); i < n; ++i) {
+		if (sections[i]->kind == kind)
+			return sections[i];
+	}
+
+	be_gas_section_t const base = kind & GAS_SECTION_TYPE_MASK;
+	if ((size_t)base >= ARRAY_SIZE(elf_sectioninfos)
+	 || elf_sectioninfos[base].name == NULL)
+		panic("section %u not supported by the ELF writer", (unsigned)base);
+	elf_sectioninfo_t const *const info = &elf_sectioninfos[base];
+
+	elf_section_t *const section = OALLOCZ(&obst, elf_section_t);
+	section->name      = info->name;
+	section->type      = info->type;
+	section->flags     = info->flags;
+	section->kind      = kind;
+	section->alignment = 1;
+	section->relocs    = NEW_ARR_F(elf_reloc_t, 0);
+	if (kind & GAS_SECTION_FLAG_TLS) {
+		switch (base) {
+		case GAS_SECTION_DATA: section->name = ".tdata"; break;
+		case GAS_SECTION_BSS:  section->name = ".tbss";  break;
+		default:
+			panic("thread local section %s not supported", info->name);
+		}
+		section->flags |= SHF_TLS;
+	}
+	ARR_APP1(elf_section_t*, sections, section);
+	return section;
+}
+
+/** Append @p size zero bytes to a section, returns a pointer to them. */
+static char *section_grow(elf_section_t *const section, size_t const size)
+{
+	size_t const begin = section->size;
+	section->size += size;
+	if (section->type == SHT_NOBITS)
+		return NULL;
+
+	if (section->size > section->capacity) {
+		section->capacity = MAX(section->size, 2 * section->capacity);
+		section->data     = XREALLOC(section->data, char, section->capacity);
+	}
+	char *const res = section->data + begin;
+	memset(res, 0, size);
+	return res;
+}
+
+static void section_align(elf_section_t *const section, unsigned const alignment)
+{
+	assert(is_po2_or_zero(alignment));
+	if (alignment <= 1)
+		return;
+	section->alignment = MAX(section->alignment, alignment);
+
+	size_t const aligned = round_up2(section->size, alignment);
+	size_t const padding = aligned - section->size;
+	char  *const fill    = section_grow(section, padding);
+	if (padding > 0 && (section->flags & SHF_EXECINSTR))
+		machine->nops(fill, padding);
+}
+
+static elf_symbol_t *get_symbol(ir_entity const *const entity)
+{
+	elf_symbol_t *symbol = pmap_get(elf_symbol_t, entity_symbols, entity);
+	if (symbol == NULL) {
+		if (get_entity_kind(entity) == IR_ENTITY_LABEL)
+			panic("references to labels (%+F) not supported by the ELF writer",
+			      entity);
+		symbol = OALLOCZ(&obst, elf_symbol_t);
+		symbol->entity = entity;
+		pmap_insert(entity_symbols, entity, symbol);
+		ARR_APP1(elf_symbol_t*, symbols, symbol);
+	}
+	return symbol;
+}
+
+static void define_symbol(ir_entity const *const entity,
+                          elf_section_t *const section, uint64_t const size,
+                          uint8_t const type)
+{
+	elf_symbol_t *const symbol = get_symbol(entity);
+	if (symbol->section != NULL || symbol->common)
+		panic("%+F defined twice", entity);
+	symbol->section = section;
+	symbol->value   = section->size;
+	symbol->size    = size;
+	symbol->type    = section->flags & SHF_TLS ? STT_TLS : type;
+}
+
+static void add_relocation(elf_section_t *const section, uint64_t const offset,
+                           unsigned const size, uint32_t const type,
+                           ir_entity const *const entity,
+                           elf_section_t *const target, int64_t const addend)
+{
+	if (entity != NULL)
+		(void)get_symbol(entity);
+
+	elf_reloc_t const reloc = {
+		.offset = offset,
+		.entity = entity,
+		.target = target,
+		.addend = addend,
+		.type   = type,
+		.size   = size,
+	};
+	ARR_APP1(elf_reloc_t, section->relocs, reloc);
+}
+
+/** Write @p size bytes of @p value in target byte order. */
+static void write_value(char *const dst, unsigned const size,
+                        uint64_t const value)
+{
+	bool const big_endian = ir_target_big_endian();
+	for (unsigned i = 0; i < size; ++i) {
+		uint8_t const byte = i < 8 ? (uint8_t)(value >> (8 * i)) : 0;
+		dst[big_endian ? size - 1 - i : i] = byte;
+	}
+}
+
+static void write_tarval(char *const dst, unsigned const size,
+                         ir_tarval *const tv)
+{
+	bool     const big_endian = ir_target_big_endian();
+	unsigned const tv_size    = get_mode_size_bytes(get_tarval_mode(tv));
+	for (unsigned i = 0, n = MIN(size, tv_size); i < n; ++i) {
+		dst[big_endian ? size - 1 - i : i] = get_tarval_sub_bits(tv, i);
+	}
+}
+
+unsigned be_elf_relocation(char *const buffer, unsigned const size,
+                           uint32_t const type, ir_entity const *const entity,
+                           int64_t const addend)
+{
+	elf_section_t *const section = current_section;
+	assert(section != NULL);
+	assert(section->data <= buffer
+	       && buffer + size <= section->data + section->size);
+	add_relocation(section, buffer - section->data, size, type, entity, NULL,
+	               addend);
+	memset(buffer, 0, size);
+	return size;
+}
+
+void be_elf_begin(FILE *const file, be_elf_machine_t const *const mach)
+{
+	if (ir_platform.object_format != OBJECT_FORMAT_ELF)
+		panic("object file writer requires an ELF target");
+	if (ir_platform.pic_style != BE_PIC_NONE)
+		panic("position independent code not supported by the ELF writer");
+	if (get_irp_n_asms() > 0)
+		panic("global assembler not supported by the ELF writer");
+
+	output  = file;
+	machine = mach;
+	obstack_init(&obst);
+	sections       = NEW_ARR_F(elf_section_t*, 0);
+	symbols        = NEW_ARR_F(elf_symbol_t*, 0);
+	entity_symbols = pmap_create();
+
+	/* The text section comes first like in assembler output. */
+	(void)get_section(GAS_SECTION_TEXT);
+}
+
+static void emit_jump_tables(ir_jit_function_t const *const function,
+                             elf_section_t *const text, uint64_t const begin)
+{
+	unsigned const pointer_size = ir_target_pointer_size();
+	for (be_jit_jump_table_t const *table = be_jit_get_jump_tables(function);
+	     table != NULL; table = table->next) {
+		elf_section_t *const rodata = get_section(GAS_SECTION_RODATA);
+		section_align(rodata, pointer_size);
+		define_symbol(table->entity, rodata, table->n_entries * pointer_size,
+		              STT_OBJECT);
+		for (unsigned i = 0, n = table->n_entries; i < n; ++i) {
+			unsigned const address
+				= be_jit_get_fragment_address(function, table->fragment_nums[i]);
+			uint64_t const offset = rodata->size;
+			(void)section_grow(rodata, pointer_size);
+			add_relocation(rodata, offset, pointer_size, machine->reloc_abs, NULL,
+			               text, begin + address);
+		}
+	}
+}
+
+void be_elf_emit_function(ir_entity const *const entity, unsigned const p2align,
+                          ir_jit_function_t *const function,
+                          emit_relocation_func const relocation)
+{
+	be_gas_section_t const kind = be_gas_determine_section(NULL, entity);
+	elf_section_t   *const text = get_section(kind & ~GAS_SECTION_FLAG_COMDAT);
+	section_align(text, 1u << p2align);
+
+	unsigned const size  = be_get_function_size(function);
+	uint64_t const begin = text->size;
+	define_symbol(entity, text, size, STT_FUNC);
+	char *const buffer = section_grow(text, size);
+
+	be_jit_emit_interface_t const emitter = {
+		.nops       = machine->nops,
+		.relocation = relocation,
+	};
+	current_section = text;
+	be_jit_emit_memory(buffer, function, &emitter);
+	current_section = NULL;
+
+	emit_jump_tables(function, text, begin);
+}
+
+/**
+ * Evaluate an initializer expression to an optional entity plus an offset.
+ */
+static int64_t eval_init_expression(ir_node *const init,
+                                    ir_entity const **const entity)
+{
+	switch (get_irn_opcode(init)) {
+	case iro_Conv:
+		return eval_init_expression(get_Conv_op(init), entity);
+
+	case iro_Const: {
+		ir_tarval *const tv = get_Const_tarval(init);
+		if (!tarval_is_long(tv))
+			panic("unsupported constant %+F in initializer", init);
+		return get_tarval_long(tv);
+	}
+
+	case iro_Address:
+		if (*entity != NULL)
+			panic("initializer %+F references multiple entities", init);
+		*entity = get_Address_entity(init);
+		return 0;
+
+	case iro_Offset:
+		return get_entity_offset(get_Offset_entity(init));
+
+	case iro_Align:
+		return get_type_alignment(get_Align_type(init));
+
+	case iro_Size:
+		return get_type_size(get_Size_type(init));
+
+	case iro_Add:
+		return eval_init_expression(get_Add_left(init), entity)
+		     + eval_init_expression(get_Add_right(init), entity);
+
+	case iro_Sub: {
+		int64_t          const left  = eval_init_expression(get_Sub_left(init), entity);
+		ir_entity const *      other = NULL;
+		int64_t          const right = eval_init_expression(get_Sub_right(init), &other);
+		if (other != NULL)
+			panic("symbol difference %+F not supported by the ELF writer", init);
+		return left - right;
+	}
+
+	case iro_Mul: {
+		ir_entity const *left_entity  = NULL;
+		ir_entity const *right_entity = NULL;
+		int64_t const left  = eval_init_expression(get_Mul_left(init), &left_entity);
+		int64_t const right = eval_init_expression(get_Mul_right(init), &right_entity);
+		if (left_entity != NULL || right_entity != NULL)
+			panic("constant must be int for '*' to work");
+		return left * right;
+	}
+
+	case iro_Unknown:
+		return 0;
+
+	default:
+		panic("unsupported IR-node %+F", init);
+	}
+}
+
+static void emit_node_data(elf_section_t *const section, size_t const offset,
+                           ir_node *const init, ir_type *const type)
+{
+	unsigned const size = get_type_size(type);
+	if (is_Const(init)) {
+		write_tarval(section->data + offset, size, get_Const_tarval(init));
+		return;
+	}
+
+	ir_entity const *entity = NULL;
+	int64_t    const value  = eval_init_expression(init, &entity);
+	if (entity == NULL) {
+		write_value(section->data + offset, size, value);
+	} else {
+		if (size != ir_target_pointer_size())
+			panic("relocation of size %u in initializer", size);
+		add_relocation(section, offset, size, machine->reloc_abs, entity, NULL,
+		               value);
+	}
+}
+
+static void emit_bitfield(char *const dst, unsigned const offset_bits,
+                          unsigned const bitfield_size,
+                          ir_initializer_t const *const initializer,
+                          ir_type *const type)
+{
+	ir_tarval *tv = NULL;
+	switch (get_initializer_kind(initializer)) {
+	case IR_INITIALIZER_NULL:
+		return;
+	case IR_INITIALIZER_TARVAL:
+		tv = get_initializer_tarval_value(initializer);
+		break;
+	case IR_INITIALIZER_CONST: {
+		ir_node *const node = get_initializer_const_value(initializer);
+		if (!is_Const(node))
+			panic("bitfield initializer not a Const node");
+		tv = get_Const_tarval(node);
+		break;
+	}
+	case IR_INITIALIZER_COMPOUND:
+		panic("bitfield initializer is compound");
+	case IR_INITIALIZER_BYTES:
+		panic("bitfield initializer is a memory image");
+	}
+	if (!tv || tv == tarval_bad)
+		panic("couldn't get numeric value for bitfield initializer");
+
+	unsigned const value_len  = get_type_size(type);
+	bool     const big_endian = ir_target_big_endian();
+	for (unsigned bit_offset = 0; bit_offset < bitfield_size;) {
+		unsigned const src_offset      = bit_offset / 8;
+		unsigned const src_offset_bits = bit_offset % 8;
+		unsigned const dst_offset      = (bit_offset + offset_bits) / 8;
+		unsigned const dst_offset_bits = (bit_offset + offset_bits) % 8;
+		unsigned const dst_bits_len    = 8 - dst_offset_bits;
+		unsigned const src_bits_len
+			= MIN(dst_bits_len, bitfield_size - bit_offset);
+
+		unsigned curr_bits = get_tarval_sub_bits(tv, src_offset) >> src_offset_bits;
+		if (src_offset_bits + src_bits_len > 8)
+			curr_bits |= get_tarval_sub_bits(tv, src_offset + 1) << (8 - src_offset_bits);
+		curr_bits &= (1u << src_bits_len) - 1;
+
+		char *const val = big_endian ? &dst[value_len - dst_offset - 1]
+		                             : &dst[dst_offset];
+		*val |= curr_bits << dst_offset_bits;
+
+		bit_offset += dst_bits_len;
+	}
+}
+
+static void emit_ir_initializer(elf_section_t *const section,
+                                size_t const offset,
+                                ir_initializer_t const *const initializer,
+                                ir_type *const type)
+{
+	switch (get_initializer_kind(initializer)) {
+	case IR_INITIALIZER_NULL:
+		return;
+
+	case IR_INITIALIZER_TARVAL:
+		write_tarval(section->data + offset, get_type_size(type),
+		             get_initializer_tarval_value(initializer));
+		return;
+
+	case IR_INITIALIZER_CONST:
+		emit_node_data(section, offset,
+		               get_initializer_const_value(initializer), type);
+		return;
+
+	case IR_INITIALIZER_BYTES:
+		memcpy(section->data + offset, get_initializer_bytes_data(initializer),
+		       get_initializer_bytes_size(initializer));
+		return;
+
+	case IR_INITIALIZER_COMPOUND:
+		if (is_Array_type(type)) {
+			ir_type *const element_type = get_array_element_type(type);
+			size_t         skip         = get_type_size(element_type);
+			size_t   const alignment    = get_type_alignment(element_type);
+			size_t   const misalign     = skip % alignment;
+			if (misalign != 0)
+				skip += alignment - misalign;
+
+			for (size_t i = 0, n = get_initializer_compound_n_entries(initializer);
+			     i < n; ++i) {
+				ir_initializer_t const *const sub_initializer
+					= get_initializer_compound_value(initializer, i);
+				emit_ir_initializer(section, offset + i * skip, sub_initializer,
+				                    element_type);
+			}
+		} else {
+			assert(is_compound_type(type));
+			for (size_t i = 0, n_members = get_compound_n_members(type);
+			     i < n_members; ++i) {
+				ir_entity *const member        = get_compound_member(type, i);
+				size_t     const member_offset = offset + get_entity_offset(member);
+
+				assert(i < get_initializer_compound_n_entries(initializer));
+				ir_initializer_t const *const sub_initializer
+					= get_initializer_compound_value(initializer, i);
+
+				ir_type *const subtype       = get_entity_type(member);
+				unsigned const bitfield_size = get_entity_bitfield_size(member);
+				if (bitfield_size > 0) {
+					emit_bitfield(section->data + member_offset,
+					              get_entity_bitfield_offset(member),
+					              bitfield_size, sub_initializer, subtype);
+					continue;
+				}
+
+				emit_ir_initializer(section, member_offset, sub_initializer,
+				                    subtype);
+			}
+		}
+		return;
+	}
+	panic("invalid ir_initializer kind found");
+}
+
+static void emit_common(ir_entity const *const entity, unsigned long const size)
+{
+	elf_symbol_t *const symbol = get_symbol(entity);
+	symbol->common = true;
+	symbol->value  = be_gas_get_entity_alignment(entity);
+	symbol->size   = size;
+	symbol->type   = STT_OBJECT;
+}
+
+/**
+ * Place a global entity, see emit_global() in begnuas.c.
+ */
+static void emit_global(ir_entity const *const entity)
+{
+	/* Block labels are part of the code and functions have been placed by
+	 * be_elf_emit_function(). */
+	ir_entity_kind const kind = get_entity_kind(entity);
+	if (kind == IR_ENTITY_LABEL || kind == IR_ENTITY_METHOD)
+		return;
+
+	be_gas_section_t const section = be_gas_determine_section(NULL, entity);
+
+	ir_visibility const visibility       = get_entity_visibility(entity);
+	ir_linkage    const linkage          = get_entity_linkage(entity);
+	bool          const zero_initializer = be_gas_entity_is_zero_initialized(entity);
+	unsigned long       size             = be_gas_compute_entity_size(entity);
+	if (size == 0)
+		size = 1;
+
+	if ((linkage & IR_LINKAGE_MERGE || zero_initializer)
+	  && !(section & GAS_SECTION_FLAG_TLS)) {
+		switch (visibility) {
+		case ir_visibility_external:
+		case ir_visibility_external_private:
+		case ir_visibility_external_protected:
+			if (linkage & IR_LINKAGE_MERGE) {
+				emit_common(entity, size);
+				return;
+			}
+			break;
+		case ir_visibility_local:
+		case ir_visibility_private:
+			if (!(linkage & IR_LINKAGE_CONSTANT)) {
+				/* local commons are allocated in the bss section */
+				elf_section_t *const bss = get_section(GAS_SECTION_BSS);
+				section_align(bss, be_gas_get_entity_alignment(entity));
+				define_symbol(entity, bss, size, STT_OBJECT);
+				(void)section_grow(bss, size);
+				return;
+			}
+			break;
+		}
+	}
+
+	if (!entity_has_definition(entity))
+		return;
+
+	if (kind == IR_ENTITY_ALIAS) {
+		get_symbol(entity)->alias = get_entity_alias(entity);
+		return;
+	}
+
+	elf_section_t *const elf_section
+		= get_section(section & ~GAS_SECTION_FLAG_COMDAT);
+	unsigned const alignment = be_gas_get_entity_alignment(entity);
+	if (!is_po2_or_zero(alignment))
+		panic("alignment not a power of 2");
+	section_align(elf_section, alignment);
+
+	size_t const offset = elf_section->size;
+	define_symbol(entity, elf_section, get_type_size(get_entity_type(entity)),
+	              STT_OBJECT);
+	(void)section_grow(elf_section, size);
+	if (!zero_initializer) {
+		if (elf_section->type == SHT_NOBITS)
+			panic("initialized entity %+F in nobits section", entity);
+		emit_ir_initializer(elf_section, offset, get_entity_initializer(entity),
+		                    get_entity_type(entity));
+	}
+}
+
+static void emit_globals(ir_type *const gt)
+{
+	for (size_t i = 0, n = get_compound_n_members(gt); i < n; i++) {
+		ir_entity *const ent = get_compound_member(gt, i);
+		if (!(get_entity_linkage(ent) & IR_LINKAGE_NO_CODEGEN))
+			emit_global(ent);
+	}
+}
+
+static uint8_t get_symbol_binding(ir_entity const *const entity)
+{
+	switch (get_entity_visibility(entity)) {
+	case ir_visibility_local:
+	case ir_visibility_private:
+		return STB_LOCAL;
+	case ir_visibility_external:
+	case ir_visibility_external_private:
+	case ir_visibility_external_protected: {
+		ir_linkage const linkage = get_entity_linkage(entity);
+		if (linkage & IR_LINKAGE_WEAK)
+			return STB_WEAK;
+		/* there are no section groups, so COMDAT definitions become weak */
+		if ((linkage & IR_LINKAGE_MERGE)
+		 && (linkage & IR_LINKAGE_GARBAGE_COLLECT)
+		 && entity_has_definition(entity))
+			return STB_WEAK;
+		return STB_GLOBAL;
+	}
+	}
+	panic("invalid visibility");
+}
+
+static uint8_t get_symbol_visibility(ir_entity const *const entity)
+{
+	switch (get_entity_visibility(entity)) {
+	case ir_visibility_external_private:   return STV_HIDDEN;
+	case ir_visibility_external_protected: return STV_PROTECTED;
+	default:                               return STV_DEFAULT;
+	}
+}
+
+static void resolve_aliases(void)
+{
+	for (size_t i = 0, n = ARR_LEN(symbols); i < n; ++i) {
+		elf_symbol_t *const symbol = symbols[i];
+		elf_symbol_t const *target = symbol;
+		for (unsigned depth = 0; target->alias != NULL; ++depth) {
+			if (depth > ARR_LEN(symbols))
+				panic("alias cycle at %+F", symbol->entity);
+			target = get_symbol(target->alias);
+		}
+		if (target == symbol)
+			continue;
+		if (target->section == NULL)
+			panic("alias %+F to undefined entity", symbol->entity);
+		symbol->section = target->section;
+		symbol->value   = target->value;
+		symbol->size    = target->size;
+		symbol->type    = target->type;
+	}
+}
+
+/** Symbols of private entities are not written, like .L labels in as. */
+static bool is_written_symbol(elf_symbol_t const *const symbol)
+{
+	return get_entity_visibility(symbol->entity) != ir_visibility_private;
+}
+
+static bool is_local_definition(elf_symbol_t const *const symbol)
+{
+	return symbol->section != NULL
+	    && get_symbol_binding(symbol->entity) == STB_LOCAL;
+}
+
+static void resolve_relocations(elf_section_t *const section)
+{
+	size_t n_kept = 0;
+	for (size_t i = 0, n = ARR_LEN(section->relocs); i < n; ++i) {
+		elf_reloc_t reloc = section->relocs[i];
+
+		elf_section_t *target = reloc.target;
+		if (reloc.entity != NULL) {
+			elf_symbol_t const *const symbol = get_symbol(reloc.entity);
+			if (is_local_definition(symbol)) {
+				target        = symbol->section;
+				reloc.addend += symbol->value;
+			} else if (!is_written_symbol(symbol)) {
+				panic("private entity %+F referenced but not defined",
+				      reloc.entity);
+			} else {
+				target       = NULL;
+				reloc.symbol = symbol->index;
+			}
+		}
+		if (target != NULL) {
+			if (target == section && reloc.type == machine->reloc_pcrel) {
+				/* PC relative reference into the same section */
+				write_value(section->data + reloc.offset, reloc.size,
+				            reloc.addend - (int64_t)reloc.offset);
+				continue;
+			}
+			reloc.symbol = target->symbol;
+		}
+
+		write_value(section->data + reloc.offset, reloc.size,
+		            machine->use_rela ? 0 : reloc.addend);
+		section->relocs[n_kept++] = reloc;
+	}
+	ARR_SETLEN(elf_reloc_t, section->relocs, n_kept);
+}
+
+static struct obstack out;
+
+static void put8(uint8_t const value)
+{
+	obstack_1grow(&out, value);
+}
+
+static void put_value(uint64_t const value, unsigned const size)
+{
+	char buf[8];
+	write_value(buf, size, value);
+	obstack_grow(&out, buf, size);
+}
+
+static void put16(uint16_t const value)
+{
+	put_value(value, 2);
+}
+
+static void put32(uint32_t const value)
+{
+	put_value(value, 4);
+}
+
+/** Put an address sized value (Elf32_Addr/Elf64_Addr, ...). */
+static void put_word(uint64_t const value)
+{
+	put_value(value, machine->is_64bit ? 8 : 4);
+}
+
+static void put_padding(unsigned const alignment)
+{
+	size_t const size = obstack_object_size(&out);
+	for (size_t i = size, n = round_up2(size, alignment); i < n; ++i)
+		put8(0);
+}
+
+static uint32_t add_string(struct obstack *const strtab, char const *const str)
+{
+	uint32_t const offset = obstack_object_size(strtab);
+	obstack_grow(strtab, str, strlen(str) + 1);
+	return offset;
+}
+
+typedef struct elf_shdr_t {
+	uint32_t name;
+	uint32_t type;
+	uint64_t flags;
+	uint64_t offset;
+	uint64_t size;
+	uint32_t link;
+	uint32_t info;
+	uint64_t alignment;
+	uint64_t entsize;
+} elf_shdr_t;
+
+static void put_shdr(elf_shdr_t const *const shdr)
+{
+	put32(shdr->name);
+	put32(shdr->type);
+	put_word(shdr->flags);
+	put_word(0); /* address */
+	put_word(shdr->offset);
+	put_word(shdr->size);
+	put32(shdr->link);
+	put32(shdr->info);
+	put_word(shdr->alignment);
+	put_word(shdr->entsize);
+}
+
+static void put_symbol(uint32_t const name, uint64_t const value,
+                       uint64_t const size, uint8_t const info,
+                       uint8_t const other, uint16_t const shndx)
+{
+	if (machine->is_64bit) {
+		put32(name);
+		put8(info);
+		put8(other);
+		put16(shndx);
+		put_word(value);
+		put_word(size);
+	} else {
+		put32(name);
+		put_word(value);
+		put_word(size);
+		put8(info);
+		put8(other);
+		put16(shndx);
+	}
+}
+
+static void put_reloc(elf_reloc_t const *const reloc)
+{
+	put_word(reloc->offset);
+	if (machine->is_64bit) {
+		put_value((uint64_t)reloc->symbol << 32 | reloc->type, 8);
+	} else {
+		put32(reloc->symbol << 8 | (reloc->type & 0xFF));
+	}
+	if (machine->use_rela)
+		put_word(reloc->addend);
+}
+
+static void write_object(void)
+{
+	size_t const n_sections = ARR_LEN(sections);
+
+	/* section header indices: content sections, relocations, tables */
+	unsigned n_shdrs = 1;
+	for (size_t i = 0; i < n_sections; ++i)
+		sections[i]->index = n_shdrs++;
+	for (size_t i = 0; i < n_sections; ++i) {
+		if (ARR_LEN(sections[i]->relocs) > 0)
+			sections[i]->rel_index = n_shdrs++;
+	}
+	unsigned const symtab_index   = n_shdrs++;
+	unsigned const strtab_index   = n_shdrs++;
+	unsigned const shstrtab_index = n_shdrs++;
+
+	/* symbol table: section symbols and locals first, then globals */
+	struct obstack strtab;
+	obstack_init(&strtab);
+	obstack_1grow(&strtab, '\0');
+	unsigned n_symbols = 1;
+	for (size_t i = 0; i < n_sections; ++i)
+		sections[i]->symbol = n_symbols++;
+	for (size_t i = 0, n = ARR_LEN(symbols); i < n; ++i) {
+		elf_symbol_t *const symbol = symbols[i];
+		if (is_written_symbol(symbol)
+		 && get_symbol_binding(symbol->entity) == STB_LOCAL)
+			symbol->index = n_symbols++;
+	}
+	unsigned const first_global = n_symbols;
+	for (size_t i = 0, n = ARR_LEN(symbols); i < n; ++i) {
+		elf_symbol_t *const symbol = symbols[i];
+		if (is_written_symbol(symbol)
+		 && get_symbol_binding(symbol->entity) != STB_LOCAL)
+			symbol->index = n_symbols++;
+	}
+
+	for (size_t i = 0; i < n_sections; ++i)
+		resolve_relocations(sections[i]);
+
+	obstack_init(&out);
+	unsigned const ehdr_size = machine->is_64bit ? 64 : 52;
+	unsigned const shdr_size = machine->is_64bit ? 64 : 40;
+	unsigned const sym_size  = machine->is_64bit ? 24 : 16;
+	unsigned const rel_size  = machine->is_64bit ? (machine->use_rela ? 24 : 16)
+	                                             : (machine->use_rela ? 12 : 8);
+	unsigned const word_size = machine->is_64bit ? 8 : 4;
+	obstack_blank(&out, ehdr_size);
+
+	elf_shdr_t *const shdrs = XMALLOCNZ(elf_shdr_t, n_shdrs);
+	struct obstack shstrtab;
+	obstack_init(&shstrtab);
+	obstack_1grow(&shstrtab, '\0');
+
+	for (size_t i = 0; i < n_sections; ++i) {
+		elf_section_t const *const section = sections[i];
+		elf_shdr_t          *const shdr    = &shdrs[section->index];
+		put_padding(section->alignment);
+		shdr->name      = add_string(&shstrtab, section->name);
+		shdr->type      = section->type;
+		shdr->flags     = section->flags;
+		shdr->offset    = obstack_object_size(&out);
+		shdr->size      = section->size;
+		shdr->alignment = section->alignment;
+		if (section->type != SHT_NOBITS)
+			obstack_grow(&out, section->data, section->size);
+	}
+
+	for (size_t i = 0; i < n_sections; ++i) {
+		elf_section_t const *const section = sections[i];
+		size_t               const n       = ARR_LEN(section->relocs);
+		if (n == 0)
+			continue;
+		elf_shdr_t *const shdr = &shdrs[section->rel_index];
+		shdr->name = obstack_object_size(&shstrtab);
+		obstack_printf(&shstrtab, "%s%s", machine->use_rela ? ".rela" : ".rel",
+		               section->name);
+		obstack_1grow(&shstrtab, '\0');
+		put_padding(word_size);
+		shdr->type      = machine->use_rela ? SHT_RELA : SHT_REL;
+		shdr->flags     = SHF_INFO_LINK;
+		shdr->offset    = obstack_object_size(&out);
+		shdr->size      = n * rel_size;
+		shdr->link      = symtab_index;
+		shdr->info      = section->index;
+		shdr->alignment = word_size;
+		shdr->entsize   = rel_size;
+		for (size_t r = 0; r < n; ++r)
+			put_reloc(&section->relocs[r]);
+	}
+
+	put_padding(word_size);
+	elf_shdr_t *const symtab_shdr = &shdrs[symtab_index];
+	symtab_shdr->name      = add_string(&shstrtab, ".symtab");
+	symtab_shdr->type      = SHT_SYMTAB;
+	symtab_shdr->offset    = obstack_object_size(&out);
+	symtab_shdr->size      = n_symbols * sym_size;
+	symtab_shdr->link      = strtab_index;
+	symtab_shdr->info      = first_global;
+	symtab_shdr->alignment = word_size;
+	symtab_shdr->entsize   = sym_size;
+	put_symbol(0, 0, 0, 0, 0, SHN_UNDEF);
+	for (size_t i = 0; i < n_sections; ++i) {
+		put_symbol(0, 0, 0, STB_LOCAL << 4 | STT_SECTION, STV_DEFAULT,
+		           sections[i]->index);
+	}
+	for (int pass = 0; pass < 2; ++pass) {
+		bool const want_local = pass == 0;
+		for (size_t i = 0, n = ARR_LEN(symbols); i < n; ++i) {
+			elf_symbol_t const *const symbol = symbols[i];
+			if (!is_written_symbol(symbol))
+				continue;
+			ir_entity const *const entity  = symbol->entity;
+			uint8_t          const binding = get_symbol_binding(entity);
+			if ((binding == STB_LOCAL) != want_local)
+				continue;
+			uint32_t const name
+				= add_string(&strtab, get_entity_ld_name(entity));
+			uint16_t const shndx
+				= symbol->common        ? SHN_COMMON
+				: symbol->section != NULL ? symbol->section->index
+				:                         SHN_UNDEF;
+			uint8_t const type
+				= symbol->section != NULL || symbol->common ? symbol->type
+				: get_entity_owner(entity) == get_tls_type() ? STT_TLS
+				:                                              STT_NOTYPE;
+			put_symbol(name, symbol->value, symbol->size, binding << 4 | type,
+			           get_symbol_visibility(entity), shndx);
+		}
+	}
+
+	elf_shdr_t *const strtab_shdr = &shdrs[strtab_index];
+	size_t      const strtab_size = obstack_object_size(&strtab);
+	strtab_shdr->name      = add_string(&shstrtab, ".strtab");
+	strtab_shdr->type      = SHT_STRTAB;
+	strtab_shdr->offset    = obstack_object_size(&out);
+	strtab_shdr->size      = strtab_size;
+	strtab_shdr->alignment = 1;
+	obstack_grow(&out, obstack_finish(&strtab), strtab_size);
+
+	elf_shdr_t *const shstrtab_shdr = &shdrs[shstrtab_index];
+	shstrtab_shdr->name = add_string(&shstrtab, ".shstrtab");
+	size_t const shstrtab_size = obstack_object_size(&shstrtab);
+	shstrtab_shdr->type      = SHT_STRTAB;
+	shstrtab_shdr->offset    = obstack_object_size(&out);
+	shstrtab_shdr->size      = shstrtab_size;
+	shstrtab_shdr->alignment = 1;
+	obstack_grow(&out, obstack_finish(&shstrtab), shstrtab_size);
+
+	put_padding(word_size);
+	uint64_t const shoff = obstack_object_size(&out);
+	for (unsigned i = 0; i < n_shdrs; ++i)
+		put_shdr(&shdrs[i]);
+
+	size_t const file_size = obstack_object_size(&out);
+	char  *const file      = obstack_finish(&out);
+
+	/* now that all offsets are known write the ELF header */
+	obstack_grow(&out, "\x7F" "ELF", 4);
+	put8(machine->is_64bit ? ELFCLASS64 : ELFCLASS32);
+	put8(ir_target_big_endian() ? ELFDATA2MSB : ELFDATA2LSB);
+	put8(EV_CURRENT);
+	for (unsigned i = 7; i < 16; ++i)
+		put8(0);
+	put16(ET_REL);
+	put16(machine->machine);
+	put32(EV_CURRENT);
+	put_word(0); /* entry */
+	put_word(0); /* program header offset */
+	put_word(shoff);
+	put32(machine->flags);
+	put16(ehdr_size);
+	put16(0); /* program header entry size */
+	put16(0); /* number of program headers */
+	put16(shdr_size);
+	put16(n_shdrs);
+	put16(shstrtab_index);
+	assert(obstack_object_size(&out) == ehdr_size);
+	memcpy(file, obstack_finish(&out), ehdr_size);
+
+	fwrite(file, 1, file_size, output);
+
+	free(shdrs);
+	obstack_free(&shstrtab, NULL);
+	obstack_free(&strtab, NULL);
+	obstack_free(&out, NULL);
+}
+
+void be_elf_finish(void)
+{
+	/* PIC symbols and trampolines do not exist as be_elf_begin() rejects
+	 * position independent code. */
+	emit_globals(get_glob_type());
+	emit_globals(get_tls_type());
+	emit_globals(get_segment_type(IR_SEGMENT_CONSTRUCTORS));
+	emit_globals(get_segment_type(IR_SEGMENT_DESTRUCTORS));
+	emit_globals(get_segment_type(IR_SEGMENT_JCR));
+
+	resolve_aliases();
+	write_object();
+
+	for (size_t i = 0, n = ARR_LEN(sections); i < n; ++i) {
+		free(sections[i]->data);
+		DEL_ARR_F(sections[i]->relocs);
+	}
+	DEL_ARR_F(sections);
+	DEL_ARR_F(symbols);
+	pmap_destroy(entity_symbols);
+	obstack_free(&obst, NULL);
+	output  = NULL;
+	machine = NULL;
+}
@@ -0,0 +1,64 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief       Writes ELF relocatable object files directly.
+ *
+ * Instead of printing assembler text, backends with a binary encoder (see
+ * bejit.h) can hand their encoded functions to this writer. Global variables
+ * are laid out from their initializers, the result is written as an ELF
+ * relocatable object with symbol table and relocations.
+ */
+#ifndef FIRM_BE_BEELF_H
+#define FIRM_BE_BEELF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "bejit.h"
+#include "firm_types.h"
+
+/** Describes the target machine to the ELF writer. */
+typedef struct be_elf_machine_t {
+	uint16_t machine;     /**< e_machine value */
+	uint32_t flags;       /**< e_flags value */
+	bool     is_64bit;    /**< write ELFCLASS64 instead of ELFCLASS32 */
+	bool     use_rela;    /**< relocations carry explicit addends */
+	uint32_t reloc_abs;   /**< relocation type for pointer sized data */
+	uint32_t reloc_pcrel; /**< relocation type for 32bit PC relative code */
+	/** fill @p size bytes of code padding */
+	void (*nops)(char *buffer, unsigned size);
+} be_elf_machine_t;
+
+/**
+ * Start writing an object file to @p output.
+ */
+void be_elf_begin(FILE *output, be_elf_machine_t const *machine);
+
+/**
+ * Place the code of @p function for @p entity into the text section.
+ * Relocations are resolved by calling @p relocation, which should call
+ * be_elf_relocation() for relocations against entities.
+ */
+void be_elf_emit_function(ir_entity const *entity, unsigned p2align,
+                          ir_jit_function_t *function,
+                          emit_relocation_func relocation);
+
+/**
+ * Record a relocation of type @p type for the @p size bytes at @p buffer,
+ * which must point into the function currently emitted by
+ * be_elf_emit_function(). Returns @p size.
+ */
+unsigned be_elf_relocation(char *buffer, unsigned size, uint32_t type,
+                           ir_entity const *entity, int64_t addend);
+
+/**
+ * Lay out all global variables and write the object file.
+ */
+void be_elf_finish(void);
+
+#endif
@@ -15,6 +15,7 @@
 #include "bedwarf.h"
 #include "beemitter.h"
 #include "begnuas.h"
+#include "beirg.h"
 #include "benode.h"
 #include "dbginfo.h"
 #include "debug.h"
@@ -69,6 +70,10 @@ void be_emit_init_cf_links(ir_node **const block_schedule)
 	ir_node *prev = NULL;
 	for (size_t i = 0, n = ARR_LEN(block_schedule); i < n; ++i) {
 		ir_node *const block = block_schedule[i];
+		/* The cold part is placed in another section, so there is no
+		 * fallthrough into it. */
+		if (block == be_birg_from_irg(get_irn_irg(block))->cold_block)
+			prev = NULL;
 
 		/* Initialize cfop link */
 		for (unsigned n = get_Block_n_cfgpreds(block); n-- > 0; ) {
@@ -14,8 +14,9 @@
 #include "irprintf.h"
 #include "panic.h"
 
-static FILE    *emit_file;
-struct obstack  emit_obst;
+static FILE           *emit_file;
+static struct obstack *capture_obst;
+struct obstack         emit_obst;
 
 void be_emit_init(FILE *file)
 {
@@ -25,6 +26,7 @@ void be_emit_init(FILE *file)
 
 void be_emit_exit(void)
 {
+	capture_obst = NULL;
 	obstack_free(&emit_obst, NULL);
 }
 
@@ -41,10 +43,64 @@ void be_emit_irprintf(const char *fmt, ...)
 	va_end(ap);
 }
 
+/* The following are used for the numbers in instructions, which are too
+ * frequent to go through the format string parsing of be_emit_irprintf(). */
+
+void be_emit_unsigned(uint64_t value)
+{
+	char        buf[20];
+	char *const end = buf + sizeof(buf);
+	char       *p   = end;
+	do {
+		*--p   = '0' + value % 10;
+		value /= 10;
+	} while (value != 0);
+	be_emit_string_len(p, end - p);
+}
+
+void be_emit_signed(int64_t const value)
+{
+	if (value < 0) {
+		be_emit_char('-');
+		be_emit_unsigned(-(uint64_t)value);
+	} else {
+		be_emit_unsigned(value);
+	}
+}
+
+void be_emit_offset(int64_t const value)
+{
+	if (value >= 0)
+		be_emit_char('+');
+	be_emit_signed(value);
+}
+
+void be_emit_hex(uint64_t value)
+{
+	static char const digits[] = "0123456789ABCDEF";
+
+	char        buf[16];
+	char *const end = buf + sizeof(buf);
+	char       *p   = end;
+	do {
+		*--p    = digits[value & 0xF];
+		value >>= 4;
+	} while (value != 0);
+	be_emit_string_len(p, end - p);
+}
+
 void be_emit_write_line(void)
 {
 	size_t const len  = obstack_object_size(&emit_obst);
 	char  *const line = (char*)obstack_finish(&emit_obst);
-	fwrite(line, 1, len, emit_file);
+	if (emit_file != NULL)
+		fwrite(line, 1, len, emit_file);
+	if (capture_obst != NULL)
+		obstack_grow(capture_obst, line, len);
 	obstack_free(&emit_obst, line);
 }
+
+void be_emit_set_capture(struct obstack *const obst)
+{
+	capture_obst = obst;
+}
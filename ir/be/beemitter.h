@@ -15,6 +15,7 @@
 #ifndef FIRM_BE_BEEMITTER_H
 #define FIRM_BE_BEEMITTER_H
 
+#include <stdint.h>
 #include <stdio.h>
 #include "obst.h"
 
@@ -59,10 +60,34 @@ static inline void be_emit_string(const char *str)
 #define be_emit_cstring(str) \
 	be_emit_string_len(str, sizeof(str) - 1)
 
+/**
+ * Emit an unsigned number in decimal, like "%" PRIu64 would.
+ */
+void be_emit_unsigned(uint64_t value);
+
+/**
+ * Emit a signed number in decimal, like "%" PRId64 would.
+ */
+void be_emit_signed(int64_t value);
+
+/**
+ * Emit a signed number in decimal with an explicit sign, like "%+" PRId64
+ * would. This is the usual format for offsets added to a symbol.
+ */
+void be_emit_offset(int64_t value);
+
+/**
+ * Emit an unsigned number in upper case hexadecimal without prefix, like
+ * "%" PRIX64 would.
+ */
+void be_emit_hex(uint64_t value);
+
 /**
  * Initializes an emitter environment.
  *
- * @param F    a file handle where the emitted file is written to.
+ * @param F    a file handle where the emitted file is written to. May be
+ *             NULL to discard the assembler text, which is done when an
+ *             object file is written directly.
  */
 void be_emit_init(FILE *F);
 
@@ -90,6 +115,12 @@ void be_emit_irvprintf(const char *fmt, va_list args);
  */
 void be_emit_write_line(void);
 
+/**
+ * Makes be_emit_write_line() additionally append the written lines to
+ * @p obst. NULL stops this again.
+ */
+void be_emit_set_capture(struct obstack *obst);
+
 /** Return column in current line. Counting starts at 0. */
 static inline size_t be_emit_get_column(void)
 {
@@ -0,0 +1,468 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Ordering and section placement of the functions of a program.
+ *
+ * The C3 algorithm (call-chain clustering) places callers and their callees
+ * next to each other, so hot code shares pages and iTLB entries: Functions
+ * are visited in order of decreasing weight. Each one is appended to the
+ * cluster of its most frequent caller, unless the merged cluster gets larger
+ * than a page or much less dense. Finally the clusters are sorted by density,
+ * the estimated execution time per byte.
+ *
+ * The call frequencies are computed from the block execution frequencies of
+ * the direct calls in the callers. Indirect calls are not resolved, as the
+ * call graph analysis would change the graphs this late in the backend. With
+ * profile data these are scaled by the number of calls of the callers,
+ * otherwise each function is assumed to be called once plus the number of its
+ * calls from other functions.
+ */
+#include "befuncorder.h"
+
+#include "array.h"
+#include "be_t.h"
+#include "bediagnostic.h"
+#include "bemodule.h"
+#include "debug.h"
+#include "entity_t.h"
+#include "execfreq.h"
+#include "irgwalk.h"
+#include "irprofile.h"
+#include "irprog_t.h"
+#include "irtools.h"
+#include "lc_opts.h"
+#include "lc_opts_enum.h"
+#include "platform_t.h"
+#include "pmap.h"
+#include "util.h"
+#include <stdio.h>
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
+
+/** Estimated size of an instruction in bytes. */
+#define FUNC_INSN_SIZE         4
+/** Clusters are not merged beyond the size of a page. */
+#define MAX_CLUSTER_SIZE       4096
+/** Calls less frequent relative to all calls of the callee are ignored. */
+#define MIN_CALL_PROBABILITY   0.1
+/** Merging must not decrease the density of the caller cluster more. */
+#define MAX_DENSITY_DEGRADATION 8.0
+/** Fraction of the total weight covered by the hot functions. */
+#define HOT_WEIGHT_FRACTION    0.9
+
+typedef enum funcorder_algo_t {
+	FUNCORDER_SOURCE,
+	FUNCORDER_C3,
+} funcorder_algo_t;
+
+static int  algo = FUNCORDER_SOURCE;
+static bool hot_cold_sections;
+static char order_file[1024];
+
+static const lc_opt_enum_int_items_t algo_items[] = {
+	{ "source", FUNCORDER_SOURCE },
+	{ "c3",     FUNCORDER_C3 },
+	{ NULL,     0 }
+};
+
+static lc_opt_enum_int_var_t algo_var = {
+	&algo, algo_items
+};
+
+static const lc_opt_table_entry_t be_funcorder_options[] = {
+	LC_OPT_ENT_ENUM_INT("algo",     "function ordering algorithm", &algo_var),
+	LC_OPT_ENT_BOOL    ("hotcold",  "place functions into .text.hot and .text.unlikely using profile data", &hot_cold_sections),
+	LC_OPT_ENT_STR     ("file",     "write the function symbols in layout order to this file", &order_file),
+	LC_OPT_LAST
+};
+
+/** Maps function entities to the sections they are placed in, NULL before
+ * the functions are ordered. */
+static pmap *function_sections;
+
+typedef struct call_edge_t {
+	unsigned callee;
+	double   freq;    /**< execution frequency of the calls in the caller */
+} call_edge_t;
+
+typedef struct func_node_t {
+	ir_graph    *irg;
+	call_edge_t *callees; /**< direct calls of other functions */
+	double       calls;   /**< number of calls */
+	double       weight;  /**< estimated execution time */
+	unsigned     size;    /**< estimated size in bytes */
+	unsigned     cluster;
+	int          caller;  /**< the most frequent caller or -1 */
+	double       caller_calls;
+} func_node_t;
+
+typedef struct call_env_t {
+	pmap        *indices;
+	func_node_t *funcs;
+	size_t       caller;
+} call_env_t;
+
+typedef struct func_cluster_t {
+	unsigned *funcs;
+	double    weight;
+	unsigned  size;
+} func_cluster_t;
+
+typedef struct size_weight_t {
+	unsigned n_insns;
+	double   freq;
+} size_weight_t;
+
+static void count_insns(ir_node *const node, void *const data)
+{
+	if (is_Block(node) || is_Proj(node) || is_Phi(node))
+		return;
+	size_weight_t *const sw = (size_weight_t*)data;
+	++sw->n_insns;
+	sw->freq += get_block_execfreq(get_nodes_block(node));
+}
+
+static void collect_call(ir_node *const node, void *const data)
+{
+	if (!is_Call(node))
+		return;
+	ir_entity *const callee_entity = get_Call_callee(node);
+	if (callee_entity == NULL)
+		return;
+	ir_graph *const callee_irg = get_entity_linktime_irg(callee_entity);
+	if (callee_irg == NULL)
+		return;
+	call_env_t *const env    = (call_env_t*)data;
+	size_t      const callee = (size_t)pmap_get(void, env->indices, callee_irg);
+	if (callee == 0 || callee - 1 == env->caller)
+		return;
+
+	double        const freq    = get_block_execfreq(get_nodes_block(node));
+	call_edge_t **const callees = &env->funcs[env->caller].callees;
+	for (size_t c = 0, n = ARR_LEN(*callees); c < n; ++c) {
+		if ((*callees)[c].callee == callee - 1) {
+			(*callees)[c].freq += freq;
+			return;
+		}
+	}
+	call_edge_t const edge = { .callee = callee - 1, .freq = freq };
+	ARR_APP1(call_edge_t, *callees, edge);
+}
+
+static func_node_t *sort_funcs;
+
+static int cmp_func_weight(const void *d1, const void *d2)
+{
+	unsigned const f1 = *(unsigned const*)d1;
+	unsigned const f2 = *(unsigned const*)d2;
+	double   const w1 = sort_funcs[f1].weight;
+	double   const w2 = sort_funcs[f2].weight;
+	if (w1 != w2)
+		return w1 > w2 ? -1 : 1;
+	return QSORT_CMP(f1, f2);
+}
+
+static func_cluster_t *sort_clusters;
+
+static double get_cluster_density(func_cluster_t const *const cluster)
+{
+	return cluster->weight / cluster->size;
+}
+
+static int cmp_cluster_density(const void *d1, const void *d2)
+{
+	unsigned const c1 = *(unsigned const*)d1;
+	unsigned const c2 = *(unsigned const*)d2;
+	double   const density1 = get_cluster_density(&sort_clusters[c1]);
+	double   const density2 = get_cluster_density(&sort_clusters[c2]);
+	if (density1 != density2)
+		return density1 > density2 ? -1 : 1;
+	return QSORT_CMP(sort_clusters[c1].funcs[0], sort_clusters[c2].funcs[0]);
+}
+
+/**
+ * Collects the functions to generate code for with their number of calls,
+ * weight and size. Determines the most frequent caller of each function.
+ */
+static func_node_t *collect_funcs(pmap *const indices, bool const have_profile)
+{
+	func_node_t *funcs = NEW_ARR_F(func_node_t, 0);
+	foreach_irp_irg(i, irg) {
+		if (get_entity_linkage(get_irg_entity(irg)) & IR_LINKAGE_NO_CODEGEN)
+			continue;
+		double const calls = have_profile
+			? ir_profile_get_block_execcount(get_irg_start_block(irg)) : 1.0;
+		func_node_t const func = {
+			.irg     = irg,
+			.calls   = calls,
+			.cluster = ARR_LEN(funcs),
+			.caller  = -1,
+		};
+		pmap_insert(indices, irg, (void*)(ARR_LEN(funcs) + 1));
+		ARR_APP1(func_node_t, funcs, func);
+	}
+
+	call_env_t env = { .indices = indices, .funcs = funcs };
+	for (size_t f = 0, n = ARR_LEN(funcs); f < n; ++f) {
+		funcs[f].callees = NEW_ARR_F(call_edge_t, 0);
+		env.caller       = f;
+		irg_walk_graph(funcs[f].irg, collect_call, NULL, &env);
+	}
+
+	/* Without profile data count the calls from other functions. */
+	if (!have_profile) {
+		for (size_t f = 0, n = ARR_LEN(funcs); f < n; ++f) {
+			call_edge_t const *const callees = funcs[f].callees;
+			for (size_t c = 0, n_callees = ARR_LEN(callees); c < n_callees; ++c) {
+				funcs[callees[c].callee].calls += callees[c].freq;
+			}
+		}
+	}
+
+	for (size_t f = 0, n = ARR_LEN(funcs); f < n; ++f) {
+		func_node_t *const func = &funcs[f];
+		ir_graph    *const irg  = func->irg;
+		size_weight_t sw = { .n_insns = 0, .freq = 0 };
+		irg_walk_graph(irg, count_insns, NULL, &sw);
+		func->size   = MAX(sw.n_insns, 1) * FUNC_INSN_SIZE;
+		func->weight = func->calls * sw.freq;
+
+		for (size_t c = 0, n_callees = ARR_LEN(func->callees); c < n_callees; ++c) {
+			call_edge_t const *const edge        = &func->callees[c];
+			func_node_t       *const callee_func = &funcs[edge->callee];
+			double             const calls       = func->calls * edge->freq;
+			if (calls > callee_func->caller_calls) {
+				callee_func->caller       = f;
+				callee_func->caller_calls = calls;
+			}
+		}
+	}
+	return funcs;
+}
+
+/** Clusters the functions with the C3 algorithm. Returns the new order. */
+static unsigned *cluster_funcs(func_node_t *const funcs)
+{
+	size_t    const n_funcs  = ARR_LEN(funcs);
+	func_cluster_t *clusters = NEW_ARR_F(func_cluster_t, n_funcs);
+	unsigned       *order    = NEW_ARR_F(unsigned, n_funcs);
+	for (size_t f = 0; f < n_funcs; ++f) {
+		clusters[f] = (func_cluster_t) {
+			.funcs  = NEW_ARR_F(unsigned, 1),
+			.weight = funcs[f].weight,
+			.size   = funcs[f].size,
+		};
+		clusters[f].funcs[0] = f;
+		order[f] = f;
+	}
+
+	sort_funcs = funcs;
+	QSORT_ARR(order, cmp_func_weight);
+	sort_funcs = NULL;
+
+	for (size_t i = 0; i < n_funcs; ++i) {
+		func_node_t const *const func = &funcs[order[i]];
+		if (func->weight <= 0)
+			break;
+		if (func->caller < 0
+		 || func->caller_calls < MIN_CALL_PROBABILITY * func->calls)
+			continue;
+
+		unsigned        const into_idx = funcs[func->caller].cluster;
+		func_cluster_t *const into     = &clusters[into_idx];
+		func_cluster_t *const from     = &clusters[func->cluster];
+		if (into == from || into->size + from->size > MAX_CLUSTER_SIZE)
+			continue;
+		double const merged_density
+			= (into->weight + from->weight) / (into->size + from->size);
+		if (get_cluster_density(into) > merged_density * MAX_DENSITY_DEGRADATION)
+			continue;
+
+		DB((dbg, LEVEL_2, "append cluster of %+F to cluster of %+F\n",
+		    func->irg, funcs[func->caller].irg));
+		for (size_t f = 0, n = ARR_LEN(from->funcs); f < n; ++f) {
+			unsigned const moved = from->funcs[f];
+			funcs[moved].cluster = into_idx;
+			ARR_APP1(unsigned, into->funcs, moved);
+		}
+		into->weight += from->weight;
+		into->size   += from->size;
+		ARR_SETLEN(unsigned, from->funcs, 0);
+	}
+
+	unsigned *cluster_order = NEW_ARR_F(unsigned, 0);
+	for (size_t c = 0; c < n_funcs; ++c) {
+		if (ARR_LEN(clusters[c].funcs) > 0)
+			ARR_APP1(unsigned, cluster_order, c);
+	}
+	sort_clusters = clusters;
+	QSORT_ARR(cluster_order, cmp_cluster_density);
+	sort_clusters = NULL;
+
+	size_t n = 0;
+	for (size_t c = 0, n_clusters = ARR_LEN(cluster_order); c < n_clusters; ++c) {
+		func_cluster_t *const cluster = &clusters[cluster_order[c]];
+		for (size_t f = 0, n_cfuncs = ARR_LEN(cluster->funcs); f < n_cfuncs; ++f) {
+			order[n++] = cluster->funcs[f];
+		}
+	}
+	assert(n == n_funcs);
+
+	for (size_t c = 0; c < n_funcs; ++c) {
+		DEL_ARR_F(clusters[c].funcs);
+	}
+	DEL_ARR_F(cluster_order);
+	DEL_ARR_F(clusters);
+	return order;
+}
+
+/**
+ * Places the functions executing the largest part of the time into the hot
+ * section and the functions never executed into the section for rarely
+ * executed code.
+ */
+static void place_funcs(func_node_t const *const funcs,
+                        unsigned const *const order)
+{
+	size_t const n_funcs = ARR_LEN(funcs);
+	double       total   = 0;
+	for (size_t f = 0; f < n_funcs; ++f) {
+		total += funcs[f].weight;
+	}
+
+	unsigned *by_weight = NEW_ARR_F(unsigned, n_funcs);
+	MEMCPY(by_weight, order, n_funcs);
+	sort_funcs = (func_node_t*)funcs;
+	QSORT_ARR(by_weight, cmp_func_weight);
+	sort_funcs = NULL;
+
+	double hot = 0;
+	for (size_t i = 0; i < n_funcs; ++i) {
+		func_node_t const *const func   = &funcs[by_weight[i]];
+		ir_entity         *const entity = get_irg_entity(func->irg);
+		be_gas_section_t section;
+		if (func->calls == 0) {
+			section = GAS_SECTION_TEXT_UNLIKELY;
+		} else if (hot < total * HOT_WEIGHT_FRACTION) {
+			section = GAS_SECTION_TEXT_HOT;
+			hot    += func->weight;
+		} else {
+			continue;
+		}
+		DB((dbg, LEVEL_1, "place %+F into section %u\n", entity, (unsigned)section));
+		pmap_insert(function_sections, entity, (void*)(size_t)section);
+	}
+	DEL_ARR_F(by_weight);
+}
+
+static void write_order_file(void)
+{
+	FILE *const file = fopen(order_file, "w");
+	if (file == NULL) {
+		be_warningf(NULL, "could not open function order file '%s'", order_file);
+		return;
+	}
+	char const prefix = ir_platform.user_label_prefix;
+	foreach_irp_irg(i, irg) {
+		ir_entity *const entity = get_irg_entity(irg);
+		/* Private functions have no symbol. */
+		if (get_entity_linkage(entity) & IR_LINKAGE_NO_CODEGEN
+		 || get_entity_visibility(entity) == ir_visibility_private)
+			continue;
+		if (prefix != '\0')
+			fputc(prefix, file);
+		fprintf(file, "%s\n", get_entity_ld_name(entity));
+	}
+	if (fclose(file) != 0)
+		be_warningf(NULL, "could not write function order file '%s'", order_file);
+}
+
+void be_order_functions(bool const have_profile)
+{
+	be_free_function_order();
+	function_sections = pmap_create();
+
+	bool const place = hot_cold_sections && have_profile
+	                && ir_platform.object_format == OBJECT_FORMAT_ELF;
+	if (algo == FUNCORDER_SOURCE && !place) {
+		if (order_file[0] != '\0')
+			write_order_file();
+		return;
+	}
+
+	pmap        *const indices = pmap_create();
+	func_node_t *const funcs   = collect_funcs(indices, have_profile);
+	size_t       const n_funcs = ARR_LEN(funcs);
+
+	unsigned *order;
+	if (algo == FUNCORDER_C3) {
+		order = cluster_funcs(funcs);
+	} else {
+		order = NEW_ARR_F(unsigned, n_funcs);
+		for (size_t f = 0; f < n_funcs; ++f) {
+			order[f] = f;
+		}
+	}
+
+	if (place)
+		place_funcs(funcs, order);
+
+	/* Functions without code generation keep their relative order at the
+	 * end. */
+	ir_graph **rest = NEW_ARR_F(ir_graph*, 0);
+	foreach_irp_irg(i, irg) {
+		if (!pmap_contains(indices, irg))
+			ARR_APP1(ir_graph*, rest, irg);
+	}
+	size_t n = 0;
+	for (size_t f = 0; f < n_funcs; ++f) {
+		func_node_t const *const func = &funcs[order[f]];
+		DB((dbg, LEVEL_1, "%+F (weight %.3g, size %u)\n", func->irg,
+		    func->weight, func->size));
+		set_irp_irg(n++, func->irg);
+	}
+	for (size_t i = 0, n_rest = ARR_LEN(rest); i < n_rest; ++i) {
+		set_irp_irg(n++, rest[i]);
+	}
+	assert(n == get_irp_n_irgs());
+	DEL_ARR_F(rest);
+
+	DEL_ARR_F(order);
+	for (size_t f = 0; f < n_funcs; ++f) {
+		DEL_ARR_F(funcs[f].callees);
+	}
+	DEL_ARR_F(funcs);
+	pmap_destroy(indices);
+
+	if (order_file[0] != '\0')
+		write_order_file();
+}
+
+be_gas_section_t be_get_function_section(ir_entity const *const entity)
+{
+	void *const section = function_sections != NULL
+	                    ? pmap_get(void, function_sections, entity) : NULL;
+	return section != NULL ? (be_gas_section_t)(size_t)section : GAS_SECTION_TEXT;
+}
+
+void be_free_function_order(void)
+{
+	if (function_sections != NULL) {
+		pmap_destroy(function_sections);
+		function_sections = NULL;
+	}
+}
+
+BE_REGISTER_MODULE_CONSTRUCTOR(be_init_funcorder)
+void be_init_funcorder(void)
+{
+	lc_opt_entry_t *be_grp        = lc_opt_get_grp(firm_opt_get_root(), "be");
+	lc_opt_entry_t *funcorder_grp = lc_opt_get_grp(be_grp, "funcorder");
+	lc_opt_add_table(funcorder_grp, be_funcorder_options);
+
+	FIRM_DBG_REGISTER(dbg, "firm.be.funcorder");
+}
@@ -0,0 +1,37 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Ordering and section placement of the functions of a program.
+ */
+#ifndef FIRM_BE_BEFUNCORDER_H
+#define FIRM_BE_BEFUNCORDER_H
+
+#include "begnuas.h"
+#include "firm_types.h"
+#include <stdbool.h>
+
+/**
+ * Reorders the graphs of the program, so code is generated for them in the
+ * layout chosen by the be.funcorder options, and decides which functions go
+ * into the hot and the unlikely text sections. Optionally writes the function
+ * symbols in layout order to a file for the linker.
+ *
+ * Expects the execution frequencies of all graphs. If @p have_profile is set,
+ * the profile must still be loaded to get the number of calls.
+ */
+void be_order_functions(bool have_profile);
+
+/**
+ * Returns the text section the function @p entity is placed in, without
+ * the comdat flag.
+ */
+be_gas_section_t be_get_function_section(ir_entity const *entity);
+
+/** Frees the section placement of the functions after code generation. */
+void be_free_function_order(void);
+
+#endif
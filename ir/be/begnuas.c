@@ -15,6 +15,8 @@
 #include "bearch.h"
 #include "beemithlp.h"
 #include "beemitter.h"
+#include "befuncorder.h"
+#include "beirg.h"
 #include "bemodule.h"
 #include "betranshlp.h"
 #include "dbginfo.h"
@@ -38,6 +40,11 @@ char                   be_gas_elf_type_char = '@';
 static be_gas_section_t current_section = (be_gas_section_t) -1;
 static pmap            *block_numbers;
 static unsigned         next_block_nr;
+/** Whether the cold part of the current function is being emitted. */
+static bool             in_cold_part;
+/** The section of the code being emitted and the entity selecting it. */
+static be_gas_section_t code_section;
+static ir_entity const *code_entity;
 
 static bool is_macho(void)
 {
@@ -124,6 +131,8 @@ typedef struct {
 
 static const elf_sectioninfo_t elf_sectioninfos[] = {
 	[GAS_SECTION_TEXT]           = { "text",              "progbits", "ax" },
+	[GAS_SECTION_TEXT_HOT]       = { "text.hot",          "progbits", "ax" },
+	[GAS_SECTION_TEXT_UNLIKELY]  = { "text.unlikely",     "progbits", "ax" },
 	[GAS_SECTION_DATA]           = { "data",              "progbits", "aw" },
 	[GAS_SECTION_RODATA]         = { "rodata",            "progbits", "a"  },
 	[GAS_SECTION_REL_RO_LOCAL]   = { "data.rel.ro.local", "progbits", "aw" },
@@ -260,6 +269,11 @@ static void emit_section(be_gas_section_t const section, ir_entity const *const
 	}
 }
 
+void be_gas_forget_section(void)
+{
+	current_section = (be_gas_section_t) -1;
+}
+
 void be_gas_emit_switch_section(be_gas_section_t section)
 {
 	/* you have to produce a switch_section call with entity manually
@@ -344,6 +358,14 @@ static bool initializer_is_null(const ir_initializer_t *initializer)
 		}
 		return true;
 	}
+	case IR_INITIALIZER_BYTES: {
+		unsigned char const *const data = initializer->bytes.data;
+		for (size_t i = 0, n = initializer->bytes.size; i < n; ++i) {
+			if (data[i] != 0)
+				return false;
+		}
+		return true;
+	}
 	}
 	panic("invalid initializer in initializer_is_null");
 }
@@ -379,7 +401,7 @@ static bool entity_is_string_const(const ir_entity *ent, bool only_suffix_null)
 	return initializer_is_string_const(init, only_suffix_null);
 }
 
-static bool entity_is_zero_initialized(ir_entity const *entity)
+bool be_gas_entity_is_zero_initialized(ir_entity const *entity)
 {
 	if (is_alias_entity(entity))
 		return false;
@@ -434,6 +456,7 @@ static reloc_class_t classify_initializer_relocs(
 	switch (get_initializer_kind(init)) {
 	case IR_INITIALIZER_NULL:
 	case IR_INITIALIZER_TARVAL:
+	case IR_INITIALIZER_BYTES:
 		return NO_RELOCATIONS;
 	case IR_INITIALIZER_CONST:
 		return classify_expr_relocs(get_initializer_const_value(init));
@@ -475,13 +498,13 @@ static be_gas_section_t determine_basic_section(const ir_entity *entity)
 			return GAS_SECTION_RODATA;
 		}
 	}
-	if (entity_is_zero_initialized(entity))
+	if (be_gas_entity_is_zero_initialized(entity))
 		return GAS_SECTION_BSS;
 
 	return GAS_SECTION_DATA;
 }
 
-static be_gas_section_t determine_section(be_main_env_t const *const main_env, ir_entity const *const entity)
+be_gas_section_t be_gas_determine_section(be_main_env_t const *const main_env, ir_entity const *const entity)
 {
 	ir_type *owner = get_entity_owner(entity);
 
@@ -489,6 +512,8 @@ static be_gas_section_t determine_section(be_main_env_t const *const main_env, i
 		be_gas_section_t section = determine_basic_section(entity);
 		if (is_comdat(entity))
 			section |= GAS_SECTION_FLAG_COMDAT;
+		else if (section == GAS_SECTION_TEXT && is_method_entity(entity))
+			section = be_get_function_section(entity);
 		return section;
 	} else if (main_env && owner == main_env->pic_symbols_type) {
 		return GAS_SECTION_PIC_SYMBOLS;
@@ -597,8 +622,10 @@ void be_gas_emit_function_prolog(const ir_entity *entity, unsigned po2alignment,
 {
 	be_dwarf_function_before(entity, parameter_infos);
 
-	be_gas_section_t const section = determine_section(NULL, entity);
+	be_gas_section_t const section = be_gas_determine_section(NULL, entity);
 	emit_section(section, entity);
+	code_section = section;
+	code_entity  = entity;
 
 	/* write the begin line (makes the life easier for scripts parsing the
 	 * assembler) */
@@ -609,13 +636,8 @@ void be_gas_emit_function_prolog(const ir_entity *entity, unsigned po2alignment,
 		be_emit_write_line();
 	}
 
-	if (po2alignment > 0) {
-		/* gcc fills space between function with 0x90... */
-		char const *const fill_byte    = is_macho() ? "0x90" : "";
-		unsigned    const maximum_skip = (1U << po2alignment) - 1;
-		be_emit_irprintf("\t.p2align %u,%s,%u\n", po2alignment, fill_byte, maximum_skip);
-		be_emit_write_line();
-	}
+	if (po2alignment > 0)
+		be_gas_emit_code_alignment(po2alignment, (1U << po2alignment) - 1);
 	emit_visibility(entity, false);
 
 	switch (ir_platform.object_format) {
@@ -644,18 +666,36 @@ void be_gas_emit_function_prolog(const ir_entity *entity, unsigned po2alignment,
 	be_dwarf_function_begin();
 }
 
+void be_gas_emit_code_alignment(unsigned const po2alignment,
+                                unsigned const maximum_skip)
+{
+	/* gcc fills space between function with 0x90... */
+	char const *const fill_byte = is_macho() ? "0x90" : "";
+	be_emit_irprintf("\t.p2align %u,%s,%u\n", po2alignment, fill_byte, maximum_skip);
+	be_emit_write_line();
+}
+
+/** Emits the size of the function symbol @p entity with @p suffix. */
+static void emit_function_size(ir_entity const *const entity,
+                               char const *const suffix)
+{
+	be_emit_cstring("\t.size\t");
+	be_gas_emit_entity(entity);
+	be_emit_string(suffix);
+	be_emit_cstring(", .-");
+	be_gas_emit_entity(entity);
+	be_emit_string(suffix);
+	be_emit_char('\n');
+	be_emit_write_line();
+}
+
 void be_gas_emit_function_epilog(ir_entity const *const entity)
 {
 	be_dwarf_function_end();
 
-	if (ir_platform.object_format == OBJECT_FORMAT_ELF) {
-		be_emit_cstring("\t.size\t");
-		be_gas_emit_entity(entity);
-		be_emit_cstring(", .-");
-		be_gas_emit_entity(entity);
-		be_emit_char('\n');
-		be_emit_write_line();
-	}
+	if (ir_platform.object_format == OBJECT_FORMAT_ELF)
+		emit_function_size(entity, in_cold_part ? ".cold" : "");
+	in_cold_part = false;
 
 	if (be_options.verbose_asm) {
 		be_emit_cstring("# -- End  ");
@@ -721,15 +761,15 @@ static void emit_init_expression(ir_node *const init)
 		return;
 
 	case iro_Offset:
-		be_emit_irprintf("%d", get_entity_offset(get_Offset_entity(init)));
+		be_emit_signed(get_entity_offset(get_Offset_entity(init)));
 		return;
 
 	case iro_Align:
-		be_emit_irprintf("%u", get_type_alignment(get_Align_type(init)));
+		be_emit_unsigned(get_type_alignment(get_Align_type(init)));
 		return;
 
 	case iro_Size:
-		be_emit_irprintf("%u", get_type_size(get_Size_type(init)));
+		be_emit_unsigned(get_type_size(get_Size_type(init)));
 		return;
 
 	case iro_Add:
@@ -836,10 +876,53 @@ void be_gas_emit_cstring(const char *string)
 	be_emit_write_line();
 }
 
+/**
+ * Emits a memory image as .quad directives followed by .byte directives for
+ * the remainder. Large images are the reason this kind of initializer exists,
+ * so the directives are formatted by hand instead of with be_emit_irprintf().
+ */
+static void emit_bytes_data(unsigned char const *const data, size_t const size)
+{
+	static char const hex[] = "0123456789abcdef";
+
+	unsigned const values_per_line = 8;
+	bool     const big_endian      = ir_target_big_endian();
+	size_t         i               = 0;
+	for (size_t const n_quads = size / 8; i < n_quads * 8;) {
+		be_emit_cstring("\t.quad\t");
+		for (unsigned v = 0; v < values_per_line && i < n_quads * 8; ++v, i += 8) {
+			char buf[18] = { '0', 'x' };
+			for (unsigned b = 0; b < 8; ++b) {
+				/* the most significant byte comes first */
+				unsigned char const c = data[i + (big_endian ? b : 7 - b)];
+				buf[2 + 2 * b]     = hex[c >> 4];
+				buf[2 + 2 * b + 1] = hex[c & 0xF];
+			}
+			if (v != 0)
+				be_emit_char(',');
+			be_emit_string_len(buf, sizeof(buf));
+		}
+		be_emit_char('\n');
+		be_emit_write_line();
+	}
+	while (i < size) {
+		be_emit_cstring("\t.byte\t");
+		for (unsigned v = 0; v < values_per_line && i < size; ++v, ++i) {
+			char const buf[] = { '0', 'x', hex[data[i] >> 4], hex[data[i] & 0xF] };
+			if (v != 0)
+				be_emit_char(',');
+			be_emit_string_len(buf, sizeof(buf));
+		}
+		be_emit_char('\n');
+		be_emit_write_line();
+	}
+}
+
 typedef enum normal_or_bitfield_kind {
 	NORMAL = 0,
 	TARVAL,
 	STRING,
+	BYTES,
 	BITFIELD
 } normal_or_bitfield_kind;
 
@@ -851,6 +934,7 @@ typedef struct {
 		ir_tarval              *tarval;
 		unsigned char           bf_val;
 		const ir_initializer_t *string;
+		const ir_initializer_t *bytes;
 	} v;
 } normal_or_bitfield;
 
@@ -864,6 +948,9 @@ static size_t get_initializer_size(const ir_initializer_t *initializer,
 	case IR_INITIALIZER_CONST:
 	case IR_INITIALIZER_NULL:
 		return get_type_size(type);
+	case IR_INITIALIZER_BYTES:
+		/* may be larger than the type for arrays of unknown size */
+		return MAX(get_type_size(type), get_initializer_bytes_size(initializer));
 	case IR_INITIALIZER_COMPOUND:
 		if (is_Array_type(type)) {
 			if (get_array_size(type) == 0) {
@@ -898,7 +985,7 @@ static size_t get_initializer_size(const ir_initializer_t *initializer,
 	panic("found invalid initializer");
 }
 
-static unsigned long compute_entity_size(ir_entity const *const entity)
+unsigned long be_gas_compute_entity_size(ir_entity const *const entity)
 {
 	ir_type *const type = get_entity_type(entity);
 	unsigned long  size = get_type_size(type);
@@ -940,6 +1027,8 @@ static void emit_bitfield(normal_or_bitfield *vals, unsigned offset_bits,
 	}
 	case IR_INITIALIZER_COMPOUND:
 		panic("bitfield initializer is compound");
+	case IR_INITIALIZER_BYTES:
+		panic("bitfield initializer is a memory image");
 	}
 	if (!tv || tv == tarval_bad)
 		panic("couldn't get numeric value for bitfield initializer");
@@ -1018,6 +1107,12 @@ static void emit_ir_initializer(normal_or_bitfield *vals,
 		}
 		return;
 
+	case IR_INITIALIZER_BYTES:
+		assert(vals->kind != BITFIELD);
+		vals->kind    = BYTES;
+		vals->v.bytes = initializer;
+		return;
+
 	case IR_INITIALIZER_COMPOUND:
 		if (is_Array_type(type)) {
 			ir_type *element_type = get_array_element_type(type);
@@ -1126,6 +1221,17 @@ static void emit_initializer(ir_entity const *const entity,
 		return;
 	}
 
+	/* avoid the per byte bookkeeping below for plain memory images */
+	if (get_initializer_kind(initializer) == IR_INITIALIZER_BYTES) {
+		size_t const n_bytes = get_initializer_bytes_size(initializer);
+		emit_bytes_data(get_initializer_bytes_data(initializer), n_bytes);
+		if (n_bytes < size) {
+			be_emit_irprintf("\t.space\t%lu, 0\n", size - n_bytes);
+			be_emit_write_line();
+		}
+		return;
+	}
+
 	assert(size > 0);
 
 	/* In the worst case, every initializer allocates one byte.
@@ -1159,6 +1265,12 @@ static void emit_initializer(ir_entity const *const entity,
 		case STRING:
 			elem_size = emit_string_initializer(vals[k].v.string);
 			break;
+		case BYTES: {
+			ir_initializer_t const *const bytes = vals[k].v.bytes;
+			elem_size = get_initializer_bytes_size(bytes);
+			emit_bytes_data(get_initializer_bytes_data(bytes), elem_size);
+			break;
+		}
 		case BITFIELD:
 			be_emit_irprintf("\t.byte\t%d\n", vals[k].v.bf_val);
 			be_emit_write_line();
@@ -1190,7 +1302,7 @@ static void emit_align(unsigned p2alignment)
 	be_emit_write_line();
 }
 
-static unsigned get_effective_entity_alignment(const ir_entity *entity)
+unsigned be_gas_get_entity_alignment(const ir_entity *entity)
 {
 	unsigned alignment = get_entity_alignment(entity);
 	if (alignment == 0) {
@@ -1203,7 +1315,7 @@ static unsigned get_effective_entity_alignment(const ir_entity *entity)
 static void emit_common(const ir_entity *entity, unsigned long size,
                         bool is_local)
 {
-	unsigned const alignment = get_effective_entity_alignment(entity);
+	unsigned const alignment = be_gas_get_entity_alignment(entity);
 
 	switch (ir_platform.object_format) {
 	case OBJECT_FORMAT_MACH_O:
@@ -1238,7 +1350,7 @@ static void emit_zerofill(const ir_entity *entity, const char *section_segment,
 	be_emit_string(section_segment);
 	be_emit_char(',');
 	be_gas_emit_entity(entity);
-	unsigned const alignment = get_effective_entity_alignment(entity);
+	unsigned const alignment = be_gas_get_entity_alignment(entity);
 	be_emit_irprintf(",%lu,%u\n", size, log2_floor(alignment));
 	be_emit_write_line();
 }
@@ -1297,7 +1409,9 @@ void be_gas_emit_entity(const ir_entity *entity)
 {
 	if (entity->kind == IR_ENTITY_LABEL) {
 		ir_label_t label = get_entity_label(entity);
-		be_emit_irprintf("%s_%lu", be_gas_get_private_prefix(), label);
+		be_emit_string(be_gas_get_private_prefix());
+		be_emit_char('_');
+		be_emit_unsigned(label);
 		return;
 	}
 
@@ -1312,6 +1426,16 @@ void be_gas_emit_entity(const ir_entity *entity)
 		be_emit_char('"');
 }
 
+unsigned be_gas_get_next_block_nr(void)
+{
+	return next_block_nr;
+}
+
+void be_gas_skip_block_nrs(unsigned const n)
+{
+	next_block_nr += n;
+}
+
 void be_gas_emit_block_name(const ir_node *block)
 {
 	ir_entity *entity = get_Block_entity(block);
@@ -1326,7 +1450,8 @@ void be_gas_emit_block_name(const ir_node *block)
 		} else {
 			nr = PTR_TO_INT(nr_val) - 1;
 		}
-		be_emit_irprintf("%s%d", be_gas_get_private_prefix(), nr);
+		be_emit_string(be_gas_get_private_prefix());
+		be_emit_signed(nr);
 	}
 }
 
@@ -1354,8 +1479,63 @@ static bool block_needs_label(ir_node const *const block)
 	}
 }
 
+/**
+ * Emits @p node like ir_printf("%+F") does. This is part of the comment on
+ * every instruction with verbose assembler output, so the common case is
+ * formatted by hand.
+ */
+static void emit_node_name(ir_node const *const node)
+{
+	if (is_Const(node) || is_Address(node) || is_Member(node) || is_Cmp(node)) {
+		be_emit_irprintf("%+F", node);
+		return;
+	}
+	be_emit_string(get_irn_opname(node));
+	be_emit_char(' ');
+	be_emit_string(get_mode_name(get_irn_mode(node)));
+	be_emit_char('[');
+	be_emit_signed(get_irn_node_nr(node));
+	be_emit_char(':');
+	be_emit_unsigned(get_irn_idx(node));
+	be_emit_char(']');
+}
+
+bool be_gas_can_split_function(ir_entity const *const entity)
+{
+	/* The debug info describes a function as a single range. */
+	return ir_platform.object_format == OBJECT_FORMAT_ELF
+	    && be_gas_elf_variant == ELF_VARIANT_NORMAL
+	    && !be_dwarf_enabled()
+	    && (be_gas_determine_section(NULL, entity) == GAS_SECTION_TEXT
+	     || be_gas_determine_section(NULL, entity) == GAS_SECTION_TEXT_HOT);
+}
+
+/**
+ * Continues the function @p entity in the section for rarely executed code
+ * as the local function symbol "name.cold".
+ */
+static void begin_cold_part(ir_entity const *const entity)
+{
+	emit_function_size(entity, "");
+	emit_section(GAS_SECTION_TEXT_UNLIKELY, NULL);
+	code_section = GAS_SECTION_TEXT_UNLIKELY;
+	code_entity  = NULL;
+	be_emit_cstring("\t.type\t");
+	be_gas_emit_entity(entity);
+	be_emit_irprintf(".cold, %cfunction\n", be_gas_elf_type_char);
+	be_emit_write_line();
+	be_gas_emit_entity(entity);
+	be_emit_cstring(".cold:\n");
+	be_emit_write_line();
+	in_cold_part = true;
+}
+
 void be_gas_begin_block(ir_node const *const block)
 {
+	ir_graph const *const irg = get_irn_irg(block);
+	if (be_birg_from_irg(irg)->cold_block == block)
+		begin_cold_part(get_irg_entity(irg));
+
 	if (block_needs_label(block)) {
 		be_gas_emit_block_name(block);
 		be_emit_char(':');
@@ -1369,7 +1549,9 @@ void be_gas_begin_block(ir_node const *const block)
 
 	if (be_options.verbose_asm) {
 		be_emit_pad_comment();
-		be_emit_irprintf("/* %+F preds:", block);
+		be_emit_cstring("/* ");
+		emit_node_name(block);
+		be_emit_cstring(" preds:");
 
 		int arity = get_irn_arity(block);
 		if (arity == 0) {
@@ -1403,7 +1585,7 @@ static void emit_global(be_main_env_t const *const main_env,
 
 	/* we already emitted all functions with graphs in other functions like
 	 * be_gas_emit_function_prolog(). All others don't need to be emitted. */
-	be_gas_section_t const section = determine_section(main_env, entity);
+	be_gas_section_t const section = be_gas_determine_section(main_env, entity);
 	if (kind == IR_ENTITY_METHOD && section != GAS_SECTION_PIC_TRAMPOLINES)
 		return;
 
@@ -1418,8 +1600,8 @@ static void emit_global(be_main_env_t const *const main_env,
 
 	ir_visibility const visibility       = get_entity_visibility(entity);
 	ir_linkage    const linkage          = get_entity_linkage(entity);
-	bool          const zero_initializer = entity_is_zero_initialized(entity);
-	unsigned long       size             = compute_entity_size(entity);
+	bool          const zero_initializer = be_gas_entity_is_zero_initialized(entity);
+	unsigned long       size             = be_gas_compute_entity_size(entity);
 
 	/* We need to output at least 1 byte, otherwise macho will merge
 	 * the label with the next thing */
@@ -1475,7 +1657,7 @@ static void emit_global(be_main_env_t const *const main_env,
 	}
 
 	/* alignment */
-	unsigned alignment = get_effective_entity_alignment(entity);
+	unsigned alignment = be_gas_get_entity_alignment(entity);
 	if (!is_po2_or_zero(alignment))
 		panic("alignment not a power of 2");
 	if (alignment > 1)
@@ -1544,7 +1726,9 @@ static void emit_global_decls(be_main_env_t const *const main_env)
 	}
 }
 
-void be_emit_jump_table(ir_node const *const node, be_switch_attr_t const *const swtch, ir_mode *const entry_mode, emit_target_func const emit_target)
+ir_node const **be_get_jump_table_targets(ir_node const *const node,
+                                          be_switch_attr_t const *const swtch,
+                                          unsigned long *const length_out)
 {
 	/* go over all proj's and collect their jump targets */
 	unsigned        n_outs  = arch_get_irn_n_outs(node);
@@ -1604,6 +1788,23 @@ void be_emit_jump_table(ir_node const *const node, be_switch_attr_t const *const
 		}
 	}
 
+	/* unmentioned values go to the default target */
+	for (unsigned long i = 0; i < length; ++i) {
+		if (labels[i] == NULL)
+			labels[i] = targets[0];
+	}
+
+	free(targets);
+	*length_out = length;
+	return labels;
+}
+
+void be_emit_jump_table(ir_node const *const node, be_switch_attr_t const *const swtch, ir_mode *const entry_mode, emit_target_func const emit_target)
+{
+	unsigned long         length;
+	ir_node const **const labels
+		= be_get_jump_table_targets(node, swtch, &length);
+
 	/* emit table */
 	unsigned         const pointer_size = get_mode_size_bytes(entry_mode);
 	ir_entity const *const entity       = swtch->table_entity;
@@ -1616,20 +1817,18 @@ void be_emit_jump_table(ir_node const *const node, be_switch_attr_t const *const
 	}
 
 	for (unsigned long i = 0; i < length; ++i) {
-		ir_node const *target = labels[i];
-		if (target == NULL)
-			target = targets[0];
 		emit_size_type(pointer_size);
-		emit_target(entity, target);
+		emit_target(entity, labels[i]);
 		be_emit_char('\n');
 		be_emit_write_line();
 	}
 
+	/* continue in the section of the function body, which is not the plain
+	 * text section for function sections or the cold part */
 	if (entity && !is_macho())
-		be_gas_emit_switch_section(GAS_SECTION_TEXT);
+		emit_section(code_section, code_entity);
 
 	free(labels);
-	free(targets);
 }
 
 static void emit_global_asms(void)
@@ -1677,14 +1876,23 @@ void be_emit_finish_line_gas(const ir_node *node)
 {
 	if (node && be_options.verbose_asm) {
 		be_emit_pad_comment();
-		dbg_info   *const dbg = get_irn_dbg_info(node);
-		src_loc_t   const loc = ir_retrieve_dbg_info(dbg);
-		char const *const fmt =
-			!loc.file       ? "/* %+F */\n"       :
-			loc.line   == 0 ? "/* %+F %s */\n"    :
-			loc.column == 0 ? "/* %+F %s:%u */\n" :
-			/*             */ "/* %+F %s:%u:%u */\n";
-		be_emit_irprintf(fmt, node, loc.file, loc.line, loc.column);
+		be_emit_cstring("/* ");
+		emit_node_name(node);
+		dbg_info *const dbg = get_irn_dbg_info(node);
+		src_loc_t const loc = ir_retrieve_dbg_info(dbg);
+		if (loc.file) {
+			be_emit_char(' ');
+			be_emit_string(loc.file);
+			if (loc.line != 0) {
+				be_emit_char(':');
+				be_emit_unsigned(loc.line);
+				if (loc.column != 0) {
+					be_emit_char(':');
+					be_emit_unsigned(loc.column);
+				}
+			}
+		}
+		be_emit_cstring(" */\n");
 	} else {
 		be_emit_char('\n');
 	}
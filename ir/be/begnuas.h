@@ -19,6 +19,8 @@
 
 typedef enum {
 	GAS_SECTION_TEXT,            /**< text section - program code */
+	GAS_SECTION_TEXT_HOT,        /**< frequently executed program code */
+	GAS_SECTION_TEXT_UNLIKELY,   /**< rarely executed program code */
 	GAS_SECTION_DATA,            /**< data section - arbitrary data */
 	GAS_SECTION_RODATA,          /**< read only data no relocations */
 	GAS_SECTION_REL_RO,          /**< read only data containing relocations */
@@ -72,8 +74,32 @@ void be_gas_emit_function_prolog(const ir_entity *entity,
 
 void be_gas_emit_function_epilog(const ir_entity *entity);
 
+/**
+ * Emits an alignment directive for code, which skips at most @p maximum_skip
+ * bytes.
+ */
+void be_gas_emit_code_alignment(unsigned po2alignment, unsigned maximum_skip);
+
+/**
+ * Returns whether the rarely executed blocks of the function @p entity can be
+ * emitted into a separate section.
+ */
+bool be_gas_can_split_function(ir_entity const *entity);
+
 char const *be_gas_get_private_prefix(void);
 
+/**
+ * Forgets the current section, so the next section switch is emitted even if
+ * the section does not change.
+ */
+void be_gas_forget_section(void);
+
+/** Returns the number the next block label gets. */
+unsigned be_gas_get_next_block_nr(void);
+
+/** Skips @p n block label numbers, which are used by code emitted verbatim. */
+void be_gas_skip_block_nrs(unsigned n);
+
 /**
  * emit ld_ident of an entity and performs additional mangling if necessary.
  * (mangling is necessary for ir_visibility_private for example).
@@ -89,7 +115,8 @@ void be_gas_emit_block_name(const ir_node *block);
 /**
  * Starts a basic block. Emits an assembler label "blockname:" if any control
  * flow predecessor does not fall through, otherwise a comment with the
- * blockname if verboseasm is enabled.
+ * blockname if verboseasm is enabled. Switches to the section for rarely
+ * executed code at the first cold block of the function.
  */
 void be_gas_begin_block(ir_node const *block);
 
@@ -124,6 +151,14 @@ const char *be_gas_insn_label_prefix(void);
 
 typedef void (*emit_target_func)(ir_entity const *table, ir_node const *proj_x);
 
+/**
+ * Compute the jump targets of a switch. Returns an array of @p *length
+ * control flow Projs, one for each table slot; free it with free().
+ */
+ir_node const **be_get_jump_table_targets(ir_node const *node,
+                                          be_switch_attr_t const *swtch,
+                                          unsigned long *length);
+
 /**
  * Emits a jump table for switch operations
  */
@@ -131,6 +166,29 @@ void be_emit_jump_table(ir_node const *node, be_switch_attr_t const *swtch, ir_m
 
 bool be_gas_produces_dwarf_line_info(void);
 
+/**
+ * Determine the section an entity is placed in.
+ */
+be_gas_section_t be_gas_determine_section(be_main_env_t const *main_env,
+                                          ir_entity const *entity);
+
+/**
+ * Return true if the entity has an initializer consisting of zeros only.
+ */
+bool be_gas_entity_is_zero_initialized(ir_entity const *entity);
+
+/**
+ * Return the size of an entity, taking initializers of variable sized types
+ * into account.
+ */
+unsigned long be_gas_compute_entity_size(ir_entity const *entity);
+
+/**
+ * Return the alignment of an entity, falling back to the alignment of its
+ * type.
+ */
+unsigned be_gas_get_entity_alignment(ir_entity const *entity);
+
 /**
  * Flush the line in the current line buffer to the emitter file and
  * appends a gas-style comment with the node number and writes the line
@@ -55,6 +55,9 @@ typedef struct be_irg_t {
 	/** Architecture specific per-graph data */
 	void             *isa_link;
 	bool              has_returns_twice_call;
+	/** first block of the part of the function emitted into a separate
+	 * section for rarely executed code, or NULL */
+	ir_node          *cold_block;
 } be_irg_t;
 
 static inline be_irg_t *be_birg_from_irg(const ir_graph *irg)
@@ -51,18 +51,22 @@ struct ir_jit_segment_t {
 	struct obstack code_obst;
 	struct obstack fragment_info_obst;
 	struct obstack fragment_info_arr_obst;
+	struct obstack jump_table_obst;
 };
 
 struct ir_jit_function_t {
-	unsigned          size;
-	unsigned          n_fragments;
-	char const       *code;
-	fragment_info_t **fragment_infos;
+	unsigned                   size;
+	unsigned                   n_fragments;
+	char const                *code;
+	fragment_info_t          **fragment_infos;
+	be_jit_jump_table_t const *jump_tables;
 };
 
-struct obstack        *code_obst;
-static struct obstack *fragment_info_obst;
-static struct obstack *fragment_info_arr_obst;
+struct obstack             *code_obst;
+static struct obstack      *fragment_info_obst;
+static struct obstack      *fragment_info_arr_obst;
+static struct obstack      *jump_table_obst;
+static be_jit_jump_table_t *jump_tables;
 
 ir_jit_segment_t *be_new_jit_segment(void)
 {
@@ -70,6 +74,7 @@ ir_jit_segment_t *be_new_jit_segment(void)
 	obstack_init(&segment->code_obst);
 	obstack_init(&segment->fragment_info_obst);
 	obstack_init(&segment->fragment_info_arr_obst);
+	obstack_init(&segment->jump_table_obst);
 	return segment;
 }
 
@@ -78,6 +83,7 @@ void be_destroy_jit_segment(ir_jit_segment_t *segment)
 	obstack_free(&segment->code_obst, NULL);
 	obstack_free(&segment->fragment_info_obst, NULL);
 	obstack_free(&segment->fragment_info_arr_obst, NULL);
+	obstack_free(&segment->jump_table_obst, NULL);
 	free(segment);
 }
 
@@ -101,6 +107,8 @@ void be_jit_begin_function(ir_jit_segment_t *const segment)
 	code_obst              = &segment->code_obst;
 	fragment_info_obst     = &segment->fragment_info_obst;
 	fragment_info_arr_obst = &segment->fragment_info_arr_obst;
+	jump_table_obst        = &segment->jump_table_obst;
+	jump_tables            = NULL;
 }
 
 static void layout_fragments(ir_jit_function_t *const function,
@@ -150,6 +158,7 @@ ir_jit_function_t *be_jit_finish_function(void)
 	res->n_fragments    = n_fragments;
 	res->fragment_infos = fragment_infos;
 	res->code           = obstack_finish(code_obst);
+	res->jump_tables    = jump_tables;
 
 	layout_fragments(res, code_size);
 
@@ -157,7 +166,9 @@ ir_jit_function_t *be_jit_finish_function(void)
 	code_obst              = NULL;
 	fragment_info_obst     = NULL;
 	fragment_info_arr_obst = NULL;
+	jump_table_obst        = NULL;
 #endif
+	jump_tables = NULL;
 
 	return res;
 }
@@ -167,6 +178,34 @@ unsigned be_get_function_size(ir_jit_function_t const *const function)
 	return function->size;
 }
 
+unsigned be_jit_get_fragment_address(ir_jit_function_t const *const function,
+                                     unsigned const fragment_num)
+{
+	assert(fragment_num < function->n_fragments);
+	return function->fragment_infos[fragment_num]->address;
+}
+
+be_jit_jump_table_t const *be_jit_get_jump_tables(
+		ir_jit_function_t const *const function)
+{
+	return function->jump_tables;
+}
+
+void be_jit_emit_jump_table(ir_entity const *const entity,
+                            unsigned const n_entries,
+                            unsigned const *const fragment_nums)
+{
+	be_jit_jump_table_t *const table
+		= (be_jit_jump_table_t*)obstack_alloc(jump_table_obst,
+			sizeof(*table) + n_entries * sizeof(table->fragment_nums[0]));
+	table->next      = jump_tables;
+	table->entity    = entity;
+	table->n_entries = n_entries;
+	memcpy(table->fragment_nums, fragment_nums,
+	       n_entries * sizeof(table->fragment_nums[0]));
+	jump_tables = table;
+}
+
 unsigned be_begin_fragment(uint8_t const p2align, uint8_t const max_skip)
 {
 	assert(obstack_object_size(fragment_info_obst) == 0);
@@ -360,7 +399,7 @@ void be_jit_emit_memory(char *const buffer, ir_jit_function_t *const function,
 	for (size_t i = 0, n = function->n_fragments; i < n; ++i) {
 		fragment_info_t const *const fragment  = function->fragment_infos[i];
 		unsigned               const address   = fragment->address;
-		unsigned               const nop_bytes = last_address - address;
+		unsigned               const nop_bytes = address - last_address;
 		assert(address >= last_address);
 		if (nop_bytes > 0)
 			emitter->nops(buffer + last_address, nop_bytes);
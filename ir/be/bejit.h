@@ -38,6 +38,30 @@ void be_jit_emit_as_asm(ir_jit_function_t *function, emit_relocation_func emit);
 void be_jit_begin_function(ir_jit_segment_t *segment);
 ir_jit_function_t *be_jit_finish_function(void);
 
+/** Return the address of a fragment relative to the function begin. */
+unsigned be_jit_get_fragment_address(ir_jit_function_t const *function,
+                                     unsigned fragment_num);
+
+/** A jump table whose entries are the addresses of code fragments. */
+typedef struct be_jit_jump_table_t be_jit_jump_table_t;
+struct be_jit_jump_table_t {
+	be_jit_jump_table_t const *next;
+	ir_entity const           *entity;    /**< the entity labeling the table */
+	unsigned                   n_entries;
+	unsigned                   fragment_nums[];
+};
+
+/**
+ * Record a jump table for the current function. The table data is not part
+ * of the code, it has to be placed by the object file writer.
+ */
+void be_jit_emit_jump_table(ir_entity const *entity, unsigned n_entries,
+                            unsigned const *fragment_nums);
+
+/** Return the list of jump tables recorded for @p function. */
+be_jit_jump_table_t const *be_jit_get_jump_tables(
+		ir_jit_function_t const *function);
+
 unsigned be_begin_fragment(uint8_t p2align, uint8_t max_skip);
 void be_finish_fragment(void);
 
@@ -11,9 +11,11 @@
  */
 #include "be_t.h"
 #include "beasm.h"
+#include "becache.h"
 #include "bechordal_t.h"
 #include "bediagnostic.h"
 #include "beemitter.h"
+#include "befuncorder.h"
 #include "begnuas.h"
 #include "beifg.h"
 #include "beirg.h"
@@ -150,6 +152,7 @@ static void finish_isa(void)
 {
 	assert(ir_target.isa_initialized);
 	ir_target.isa->finish();
+	arch_free_machine_infos();
 	obstack_free(&obst, NULL);
 }
 
@@ -294,6 +297,8 @@ static ir_graph *be_prepare_profile(const char *const cup_name)
 			be_warningf(NULL, "could not read profile data '%s'", prof_filename);
 		} else {
 			ir_create_execfreqs_from_profile();
+			/* The function layout needs the call counts of the profile. */
+			be_order_functions(true);
 			ir_profile_free();
 			have_profile = true;
 		}
@@ -309,6 +314,7 @@ static ir_graph *be_prepare_profile(const char *const cup_name)
 			ir_estimate_execfreq(irg);
 		}
 		be_timer_pop(T_EXECFREQ);
+		be_order_functions(false);
 	}
 	return prof_init_irg;
 }
@@ -382,6 +388,7 @@ void be_begin(FILE *file_handle, const char *cup_name)
 	if (prof_init_irg != NULL)
 		initialize_birg(&birgs[num_birgs++], prof_init_irg, &env);
 
+	be_cache_begin_compilation_unit(&env);
 	be_gas_begin_compilation_unit(&env);
 }
 
@@ -464,6 +471,10 @@ bool be_step_first(ir_graph *irg)
 	ir_entity *const entity = get_irg_entity(irg);
 	if (get_entity_linkage(entity) & IR_LINKAGE_NO_CODEGEN)
 		return false;
+	if (be_cache_begin_function(irg)) {
+		be_free_birg(irg);
+		return false;
+	}
 
 	be_timer_push(T_OTHER);
 	if (stat_ev_enabled) {
@@ -543,6 +554,7 @@ void be_step_last(ir_graph *irg)
 		}
 	}
 
+	be_cache_end_function();
 	be_free_birg(irg);
 	stat_ev_ctx_pop("bemain_irg");
 
@@ -552,6 +564,7 @@ void be_step_last(ir_graph *irg)
 void be_finish(void)
 {
 	be_gas_end_compilation_unit(&env);
+	be_free_function_order();
 
 	if (be_options.timing) {
 		ir_timer_stop(bemain_timer);
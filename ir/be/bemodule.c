@@ -39,16 +39,19 @@ void be_init_copynone(void);
 void be_init_copyopt(void);
 void be_init_daemelspill(void);
 void be_init_dwarf(void);
+void be_init_funcorder(void);
 void be_init_listsched(void);
 void be_init_live(void);
 void be_init_loopana(void);
 void be_init_pbqp(void);
 void be_init_pbqp_coloring(void);
 void be_init_peephole(void);
+void be_init_postsched(void);
 void be_init_pref_alloc(void);
 void be_init_ra(void);
 void be_init_sched(void);
 void be_init_sched_normal(void);
+void be_init_sched_latency(void);
 void be_init_sched_rand(void);
 void be_init_sched_trivial(void);
 void be_init_spill(void);
@@ -77,9 +80,11 @@ void be_init_modules(void)
 	be_init_chordal_common();
 	be_init_copyopt();
 	be_init_dwarf();
+	be_init_funcorder();
 	be_init_live();
 	be_init_loopana();
 	be_init_peephole();
+	be_init_postsched();
 	be_init_ra();
 	be_init_sched();
 	be_init_spill();
@@ -99,6 +104,7 @@ void be_init_modules(void)
 
 	be_init_listsched();
 	be_init_sched_normal();
+	be_init_sched_latency();
 	be_init_sched_rand();
 	be_init_sched_trivial();
 
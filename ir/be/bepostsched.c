@@ -0,0 +1,437 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   List scheduler running after register allocation.
+ *
+ * Spilling places reloads right before their first use, so the code stalls
+ * on them. This scheduler reorders the instructions of a block again, using
+ * the latencies of the machine model (see arch_get_irn_machine_info()).
+ * The register assignment is fixed, so besides the data dependencies an
+ * instruction must not move across another one reading or writing the same
+ * register (anti and output dependencies).
+ *
+ * Blocks are split at barriers, which keep their place: Phis, control flow,
+ * most backend nodes and instructions executed only for their side effects.
+ * Memory is a single resource. Reloads read only their spill slot, which was
+ * written by the spill they depend on, so they may move across other stores.
+ */
+#include "bepostsched.h"
+
+#include "array.h"
+#include "be_t.h"
+#include "bearch.h"
+#include "bemodule.h"
+#include "benode.h"
+#include "besched.h"
+#include "debug.h"
+#include "iredges_t.h"
+#include "irgwalk.h"
+#include "irnodetable.h"
+#include "irtools.h"
+#include "lc_opts.h"
+#include "obst.h"
+#include "target_t.h"
+#include "util.h"
+#include <string.h>
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
+
+/** Number of execution units the machine model can describe. */
+#define N_UNITS 32
+
+static bool do_postsched = false;
+
+typedef struct dep_t dep_t;
+struct dep_t {
+	dep_t   *next;
+	unsigned to;      /**< the dependent instruction */
+	unsigned latency; /**< cycles between the two instructions */
+};
+
+typedef struct insn_t {
+	ir_node *node;
+	dep_t   *succs;
+	unsigned n_preds;  /**< unscheduled predecessors */
+	unsigned earliest; /**< first cycle allowed by the predecessors */
+	unsigned height;   /**< length of the critical path to the region end */
+	unsigned latency;
+} insn_t;
+
+typedef struct resource_t {
+	int       writer;  /**< last instruction writing it, -1 if none */
+	unsigned *readers; /**< instructions reading it since */
+} resource_t;
+
+typedef struct postsched_env_t {
+	arch_register_class_t const *flags_cls;
+	arch_register_class_t const *stack_cls;
+	struct obstack               obst;       /**< dependencies */
+	ir_nodetable                 positions;  /**< instruction per node */
+	insn_t                      *insns;      /**< instructions of the region */
+	resource_t                  *resources;
+	unsigned                     n_resources;
+	unsigned                     unit_free[N_UNITS];
+} postsched_env_t;
+
+/** Returns the resource of the registers of class @p cls as a whole. */
+static unsigned get_class_resource(arch_register_class_t const *const cls)
+{
+	return ir_target.isa->n_registers + cls->index;
+}
+
+static unsigned get_memory_resource(void)
+{
+	return ir_target.isa->n_registers + ir_target.isa->n_register_classes;
+}
+
+static void add_dep(postsched_env_t *const env, unsigned const from,
+                    unsigned const to, unsigned const latency)
+{
+	if (from == to)
+		return;
+	dep_t *const dep = OALLOC(&env->obst, dep_t);
+	dep->next    = env->insns[from].succs;
+	dep->to      = to;
+	dep->latency = latency;
+	env->insns[from].succs = dep;
+	++env->insns[to].n_preds;
+}
+
+static void read_resource(postsched_env_t *const env, unsigned const i,
+                          unsigned const r)
+{
+	resource_t *const res = &env->resources[r];
+	if (res->writer >= 0)
+		add_dep(env, res->writer, i, env->insns[res->writer].latency);
+	ARR_APP1(unsigned, res->readers, i);
+}
+
+static void write_resource(postsched_env_t *const env, unsigned const i,
+                           unsigned const r)
+{
+	resource_t *const res = &env->resources[r];
+	for (size_t k = 0, n = ARR_LEN(res->readers); k < n; ++k) {
+		add_dep(env, res->readers[k], i, 0);
+	}
+	if (res->writer >= 0)
+		add_dep(env, res->writer, i, 0);
+	res->writer = i;
+	ARR_SHRINKLEN(res->readers, 0);
+}
+
+static void access_resource(postsched_env_t *const env, unsigned const i,
+                            unsigned const r, bool const write)
+{
+	if (write)
+		write_resource(env, i, r);
+	else
+		read_resource(env, i, r);
+}
+
+/**
+ * Records that instruction @p i reads or writes register @p reg of class
+ * @p cls. A NULL register stands for an unknown one of the class.
+ */
+static void access_register(postsched_env_t *const env, unsigned const i,
+                            arch_register_class_t const *const cls,
+                            arch_register_t const *const reg, bool const write)
+{
+	if (cls == env->stack_cls) {
+		write_resource(env, i, get_class_resource(cls));
+	} else if (cls->manual_ra) {
+		access_resource(env, i, get_class_resource(cls), write);
+	} else if (reg != NULL) {
+		if (!reg->is_virtual)
+			access_resource(env, i, reg->global_index, write);
+	} else {
+		for (unsigned r = 0; r < cls->n_regs; ++r) {
+			access_resource(env, i, cls->regs[r].global_index, write);
+		}
+	}
+}
+
+/** Returns whether @p cls is a pseudo class like memory or control flow. */
+static bool is_pseudo_class(arch_register_class_t const *const cls)
+{
+	return cls->index == (unsigned)-1;
+}
+
+static void add_deps(postsched_env_t *const env, unsigned const i)
+{
+	ir_node *const node = env->insns[i].node;
+	foreach_irn_in(node, n, op) {
+		unsigned const *const pos
+			= ir_nodetable_get(unsigned, &env->positions, skip_Proj(op));
+		if (pos != NULL)
+			add_dep(env, *pos, i, env->insns[*pos].latency);
+	}
+
+	bool mem_in  = false;
+	bool mem_out = false;
+	foreach_irn_in(node, n, op) {
+		arch_register_class_t const *const cls
+			= arch_get_irn_register_req_in(node, n)->cls;
+		if (cls == arch_memory_req->cls)
+			mem_in = true;
+		else if (!is_pseudo_class(cls))
+			access_register(env, i, cls, arch_get_irn_register_in(node, n),
+			                false);
+	}
+
+	if (env->flags_cls != NULL && arch_irn_is(node, modify_flags))
+		write_resource(env, i, get_class_resource(env->flags_cls));
+	be_foreach_out(node, o) {
+		arch_register_class_t const *const cls
+			= arch_get_irn_register_req_out(node, o)->cls;
+		if (cls == arch_memory_req->cls)
+			mem_out = true;
+		else if (!is_pseudo_class(cls))
+			access_register(env, i, cls, arch_get_irn_register_out(node, o),
+			                true);
+	}
+
+	unsigned const memory = get_memory_resource();
+	if (arch_irn_is(node, reload)) {
+		/* Only stores to the spill slot must stay after the reload. */
+		ARR_APP1(unsigned, env->resources[memory].readers, i);
+	} else if (mem_out) {
+		write_resource(env, i, memory);
+	} else if (mem_in) {
+		read_resource(env, i, memory);
+	}
+}
+
+/**
+ * Returns whether @p node has to keep its place: Nothing moves across it.
+ */
+static bool is_barrier(ir_node *const node)
+{
+	if (is_Phi(node) || is_cfop(node) || arch_irn_is(node, schedule_first))
+		return true;
+	if (is_be_node(node))
+		return !be_is_Copy(node) && !be_is_CopyKeep(node) && !be_is_Keep(node);
+
+	/* Instructions which may branch to an exception handler. */
+	if (get_irn_mode(node) == mode_T) {
+		foreach_out_edge(node, edge) {
+			if (get_irn_mode(get_edge_src_irn(edge)) == mode_X)
+				return true;
+		}
+	}
+	/* Instructions executed only for their side effects, like the stack
+	 * manipulations of the x87 simulation. */
+	be_foreach_out(node, o) {
+		arch_register_class_t const *const cls
+			= arch_get_irn_register_req_out(node, o)->cls;
+		if (!is_pseudo_class(cls) || cls == arch_memory_req->cls)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Returns the first cycle instruction @p insn can start in after @p cycle.
+ * If @p unit is not NULL, it is set to the execution unit used, or -1 if the
+ * instruction has no units.
+ */
+static unsigned get_start(postsched_env_t const *const env,
+                          insn_t const *const insn, unsigned const cycle,
+                          int *const unit)
+{
+	unsigned start = MAX(cycle, insn->earliest);
+	unsigned units = arch_get_irn_machine_info(insn->node)->units;
+	int      best  = -1;
+	unsigned free  = 0;
+	for (int u = 0; units != 0; ++u, units >>= 1) {
+		if ((units & 1) == 0)
+			continue;
+		if (best < 0 || env->unit_free[u] < free) {
+			best = u;
+			free = env->unit_free[u];
+		}
+	}
+	if (best >= 0)
+		start = MAX(start, free);
+	if (unit != NULL)
+		*unit = best;
+	return start;
+}
+
+/**
+ * Picks the ready instruction starting first, preferring the longer critical
+ * path and then the original order. Returns its position in @p ready.
+ */
+static size_t select_insn(postsched_env_t const *const env,
+                          unsigned const *const ready, unsigned const cycle)
+{
+	size_t   best        = 0;
+	unsigned best_start  = 0;
+	unsigned best_height = 0;
+	for (size_t k = 0, n = ARR_LEN(ready); k < n; ++k) {
+		insn_t const *const insn   = &env->insns[ready[k]];
+		unsigned      const start  = get_start(env, insn, cycle, NULL);
+		unsigned      const height = insn->height;
+		if (k > 0) {
+			if (start != best_start) {
+				if (start > best_start)
+					continue;
+			} else if (height != best_height) {
+				if (height < best_height)
+					continue;
+			} else if (ready[k] > ready[best]) {
+				continue;
+			}
+		}
+		best        = k;
+		best_start  = start;
+		best_height = height;
+	}
+	return best;
+}
+
+/** Reschedules the @p n instructions in @p nodes, which follow each other. */
+static void sched_region(postsched_env_t *const env, ir_node *const *const nodes,
+                         size_t const n)
+{
+	if (n < 2)
+		return;
+
+	ARR_RESIZE(insn_t, env->insns, n);
+	memset(env->insns, 0, n * sizeof(*env->insns));
+	ir_nodetable_clear(&env->positions);
+	for (size_t i = 0; i < n; ++i) {
+		insn_t *const insn = &env->insns[i];
+		insn->node    = nodes[i];
+		insn->latency = arch_get_irn_machine_info(nodes[i])->latency;
+		*ir_nodetable_insert(unsigned, &env->positions, nodes[i]) = i;
+	}
+	for (unsigned r = 0; r < env->n_resources; ++r) {
+		env->resources[r].writer = -1;
+		ARR_SHRINKLEN(env->resources[r].readers, 0);
+	}
+	for (size_t i = 0; i < n; ++i) {
+		add_deps(env, i);
+	}
+
+	/* Dependencies point forward, so the successors are done first. */
+	for (size_t i = n; i-- > 0;) {
+		insn_t  *const insn   = &env->insns[i];
+		unsigned       height = insn->latency;
+		for (dep_t const *dep = insn->succs; dep != NULL; dep = dep->next) {
+			height = MAX(height, dep->latency + env->insns[dep->to].height);
+		}
+		insn->height = height;
+	}
+
+	unsigned *ready = NEW_ARR_F(unsigned, 0);
+	for (size_t i = 0; i < n; ++i) {
+		if (env->insns[i].n_preds == 0)
+			ARR_APP1(unsigned, ready, i);
+	}
+
+	ir_node *last = sched_prev(nodes[0]);
+	for (size_t i = 0; i < n; ++i) {
+		sched_remove(nodes[i]);
+	}
+
+	memset(env->unit_free, 0, sizeof(env->unit_free));
+	unsigned cycle = 0;
+	for (size_t n_scheduled = 0; n_scheduled < n; ++n_scheduled) {
+		assert(ARR_LEN(ready) > 0);
+		size_t   const k    = select_insn(env, ready, cycle);
+		insn_t  *const insn = &env->insns[ready[k]];
+		ready[k] = ready[ARR_LEN(ready) - 1];
+		ARR_SHRINKLEN(ready, ARR_LEN(ready) - 1);
+
+		int            unit;
+		unsigned const start = get_start(env, insn, cycle, &unit);
+		if (unit >= 0) {
+			env->unit_free[unit]
+				= start + arch_get_irn_machine_info(insn->node)->throughput;
+		}
+		cycle = start;
+		DB((dbg, LEVEL_2, "\t%+F in cycle %u\n", insn->node, start));
+
+		for (dep_t const *dep = insn->succs; dep != NULL; dep = dep->next) {
+			insn_t *const succ = &env->insns[dep->to];
+			succ->earliest = MAX(succ->earliest, start + dep->latency);
+			if (--succ->n_preds == 0)
+				ARR_APP1(unsigned, ready, dep->to);
+		}
+
+		sched_add_after(last, insn->node);
+		last = insn->node;
+	}
+	DEL_ARR_F(ready);
+	obstack_free(&env->obst, NULL);
+	obstack_init(&env->obst);
+}
+
+static void sched_block(ir_node *const block, void *const data)
+{
+	postsched_env_t *const env = (postsched_env_t*)data;
+	DB((dbg, LEVEL_1, "%+F\n", block));
+
+	ir_node **nodes = NEW_ARR_F(ir_node*, 0);
+	sched_foreach(block, node) {
+		ARR_APP1(ir_node*, nodes, node);
+	}
+
+	size_t const n     = ARR_LEN(nodes);
+	size_t       first = 0;
+	for (size_t i = 0; i <= n; ++i) {
+		if (i == n || is_barrier(nodes[i])) {
+			sched_region(env, &nodes[first], i - first);
+			first = i + 1;
+		}
+	}
+	DEL_ARR_F(nodes);
+}
+
+void be_postsched_graph(ir_graph *const irg,
+                        arch_register_class_t const *const flags_cls,
+                        arch_register_class_t const *const stack_cls)
+{
+	if (!do_postsched)
+		return;
+
+	postsched_env_t env;
+	memset(&env, 0, sizeof(env));
+	env.flags_cls   = flags_cls;
+	env.stack_cls   = stack_cls;
+	env.insns       = NEW_ARR_F(insn_t, 0);
+	env.n_resources = get_memory_resource() + 1;
+	env.resources   = XMALLOCN(resource_t, env.n_resources);
+	for (unsigned r = 0; r < env.n_resources; ++r) {
+		env.resources[r].readers = NEW_ARR_F(unsigned, 0);
+	}
+	obstack_init(&env.obst);
+	ir_nodetable_init(&env.positions, irg, sizeof(unsigned));
+
+	irg_block_walk_graph(irg, sched_block, NULL, &env);
+
+	ir_nodetable_destroy(&env.positions);
+	obstack_free(&env.obst, NULL);
+	for (unsigned r = 0; r < env.n_resources; ++r) {
+		DEL_ARR_F(env.resources[r].readers);
+	}
+	free(env.resources);
+	DEL_ARR_F(env.insns);
+}
+
+BE_REGISTER_MODULE_CONSTRUCTOR(be_init_postsched)
+void be_init_postsched(void)
+{
+	static const lc_opt_table_entry_t options[] = {
+		LC_OPT_ENT_BOOL("postsched", "reschedule blocks after register allocation", &do_postsched),
+		LC_OPT_LAST
+	};
+	lc_opt_entry_t *be_grp = lc_opt_get_grp(firm_opt_get_root(), "be");
+	lc_opt_add_table(be_grp, options);
+
+	FIRM_DBG_REGISTER(dbg, "firm.be.postsched");
+}
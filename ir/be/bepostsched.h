@@ -0,0 +1,32 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   List scheduler running after register allocation.
+ */
+#ifndef FIRM_BE_BEPOSTSCHED_H
+#define FIRM_BE_BEPOSTSCHED_H
+
+#include "be_types.h"
+#include "firm_types.h"
+
+/**
+ * Reorders the instructions within each block of @p irg under the fixed
+ * register assignment, so reloads and other long latency instructions start
+ * early. Does nothing unless enabled with the be.postsched option.
+ *
+ * Backends call this after their final fixups right before emission.
+ *
+ * @param flags_cls  the class of the flags register, which nodes marked with
+ *                   arch_irn_flag_modify_flags write, or NULL
+ * @param stack_cls  a register class used as a stack, like the x87 registers
+ *                   after the x87 simulation, or NULL. Instructions using it
+ *                   keep their order.
+ */
+void be_postsched_graph(ir_graph *irg, arch_register_class_t const *flags_cls,
+                        arch_register_class_t const *stack_cls);
+
+#endif
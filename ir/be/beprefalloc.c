@@ -45,6 +45,7 @@
 #include "irgraph_t.h"
 #include "irgwalk.h"
 #include "irnode_t.h"
+#include "irnodetable.h"
 #include "irtools.h"
 #include "lpp.h"
 #include "obst.h"
@@ -70,6 +71,7 @@
 DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
 
 static struct obstack               obst;
+static ir_nodetable                 allocation_infos;
 static ir_graph                    *irg;
 static const arch_register_class_t *cls;
 static be_lv_t                     *lv;
@@ -115,12 +117,12 @@ typedef struct block_info_t block_info_t;
  */
 static allocation_info_t *get_allocation_info(ir_node *node)
 {
-	allocation_info_t *info = (allocation_info_t*)get_irn_link(node);
+	allocation_info_t *info
+		= ir_nodetable_get(allocation_info_t, &allocation_infos, node);
 	if (info == NULL) {
-		info = OALLOCFZ(&obst, allocation_info_t, prefs, n_regs);
+		info = ir_nodetable_insert(allocation_info_t, &allocation_infos, node);
 		info->current_value  = node;
 		info->original_value = node;
-		set_irn_link(node, info);
 	}
 
 	return info;
@@ -128,7 +130,7 @@ static allocation_info_t *get_allocation_info(ir_node *node)
 
 static allocation_info_t *try_get_allocation_info(const ir_node *node)
 {
-	return (allocation_info_t*) get_irn_link(node);
+	return ir_nodetable_get(allocation_info_t, &allocation_infos, node);
 }
 
 /**
@@ -1741,7 +1743,8 @@ static void be_pref_alloc_cls(void)
 
 	DB((dbg, LEVEL_2, "=== Allocating registers of %s ===\n", cls->name));
 
-	irg_walk_graph(irg, firm_clear_link, NULL, NULL);
+	irg_block_walk_graph(irg, firm_clear_link, NULL, NULL);
+	ir_nodetable_clear(&allocation_infos);
 
 	irg_block_walk_graph(irg, NULL, analyze_block, NULL);
 	combine_congruence_classes();
@@ -1791,6 +1794,12 @@ static void be_pref_alloc(ir_graph *new_irg, const regalloc_if_t *regif)
 
 	arch_register_class_t const *const reg_classes
 		= ir_target.isa->register_classes;
+	unsigned max_regs = 0;
+	for (int c = 0, n_cls = ir_target.isa->n_register_classes; c < n_cls; ++c)
+		max_regs = MAX(max_regs, reg_classes[c].n_regs);
+	ir_nodetable_init(&allocation_infos, irg, sizeof(allocation_info_t)
+	                  + max_regs * sizeof(((allocation_info_t*)0)->prefs[0]));
+
 	for (int c = 0, n_cls = ir_target.isa->n_register_classes; c < n_cls; ++c) {
 		cls = &reg_classes[c];
 		if (cls->manual_ra)
@@ -1827,6 +1836,7 @@ static void be_pref_alloc(ir_graph *new_irg, const regalloc_if_t *regif)
 	}
 
 	free_block_order();
+	ir_nodetable_destroy(&allocation_infos);
 	obstack_free(&obst, NULL);
 
 	set_optimize(last_opt_state);
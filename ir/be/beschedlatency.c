@@ -0,0 +1,421 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Critical path list scheduler using the machine model.
+ *
+ * The scheduler simulates the issue of the instructions of a block: an
+ * instruction can start when its operands are available and one of its
+ * execution units is free (see arch_get_irn_machine_info()). Among the ready
+ * nodes it picks the one starting first, preferring nodes with a longer
+ * critical path to the end of the block. When the number of live values of a
+ * register class reaches its limit, nodes which reduce the pressure are
+ * preferred instead.
+ */
+#include "be_t.h"
+#include "bearch.h"
+#include "belistsched.h"
+#include "bemodule.h"
+#include "benode.h"
+#include "besched.h"
+#include "debug.h"
+#include "heights.h"
+#include "iredges_t.h"
+#include "irgwalk.h"
+#include "irnodetable.h"
+#include "target_t.h"
+#include "util.h"
+#include "xmalloc.h"
+#include <string.h>
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
+
+/** Number of execution units the machine model can describe. */
+#define N_UNITS 32
+
+typedef struct value_info_t {
+	unsigned available; /**< cycle the value is available */
+	unsigned n_users;   /**< unscheduled users in the current block */
+	bool     live_out;  /**< live after the current block */
+} value_info_t;
+
+typedef struct sched_env_t {
+	ir_heights_t *heights;
+	ir_nodetable  values;
+	ir_node      *block;
+	unsigned      cycle;                /**< cycle of the last issue */
+	unsigned      unit_free[N_UNITS];   /**< cycle each unit is free again */
+	unsigned     *pressure;             /**< live values per class */
+	unsigned     *limit;                /**< pressure limit per class */
+} sched_env_t;
+
+static unsigned get_latency(ir_node const *const node)
+{
+	if (arch_is_irn_not_scheduled(node))
+		return 0;
+	return arch_get_irn_machine_info(node)->latency;
+}
+
+/**
+ * Returns the register class of value @p node if it occupies a register
+ * during allocation, NULL otherwise.
+ */
+static arch_register_class_t const *get_value_cls(ir_node const *const node)
+{
+	if (get_irn_mode(node) == mode_T)
+		return NULL;
+	arch_register_req_t const *const req = arch_get_irn_register_req(node);
+	if (req->ignore || req->cls->manual_ra)
+		return NULL;
+	return req->cls;
+}
+
+static value_info_t *get_value_info(sched_env_t *const env,
+                                    ir_node const *const node)
+{
+	value_info_t *info = ir_nodetable_get(value_info_t, &env->values, node);
+	if (info == NULL)
+		info = ir_nodetable_insert(value_info_t, &env->values, node);
+	return info;
+}
+
+/**
+ * Returns whether the value @p node, which is used in the current block but
+ * defined elsewhere, dies in the current block. This is an estimate: the
+ * value is assumed to die if it has no users outside its definition block and
+ * the current block.
+ */
+static bool is_live_in_dying(sched_env_t const *const env,
+                             ir_node const *const node)
+{
+	ir_node const *const def_block = get_nodes_block(node);
+	foreach_out_edge(node, edge) {
+		ir_node *const user = get_edge_src_irn(edge);
+		if (is_Phi(user))
+			return false;
+		ir_node const *const block = get_nodes_block(user);
+		if (block != env->block && block != def_block)
+			return false;
+	}
+	return true;
+}
+
+static void count_users(sched_env_t *const env, ir_node *const node)
+{
+	ir_node *const block = env->block;
+	foreach_irn_in(node, i, op) {
+		if (is_Block(op) || get_value_cls(op) == NULL)
+			continue;
+		value_info_t *const info  = get_value_info(env, op);
+		bool          const first = info->n_users == 0;
+		++info->n_users;
+		if (first && get_nodes_block(op) != block) {
+			info->live_out = !is_live_in_dying(env, op);
+			++env->pressure[get_value_cls(op)->index];
+		}
+	}
+}
+
+static void init_value(sched_env_t *const env, ir_node *const node)
+{
+	value_info_t *const info = get_value_info(env, node);
+	foreach_out_edge(node, edge) {
+		ir_node *const user = get_edge_src_irn(edge);
+		if (is_Block(user))
+			continue;
+		if (is_Phi(user) || get_nodes_block(user) != env->block) {
+			info->live_out = true;
+			break;
+		}
+	}
+}
+
+/** Returns the cycle the operands of @p node are available. */
+static unsigned get_operands_available(sched_env_t *const env,
+                                       ir_node const *const node)
+{
+	unsigned available = 0;
+	foreach_irn_in(node, i, op) {
+		if (is_Block(op) || get_nodes_block(op) != env->block)
+			continue;
+		value_info_t const *const info
+			= ir_nodetable_get(value_info_t, &env->values, skip_Proj(op));
+		if (info != NULL)
+			available = MAX(available, info->available);
+	}
+	return available;
+}
+
+/**
+ * Returns the first cycle @p node can start in. If @p unit is not NULL, it is
+ * set to the execution unit used, or -1 if the node has no units.
+ */
+static unsigned get_start(sched_env_t *const env, ir_node const *const node,
+                          int *const unit)
+{
+	unsigned start = MAX(env->cycle, get_operands_available(env, node));
+	unsigned units = arch_get_irn_machine_info(node)->units;
+	int      best  = -1;
+	unsigned free  = 0;
+	for (int u = 0; units != 0; ++u, units >>= 1) {
+		if ((units & 1) == 0)
+			continue;
+		if (best < 0 || env->unit_free[u] < free) {
+			best = u;
+			free = env->unit_free[u];
+		}
+	}
+	if (best >= 0)
+		start = MAX(start, free);
+	if (unit != NULL)
+		*unit = best;
+	return start;
+}
+
+static void add_value_pressure(sched_env_t const *const env,
+                               ir_node const *const value,
+                               int *const delta)
+{
+	arch_register_class_t const *const cls = get_value_cls(value);
+	if (cls == NULL)
+		return;
+	value_info_t const *const info
+		= ir_nodetable_get(value_info_t, &env->values, value);
+	if (info != NULL && (info->n_users > 0 || info->live_out))
+		++delta[cls->index];
+}
+
+/**
+ * Computes how scheduling @p node changes the number of live values of each
+ * register class.
+ */
+static void get_pressure_delta(sched_env_t const *const env,
+                               ir_node const *const node, int *const delta)
+{
+	unsigned const n_classes = ir_target.isa->n_register_classes;
+	memset(delta, 0, n_classes * sizeof(*delta));
+
+	if (get_irn_mode(node) == mode_T) {
+		foreach_out_edge(node, edge) {
+			ir_node const *const proj = get_edge_src_irn(edge);
+			if (is_Proj(proj))
+				add_value_pressure(env, proj, delta);
+		}
+	} else {
+		add_value_pressure(env, node, delta);
+	}
+
+	foreach_irn_in(node, i, op) {
+		if (is_Block(op))
+			continue;
+		arch_register_class_t const *const cls = get_value_cls(op);
+		if (cls == NULL)
+			continue;
+		value_info_t const *const info
+			= ir_nodetable_get(value_info_t, &env->values, op);
+		if (info != NULL && info->n_users == 1 && !info->live_out)
+			--delta[cls->index];
+	}
+}
+
+/** Returns whether any register class is at its pressure limit. */
+static bool is_pressure_high(sched_env_t const *const env)
+{
+	for (unsigned c = 0, n = ir_target.isa->n_register_classes; c < n; ++c) {
+		if (env->limit[c] > 0 && env->pressure[c] >= env->limit[c])
+			return true;
+	}
+	return false;
+}
+
+/** Returns the increase of pressure in classes at their pressure limit. */
+static int get_excess_delta(sched_env_t const *const env,
+                            int const *const delta)
+{
+	int excess = 0;
+	for (unsigned c = 0, n = ir_target.isa->n_register_classes; c < n; ++c) {
+		if (env->limit[c] > 0 && env->pressure[c] >= env->limit[c])
+			excess += delta[c];
+	}
+	return excess;
+}
+
+static ir_node *latency_select(sched_env_t *const env,
+                               ir_nodeset_t *const ready_set)
+{
+	bool const high_pressure = is_pressure_high(env);
+	int *const delta
+		= ALLOCAN(int, ir_target.isa->n_register_classes);
+
+	ir_node *best        = NULL;
+	int      best_excess = 0;
+	unsigned best_start  = 0;
+	unsigned best_height = 0;
+	foreach_ir_nodeset(ready_set, node, iter) {
+		int excess = 0;
+		if (high_pressure) {
+			get_pressure_delta(env, node, delta);
+			excess = get_excess_delta(env, delta);
+		}
+		unsigned const start  = get_start(env, node, NULL);
+		unsigned const height = get_irn_height(env->heights, node);
+		if (best != NULL) {
+			if (excess != best_excess) {
+				if (excess > best_excess)
+					continue;
+			} else if (start != best_start) {
+				if (start > best_start)
+					continue;
+			} else if (height != best_height) {
+				if (height < best_height)
+					continue;
+			} else if (get_irn_idx(node) > get_irn_idx(best)) {
+				continue;
+			}
+		}
+		best        = node;
+		best_excess = excess;
+		best_start  = start;
+		best_height = height;
+	}
+	return best;
+}
+
+static void add_value(sched_env_t *const env, ir_node const *const value,
+                      unsigned const available)
+{
+	value_info_t *const info = get_value_info(env, value);
+	info->available = available;
+	arch_register_class_t const *const cls = get_value_cls(value);
+	if (cls != NULL && (info->n_users > 0 || info->live_out))
+		++env->pressure[cls->index];
+}
+
+/** Makes the values defined by @p node available in cycle @p available. */
+static void add_values(sched_env_t *const env, ir_node *const node,
+                       unsigned const available)
+{
+	if (get_irn_mode(node) == mode_T) {
+		get_value_info(env, node)->available = available;
+		foreach_out_edge(node, edge) {
+			ir_node const *const proj = get_edge_src_irn(edge);
+			if (is_Proj(proj))
+				add_value(env, proj, available);
+		}
+	} else {
+		add_value(env, node, available);
+	}
+}
+
+/** Updates the simulated machine state for issuing @p node. */
+static void issue(sched_env_t *const env, ir_node *const node)
+{
+	int            unit;
+	unsigned const start = get_start(env, node, &unit);
+	arch_machine_info_t const *const machine_info
+		= arch_get_irn_machine_info(node);
+	if (unit >= 0)
+		env->unit_free[unit] = start + machine_info->throughput;
+	env->cycle = start;
+	DB((dbg, LEVEL_2, "\tissue %+F in cycle %u\n", node, start));
+
+	foreach_irn_in(node, i, op) {
+		if (is_Block(op) || get_value_cls(op) == NULL)
+			continue;
+		value_info_t *const info = get_value_info(env, op);
+		assert(info->n_users > 0);
+		if (--info->n_users == 0 && !info->live_out) {
+			unsigned *const pressure = &env->pressure[get_value_cls(op)->index];
+			assert(*pressure > 0);
+			--*pressure;
+		}
+	}
+
+	add_values(env, node, start + machine_info->latency);
+}
+
+/**
+ * Initializes the simulation of @p block. The list scheduler places
+ * schedule_first nodes (Phis, Keeps) without asking the scheduler, so they
+ * do not use their operands in the simulation and their values are available
+ * from the start of the block.
+ */
+static void init_block(sched_env_t *const env, ir_node *const block)
+{
+	env->block = block;
+	env->cycle = 0;
+	memset(env->unit_free, 0, sizeof(env->unit_free));
+	unsigned const n_classes = ir_target.isa->n_register_classes;
+	memset(env->pressure, 0, n_classes * sizeof(*env->pressure));
+	ir_nodetable_clear(&env->values);
+
+	foreach_out_edge(block, edge) {
+		ir_node *const node = get_edge_src_irn(edge);
+		if (is_Proj(node) || get_irn_mode(node) != mode_T)
+			init_value(env, node);
+	}
+	foreach_out_edge(block, edge) {
+		ir_node *const node = get_edge_src_irn(edge);
+		if (!is_Proj(node) && !arch_irn_is(node, schedule_first))
+			count_users(env, node);
+	}
+	foreach_out_edge(block, edge) {
+		ir_node *const node = get_edge_src_irn(edge);
+		if (!is_Proj(node) && arch_irn_is(node, schedule_first))
+			add_values(env, node, 0);
+	}
+}
+
+static void sched_block(ir_node *const block, void *const data)
+{
+	sched_env_t *const env = (sched_env_t*)data;
+	init_block(env, block);
+
+	ir_nodeset_t *const cands = be_list_sched_begin_block(block);
+	while (ir_nodeset_size(cands) > 0) {
+		ir_node *const node = latency_select(env, cands);
+		issue(env, node);
+		be_list_sched_schedule(node);
+	}
+	be_list_sched_end_block();
+}
+
+static void sched_latency(ir_graph *irg)
+{
+	sched_env_t env;
+	memset(&env, 0, sizeof(env));
+
+	unsigned const n_classes = ir_target.isa->n_register_classes;
+	env.pressure = XMALLOCNZ(unsigned, n_classes);
+	env.limit   = XMALLOCNZ(unsigned, n_classes);
+	/* The pressure estimate misses live-through values and register
+	 * constraints, so only fill half of the registers. */
+	for (unsigned c = 0; c < n_classes; ++c) {
+		arch_register_class_t const *const cls
+			= &ir_target.isa->register_classes[c];
+		if (!cls->manual_ra)
+			env.limit[c] = be_get_n_allocatable_regs(irg, cls) / 2;
+	}
+
+	be_list_sched_begin(irg);
+	env.heights = heights_new_weighted(irg, get_latency);
+	ir_nodetable_init(&env.values, irg, sizeof(value_info_t));
+
+	irg_block_walk_graph(irg, sched_block, NULL, &env);
+
+	ir_nodetable_destroy(&env.values);
+	heights_free(env.heights);
+	be_list_sched_finish();
+	free(env.limit);
+	free(env.pressure);
+}
+
+BE_REGISTER_MODULE_CONSTRUCTOR(be_init_sched_latency)
+void be_init_sched_latency(void)
+{
+	be_register_scheduler("latency", sched_latency);
+	FIRM_DBG_REGISTER(dbg, "firm.be.sched.latency");
+}
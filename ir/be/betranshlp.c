@@ -129,7 +129,7 @@ void be_set_transform_proj_function(ir_op *op, be_transform_func func)
 static ir_node *transform_block(ir_node *node)
 {
 	ir_node *const block = exact_copy(node);
-	block->node_nr = node->node_nr;
+	copy_irn_node_nr(block, node);
 
 	/* put the preds in the worklist */
 	be_enqueue_operands(node);
@@ -186,7 +186,7 @@ ir_node *be_duplicate_node(ir_node *const node)
 	ir_node *const block    = be_transform_nodes_block(node);
 	ir_node *const new_node = new_similar_node(node, block, ins);
 
-	new_node->node_nr = node->node_nr;
+	copy_irn_node_nr(new_node, node);
 	return new_node;
 }
 
@@ -323,6 +323,8 @@ void be_transform_graph(ir_graph *irg, arch_pretrans_nodes *func)
 	struct obstack old_obst = irg->obst;
 	obstack_init(&irg->obst);
 	irg->last_node_idx = 0;
+	/* the free lists point into the old obstack */
+	memset(irg->free_nodes, 0, sizeof(irg->free_nodes));
 
 	free_vrp_data(irg);
 
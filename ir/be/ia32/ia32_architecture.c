@@ -24,6 +24,7 @@ ia32_code_gen_config_t ia32_cg_config;
 
 static bool              opt_size             = false;
 static bool              emit_machcode        = false;
+static bool              emit_object          = false;
 static bool              use_softfloat        = false;
 static bool              use_cmov             = false;
 static bool              use_sse              = false;
@@ -175,6 +176,7 @@ static const lc_opt_table_entry_t ia32_architecture_options[] = {
 	LC_OPT_ENT_BOOL    ("optcc",            "optimize calling convention",                        &opt_cc),
 	LC_OPT_ENT_BOOL    ("unsafe_floatconv", "do unsafe floating point controlword optimizations", &opt_unsafe_floatconv),
 	LC_OPT_ENT_BOOL    ("machcode",         "output machine code instead of assembler",           &emit_machcode),
+	LC_OPT_ENT_BOOL    ("objfile",          "write an ELF object file instead of assembler",      &emit_object),
 	LC_OPT_ENT_BOOL    ("soft-float",       "equivalent to fpmath=softfloat",                     &use_softfloat),
 	LC_OPT_ENT_BOOL    ("cmov",             "use conditional move",                               &use_cmov),
 	LC_OPT_ENT_BOOL    ("sse",              "gcc compatibility",                                  &use_sse),
@@ -486,6 +488,7 @@ void ia32_setup_cg_config(void)
 	c->optimize_cc          = opt_cc;
 	c->use_unsafe_floatconv = opt_unsafe_floatconv;
 	c->emit_machcode        = emit_machcode;
+	c->emit_object          = emit_object;
 
 	c->function_alignment       = arch_costs->function_alignment;
 	c->label_alignment          = arch_costs->label_alignment;
@@ -82,6 +82,8 @@ typedef struct {
 	bool use_unsafe_floatconv:1;
 	/** emit machine code instead of assembler */
 	bool emit_machcode:1;
+	/** write an ELF object file instead of assembler */
+	bool emit_object:1;
 
 	/** function alignment (a power of two in bytes) */
 	unsigned function_alignment;
@@ -10,9 +10,11 @@
  */
 #include "ia32_bearch_t.h"
 
+#include "beelf.h"
 #include "beflags.h"
 #include "begnuas.h"
 #include "bemodule.h"
+#include "bepostsched.h"
 #include "bera.h"
 #include "besched.h"
 #include "bespillslots.h"
@@ -1114,6 +1116,9 @@ static void ia32_before_emit(ir_graph *irg)
 	ia32_peephole_optimization(irg);
 
 	be_remove_dead_nodes_from_schedule(irg);
+
+	be_postsched_graph(irg, &ia32_reg_classes[CLASS_ia32_flags],
+	                   &ia32_reg_classes[CLASS_ia32_fp]);
 }
 
 /**
@@ -1360,7 +1365,6 @@ static void ia32_init(void)
 	}
 
 	ia32_register_init();
-	obstack_init(&opcodes_obst);
 	ia32_create_opcodes();
 	ia32_cconv_init();
 }
@@ -1368,7 +1372,6 @@ static void ia32_init(void)
 static void ia32_finish(void)
 {
 	ia32_free_opcodes();
-	obstack_free(&opcodes_obst, NULL);
 }
 
 static void ia32_mark_remat(ir_node *node)
@@ -1416,7 +1419,12 @@ static void ia32_generate_code(FILE *output, const char *cup_name)
 {
 	ia32_tv_ent = pmap_create();
 
-	be_begin(output, cup_name);
+	/* An object file is written instead of the assembler text, which is
+	 * discarded then. */
+	bool const emit_object = ia32_cg_config.emit_object;
+	be_begin(emit_object ? NULL : output, cup_name);
+	if (emit_object)
+		ia32_begin_object(output);
 	unsigned *const sp_is_non_ssa = rbitset_alloca(N_IA32_REGISTERS);
 	rbitset_set(sp_is_non_ssa, REG_ESP);
 
@@ -1425,13 +1433,19 @@ static void ia32_generate_code(FILE *output, const char *cup_name)
 			continue;
 
 		be_timer_push(T_EMIT);
-		ia32_emit_function(irg);
+		if (emit_object)
+			ia32_emit_object_function(irg);
+		else
+			ia32_emit_function(irg);
 		be_timer_pop(T_EMIT);
 
 		be_step_last(irg);
 	}
 
-	ia32_emit_thunks();
+	if (emit_object)
+		be_elf_finish();
+	else
+		ia32_emit_thunks();
 
 	be_finish();
 	pmap_destroy(ia32_tv_ent);
@@ -319,8 +319,12 @@ end_of_mods:
 					case 'F':
 						if (get_ia32_op_type(node) == ia32_Normal) {
 							ia32_x87_attr_t const *const attr = get_ia32_x87_attr_const(node);
-							char            const *const fmt  = attr->x87.res_in_reg ? "%%st, %%%s" : "%%%s, %%st";
-							be_emit_irprintf(fmt, attr->x87.reg->name);
+							if (attr->x87.res_in_reg)
+								be_emit_cstring("%st, ");
+							be_emit_char('%');
+							be_emit_string(attr->x87.reg->name);
+							if (!attr->x87.res_in_reg)
+								be_emit_cstring(", %st");
 							break;
 						} else {
 							goto emit_AM;
@@ -587,7 +591,7 @@ x86_condition_code_t ia32_determine_final_cc(ir_node const *const node,
 static void ia32_emit_exc_label(const ir_node *node)
 {
 	be_emit_string(be_gas_insn_label_prefix());
-	be_emit_irprintf("%lu", get_ia32_exc_label_id(node));
+	be_emit_unsigned(get_ia32_exc_label_id(node));
 }
 
 static void emit_jmp(ir_node const *const node, ir_node const *const target)
@@ -1284,8 +1288,10 @@ static void ia32_emit_block_header(ir_node *block)
 		/* align the current block if:
 		 * a) if should be aligned due to its execution frequency
 		 * b) there is no fall-through here
+		 * c) it is the header of a loop iterating often
 		 */
-		if (ia32_should_align_block(block) || !has_fallthrough(block))
+		if (ia32_should_align_block(block) || !has_fallthrough(block)
+		 || be_should_align_loop_header(block))
 			ia32_emit_align_label();
 	}
 
@@ -13,6 +13,7 @@
 #include "bearch.h"
 #include "beblocksched.h"
 #include "beemithlp.h"
+#include "beelf.h"
 #include "begnuas.h"
 #include "bejit.h"
 #include "besched.h"
@@ -133,6 +134,18 @@ static void enc_modru(const arch_register_t *reg, unsigned ext)
 	be_emit8(modrm);
 }
 
+/** Create a ModR/M8 byte for one register and extension */
+static void enc_modru8(reg_modifier_t high_part, const arch_register_t *reg,
+                       unsigned ext)
+{
+	unsigned char modrm = MOD_REG;
+	assert(ext <= 7);
+	assert(high_part == REG_LOW || reg->encoding < 4);
+	modrm |= ENC_RM(reg->encoding, high_part);
+	modrm |= ENC_REG(ext, REG_LOW);
+	be_emit8(modrm);
+}
+
 /** Create a ModR/M8 byte for one register */
 static void enc_modrm8(reg_modifier_t high_part, const arch_register_t *reg)
 {
@@ -334,13 +347,20 @@ void ia32_enc_simple(uint8_t const opcode)
 	be_emit8(opcode);
 }
 
+/** Returns the register modifier selecting the 8 bit high registers if
+ * @p node operates on them. */
+static reg_modifier_t get_8bit_modifier(ir_node const *const node)
+{
+	return get_ia32_attr_const(node)->use_8bit_high ? REG_HIGH : REG_LOW;
+}
+
 void ia32_enc_unop(ir_node const *const node, uint8_t const code,
                    uint8_t const ext, int const input)
 {
 	be_emit8(code);
 	if (get_ia32_op_type(node) == ia32_Normal) {
 		const arch_register_t *in = arch_get_irn_register_in(node, input);
-		enc_modru(in, ext);
+		enc_modru8(get_8bit_modifier(node), in, ext);
 	} else {
 		enc_mod_am(ext, node);
 	}
@@ -360,6 +380,7 @@ static bool use_eax_short_form(ir_node const *const node)
 {
 	return
 		get_ia32_op_type(node) == ia32_Normal &&
+		!get_ia32_attr_const(node)->use_8bit_high &&
 		arch_get_irn_register_in(node, n_ia32_binary_left)->index == REG_GP_EAX;
 }
 
@@ -368,8 +389,9 @@ static void enc_binop_reg(ir_node const *const node, unsigned char const code, i
 	be_emit8(code);
 	arch_register_t const *const dst = arch_get_irn_register_in(node, n_ia32_binary_left);
 	if (get_ia32_op_type(node) == ia32_Normal) {
-		arch_register_t const *const src = arch_get_irn_register(right);
-		enc_modrr(src, dst);
+		arch_register_t const *const src  = arch_get_irn_register(right);
+		reg_modifier_t         const high = get_8bit_modifier(node);
+		enc_modrr8(high, src, high, dst);
 	} else {
 		enc_mod_am(dst->encoding, node);
 	}
@@ -560,6 +582,17 @@ static void enc_setcc(const ir_node *node)
 	}
 }
 
+static void enc_setccmem(ir_node const *const node)
+{
+	x86_condition_code_t const cc
+		= ia32_determine_final_cc(node, n_ia32_SetccMem_eflags);
+	assert(!(cc & x86_cc_float_parity_cases));
+	/* set%PNC mem */
+	be_emit8(0x0F);
+	be_emit8(0x90 | pnc2cc(cc));
+	enc_mod_am(0, node);
+}
+
 static void enc_unop_reg(ir_node const *const node, uint8_t const code,
                          int const input)
 {
@@ -581,6 +614,41 @@ static void enc_bswap(ir_node const *const node)
 	enc_modru(arch_get_irn_register_out(node, pn_ia32_Bswap_res), 1);
 }
 
+static void enc_bswap16(ir_node const *const node)
+{
+	/* xchg %<reg, %>reg */
+	arch_register_t const *const reg = arch_get_irn_register_out(node, pn_ia32_Bswap16_res);
+	be_emit8(0x86);
+	enc_modrr8(REG_LOW, reg, REG_HIGH, reg);
+}
+
+static void enc_xorhighlow(ir_node const *const node)
+{
+	/* xorb %>reg, %<reg */
+	arch_register_t const *const reg = arch_get_irn_register_out(node, pn_ia32_XorHighLow_res);
+	be_emit8(0x30);
+	enc_modrr8(REG_LOW, reg, REG_HIGH, reg);
+}
+
+static void enc_cmpxchgmem(ir_node const *const node)
+{
+	x86_insn_size_t const size = get_ia32_attr_const(node)->size;
+	be_emit8(0xF0); // lock
+	if (size == X86_SIZE_16)
+		be_emit8(0x66);
+	be_emit8(0x0F);
+	be_emit8(size == X86_SIZE_8 ? 0xB0 : 0xB1);
+	arch_register_t const *const in = arch_get_irn_register_in(node, n_ia32_CmpXChgMem_new);
+	enc_mod_am(in->encoding, node);
+}
+
+static void enc_ud2(ir_node const *const node)
+{
+	(void)node;
+	be_emit8(0x0F);
+	be_emit8(0x0B);
+}
+
 static void enc_bt(ir_node const *const node)
 {
 	be_emit8(0x0F);
@@ -759,11 +827,22 @@ zero_neg:
 }
 
 /**
- * Emits a MOV out, [MEM].
+ * Emits a MOV out, [MEM] or a MOVZX/MOVSX for 8 and 16 bit loads.
  */
 static void enc_load(const ir_node *node)
 {
-	arch_register_t const *const out = arch_get_irn_register_out(node, pn_ia32_Load_res);
+	arch_register_t const *const out  = arch_get_irn_register_out(node, pn_ia32_Load_res);
+	ia32_attr_t     const *const attr = get_ia32_attr_const(node);
+
+	if (attr->size == X86_SIZE_8 || attr->size == X86_SIZE_16) {
+		unsigned opcode = 0xB6;
+		if (attr->sign_extend)         opcode |= 0x08;
+		if (attr->size == X86_SIZE_16) opcode |= 0x01;
+		be_emit8(0x0F);
+		be_emit8(opcode);
+		enc_mod_am(out->encoding, node);
+		return;
+	}
 
 	if (out->index == REG_GP_EAX) {
 		ir_node const *const base = get_irn_n_reg(node, n_ia32_base);
@@ -772,7 +851,6 @@ static void enc_load(const ir_node *node)
 			/* load from constant address to EAX can be encoded
 			   as 0xA1 [offset] */
 			be_emit8(0xA1);
-			ia32_attr_t const *const attr = get_ia32_attr_const(node);
 			enc_relocation(&attr->addr.immediate);
 			return;
 		}
@@ -892,7 +970,7 @@ static void enc_call(ir_node const *const node)
 			= &get_ia32_immediate_attr_const(callee)->imm;
 		assert(imm->kind == X86_IMM_PCREL);
 
-		if (ia32_cg_config.emit_machcode) {
+		if (ia32_cg_config.emit_machcode && !ia32_cg_config.emit_object) {
 			/* Cheat because I cannot find a way to output .long ENTITY
 			 * as a PC relative relocation. See emit_jit_entity_relocation_asm()
 			 * for the other half of the cheat! */
@@ -998,10 +1076,28 @@ static void enc_ia32_jcc(const ir_node *node)
 static void enc_switchjmp(const ir_node *node)
 {
 	be_emit8(0xFF); // jmp *tbl.label(,%in,4)
-	enc_mod_am(0x05, node);
+	enc_mod_am(0x04, node);
 
 	ia32_switch_attr_t const *const attr = get_ia32_switch_attr_const(node);
-	be_emit_jump_table(node, &attr->swtch, mode_P, ia32_emit_jumptable_target);
+	if (!ia32_cg_config.emit_object) {
+		be_emit_jump_table(node, &attr->swtch, mode_P,
+		                   ia32_emit_jumptable_target);
+		return;
+	}
+
+	/* the object file writer places the table into the rodata section */
+	unsigned long         length;
+	ir_node const **const targets
+		= be_get_jump_table_targets(node, &attr->swtch, &length);
+	unsigned *const fragment_nums = XMALLOCN(unsigned, length);
+	for (unsigned long i = 0; i < length; ++i) {
+		ir_node const *const block = be_emit_get_cfop_target(targets[i]);
+		fragment_nums[i]
+			= PTR_TO_INT(ir_nodehashmap_get(void, &block_fragmentnum, block));
+	}
+	be_jit_emit_jump_table(attr->swtch.table_entity, length, fragment_nums);
+	free(fragment_nums);
+	free(targets);
 }
 
 static void enc_return(const ir_node *node)
@@ -1025,6 +1121,12 @@ static void enc_subsp(const ir_node *node)
 	enc_mov(&ia32_registers[REG_ESP], out);
 }
 
+static void enc_copyebpesp(ir_node const *const node)
+{
+	(void)node;
+	enc_mov(&ia32_registers[REG_EBP], &ia32_registers[REG_ESP]);
+}
+
 static void enc_incsp(const ir_node *node)
 {
 	int offs = be_get_IncSP_offset(node);
@@ -1052,15 +1154,27 @@ static void enc_incsp(const ir_node *node)
 	}
 }
 
-static void enc_copybi(const ir_node *node)
+static void enc_copyb_prolog(unsigned const size)
 {
-	unsigned size = get_ia32_copyb_size(node);
 	if (size & 1)
 		be_emit8(0xA4); // movsb
 	if (size & 2) {
 		be_emit8(0x66);
 		be_emit8(0xA5); // movsw
 	}
+}
+
+static void enc_copyb(const ir_node *node)
+{
+	enc_copyb_prolog(get_ia32_copyb_size(node));
+	be_emit8(0xF3); // rep
+	be_emit8(0xA5); // movsl
+}
+
+static void enc_copybi(const ir_node *node)
+{
+	unsigned size = get_ia32_copyb_size(node);
+	enc_copyb_prolog(size);
 	size >>= 2;
 	while (size--) {
 		be_emit8(0xA5); // movsl
@@ -1131,7 +1245,7 @@ static void enc_fild(const ir_node *node)
 	panic("invalid mode size");
 }
 
-static void enc_fist(const ir_node *node)
+static void enc_fist_pop(ir_node const *const node, bool const pop)
 {
 	x86_insn_size_t const size = get_ia32_attr_const(node)->size;
 	switch (size) {
@@ -1140,11 +1254,12 @@ static void enc_fist(const ir_node *node)
 	case X86_SIZE_32: be_emit8(0xDB); op = 2; goto enc; // fist[p]l
 	case X86_SIZE_64: be_emit8(0xDF); op = 6; goto enc; // fistpll
 enc:
-		if (get_ia32_x87_attr_const(node)->x87.pop)
+		if (pop)
 			++op;
 		// There is only a pop variant for 64 bit integer store.
-		assert(size < X86_SIZE_64 || get_ia32_x87_attr_const(node)->x87.pop);
+		assert(size < X86_SIZE_64 || pop);
 		enc_mod_am(op, node);
+		return;
 
 	case X86_SIZE_8:
 	case X86_SIZE_80:
@@ -1154,6 +1269,16 @@ enc:
 	panic("invalid mode size");
 }
 
+static void enc_fist(ir_node const *const node)
+{
+	enc_fist_pop(node, get_ia32_x87_attr_const(node)->x87.pop);
+}
+
+static void enc_fistp(ir_node const *const node)
+{
+	enc_fist_pop(node, true);
+}
+
 static void enc_fisttp(ir_node const *const node)
 {
 	x86_insn_size_t const size = get_ia32_attr_const(node)->size;
@@ -1202,7 +1327,7 @@ static void enc_fldcw(const ir_node *node)
 	enc_mod_am(5, node);
 }
 
-static void enc_fst(const ir_node *node)
+static void enc_fst_pop(ir_node const *const node, bool const pop)
 {
 	x86_insn_size_t const size = get_ia32_attr_const(node)->size;
 	switch (size) {
@@ -1211,11 +1336,12 @@ static void enc_fst(const ir_node *node)
 	case X86_SIZE_64: be_emit8(0xDD); op = 2; goto enc; // fst[p]l
 	case X86_SIZE_80: be_emit8(0xDB); op = 6; goto enc; // fstpt
 enc:
-		if (get_ia32_x87_attr_const(node)->x87.pop)
+		if (pop)
 			++op;
 		/* There is only a pop variant for long double store. */
-		assert(size < X86_SIZE_80 || get_ia32_x87_attr_const(node)->x87.pop);
+		assert(size < X86_SIZE_80 || pop);
 		enc_mod_am(op, node);
+		return;
 
 	case X86_SIZE_8:
 	case X86_SIZE_16:
@@ -1225,6 +1351,16 @@ enc:
 	panic("unexpected mode size");
 }
 
+static void enc_fst(ir_node const *const node)
+{
+	enc_fst_pop(node, get_ia32_x87_attr_const(node)->x87.pop);
+}
+
+static void enc_fstp(ir_node const *const node)
+{
+	enc_fst_pop(node, true);
+}
+
 static void enc_fnstcw(const ir_node *node)
 {
 	be_emit8(0xD9); // fnstcw
@@ -1281,12 +1417,16 @@ static void ia32_register_binary_emitters(void)
 	be_set_emitter(op_be_Perm,            enc_perm);
 	be_set_emitter(op_ia32_Ret,           enc_return);
 	be_set_emitter(op_ia32_Bswap,         enc_bswap);
+	be_set_emitter(op_ia32_Bswap16,       enc_bswap16);
 	be_set_emitter(op_ia32_Bt,            enc_bt);
 	be_set_emitter(op_ia32_CMovcc,        enc_cmovcc);
 	be_set_emitter(op_ia32_Call,          enc_call);
+	be_set_emitter(op_ia32_CmpXChgMem,    enc_cmpxchgmem);
 	be_set_emitter(op_ia32_Const,         enc_mov_const);
 	be_set_emitter(op_ia32_Conv_I2I,      enc_conv_i2i);
+	be_set_emitter(op_ia32_CopyB,         enc_copyb);
 	be_set_emitter(op_ia32_CopyB_i,       enc_copybi);
+	be_set_emitter(op_ia32_CopyEbpEsp,    enc_copyebpesp);
 	be_set_emitter(op_ia32_Dec,           enc_dec);
 	be_set_emitter(op_ia32_FldCW,         enc_fldcw);
 	be_set_emitter(op_ia32_FnstCW,        enc_fnstcw);
@@ -1309,18 +1449,23 @@ static void ia32_register_binary_emitters(void)
 	be_set_emitter(op_ia32_PushEax,       enc_pusheax);
 	be_set_emitter(op_ia32_Sbb0,          enc_sbb0);
 	be_set_emitter(op_ia32_Setcc,         enc_setcc);
+	be_set_emitter(op_ia32_SetccMem,      enc_setccmem);
 	be_set_emitter(op_ia32_ShlD,          enc_shld);
 	be_set_emitter(op_ia32_ShrD,          enc_shrd);
 	be_set_emitter(op_ia32_Store,         enc_store);
 	be_set_emitter(op_ia32_SubSP,         enc_subsp);
 	be_set_emitter(op_ia32_SwitchJmp,     enc_switchjmp);
 	be_set_emitter(op_ia32_Test,          enc_test);
+	be_set_emitter(op_ia32_UD2,           enc_ud2);
 	be_set_emitter(op_ia32_Xor0,          enc_xor0);
+	be_set_emitter(op_ia32_XorHighLow,    enc_xorhighlow);
 	be_set_emitter(op_ia32_fild,          enc_fild);
 	be_set_emitter(op_ia32_fist,          enc_fist);
+	be_set_emitter(op_ia32_fistp,         enc_fistp);
 	be_set_emitter(op_ia32_fisttp,        enc_fisttp);
 	be_set_emitter(op_ia32_fld,           enc_fld);
 	be_set_emitter(op_ia32_fst,           enc_fst);
+	be_set_emitter(op_ia32_fstp,          enc_fstp);
 }
 
 static void assign_block_fragment_num(ir_node *const block, unsigned const num)
@@ -1454,3 +1599,70 @@ void ia32_emit_jit_function(char *buffer, ir_jit_function_t *const function)
 	};
 	be_jit_emit_memory(buffer, function, &jit_emit_interface);
 }
+
+enum {
+	R_386_32     = 1,
+	R_386_PC32   = 2,
+	R_386_GOT32  = 3,
+	R_386_PLT32  = 4,
+	R_386_GOTOFF = 9,
+	R_386_TLS_IE = 15,
+	R_386_TLS_LE = 17,
+};
+
+static unsigned enc_object_relocation_callback(char *const buffer,
+                                               uint8_t const be_kind,
+                                               ir_entity *const entity,
+                                               int32_t const offset)
+{
+	if (entity == NULL) {
+		assert(be_kind == IA32_RELOCATION_RELJUMP);
+		uint32_t const value = (uint32_t)offset;
+		memcpy(buffer, &value, 4);
+		return 4;
+	}
+
+	uint32_t type;
+	switch ((x86_immediate_kind_t)be_kind) {
+	case X86_IMM_ADDR:   type = R_386_32;     break;
+	case X86_IMM_PCREL:  type = R_386_PC32;   break;
+	case X86_IMM_PLT:    type = R_386_PLT32;  break;
+	case X86_IMM_GOT:    type = R_386_GOT32;  break;
+	case X86_IMM_GOTOFF: type = R_386_GOTOFF; break;
+	case X86_IMM_TLS_IE: type = R_386_TLS_IE; break;
+	case X86_IMM_TLS_LE: type = R_386_TLS_LE; break;
+	default:
+		panic("relocation kind %u not supported in object files",
+		      (unsigned)be_kind);
+	}
+	return be_elf_relocation(buffer, 4, type, entity, offset);
+}
+
+void ia32_begin_object(FILE *const output)
+{
+	static const be_elf_machine_t elf_machine = {
+		.machine     = 3, /* EM_386 */
+		.is_64bit    = false,
+		.use_rela    = false,
+		.reloc_abs   = R_386_32,
+		.reloc_pcrel = R_386_PC32,
+		.nops        = enc_nop_callback,
+	};
+	/* The encoder has no SSE instructions. */
+	if (ia32_cg_config.use_sse2)
+		panic("SSE floating point not supported by the ELF writer, "
+		      "use fpmath=387 or fpmath=softfloat");
+	be_elf_begin(output, &elf_machine);
+}
+
+void ia32_emit_object_function(ir_graph *const irg)
+{
+	ir_jit_segment_t  *const segment  = be_new_jit_segment();
+	ir_jit_function_t *const function = ia32_emit_jit(segment, irg);
+	/* Block alignment is relative to the function begin. */
+	unsigned const p2align = MAX(ia32_cg_config.function_alignment,
+	                             ia32_cg_config.label_alignment);
+	be_elf_emit_function(get_irg_entity(irg), p2align, function,
+	                     enc_object_relocation_callback);
+	be_destroy_jit_segment(segment);
+}
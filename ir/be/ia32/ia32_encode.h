@@ -12,6 +12,7 @@
 #define FIRM_BE_IA32_IA32_ENCODE_H
 
 #include <stdint.h>
+#include <stdio.h>
 #include "firm_types.h"
 #include "jit.h"
 
@@ -23,6 +24,12 @@ ir_jit_function_t *ia32_emit_jit(ir_jit_segment_t *segment, ir_graph *irg);
 
 void ia32_emit_jit_function(char *buffer, ir_jit_function_t *function);
 
+/** Start writing an ELF object file instead of assembler. */
+void ia32_begin_object(FILE *output);
+
+/** Encode @p irg and place it into the object file. */
+void ia32_emit_object_function(ir_graph *irg);
+
 void ia32_enc_simple(uint8_t opcode);
 
 void ia32_enc_binop(ir_node const *node, unsigned code);
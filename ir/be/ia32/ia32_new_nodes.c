@@ -35,8 +35,6 @@
 #include <stdbool.h>
 #include <stdlib.h>
 
-struct obstack opcodes_obst;
-
 static const char *condition_code_name(x86_condition_code_t cc)
 {
 	switch (cc) {
@@ -443,9 +441,7 @@ int is_ia32_is_remat(const ir_node *node)
 unsigned get_ia32_latency(const ir_node *node)
 {
 	assert(is_ia32_irn(node));
-	const ir_op *op               = get_irn_op(node);
-	const ia32_op_attr_t *op_attr = (ia32_op_attr_t*) get_op_attr(op);
-	return op_attr->latency;
+	return arch_get_irn_machine_info(node)->latency;
 }
 
 x86_condition_code_t get_ia32_condcode(const ir_node *node)
@@ -675,10 +671,3 @@ int ia32_return_attrs_equal(const ir_node *a, const ir_node *b)
 	return ia32_attrs_equal_(&attr_a->attr, &attr_b->attr)
 	    && attr_a->pop == attr_b->pop;
 }
-
-void ia32_init_op(ir_op *op, unsigned latency)
-{
-	ia32_op_attr_t *attr = OALLOCZ(&opcodes_obst, ia32_op_attr_t);
-	attr->latency = latency;
-	set_op_attr(op, attr);
-}
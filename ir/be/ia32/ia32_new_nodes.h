@@ -39,8 +39,6 @@ enum {
 	pn_ia32_st_X_except  = 2,
 };
 
-extern struct obstack opcodes_obst;
-
 /**
  * Returns the attributes of an ia32 node.
  */
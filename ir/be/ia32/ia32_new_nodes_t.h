@@ -38,6 +38,4 @@ int ia32_climbframe_attrs_equal(const ir_node *a, const ir_node *b);
 int ia32_switch_attrs_equal(const ir_node *a, const ir_node *b);
 int ia32_return_attrs_equal(const ir_node *a, const ir_node *b);
 
-void ia32_init_op(ir_op *op, unsigned latency);
-
 #endif
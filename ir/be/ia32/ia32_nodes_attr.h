@@ -56,11 +56,6 @@ typedef enum match_flags_t {
 } match_flags_t;
 ENUM_BITSET(match_flags_t)
 
-typedef struct ia32_op_attr_t ia32_op_attr_t;
-struct ia32_op_attr_t {
-	unsigned latency;
-};
-
 #ifndef NDEBUG
 typedef enum ia32_attr_type_t {
 	IA32_ATTR_INVALID               = 0,
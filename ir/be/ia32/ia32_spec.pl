@@ -124,6 +124,19 @@ $custom_init_attr_func = \&ia32_custom_init_attr;
 		"\tinit_ia32_return_attributes(res, pop);",
 );
 
+# Execution units of the machine model, loosely following the ports of current
+# out-of-order x86 cores.
+@execution_units = ( "p0", "p1", "p2", "p3", "p4", "p5", "p6" );
+
+my $alu_units    = [ "p0", "p1", "p5", "p6" ];
+my $shift_units  = [ "p0", "p6" ];
+my $mul_units    = [ "p1" ];
+my $div_units    = [ "p0" ];
+my $fp_units     = [ "p0", "p1" ];
+my $load_units   = [ "p2", "p3" ];
+my $store_units  = [ "p4" ];
+my $branch_units = [ "p6" ];
+
 my $x87sim = "ia32_request_x87_sim(irg);";
 
 my $binop_commutative = {
@@ -145,6 +158,7 @@ my $binop_commutative = {
 	am        => "source,binary",
 	mode      => "first",
 	emit      => "{name}%M %B",
+	units     => $alu_units,
 };
 
 my $binop_flags = {
@@ -162,6 +176,7 @@ my $binop_flags = {
 	init      => "attr->ins_permuted = ins_permuted;",
 	mode      => "first",
 	emit      => "{name}%M %B",
+	units     => $alu_units,
 };
 
 my $binop_mem = {
@@ -176,6 +191,7 @@ my $binop_mem = {
 	outs      => [ "unused", "flags", "M" ],
 	attr      => "x86_insn_size_t size",
 	emit      => "{name}%M %S3, %AM",
+	units     => $alu_units,
 };
 
 my $shiftop = {
@@ -190,6 +206,7 @@ my $shiftop = {
 	mode      => "first",
 	attr      => "x86_insn_size_t size",
 	emit      => "{name}%M %<,S1 %D0",
+	units     => $shift_units,
 };
 
 my $shiftop_mem = {
@@ -201,6 +218,7 @@ my $shiftop_mem = {
 	outs      => [ "unused", "flags", "M" ],
 	attr      => "x86_insn_size_t size",
 	emit      => "{name}%M %<,S3 %AM",
+	units     => $shift_units,
 };
 
 my $shiftop_double = {
@@ -218,6 +236,7 @@ my $shiftop_double = {
 	mode      => "first",
 	fixed     => "x86_insn_size_t const size = X86_SIZE_32;",
 	emit      => "{name}%M %<S2, %S1, %D0",
+	units     => $mul_units,
 };
 
 my $divop = {
@@ -231,6 +250,8 @@ my $divop = {
 	am        => "source,unary",
 	attr      => "x86_insn_size_t size",
 	emit      => "{name}%M %AS3",
+	units     => $div_units,
+	throughput => 6,
 };
 
 my $mulop = {
@@ -245,6 +266,7 @@ my $mulop = {
 	am        => "source,binary",
 	attr      => "x86_insn_size_t size",
 	emit      => "{name}%M %AS4",
+	units     => $mul_units,
 };
 
 my $unop = {
@@ -256,6 +278,7 @@ my $unop = {
 	attr      => "x86_insn_size_t size",
 	mode      => "first",
 	emit      => "{name}%M %D0",
+	units     => $alu_units,
 };
 
 my $unop_no_flags = {
@@ -267,6 +290,7 @@ my $unop_no_flags = {
 	outs      => [ "res" ],
 	attr      => "x86_insn_size_t size",
 	emit      => "{name}%M %D0",
+	units     => $alu_units,
 };
 
 my $unop_from_mem = {
@@ -280,6 +304,7 @@ my $unop_from_mem = {
 	mode      => "first",
 	attr      => "x86_insn_size_t size",
 	emit      => "{name}%M %AS3, %D0",
+	units     => $load_units,
 };
 
 my $unop_mem = {
@@ -291,6 +316,7 @@ my $unop_mem = {
 	outs      => [ "unused", "flags", "M" ],
 	attr      => "x86_insn_size_t size",
 	emit      => "{name}%M %AM",
+	units     => $alu_units,
 };
 
 my $memop = {
@@ -322,6 +348,7 @@ my $fbinop = {
 	mode      => "first",
 	attr_type => "ia32_x87_attr_t",
 	attr      => "x86_insn_size_t size",
+	units     => $fp_units,
 };
 
 my $funop = {
@@ -373,6 +400,7 @@ my $xbinop = {
 	mode      => "first",
 	attr      => "x86_insn_size_t size",
 	emit      => "{name}%FX %B",
+	units     => $fp_units,
 };
 
 my $xbinop_commutative = {
@@ -386,6 +414,7 @@ my $xbinop_commutative = {
 	mode      => "first",
 	attr      => "x86_insn_size_t size",
 	emit      => "{name}%FX %B",
+	units     => $fp_units,
 };
 
 my $xconv_i2f = {
@@ -396,6 +425,7 @@ my $xconv_i2f = {
 	attr     => "x86_insn_size_t size",
 	am       => "source,unary",
 	emit     => "{name} %AS3, %D0",
+	units    => $fp_units,
 };
 
 my $xshiftop = {
@@ -404,6 +434,7 @@ my $xshiftop = {
 	out_reqs  => [ "in_r0 !in_r1" ],
 	attr      => "x86_insn_size_t size",
 	emit      => "{name} %S1, %D0",
+	units     => $shift_units,
 };
 
 my $xvalueop = {
@@ -448,6 +479,7 @@ my $loadop = {
 	state    => "exc_pinned",
 	in_reqs  => [ "gp", "gp", "mem" ],
 	ins      => [ "base", "index", "mem" ],
+	units    => $load_units,
 };
 
 my $storeop = {
@@ -456,6 +488,7 @@ my $storeop = {
 	out_reqs => [ "mem", "exec", "exec" ],
 	outs     => [ "M", "X_regular", "X_except" ],
 	attr     => "x86_insn_size_t size",
+	units    => $store_units,
 };
 
 my $fucomop = {
@@ -543,6 +576,7 @@ IMul => {
 	template => $binop_commutative,
 	encode   => "ia32_enc_0f_unop_reg(node, 0xAF, n_ia32_IMul_right)",
 	latency  => 5,
+	units    => $mul_units,
 },
 
 IMulImm => {
@@ -555,6 +589,7 @@ IMulImm => {
 	},
 	emit     => "imul%M %S4, %AS3, %D0",
 	latency  => 5,
+	units    => $mul_units,
 },
 
 IMul1OP => {
@@ -911,6 +946,7 @@ Setcc => {
 	             "\t\t/* attr->latency = 3; */\n".
 	             "\t}\n",
 	latency   => 1,
+	units     => $alu_units,
 },
 
 SetccMem => {
@@ -941,6 +977,7 @@ CMovcc => {
 	emit      => "cmov%P5 %B",
 	latency   => 1,
 	mode      => "first",
+	units     => $alu_units,
 },
 
 Jcc => {
@@ -955,6 +992,7 @@ Jcc => {
 	attr_type => "ia32_condcode_attr_t",
 	attr      => "x86_condition_code_t condition_code",
 	latency   => 2,
+	units     => $branch_units,
 },
 
 SwitchJmp => {
@@ -976,6 +1014,7 @@ Jmp => {
 	out_reqs  => [ "exec" ],
 	latency   => 1,
 	fixed    => "x86_insn_size_t const size = X86_SIZE_32;",
+	units     => $branch_units,
 },
 
 IJmp => {
@@ -1087,6 +1126,7 @@ Load => {
 	attr     => "x86_insn_size_t size, bool sign_extend",
 	init     => "attr->sign_extend = sign_extend;",
 	emit     => "mov%#Ml %AM, %#D0",
+	units    => $load_units,
 },
 
 Store => {
@@ -1098,6 +1138,7 @@ Store => {
 	ins      => [ "base", "index", "mem", "val" ],
 	emit     => "mov%M %S3, %AM",
 	latency  => 2,
+	units    => $store_units,
 },
 
 Lea => {
@@ -1111,6 +1152,7 @@ Lea => {
 	fixed     => "x86_insn_size_t const size = X86_SIZE_32;",
 	emit      => "leal %AM, %D0",
 	latency   => 2,
+	units     => $alu_units,
 },
 
 Push => {
@@ -1123,6 +1165,7 @@ Push => {
 	am       => "source,unary",
 	latency  => 2,
 	attr     => "x86_insn_size_t size",
+	units    => $store_units,
 },
 
 PushEax => {
@@ -1147,6 +1190,7 @@ Pop => {
 	emit    => "pop%M %D0",
 	attr    => "x86_insn_size_t size",
 	latency => 3, # Pop is more expensive than Push on Athlon
+	units   => $load_units,
 },
 
 CopyEbpEsp => {
@@ -1198,6 +1242,7 @@ AddSP => {
 	fixed     => "x86_insn_size_t const size = X86_SIZE_32;",
 	am        => "source,binary",
 	emit      => "addl %B",
+	encode    => "ia32_enc_binop(node, 0)",
 	latency   => 1,
 	outs      => [ "stack", "M" ],
 },
@@ -1278,6 +1323,7 @@ Call => {
 	attr      => "uint8_t pop, uint8_t n_reg_results",
 	am        => "source,unary",
 	latency   => 4, # random number
+	units     => $branch_units,
 },
 
 Bswap => {
@@ -1476,7 +1522,9 @@ Divs => {
 	template => $xbinop,
 	am       => "source,binary",
 	latency  => 16,
-	mode     => "mode_T"
+	mode     => "mode_T",
+	units    => $div_units,
+	throughput => 4,
 },
 
 Ucomis => {
@@ -1501,6 +1549,7 @@ xLoad => {
 	emit     => "movs%FX %AM, %D0",
 	attr     => "x86_insn_size_t size",
 	latency  => 0,
+	units    => $load_units,
 },
 
 xStore => {
@@ -1509,6 +1558,7 @@ xStore => {
 	ins      => [ "base", "index", "mem", "val" ],
 	emit     => "movs%FX %S3, %AM",
 	latency  => 0,
+	units    => $store_units,
 },
 
 CvtSI2SS => {
@@ -1645,7 +1695,9 @@ fdiv => {
 	emit     => "fdiv%FR%FP%FM %AF",
 	encode   => "ia32_enc_fbinop(node, 6, 7)",
 	latency  => 20,
-	mode     => "mode_T"
+	mode     => "mode_T",
+	units    => $div_units,
+	throughput => 4,
 },
 
 fabs => {
@@ -1895,28 +1947,11 @@ xxStore => {
 
 );
 
-# Transform some attributes
+# Every node except the lowering helpers needs a machine model
 foreach my $op (keys(%nodes)) {
-	my $node         = $nodes{$op};
-	my $op_attr_init = $node->{op_attr_init};
-
-	if (defined($op_attr_init)) {
-		$op_attr_init .= "\n\t";
-	} else {
-		$op_attr_init = "";
+	if (!defined($nodes{$op}->{latency}) && $op !~ m/^l_/) {
+		die("Latency missing for op $op");
 	}
-
-	my $latency = $node->{latency};
-	if (!defined($latency)) {
-		if ($op =~ m/^l_/) {
-			$latency = 0;
-		} else {
-			die("Latency missing for op $op");
-		}
-	}
-	$op_attr_init .= "ia32_init_op(op, $latency);";
-
-	$node->{op_attr_init} = $op_attr_init;
 }
 
 print "";
@@ -25,15 +25,17 @@
 static void emit_immediate_val(char const *const prefix, ir_entity *const ent, int32_t const val)
 {
 	if (ent) {
-		if (prefix)
-			be_emit_irprintf("%s(", prefix);
+		if (prefix) {
+			be_emit_string(prefix);
+			be_emit_char('(');
+		}
 		be_gas_emit_entity(ent);
 		if (val != 0)
-			be_emit_irprintf("%+" PRId32, val);
+			be_emit_offset(val);
 		if (prefix)
 			be_emit_char(')');
 	} else {
-		be_emit_irprintf("%" PRId32, val);
+		be_emit_signed(val);
 	}
 }
 
@@ -22,6 +22,7 @@ our %init_attr;
 our $custom_init_attr_func;
 our %reg_classes;
 our %custom_irn_flags;
+our @execution_units;
 
 # include spec file
 unless (my $return = do "${specfile}") {
@@ -52,6 +53,7 @@ my %requirements = ();
 my %limit_bitsets = ();
 my %reg2class = ();
 my %regclass2len = ();
+my %unit2bit = ();
 
 # build register->class hashes
 foreach my $class_name (sort(keys(%reg_classes))) {
@@ -70,6 +72,15 @@ foreach my $class_name (sort(keys(%reg_classes))) {
 }
 
 
+# build execution unit->bit hash for the machine model
+{
+	my $bit = 0;
+	foreach my $unit (@execution_units) {
+		$unit2bit{$unit} = $bit++;
+	}
+	die "Fatal error: too many execution units" if $bit > 32;
+}
+
 $obst_header .= <<EOF;
 void ${arch}_create_opcodes(void);
 void ${arch}_free_opcodes(void);
@@ -547,6 +558,17 @@ EOF
 	if (defined(my $op_attr_init = $n{op_attr_init})) {
 		$obst_new_irop .= "\t$op_attr_init\n";
 	}
+	if (defined(my $latency = $n{latency})) {
+		my $throughput = $n{throughput} // 1;
+		my $units      = 0;
+		foreach my $unit (@{ $n{units} // [] }) {
+			my $bit = $unit2bit{$unit};
+			die "Fatal error: unknown execution unit '$unit' in opcode $op" if !defined($bit);
+			$units |= 1 << $bit;
+		}
+		$units = sprintf("0x%X", $units);
+		$obst_new_irop .= "\tarch_set_op_machine_info(op, $latency, $throughput, $units);\n";
+	}
 	$obst_new_irop .= "\top_$op = op;\n";
 
 	$obst_free_irop .= "\tfree_ir_op(op_$op); op_$op = NULL;\n";
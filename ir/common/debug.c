@@ -18,6 +18,7 @@
 #include "debug.h"
 
 #include "hashptr.h"
+#include "irthread.h"
 #include "obst.h"
 #include "set.h"
 
@@ -61,10 +62,13 @@ firm_dbg_module_t *firm_dbg_register(const char *name)
   mod.name = name;
   mod.file = stderr;
 
+  ir_lock();
   if (!module_set)
     firm_dbg_init();
 
-  return set_insert(firm_dbg_module_t, module_set, &mod, sizeof(mod), hash_str(name));
+  firm_dbg_module_t *res = set_insert(firm_dbg_module_t, module_set, &mod, sizeof(mod), hash_str(name));
+  ir_unlock();
+  return res;
 }
 
 void firm_dbg_set_mask(firm_dbg_module_t *module, unsigned mask)
@@ -0,0 +1,32 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Global lock for program wide state.
+ */
+#include "irthread.h"
+
+#include <assert.h>
+#include <pthread.h>
+
+bool ir_threads_active;
+
+static pthread_mutex_t global_lock = PTHREAD_MUTEX_INITIALIZER;
+/** How often the current thread holds the global lock. */
+static FIRM_THREAD_LOCAL unsigned lock_depth;
+
+void ir_lock_acquire(void)
+{
+	if (lock_depth++ == 0)
+		pthread_mutex_lock(&global_lock);
+}
+
+void ir_lock_release(void)
+{
+	assert(lock_depth > 0);
+	if (--lock_depth == 0)
+		pthread_mutex_unlock(&global_lock);
+}
@@ -0,0 +1,47 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Protection of program wide state while graphs are optimized in
+ *          parallel.
+ *
+ * Graph passes of a parallel pipeline (see run_parallel_pipeline()) run on
+ * several threads at once. State that is private to a pass lives in
+ * FIRM_THREAD_LOCAL variables. Program wide tables (identifiers, tarvals,
+ * modes, types and entities, node numbers) are modified under a global
+ * lock, which is only taken while such a pipeline is running.
+ */
+#ifndef FIRM_COMMON_IRTHREAD_H
+#define FIRM_COMMON_IRTHREAD_H
+
+#include <stdbool.h>
+
+#include "compiler.h"
+
+/** Set while graph passes run on more than one thread. */
+extern bool ir_threads_active;
+
+/** Acquire the global lock, which may be taken recursively. */
+void ir_lock_acquire(void);
+
+/** Release the global lock. */
+void ir_lock_release(void);
+
+/** Lock the program wide state if other threads may access it. */
+static inline void ir_lock(void)
+{
+	if (UNLIKELY(ir_threads_active))
+		ir_lock_acquire();
+}
+
+/** Counterpart of ir_lock(). */
+static inline void ir_unlock(void)
+{
+	if (UNLIKELY(ir_threads_active))
+		ir_lock_release();
+}
+
+#endif
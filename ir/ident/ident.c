@@ -11,6 +11,7 @@
 #include "ident_t.h"
 
 #include "hashptr.h"
+#include "irthread.h"
 #include "obst.h"
 #include "set.h"
 #include <stdio.h>
@@ -30,8 +31,10 @@ void init_ident(void)
 
 ident *new_id_from_chars(const char *str, size_t len)
 {
-	unsigned   hash   = hash_data((const unsigned char*)str, len);
+	unsigned hash = hash_data((const unsigned char*)str, len);
+	ir_lock();
 	set_entry *result = set_hinsert0(id_set, str, len, hash);
+	ir_unlock();
 	return (ident*)result->dptr;
 }
 
@@ -53,9 +56,12 @@ ident *new_id_fmt(char const *const fmt, ...)
 {
 	va_list ap;
 	va_start(ap, fmt);
+	ir_lock();
 	obstack_vprintf(&id_obst, fmt, ap);
 	va_end(ap);
-	return new_ident_from_obst(&id_obst);
+	ident *const res = new_ident_from_obst(&id_obst);
+	ir_unlock();
+	return res;
 }
 
 const char *(get_id_str)(ident *id)
@@ -73,5 +79,8 @@ void finish_ident(void)
 ident *id_unique(const char *tag)
 {
 	static unsigned unique_id = 0;
-	return new_id_fmt("%s.%u", tag, unique_id++);
+	ir_lock();
+	ident *const res = new_id_fmt("%s.%u", tag, unique_id++);
+	ir_unlock();
+	return res;
 }
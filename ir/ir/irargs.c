@@ -17,6 +17,7 @@
 #include "irloop_t.h"
 #include "irnode_t.h"
 #include "irprintf.h"
+#include "irthread.h"
 #include "lc_printf.h"
 #include "tv_t.h"
 #include "util.h"
@@ -294,6 +295,7 @@ lc_arg_env_t *firm_get_arg_env(void)
 	};
 
 	static lc_arg_env_t *env = NULL;
+	ir_lock();
 	if (env == NULL) {
 		env = lc_arg_new_env();
 		lc_arg_add_std(env);
@@ -308,6 +310,7 @@ lc_arg_env_t *firm_get_arg_env(void)
 		lc_arg_register(env, "firm:bitset",   'B', &bitset_handler);
 		lc_arg_register(env, "firm:pnc",      '=', &pnc_handler);
 	}
+	ir_unlock();
 
 	return env;
 }
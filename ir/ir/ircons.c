@@ -224,14 +224,18 @@ void mature_immBlock(ir_node *block)
 		size_t                n_preds = ARR_LEN(block->in) - 1;
 		if (n_preds == 0) {
 			n_preds   = 1;
-			new_in    = NEW_ARR_D(ir_node*, obst, 2);
+			new_in    = new_irn_in_array(irg, 1);
 			new_in[0] = NULL;
 			new_in[1] = new_r_Bad(irg, mode_X);
 		} else {
-			new_in = DUP_ARR_D(ir_node*, obst, block->in);
+			new_in = new_irn_in_array(irg, n_preds);
+			MEMCPY(new_in, block->in, n_preds + 1);
 		}
 		DEL_ARR_F(block->in);
 		block->in                     = new_in;
+#ifdef FIRM_COMPACT_NODES
+		block->arity                  = n_preds;
+#endif
 		block->attr.block.backedge    = new_backedge_arr(obst, n_preds);
 		block->attr.block.dynamic_ins = false;
 	}
@@ -370,6 +374,7 @@ void add_immBlock_pred(ir_node *block, ir_node *jmp)
 	assert(jmp->kind == k_ir_node);
 
 	ARR_APP1(ir_node *, block->in, jmp);
+	update_irn_arity(block);
 }
 
 void set_cur_block(ir_node *target)
@@ -121,7 +121,7 @@ static ir_dump_flags_t flags =
 static ird_color_t overrule_nodecolor = ird_color_default_node;
 
 /** The vcg node attribute hook. */
-static dump_node_vcgattr_func dump_node_vcgattr_hook = NULL;
+static FIRM_THREAD_LOCAL dump_node_vcgattr_func dump_node_vcgattr_hook = NULL;
 /** The vcg edge attribute hook. */
 static dump_edge_vcgattr_func dump_edge_vcgattr_hook = NULL;
 /** The vcg dump block edge hook */
@@ -1328,6 +1328,8 @@ static void dump_graph_info(FILE *F, ir_graph *irg)
 		fprintf(F, " consistent_loopinfo");
 	if (irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE))
 		fprintf(F, " consistent_entity_usage");
+	if (irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_ORACLE))
+		fprintf(F, " consistent_alias_oracle");
 	if (irg_has_properties(irg, IR_GRAPH_PROPERTY_MANY_RETURNS))
 		fprintf(F, " many_returns");
 	fprintf(F, "\"\n");
@@ -21,6 +21,7 @@
 #include "irprog_t.h"
 #include "panic.h"
 #include "tv_t.h"
+#include "util.h"
 #include <stdbool.h>
 #include <stdlib.h>
 
@@ -490,6 +491,17 @@ static void dump_ir_initializers_to_file(FILE *const F, const char *const prefix
 			}
 		}
 		break;
+	case IR_INITIALIZER_BYTES: {
+		/* only show the start of large blobs */
+		size_t               const size = get_initializer_bytes_size(initializer);
+		unsigned char const *const data = get_initializer_bytes_data(initializer);
+		fprintf(F, "\t = <BYTES %zu>", size);
+		for (size_t i = 0, n = MIN(size, 16); i != n; ++i)
+			fprintf(F, " %02x", data[i]);
+		if (size > 16)
+			fprintf(F, " ...");
+		break;
+	}
 	default:
 		panic("invalid ir_initializer kind found");
 	}
@@ -632,7 +632,7 @@ int edges_verify_kind(ir_graph *irg, ir_edge_kind_t kind)
 	return w.fine;
 }
 
-static ir_nodemap usermap;
+static FIRM_THREAD_LOCAL ir_nodemap usermap;
 
 /**
  * Initializes the user node map for each node.
@@ -755,6 +755,8 @@ void edges_deactivate(ir_graph *irg)
 
 void assure_edges(ir_graph *irg)
 {
+	if (irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES))
+		irg_count_assure_hits(IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
 	assure_edges_kind(irg, EDGE_KIND_BLOCK);
 	assure_edges_kind(irg, EDGE_KIND_NORMAL);
 	add_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
@@ -20,7 +20,7 @@
 #define ON   -1
 #define OFF   0
 
-optimization_state_t libFIRM_opt =
+FIRM_THREAD_LOCAL optimization_state_t libFIRM_opt =
 #define FLAG(name, value, def)   (irf_##name & def) |
 #include "irflag_t.def"
 #undef FLAG
@@ -69,8 +69,8 @@ void all_optimizations_off(void)
 	libFIRM_opt = 0;
 }
 
-static const lc_opt_table_entry_t firm_flags[] = {
-#define FLAG(name, val, def) LC_OPT_ENT_BIT(#name, #name, &libFIRM_opt, (1 << val)),
+static lc_opt_table_entry_t firm_flags[] = {
+#define FLAG(name, val, def) LC_OPT_ENT_BIT(#name, #name, NULL, (1 << val)),
 #include "irflag_t.def"
 #undef FLAG
 	LC_OPT_LAST
@@ -78,6 +78,10 @@ static const lc_opt_table_entry_t firm_flags[] = {
 
 void firm_init_flags(void)
 {
+	/* The flags are thread local, their address is only known at runtime. */
+	for (lc_opt_table_entry_t *entry = firm_flags; entry->name != NULL; ++entry)
+		entry->value = &libFIRM_opt;
+
 	lc_opt_entry_t *grp = lc_opt_get_grp(firm_opt_get_root(), "opt");
 	lc_opt_add_table(grp, firm_flags);
 }
@@ -13,6 +13,8 @@
 
 #include "irflag.h"
 
+#include "compiler.h"
+
 #define get_opt_cse()                      get_opt_cse_()
 #define get_optimize()                     get_optimize_()
 #define get_opt_constant_folding()         get_opt_constant_folding_()
@@ -29,7 +31,8 @@ typedef enum {
 #undef FLAG
 } libfirm_opts_t;
 
-extern optimization_state_t libFIRM_opt;
+/** The flags are per thread, see run_parallel_pipeline(). */
+extern FIRM_THREAD_LOCAL optimization_state_t libFIRM_opt;
 
 /** initialises the flags */
 void firm_init_flags(void);
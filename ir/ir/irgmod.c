@@ -17,6 +17,7 @@
 #include "irgraph_t.h"
 #include "irgwalk.h"
 #include "irhooks.h"
+#include "irmemory_t.h"
 #include "irnode_t.h"
 #include "irtools.h"
 #include "panic.h"
@@ -57,6 +58,10 @@ void exchange(ir_node *old, ir_node *nw)
 
 	hook_replace(old, nw);
 
+	/* The loop information only covers blocks and the control flow nodes
+	 * connecting them. */
+	bool const changes_cfg = is_Block(old) || get_irn_mode(old) == mode_X;
+
 	/* If new outs are on, we can skip the id node creation and reroute
 	 * the edges from the old node to the new directly. */
 	if (edges_activated(irg)) {
@@ -77,15 +82,21 @@ void exchange(ir_node *old, ir_node *nw)
 		if (is_irn_dynamic(old))
 			DEL_ARR_F(old->in);
 
-		old->op    = op_Id;
-		old->in    = NEW_ARR_D(ir_node*, get_irg_obstack(irg), 2);
+		set_irn_op(old, op_Id);
+		old->in    = new_irn_in_array(irg, 1);
 		old->in[0] = block;
 		old->in[1] = nw;
+#ifdef FIRM_COMPACT_NODES
+		old->arity = 1;
+#endif
 	}
 
+	ir_alias_oracle_exchanged(irg, old);
+
 	/* update irg flags */
-	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS
-	                        | IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
+	if (changes_cfg)
+		clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
 }
 
 static void collect_new_start_block_node_(ir_node *node)
@@ -19,7 +19,7 @@
 #include "irgopt.h"
 #include "irgwalk.h"
 #include "irhooks.h"
-#include "irmemory.h"
+#include "irmemory_t.h"
 #include "irnode_t.h"
 #include "iropt_t.h"
 #include "iroptimize.h"
@@ -59,7 +59,11 @@ static ir_graph *alloc_graph(void)
 	res->kind = k_ir_graph;
 
 	/* initialize the idx->node map. */
-	res->idx_irn_map = NEW_ARR_FZ(ir_node*, INITIAL_IDX_IRN_MAP_SIZE);
+	res->idx_irn_map     = NEW_ARR_FZ(ir_node*, INITIAL_IDX_IRN_MAP_SIZE);
+	res->idx_alloc_class = NEW_ARR_FZ(unsigned char, INITIAL_IDX_IRN_MAP_SIZE);
+#ifdef FIRM_COMPACT_NODES
+	res->node_cold       = NEW_ARR_FZ(ir_node_cold_t, INITIAL_IDX_IRN_MAP_SIZE);
+#endif
 
 	obstack_init(&res->obst);
 
@@ -77,6 +81,10 @@ static void free_graph(ir_graph *irg)
 	for (ir_edge_kind_t i = EDGE_KIND_FIRST; i <= EDGE_KIND_LAST; ++i)
 		edges_deactivate_kind(irg, i);
 	DEL_ARR_F(irg->idx_irn_map);
+	DEL_ARR_F(irg->idx_alloc_class);
+#ifdef FIRM_COMPACT_NODES
+	DEL_ARR_F(irg->node_cold);
+#endif
 	free(irg);
 }
 
@@ -275,6 +283,7 @@ void free_ir_graph(ir_graph *irg)
 	confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_NONE);
 
 	free_irg_outs(irg);
+	free_irg_points_to(irg);
 	del_identities(irg);
 	if (irg->ent) {
 		set_entity_irg(irg->ent, NULL);  /* not set in const code irg */
@@ -460,17 +469,21 @@ static ir_visited_t max_irg_visited = 0;
 void set_irg_visited(ir_graph *irg, ir_visited_t visited)
 {
 	irg->visited = visited;
+	ir_lock();
 	if (irg->visited > max_irg_visited) {
 		max_irg_visited = irg->visited;
 	}
+	ir_unlock();
 }
 
 void inc_irg_visited(ir_graph *irg)
 {
 	++irg->visited;
+	ir_lock();
 	if (irg->visited > max_irg_visited) {
 		max_irg_visited = irg->visited;
 	}
+	ir_unlock();
 }
 
 ir_visited_t get_max_irg_visited(void)
@@ -544,6 +557,40 @@ unsigned get_irg_last_idx(const ir_graph *irg)
 	return irg->last_node_idx;
 }
 
+void *irg_alloc_node_memory(ir_graph *irg, size_t size,
+                            unsigned char *alloc_class)
+{
+	size_t const cls = (size + NODE_ALLOC_GRANULE - 1) / NODE_ALLOC_GRANULE;
+	if (cls >= N_NODE_ALLOC_CLASSES) {
+		*alloc_class = 0;
+		return OALLOCNZ(&irg->obst, char, size);
+	}
+
+	/* Allocate the whole class size, so the memory fits any node of this
+	 * class once it is recycled. */
+	size_t const chunk_size = cls * NODE_ALLOC_GRANULE;
+	void        *res        = irg->free_nodes[cls];
+	if (res != NULL) {
+		irg->free_nodes[cls] = *(void**)res;
+		*alloc_class         = (unsigned char)cls | NODE_ALLOC_RECYCLED;
+	} else {
+		res          = OALLOCN(&irg->obst, char, chunk_size);
+		*alloc_class = (unsigned char)cls;
+	}
+	return memset(res, 0, chunk_size);
+}
+
+void irg_free_node_memory(ir_graph *irg, ir_node *node)
+{
+	unsigned const cls
+		= irg->idx_alloc_class[get_irn_idx(node)] & ~NODE_ALLOC_RECYCLED;
+	if (cls == 0)
+		return;
+	/* The first word of a free node links the free list. */
+	*(void**)node        = irg->free_nodes[cls];
+	irg->free_nodes[cls] = node;
+}
+
 void add_irg_constraints(ir_graph *irg, ir_graph_constraints_t constraints)
 {
 	irg->constraints |= constraints;
@@ -574,6 +621,10 @@ int (irg_has_properties)(const ir_graph *irg, ir_graph_properties_t props)
 	return irg_has_properties_(irg, props);
 }
 
+FIRM_THREAD_LOCAL unsigned *irg_assure_hits;
+COMPILETIME_ASSERT((IR_GRAPH_PROPERTIES_ALL >> IR_GRAPH_N_PROPERTIES) == 0,
+                   graph_properties_fit)
+
 typedef void (*assure_property_func)(ir_graph *irg);
 
 void assure_irg_properties(ir_graph *irg, ir_graph_properties_t props)
@@ -595,7 +646,9 @@ void assure_irg_properties(ir_graph *irg, ir_graph_properties_t props)
 		{ IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO,      assure_loopinfo },
 		{ IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE,  assure_irg_entity_usage_computed },
 		{ IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE_FRONTIERS, ir_compute_dominance_frontiers },
+		{ IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_ORACLE,  ir_compute_alias_oracle },
 	};
+	irg_count_assure_hits(props & irg->properties);
 	for (size_t i = 0; i < ARRAY_SIZE(property_functions); ++i) {
 		ir_graph_properties_t missing = props & ~irg->properties;
 		if (missing & property_functions[i].property)
@@ -612,8 +665,13 @@ void confirm_irg_properties(ir_graph *irg, ir_graph_properties_t props)
 	if (!(props & IR_GRAPH_PROPERTY_CONSISTENT_OUTS)
 	    && (irg->properties & IR_GRAPH_PROPERTY_CONSISTENT_OUTS))
 	    free_irg_outs(irg);
-	if (!(props & IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE))
+	/* A parallel pipeline computes the entity usage before its graph passes
+	 * run and invalidates it afterwards. */
+	if (!(props & IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE)
+	    && !ir_threads_active)
 		set_irp_globals_entity_usage_state(ir_entity_usage_not_computed);
 	if (!(props & IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE_FRONTIERS))
 		ir_free_dominance_frontiers(irg);
+	if (!(props & IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_ORACLE))
+		ir_free_alias_oracle(irg);
 }
@@ -13,6 +13,7 @@
 
 #include "irgraph.h"
 
+#include "compiler.h"
 #include "entity_t.h"
 #include "firm_types.h"
 #include "iredgekinds.h"
@@ -99,6 +100,27 @@ typedef struct ir_vrp_info {
 	struct obstack    obst;
 } ir_vrp_info;
 
+#ifdef FIRM_COMPACT_NODES
+/**
+ * Rarely used node data, which the compact node layout keeps in a side table
+ * of the graph indexed by the node index.
+ */
+typedef struct ir_node_cold_t {
+	long     node_nr; /**< Globally unique node number. */
+	ir_loop *loop;    /**< Loop information. */
+} ir_node_cold_t;
+#endif
+
+/** Granularity of node allocations in bytes. */
+#define NODE_ALLOC_GRANULE   8
+/**
+ * Number of node size classes. Class c holds nodes of c * NODE_ALLOC_GRANULE
+ * bytes, class 0 marks larger nodes, which are never recycled.
+ */
+#define N_NODE_ALLOC_CLASSES 128
+/** Marks a node whose memory came from a free list instead of the obstack. */
+#define NODE_ALLOC_RECYCLED  0x80
+
 /**
  * An ir_graph represents the code of a function as a graph of nodes.
  */
@@ -124,6 +146,13 @@ struct ir_graph {
 	ir_visited_t     block_visited; /**< Visited flag for block nodes. */
 	ir_visited_t     self_visited;  /**< Visited flag of the irg */
 	ir_node        **idx_irn_map;   /**< Map of node indexes to nodes. */
+#ifdef FIRM_COMPACT_NODES
+	ir_node_cold_t  *node_cold;     /**< Cold node data, indexed like idx_irn_map. */
+#endif
+	/** Allocation size class of each node, indexed like idx_irn_map. */
+	unsigned char   *idx_alloc_class;
+	/** Free lists of node memory, one per size class. */
+	void            *free_nodes[N_NODE_ALLOC_CLASSES];
 	size_t           index;         /**< a unique number for each graph */
 	/** A void* field to link any information to the graph. */
 	void            *link;
@@ -145,6 +174,8 @@ struct ir_graph {
 	ir_vrp_info         vrp;         /**< vrp info */
 	ir_loop            *loop;        /**< The outermost loop for this graph. */
 	ir_dom_front_info_t domfront;    /**< dominance frontier analysis data */
+	struct ir_alias_oracle *alias_oracle; /**< cached alias queries */
+	struct ir_nodemap   points_to;   /**< points-to sets of the addresses */
 	irg_edges_info_t    edge_info;   /**< edge info for automatic outs */
 	ir_graph          **callers;     /**< Callgraph: list of callers. */
 	unsigned           *caller_isbe; /**< Callgraph: bitset if backedge info is
@@ -403,6 +434,27 @@ static inline int irg_has_properties_(const ir_graph *irg,
 	return (irg->properties & props) == props;
 }
 
+/** Number of bits used by ir_graph_properties_t. */
+#define IR_GRAPH_N_PROPERTIES 14
+
+/**
+ * Counters of the assure functions of the current thread which found a
+ * property already valid, indexed by the bit number of the property. NULL if
+ * nobody counts.
+ */
+extern FIRM_THREAD_LOCAL unsigned *irg_assure_hits;
+
+/** Records that an assure function found the properties @p props valid. */
+static inline void irg_count_assure_hits(ir_graph_properties_t props)
+{
+	if (irg_assure_hits == NULL)
+		return;
+	for (unsigned i = 0; props != 0; ++i, props >>= 1) {
+		if (props & 1)
+			++irg_assure_hits[i];
+	}
+}
+
 #ifndef NDEBUG
 static inline void ir_reserve_resources_(ir_graph *irg,
                                          ir_resources_t resources)
@@ -440,19 +492,46 @@ static inline ir_resources_t ir_resources_reserved_(const ir_graph *irg)
 }
 #endif
 
+/**
+ * Allocates zeroed memory for a node of @p size bytes. Memory of dead nodes
+ * released by irg_free_node_memory() is reused before the obstack grows.
+ * @param irg         The graph.
+ * @param size        The size of the node in bytes.
+ * @param alloc_class Receives the allocation class to pass to
+ *                    irg_register_node_idx().
+ */
+void *irg_alloc_node_memory(ir_graph *irg, size_t size,
+                            unsigned char *alloc_class);
+
+/**
+ * Puts the memory of the dead node @p node onto the free list of its size
+ * class. The node must not be referenced anymore.
+ */
+void irg_free_node_memory(ir_graph *irg, ir_node *node);
+
 /**
  * Allocates a new idx in the irg for the node and adds the irn to the idx -> irn map.
- * @param irg The graph.
- * @param irn The node.
- * @return    The index allocated for the node.
+ * @param irg         The graph.
+ * @param irn         The node.
+ * @param alloc_class The allocation class returned by irg_alloc_node_memory().
+ * @return            The index allocated for the node.
  */
-static inline unsigned irg_register_node_idx(ir_graph *irg, ir_node *irn)
+static inline unsigned irg_register_node_idx(ir_graph *irg, ir_node *irn,
+                                             unsigned char alloc_class)
 {
 	unsigned idx = irg->last_node_idx++;
-	if (idx >= (unsigned)ARR_LEN(irg->idx_irn_map))
+	if (idx >= (unsigned)ARR_LEN(irg->idx_irn_map)) {
 		ARR_RESIZE(ir_node *, irg->idx_irn_map, idx + 1);
-
-	irg->idx_irn_map[idx] = irn;
+		ARR_RESIZE(unsigned char, irg->idx_alloc_class, idx + 1);
+	}
+
+	irg->idx_irn_map[idx]     = irn;
+	irg->idx_alloc_class[idx] = alloc_class;
+#ifdef FIRM_COMPACT_NODES
+	if (idx >= (unsigned)ARR_LEN(irg->node_cold))
+		ARR_RESIZE(ir_node_cold_t, irg->node_cold, idx + 1);
+	irg->node_cold[idx] = (ir_node_cold_t){ .node_nr = 0 };
+#endif
 	return idx;
 }
 
@@ -468,7 +547,11 @@ static inline void irg_kill_node(ir_graph *irg, ir_node *n)
 	if (idx + 1 == irg->last_node_idx)
 		--irg->last_node_idx;
 	irg->idx_irn_map[idx] = NULL;
-	obstack_free(&irg->obst, n);
+	/* A recycled node is not at the top of the obstack. */
+	if (irg->idx_alloc_class[idx] & NODE_ALLOC_RECYCLED)
+		irg_free_node_memory(irg, n);
+	else
+		obstack_free(&irg->obst, n);
 }
 
 /**
@@ -484,6 +567,17 @@ static inline ir_node *get_idx_irn_(const ir_graph *irg, unsigned idx)
 	return irg->idx_irn_map[idx];
 }
 
+#ifdef FIRM_COMPACT_NODES
+/**
+ * Get the cold data of a node. Note that the entry is shared with any later
+ * node, which gets the same index, e.g. after the graph was copied.
+ */
+static inline ir_node_cold_t *get_irn_cold(const ir_node *node)
+{
+	return &node->irg->node_cold[node->node_idx];
+}
+#endif
+
 /**
  * Get the anchor.
  */
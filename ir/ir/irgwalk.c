@@ -376,6 +376,7 @@ static void walk_initializer(ir_initializer_t *initializer, walk_env *env)
         return;
     case IR_INITIALIZER_TARVAL:
     case IR_INITIALIZER_NULL:
+    case IR_INITIALIZER_BYTES:
         return;
 
     case IR_INITIALIZER_COMPOUND:
@@ -18,11 +18,16 @@
 #include "irgwalk.h"
 #include "irprintf.h"
 #include "irprog_t.h"
+#include "irtools.h"
+#include "lc_opts.h"
 #include "obst.h"
 #include "panic.h"
+#include "platform_t.h"
 #include "pmap.h"
+#include "target_t.h"
 #include "tv_t.h"
 #include "util.h"
+#include "xmalloc.h"
 #include <ctype.h>
 #include <stdarg.h>
 #include <stdbool.h>
@@ -30,6 +35,10 @@
 
 #define SYMERROR ((unsigned) ~0)
 
+/* 64 bit FNV-1a parameters for fingerprints */
+#define FINGERPRINT_OFFSET_BASIS 14695981039346656037ULL
+#define FINGERPRINT_PRIME        1099511628211ULL
+
 typedef enum typetag_t {
 	tt_align,
 	tt_builtin_kind,
@@ -250,6 +259,7 @@ static void symtbl_init(void)
 	INSERTENUM(tt_initializer, IR_INITIALIZER_TARVAL);
 	INSERTENUM(tt_initializer, IR_INITIALIZER_NULL);
 	INSERTENUM(tt_initializer, IR_INITIALIZER_COMPOUND);
+	INSERTENUM(tt_initializer, IR_INITIALIZER_BYTES);
 
 	INSERT(tt_mode_arithmetic, "none",               irma_none);
 	INSERT(tt_mode_arithmetic, "twos_complement",    irma_twos_complement);
@@ -318,37 +328,97 @@ static unsigned symbol(const char *str, typetag_t typetag)
 	return entry ? entry->code : SYMERROR;
 }
 
+/**
+ * Writes @p c to the output file or, when computing a fingerprint, mixes it
+ * into the hash.
+ */
+static void write_char(write_env_t *env, char c)
+{
+	if (env->file != NULL) {
+		fputc(c, env->file);
+	} else {
+		env->hash ^= (unsigned char)c;
+		env->hash *= FINGERPRINT_PRIME;
+	}
+}
+
+static void write_chars(write_env_t *env, char const *str)
+{
+	if (env->file != NULL) {
+		fputs(str, env->file);
+	} else {
+		for (char const *c = str; *c != '\0'; ++c)
+			write_char(env, *c);
+	}
+}
+
 void write_long(write_env_t *env, long value)
 {
-	fprintf(env->file, "%ld ", value);
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%ld ", value);
+	write_chars(env, buf);
 }
 
 void write_int(write_env_t *env, int value)
 {
-	fprintf(env->file, "%d ", value);
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%d ", value);
+	write_chars(env, buf);
 }
 
 void write_unsigned(write_env_t *env, unsigned value)
 {
-	fprintf(env->file, "%u ", value);
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%u ", value);
+	write_chars(env, buf);
 }
 
 void write_size_t(write_env_t *env, size_t value)
 {
-	ir_fprintf(env->file, "%zu ", value);
+	char buf[32];
+	ir_snprintf(buf, sizeof(buf), "%zu ", value);
+	write_chars(env, buf);
 }
 
 void write_symbol(write_env_t *env, const char *symbol)
 {
-	fputs(symbol, env->file);
-	fputc(' ', env->file);
+	write_chars(env, symbol);
+	write_char(env, ' ');
+}
+
+/**
+ * Writes the number @p nr of @p thing. A fingerprint numbers things in the
+ * order they are first referenced instead, so it does not depend on how many
+ * nodes, types and entities were created before.
+ *
+ * @return true if a fingerprint references @p thing for the first time
+ */
+static bool write_nr(write_env_t *env, void const *thing, long nr)
+{
+	bool first = false;
+	if (env->file == NULL) {
+		void *const canonical = pmap_get(void, env->numbers, thing);
+		if (canonical != NULL) {
+			nr = PTR_TO_INT(canonical);
+		} else {
+			nr    = ++env->n_numbers;
+			first = true;
+			pmap_insert(env->numbers, thing, INT_TO_PTR(nr));
+		}
+	}
+	write_long(env, nr);
+	return first;
 }
 
 void write_entity_ref(write_env_t *env, ir_entity *entity)
 {
-	write_long(env, get_entity_nr(entity));
+	/* a fingerprint also covers the description of referenced entities */
+	if (write_nr(env, entity, get_entity_nr(entity)))
+		deq_push_pointer_right(&env->entity_queue, entity);
 }
 
+static void write_type(write_env_t *env, ir_type *tp);
+
 void write_type_ref(write_env_t *env, ir_type *type)
 {
 	switch (get_type_opcode(type)) {
@@ -361,29 +431,31 @@ void write_type_ref(write_env_t *env, ir_type *type)
 	default:
 		break;
 	}
-	write_long(env, get_type_nr(type));
+	if (env->file == NULL)
+		write_type(env, type);
+	write_nr(env, type, get_type_nr(type));
 }
 
 void write_string(write_env_t *env, const char *string)
 {
-	fputc('"', env->file);
+	write_char(env, '"');
 	for (const char *c = string; *c != '\0'; ++c) {
 		switch (*c) {
 		case '\n':
-			fputc('\\', env->file);
-			fputc('n', env->file);
+			write_char(env, '\\');
+			write_char(env, 'n');
 			break;
 		case '"':
 		case '\\':
-			fputc('\\', env->file);
+			write_char(env, '\\');
 			/* FALLTHROUGH */
 		default:
-			fputc(*c, env->file);
+			write_char(env, *c);
 			break;
 		}
 	}
-	fputc('"', env->file);
-	fputc(' ', env->file);
+	write_char(env, '"');
+	write_char(env, ' ');
 }
 
 void write_ident(write_env_t *env, ident *id)
@@ -394,7 +466,7 @@ void write_ident(write_env_t *env, ident *id)
 void write_ident_null(write_env_t *env, ident *id)
 {
 	if (id == NULL) {
-		fputs("NULL ", env->file);
+		write_chars(env, "NULL ");
 	} else {
 		write_ident(env, id);
 	}
@@ -411,26 +483,26 @@ void write_tarval_ref(write_env_t *env, ir_tarval *tv)
 	write_mode_ref(env, mode);
 	char buf[128];
 	const char *ascii = ir_tarval_to_ascii(buf, sizeof(buf), tv);
-	fputs(ascii, env->file);
-	fputc(' ', env->file);
+	write_chars(env, ascii);
+	write_char(env, ' ');
 }
 
 void write_align(write_env_t *env, ir_align align)
 {
-	fputs(get_align_name(align), env->file);
-	fputc(' ', env->file);
+	write_chars(env, get_align_name(align));
+	write_char(env, ' ');
 }
 
 void write_builtin_kind(write_env_t *env, ir_builtin_kind kind)
 {
-	fputs(get_builtin_kind_name(kind), env->file);
-	fputc(' ', env->file);
+	write_chars(env, get_builtin_kind_name(kind));
+	write_char(env, ' ');
 }
 
 void write_cond_jmp_predicate(write_env_t *env, cond_jmp_predicate pred)
 {
-	fputs(get_cond_jmp_predicate_name(pred), env->file);
-	fputc(' ', env->file);
+	write_chars(env, get_cond_jmp_predicate_name(pred));
+	write_char(env, ' ');
 }
 
 void write_relation(write_env_t *env, ir_relation relation)
@@ -450,37 +522,36 @@ void write_loop(write_env_t *env, bool loop)
 
 static void write_list_begin(write_env_t *env)
 {
-	fputs("[", env->file);
+	write_chars(env, "[");
 }
 
 static void write_list_end(write_env_t *env)
 {
-	fputs("] ", env->file);
+	write_chars(env, "] ");
 }
 
 static void write_scope_begin(write_env_t *env)
 {
-	fputs("{\n", env->file);
+	write_chars(env, "{\n");
 }
 
 static void write_scope_end(write_env_t *env)
 {
-	fputs("}\n\n", env->file);
+	write_chars(env, "}\n\n");
 }
 
 void write_node_ref(write_env_t *env, const ir_node *node)
 {
-	write_long(env, get_irn_node_nr(node));
+	write_nr(env, node, get_irn_node_nr(node));
 }
 
 void write_initializer(write_env_t *const env,
                        ir_initializer_t const *const ini)
 {
-	FILE *f = env->file;
 	ir_initializer_kind_t ini_kind = get_initializer_kind(ini);
 
-	fputs(get_initializer_kind_name(ini_kind), f);
-	fputc(' ', f);
+	write_chars(env, get_initializer_kind_name(ini_kind));
+	write_char(env, ' ');
 
 	switch (ini_kind) {
 	case IR_INITIALIZER_CONST:
@@ -501,45 +572,60 @@ void write_initializer(write_env_t *const env,
 			write_initializer(env, get_initializer_compound_value(ini, i));
 		return;
 	}
+
+	case IR_INITIALIZER_BYTES: {
+		/* the data is written as one string of hex digits */
+		static char const hex[] = "0123456789abcdef";
+		size_t               const size = get_initializer_bytes_size(ini);
+		unsigned char const *const data = get_initializer_bytes_data(ini);
+		write_size_t(env, size);
+		write_char(env, '"');
+		for (size_t i = 0; i < size; ++i) {
+			write_char(env, hex[data[i] >> 4]);
+			write_char(env, hex[data[i] & 0xF]);
+		}
+		write_chars(env, "\" ");
+		return;
+	}
 	}
 	panic("unknown initializer kind");
 }
 
 void write_pin_state(write_env_t *env, op_pin_state state)
 {
-	fputs(get_op_pin_state_name(state), env->file);
-	fputc(' ', env->file);
+	write_chars(env, get_op_pin_state_name(state));
+	write_char(env, ' ');
 }
 
 void write_volatility(write_env_t *env, ir_volatility vol)
 {
-	fputs(get_volatility_name(vol), env->file);
-	fputc(' ', env->file);
+	write_chars(env, get_volatility_name(vol));
+	write_char(env, ' ');
 }
 
 static void write_type_state(write_env_t *env, ir_type_state state)
 {
-	fputs(get_type_state_name(state), env->file);
-	fputc(' ', env->file);
+	write_chars(env, get_type_state_name(state));
+	write_char(env, ' ');
 }
 
 void write_visibility(write_env_t *env, ir_visibility visibility)
 {
-	fputs(get_visibility_name(visibility), env->file);
-	fputc(' ', env->file);
+	write_chars(env, get_visibility_name(visibility));
+	write_char(env, ' ');
 }
 
 static void write_mode_arithmetic(write_env_t *env, ir_mode_arithmetic arithmetic)
 {
-	fputs(get_mode_arithmetic_name(arithmetic), env->file);
-	fputc(' ', env->file);
+	write_chars(env, get_mode_arithmetic_name(arithmetic));
+	write_char(env, ' ');
 }
 
 static void write_type_common(write_env_t *env, ir_type *tp)
 {
-	fputc('\t', env->file);
+	write_char(env, '\t');
 	write_symbol(env, "type");
-	write_long(env, get_type_nr(tp));
+	write_nr(env, tp, get_type_nr(tp));
 	write_symbol(env, get_type_opcode_name(get_type_opcode(tp)));
 	write_unsigned(env, get_type_size(tp));
 	write_unsigned(env, get_type_alignment(tp));
@@ -547,8 +633,6 @@ static void write_type_common(write_env_t *env, ir_type *tp)
 	write_unsigned(env, tp->flags);
 }
 
-static void write_type(write_env_t *env, ir_type *tp);
-
 static bool is_internal_mode(ir_mode *mode)
 {
 	return !mode_is_int(mode) && !mode_is_reference(mode)
@@ -571,12 +655,22 @@ static void write_type_primitive(write_env_t *env, ir_type *tp)
 
 	write_type_common(env, tp);
 	write_mode_ref(env, mode);
-	fputc('\n', env->file);
+	write_char(env, '\n');
 }
 
 static void write_type_compound(write_env_t *env, ir_type *tp)
 {
-	if (is_Class_type(tp)) {
+	if (env->file == NULL && is_segment_type(tp)) {
+		/* For a fingerprint the members of a segment are unrelated globals,
+		 * referenced entities are described individually. */
+		write_char(env, '\t');
+		write_symbol(env, "segment");
+		write_nr(env, tp, get_type_nr(tp));
+		write_ident_null(env, get_compound_ident(tp));
+		write_char(env, '\n');
+		return;
+	}
+	if (is_Class_type(tp) && env->file != NULL) {
 		if (get_class_n_subtypes(tp) > 0 || get_class_n_supertypes(tp) > 0) {
 			/* sub/superclass export not implemented yet, it's unclear whether
 			 * class types will stay in libfirm anyway */
@@ -585,7 +679,7 @@ static void write_type_compound(write_env_t *env, ir_type *tp)
 	}
 	write_type_common(env, tp);
 	write_ident_null(env, get_compound_ident(tp));
-	fputc('\n', env->file);
+	write_char(env, '\n');
 
 	for (size_t i = 0, n = get_compound_n_members(tp); i < n; ++i) {
 		ir_entity *member = get_compound_member(tp, i);
@@ -601,7 +695,7 @@ static void write_type_array(write_env_t *env, ir_type *tp)
 	write_type_common(env, tp);
 	write_type_ref(env, element_type);
 	write_unsigned(env, get_array_size(tp));
-	fputc('\n', env->file);
+	write_char(env, '\n');
 }
 
 static void write_type_method(write_env_t *env, ir_type *tp)
@@ -623,7 +717,7 @@ static void write_type_method(write_env_t *env, ir_type *tp)
 		write_type_ref(env, get_method_param_type(tp, i));
 	for (size_t i = 0; i < nresults; i++)
 		write_type_ref(env, get_method_res_type(tp, i));
-	fputc('\n', env->file);
+	write_char(env, '\n');
 }
 
 static void write_type_pointer(write_env_t *env, ir_type *tp)
@@ -634,7 +728,7 @@ static void write_type_pointer(write_env_t *env, ir_type *tp)
 
 	write_type_common(env, tp);
 	write_type_ref(env, points_to);
-	fputc('\n', env->file);
+	write_char(env, '\n');
 }
 
 static void write_type(write_env_t *env, ir_type *tp)
@@ -683,7 +777,7 @@ static void write_entity(write_env_t *env, ir_entity *ent)
 		write_entity(env, aliased);
 	}
 
-	fputc('\t', env->file);
+	write_char(env, '\t');
 	switch ((ir_entity_kind)ent->kind) {
 	case IR_ENTITY_ALIAS:           write_symbol(env, "alias");           break;
 	case IR_ENTITY_NORMAL:          write_symbol(env, "entity");          break;
@@ -693,12 +787,12 @@ static void write_entity(write_env_t *env, ir_entity *ent)
 	case IR_ENTITY_PARAMETER:       write_symbol(env, "parameter");       break;
 	case IR_ENTITY_UNKNOWN:
 		write_symbol(env, "unknown");
-		write_long(env, get_entity_nr(ent));
+		write_nr(env, ent, get_entity_nr(ent));
 		goto end_line;
 	case IR_ENTITY_SPILLSLOT:
 		panic("Unexpected entity %+F", ent); // Should only exist in backend
 	}
-	write_long(env, get_entity_nr(ent));
+	write_nr(env, ent, get_entity_nr(ent));
 
 	if (ent->kind != IR_ENTITY_LABEL && ent->kind != IR_ENTITY_PARAMETER) {
 		write_ident_null(env, get_entity_ident(ent));
@@ -737,7 +831,9 @@ static void write_entity(write_env_t *env, ir_entity *ent)
 		ir_initializer_t const *const init = get_entity_initializer(ent);
 		if (init) {
 			write_symbol(env, "initializer");
-			write_initializer(env, init);
+			/* code referencing the entity does not depend on its value */
+			if (env->file != NULL)
+				write_initializer(env, init);
 		} else {
 			write_symbol(env, "none");
 		}
@@ -771,7 +867,7 @@ static void write_entity(write_env_t *env, ir_entity *ent)
 	}
 
 end_line:
-	fputc('\n', env->file);
+	write_char(env, '\n');
 }
 
 void write_switch_table_ref(write_env_t *env, const ir_switch_table *table)
@@ -802,7 +898,7 @@ void write_pred_refs(write_env_t *env, const ir_node *node, int from)
 
 void write_node_nr(write_env_t *env, const ir_node *node)
 {
-	write_long(env, get_irn_node_nr(node));
+	write_nr(env, node, get_irn_node_nr(node));
 }
 
 static void write_ASM(write_env_t *env, const ir_node *node)
@@ -890,11 +986,15 @@ static void write_node(const ir_node *node, write_env_t *env)
 	ir_op           *const op   = get_irn_op(node);
 	write_node_func *const func = get_generic_function_ptr(write_node_func, op);
 
-	fputc('\t', env->file);
-	if (func == NULL)
-		panic("no write_node_func for %+F", node);
+	write_char(env, '\t');
+	if (func == NULL) {
+		if (env->file != NULL)
+			panic("no write_node_func for %+F", node);
+		env->incomplete = true;
+		return;
+	}
 	func(env, node);
-	fputc('\n', env->file);
+	write_char(env, '\n');
 }
 
 static void write_node_recursive(ir_node *node, write_env_t *env);
@@ -965,18 +1065,18 @@ static void write_mode(write_env_t *env, ir_mode *mode)
 static void write_modes(write_env_t *env)
 {
 	write_symbol(env, "modes");
-	fputs("{\n", env->file);
+	write_chars(env, "{\n");
 
 	for (size_t i = 0, n_modes = ir_get_n_modes(); i < n_modes; i++) {
 		ir_mode *mode = ir_get_mode(i);
 		if (is_internal_mode(mode))
 			continue;
-		fputc('\t', env->file);
+		write_char(env, '\t');
 		write_mode(env, mode);
-		fputc('\n', env->file);
+		write_char(env, '\n');
 	}
 
-	fputs("}\n\n", env->file);
+	write_chars(env, "}\n\n");
 }
 
 static void write_program(write_env_t *env)
@@ -984,15 +1084,15 @@ static void write_program(write_env_t *env)
 	write_symbol(env, "program");
 	write_scope_begin(env);
 	if (irp_prog_name_is_set()) {
-		fputc('\t', env->file);
+		write_char(env, '\t');
 		write_symbol(env, "name");
 		write_string(env, get_irp_name());
-		fputc('\n', env->file);
+		write_char(env, '\n');
 	}
 
 	for (ir_segment_t s = IR_SEGMENT_FIRST; s <= IR_SEGMENT_LAST; ++s) {
 		ir_type *segment_type = get_segment_type(s);
-		fputc('\t', env->file);
+		write_char(env, '\t');
 		write_symbol(env, "segment_type");
 		write_symbol(env, get_segment_name(s));
 		if (segment_type == NULL) {
@@ -1000,15 +1100,15 @@ static void write_program(write_env_t *env)
 		} else {
 			write_type_ref(env, segment_type);
 		}
-		fputc('\n', env->file);
+		write_char(env, '\n');
 	}
 
 	for (size_t i = 0, n_asms = get_irp_n_asms(); i < n_asms; ++i) {
 		ident *asm_text = get_irp_asm(i);
-		fputc('\t', env->file);
+		write_char(env, '\t');
 		write_symbol(env, "asm");
 		write_ident(env, asm_text);
-		fputc('\n', env->file);
+		write_char(env, '\n');
 	}
 	write_scope_end(env);
 }
@@ -1104,7 +1204,70 @@ void ir_export_file(FILE *file)
 	deq_free(&env->write_queue);
 }
 
+static void write_option(char const *name, char const *value, void *data)
+{
+	write_env_t *env = (write_env_t*)data;
+	write_string(env, name);
+	if (value != NULL)
+		write_string(env, value);
+}
+
+/**
+ * Writes everything besides the graph itself which influences the code
+ * generated for it.
+ */
+static void write_fingerprint_context(write_env_t *env)
+{
+	write_symbol(env, "libfirm");
+	write_unsigned(env, ir_get_version_major());
+	write_unsigned(env, ir_get_version_minor());
+	write_unsigned(env, ir_get_version_micro());
+	write_string(env, ir_get_version_revision());
+
+	write_symbol(env, "target");
+	write_string(env, ir_target.isa->name);
+	write_string(env, ir_target.experimental != NULL ? ir_target.experimental : "");
+	write_unsigned(env, ir_platform.object_format);
+	write_unsigned(env, ir_platform.pic_style);
+	write_unsigned(env, ir_platform.is_darwin);
+	write_unsigned(env, ir_platform.amd64_x64abi);
+	write_unsigned(env, ir_platform.ia32_struct_in_regs);
+	write_unsigned(env, ir_platform.ia32_po2_stackalign);
+	write_unsigned(env, ir_platform.supports_thread_local_storage);
+	write_int(env, ir_platform.user_label_prefix);
+
+	write_symbol(env, "options");
+	lc_opt_walk_values(firm_opt_get_root(), write_option, env);
+}
+
+unsigned long long ir_fingerprint_irg(ir_graph *irg)
+{
+	write_env_t my_env;
+	write_env_t *env = &my_env;
+
+	memset(env, 0, sizeof(*env));
+	env->hash    = FINGERPRINT_OFFSET_BASIS;
+	env->numbers = pmap_create();
+	deq_init(&env->write_queue);
+	deq_init(&env->entity_queue);
+
+	writers_init();
+	write_fingerprint_context(env);
 
+	irp_reserve_resources(irp, IRP_RESOURCE_TYPE_VISITED);
+	inc_master_type_visited();
+	write_irg(env, irg);
+	while (!deq_empty(&env->entity_queue)) {
+		ir_entity *entity = deq_pop_pointer_left(ir_entity, &env->entity_queue);
+		write_entity(env, entity);
+	}
+	irp_free_resources(irp, IRP_RESOURCE_TYPE_VISITED);
+
+	pmap_destroy(env->numbers);
+	deq_free(&env->entity_queue);
+	deq_free(&env->write_queue);
+	return env->incomplete ? 0 : env->hash;
+}
 
 static void read_c(read_env_t *env)
 {
@@ -1567,6 +1730,42 @@ ir_switch_table *read_switch_table_ref(read_env_t *env)
 	return table;
 }
 
+static int read_hex_digit(read_env_t *env)
+{
+	int const c = env->c;
+	read_c(env);
+	if ('0' <= c && c <= '9')
+		return c - '0';
+	if ('a' <= c && c <= 'f')
+		return c - 'a' + 10;
+	parse_error(env, "Expected hex digit, got '%c'\n", c);
+	exit(1);
+}
+
+static ir_initializer_t *read_bytes_initializer(read_env_t *env)
+{
+	size_t         size = read_size_t(env);
+	unsigned char *data = XMALLOCN(unsigned char, size);
+	skip_ws(env);
+	if (env->c != '"') {
+		parse_error(env, "Expected string, got '%c'\n", env->c);
+		exit(1);
+	}
+	read_c(env);
+	for (size_t i = 0; i < size; ++i) {
+		int const high = read_hex_digit(env);
+		data[i] = high << 4 | read_hex_digit(env);
+	}
+	if (env->c != '"') {
+		parse_error(env, "Unexpected char '%c', expected '\"'\n", env->c);
+		exit(1);
+	}
+	read_c(env);
+	ir_initializer_t *const ini = create_initializer_bytes(size, data);
+	free(data);
+	return ini;
+}
+
 static ir_initializer_t *read_initializer(read_env_t *env)
 {
 	ir_initializer_kind_t ini_kind = read_initializer_kind(env);
@@ -1600,6 +1799,9 @@ static ir_initializer_t *read_initializer(read_env_t *env)
 		}
 		return ini;
 	}
+
+	case IR_INITIALIZER_BYTES:
+		return read_bytes_initializer(env);
 	}
 
 	panic("unknown initializer kind");
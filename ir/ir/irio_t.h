@@ -6,6 +6,7 @@
 #include "irnode_t.h"
 #include "obst.h"
 #include "pdeq.h"
+#include "pmap.h"
 #include "set.h"
 #include "type_t.h"
 #include "typerep.h"
@@ -40,9 +41,13 @@ typedef struct read_env_t {
 } read_env_t;
 
 typedef struct write_env_t {
-	FILE *file;
+	FILE *file;          /**< output file, NULL when computing a fingerprint */
 	deq_t write_queue;
 	deq_t entity_queue;
+	unsigned long long hash;    /**< the fingerprint computed so far */
+	pmap              *numbers; /**< canonical numbers of a fingerprint */
+	long               n_numbers;
+	bool               incomplete; /**< some node could not be described */
 } write_env_t;
 
 void write_align(write_env_t *env, ir_align align);
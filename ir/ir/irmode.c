@@ -14,19 +14,21 @@
 #include "ident.h"
 #include "irhooks.h"
 #include "irprog_t.h"
+#include "irthread.h"
 #include "obst.h"
 #include "panic.h"
 #include "strcalc.h"
 #include "tv_t.h"
 #include "util.h"
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 /** Obstack to hold all modes. */
 static struct obstack modes;
 
 /** The list of all currently existing modes. */
-static ir_mode **mode_list;
+ir_mode **ir_modes;
 
 static bool modes_are_equal(const ir_mode *m, const ir_mode *n)
 {
@@ -48,8 +50,8 @@ static bool modes_are_equal(const ir_mode *m, const ir_mode *n)
  */
 static ir_mode *find_mode(const ir_mode *m)
 {
-	for (size_t i = 0, n_modes = ARR_LEN(mode_list); i < n_modes; ++i) {
-		ir_mode *n = mode_list[i];
+	for (size_t i = 0, n_modes = ARR_LEN(ir_modes); i < n_modes; ++i) {
+		ir_mode *n = ir_modes[i];
 		if (modes_are_equal(n, m))
 			return n;
 	}
@@ -133,7 +135,11 @@ static ir_mode *register_mode(ir_mode *mode)
 
 	mode->kind = k_ir_mode;
 	mode->type = new_type_primitive(mode);
-	ARR_APP1(ir_mode*, mode_list, mode);
+	mode->index = ARR_LEN(ir_modes);
+#ifdef FIRM_COMPACT_NODES
+	assert(mode->index <= UINT16_MAX);
+#endif
+	ARR_APP1(ir_mode*, ir_modes, mode);
 	init_mode_values(mode);
 	hook_new_mode(mode);
 	return mode;
@@ -145,9 +151,12 @@ ir_mode *new_int_mode(const char *name, unsigned bit_size, int sign,
 	if (bit_size >= (unsigned)sc_get_precision())
 		panic("cannot create mode: more bits than tarval module maximum");
 
+	ir_lock();
 	ir_mode *result = alloc_mode(name, irms_int_number, irma_twos_complement,
 	                             bit_size, sign, modulo_shift);
-	return register_mode(result);
+	ir_mode *res    = register_mode(result);
+	ir_unlock();
+	return res;
 }
 
 ir_mode *new_reference_mode(const char *name, unsigned bit_size,
@@ -156,6 +165,7 @@ ir_mode *new_reference_mode(const char *name, unsigned bit_size,
 	if (bit_size >= (unsigned)sc_get_precision())
 		panic("cannot create mode: more bits than tarval module maximum");
 
+	ir_lock();
 	ir_mode *result = alloc_mode(name, irms_reference, irma_twos_complement,
 	                             bit_size, 0, modulo_shift);
 	ir_mode *res = register_mode(result);
@@ -167,6 +177,7 @@ ir_mode *new_reference_mode(const char *name, unsigned bit_size,
 		ir_mode *offset_mode = new_int_mode(buf, bit_size, 1, modulo_shift);
 		res->offset_mode = offset_mode;
 	}
+	ir_unlock();
 	return res;
 }
 
@@ -191,19 +202,25 @@ ir_mode *new_float_mode(const char *name, ir_mode_arithmetic arithmetic,
 	if (mantissa_size >= (unsigned)sc_get_precision())
 		panic("cannot create mode: more bits than tarval module maximum");
 
+	ir_lock();
 	ir_mode *result
 		= alloc_mode(name, irms_float_number, arithmetic, bit_size, 1, 0);
 	result->int_conv_overflow        = conv_overflow;
 	result->float_desc.exponent_size = exponent_size;
 	result->float_desc.mantissa_size = mantissa_size;
 	result->float_desc.explicit_one  = explicit_one;
-	return register_mode(result);
+	ir_mode *res = register_mode(result);
+	ir_unlock();
+	return res;
 }
 
 ir_mode *new_non_arithmetic_mode(const char *name, unsigned bit_size)
 {
+	ir_lock();
 	ir_mode *result = alloc_mode(name, irms_data, irma_none, bit_size, 0, 0);
-	return register_mode(result);
+	ir_mode *res    = register_mode(result);
+	ir_unlock();
+	return res;
 }
 
 static ir_mode *new_non_data_mode(const char *name)
@@ -433,7 +450,7 @@ void set_reference_offset_mode(ir_mode *ref_mode, ir_mode *int_mode)
 void init_mode(void)
 {
 	obstack_init(&modes);
-	mode_list = NEW_ARR_F(ir_mode*, 0);
+	ir_modes = NEW_ARR_F(ir_mode*, 0);
 
 	/* initialize predefined modes */
 	mode_BB  = new_non_data_mode("BB");
@@ -548,19 +565,19 @@ ir_type *(get_type_for_mode) (const ir_mode *mode)
 
 size_t ir_get_n_modes(void)
 {
-	return ARR_LEN(mode_list);
+	return ARR_LEN(ir_modes);
 }
 
 ir_mode *ir_get_mode(size_t num)
 {
-	assert(num < ARR_LEN(mode_list));
-	return mode_list[num];
+	assert(num < ARR_LEN(ir_modes));
+	return ir_modes[num];
 }
 
 void finish_mode(void)
 {
 	obstack_free(&modes, 0);
-	DEL_ARR_F(mode_list);
+	DEL_ARR_F(ir_modes);
 
 	mode_T   = NULL;
 	mode_X   = NULL;
@@ -92,8 +92,12 @@ struct ir_mode {
 	/** For reference modes, a signed integer mode used to add/subtract
 	 * offsets. */
 	ir_mode            *offset_mode;
+	unsigned            index;     /**< Position in ir_modes */
 };
 
+/** All registered modes, indexed by ir_mode::index. */
+extern ir_mode **ir_modes;
+
 static inline ident *get_mode_ident_(const ir_mode *mode)
 {
 	return mode->name;
@@ -11,6 +11,7 @@
 #include "irnode_t.h"
 
 #include "beinfo.h"
+#include "bitfiddle.h"
 #include "ident.h"
 #include "irbackedge_t.h"
 #include "ircons.h"
@@ -73,34 +74,69 @@ ir_relation get_inversed_relation(ir_relation relation)
 	return code;
 }
 
+ir_node **new_irn_in_array(ir_graph *irg, int arity)
+{
+#ifdef FIRM_COMPACT_NODES
+	return OALLOCN(get_irg_obstack(irg), ir_node*, arity + 1);
+#else
+	return NEW_ARR_D(ir_node*, get_irg_obstack(irg), arity + 1);
+#endif
+}
+
 ir_node *new_ir_node(dbg_info *db, ir_graph *irg, ir_node *block, ir_op *op,
                      ir_mode *mode, int arity, ir_node *const *in)
 {
 	assert(mode != NULL);
 
-	size_t   const node_size = offsetof(ir_node, attr) + op->attr_size;
-	ir_node *const res       = (ir_node*)OALLOCNZ(get_irg_obstack(irg), char, node_size);
+	/* Nodes with dynamic arity must always have a flexible array. */
+	bool      const flexible_in = arity < 0 || op->opar == oparity_dynamic;
+	size_t    const node_size   = offsetof(ir_node, attr) + op->attr_size;
+	unsigned char   alloc_class;
+	/* Place a fixed in array directly behind the node, so it is recycled
+	 * together with the node. */
+#ifdef FIRM_COMPACT_NODES
+	size_t    const in_offset   = round_up2(node_size, sizeof(ir_node*));
+	size_t    const in_size     = (arity + 1) * sizeof(ir_node*);
+#else
+	/* The in array keeps its array header. */
+	size_t    const in_offset   = round_up2(node_size, sizeof(aligned_type));
+	size_t    const in_size     = ARR_ELTS_OFFS + (arity + 1) * sizeof(ir_node*);
+#endif
+	size_t    const alloc_size  = flexible_in ? node_size : in_offset + in_size;
+	ir_node  *const res         = (ir_node*)irg_alloc_node_memory(irg, alloc_size, &alloc_class);
+	ir_node **      fixed_in    = (ir_node**)((char*)res + in_offset);
+#ifndef FIRM_COMPACT_NODES
+	if (!flexible_in) {
+		ir_arr_descr *const descr = (ir_arr_descr*)fixed_in;
+		*descr           = arr_mt_descr;
+		descr->allocated = descr->nelts = arity + 1;
+		fixed_in         = (ir_node**)descr->elts;
+	}
+#endif
 
 	res->kind     = k_ir_node;
-	res->op       = op;
-	res->mode     = mode;
 	res->irg      = irg;
-	res->node_idx = irg_register_node_idx(irg, res);
+	res->node_idx = irg_register_node_idx(irg, res, alloc_class);
+	set_irn_op(res, op);
+	set_irn_mode(res, mode);
 
 	if (arity < 0) {
 		res->in = NEW_ARR_F(ir_node *, 1);  /* 1: space for block */
 	} else {
-		/* Nodes with dynamic arity must always have a flexible array. */
-		if (op->opar == oparity_dynamic)
-			res->in = NEW_ARR_F(ir_node *, (arity+1));
-		else
-			res->in = NEW_ARR_D(ir_node*, get_irg_obstack(irg), arity + 1);
+		res->in = flexible_in ? NEW_ARR_F(ir_node*, arity + 1) : fixed_in;
 		MEMCPY(&res->in[1], in, arity);
 	}
+#ifdef FIRM_COMPACT_NODES
+	res->arity = arity < 0 ? 0 : arity;
+#endif
 
 	res->in[0]   = block;
 	set_irn_dbg_info(res, db);
+#ifdef FIRM_COMPACT_NODES
+	get_irn_cold(res)->node_nr = get_irp_new_node_nr();
+#else
 	res->node_nr = get_irp_new_node_nr();
+#endif
 
 	for (ir_edge_kind_t i = EDGE_KIND_FIRST; i <= EDGE_KIND_LAST; ++i) {
 		INIT_LIST_HEAD(&res->edge_info[i].outs_head);
@@ -160,6 +196,21 @@ int (get_irn_arity)(const ir_node *node)
 	return get_irn_arity_(node);
 }
 
+/**
+ * Returns whether changing input @p n of @p node may change the control flow
+ * graph. The loop information only covers blocks, so other changes keep it.
+ */
+static bool changes_cfg(const ir_node *node, int n)
+{
+	if (is_Block(node) || is_End(node))
+		return true;
+	if (n >= 0)
+		return false;
+	/* Blocks find their predecessors through the block of the mode_X nodes,
+	 * so only moving those changes control flow. */
+	return get_irn_mode(node) == mode_X;
+}
+
 void set_irn_in(ir_node *const node, int const arity, ir_node *const *const in)
 {
 	assert(node != NULL && node->kind == k_ir_node);
@@ -170,30 +221,36 @@ void set_irn_in(ir_node *const node, int const arity, ir_node *const *const in)
 	}
 #endif
 
-	ir_graph  *irg     = get_irn_irg(node);
-	ir_node ***pOld_in = &node->in;
+	ir_graph  *irg       = get_irn_irg(node);
+	ir_node ***pOld_in   = &node->in;
+	int        old_arity = get_irn_arity(node);
 	int        i;
 	for (i = 0; i < arity; i++) {
-		if (i < (int)ARR_LEN(*pOld_in)-1)
+		if (i < old_arity)
 			edges_notify_edge(node, i, in[i], (*pOld_in)[i+1], irg);
 		else
 			edges_notify_edge(node, i, in[i], NULL,            irg);
 	}
-	for (;i < (int)ARR_LEN(*pOld_in)-1; i++) {
+	for (;i < old_arity; i++) {
 		edges_notify_edge(node, i, NULL, (*pOld_in)[i+1], irg);
 	}
 
-	if (arity != (int)ARR_LEN(*pOld_in) - 1) {
+	if (arity != old_arity) {
 		ir_node * block = (*pOld_in)[0];
-		*pOld_in = NEW_ARR_D(ir_node*, get_irg_obstack(irg), arity + 1);
+		*pOld_in = new_irn_in_array(irg, arity);
 		(*pOld_in)[0] = block;
+#ifdef FIRM_COMPACT_NODES
+		node->arity = arity;
+#endif
 	}
 	fix_backedges(get_irg_obstack(irg), node);
 
 	MEMCPY(*pOld_in + 1, in, arity);
 
 	/* update irg flags */
-	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS | IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
+	if (changes_cfg(node, 0))
+		clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
 }
 
 ir_node *(get_irn_n)(const ir_node *node, int n)
@@ -210,13 +267,17 @@ void set_irn_n(ir_node *node, int n, ir_node *in)
 	assert(in && in->kind == k_ir_node);
 	assert(!is_Deleted(in));
 
+	ir_node *const old = node->in[n + 1];
+
 	/* Here, we rely on src and tgt being in the current ir graph */
-	edges_notify_edge(node, n, in, node->in[n + 1], irg);
+	edges_notify_edge(node, n, in, old, irg);
 
 	node->in[n + 1] = in;
 
 	/* update irg flags */
-	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS | IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
+	if (in != old && changes_cfg(node, n))
+		clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
 }
 
 int add_irn_n(ir_node *node, ir_node *in)
@@ -226,6 +287,7 @@ int add_irn_n(ir_node *node, ir_node *in)
 	assert(is_irn_dynamic(node));
 	int pos = ARR_LEN(node->in) - 1;
 	ARR_APP1(ir_node *, node->in, in);
+	update_irn_arity(node);
 	edges_notify_edge(node, pos, node->in[pos + 1], NULL, irg);
 
 	/* update irg flags */
@@ -249,6 +311,7 @@ static void remove_irn_n(ir_node *node, int n)
 	/* Remove last edge. */
 	edges_notify_edge(node, arity - 1, NULL, last, irg);
 	ARR_SHRINKLEN(node->in, arity);
+	update_irn_arity(node);
 
 	/* update irg flags */
 	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
@@ -282,13 +345,13 @@ unsigned (get_irn_opcode)(const ir_node *node)
 
 const char *get_irn_opname(const ir_node *node)
 {
-	return get_id_str(node->op->name);
+	return get_id_str(get_irn_op(node)->name);
 }
 
 ident *get_irn_opident(const ir_node *node)
 {
 	assert(node);
-	return node->op->name;
+	return get_irn_op(node)->name;
 }
 
 ir_visited_t (get_irn_visited)(const ir_node *node)
@@ -341,7 +404,11 @@ void set_irn_pinned(ir_node *node, int pinned)
 long get_irn_node_nr(const ir_node *node)
 {
 	assert(node->kind == k_ir_node);
+#ifdef FIRM_COMPACT_NODES
+	return get_irn_cold(node)->node_nr;
+#else
 	return node->node_nr;
+#endif
 }
 
 void *(get_irn_generic_attr)(ir_node *node)
@@ -465,6 +532,7 @@ void set_End_keepalives(ir_node *end, int n, ir_node *in[])
 		edges_notify_edge(end, e, NULL, end->in[e + 1], irg);
 	}
 	ARR_RESIZE(ir_node *, end->in, n + 1 + END_KEEPALIVE_OFFSET);
+	update_irn_arity(end);
 
 	for (int i = 0; i < n; ++i) {
 		end->in[1 + END_KEEPALIVE_OFFSET + i] = in[i];
@@ -603,25 +671,25 @@ ir_entity *get_Call_callee(const ir_node *node)
 ir_node *get_binop_left(const ir_node *node)
 {
 	assert(is_binop(node));
-	return get_irn_n(node, node->op->op_index);
+	return get_irn_n(node, get_irn_op(node)->op_index);
 }
 
 void set_binop_left(ir_node *node, ir_node *left)
 {
 	assert(is_binop(node));
-	set_irn_n(node, node->op->op_index, left);
+	set_irn_n(node, get_irn_op(node)->op_index, left);
 }
 
 ir_node *get_binop_right(const ir_node *node)
 {
 	assert(is_binop(node));
-	return get_irn_n(node, node->op->op_index + 1);
+	return get_irn_n(node, get_irn_op(node)->op_index + 1);
 }
 
 void set_binop_right(ir_node *node, ir_node *right)
 {
 	assert(is_binop(node));
-	set_irn_n(node, node->op->op_index + 1, right);
+	set_irn_n(node, get_irn_op(node)->op_index + 1, right);
 }
 
 ir_node *(get_Phi_next)(const ir_node *phi)
@@ -668,7 +736,7 @@ int is_x_except_Proj(const ir_node *node)
 	ir_node *pred = get_Proj_pred(node);
 	if (!is_fragile_op(pred))
 		return false;
-	return get_Proj_num(node) == pred->op->pn_x_except;
+	return get_Proj_num(node) == get_irn_op(pred)->pn_x_except;
 }
 
 int is_x_regular_Proj(const ir_node *node)
@@ -678,7 +746,7 @@ int is_x_regular_Proj(const ir_node *node)
 	ir_node *pred = get_Proj_pred(node);
 	if (!is_fragile_op(pred))
 		return false;
-	return get_Proj_num(node) == pred->op->pn_x_regular;
+	return get_Proj_num(node) == get_irn_op(pred)->pn_x_regular;
 }
 
 void ir_set_throws_exception(ir_node *node, int throws_exception)
@@ -766,17 +834,17 @@ ir_node *skip_Id(ir_node *node)
 	/* This should compact Id-cycles to self-cycles. It has the same (or less?) complexity
 	 * than any other approach, as Id chains are resolved and all point to the real node, or
 	 * all id's are self loops. */
-	if (node->op != op_Id)
+	if (get_irn_op(node) != op_Id)
 		return node;
 
 	/* Don't use get_Id_pred():  We get into an endless loop for
 	   self-referencing Ids. */
 	ir_node *pred = node->in[0+1];
-	if (pred->op != op_Id)
+	if (get_irn_op(pred) != op_Id)
 		return pred;
 
 	if (node != pred) {  /* not a self referencing Id. Resolve Id chain. */
-		if (pred->op != op_Id)
+		if (get_irn_op(pred) != op_Id)
 			return pred; /* shortcut */
 		ir_node *rem_pred = pred;
 
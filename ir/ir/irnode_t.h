@@ -11,12 +11,15 @@
 #ifndef FIRM_IR_IRNODE_T_H
 #define FIRM_IR_IRNODE_T_H
 
+#include <stdint.h>
+
 #include "array.h"
 #include "bitset.h"
 #include "irdom_t.h"
 #include "iredgekinds.h"
 #include "irflag_t.h"
 #include "irgraph.h"
+#include "irmode_t.h"
 #include "irnode.h"
 #include "irop_t.h"
 #include "list.h"
@@ -288,12 +291,23 @@ typedef struct ir_def_use_edges {
 
 /**
  * Data of a function graph node.
+ *
+ * With FIRM_COMPACT_NODES the opcode and mode are stored as indices into the
+ * opcode and mode tables, the operands of nodes with fixed arity are
+ * allocated directly behind the node and the rarely used node number and
+ * loop are kept in a side table of the graph (see ir_node_cold_t).
  */
 struct ir_node {
 	firm_kind        kind;     /**< Distinguishes this node from others. */
 	unsigned         node_idx; /**< The node index of this node in its graph. */
+#ifdef FIRM_COMPACT_NODES
+	uint16_t         opcode;   /**< The opcode of this node. */
+	uint16_t         mode_nr;  /**< The number of the mode of this node. */
+	unsigned         arity;    /**< The number of operands. */
+#else
 	ir_op           *op;       /**< The Opcode of this node. */
 	ir_mode         *mode;     /**< The Mode of this node. */
+#endif
 	struct ir_node **in;       /**< The array of predecessors / operands. */
 	ir_graph        *irg;
 	ir_visited_t     visited;  /**< Visited counter for walks of the graph. */
@@ -301,14 +315,18 @@ struct ir_node {
 	                                node, e.g. used during optimization to link
 	                                to nodes that shall replace a node. */
 	dbg_info        *dbi;      /**< Information for debug support. */
+#ifndef FIRM_COMPACT_NODES
 	long             node_nr;  /**< Globally unique node number. */
+#endif
 
 	union {
 		ir_def_use_edges *out;    /**< array of def-use edges. */
 		unsigned          n_outs; /**< number of def-use edges (temporarily used
 		                               during construction of data structure) */
 	} o;
+#ifndef FIRM_COMPACT_NODES
 	ir_loop         *loop;         /**< Loop information. */
+#endif
 	void            *backend_info;
 	irn_edges_info_t edge_info;    /**< Everlasting out edges. */
 
@@ -316,6 +334,12 @@ struct ir_node {
 	ir_attr attr;
 };
 
+/**
+ * Allocates an in array for a node with fixed arity @p arity, including the
+ * slot for the block.
+ */
+ir_node **new_irn_in_array(ir_graph *irg, int arity);
+
 /**
  * Returns the array with the ins.  The content of the array must not be
  * changed.
@@ -342,7 +366,11 @@ static inline unsigned get_irn_idx_(const ir_node *node)
  */
 static inline ir_op *get_irn_op_(const ir_node *node)
 {
+#ifdef FIRM_COMPACT_NODES
+	return ir_opcodes[node->opcode];
+#else
 	return node->op;
+#endif
 }
 
 /**
@@ -350,7 +378,11 @@ static inline ir_op *get_irn_op_(const ir_node *node)
  */
 static inline void set_irn_op(ir_node *node, ir_op *op)
 {
+#ifdef FIRM_COMPACT_NODES
+	node->opcode = op->code;
+#else
 	node->op = op;
+#endif
 }
 
 /** Copies all attributes stored in the old node  to the new node.
@@ -371,7 +403,11 @@ static inline void copy_node_attr_(ir_graph *irg, const ir_node *old_node,
 static inline unsigned get_irn_opcode_(const ir_node *node)
 {
 	assert(k_ir_node == get_kind(node));
+#ifdef FIRM_COMPACT_NODES
+	return node->opcode;
+#else
 	return node->op->code;
+#endif
 }
 
 /**
@@ -380,7 +416,24 @@ static inline unsigned get_irn_opcode_(const ir_node *node)
  */
 static inline int get_irn_arity_(const ir_node *node)
 {
+#ifdef FIRM_COMPACT_NODES
+	return (int)node->arity;
+#else
 	return (int)(ARR_LEN(node->in) - 1);
+#endif
+}
+
+/**
+ * Updates the arity of a node after its in array was changed with the
+ * ARR_* functions. Only needed for nodes with a flexible in array.
+ */
+static inline void update_irn_arity(ir_node *node)
+{
+#ifdef FIRM_COMPACT_NODES
+	node->arity = ARR_LEN(node->in) - 1;
+#else
+	(void)node;
+#endif
 }
 
 /**
@@ -415,7 +468,11 @@ static inline unsigned hash_irn(const ir_node *node)
  */
 static inline ir_mode *get_irn_mode_(const ir_node *node)
 {
+#ifdef FIRM_COMPACT_NODES
+	return ir_modes[node->mode_nr];
+#else
 	return node->mode;
+#endif
 }
 
 /**
@@ -424,7 +481,11 @@ static inline ir_mode *get_irn_mode_(const ir_node *node)
  */
 static inline void set_irn_mode_(ir_node *node, ir_mode *mode)
 {
+#ifdef FIRM_COMPACT_NODES
+	node->mode_nr = mode->index;
+#else
 	node->mode = mode;
+#endif
 }
 
 static inline ir_node *get_nodes_block_(const ir_node *node)
@@ -524,7 +585,7 @@ static inline int get_irn_pinned_(const ir_node *node)
 static inline int is_binop_(const ir_node *node)
 {
 	assert(node->kind == k_ir_node);
-	return (node->op->opar == oparity_binary);
+	return (get_irn_op_(node)->opar == oparity_binary);
 }
 
 static inline bool is_irn_dynamic(ir_node const *const n)
@@ -632,6 +693,22 @@ static inline const void *get_irn_generic_attr_const_(const ir_node *node)
 	return &node->attr;
 }
 
+/**
+ * Gives a copy of a node the number of the original node.
+ */
+static inline void copy_irn_node_nr(ir_node *new_node, const ir_node *old_node)
+{
+#ifdef FIRM_COMPACT_NODES
+	/* The number is kept in the side table of the graph, where the entry of a
+	 * node from before copying the graph may already belong to a new node with
+	 * the same index. So the copy gets a fresh number instead. */
+	(void)new_node;
+	(void)old_node;
+#else
+	new_node->node_nr = old_node->node_nr;
+#endif
+}
+
 static inline dbg_info *get_irn_dbg_info_(const ir_node *n)
 {
 	return n->dbi;
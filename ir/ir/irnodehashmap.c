@@ -19,6 +19,7 @@
 static ir_nodehashmap_entry_t null_nodehashmap_entry = { NULL, NULL };
 
 #define DO_REHASH
+#define GROUP_PROBING
 #define HashSet                   ir_nodehashmap_t
 #define HashSetIterator           ir_nodehashmap_iterator_t
 #define ValueType                 ir_nodehashmap_entry_t
@@ -27,13 +28,12 @@ static ir_nodehashmap_entry_t null_nodehashmap_entry = { NULL, NULL };
 #define ConstKeyType              const ir_node*
 #define GetKey(value)             (value).node
 #define InitData(self,value,key)  (value).node = (key)
+#ifdef FIRM_COMPACT_NODES
+#define Hash(self,key)            hash_irn(key)
+#else
 #define Hash(self,key)            ((unsigned)((key)->node_nr))
+#endif
 #define KeysEqual(self,key1,key2) (key1) == (key2)
-#define SetRangeEmpty(ptr,size)   memset(ptr, 0, (size) * sizeof((ptr)[0]))
-#define EntrySetEmpty(value)      (value).node = NULL
-#define EntrySetDeleted(value)    (value).node = (ir_node*) -1
-#define EntryIsEmpty(value)       ((value).node == NULL)
-#define EntryIsDeleted(value)     ((value).node == (ir_node*)-1)
 
 void ir_nodehashmap_init_(ir_nodehashmap_t *self);
 #define hashset_init            ir_nodehashmap_init_
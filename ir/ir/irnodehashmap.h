@@ -24,7 +24,9 @@ typedef struct ir_nodehashmap_entry_t {
 #define HashSetIterator  ir_nodehashmap_iterator_t
 #define ValueType        ir_nodehashmap_entry_t
 #define DO_REHASH
+#define GROUP_PROBING
 #include "hashset.h"
+#undef GROUP_PROBING
 #undef DO_REHASH
 #undef ValueType
 #undef HashSetIterator
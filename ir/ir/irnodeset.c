@@ -16,15 +16,18 @@
 #include "irnode_t.h"
 
 #define DO_REHASH
+#define GROUP_PROBING
 #define ID_HASH
 #define HashSet                   ir_nodeset_t
 #define HashSetIterator           ir_nodeset_iterator_t
 #define ValueType                 ir_node*
 #define NullValue                 NULL
-#define DeletedValue              ((ir_node*)-1)
+#ifdef FIRM_COMPACT_NODES
+#define Hash(this,key)            hash_irn(key)
+#else
 #define Hash(this,key)            ((unsigned)((key)->node_nr))
+#endif
 #define KeysEqual(this,key1,key2) (key1) == (key2)
-#define SetRangeEmpty(ptr,size)   memset(ptr, 0, (size) * sizeof((ptr)[0]))
 
 void ir_nodeset_init_(ir_nodeset_t *self);
 #define hashset_init            ir_nodeset_init_
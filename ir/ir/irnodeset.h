@@ -23,9 +23,11 @@
 #define HashSetIterator  ir_nodeset_iterator_t
 #define ValueType        ir_node*
 #define DO_REHASH
+#define GROUP_PROBING
 
 #include "hashset.h"
 
+#undef GROUP_PROBING
 #undef DO_REHASH
 #undef ValueType
 #undef HashSetIterator
@@ -0,0 +1,148 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   A dense side table storing a fixed size entry per node index.
+ *
+ * In contrast to ir_nodemap, which maps node indices to pointers, the
+ * entries are stored inline, so passes need no extra obstack allocation per
+ * node and lookups need no pointer chase. Entries live in chunks of
+ * IR_NODETABLE_CHUNK_SIZE consecutive indices, which are allocated when the
+ * first entry of the chunk is inserted. Chunks never move, so pointers to
+ * entries stay valid while new nodes are added to the graph and the table
+ * grows.
+ *
+ * Every entry is stamped with the generation it was inserted in:
+ * ir_nodetable_clear() starts a new generation, which invalidates all
+ * entries without touching the chunks.
+ */
+#ifndef FIRM_IRNODETABLE_H
+#define FIRM_IRNODETABLE_H
+
+#include <string.h>
+
+#include "array.h"
+#include "bitfiddle.h"
+#include "firm_types.h"
+#include "irgraph_t.h"
+#include "irnode_t.h"
+#include "xmalloc.h"
+
+#define IR_NODETABLE_CHUNK_SHIFT 8
+#define IR_NODETABLE_CHUNK_SIZE  (1u << IR_NODETABLE_CHUNK_SHIFT)
+/** Size of the generation stamps in front of the entries of a chunk. */
+#define IR_NODETABLE_STAMPS_SIZE (IR_NODETABLE_CHUNK_SIZE * sizeof(unsigned))
+
+typedef struct ir_nodetable {
+	char   **chunks;     /**< ARR_F of chunks, NULL if not allocated yet */
+	size_t   elem_size;  /**< size of an entry including padding */
+	unsigned generation; /**< stamp of the valid entries */
+} ir_nodetable;
+
+/**
+ * Initialize a node table with entries of @p elem_size bytes for the nodes
+ * of @p irg.
+ */
+static inline void ir_nodetable_init(ir_nodetable *table, const ir_graph *irg,
+                                     size_t elem_size)
+{
+	size_t const n_chunks
+		= (get_irg_last_idx(irg) >> IR_NODETABLE_CHUNK_SHIFT) + 1;
+	table->chunks     = NEW_ARR_FZ(char*, n_chunks);
+	table->elem_size  = round_up2(elem_size, sizeof(void*));
+	table->generation = 1;
+}
+
+/**
+ * Free all memory used by the node table but not the table struct itself.
+ */
+static inline void ir_nodetable_destroy(ir_nodetable *table)
+{
+	for (size_t i = 0, n = ARR_LEN(table->chunks); i < n; ++i)
+		free(table->chunks[i]);
+	DEL_ARR_F(table->chunks);
+	table->chunks = NULL;
+}
+
+/**
+ * Remove all entries from the node table.
+ */
+static inline void ir_nodetable_clear(ir_nodetable *table)
+{
+	if (++table->generation != 0)
+		return;
+	/* The stamps wrapped around, reset them so no old entry becomes valid. */
+	for (size_t i = 0, n = ARR_LEN(table->chunks); i < n; ++i) {
+		if (table->chunks[i] != NULL)
+			memset(table->chunks[i], 0, IR_NODETABLE_STAMPS_SIZE);
+	}
+	table->generation = 1;
+}
+
+/**
+ * Get the entry for node index @p idx. Returns NULL if there is none.
+ */
+static inline void *ir_nodetable_get_idx(const ir_nodetable *table,
+                                         unsigned idx)
+{
+	size_t const chunk_nr = idx >> IR_NODETABLE_CHUNK_SHIFT;
+	if (chunk_nr >= ARR_LEN(table->chunks))
+		return NULL;
+	char *const chunk = table->chunks[chunk_nr];
+	if (chunk == NULL)
+		return NULL;
+	unsigned const i = idx & (IR_NODETABLE_CHUNK_SIZE - 1);
+	if (((unsigned const*)chunk)[i] != table->generation)
+		return NULL;
+	return chunk + IR_NODETABLE_STAMPS_SIZE + i * table->elem_size;
+}
+
+/**
+ * Get the entry for @p node. Returns NULL if there is none.
+ */
+static inline void *ir_nodetable_get(const ir_nodetable *table,
+                                     const ir_node *node)
+{
+	return ir_nodetable_get_idx(table, get_irn_idx(node));
+}
+
+/**
+ * Create a zeroed entry for @p node, replacing an existing one.
+ */
+static inline void *ir_nodetable_insert(ir_nodetable *table,
+                                        const ir_node *node)
+{
+	unsigned const idx      = get_irn_idx(node);
+	size_t   const chunk_nr = idx >> IR_NODETABLE_CHUNK_SHIFT;
+	size_t   const n_chunks = ARR_LEN(table->chunks);
+	if (chunk_nr >= n_chunks) {
+		ARR_RESIZE(char*, table->chunks, chunk_nr + 1);
+		memset(table->chunks + n_chunks, 0,
+		       (chunk_nr + 1 - n_chunks) * sizeof(table->chunks[0]));
+	}
+	char *chunk = table->chunks[chunk_nr];
+	if (chunk == NULL) {
+		chunk = XMALLOCNZ(char, IR_NODETABLE_STAMPS_SIZE
+		                   + IR_NODETABLE_CHUNK_SIZE * table->elem_size);
+		table->chunks[chunk_nr] = chunk;
+	}
+	unsigned const i = idx & (IR_NODETABLE_CHUNK_SIZE - 1);
+	((unsigned*)chunk)[i] = table->generation;
+	char *const entry = chunk + IR_NODETABLE_STAMPS_SIZE + i * table->elem_size;
+	memset(entry, 0, table->elem_size);
+	return entry;
+}
+
+#define ir_nodetable_get_idx(type, table, idx) \
+	((type*)ir_nodetable_get_idx((table), (idx)))
+
+#define ir_nodetable_get(type, table, node) \
+	((type*)ir_nodetable_get((table), (node)))
+
+#define ir_nodetable_insert(type, table, node) \
+	((type*)ir_nodetable_insert((table), (node)))
+
+#endif
@@ -23,7 +23,7 @@
 #include "xmalloc.h"
 #include <string.h>
 
-static ir_op **opcodes;
+ir_op **ir_opcodes;
 /** the available next opcode */
 static unsigned next_iro = iro_last+1;
 
@@ -67,35 +67,38 @@ ir_op *new_ir_op(unsigned code, const char *name, op_pin_state p,
 	res->ops.get_type_attr   = default_get_type_attr;
 	res->ops.get_entity_attr = default_get_entity_attr;
 
-	size_t len = ARR_LEN(opcodes);
+#ifdef FIRM_COMPACT_NODES
+	assert(code <= UINT16_MAX);
+#endif
+	size_t len = ARR_LEN(ir_opcodes);
 	if ((size_t)code >= len) {
-		ARR_RESIZE(ir_op*, opcodes, (size_t)code+1);
-		memset(&opcodes[len], 0, (code-len+1) * sizeof(opcodes[0]));
+		ARR_RESIZE(ir_op*, ir_opcodes, (size_t)code+1);
+		memset(&ir_opcodes[len], 0, (code-len+1) * sizeof(ir_opcodes[0]));
 	}
-	if (opcodes[code] != NULL)
+	if (ir_opcodes[code] != NULL)
 		panic("opcode registered twice");
-	opcodes[code] = res;
+	ir_opcodes[code] = res;
 
 	return res;
 }
 
 void free_ir_op(ir_op *code)
 {
-	assert(opcodes[code->code] == code);
-	opcodes[code->code] = NULL;
+	assert(ir_opcodes[code->code] == code);
+	ir_opcodes[code->code] = NULL;
 
 	free(code);
 }
 
 unsigned ir_get_n_opcodes(void)
 {
-	return ARR_LEN(opcodes);
+	return ARR_LEN(ir_opcodes);
 }
 
 ir_op *ir_get_opcode(unsigned code)
 {
-	assert((size_t)code < ARR_LEN(opcodes));
-	return opcodes[code];
+	assert((size_t)code < ARR_LEN(ir_opcodes));
+	return ir_opcodes[code];
 }
 
 void ir_clear_opcodes_generic_func(void)
@@ -573,7 +576,7 @@ void set_op_dump(ir_op *op, dump_node_func func)
 
 void firm_init_op(void)
 {
-	opcodes = NEW_ARR_F(ir_op*, 0);
+	ir_opcodes = NEW_ARR_F(ir_op*, 0);
 	ir_init_opcodes();
 	be_init_op();
 
@@ -622,6 +625,6 @@ void firm_finish_op(void)
 {
 	be_finish_op();
 	ir_finish_opcodes();
-	DEL_ARR_F(opcodes);
-	opcodes = NULL;
+	DEL_ARR_F(ir_opcodes);
+	ir_opcodes = NULL;
 }
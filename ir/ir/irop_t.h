@@ -80,6 +80,9 @@ void firm_init_op(void);
 /** frees memory allocated by irop module */
 void firm_finish_op(void);
 
+/** All registered opcodes, indexed by their code. */
+extern ir_op **ir_opcodes;
+
 /**
  * Returns the attribute size of nodes of this opcode.
  * @note Use not encouraged, internal feature.
@@ -159,7 +159,10 @@ ir_type *(get_tls_type)(void)
 
 ir_entity *ir_get_global(ident *name)
 {
-	return pmap_get(ir_entity, irp->globals, name);
+	ir_lock();
+	ir_entity *const res = pmap_get(ir_entity, irp->globals, name);
+	ir_unlock();
+	return res;
 }
 
 void add_irp_irg(ir_graph *irg)
@@ -212,7 +215,9 @@ void add_irp_type(ir_type *typ)
 {
 	assert(typ != NULL);
 	assert(irp);
+	ir_lock();
 	ARR_APP1(ir_type *, irp->types, typ);
+	ir_unlock();
 }
 
 void remove_irp_type(ir_type *typ)
@@ -220,6 +225,7 @@ void remove_irp_type(ir_type *typ)
 	size_t i, l;
 	assert(typ);
 
+	ir_lock();
 	l = ARR_LEN(irp->types);
 	for (i = 0; i < l; ++i) {
 		if (irp->types[i] == typ) {
@@ -230,6 +236,7 @@ void remove_irp_type(ir_type *typ)
 			break;
 		}
 	}
+	ir_unlock();
 }
 
 size_t (get_irp_n_types) (void)
@@ -17,6 +17,7 @@
 #include "array.h"
 #include "callgraph.h"
 #include "irmemory.h"
+#include "irthread.h"
 #include "pmap.h"
 #include "typerep.h"
 
@@ -119,7 +120,10 @@ static inline ir_type *get_irp_type_(size_t pos)
 /** Returns a new, unique number to number nodes or the like. */
 static inline long get_irp_new_node_nr(void)
 {
-	return irp->max_node_nr++;
+	ir_lock();
+	long const nr = irp->max_node_nr++;
+	ir_unlock();
+	return nr;
 }
 
 static inline size_t get_irp_new_irg_idx(void)
@@ -142,12 +146,18 @@ static inline ir_label_t get_irp_next_label_nr_(void)
 static inline void irp_reserve_resources(ir_prog *irp,
                                          irp_resources_t resources)
 {
+	/* Graph passes running in parallel only use the links of their own frame
+	 * entities, so reservations are not tracked then. */
+	if (ir_threads_active)
+		return;
 	assert((irp->reserved_resources & resources) == 0);
 	irp->reserved_resources |= resources;
 }
 
 static inline void irp_free_resources(ir_prog *irp, irp_resources_t resources)
 {
+	if (ir_threads_active)
+		return;
 	assert((irp->reserved_resources & resources) == resources);
 	irp->reserved_resources &= ~resources;
 }
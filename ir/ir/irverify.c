@@ -1370,8 +1370,8 @@ static bool has_multiple_X_succs(const ir_node *node)
 	    || (is_fragile_op(node) && ir_throws_exception(node));
 }
 
-static unsigned n_returns;
-static bool     properties_fine;
+static FIRM_THREAD_LOCAL unsigned n_returns;
+static FIRM_THREAD_LOCAL bool     properties_fine;
 
 static void check_simple_properties(ir_node *node, void *env)
 {
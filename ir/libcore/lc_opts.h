@@ -186,6 +186,17 @@ const char *lc_opt_get_type_name(const lc_opt_entry_t *ent);
  */
 void lc_opt_print_help_for_entry(lc_opt_entry_t *ent, char separator, FILE *f);
 
+typedef void (lc_opt_value_func)(char const *name, char const *value,
+                                 void *data);
+
+/**
+ * Calls @p func for every option below @p grp with the name and the current
+ * value of the option, and for every subgroup with its name and a NULL value
+ * before visiting its options.
+ */
+void lc_opt_walk_values(const lc_opt_entry_t *grp, lc_opt_value_func *func,
+                        void *data);
+
 bool lc_opt_add_table(lc_opt_entry_t *grp, const lc_opt_table_entry_t *table);
 
 /**
@@ -26,6 +26,7 @@
 #include "tv_t.h"
 #include "util.h"
 #include <stdbool.h>
+#include <string.h>
 
 /** Walker environment. */
 struct ir_intrinsics_map {
@@ -512,6 +513,7 @@ static ir_tarval *get_initializer_value(ir_initializer_t *const init, ir_mode *c
 	}
 
 	case IR_INITIALIZER_COMPOUND:
+	case IR_INITIALIZER_BYTES:
 		break;
 	}
 
@@ -568,6 +570,17 @@ static ir_node *eval_strlen(ir_graph *irg, ir_entity *ent, ir_type *res_tp)
 		return NULL;
 
 	initializer = get_entity_initializer(ent);
+	if (get_initializer_kind(initializer) == IR_INITIALIZER_BYTES) {
+		/* bytes beyond the image are zero */
+		unsigned char const *data = get_initializer_bytes_data(initializer);
+		size = get_initializer_bytes_size(initializer);
+		unsigned char const *nul = (unsigned char const*)memchr(data, 0, size);
+		if (nul != NULL)
+			return new_r_Const_long(irg, get_type_mode(res_tp), nul - data);
+		if (size < get_type_size(get_entity_type(ent)))
+			return new_r_Const_long(irg, get_type_mode(res_tp), size);
+		return NULL;
+	}
 	if (get_initializer_kind(initializer) != IR_INITIALIZER_COMPOUND)
 		return NULL;
 
@@ -712,6 +725,11 @@ static int is_empty_string(ir_entity *ent)
 		return 0;
 
 	initializer = get_entity_initializer(ent);
+	if (get_initializer_kind(initializer) == IR_INITIALIZER_BYTES) {
+		if (get_initializer_bytes_size(initializer) == 0)
+			return get_type_size(get_entity_type(ent)) > 0;
+		return get_initializer_bytes_data(initializer)[0] == '\0';
+	}
 	if (get_initializer_kind(initializer) != IR_INITIALIZER_COMPOUND)
 		return 0;
 
@@ -12,6 +12,7 @@
  * transforms pointless conditional jumps into undonciditonal ones.
  */
 #include "debug.h"
+#include "irdom_t.h"
 #include "iredges_t.h"
 #include "irgmod.h"
 #include "irgraph_t.h"
@@ -32,6 +33,17 @@ static void set_Block_removable(ir_node *block, bool removable)
 	set_Block_mark(block, removable);
 }
 
+/**
+ * Keeps the dominator tree up to date when @p block is merged into its only
+ * successor or predecessor.
+ */
+static void remove_block_dom(ir_node *block)
+{
+	ir_graph *irg = get_irn_irg(block);
+	if (irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE))
+		dom_remove_block(block);
+}
+
 /** Check if a block has the removable property set. */
 static bool is_Block_removable(const ir_node *block)
 {
@@ -276,6 +288,7 @@ static bool try_merge_blocks(ir_node *block, unsigned pred_pos)
 	if (!is_Block_removable(block))
 		set_Block_removable(pred_block, false);
 	assert(get_Block_entity(block) == NULL);
+	remove_block_dom(block);
 	exchange(block, pred_block);
 	return true;
 }
@@ -458,6 +471,7 @@ static void merge_empty_predecessors(ir_node *block, unsigned new_n_cfgpreds)
 			in[n++] = predpred;
 		}
 		/* Merge blocks to preserve keep alive edges. */
+		remove_block_dom(predb);
 		exchange(predb, block);
 	}
 	assert(n == new_n_cfgpreds);
@@ -581,6 +595,15 @@ void optimize_cf(ir_graph *irg)
 
 	ir_free_resources(irg, IR_RESOURCE_BLOCK_MARK | IR_RESOURCE_PHI_LIST
 	                     | IR_RESOURCE_IRN_LINK);
-	confirm_irg_properties(irg, global_changed ? IR_GRAPH_PROPERTIES_NONE
+
+	/* Merging blocks does not change dominance between the remaining blocks,
+	 * so the dominator tree was maintained while merging. */
+	ir_graph_properties_t kept = IR_GRAPH_PROPERTIES_NONE;
+	if (global_changed
+	    && irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE)) {
+		dom_repair_tree(irg);
+		kept = IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE;
+	}
+	confirm_irg_properties(irg, global_changed ? kept
 	                                           : IR_GRAPH_PROPERTIES_ALL);
 }
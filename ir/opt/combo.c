@@ -43,6 +43,7 @@
 #include "pmap.h"
 #include "set.h"
 #include "tv_t.h"
+#include "xmalloc.h"
 #include <assert.h>
 
 /* define this to check that all type translations are monotone */
@@ -182,10 +183,13 @@ static inline bool is_reachable(const node_t *node)
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 
 /** The what reason. */
-DEBUG_ONLY(static const char *what_reason;)
+DEBUG_ONLY(static FIRM_THREAD_LOCAL const char *what_reason;)
 
 /** Next partition number. */
-DEBUG_ONLY(static unsigned part_nr = 0;)
+DEBUG_ONLY(static FIRM_THREAD_LOCAL unsigned part_nr = 0;)
+
+/** The compute functions, indexed by opcode. */
+static FIRM_THREAD_LOCAL compute_func *compute_funcs;
 
 /* forward */
 static node_t *identity(node_t *node);
@@ -216,7 +220,7 @@ static int cmp_irn_opcode(const ir_node *a, const ir_node *b)
 
 	/* here, we already know that the nodes are identical except their
 	 * attributes */
-	return !a->op->ops.attrs_equal(a, b);
+	return !get_irn_op(a)->ops.attrs_equal(a, b);
 }
 
 #ifdef CHECK_PARTITIONS
@@ -1069,7 +1073,7 @@ static bool clear_flags(node_t *list)
 static partition_t *split(partition_t **pX, node_t *gg, environment_t *env)
 {
 	partition_t *X = *pX;
-	DEBUG_ONLY(static int run = 0;)
+	DEBUG_ONLY(static FIRM_THREAD_LOCAL int run = 0;)
 
 	DB((dbg, LEVEL_2, "Run %d ", run++));
 	if (list_empty(&X->follower)) {
@@ -2296,7 +2300,7 @@ static void compute(node_t *node)
 		}
 	}
 
-	compute_func func = (compute_func)node->node->op->ops.generic;
+	compute_func func = compute_funcs[get_irn_opcode(node->node)];
 	if (func != NULL)
 		func(node);
 }
@@ -3121,7 +3125,7 @@ static void apply_end(ir_node *end, environment_t *env)
 
 static void set_compute_func(ir_op *op, compute_func func)
 {
-	op->ops.generic = (op_func)func;
+	compute_funcs[get_op_code(op)] = func;
 }
 
 /**
@@ -3130,10 +3134,10 @@ static void set_compute_func(ir_op *op, compute_func func)
 static void set_compute_functions(void)
 {
 	/* set the default compute function */
-	for (size_t i = 0, n = ir_get_n_opcodes(); i < n; ++i) {
-		ir_op *op = ir_get_opcode(i);
-		op->ops.generic = (op_func)default_compute;
-	}
+	size_t const n_opcodes = ir_get_n_opcodes();
+	compute_funcs = XMALLOCN(compute_func, n_opcodes);
+	for (size_t i = 0; i < n_opcodes; ++i)
+		compute_funcs[i] = default_compute;
 
 	/* set specific functions */
 	set_compute_func(op_Add,     compute_Add);
@@ -3267,6 +3271,7 @@ void combo(ir_graph *irg)
 	/* remove the partition hook */
 	DEBUG_ONLY(set_dump_node_vcgattr_hook(NULL);)
 
+	free(compute_funcs);
 	DEL_ARR_F(env.kept_memory);
 	del_set(env.opcode2id_map);
 	obstack_free(&env.obst, NULL);
@@ -18,6 +18,10 @@
  *            |
  *         Conv Hs
  *
+ * A conversion into an intermediate mode, which is followed by another
+ * conversion, is left out if value range propagation shows that the value
+ * fits into the intermediate mode.
+ *
  * TODO: * try to optimize cmp modes
  *       * decide when it is useful to move the convs through phis
  */
@@ -241,6 +245,25 @@ static ir_node *conv_transform(ir_node *node, ir_mode *dest_mode)
 	return new_node;
 }
 
+/** Checks whether value range propagation shows that all values of @p node
+ * are representable in @p mode. */
+static bool value_fits_mode(const ir_node *node, ir_mode *mode)
+{
+	const vrp_attr *vrp = vrp_get_info(node);
+	if (vrp == NULL || vrp->range_type != VRP_RANGE)
+		return false;
+
+	ir_mode *const node_mode = get_irn_mode(node);
+	ir_tarval *const bounds[] = { vrp->range_bottom, vrp->range_top };
+	for (size_t i = 0; i < ARRAY_SIZE(bounds); ++i) {
+		ir_tarval *const conved = tarval_convert_to(bounds[i], mode);
+		if (tarval_is_negative(conved) != tarval_is_negative(bounds[i])
+		    || tarval_convert_to(conved, node_mode) != bounds[i])
+			return false;
+	}
+	return true;
+}
+
 static void conv_opt_walker(ir_node *node, void *data)
 {
 	bool *const changed = (bool*)data;
@@ -257,6 +280,22 @@ static void conv_opt_walker(ir_node *node, void *data)
 	if (mode_is_reference(pred_mode))
 		return;
 
+	/* Conv(Conv(x)) -> Conv(x) if x fits into the intermediate mode */
+	if (is_Conv(pred) && mode_is_int(mode) && mode_is_int(pred_mode)) {
+		ir_node *const op      = get_Conv_op(pred);
+		ir_mode *const op_mode = get_irn_mode(op);
+		if (mode_is_int(op_mode) && value_fits_mode(op, pred_mode)) {
+			DB((dbg, LEVEL_2, "%+F fits into %+F at %+F\n", op, pred_mode,
+			    node));
+			ir_node *const res = op_mode == mode ? op
+				: new_rd_Conv(get_irn_dbg_info(node), get_nodes_block(node), op,
+				              mode);
+			exchange(node, res);
+			*changed = true;
+			return;
+		}
+	}
+
 	if (!is_Phi(pred) && !is_downconv(pred_mode, mode))
 		return;
 
@@ -281,6 +320,11 @@ void conv_opt(ir_graph *irg)
 
 	DB((dbg, LEVEL_1, "===> Performing conversion optimization on %+F\n", irg));
 
+	/* The ranges are computed once: the transformations keep the values of
+	 * existing nodes, new nodes have no range and are treated as unknown.
+	 * Recomputing them would need the dominance, which local_optimize_graph()
+	 * does not keep. */
+	set_vrp_data(irg);
 	bool global_changed = false;
 	bool changed;
 	do {
@@ -290,6 +334,7 @@ void conv_opt(ir_graph *irg)
 			local_optimize_graph(irg);
 		global_changed |= changed;
 	} while (changed);
+	free_vrp_data(irg);
 
 	confirm_irg_properties(irg,
 		global_changed ? IR_GRAPH_PROPERTIES_NONE : IR_GRAPH_PROPERTIES_ALL);
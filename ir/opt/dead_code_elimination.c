@@ -12,13 +12,16 @@
  * which is not used can't be found by any walker.
  * The only drawback is that the nodes still take up memory. This phase fixes
  * this by copying all (reachable) nodes to a new obstack and throwing away
- * the old one.
+ * the old one. Alternatively dead_node_compaction() keeps the reachable nodes
+ * in place and hands the memory of all other nodes to the free lists of the
+ * graph, from which new nodes are allocated.
  */
 #include "cgana.h"
 #include "iredges_t.h"
 #include "irgraph_t.h"
 #include "irgwalk.h"
 #include "irhooks.h"
+#include "irmemory_t.h"
 #include "irnode_t.h"
 #include "iropt_t.h"
 #include "iroptimize.h"
@@ -42,7 +45,7 @@ static void copy_node_dce(ir_node *node, void *env)
 	(void)env;
 	ir_node *new_node = exact_copy(node);
 	/* preserve the node numbers for easier debugging */
-	new_node->node_nr = node->node_nr;
+	copy_irn_node_nr(new_node, node);
 	set_irn_link(node, new_node);
 }
 
@@ -65,23 +68,32 @@ static void copy_graph_env(ir_graph *irg)
 }
 
 /**
- * Copies all reachable nodes to a new obstack.  Removes bad inputs
- * from block nodes and the corresponding inputs from Phi nodes.
- * Merges single exit blocks with single entry blocks and removes
- * 1-input Phis.
- * Adds all new nodes to a new hash table for CSE.  Does not
- * perform CSE, so the hash table might contain common subexpressions.
+ * Frees analysis information, which refers to dead nodes.
  */
-void dead_node_elimination(ir_graph *irg)
+static void free_graph_state(ir_graph *irg)
 {
 	edges_deactivate(irg);
 
-	/* Handle graph state */
 	free_callee_info(irg);
 	free_irg_outs(irg);
 	free_loop_information(irg);
 	free_vrp_data(irg);
+	ir_free_alias_oracle(irg);
+	free_irg_points_to(irg);
 	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+}
+
+/**
+ * Copies all reachable nodes to a new obstack.  Removes bad inputs
+ * from block nodes and the corresponding inputs from Phi nodes.
+ * Merges single exit blocks with single entry blocks and removes
+ * 1-input Phis.
+ * Adds all new nodes to a new hash table for CSE.  Does not
+ * perform CSE, so the hash table might contain common subexpressions.
+ */
+void dead_node_elimination(ir_graph *irg)
+{
+	free_graph_state(irg);
 
 	/* A quiet place, where the old obstack can rest in peace,
 	   until it will be cremated. */
@@ -90,6 +102,7 @@ void dead_node_elimination(ir_graph *irg)
 	/* A new obstack, where the reachable nodes will be copied to. */
 	obstack_init(&irg->obst);
 	irg->last_node_idx = 0;
+	memset(irg->free_nodes, 0, sizeof(irg->free_nodes));
 
 	/* We also need a new value table for CSE */
 	new_identities(irg);
@@ -102,3 +115,50 @@ void dead_node_elimination(ir_graph *irg)
 	/* Free memory from old unoptimized obstack */
 	obstack_free(&graveyard_obst, 0);  /* First empty the obstack ... */
 }
+
+static void count_node(ir_node *node, void *env)
+{
+	(void)node;
+	unsigned *n_live = (unsigned*)env;
+	++*n_live;
+}
+
+void dead_node_compaction(ir_graph *irg)
+{
+	free_graph_state(irg);
+	/* The nodes keep their (now stale) out arrays. */
+	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS
+	                   | IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+
+	/* The value table contains dead nodes, start with a new one. */
+	new_identities(irg);
+
+	/* Mark the reachable nodes. Walking the inputs also removes Id nodes. */
+	unsigned n_live = 0;
+	irg_walk_in_or_dep(irg->anchor, count_node, NULL, &n_live);
+
+	/* Recycle the unreachable nodes and renumber the others densely in their
+	 * old order. Indices only shrink, so the entries can be moved down. */
+	unsigned const last_idx = irg->last_node_idx;
+	unsigned       new_idx  = 0;
+	for (unsigned idx = 0; idx < last_idx; ++idx) {
+		ir_node *const node = irg->idx_irn_map[idx];
+		if (node == NULL)
+			continue;
+		if (!irn_visited(node)) {
+			irg_free_node_memory(irg, node);
+			continue;
+		}
+
+		irg->idx_irn_map[new_idx]     = node;
+		irg->idx_alloc_class[new_idx] = irg->idx_alloc_class[idx];
+#ifdef FIRM_COMPACT_NODES
+		irg->node_cold[new_idx]       = irg->node_cold[idx];
+#endif
+		node->node_idx = new_idx++;
+	}
+	assert(new_idx == n_live);
+	for (unsigned idx = new_idx; idx < last_idx; ++idx)
+		irg->idx_irn_map[idx] = NULL;
+	irg->last_node_idx = new_idx;
+}
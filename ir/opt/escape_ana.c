@@ -0,0 +1,598 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Interprocedural escape analysis and stack allocation of objects.
+ *
+ * For every method the analysis determines which pointer parameters escape,
+ * i.e. may be stored to memory, returned, freed or passed to code outside the
+ * program.  The summaries start optimistic and are iterated along the call
+ * graph (as determined by cgana()) until a fixpoint is reached.
+ *
+ * Afterwards objects allocated by an Alloc node or by a call of malloc() with
+ * a constant size are moved to the stack frame, if their address neither
+ * escapes the allocating method nor is merged with other addresses by a Phi or
+ * Mux.  Then at most one instance of such an object is accessible at any
+ * time, so a single frame entity can hold all of them, and frees of the
+ * object are removed.  The entity gets the type the object is accessed with
+ * if possible, such that scalar_replacement_opt() can replace it by values.
+ */
+#include "array.h"
+#include "callgraph_t.h"
+#include "cgana.h"
+#include "debug.h"
+#include "ircons.h"
+#include "iredges_t.h"
+#include "irgmod.h"
+#include "irgraph_t.h"
+#include "irgwalk.h"
+#include "irnode_t.h"
+#include "iroptimize.h"
+#include "irprog_t.h"
+#include "obst.h"
+#include "raw_bitset.h"
+#include "target.h"
+#include "tv.h"
+#include "type_t.h"
+#include "util.h"
+#include <stdlib.h>
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+
+/** Objects bigger than this (in bytes) are not moved to the stack frame. */
+#define MAX_STACK_OBJECT_SIZE 1024
+
+typedef struct func_info_t {
+	ir_graph *irg;
+	size_t    n_params;
+	unsigned *escaping;    /**< parameters whose address escapes */
+} func_info_t;
+
+/** An access of an object with a known offset. */
+typedef struct access_t {
+	ir_node   *node;    /**< the Load or Store */
+	long       offset;
+	ir_mode   *mode;
+	ir_type   *type;
+	ir_entity *field;   /**< the member of the synthesized layout */
+} access_t;
+
+/** The linker names of malloc() and free(). */
+static ident *malloc_id;
+static ident *free_id;
+
+static bool is_malloc_call(ir_node const *const call)
+{
+	ir_entity *const callee = get_Call_callee(call);
+	return callee != NULL
+	    && get_entity_ld_ident(callee) == malloc_id
+	    && get_entity_linktime_irg(callee) == NULL
+	    && (get_entity_additional_properties(callee) & mtp_property_malloc)
+	    && get_Call_n_params(call) == 1;
+}
+
+static bool is_free_call(ir_node const *const call)
+{
+	ir_entity *const callee = get_Call_callee(call);
+	return callee != NULL
+	    && get_entity_ld_ident(callee) == free_id
+	    && get_entity_linktime_irg(callee) == NULL
+	    && get_Call_n_params(call) == 1;
+}
+
+/**
+ * Creates the method infos, initially no parameter escapes.  Needs out edges
+ * to find the uses of the parameters.
+ */
+static void init_func_infos(struct obstack *const obst)
+{
+	foreach_irp_irg(i, irg) {
+		assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
+
+		ir_type     *const mtp  = get_entity_type(get_irg_entity(irg));
+		func_info_t *const info = OALLOC(obst, func_info_t);
+		info->irg      = irg;
+		info->n_params = get_method_n_params(mtp);
+		info->escaping = rbitset_obstack_alloc(obst, info->n_params);
+		set_irg_link(irg, info);
+	}
+}
+
+static bool is_callee_param_escaping(ir_entity *const callee, size_t const pos)
+{
+	if (is_unknown_entity(callee))
+		return true;
+	ir_graph *const irg = get_entity_linktime_irg(callee);
+	if (irg == NULL)
+		return true;
+	func_info_t const *const info = (func_info_t const*)get_irg_link(irg);
+	return pos >= info->n_params || rbitset_is_set(info->escaping, pos);
+}
+
+/** Checks whether the argument @p pos of @p call may escape in a callee. */
+static bool is_param_escaping(ir_node const *const call, size_t const pos)
+{
+	ir_entity *const callee = get_Call_callee(call);
+	if (callee != NULL)
+		return is_callee_param_escaping(callee, pos);
+	if (!cg_call_has_callees(call))
+		return true;
+	for (size_t i = 0, n = cg_get_call_n_callees(call); i < n; ++i) {
+		if (is_callee_param_escaping(cg_get_call_callee(call, i), pos))
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Checks whether the address @p node escapes.  If @p object is not NULL,
+ * @p node is derived from the address @p object of a fresh allocation, which
+ * must not be merged with other addresses, and frees of @p object are
+ * appended to @p frees.  Visited nodes are marked.
+ */
+static bool is_escaping(ir_node *const node, ir_node const *const object,
+                        ir_node ***const frees)
+{
+	mark_irn_visited(node);
+	foreach_out_edge(node, edge) {
+		ir_node *const succ = get_edge_src_irn(edge);
+		int      const pos  = get_edge_src_pos(edge);
+		switch (get_irn_opcode(succ)) {
+		case iro_Load:
+		case iro_CopyB:
+		case iro_Cmp:
+		case iro_End:
+			continue;
+
+		case iro_Store:
+			if (pos == n_Store_value)
+				return true;
+			continue;
+
+		case iro_Confirm:
+			if (pos == n_Confirm_bound)
+				continue;
+			break;
+
+		case iro_Add:
+		case iro_Sub:
+		case iro_Member:
+		case iro_Sel:
+		case iro_Id:
+			break;
+
+		case iro_Phi:
+		case iro_Mux:
+			if (object != NULL)
+				return true;
+			break;
+
+		case iro_Free:
+			if (node != object)
+				return true;
+			ARR_APP1(ir_node*, *frees, succ);
+			continue;
+
+		case iro_Call:
+			if (pos == n_Call_ptr)
+				return true;
+			if (is_free_call(succ)) {
+				if (node != object)
+					return true;
+				ARR_APP1(ir_node*, *frees, succ);
+				continue;
+			}
+			if (is_param_escaping(succ, pos - (n_Call_max + 1)))
+				return true;
+			continue;
+
+		default:
+			return true;
+		}
+
+		/* succ computes an address from node */
+		if (!mode_is_reference(get_irn_mode(succ)))
+			return true;
+		if (!irn_visited(succ) && is_escaping(succ, object, frees))
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Determines the escaping parameters of a graph.  Returns true if a parameter
+ * escapes which was not known to escape before.
+ */
+static bool analyze_graph(func_info_t *const info)
+{
+	ir_graph *const irg     = info->irg;
+	bool            changed = false;
+	foreach_out_edge(get_irg_args(irg), edge) {
+		ir_node *const proj = get_edge_src_irn(edge);
+		if (!is_Proj(proj) || !mode_is_reference(get_irn_mode(proj)))
+			continue;
+		unsigned const num = get_Proj_num(proj);
+		if (rbitset_is_set(info->escaping, num))
+			continue;
+
+		inc_irg_visited(irg);
+		if (is_escaping(proj, NULL, NULL)) {
+			DB((dbg, LEVEL_2, "parameter %u of %+F escapes\n", num, irg));
+			rbitset_set(info->escaping, num);
+			changed = true;
+		}
+	}
+	return changed;
+}
+
+/**
+ * Escaping parameters only grow, so a graph is re-evaluated only if an
+ * argument it passes may now escape in one of its callees.
+ */
+static void solve(cg_worklist_t *const wl)
+{
+	for (ir_graph *irg; (irg = cg_worklist_pop(wl)) != NULL;) {
+		DB((dbg, LEVEL_2, "evaluating %+F\n", irg));
+		func_info_t *const info = (func_info_t*)get_irg_link(irg);
+		if (analyze_graph(info))
+			cg_worklist_push_callers(wl, irg);
+	}
+}
+
+static void collect_allocations(ir_node *const node, void *const env)
+{
+	ir_node ***const allocs = (ir_node***)env;
+	if (is_Alloc(node) || (is_Call(node) && is_malloc_call(node)))
+		ARR_APP1(ir_node*, *allocs, node);
+}
+
+/**
+ * Finds the Proj @p num of @p node.  Returns false if there are several of
+ * them, *res is NULL if there is none.
+ */
+static bool find_single_proj(ir_node const *const node, unsigned const num,
+                             ir_node **const res)
+{
+	*res = NULL;
+	foreach_out_edge(node, edge) {
+		ir_node *const proj = get_edge_src_irn(edge);
+		if (!is_Proj(proj) || get_Proj_num(proj) != num)
+			continue;
+		if (*res != NULL)
+			return false;
+		*res = proj;
+	}
+	return true;
+}
+
+/**
+ * Returns the address of the object allocated by @p alloc in *res.  Returns
+ * false if the address is not unique.
+ */
+static bool find_object_address(ir_node const *const alloc, ir_node **const res)
+{
+	if (is_Alloc(alloc))
+		return find_single_proj(alloc, pn_Alloc_res, res);
+
+	ir_node *tuple;
+	if (!find_single_proj(alloc, pn_Call_T_result, &tuple))
+		return false;
+	if (tuple == NULL) {
+		*res = NULL;
+		return true;
+	}
+	return find_single_proj(tuple, 0, res);
+}
+
+/** Returns the constant size of the object allocated by @p alloc or 0. */
+static unsigned get_object_size(ir_node const *const alloc)
+{
+	ir_node const *const size = is_Alloc(alloc)
+		? get_Alloc_size(alloc) : get_Call_param(alloc, 0);
+	if (!is_Const(size))
+		return 0;
+	ir_tarval *const tv = get_Const_tarval(size);
+	if (!tarval_is_long(tv))
+		return 0;
+	long const val = get_tarval_long(tv);
+	if (val <= 0 || val > MAX_STACK_OBJECT_SIZE)
+		return 0;
+	return (unsigned)val;
+}
+
+static bool is_free(ir_node const *const node)
+{
+	return is_Free(node) || (is_Call(node) && is_free_call(node));
+}
+
+/**
+ * Returns the compound type the object at @p addr is accessed with, if all
+ * accesses select a member of the same compound type of size @p size.
+ */
+static ir_type *find_compound_type(ir_node const *const addr,
+                                   unsigned const size)
+{
+	ir_type *type = NULL;
+	foreach_out_edge(addr, edge) {
+		ir_node *const succ = get_edge_src_irn(edge);
+		if (is_free(succ))
+			continue;
+		if (!is_Member(succ))
+			return NULL;
+		ir_type *const owner = get_entity_owner(get_Member_entity(succ));
+		if (type != NULL && owner != type)
+			return NULL;
+		type = owner;
+	}
+	if (type == NULL || !(is_Struct_type(type) || is_Class_type(type))
+	 || get_type_state(type) != layout_fixed || get_type_size(type) != size)
+		return NULL;
+	return type;
+}
+
+static bool add_access(access_t **const accesses, ir_node *const node,
+                       ir_node const *const addr, long const offset)
+{
+	ir_mode *mode;
+	ir_type *type;
+	if (is_Load(node)) {
+		mode = get_Load_mode(node);
+		type = get_Load_type(node);
+	} else if (is_Store(node) && get_Store_ptr(node) == addr) {
+		mode = get_irn_mode(get_Store_value(node));
+		type = get_Store_type(node);
+	} else {
+		return false;
+	}
+	/* hidden conversions are not representable by a member */
+	if (get_type_mode(type) != mode)
+		return false;
+
+	access_t const access = {
+		.node   = node,
+		.offset = offset,
+		.mode   = mode,
+		.type   = type,
+		.field  = NULL,
+	};
+	ARR_APP1(access_t, *accesses, access);
+	return true;
+}
+
+/**
+ * Collects the Loads and Stores of the object at @p addr, which must access
+ * it directly or at a constant offset.
+ */
+static bool collect_accesses(access_t **const accesses, ir_node const *const addr)
+{
+	foreach_out_edge(addr, edge) {
+		ir_node *const succ = get_edge_src_irn(edge);
+		if (is_free(succ))
+			continue;
+		if (!is_Add(succ)) {
+			if (!add_access(accesses, succ, addr, 0))
+				return false;
+			continue;
+		}
+
+		ir_node *const offset = get_Add_left(succ) == addr
+			? get_Add_right(succ) : get_Add_left(succ);
+		if (!is_Const(offset) || !tarval_is_long(get_Const_tarval(offset)))
+			return false;
+		long const val = get_tarval_long(get_Const_tarval(offset));
+		foreach_out_edge(succ, add_edge) {
+			if (!add_access(accesses, get_edge_src_irn(add_edge), succ, val))
+				return false;
+		}
+	}
+	return true;
+}
+
+static int cmp_access(void const *const a, void const *const b)
+{
+	access_t const *const ac = (access_t const*)a;
+	access_t const *const bc = (access_t const*)b;
+	return (ac->offset > bc->offset) - (ac->offset < bc->offset);
+}
+
+/**
+ * Synthesizes a struct type of size @p size with a member for every offset
+ * of the @p accesses.  The members are recorded in the
+ * accesses.  Returns NULL if the accesses overlap.
+ */
+static ir_type *synthesize_layout(access_t *const accesses, unsigned const size)
+{
+	size_t const n_accesses = ARR_LEN(accesses);
+	if (n_accesses == 0)
+		return NULL;
+	QSORT_ARR(accesses, cmp_access);
+
+	long end = 0;
+	for (size_t i = 0; i < n_accesses; ++i) {
+		access_t *const access = &accesses[i];
+		if (i > 0 && access->offset == accesses[i - 1].offset) {
+			if (access->mode != accesses[i - 1].mode)
+				return NULL;
+			continue;
+		}
+		if (access->offset < end)
+			return NULL;
+		end = access->offset + (long)get_type_size(access->type);
+	}
+	if (end > (long)size)
+		return NULL;
+
+	ir_type  *const type  = new_type_struct(id_unique("$alloc_layout"));
+	unsigned        align = 1;
+	for (size_t i = 0; i < n_accesses; ++i) {
+		access_t *const access = &accesses[i];
+		if (i > 0 && access->offset == accesses[i - 1].offset) {
+			access->field = accesses[i - 1].field;
+			continue;
+		}
+		ir_entity *const field
+			= new_entity(type, id_unique("$alloc_field"), access->type);
+		set_entity_offset(field, (int)access->offset);
+		align         = MAX(align, get_type_alignment(access->type));
+		access->field = field;
+	}
+	set_type_size(type, size);
+	set_type_alignment(type, align);
+	set_type_state(type, layout_fixed);
+	return type;
+}
+
+/** Removes the free @p node of an object moved to the stack frame. */
+static void remove_free(ir_node *const node)
+{
+	if (is_Free(node)) {
+		exchange(node, get_Free_mem(node));
+		return;
+	}
+
+	ir_graph *const irg   = get_irn_irg(node);
+	ir_node  *const block = get_nodes_block(node);
+	ir_node  *in[pn_Call_max + 1] = {
+		[pn_Call_M]        = get_Call_mem(node),
+		[pn_Call_T_result] = new_r_Bad(irg, mode_T),
+	};
+	int n_in = 2;
+	if (ir_throws_exception(node)) {
+		in[pn_Call_X_regular] = new_r_Jmp(block);
+		in[pn_Call_X_except]  = new_r_Bad(irg, mode_X);
+		n_in = 4;
+	}
+	turn_into_tuple(node, n_in, in);
+}
+
+/** Replaces the allocation @p alloc by the frame address @p addr. */
+static void remove_allocation(ir_node *const alloc, ir_node *addr)
+{
+	if (is_Alloc(alloc)) {
+		ir_node *const in[] = {
+			[pn_Alloc_M]   = get_Alloc_mem(alloc),
+			[pn_Alloc_res] = addr,
+		};
+		turn_into_tuple(alloc, ARRAY_SIZE(in), in);
+		return;
+	}
+
+	ir_graph *const irg   = get_irn_irg(alloc);
+	ir_node  *const block = get_nodes_block(alloc);
+	ir_node  *in[pn_Call_max + 1] = {
+		[pn_Call_M]        = get_Call_mem(alloc),
+		[pn_Call_T_result] = new_r_Tuple(block, 1, &addr),
+	};
+	int n_in = 2;
+	if (ir_throws_exception(alloc)) {
+		in[pn_Call_X_regular] = new_r_Jmp(block);
+		in[pn_Call_X_except]  = new_r_Bad(irg, mode_X);
+		n_in = 4;
+	}
+	turn_into_tuple(alloc, n_in, in);
+}
+
+/**
+ * Moves the object allocated by @p alloc to the stack frame if its address
+ * does not escape.
+ */
+static bool move_to_frame(ir_node *const alloc)
+{
+	unsigned const size = get_object_size(alloc);
+	ir_node       *addr;
+	if (size == 0 || !find_object_address(alloc, &addr))
+		return false;
+
+	ir_graph *const irg   = get_irn_irg(alloc);
+	ir_node **frees = NEW_ARR_F(ir_node*, 0);
+	if (addr != NULL) {
+		inc_irg_visited(irg);
+		if (is_escaping(addr, addr, &frees)) {
+			DEL_ARR_F(frees);
+			return false;
+		}
+	}
+
+	access_t *accesses = NEW_ARR_F(access_t, 0);
+	ir_type  *type     = NULL;
+	if (addr != NULL) {
+		type = find_compound_type(addr, size);
+		if (type == NULL && collect_accesses(&accesses, addr))
+			type = synthesize_layout(accesses, size);
+		else
+			ARR_SHRINKLEN(accesses, 0);
+	}
+	if (type == NULL)
+		type = new_type_array(get_type_for_mode(mode_Bu), size);
+
+	unsigned const align = is_Alloc(alloc)
+		? get_Alloc_alignment(alloc) : ir_target_biggest_alignment();
+	ir_type   *const frame_type = get_irg_frame_type(irg);
+	ir_entity *const ent        = new_entity(frame_type, id_unique("$alloc"), type);
+	set_entity_alignment(ent, MAX(align, get_type_alignment(type)));
+	DB((dbg, LEVEL_1, "%+F: moving object of %+F to %+F\n", irg, alloc, ent));
+
+	ir_node *const start = get_irg_start_block(irg);
+	ir_node *const frame = new_r_Member(start, get_irg_frame(irg), ent);
+	for (size_t i = 0, n = ARR_LEN(accesses); i < n; ++i) {
+		access_t const *const access = &accesses[i];
+		ir_node        *const member = new_r_Member(start, frame, access->field);
+		if (is_Load(access->node))
+			set_Load_ptr(access->node, member);
+		else
+			set_Store_ptr(access->node, member);
+	}
+	for (size_t i = 0, n = ARR_LEN(frees); i < n; ++i)
+		remove_free(frees[i]);
+	remove_allocation(alloc, frame);
+
+	DEL_ARR_F(accesses);
+	DEL_ARR_F(frees);
+	return true;
+}
+
+/** Moves the non-escaping objects allocated in @p irg to the stack frame. */
+static void transform_graph(ir_graph *const irg)
+{
+	bool changed = false;
+	if (get_type_state(get_irg_frame_type(irg)) != layout_fixed) {
+		ir_node **allocs = NEW_ARR_F(ir_node*, 0);
+		irg_walk_graph(irg, NULL, collect_allocations, &allocs);
+		for (size_t i = 0, n = ARR_LEN(allocs); i < n; ++i)
+			changed |= move_to_frame(allocs[i]);
+		DEL_ARR_F(allocs);
+	}
+
+	confirm_irg_properties(irg, changed
+		? IR_GRAPH_PROPERTIES_NONE : IR_GRAPH_PROPERTIES_ALL);
+	if (changed)
+		scalar_replacement_opt(irg);
+}
+
+void escape_analysis(void)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.opt.escape_ana");
+
+	malloc_id = ir_platform_mangle_global("malloc");
+	free_id   = ir_platform_mangle_global("free");
+
+	struct obstack obst;
+	obstack_init(&obst);
+	irp_reserve_resources(irp, IRP_RESOURCE_IRG_LINK);
+
+	cg_worklist_t wl;
+	cg_worklist_init(&wl);
+	init_func_infos(&obst);
+	solve(&wl);
+
+	foreach_irp_irg(i, irg) {
+		transform_graph(irg);
+	}
+
+	irp_free_resources(irp, IRP_RESOURCE_IRG_LINK);
+	cg_worklist_free(&wl);
+	obstack_free(&obst, NULL);
+}
@@ -47,6 +47,7 @@ static void visit_initializer(ir_initializer_t *initializer)
 		return;
 	case IR_INITIALIZER_TARVAL:
 	case IR_INITIALIZER_NULL:
+	case IR_INITIALIZER_BYTES:
 		return;
 
 	case IR_INITIALIZER_COMPOUND: {
@@ -20,6 +20,7 @@
 #include "irgraph_t.h"
 #include "irgwalk.h"
 #include "irloop.h"
+#include "irmemory.h"
 #include "irnode_t.h"
 #include "irnodehashmap.h"
 #include "irnodeset.h"
@@ -45,7 +46,8 @@
 #define COMMON_DOM 1
 
 /* Seamless implementation of handling loads and generally memory
-   dependent nodes with GVN-PRE. */
+   dependent nodes with GVN-PRE. Loads are numbered by their memory
+   version, so stores to other addresses do not kill them. */
 #define LOADS 1
 #define DIVMODS 0
 
@@ -95,6 +97,8 @@ typedef struct pre_env {
 	block_info     *list;         /* block_info list head */
 	elim_pair      *pairs;        /* elim_pair list head */
 	ir_nodeset_t   *keeps;        /* a list of to be removed phis to kill their keep alive edges */
+	ir_nodeset_t   *dead_loads;   /* loads whose result has been replaced */
+	ir_node       **load_mems;    /* memory projections of versioned loads */
 	unsigned        last_idx;     /* last node index of input graph */
 	char            changes;      /* flag for fixed point iterations - non-zero if changes occurred */
 	char            first_iter;   /* non-zero for first fixed point iteration */
@@ -105,10 +109,13 @@ typedef struct pre_env {
 #endif
 } pre_env;
 
-static pre_env *environment;
+static FIRM_THREAD_LOCAL pre_env *environment;
 
 /* custom GVN value map */
-static ir_nodehashmap_t value_map;
+static FIRM_THREAD_LOCAL ir_nodehashmap_t value_map;
+
+/* memory versions of loads */
+static FIRM_THREAD_LOCAL ir_nodehashmap_t mem_version_map;
 
 /* debug module handle */
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
@@ -133,7 +140,7 @@ typedef struct gvnpre_statistics {
 	int infinite_loops;
 } gvnpre_statistics;
 
-static gvnpre_statistics *gvnpre_stats = NULL;
+static FIRM_THREAD_LOCAL gvnpre_statistics *gvnpre_stats = NULL;
 
 static void init_stats(void)
 {
@@ -215,6 +222,81 @@ static void dump_all_expgen_sets(block_info *list)
 
 #endif /* DEBUG_libfirm */
 
+/* --------------------------------------------------------
+ * Memory versions
+ * --------------------------------------------------------
+ */
+
+/**
+ * Returns non-zero if load is handled with memory versions.
+ */
+static unsigned is_versioned_load(const ir_node *n)
+{
+#if LOADS
+	return is_Load(n)
+	    && get_Load_volatility(n) == volatility_non_volatile
+	    && !ir_throws_exception(n);
+#else
+	(void)n;
+	return 0;
+#endif
+}
+
+/**
+ * Returns the memory version of a load: the nearest memory state on its
+ * memory chain that may change the loaded value. Other loads and stores
+ * which do not alias are skipped, so loads of the same address get the
+ * same version as long as nothing in between writes to it. The walk
+ * stops at Phis, which are the merge points of memory SSA.
+ */
+static ir_node *get_mem_version(ir_node *load)
+{
+	ir_node *version = ir_nodehashmap_get(ir_node, &mem_version_map, load);
+	if (version != NULL)
+		return version;
+
+	const ir_node *ptr       = get_Load_ptr(load);
+	const ir_type *load_type = get_Load_type(load);
+	unsigned       load_size = get_mode_size_bytes(get_Load_mode(load));
+
+	ir_node *mem = get_Load_mem(load);
+	while (is_Proj(mem)) {
+		ir_node *pred = get_Proj_pred(mem);
+		if (is_Load(pred)) {
+			if (get_Load_volatility(pred) != volatility_non_volatile)
+				break;
+			mem = get_Load_mem(pred);
+		} else if (is_Store(pred)) {
+			const ir_node *value      = get_Store_value(pred);
+			unsigned       store_size = get_mode_size_bytes(get_irn_mode(value));
+			if (get_Store_volatility(pred) != volatility_non_volatile)
+				break;
+			ir_alias_relation rel = get_alias_relation(
+				get_Store_ptr(pred), get_Store_type(pred), store_size,
+				ptr, load_type, load_size);
+			if (rel != ir_no_alias)
+				break;
+			mem = get_Store_mem(pred);
+		} else {
+			break;
+		}
+	}
+
+	ir_nodehashmap_insert(&mem_version_map, load, mem);
+	return mem;
+}
+
+/**
+ * Returns the predecessor pos of node as seen by GVN-PRE.
+ * The memory of a load is replaced by its memory version.
+ */
+static ir_node *get_pre_pred(ir_node *node, int pos)
+{
+	if (pos == n_Load_mem && is_versioned_load(node))
+		return get_mem_version(node);
+	return get_irn_n(node, pos);
+}
+
 /* --------------------------------------------------------
  * GVN Functions
  * --------------------------------------------------------
@@ -273,7 +355,7 @@ static int compare_gvn_identities(const void *elt, const void *key)
 
 	/* here, we already now that the nodes are identical except their
 	 * attributes */
-	return !a->op->ops.attrs_equal(a, b);
+	return !get_irn_op(a)->ops.attrs_equal(a, b);
 }
 
 /**
@@ -310,12 +392,21 @@ static ir_node *identify(ir_node *irn)
  */
 static ir_node *remember(ir_node *irn)
 {
+	/* The memory of a load is one of its own, so it is never merged
+	   with the memory of an equal load. */
+	if (is_Proj(irn) && get_irn_mode(irn) == mode_M
+	    && is_versioned_load(get_Proj_pred(irn))) {
+		ir_nodehashmap_insert(&value_map, irn, irn);
+		return irn;
+	}
+
 	int       arity   = get_irn_arity(irn);
 	int       changed = 0;
 	ir_node **in      = XMALLOCN(ir_node *, arity);
 	ir_node  *value;
 
-	foreach_irn_in(irn, i, pred) {
+	for (int i = 0; i < arity; ++i) {
+		ir_node *pred = get_pre_pred(irn, i);
 		/* value and leader at the same time */
 		ir_node *pred_value = identify(pred);
 
@@ -333,7 +424,12 @@ static ir_node *remember(ir_node *irn)
 		in[i] = pred_value;
 	}
 
-	if (changed && !is_memop(irn) && get_irn_mode(irn) != mode_X) {
+	/* loads are represented by their memory version */
+	if (is_versioned_load(irn) && in[n_Load_mem] != get_Load_mem(irn))
+		changed = 1;
+
+	if (changed && (!is_memop(irn) || is_versioned_load(irn))
+	    && get_irn_mode(irn) != mode_X) {
 		/* create representative for */
 		ir_node *nn = new_similar_node(irn, get_nodes_block(irn), in);
 
@@ -603,6 +699,9 @@ static unsigned is_nice_value(ir_node *n)
 		return 1;
 
 #if LOADS || DIVMODS
+	/* the memory of a load is never redundant */
+	if (is_Proj(n) && mode == mode_M && is_Load(get_Proj_pred(n)))
+		return 0;
 	if (is_Proj(n) && mode != mode_X && mode != mode_T)
 		return 1;
 #else
@@ -612,7 +711,7 @@ static unsigned is_nice_value(ir_node *n)
 
 #if LOADS
 	if (is_Load(n))
-		return get_Load_volatility(n) == volatility_non_volatile;
+		return is_versioned_load(n);
 	if (is_Store(n))
 		return get_Store_volatility(n) == volatility_non_volatile;
 #endif
@@ -643,9 +742,13 @@ static unsigned is_clean_in_block(ir_node *n, ir_node *block, ir_valueset_t *val
 		return 0;
 
 #if LOADS
-	/* filter loads with no phi predecessor from antic_in */
-	if (is_Load(n) && !is_Phi(get_Load_mem(n)))
-		return 0;
+	/* filter loads whose memory version is not available at block entry:
+	   it has to be a phi of this block or come from a dominator */
+	if (is_Load(n)) {
+		ir_node *version = get_mem_version(n);
+		if (!is_Phi(version) && get_nodes_block(version) == block)
+			return 0;
+	}
 	if (is_Store(n) && !is_Phi(get_Store_mem(n)))
 		return 0;
 #endif
@@ -664,7 +767,8 @@ static unsigned is_clean_in_block(ir_node *n, ir_node *block, ir_valueset_t *val
 		return 0;
 #endif
 
-	foreach_irn_in(n, i, pred) {
+	for (int i = 0, arity = get_irn_arity(n); i < arity; ++i) {
+		ir_node *pred = get_pre_pred(n, i);
 		if (is_Phi(pred))
 			continue;
 
@@ -793,7 +897,8 @@ static ir_node *phi_translate(ir_node *node, ir_node *block, int pos, ir_valuese
 	   the main representative. If we access a node as representative of a
 	   value we always use the anti leader. The anti leader can be found by
 	   antic_in(identify(node)). */
-	foreach_irn_in(node, i, pred) {
+	for (int i = 0; i < arity; ++i) {
+		ir_node *pred   = get_pre_pred(node, i);
 		ir_node *value  = identify(pred);
 		/* get leader for pred to lookup its translated value */
 		ir_node *leader = ir_valueset_lookup(leaderset, value);
@@ -834,7 +939,10 @@ static ir_node *phi_translate(ir_node *node, ir_node *block, int pos, ir_valuese
 				/* If we do not translate this node, we will get its value wrong. */
 				needed |= 1;
 
-				if (is_Load(loadstore)) {
+				if (is_versioned_load(node)) {
+					/* Keep the memory, remember() computes the memory
+					   version of the translated load. */
+				} else if (is_Load(loadstore)) {
 					/* Put new load under the adjacent loads memory edge
 					   such that GVN may compare them. */
 					new_pred = get_Load_mem(loadstore);
@@ -1163,7 +1271,8 @@ static unsigned is_hoisting_greedy(ir_node *irn, ir_node *block)
 		ir_node    *pred_block = get_Block_cfgpred_block(block, pos);
 		block_info *pred_info  = get_block_info(pred_block);
 
-		foreach_irn_in(irn, i, pred) {
+		for (int i = 0, arity = get_irn_arity(irn); i < arity; ++i) {
+			ir_node *pred = get_pre_pred(irn, i);
 #if MIN_CUT
 			/* Very conservative min cut. Phi might only have 1 user. */
 			if (is_Phi(pred) && get_irn_n_edges(pred) != 1)
@@ -1298,6 +1407,16 @@ static void insert_nodes_walker(ir_node *block, void *ctx)
 			continue;
 		}
 
+#if LOADS
+		/* Inserted loads have to be ordered before later stores, so they
+		   are threaded into the memory phi of this block. */
+		if (is_versioned_load(expr)) {
+			ir_node *version = get_mem_version(expr);
+			if (!is_Phi(version) || get_nodes_block(version) != block)
+				continue;
+		}
+#endif
+
 		ir_mode  *mode = is_partially_redundant(block, expr, value);
 		if (mode == NULL)
 			continue;
@@ -1338,7 +1457,8 @@ static void insert_nodes_walker(ir_node *block, void *ctx)
 				ir_node **in           = XMALLOCNZ(ir_node *, node_arity);
 				ir_node  *target_block = pred_block;
 
-				foreach_irn_in(expr, i, pred) {
+				for (int i = 0; i < node_arity; ++i) {
+					ir_node       *pred  = get_pre_pred(expr, i);
 					const ir_node *value = identify(pred);
 
 					/* transform knowledge over the predecessor from
@@ -1359,6 +1479,9 @@ static void insert_nodes_walker(ir_node *block, void *ctx)
 
 					/* in case of phi, we are done */
 					if (is_Phi(pred) && get_nodes_block(pred) == block) {
+						/* loads use the current end of the memory chain */
+						if (get_irn_mode(pred) == mode_M)
+							trans = get_Phi_pred(pred, pos);
 						in[i] = trans;
 						continue;
 					}
@@ -1392,6 +1515,14 @@ static void insert_nodes_walker(ir_node *block, void *ctx)
 				ir_node *trans = new_similar_node(expr, target_block, in);
 				free(in);
 
+#if LOADS
+				if (is_versioned_load(trans)) {
+					ir_node *mem_phi = get_mem_version(expr);
+					ir_node *mem     = new_r_Proj(trans, mode_M, pn_Load_M);
+					set_Phi_pred(mem_phi, pos, mem);
+				}
+#endif
+
 				/* value is now available in target block through trans
 				   insert (not replace) because it has not been available */
 				ir_node *new_value = identify_or_remember(trans);
@@ -1633,6 +1764,16 @@ static void eliminate(ir_node *irn, void *ctx)
 	pre_env *env = (pre_env*)ctx;
 
 	if (!is_Block(irn)) {
+		/* Loads stay in the memory chain even if they are redundant,
+		   eliminate_nodes() removes them once their result is replaced. */
+		if (is_versioned_load(irn))
+			return;
+		if (is_Proj(irn) && get_irn_mode(irn) == mode_M
+		    && is_versioned_load(get_Proj_pred(irn))) {
+			ARR_APP1(ir_node*, env->load_mems, irn);
+			return;
+		}
+
 		ir_node *value = identify(irn);
 
 		if (value != NULL) {
@@ -1649,6 +1790,9 @@ static void eliminate(ir_node *irn, void *ctx)
 				p->next     = env->pairs;
 				env->pairs = p;
 				DEBUG_ONLY(inc_stats(gvnpre_stats->replaced);)
+
+				if (is_Proj(irn) && is_versioned_load(get_Proj_pred(irn)))
+					ir_nodeset_insert(env->dead_loads, get_Proj_pred(irn));
 			}
 		}
 	}
@@ -1698,6 +1842,25 @@ static void eliminate_nodes(elim_pair *pairs, ir_nodeset_t *keeps)
 	}
 }
 
+/**
+ * Removes loads whose result has been replaced
+ * by bypassing their memory.
+ *
+ * @param env  the environment
+ */
+static void eliminate_loads(pre_env *env)
+{
+	for (size_t i = 0, n = ARR_LEN(env->load_mems); i < n; ++i) {
+		ir_node *proj = env->load_mems[i];
+		ir_node *load = get_Proj_pred(proj);
+		if (!ir_nodeset_contains(env->dead_loads, load))
+			continue;
+
+		DB((dbg, LEVEL_2, "Removing redundant %+F\n", load));
+		exchange(proj, skip_Id(get_Load_mem(load)));
+	}
+}
+
 
 /* --------------------------------------------------------
  * GVN PRE pass
@@ -1718,6 +1881,7 @@ static void gvn_pre(ir_graph *irg, pre_env *env)
 	irg_walk_blkwise_graph(irg, block_info_walker, NULL, env);
 
 	ir_nodehashmap_init(&value_map);
+	ir_nodehashmap_init(&mem_version_map);
 
 	/* generate exp_gen */
 	irg_walk_blkwise_graph(irg, NULL, topo_walker, env);
@@ -1772,9 +1936,14 @@ static void gvn_pre(ir_graph *irg, pre_env *env)
 	edges_deactivate(environment->graph);
 
 	/* eliminate nodes */
+	ir_nodeset_init(env->dead_loads);
+	env->load_mems = NEW_ARR_F(ir_node*, 0);
 	irg_walk_graph(irg, NULL, eliminate, env);
 	eliminate_nodes(env->pairs, env->keeps);
+	eliminate_loads(env);
 
+	DEL_ARR_F(env->load_mems);
+	ir_nodeset_destroy(env->dead_loads);
 	ir_nodeset_destroy(env->keeps);
 }
 
@@ -1787,6 +1956,7 @@ void do_gvn_pre(ir_graph *irg)
 {
 	pre_env               env;
 	ir_nodeset_t          keeps;
+	ir_nodeset_t          dead_loads;
 	optimization_state_t  state;
 
 	/* bads and unreachables cause too much trouble with dominance,
@@ -1820,6 +1990,8 @@ void do_gvn_pre(ir_graph *irg)
 	env.end_node     = get_irg_end(irg);
 	env.pairs        = NULL;
 	env.keeps        = &keeps;
+	env.dead_loads   = &dead_loads;
+	env.load_mems    = NULL;
 	env.last_idx     = get_irg_last_idx(irg);
 	obstack_init(&env.obst);
 
@@ -1856,6 +2028,7 @@ void do_gvn_pre(ir_graph *irg)
 
 	DEBUG_ONLY(free_stats();)
 	ir_nodehashmap_destroy(&value_map);
+	ir_nodehashmap_destroy(&mem_version_map);
 	obstack_free(&env.obst, NULL);
 	ir_free_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_LOOP_LINK);
 
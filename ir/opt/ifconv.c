@@ -11,6 +11,7 @@
 #include "cdep_t.h"
 #include "debug.h"
 #include "ircons.h"
+#include "irdom.h"
 #include "irgmod.h"
 #include "irgopt.h"
 #include "irgwalk.h"
@@ -264,6 +265,20 @@ static void prepare_path(ir_node *block, int i, const ir_node *dependency)
 	}
 }
 
+/**
+ * Returns a block dominating all blocks whose control flow is changed when
+ * the predecessors @p i and @p j of @p block are if-converted into
+ * @p mux_block.
+ */
+static ir_node *get_dom_update_root(ir_node *block, ir_node *mux_block,
+                                    int i, int j)
+{
+	ir_node *root = ir_deepest_common_dominator(block, mux_block);
+	root = ir_deepest_common_dominator(root, get_Block_cfgpred_block(block, i));
+	root = ir_deepest_common_dominator(root, get_Block_cfgpred_block(block, j));
+	return root;
+}
+
 /**
  * Block walker: Search for diamonds and do the if conversion.
  */
@@ -334,13 +349,16 @@ restart:;
 					cond, projx0, projx1
 				));
 
+				ir_node *const mux_block = get_nodes_block(cond);
+				ir_node *const dom_root
+					= get_dom_update_root(block, mux_block, i, j);
+
 				/* remove critical edges */
 				env->changed = true;
 				prepare_path(block, i, dependency);
 				prepare_path(block, j, dependency);
 				arity = get_irn_arity(block);
 
-				ir_node *const mux_block = get_nodes_block(cond);
 				do { /* generate Mux nodes in mux_block for Phis in block */
 					ir_node *val_i = get_irn_n(phi, i);
 					ir_node *val_j = get_irn_n(phi, j);
@@ -392,9 +410,11 @@ restart:;
 					/* mark both block just to be sure, should be enough to mark mux_block */
 					set_Block_mark(mux_block, mark);
 					exchange(block, mux_block);
+					dom_update_subtree(dom_root);
 					return;
 				} else {
 					rewire(block, i, j, new_r_Jmp(mux_block));
+					dom_update_subtree(dom_root);
 					goto restart;
 				}
 			}
@@ -490,9 +510,13 @@ void opt_if_conv_cb(ir_graph *irg, arch_allow_ifconv_func callback)
 
 	free_cdep(irg);
 
+	/* Dominance is maintained during the conversion, but the local
+	 * optimizations may change control flow again. */
 	confirm_irg_properties(irg,
 		IR_GRAPH_PROPERTY_NO_CRITICAL_EDGES
-		| IR_GRAPH_PROPERTY_ONE_RETURN);
+		| IR_GRAPH_PROPERTY_ONE_RETURN
+		| (env.changed ? IR_GRAPH_PROPERTIES_NONE
+		               : IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE));
 }
 
 void opt_if_conv(ir_graph *irg)
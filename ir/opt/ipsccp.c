@@ -0,0 +1,821 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Interprocedural sparse conditional constant propagation.
+ *
+ * Every graph is evaluated with a sparse conditional constant propagation
+ * (Wegman/Zadeck) whose lattice is extended across calls: a private method
+ * (all its call sites are known, see mark_private_methods()) receives the meet
+ * of the arguments of all executable call sites as parameter values, and the
+ * results of a call are the meet of the returned values of all its possible
+ * callees (as determined by cgana()).  Graphs are re-evaluated along the call
+ * graph until a fixpoint is reached.
+ *
+ * Afterwards private methods which are called with different constant
+ * arguments are specialized: call sites sharing the same constant arguments
+ * are redirected to a copy of the callee, if the estimated benefit exceeds a
+ * threshold (the same weighting as in proc_cloning() is used).  The copy keeps
+ * the signature of the original, the constant parameters are propagated into
+ * it by a second round of the analysis.
+ */
+#include "analyze_irg_args.h"
+#include "array.h"
+#include "bitset.h"
+#include "callgraph_t.h"
+#include "cgana.h"
+#include "debug.h"
+#include "ircons.h"
+#include "iredges_t.h"
+#include "irgmod.h"
+#include "irgraph_t.h"
+#include "irgwalk.h"
+#include "irmemory.h"
+#include "irnode_t.h"
+#include "irnodemap.h"
+#include "iropt_t.h"
+#include "iroptimize.h"
+#include "irprog_t.h"
+#include "obst.h"
+#include "tv.h"
+#include "type_t.h"
+#include "util.h"
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+
+/** Maximum number of specializations created for a single method. */
+#define MAX_SPECIALIZATIONS 4
+
+/**
+ * The lattice: tarval_unknown is top (not yet known), tarval_bad is bottom
+ * (not constant), every other tarval is a constant.
+ */
+static bool is_lattice_const(ir_tarval const *const tv)
+{
+	return tv != tarval_unknown && tv != tarval_bad;
+}
+
+static ir_tarval *lattice_meet(ir_tarval *const a, ir_tarval *const b)
+{
+	if (a == tarval_unknown)
+		return b;
+	if (b == tarval_unknown || a == b)
+		return a;
+	return tarval_bad;
+}
+
+/** A group of call sites passing the same constant arguments. */
+typedef struct spec_t {
+	ir_tarval **args;   /**< constant arguments, NULL if not constant */
+	ir_node   **calls;  /**< the call sites */
+	float       weight; /**< estimated benefit of a specialization */
+} spec_t;
+
+/** Interprocedural information about a method. */
+typedef struct func_info_t {
+	ir_graph   *irg;
+	size_t      n_params;
+	size_t      n_results;
+	ir_tarval **params;       /**< meet of the arguments of all call sites */
+	ir_tarval **results;      /**< meet of all returned values */
+	ir_node   **calls;        /**< Call nodes inside the graph */
+	spec_t    **specs;        /**< candidates for specialization */
+	bool        known_callers; /**< all call sites of the method are known */
+} func_info_t;
+
+typedef struct ipsccp_env_t {
+	struct obstack  obst;
+	func_info_t   **infos;  /**< infos of all methods */
+	cg_worklist_t   wl;
+} ipsccp_env_t;
+
+/** The state of the intraprocedural propagation of one graph. */
+typedef struct graph_env_t {
+	ir_graph    *irg;
+	func_info_t *info;
+	ir_nodemap   values;   /**< lattice values, unset means top */
+	ir_node    **worklist;
+	bitset_t    *queued;
+} graph_env_t;
+
+/** The graph environment used by get_lattice_tarval(). */
+static graph_env_t *current_genv;
+
+static func_info_t *get_func_info(ir_entity *const ent)
+{
+	ir_graph *const irg = get_entity_linktime_irg(ent);
+	return irg != NULL ? (func_info_t*)get_irg_link(irg) : NULL;
+}
+
+static void collect_calls(ir_node *const node, void *const env)
+{
+	func_info_t *const info = (func_info_t*)env;
+	if (is_Call(node))
+		ARR_APP1(ir_node*, info->calls, node);
+}
+
+static func_info_t *create_func_info(ipsccp_env_t *const env,
+                                     ir_graph *const irg)
+{
+	ir_entity *const ent = get_irg_entity(irg);
+	ir_type   *const mtp = get_entity_type(ent);
+
+	func_info_t *const info = OALLOC(&env->obst, func_info_t);
+	info->irg           = irg;
+	info->n_params      = get_method_n_params(mtp);
+	info->n_results     = get_method_n_ress(mtp);
+	info->params        = OALLOCN(&env->obst, ir_tarval*, info->n_params);
+	info->results       = OALLOCN(&env->obst, ir_tarval*, info->n_results);
+	info->calls         = NEW_ARR_F(ir_node*, 0);
+	info->specs         = NEW_ARR_F(spec_t*, 0);
+	info->known_callers = !is_method_variadic(mtp)
+		&& (get_entity_additional_properties(ent) & mtp_property_private);
+
+	/* parameters of methods with unknown callers may have any value */
+	ir_tarval *const param_init = info->known_callers ? tarval_unknown : tarval_bad;
+	for (size_t i = 0; i < info->n_params; ++i)
+		info->params[i] = param_init;
+	for (size_t i = 0; i < info->n_results; ++i)
+		info->results[i] = tarval_unknown;
+
+	irg_walk_graph(irg, collect_calls, NULL, info);
+
+	set_irg_link(irg, info);
+	ARR_APP1(func_info_t*, env->infos, info);
+	return info;
+}
+
+static void free_func_infos(ipsccp_env_t *const env)
+{
+	for (size_t i = 0, n = ARR_LEN(env->infos); i < n; ++i) {
+		func_info_t *const info = env->infos[i];
+		for (size_t s = 0, n_specs = ARR_LEN(info->specs); s < n_specs; ++s)
+			DEL_ARR_F(info->specs[s]->calls);
+		DEL_ARR_F(info->specs);
+		DEL_ARR_F(info->calls);
+	}
+	ARR_SHRINKLEN(env->infos, 0);
+	obstack_free(&env->obst, NULL);
+	obstack_init(&env->obst);
+	cg_worklist_free(&env->wl);
+}
+
+/**
+ * Creates the method infos of all graphs, which are all evaluated at least
+ * once.  The call graph must be recomputed whenever graphs are added.
+ */
+static void init_func_infos(ipsccp_env_t *const env)
+{
+	cg_worklist_init(&env->wl);
+	foreach_irp_irg(i, irg) {
+		create_func_info(env, irg);
+	}
+}
+
+static ir_tarval *get_lattice(graph_env_t const *const genv,
+                            ir_node const *const node)
+{
+	ir_tarval *const tv = ir_nodemap_get(ir_tarval, &genv->values, node);
+	return tv != NULL ? tv : tarval_unknown;
+}
+
+static bool is_executable(graph_env_t const *const genv,
+                          ir_node const *const node)
+{
+	return get_lattice(genv, node) == tarval_b_true;
+}
+
+/**
+ * The value_of() hook used while evaluating a node: only constants are
+ * visible, as computed_value() treats tarval_unknown as "not constant".
+ */
+static ir_tarval *get_lattice_tarval(ir_node const *const node)
+{
+	if (is_Const(node))
+		return get_Const_tarval(node);
+	ir_tarval *const tv = get_lattice(current_genv, node);
+	return is_lattice_const(tv) ? tv : tarval_unknown;
+}
+
+static void push_node(graph_env_t *const genv, ir_node *const node)
+{
+	unsigned const idx = get_irn_idx(node);
+	if (bitset_is_set(genv->queued, idx))
+		return;
+	bitset_set(genv->queued, idx);
+	ARR_APP1(ir_node*, genv->worklist, node);
+}
+
+static void set_lattice(graph_env_t *const genv, ir_node *const node,
+                      ir_tarval *const tv)
+{
+	if (get_lattice(genv, node) == tv)
+		return;
+	ir_nodemap_insert(&genv->values, node, tv);
+
+	foreach_out_edge(node, edge) {
+		ir_node *const succ = get_edge_src_irn(edge);
+		push_node(genv, succ);
+		/* the Phis of a block depend on its executable predecessors */
+		if (is_Block(succ) && get_irn_mode(node) == mode_X) {
+			foreach_out_edge(succ, block_edge) {
+				ir_node *const phi = get_edge_src_irn(block_edge);
+				if (is_Phi(phi))
+					push_node(genv, phi);
+			}
+		}
+	}
+}
+
+static ir_tarval *value_with_mode(ir_tarval *const tv, ir_node const *const node)
+{
+	if (is_lattice_const(tv) && get_tarval_mode(tv) != get_irn_mode(node))
+		return tarval_bad;
+	return tv;
+}
+
+/** Returns the meet of the results at position @p pos of all callees. */
+static ir_tarval *get_call_result(ir_node const *const call, unsigned const pos)
+{
+	ir_entity *const callee = get_Call_callee(call);
+	if (callee != NULL) {
+		func_info_t const *const info = get_func_info(callee);
+		if (info == NULL || pos >= info->n_results)
+			return tarval_bad;
+		return info->results[pos];
+	}
+	if (!cg_call_has_callees(call))
+		return tarval_bad;
+
+	size_t const n_callees = cg_get_call_n_callees(call);
+	if (n_callees == 0)
+		return tarval_bad;
+	ir_tarval *res = tarval_unknown;
+	for (size_t i = 0; i < n_callees; ++i) {
+		func_info_t const *const info = get_func_info(cg_get_call_callee(call, i));
+		if (info == NULL || pos >= info->n_results)
+			return tarval_bad;
+		res = lattice_meet(res, info->results[pos]);
+	}
+	return res;
+}
+
+static ir_tarval *compute_Block(graph_env_t const *const genv,
+                                ir_node const *const block)
+{
+	if (block == get_irg_start_block(genv->irg))
+		return tarval_b_true;
+	for (int i = 0, n = get_Block_n_cfgpreds(block); i < n; ++i) {
+		if (is_executable(genv, get_Block_cfgpred(block, i)))
+			return tarval_b_true;
+	}
+	return tarval_unknown;
+}
+
+static ir_tarval *compute_Phi(graph_env_t const *const genv,
+                              ir_node const *const phi)
+{
+	if (!mode_is_data(get_irn_mode(phi)) && get_irn_mode(phi) != mode_b)
+		return tarval_bad;
+
+	ir_node const *const block = get_nodes_block(phi);
+	ir_tarval           *res   = tarval_unknown;
+	foreach_irn_in(phi, i, pred) {
+		if (is_executable(genv, get_Block_cfgpred(block, i)))
+			res = lattice_meet(res, get_lattice(genv, pred));
+	}
+	return res;
+}
+
+static ir_tarval *compute_X(graph_env_t const *const genv,
+                            ir_node const *const node)
+{
+	if (is_Proj(node)) {
+		ir_node const *const pred = get_Proj_pred(node);
+		if (is_Cond(pred)) {
+			ir_tarval *const sel = get_lattice(genv, pred);
+			if (sel == tarval_unknown)
+				return tarval_unknown;
+			if (sel == tarval_bad)
+				return tarval_b_true;
+			bool const taken = sel == tarval_b_true;
+			return taken == (get_Proj_num(node) == pn_Cond_true)
+				? tarval_b_true : tarval_unknown;
+		} else if (is_Switch(pred)) {
+			ir_tarval *const sel = get_lattice(genv, pred);
+			return sel == tarval_unknown ? tarval_unknown : tarval_b_true;
+		}
+	}
+	return tarval_b_true;
+}
+
+static bool has_top_operand(graph_env_t const *const genv,
+                            ir_node const *const node)
+{
+	foreach_irn_in(node, i, pred) {
+		if (get_lattice(genv, pred) == tarval_unknown && !is_Const(pred))
+			return true;
+	}
+	return false;
+}
+
+/** Folds a node whose operands are not top with the constant operands. */
+static ir_tarval *compute_folded(ir_node const *const node)
+{
+	ir_tarval *const tv = computed_value(node);
+	return is_lattice_const(tv) ? tv : tarval_bad;
+}
+
+static ir_tarval *compute_Proj(graph_env_t const *const genv,
+                               ir_node const *const proj)
+{
+	ir_node const *const pred = get_Proj_pred(proj);
+	if (pred == get_irg_args(genv->irg)) {
+		unsigned const num = get_Proj_num(proj);
+		if (num >= genv->info->n_params)
+			return tarval_bad;
+		return value_with_mode(genv->info->params[num], proj);
+	}
+	if (is_Proj(pred)) {
+		ir_node const *const call = get_Proj_pred(pred);
+		if (is_Call(call) && get_Proj_num(pred) == pn_Call_T_result)
+			return value_with_mode(get_call_result(call, get_Proj_num(proj)), proj);
+		return tarval_bad;
+	}
+	if (get_lattice(genv, pred) == tarval_unknown)
+		return tarval_unknown;
+	return compute_folded(proj);
+}
+
+static ir_tarval *compute(graph_env_t const *const genv, ir_node const *const node)
+{
+	if (is_Block(node))
+		return compute_Block(genv, node);
+	if (is_Bad(node) || !is_executable(genv, get_nodes_block(node)))
+		return tarval_unknown;
+
+	ir_mode *const mode = get_irn_mode(node);
+	if (mode == mode_X)
+		return compute_X(genv, node);
+	/* branches depend on the value of their selector */
+	if (is_Cond(node))
+		return get_lattice(genv, get_Cond_selector(node));
+	if (is_Switch(node))
+		return get_lattice(genv, get_Switch_selector(node));
+	if (is_Const(node))
+		return get_Const_tarval(node);
+	if (is_Phi(node))
+		return compute_Phi(genv, node);
+	/* tuples are bottom once all their operands are known, so their Projs
+	 * are evaluated again when this happens */
+	if (mode == mode_T)
+		return has_top_operand(genv, node) ? tarval_unknown : tarval_bad;
+	if (!mode_is_data(mode) && mode != mode_b)
+		return tarval_bad;
+	/* undefined values are not exploited, only constant ones */
+	if (is_Unknown(node))
+		return tarval_bad;
+	if (is_Proj(node))
+		return compute_Proj(genv, node);
+	if (has_top_operand(genv, node))
+		return tarval_unknown;
+	return compute_folded(node);
+}
+
+static void init_graph_env(graph_env_t *const genv, ir_graph *const irg)
+{
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_NO_TUPLES
+	                         | IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
+
+	genv->irg      = irg;
+	genv->info     = (func_info_t*)get_irg_link(irg);
+	genv->worklist = NEW_ARR_F(ir_node*, 0);
+	genv->queued   = bitset_malloc(get_irg_last_idx(irg));
+	ir_nodemap_init(&genv->values, irg);
+}
+
+static void free_graph_env(graph_env_t *const genv)
+{
+	ir_nodemap_destroy(&genv->values);
+	free(genv->queued);
+	DEL_ARR_F(genv->worklist);
+}
+
+/** Runs the intraprocedural propagation for a graph. */
+static void analyze_graph(graph_env_t *const genv)
+{
+	current_genv = genv;
+	set_value_of_func(get_lattice_tarval);
+
+	push_node(genv, get_irg_start_block(genv->irg));
+	while (ARR_LEN(genv->worklist) > 0) {
+		size_t   const last = ARR_LEN(genv->worklist) - 1;
+		ir_node *const node = genv->worklist[last];
+		ARR_SHRINKLEN(genv->worklist, last);
+		bitset_clear(genv->queued, get_irn_idx(node));
+		set_lattice(genv, node, compute(genv, node));
+	}
+
+	set_value_of_func(NULL);
+	current_genv = NULL;
+}
+
+/** Propagates the argument values of the executable calls to the callees. */
+static void propagate_arguments(ipsccp_env_t *const env,
+                                graph_env_t const *const genv)
+{
+	func_info_t const *const info = genv->info;
+	for (size_t c = 0, n_calls = ARR_LEN(info->calls); c < n_calls; ++c) {
+		ir_node *const call = info->calls[c];
+		if (!is_executable(genv, get_nodes_block(call)))
+			continue;
+		ir_entity *const callee = get_Call_callee(call);
+		if (callee == NULL)
+			continue;
+		func_info_t *const callee_info = get_func_info(callee);
+		if (callee_info == NULL || !callee_info->known_callers)
+			continue;
+
+		size_t const n_args  = get_Call_n_params(call);
+		bool         changed = false;
+		for (size_t i = 0; i < callee_info->n_params; ++i) {
+			ir_tarval *const arg = i < n_args
+				? get_lattice(genv, get_Call_param(call, i)) : tarval_bad;
+			ir_tarval *const old = callee_info->params[i];
+			ir_tarval *const tv  = lattice_meet(old, arg);
+			if (tv != old) {
+				callee_info->params[i] = tv;
+				changed = true;
+			}
+		}
+		if (changed)
+			cg_worklist_push(&env->wl, callee_info->irg);
+	}
+}
+
+/** Propagates the values of the executable Returns to the callers. */
+static void propagate_results(ipsccp_env_t *const env,
+                              graph_env_t const *const genv)
+{
+	func_info_t *const info      = genv->info;
+	ir_node     *const end_block = get_irg_end_block(genv->irg);
+	bool               changed   = false;
+	foreach_irn_in(end_block, i, pred) {
+		if (!is_Return(pred) || !is_executable(genv, get_nodes_block(pred)))
+			continue;
+		size_t const n_ress = get_Return_n_ress(pred);
+		for (size_t r = 0; r < info->n_results; ++r) {
+			ir_tarval *const res = r < n_ress
+				? get_lattice(genv, get_Return_res(pred, r)) : tarval_bad;
+			ir_tarval *const old = info->results[r];
+			ir_tarval *const tv  = lattice_meet(old, res);
+			if (tv != old) {
+				info->results[r] = tv;
+				changed = true;
+			}
+		}
+	}
+	if (changed)
+		cg_worklist_push_callers(&env->wl, genv->irg);
+}
+
+/**
+ * Parameter and result values only descend in the lattice, so every graph is
+ * re-evaluated a bounded number of times: when the arguments passed to it or
+ * the results of one of its callees change.
+ */
+static void solve(ipsccp_env_t *const env)
+{
+	for (ir_graph *irg; (irg = cg_worklist_pop(&env->wl)) != NULL;) {
+		DB((dbg, LEVEL_2, "evaluating %+F\n", irg));
+		graph_env_t genv;
+		init_graph_env(&genv, irg);
+		analyze_graph(&genv);
+		propagate_arguments(env, &genv);
+		propagate_results(env, &genv);
+		free_graph_env(&genv);
+	}
+}
+
+/**
+ * Returns the specialization candidate of @p callee_info for the given
+ * constant arguments, creating it if necessary.
+ */
+static spec_t *get_spec(ipsccp_env_t *const env, func_info_t *const callee_info,
+                        ir_tarval **const args)
+{
+	size_t const n_params = callee_info->n_params;
+	for (size_t s = 0, n = ARR_LEN(callee_info->specs); s < n; ++s) {
+		spec_t *const spec = callee_info->specs[s];
+		if (memcmp(spec->args, args, n_params * sizeof(*args)) == 0)
+			return spec;
+	}
+
+	spec_t *const spec = OALLOC(&env->obst, spec_t);
+	spec->args   = OALLOCN(&env->obst, ir_tarval*, n_params);
+	spec->calls  = NEW_ARR_F(ir_node*, 0);
+	spec->weight = 0.0F;
+	MEMCPY(spec->args, args, n_params);
+	ARR_APP1(spec_t*, callee_info->specs, spec);
+	return spec;
+}
+
+/**
+ * Groups the executable call sites of private methods by the constant
+ * arguments they pass for parameters which are not constant anyway.
+ */
+static void collect_specializations(ipsccp_env_t *const env,
+                                    graph_env_t const *const genv)
+{
+	func_info_t const *const info = genv->info;
+	for (size_t c = 0, n_calls = ARR_LEN(info->calls); c < n_calls; ++c) {
+		ir_node *const call = info->calls[c];
+		if (!is_executable(genv, get_nodes_block(call)))
+			continue;
+		ir_entity *const callee = get_Call_callee(call);
+		if (callee == NULL)
+			continue;
+		func_info_t *const callee_info = get_func_info(callee);
+		if (callee_info == NULL || !callee_info->known_callers
+		 || callee_info->irg == genv->irg)
+			continue;
+
+		size_t const n_params = callee_info->n_params;
+		if (get_Call_n_params(call) != n_params)
+			continue;
+
+		ir_tarval **const args = ALLOCAN(ir_tarval*, n_params);
+		bool              any  = false;
+		for (size_t i = 0; i < n_params; ++i) {
+			ir_tarval *const tv = get_lattice(genv, get_Call_param(call, i));
+			if (callee_info->params[i] == tarval_bad && is_lattice_const(tv)) {
+				args[i] = tv;
+				any     = true;
+			} else {
+				args[i] = NULL;
+			}
+		}
+		if (!any)
+			continue;
+
+		spec_t *const spec = get_spec(env, callee_info, args);
+		ARR_APP1(ir_node*, spec->calls, call);
+	}
+}
+
+/**
+ * The weight formula of proc_cloning(): We save one instruction in every
+ * caller and param_weight instructions in the callee for every constant
+ * parameter.
+ */
+static float calculate_weight(func_info_t const *const info,
+                              spec_t const *const spec)
+{
+	ir_entity *const ent    = get_irg_entity(info->irg);
+	float            weight = 0.0F;
+	for (size_t i = 0; i < info->n_params; ++i) {
+		if (spec->args[i] != NULL)
+			weight += (float)(get_method_param_weight(ent, i) + 1);
+	}
+	return ARR_LEN(spec->calls) * weight;
+}
+
+static int cmp_spec_weight(void const *const a, void const *const b)
+{
+	spec_t const *const sa = *(spec_t const *const*)a;
+	spec_t const *const sb = *(spec_t const *const*)b;
+	return (sa->weight < sb->weight) - (sa->weight > sb->weight);
+}
+
+/**
+ * Pre-walker: Copies a node into the specialized graph and links the copy to
+ * the original.  The fixed nodes of a graph are not copied.
+ */
+static void copy_node(ir_node *const node, void *const env)
+{
+	ir_graph *const copy_irg = (ir_graph*)env;
+	ir_graph *const irg      = get_irn_irg(node);
+	ir_node        *copy;
+	if (node == get_irg_start_block(irg)) {
+		copy = get_irg_start_block(copy_irg);
+	} else if (node == get_irg_end_block(irg)) {
+		copy = get_irg_end_block(copy_irg);
+	} else if (node == get_irg_start(irg)) {
+		copy = get_irg_start(copy_irg);
+	} else if (node == get_irg_end(irg)) {
+		copy = get_irg_end(copy_irg);
+	} else if (node == get_irg_no_mem(irg)) {
+		copy = get_irg_no_mem(copy_irg);
+	} else if (node == get_irg_frame(irg)) {
+		copy = get_irg_frame(copy_irg);
+	} else if (node == get_irg_initial_mem(irg)) {
+		copy = get_irg_initial_mem(copy_irg);
+	} else if (node == get_irg_args(irg)) {
+		copy = get_irg_args(copy_irg);
+	} else {
+		copy = irn_copy_into_irg(node, copy_irg);
+		/* redirect accesses to the copied frame entities */
+		if (is_Member(copy)) {
+			ir_entity *const ent = get_Member_entity(copy);
+			if (get_entity_owner(ent) == get_irg_frame_type(irg))
+				set_Member_entity(copy, (ir_entity*)get_entity_link(ent));
+		}
+	}
+	set_irn_link(node, copy);
+}
+
+static inline ir_node *get_copy(ir_node const *const node)
+{
+	return (ir_node*)get_irn_link(node);
+}
+
+/** Post-walker: Sets the predecessors of the copied nodes. */
+static void rewire_node(ir_node *const node, void *const env)
+{
+	(void)env;
+	ir_node *const copy = get_copy(node);
+	if (is_Block(node)) {
+		/* the end block of the new graph is not matured yet */
+		bool const is_end_block = node == get_irg_end_block(get_irn_irg(node));
+		for (int i = 0, n = get_Block_n_cfgpreds(node); i < n; ++i) {
+			ir_node *const pred = get_copy(get_Block_cfgpred(node, i));
+			if (is_end_block)
+				add_immBlock_pred(copy, pred);
+			else
+				set_Block_cfgpred(copy, i, pred);
+		}
+	} else {
+		set_nodes_block(copy, get_copy(get_nodes_block(node)));
+		if (is_End(node)) {
+			for (int i = 0, n = get_End_n_keepalives(node); i < n; ++i)
+				add_End_keepalive(copy, get_copy(get_End_keepalive(node, i)));
+		} else {
+			foreach_irn_in(node, i, pred) {
+				set_irn_n(copy, i, get_copy(pred));
+			}
+		}
+	}
+}
+
+/** Creates a copy of a method which is called by the call sites of @p spec. */
+static ir_entity *specialize_method(func_info_t const *const info,
+                                    spec_t const *const spec)
+{
+	ir_graph  *const irg   = info->irg;
+	ir_entity *const ent   = get_irg_entity(irg);
+	ident     *const name  = id_unique(get_entity_ident(ent));
+	ir_entity *const clone = clone_entity(ent, name, get_entity_owner(ent));
+	set_entity_visibility(clone, ir_visibility_local);
+	add_entity_additional_properties(clone, mtp_property_private);
+
+	ir_graph *const copy_irg = new_ir_graph(clone, 0);
+
+	irp_reserve_resources(irp, IRP_RESOURCE_ENTITY_LINK);
+	ir_type *const frame      = get_irg_frame_type(irg);
+	ir_type *const copy_frame = get_irg_frame_type(copy_irg);
+	for (size_t i = 0, n = get_compound_n_members(frame); i < n; ++i) {
+		ir_entity *const member = get_compound_member(frame, i);
+		ir_entity *const copy   = clone_entity(member, get_entity_ident(member),
+		                                       copy_frame);
+		set_entity_link(member, copy);
+	}
+
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
+	irg_walk_graph(irg, copy_node, rewire_node, copy_irg);
+	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
+	irp_free_resources(irp, IRP_RESOURCE_ENTITY_LINK);
+
+	irg_finalize_cons(copy_irg);
+
+	/* redirect the call sites */
+	for (size_t i = 0, n = ARR_LEN(spec->calls); i < n; ++i) {
+		ir_node  *const call     = spec->calls[i];
+		ir_graph *const call_irg = get_irn_irg(call);
+		set_Call_ptr(call, new_r_Address(call_irg, clone));
+		confirm_irg_properties(call_irg, IR_GRAPH_PROPERTIES_CONTROL_FLOW);
+	}
+	return clone;
+}
+
+/** Creates the specializations with a sufficient weight. */
+static bool specialize_methods(ipsccp_env_t *const env, float const threshold)
+{
+	foreach_irp_irg(i, irg) {
+		graph_env_t genv;
+		init_graph_env(&genv, irg);
+		analyze_graph(&genv);
+		collect_specializations(env, &genv);
+		free_graph_env(&genv);
+	}
+
+	bool changed = false;
+	for (size_t i = 0, n = ARR_LEN(env->infos); i < n; ++i) {
+		func_info_t *const info    = env->infos[i];
+		size_t       const n_specs = ARR_LEN(info->specs);
+		if (n_specs == 0)
+			continue;
+		for (size_t s = 0; s < n_specs; ++s)
+			info->specs[s]->weight = calculate_weight(info, info->specs[s]);
+		QSORT_ARR(info->specs, cmp_spec_weight);
+
+		for (size_t s = 0; s < n_specs && s < MAX_SPECIALIZATIONS; ++s) {
+			spec_t const *const spec = info->specs[s];
+			if (spec->weight < threshold)
+				break;
+			ir_entity *const clone = specialize_method(info, spec);
+			DB((dbg, LEVEL_1, "specialized %+F for %zu calls as %+F\n",
+			    info->irg, ARR_LEN(spec->calls), clone));
+			(void)clone;
+			changed = true;
+		}
+	}
+	return changed;
+}
+
+/** Collects the nodes of a graph which are replaced by constants. */
+static void collect_constants(ir_node *const node, void *const env)
+{
+	graph_env_t *const genv = (graph_env_t*)env;
+	if (is_Block(node) || is_Const(node)
+	 || !is_executable(genv, get_nodes_block(node)))
+		return;
+
+	ir_mode *const mode = get_irn_mode(node);
+	if (is_Cond(node) || ((mode_is_data(mode) || mode == mode_b)
+	                      && is_lattice_const(get_lattice(genv, node))))
+		ARR_APP1(ir_node*, genv->worklist, node);
+}
+
+/** Replaces all constant values of a graph and folds constant branches. */
+static bool apply_graph(graph_env_t *const genv)
+{
+	ir_graph *const irg = genv->irg;
+	irg_walk_graph(irg, NULL, collect_constants, genv);
+
+	bool changed = false;
+	for (size_t i = 0, n = ARR_LEN(genv->worklist); i < n; ++i) {
+		ir_node   *const node = genv->worklist[i];
+		ir_tarval *const tv   = get_lattice(genv, node);
+		if (!is_lattice_const(tv))
+			continue;
+
+		if (is_Cond(node)) {
+			ir_node *const block = get_nodes_block(node);
+			foreach_out_edge_safe(node, edge) {
+				ir_node *const proj = get_edge_src_irn(edge);
+				ir_node *const repl = is_executable(genv, proj)
+					? new_r_Jmp(block) : new_r_Bad(irg, mode_X);
+				exchange(proj, repl);
+			}
+		} else {
+			DB((dbg, LEVEL_2, "replacing %+F by %T\n", node, tv));
+			exchange(node, new_r_Const(irg, tv));
+		}
+		changed = true;
+	}
+	return changed;
+}
+
+void ipsccp(float threshold)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.opt.ipsccp");
+
+	mark_private_methods();
+
+	ipsccp_env_t env;
+	obstack_init(&env.obst);
+	env.infos = NEW_ARR_F(func_info_t*, 0);
+
+	irp_reserve_resources(irp, IRP_RESOURCE_IRG_LINK);
+
+	init_func_infos(&env);
+	solve(&env);
+
+	/* The specializations are private methods with fewer call sites, so the
+	 * solution must be recomputed from scratch. */
+	if (specialize_methods(&env, threshold)) {
+		free_func_infos(&env);
+		init_func_infos(&env);
+		solve(&env);
+	}
+
+	foreach_irp_irg(i, irg) {
+		graph_env_t genv;
+		init_graph_env(&genv, irg);
+		analyze_graph(&genv);
+		ARR_SHRINKLEN(genv.worklist, 0);
+		bool const changed = apply_graph(&genv);
+		free_graph_env(&genv);
+
+		confirm_irg_properties(irg, changed
+			? IR_GRAPH_PROPERTIES_NONE : IR_GRAPH_PROPERTIES_ALL);
+	}
+
+	irp_free_resources(irp, IRP_RESOURCE_IRG_LINK);
+	free_func_infos(&env);
+	DEL_ARR_F(env.infos);
+	obstack_free(&env.obst, NULL);
+}
@@ -137,7 +137,7 @@ static ir_tarval *default_value_of(const ir_node *n)
 		return tarval_unknown;
 }
 
-value_of_func value_of_ptr = default_value_of;
+FIRM_THREAD_LOCAL value_of_func value_of_ptr = default_value_of;
 
 void set_value_of_func(value_of_func func)
 {
@@ -997,8 +997,8 @@ static ir_tarval *computed_value_Proj(const ir_node *proj)
 {
 	const ir_node *n = get_Proj_pred(proj);
 
-	if (n->op->ops.computed_value_Proj != NULL)
-		return n->op->ops.computed_value_Proj(proj);
+	if (get_irn_op(n)->ops.computed_value_Proj != NULL)
+		return get_irn_op(n)->ops.computed_value_Proj(proj);
 	return tarval_unknown;
 }
 
@@ -1014,8 +1014,8 @@ ir_tarval *computed_value(const ir_node *n)
 	if (vrp != NULL && vrp->bits_set == vrp->bits_not_set)
 		return vrp->bits_set;
 
-	if (n->op->ops.computed_value)
-		return n->op->ops.computed_value(n);
+	if (get_irn_op(n)->ops.computed_value)
+		return get_irn_op(n)->ops.computed_value(n);
 	return tarval_unknown;
 }
 
@@ -1588,8 +1588,8 @@ static ir_node *equivalent_node_CopyB(ir_node *copyb)
 static ir_node *equivalent_node_Proj(ir_node *proj)
 {
 	const ir_node *n = get_Proj_pred(proj);
-	if (n->op->ops.equivalent_node_Proj)
-		return n->op->ops.equivalent_node_Proj(proj);
+	if (get_irn_op(n)->ops.equivalent_node_Proj)
+		return get_irn_op(n)->ops.equivalent_node_Proj(proj);
 	return proj;
 }
 
@@ -1760,8 +1760,8 @@ static ir_node *equivalent_node_Confirm(ir_node *n)
  */
 ir_node *equivalent_node(ir_node *n)
 {
-	if (n->op->ops.equivalent_node)
-		return n->op->ops.equivalent_node(n);
+	if (get_irn_op(n)->ops.equivalent_node)
+		return get_irn_op(n)->ops.equivalent_node(n);
 	return n;
 }
 
@@ -5769,8 +5769,8 @@ static ir_node *transform_node_Proj(ir_node *proj)
 {
 	ir_node *n = get_Proj_pred(proj);
 
-	if (n->op->ops.transform_node_Proj)
-		return n->op->ops.transform_node_Proj(proj);
+	if (get_irn_op(n)->ops.transform_node_Proj)
+		return get_irn_op(n)->ops.transform_node_Proj(proj);
 	return proj;
 }
 
@@ -7242,6 +7242,16 @@ handle_tv:
 		}
 		return false;
 	}
+	case IR_INITIALIZER_BYTES: {
+		/* the image is in memory order already, bytes behind it are zero */
+		size_t               const size = get_initializer_bytes_size(initializer);
+		unsigned char const *const data = get_initializer_bytes_data(initializer);
+		size_t const begin = (size_t)MAX(0, offset);
+		size_t const end   = MIN(size, (size_t)(offset + (long)mode_size));
+		for (size_t b = begin; b < end; ++b)
+			buf[b - offset] = data[b];
+		return true;
+	}
 	case IR_INITIALIZER_COMPOUND:
 		if (is_Array_type(type)) {
 			ir_type  *el_type = get_array_element_type(type);
@@ -7384,6 +7394,9 @@ handle_tv:;
 		 * here, but it's unclear to me if that improves things */
 		return NULL;
 	}
+	case IR_INITIALIZER_BYTES:
+		/* handled by sim_store_load() */
+		return NULL;
 	case IR_INITIALIZER_COMPOUND: {
 		if (is_Array_type(type)) {
 			ir_type  *el_type = get_array_element_type(type);
@@ -7641,8 +7654,8 @@ restart:;
 	if (get_opt_algebraic_simplification() ||
 		(iro == iro_Cond) ||
 		(iro == iro_Proj)) {    /* Flags tested local. */
-		if (n->op->ops.transform_node != NULL) {
-			n = n->op->ops.transform_node(n);
+		if (get_irn_op(n)->ops.transform_node != NULL) {
+			n = get_irn_op(n)->ops.transform_node(n);
 			if (n != old_n)
 				goto restart;
 		}
@@ -7803,12 +7816,12 @@ static int identities_cmp(const void *elt, const void *key)
 
 	/* here, we already know that the nodes are identical except their
 	 * attributes */
-	return !a->op->ops.attrs_equal(a, b);
+	return !get_irn_op(a)->ops.attrs_equal(a, b);
 }
 
 unsigned ir_node_hash(const ir_node *node)
 {
-	return node->op->ops.hash(node);
+	return get_irn_op(node)->ops.hash(node);
 }
 
 void new_identities(ir_graph *irg)
@@ -7947,11 +7960,11 @@ ir_node *optimize_node(ir_node *n)
 			if (tarval_is_constant(tv)) {
 				/* we MUST copy the node here temporarily, because it's still
 				 * needed for DBG_OPT_CSTEVAL */
-				size_t node_size = offsetof(ir_node, attr) +  n->op->attr_size;
+				size_t node_size = offsetof(ir_node, attr) + get_irn_op(n)->attr_size;
 				oldn = (ir_node *)alloca(node_size);
 
 				memcpy(oldn, n, node_size);
-				size_t n_in = ARR_LEN(n->in);
+				size_t n_in = get_irn_arity(n) + 1;
 				oldn->in = ALLOCAN(ir_node*, n_in);
 
 				/* ARG, copy the in array, we need it for statistics */
@@ -12,6 +12,7 @@
 #define FIRM_IR_IROPT_T_H
 
 #include <stdbool.h>
+#include "compiler.h"
 #include "irop_t.h"
 #include "iropt.h"
 #include "irnode_t.h"
@@ -79,7 +80,7 @@ ir_node *optimize_in_place_2(ir_node *n);
  */
 typedef ir_tarval *(*value_of_func)(const ir_node *self);
 
-extern value_of_func value_of_ptr;
+extern FIRM_THREAD_LOCAL value_of_func value_of_ptr;
 
 /**
  * Set a new value_of function.
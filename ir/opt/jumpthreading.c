@@ -12,6 +12,7 @@
 #include "array.h"
 #include "debug.h"
 #include "ircons.h"
+#include "irdom.h"
 #include "iredges_t.h"
 #include "irgmod.h"
 #include "irgopt.h"
@@ -44,8 +45,8 @@ static void add_pred(ir_node *node, ir_node *x)
 	set_irn_in(node, n + 1, ins);
 }
 
-static ir_node *ssa_second_def;
-static ir_node *ssa_second_def_block;
+static FIRM_THREAD_LOCAL ir_node *ssa_second_def;
+static FIRM_THREAD_LOCAL ir_node *ssa_second_def_block;
 
 static ir_node *search_def_and_create_phis(ir_node *block, ir_mode *mode,
                                            bool first)
@@ -199,6 +200,12 @@ static void split_critical_edge(ir_node *block, int pos)
 	set_Block_cfgpred(block, pos, new_jmp);
 }
 
+/** State of one walk over all blocks. */
+typedef struct jumpthreading_walk_t {
+	bool     changed;   /**< Set if a jump was threaded. */
+	ir_node *dom_root;  /**< Dominates all blocks changed by the walk. */
+} jumpthreading_walk_t;
+
 typedef struct jumpthreading_env_t {
 	ir_node      *true_block;  /**< Block we try to thread into */
 	ir_node      *cmp;         /**< The Compare node that might be partial
@@ -210,8 +217,42 @@ typedef struct jumpthreading_env_t {
 	ir_node      *cnst_pred;   /**< the block before the constant */
 	int           cnst_pos;    /**< the pos to the constant block (needed to
 	                                kill that edge later) */
+	ir_node      *dom_root;    /**< dominates all blocks changed by the
+	                                threading */
 } jumpthreading_env_t;
 
+/**
+ * Returns the deepest block dominating @p root and @p block, where @p root may
+ * be NULL.
+ */
+static ir_node *add_dom_root(ir_node *root, ir_node *block)
+{
+	return root == NULL ? block : ir_deepest_common_dominator(root, block);
+}
+
+/**
+ * Records that the edges of @p block may change, so that the dominance
+ * information can be updated for the smallest subtree after the walk. Must be
+ * called before the change.
+ */
+static void note_changed_block(jumpthreading_env_t *env, ir_node *block)
+{
+	ir_graph *irg = get_irn_irg(block);
+	if (!irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE))
+		return;
+	int depth = get_Block_dom_depth(block);
+	if (depth < 0) {
+		/* dead code is involved, give up on maintaining dominance */
+		clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+		return;
+	}
+	/* blocks created during this walk are covered by the root of the
+	 * threading that created them */
+	if (depth == 0)
+		return;
+	env->dom_root = add_dom_root(env->dom_root, block);
+}
+
 static ir_node *copy_and_fix_node(const jumpthreading_env_t *env,
                                   ir_node *block, ir_node *copy_block, int j,
                                   ir_node *node)
@@ -400,6 +441,7 @@ static ir_node *find_const_or_confirm(jumpthreading_env_t *env, ir_node *jump,
 		return NULL;
 
 	ir_node *block = get_nodes_block(jump);
+	note_changed_block(env, block);
 	if (is_Const_or_Confirm(value)) {
 		int evaluated = eval_cmp(env, value);
 		if (evaluated < 0)
@@ -472,6 +514,7 @@ static ir_node *find_candidate(jumpthreading_env_t *env, ir_node *jump,
 		return NULL;
 
 	ir_node *block = get_nodes_block(jump);
+	note_changed_block(env, block);
 	if (is_Const_or_Confirm(value)) {
 		ir_tarval *tv = get_Const_or_Confirm_tarval(value);
 		if (tv != env->tv)
@@ -560,7 +603,7 @@ static ir_node *find_candidate(jumpthreading_env_t *env, ir_node *jump,
  */
 static void thread_jumps(ir_node* block, void* data)
 {
-	bool *changed = (bool*)data;
+	jumpthreading_walk_t *walk = (jumpthreading_walk_t*)data;
 
 	/* we do not deal with Phis, so restrict this to exactly one cfgpred */
 	if (get_Block_n_cfgpreds(block) != 1)
@@ -590,7 +633,9 @@ static void thread_jumps(ir_node* block, void* data)
 			[pn_Cond_true]  = is_true ? jmp : bad,
 		};
 		turn_into_tuple(cond, ARRAY_SIZE(in), in);
-		*changed = true;
+		/* Tuples hide the removed edge until they are optimized away. */
+		clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+		walk->changed = true;
 		return;
 	}
 	inc_irg_visited(irg);
@@ -600,6 +645,9 @@ static void thread_jumps(ir_node* block, void* data)
 	                 ? tarval_b_false : tarval_b_true;
 	env.true_block = block;
 	env.visited_nr = get_irg_visited(irg);
+	env.dom_root   = NULL;
+	note_changed_block(&env, block);
+	note_changed_block(&env, get_nodes_block(cond));
 
 	ir_node *copy_block = find_candidate(&env, projx, selector);
 	if (copy_block == NULL)
@@ -630,7 +678,10 @@ static void thread_jumps(ir_node* block, void* data)
 	}
 
 	/* the graph is changed now */
-	*changed = true;
+	walk->changed = true;
+	if (env.dom_root != NULL
+	    && irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE))
+		walk->dom_root = add_dom_root(walk->dom_root, env.dom_root);
 }
 
 void opt_jumpthreading(ir_graph* irg)
@@ -644,22 +695,31 @@ void opt_jumpthreading(ir_graph* irg)
 
 	DB((dbg, LEVEL_1, "===> Performing jumpthreading on %+F\n", irg));
 
-	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_IRN_VISITED);
-
-	bool changed = false;
-	bool rerun;
+	bool                 changed = false;
+	jumpthreading_walk_t walk;
 	do {
-		rerun = false;
-		irg_block_walk_graph(irg, thread_jumps, NULL, &rerun);
-		changed |= rerun;
-	} while (rerun);
-
-	ir_free_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_IRN_VISITED);
+		walk.changed  = false;
+		walk.dom_root = NULL;
+		ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_IRN_VISITED);
+		irg_block_walk_graph(irg, thread_jumps, NULL, &walk);
+		ir_free_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_IRN_VISITED);
+		changed |= walk.changed;
+
+		/* update dominance once for all threadings of this walk */
+		if (walk.dom_root != NULL
+		    && irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE))
+			dom_update_subtree(walk.dom_root);
+	} while (walk.changed);
 
 	if (changed) {
 		/* we tend to produce a lot of duplicated keep edges, remove them */
 		remove_End_Bads_and_doublets(get_irg_end(irg));
-		confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_NONE);
+		/* dominance is updated after each threading */
+		bool keep_dom = irg_has_properties(irg,
+			IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+		confirm_irg_properties(irg, keep_dom
+			? IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
+			: IR_GRAPH_PROPERTIES_NONE);
 	} else {
 		confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_ALL);
 	}
@@ -28,6 +28,7 @@
 #include "iropt_t.h"
 #include "iroptimize.h"
 #include "irtools.h"
+#include "memssa.h"
 #include "panic.h"
 #include "set.h"
 #include "target_t.h"
@@ -56,6 +57,7 @@ typedef enum changes_t {
 typedef struct walk_env_t {
 	struct obstack obst;    /**< list of all stores */
 	changes_t      changes; /**< a bitmask of graph changes */
+	ir_memssa_t   *memssa;  /**< the memory SSA overlay */
 } walk_env_t;
 
 /** A Load/Store info. */
@@ -76,6 +78,8 @@ typedef struct track_load_env_t {
 	base_offset_t base_offset;
 	ir_node      *ptr; /* deprecated: alternative representation of
 	                      base_offset */
+	ir_memssa_t  *memssa;
+	unsigned      cls; /**< alias class of ptr */
 } track_load_env_t;
 
 /**
@@ -94,7 +98,7 @@ typedef struct block_info_t {
 } block_info_t;
 
 /** the master visited flag for loop detection. */
-static unsigned master_visited;
+static FIRM_THREAD_LOCAL unsigned master_visited;
 
 #define INC_MASTER()       ++master_visited
 #define MARK_NODE(info)    (info)->visited = master_visited
@@ -619,22 +623,23 @@ static bool try_update_ptr_CopyB(track_load_env_t *env, ir_node *copyb)
  */
 
 /**
- * Follow the memory chain as long as there are only Loads,
+ * Follow the memory chain above @p mem as long as there are only Loads,
  * alias free Stores, and constant Calls and try to replace the
- * current Load by a previous ones.
+ * current Load by a previous ones. The memory SSA overlay skips the
+ * memory operations of other alias classes.
  * Note that in unreachable loops it might happen that we reach
  * load again, as well as we can fall into a cycle.
  * We break such cycles using a special visited flag.
  *
  * INC_MASTER() must be called before dive into
  */
-static changes_t follow_load_mem_chain(track_load_env_t *env, ir_node *start)
+static changes_t follow_load_mem_chain(track_load_env_t *env, ir_node *mem)
 {
 	ir_node  *load      = env->load;
 	ir_type  *load_type = get_Load_type(load);
 	unsigned  load_size = get_mode_size_bytes(get_Load_mode(load));
 
-	ir_node   *node = start;
+	ir_node   *node = memssa_skip(env->memssa, mem, env->cls, memssa_def);
 	changes_t  res  = NO_CHANGES;
 	for (;;) {
 		ldst_info_t *node_info = (ldst_info_t *)get_irn_link(node);
@@ -656,14 +661,16 @@ static changes_t follow_load_mem_chain(track_load_env_t *env, ir_node *start)
 			/* if the might be an alias, we cannot pass this Store */
 			if (rel != ir_no_alias)
 				break;
-			node = skip_Proj(get_Store_mem(node));
+			node = memssa_skip(env->memssa, get_Store_mem(node), env->cls,
+			                   memssa_def);
 		} else if (is_Load(node)) {
 			/* try load-after-load */
 			changes_t changes = try_load_after_load(env, node);
 			if (changes != NO_CHANGES)
 				return changes | res;
 			/* we can skip any load */
-			node = skip_Proj(get_Load_mem(node));
+			node = memssa_skip(env->memssa, get_Load_mem(node), env->cls,
+			                   memssa_def);
 		} else if (is_CopyB(node)) {
 			/*
 			 * We cannot replace the Load with another
@@ -679,7 +686,8 @@ static changes_t follow_load_mem_chain(track_load_env_t *env, ir_node *start)
 				 * a constant, we *can* replace the
 				 * Load immediately.
 				 */
-				res |= NODES_CREATED;
+				res     |= NODES_CREATED;
+				env->cls = memssa_get_class(env->memssa, env->ptr);
 				ir_mode *load_mode = get_Load_mode(load);
 				ir_node *new_value = predict_load(env->ptr, load_mode);
 				if (new_value != NULL)
@@ -696,9 +704,8 @@ static changes_t follow_load_mem_chain(track_load_env_t *env, ir_node *start)
 			/* possible alias => we cannot continue */
 			if (rel != ir_no_alias)
 				break;
-			node = skip_Proj(get_CopyB_mem(node));
-		} else if (is_irn_const_memory(node)) {
-			node = skip_Proj(get_memop_mem(node));
+			node = memssa_skip(env->memssa, get_CopyB_mem(node), env->cls,
+			                   memssa_def);
 		} else {
 			/* be conservative about any other node and assume aliasing
 			 * that changes the loaded value */
@@ -714,8 +721,7 @@ static changes_t follow_load_mem_chain(track_load_env_t *env, ir_node *start)
 	if (is_Sync(node)) {
 		/* handle all Sync predecessors */
 		foreach_irn_in(node, i, in) {
-			ir_node *skipped = skip_Proj(in);
-			res |= follow_load_mem_chain(env, skipped);
+			res |= follow_load_mem_chain(env, in);
 			if ((res & ~NODES_CREATED) != NO_CHANGES)
 				break;
 		}
@@ -778,7 +784,7 @@ static ir_entity *find_entity(ir_node *ptr)
  *
  * @param load  the Load node
  */
-static changes_t optimize_load(ir_node *load)
+static changes_t optimize_load(ir_node *load, ir_memssa_t *memssa)
 {
 	const ldst_info_t *info = (ldst_info_t *)get_irn_link(load);
 	changes_t          res  = NO_CHANGES;
@@ -821,7 +827,11 @@ static changes_t optimize_load(ir_node *load)
 		}
 	}
 
-	track_load_env_t env = { .ptr = ptr };
+	track_load_env_t env = {
+		.ptr    = ptr,
+		.memssa = memssa,
+		.cls    = memssa_get_class(memssa, ptr),
+	};
 	get_base_and_offset(ptr, &env.base_offset);
 
 	/* Check, if the base address of this load is used more than once.
@@ -839,7 +849,7 @@ static changes_t optimize_load(ir_node *load)
 	 */
 	INC_MASTER();
 	env.load = load;
-	res = follow_load_mem_chain(&env, skip_Proj(mem));
+	res = follow_load_mem_chain(&env, mem);
 	return res;
 }
 
@@ -859,12 +869,13 @@ static bool is_partially_same(ir_node *small, ir_node *large)
 }
 
 /**
- * follow the memory chain as long as there are only Loads and alias free
- * Stores.
+ * follow the memory chain above @p start as long as there are only Loads and
+ * alias free Stores. The memory SSA overlay skips the memory operations of
+ * other alias classes.
  * INC_MASTER() must be called before dive into
  */
-static changes_t follow_store_mem_chain(ir_node *store, ir_node *start,
-                                        bool had_split)
+static changes_t follow_store_mem_chain(ir_memssa_t *memssa, ir_node *store,
+                                        ir_node *start, bool had_split)
 {
 	changes_t    res   = NO_CHANGES;
 	ldst_info_t *info  = (ldst_info_t *)get_irn_link(store);
@@ -874,8 +885,9 @@ static changes_t follow_store_mem_chain(ir_node *store, ir_node *start,
 	ir_type     *type  = get_Store_type(store);
 	unsigned     size  = get_mode_size_bytes(get_irn_mode(value));
 	ir_node     *block = get_nodes_block(store);
+	unsigned     cls   = memssa_get_class(memssa, ptr);
 
-	ir_node *node = start;
+	ir_node *node = memssa_skip(memssa, start, cls, memssa_access);
 	while (node != store) {
 		ldst_info_t *node_info = (ldst_info_t *)get_irn_link(node);
 
@@ -967,7 +979,7 @@ static changes_t follow_store_mem_chain(ir_node *store, ir_node *start,
 			/* if the might be an alias, we cannot pass this Store */
 			if (rel != ir_no_alias)
 				break;
-			node = skip_Proj(get_Store_mem(node));
+			node = memssa_skip(memssa, get_Store_mem(node), cls, memssa_access);
 		} else if (is_Load(node)) {
 			ir_node           *load_ptr  = get_Load_ptr(node);
 			ir_type           *load_type = get_Load_type(node);
@@ -978,7 +990,7 @@ static changes_t follow_store_mem_chain(ir_node *store, ir_node *start,
 			if (rel != ir_no_alias)
 				break;
 
-			node = skip_Proj(get_Load_mem(node));
+			node = memssa_skip(memssa, get_Load_mem(node), cls, memssa_access);
 		} else if (is_CopyB(node)) {
 			ir_node           *copyb_src  = get_CopyB_src(node);
 			ir_type           *copyb_type = get_CopyB_type(node);
@@ -994,6 +1006,8 @@ static changes_t follow_store_mem_chain(ir_node *store, ir_node *start,
 				ptr, type, size);
 			if (dst_rel != ir_no_alias)
 				break;
+			/* a CopyB touching neither side is passed like a Store */
+			node = memssa_skip(memssa, get_CopyB_mem(node), cls, memssa_access);
 		} else {
 			/* follow only Load chains */
 			break;
@@ -1008,8 +1022,7 @@ static changes_t follow_store_mem_chain(ir_node *store, ir_node *start,
 	if (is_Sync(node)) {
 		/* handle all Sync predecessors */
 		foreach_irn_in(node, i, in) {
-			ir_node *skipped = skip_Proj(in);
-			res |= follow_store_mem_chain(store, skipped, true);
+			res |= follow_store_mem_chain(memssa, store, in, true);
 			if (res != NO_CHANGES)
 				break;
 		}
@@ -1022,7 +1035,7 @@ static changes_t follow_store_mem_chain(ir_node *store, ir_node *start,
  *
  * @param store  the Store node
  */
-static changes_t optimize_store(ir_node *store)
+static changes_t optimize_store(ir_node *store, ir_memssa_t *memssa)
 {
 	if (get_Store_volatility(store) == volatility_is_volatile)
 		return NO_CHANGES;
@@ -1038,7 +1051,7 @@ static changes_t optimize_store(ir_node *store)
 	/* follow the memory chain as long as there are only Loads */
 	INC_MASTER();
 
-	return follow_store_mem_chain(store, skip_Proj(mem), false);
+	return follow_store_mem_chain(memssa, store, mem, false);
 }
 
 /**
@@ -1434,6 +1447,8 @@ static changes_t optimize_phi(ir_node *phi, walk_env_t *wenv)
 	if (get_Phi_loop(phi))
 		remove_keep_alive(phi);
 	exchange(phi, projM);
+	/* the new Store entered the memory chain */
+	memssa_invalidate(wenv->memssa);
 
 	return res | DF_CHANGED;
 }
@@ -1484,11 +1499,11 @@ static void do_load_store_optimize(ir_node *n, void *env)
 {
 	walk_env_t *wenv = (walk_env_t *)env;
 	switch (get_irn_opcode(n)) {
-	case iro_Load:  wenv->changes |= optimize_load(n);      break;
-	case iro_Store: wenv->changes |= optimize_store(n);     break;
-	case iro_CopyB: wenv->changes |= optimize_copyb(n);     break;
-	case iro_Phi:   wenv->changes |= optimize_phi(n, wenv); break;
-	case iro_Conv:  wenv->changes |= optimize_conv_load(n); break;
+	case iro_Load:  wenv->changes |= optimize_load(n, wenv->memssa);  break;
+	case iro_Store: wenv->changes |= optimize_store(n, wenv->memssa); break;
+	case iro_CopyB: wenv->changes |= optimize_copyb(n);               break;
+	case iro_Phi:   wenv->changes |= optimize_phi(n, wenv);           break;
+	case iro_Conv:  wenv->changes |= optimize_conv_load(n);           break;
 	default:
 		break;
 	}
@@ -2301,7 +2316,8 @@ void optimize_load_store(ir_graph *irg)
 	                         | IR_GRAPH_PROPERTY_NO_TUPLES
 	                         | IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
 	                         | IR_GRAPH_PROPERTY_CONSISTENT_POSTDOMINANCE
-	                         | IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE);
+	                         | IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE
+	                         | IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_ORACLE);
 
 	FIRM_DBG_REGISTER(dbg, "firm.opt.ldstopt");
 
@@ -2322,7 +2338,9 @@ void optimize_load_store(ir_graph *irg)
 	irg_walk_graph(irg, firm_clear_link, collect_nodes, &env);
 
 	/* now we have collected enough information, optimize */
+	env.memssa = memssa_new(irg);
 	irg_walk_graph(irg, NULL, do_load_store_optimize, &env);
+	memssa_free(env.memssa);
 
 	/* optimize_load can introduce dead stores. They are
 	 * eliminated now. */
@@ -0,0 +1,806 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Loop invariant code motion for memory operations.
+ *
+ * place_code() already moves floating nodes out of loops, but it cannot move
+ * Loads and Stores as they are bound to the memory chain of the loop. This
+ * pass hoists Loads from loop invariant addresses into the loop preheader if
+ * no memory operation in the loop may write to the loaded address, and sinks
+ * Stores to loop invariant addresses into the loop exit if nothing in the loop
+ * observes the stored value.
+ *
+ * Every hoisted value stays live throughout the whole loop, so the hoisting
+ * is bounded by a rough estimate of the register pressure inside the loop.
+ */
+#include "array.h"
+#include "debug.h"
+#include "ircons.h"
+#include "irdom.h"
+#include "iredges_t.h"
+#include "irgmod.h"
+#include "irgraph_t.h"
+#include "irgwalk.h"
+#include "irloop_t.h"
+#include "irmemory.h"
+#include "irnode_t.h"
+#include "irnodeset.h"
+#include "iroptimize.h"
+#include "memssa.h"
+#include "obst.h"
+#include "target_t.h"
+#include "type_t.h"
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+
+/** Register budget assumed if the target has not been initialized. */
+#define DEFAULT_REGISTER_BUDGET 8
+
+/** Nodes and blocks directly contained in a loop (not in its sons). */
+typedef struct loop_info_t {
+	ir_node **blocks;
+	ir_node **nodes;
+} loop_info_t;
+
+/** Properties of the loop currently processed. */
+typedef struct licm_loop_t {
+	ir_loop     *loop;
+	ir_node     *header;
+	ir_node     *preheader;
+	int          entry_pos;     /**< header predecessor coming from preheader */
+	unsigned     n_entries;     /**< number of edges entering the loop */
+	ir_node     *exit_block;    /**< the single exit block or NULL */
+	ir_node    **exiting;       /**< blocks with a successor outside the loop */
+	ir_node    **latches;       /**< blocks with a backedge to the header */
+	ir_node    **memops;        /**< memory operations in the loop */
+	ir_memssa_t *memssa;        /**< the memory SSA overlay */
+	bool         regular_exits; /**< no exceptional exits */
+	unsigned     pressure;      /**< estimated register pressure */
+	unsigned     budget;        /**< available registers */
+} licm_loop_t;
+
+typedef struct licm_env_t {
+	struct obstack obst;
+	loop_info_t  **infos;   /**< all allocated loop infos */
+	ir_memssa_t   *memssa;  /**< the memory SSA overlay */
+	unsigned       budget;  /**< available registers */
+	bool           changed;
+} licm_env_t;
+
+static loop_info_t *get_loop_info(licm_env_t *env, ir_loop *loop)
+{
+	loop_info_t *info = (loop_info_t*)get_loop_link(loop);
+	if (info == NULL) {
+		info = OALLOC(&env->obst, loop_info_t);
+		info->blocks = NEW_ARR_F(ir_node*, 0);
+		info->nodes  = NEW_ARR_F(ir_node*, 0);
+		set_loop_link(loop, info);
+		ARR_APP1(loop_info_t*, env->infos, info);
+	}
+	return info;
+}
+
+static void clear_loop_links(ir_loop *loop)
+{
+	set_loop_link(loop, NULL);
+	for (size_t i = 0, n = get_loop_n_elements(loop); i < n; ++i) {
+		loop_element elem = get_loop_element(loop, i);
+		if (*elem.kind == k_ir_loop)
+			clear_loop_links(elem.son);
+	}
+}
+
+static void collect_nodes(ir_node *node, void *data)
+{
+	licm_env_t *env = (licm_env_t*)data;
+	if (is_Block(node)) {
+		ir_loop *loop = get_irn_loop(node);
+		if (loop != NULL)
+			ARR_APP1(ir_node*, get_loop_info(env, loop)->blocks, node);
+	} else {
+		ir_loop *loop = get_irn_loop(get_nodes_block(node));
+		if (loop != NULL)
+			ARR_APP1(ir_node*, get_loop_info(env, loop)->nodes, node);
+	}
+}
+
+static bool is_in_loop(const ir_node *block, const ir_loop *loop)
+{
+	ir_loop *l     = get_irn_loop(block);
+	unsigned depth = get_loop_depth(loop);
+	while (l != NULL && get_loop_depth(l) > depth)
+		l = get_loop_outer_loop(l);
+	return l == loop;
+}
+
+static bool is_node_in_loop(const ir_node *node, const ir_loop *loop)
+{
+	return is_in_loop(get_nodes_block(node), loop);
+}
+
+/**
+ * Calls @p func for all blocks and nodes which currently are in @p loop or
+ * one of its sons.
+ */
+static void foreach_loop_node(const ir_loop *loop, const ir_loop *outer,
+                              void (*func)(ir_node*, void*), void *data)
+{
+	loop_info_t *info = (loop_info_t*)get_loop_link(loop);
+	if (info != NULL) {
+		for (size_t i = 0, n = ARR_LEN(info->blocks); i < n; ++i)
+			func(info->blocks[i], data);
+		/* nodes may have been moved out of their loop in the meantime */
+		for (size_t i = 0, n = ARR_LEN(info->nodes); i < n; ++i) {
+			ir_node *node = info->nodes[i];
+			if (is_node_in_loop(node, outer))
+				func(node, data);
+		}
+	}
+	for (size_t i = 0, n = get_loop_n_elements(loop); i < n; ++i) {
+		loop_element elem = get_loop_element(loop, i);
+		if (*elem.kind == k_ir_loop)
+			foreach_loop_node(elem.son, outer, func, data);
+	}
+}
+
+static bool is_memory_user(const ir_node *node)
+{
+	if (is_Phi(node) || is_Sync(node) || is_Proj(node) || is_End(node))
+		return false;
+	foreach_irn_in(node, i, pred) {
+		if (get_irn_mode(pred) == mode_M)
+			return true;
+	}
+	return false;
+}
+
+static void analyze_loop_node(ir_node *node, void *data)
+{
+	licm_loop_t *ll   = (licm_loop_t*)data;
+	ir_loop     *loop = ll->loop;
+	if (is_Block(node)) {
+		for (int i = 0, n = get_Block_n_cfgpreds(node); i < n; ++i) {
+			ir_node *pred = get_Block_cfgpred_block(node, i);
+			if (pred != NULL && !is_in_loop(pred, loop)) {
+				++ll->n_entries;
+				ll->header    = node;
+				ll->preheader = pred;
+				ll->entry_pos = i;
+			}
+		}
+		bool is_exiting = false;
+		foreach_block_succ(node, edge) {
+			ir_node *succ = get_edge_src_irn(edge);
+			if (is_in_loop(succ, loop))
+				continue;
+			ir_node *cfop = skip_Proj(get_Block_cfgpred(succ, get_edge_src_pos(edge)));
+			if (!is_Jmp(cfop) && !is_Cond(cfop) && !is_Switch(cfop))
+				ll->regular_exits = false;
+			if (get_Block_n_cfgpreds(succ) != 1 || ll->exit_block != NULL)
+				ll->regular_exits = false;
+			ll->exit_block = succ;
+			is_exiting     = true;
+		}
+		if (is_exiting)
+			ARR_APP1(ir_node*, ll->exiting, node);
+	} else if (is_memory_user(node)) {
+		ARR_APP1(ir_node*, ll->memops, node);
+	}
+}
+
+static void find_latches(licm_loop_t *ll)
+{
+	ir_node *header = ll->header;
+	for (int i = 0, n = get_Block_n_cfgpreds(header); i < n; ++i) {
+		ir_node *pred = get_Block_cfgpred_block(header, i);
+		if (pred != NULL && is_in_loop(pred, ll->loop))
+			ARR_APP1(ir_node*, ll->latches, pred);
+	}
+}
+
+/**
+ * Returns true if @p block is executed in every iteration of the loop that
+ * is started.
+ */
+static bool is_executed_always(const licm_loop_t *ll, const ir_node *block)
+{
+	for (size_t i = 0, n = ARR_LEN(ll->exiting); i < n; ++i) {
+		if (!block_dominates(block, ll->exiting[i]))
+			return false;
+	}
+	for (size_t i = 0, n = ARR_LEN(ll->latches); i < n; ++i) {
+		if (!block_dominates(block, ll->latches[i]))
+			return false;
+	}
+	return true;
+}
+
+typedef struct pressure_env_t {
+	ir_loop      *loop;
+	ir_nodeset_t  live_in;
+	unsigned      n_global;
+} pressure_env_t;
+
+static void count_pressure(ir_node *node, void *data)
+{
+	pressure_env_t *env = (pressure_env_t*)data;
+	if (is_Block(node) || !mode_is_data(get_irn_mode(node)))
+		return;
+
+	/* values used in another block are live across block borders */
+	ir_node *block = get_nodes_block(node);
+	foreach_out_edge(node, edge) {
+		ir_node *succ = get_edge_src_irn(edge);
+		if (get_nodes_block(succ) != block || is_Phi(succ)) {
+			++env->n_global;
+			break;
+		}
+	}
+
+	foreach_irn_in(node, i, pred) {
+		if (!mode_is_data(get_irn_mode(pred)) || is_irn_constlike(pred))
+			continue;
+		if (!is_node_in_loop(pred, env->loop))
+			ir_nodeset_insert(&env->live_in, pred);
+	}
+}
+
+/**
+ * Estimates the register pressure inside a loop: All values defined outside
+ * the loop and used inside are live throughout the whole loop, and the values
+ * crossing block borders inside the loop are assumed to be live at the same
+ * time.
+ */
+static unsigned estimate_loop_pressure(const ir_loop *loop)
+{
+	pressure_env_t env = { .loop = (ir_loop*)loop, .n_global = 0 };
+	ir_nodeset_init(&env.live_in);
+	foreach_loop_node(loop, loop, count_pressure, &env);
+	unsigned pressure = ir_nodeset_size(&env.live_in) + env.n_global;
+	ir_nodeset_destroy(&env.live_in);
+	return pressure;
+}
+
+static unsigned get_register_budget(void)
+{
+	arch_isa_if_t const *const isa = ir_target.isa;
+	if (isa == NULL)
+		return DEFAULT_REGISTER_BUDGET;
+	for (unsigned c = 0; c < isa->n_register_classes; ++c) {
+		arch_register_class_t const *const cls = &isa->register_classes[c];
+		if (!cls->manual_ra && mode_is_int(cls->mode)) {
+			/* stack and frame pointer are usually not available */
+			return cls->n_regs > 2 ? cls->n_regs - 2 : cls->n_regs;
+		}
+	}
+	return DEFAULT_REGISTER_BUDGET;
+}
+
+/**
+ * Checks whether @p node can be made loop invariant by hoisting floating
+ * nodes into the preheader. Returns the number of hoisted values that would
+ * increase the register pressure or -1 if this is not possible. If @p commit
+ * is set, the nodes are moved.
+ */
+static int make_invariant(licm_loop_t *ll, ir_node *node, bool commit)
+{
+	if (!is_node_in_loop(node, ll->loop))
+		return 0;
+	if (get_irn_pinned(node) || is_Phi(node) || is_Proj(node))
+		return -1;
+	ir_mode *mode = get_irn_mode(node);
+	if (mode == mode_M || mode == mode_T || mode == mode_X)
+		return -1;
+
+	int cost = 0;
+	foreach_irn_in(node, i, pred) {
+		int pred_cost = make_invariant(ll, pred, commit);
+		if (pred_cost < 0)
+			return -1;
+		cost += pred_cost;
+	}
+	if (commit)
+		set_nodes_block(node, ll->preheader);
+	/* a node with a single user dies in the preheader together with the
+	 * hoisted memory operation */
+	if (get_irn_n_edges(node) > 1)
+		++cost;
+	return cost;
+}
+
+/**
+ * Returns the memory state at the loop entry or NULL if it cannot be
+ * determined.
+ */
+static ir_node *get_entry_mem(const licm_loop_t *ll, ir_node *mem)
+{
+	ir_node *header = ll->header;
+	foreach_out_edge(header, edge) {
+		ir_node *phi = get_edge_src_irn(edge);
+		if (is_Phi(phi) && get_irn_mode(phi) == mode_M)
+			return get_Phi_pred(phi, ll->entry_pos);
+	}
+	/* no memory Phi: the loop only contains Loads */
+	while (is_node_in_loop(mem, ll->loop)) {
+		if (!is_Proj(mem))
+			return NULL;
+		ir_node *pred = get_Proj_pred(mem);
+		if (!is_Load(pred))
+			return NULL;
+		mem = get_Load_mem(pred);
+	}
+	return mem;
+}
+
+static ir_node *get_header_mem_phi(const licm_loop_t *ll)
+{
+	foreach_out_edge(ll->header, edge) {
+		ir_node *phi = get_edge_src_irn(edge);
+		if (is_Phi(phi) && get_irn_mode(phi) == mode_M)
+			return phi;
+	}
+	return NULL;
+}
+
+/**
+ * Returns true if only other Loads may be executed in the current iteration
+ * before the memory state @p mem is reached.
+ */
+static bool is_first_side_effect(const licm_loop_t *ll, ir_node *mem)
+{
+	for (;;) {
+		if (!is_node_in_loop(mem, ll->loop))
+			return true;
+		if (is_Phi(mem))
+			return get_nodes_block(mem) == ll->header;
+		if (is_Sync(mem)) {
+			foreach_irn_in(mem, i, pred) {
+				if (!is_first_side_effect(ll, pred))
+					return false;
+			}
+			return true;
+		}
+		if (!is_Proj(mem))
+			return false;
+		ir_node *pred = get_Proj_pred(mem);
+		if (!is_Load(pred))
+			return false;
+		mem = get_Load_mem(pred);
+	}
+}
+
+/**
+ * Checks whether a memory operation in the loop may modify the given memory
+ * location.
+ */
+static bool is_location_written(const licm_loop_t *ll, const ir_node *ptr,
+                                const ir_type *type, unsigned size)
+{
+	for (size_t i = 0, n = ARR_LEN(ll->memops); i < n; ++i) {
+		ir_node *op = ll->memops[i];
+		switch (get_irn_opcode(op)) {
+		case iro_Load:
+		case iro_Div:
+		case iro_Mod:
+			continue;
+		case iro_Store: {
+			ir_node *value = get_Store_value(op);
+			unsigned st_size = get_mode_size_bytes(get_irn_mode(value));
+			if (get_alias_relation(ptr, type, size, get_Store_ptr(op),
+			                       get_Store_type(op), st_size) != ir_no_alias)
+				return true;
+			continue;
+		}
+		case iro_CopyB: {
+			ir_type *cp_type = get_CopyB_type(op);
+			if (get_alias_relation(ptr, type, size, get_CopyB_dst(op),
+			                       cp_type, get_type_size(cp_type))
+			    != ir_no_alias)
+				return true;
+			continue;
+		}
+		case iro_Call: {
+			ir_type *call_type = get_Call_type(op);
+			mtp_additional_properties props
+				= get_method_additional_properties(call_type);
+			if (props & (mtp_property_no_write | mtp_property_pure))
+				continue;
+			return true;
+		}
+		default:
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Checks whether a memory operation in the loop except @p store may access
+ * the given memory location.
+ */
+static bool is_location_accessed(const licm_loop_t *ll, const ir_node *store,
+                                 const ir_node *ptr, const ir_type *type,
+                                 unsigned size)
+{
+	for (size_t i = 0, n = ARR_LEN(ll->memops); i < n; ++i) {
+		ir_node *op = ll->memops[i];
+		if (op == store)
+			continue;
+		switch (get_irn_opcode(op)) {
+		case iro_Div:
+		case iro_Mod:
+			continue;
+		case iro_Load: {
+			ir_mode *mode = get_Load_mode(op);
+			if (get_alias_relation(ptr, type, size, get_Load_ptr(op),
+			                       get_Load_type(op), get_mode_size_bytes(mode))
+			    != ir_no_alias)
+				return true;
+			continue;
+		}
+		case iro_Store: {
+			ir_node *value = get_Store_value(op);
+			unsigned st_size = get_mode_size_bytes(get_irn_mode(value));
+			if (get_alias_relation(ptr, type, size, get_Store_ptr(op),
+			                       get_Store_type(op), st_size) != ir_no_alias)
+				return true;
+			continue;
+		}
+		case iro_CopyB: {
+			ir_type *cp_type = get_CopyB_type(op);
+			unsigned cp_size = get_type_size(cp_type);
+			if (get_alias_relation(ptr, type, size, get_CopyB_dst(op), cp_type,
+			                       cp_size) != ir_no_alias
+			    || get_alias_relation(ptr, type, size, get_CopyB_src(op),
+			                          cp_type, cp_size) != ir_no_alias)
+				return true;
+			continue;
+		}
+		case iro_Call: {
+			ir_type *call_type = get_Call_type(op);
+			mtp_additional_properties props
+				= get_method_additional_properties(call_type);
+			if (props & mtp_property_pure)
+				continue;
+			return true;
+		}
+		default:
+			return true;
+		}
+	}
+	return false;
+}
+
+/** Returns true if the loop contains a side effect besides @p store. */
+static bool has_other_side_effects(const licm_loop_t *ll, const ir_node *store)
+{
+	for (size_t i = 0, n = ARR_LEN(ll->memops); i < n; ++i) {
+		ir_node *op = ll->memops[i];
+		if (op != store && !is_Load(op))
+			return true;
+	}
+	return false;
+}
+
+static void move_projs(ir_node *node, ir_node *block)
+{
+	foreach_out_edge(node, edge) {
+		ir_node *succ = get_edge_src_irn(edge);
+		if (is_Proj(succ))
+			set_nodes_block(succ, block);
+	}
+}
+
+static bool try_hoist_load(licm_loop_t *ll, ir_node *load)
+{
+	if (get_Load_volatility(load) == volatility_is_volatile
+	    || ir_throws_exception(load))
+		return false;
+
+	/* a Load which might trap must be executed anyway and must not pass other
+	 * side effects */
+	ir_node *block = get_nodes_block(load);
+	ir_node *mem   = get_Load_mem(load);
+	if (get_irn_pinned(load)
+	    && (!is_executed_always(ll, block) || !is_first_side_effect(ll, mem)))
+		return false;
+
+	/* nothing in the loop writes the alias class if its nearest clobber lies
+	 * outside, otherwise check the memory operations one by one */
+	ir_node *ptr     = get_Load_ptr(load);
+	ir_type *type    = get_Load_type(load);
+	unsigned size    = get_mode_size_bytes(get_Load_mode(load));
+	unsigned cls     = memssa_get_class(ll->memssa, ptr);
+	ir_node *clobber = memssa_skip(ll->memssa, mem, cls, memssa_clobber);
+	if (is_node_in_loop(clobber, ll->loop)
+	    && is_location_written(ll, ptr, type, size))
+		return false;
+
+	int cost = make_invariant(ll, ptr, false);
+	if (cost < 0)
+		return false;
+	++cost;
+	if (ll->pressure + (unsigned)cost > ll->budget) {
+		DB((dbg, LEVEL_2, "  not hoisting %+F: register pressure %u\n", load,
+		    ll->pressure));
+		return false;
+	}
+
+	ir_node *entry_mem = get_entry_mem(ll, mem);
+	if (entry_mem == NULL)
+		return false;
+
+	DB((dbg, LEVEL_1, "  hoisting %+F into %+F\n", load, ll->preheader));
+	make_invariant(ll, ptr, true);
+	ll->pressure += cost;
+
+	ir_node *proj_m = NULL;
+	foreach_out_edge(load, edge) {
+		ir_node *succ = get_edge_src_irn(edge);
+		if (is_Proj(succ) && get_Proj_num(succ) == pn_Load_M)
+			proj_m = succ;
+	}
+	if (proj_m != NULL)
+		edges_reroute(proj_m, mem);
+	set_Load_mem(load, entry_mem);
+	set_nodes_block(load, ll->preheader);
+	move_projs(load, ll->preheader);
+
+	/* thread the Load into the memory entering the loop */
+	ir_node *phi = get_header_mem_phi(ll);
+	if (phi != NULL && proj_m != NULL)
+		set_Phi_pred(phi, ll->entry_pos, proj_m);
+	memssa_invalidate(ll->memssa);
+	return true;
+}
+
+typedef struct sink_env_t {
+	ir_node   *exit_block;
+	ir_node   *store;
+	ir_node  **users;
+	int       *positions;
+} sink_env_t;
+
+static ir_node *get_use_block(ir_node *user, int pos)
+{
+	if (is_Phi(user))
+		return get_Block_cfgpred_block(get_nodes_block(user), pos);
+	return get_nodes_block(user);
+}
+
+/**
+ * Collects the memory uses after the loop exit which use memory values from
+ * before the exit.
+ */
+static void collect_exit_mem_uses(ir_node *node, void *data)
+{
+	sink_env_t *env = (sink_env_t*)data;
+	if (is_Block(node) || is_End(node) || node == env->store)
+		return;
+	ir_node *exit_block = env->exit_block;
+	foreach_irn_in(node, i, pred) {
+		if (get_irn_mode(pred) != mode_M)
+			continue;
+		ir_node *use_block = get_use_block(node, i);
+		if (use_block == NULL || !block_dominates(exit_block, use_block))
+			continue;
+		if (block_dominates(exit_block, get_nodes_block(pred)))
+			continue;
+		ARR_APP1(ir_node*, env->users, node);
+		ARR_APP1(int, env->positions, i);
+	}
+}
+
+static bool try_sink_store(licm_loop_t *ll, ir_node *store)
+{
+	ir_node *block = get_nodes_block(store);
+	if (ll->exit_block == NULL || !ll->regular_exits
+	    || get_irn_loop(block) != ll->loop
+	    || get_Store_volatility(store) == volatility_is_volatile
+	    || ir_throws_exception(store))
+		return false;
+
+	/* the Store must be executed in every iteration right before the exit */
+	for (size_t i = 0, n = ARR_LEN(ll->exiting); i < n; ++i) {
+		if (!block_dominates(block, ll->exiting[i]))
+			return false;
+	}
+	/* a trapping Store must not be moved behind other side effects */
+	if (get_irn_pinned(store) && has_other_side_effects(ll, store))
+		return false;
+
+	ir_node *ptr   = get_Store_ptr(store);
+	ir_node *value = get_Store_value(store);
+	if (is_node_in_loop(ptr, ll->loop))
+		return false;
+	/* only values computed once per iteration reach the exit unchanged */
+	if (is_node_in_loop(value, ll->loop)
+	    && get_irn_loop(get_nodes_block(value)) != ll->loop)
+		return false;
+
+	ir_type *type = get_Store_type(store);
+	unsigned size = get_mode_size_bytes(get_irn_mode(value));
+	if (is_location_accessed(ll, store, ptr, type, size))
+		return false;
+
+	ir_node *exit_block = ll->exit_block;
+	foreach_out_edge(exit_block, edge) {
+		ir_node *succ = get_edge_src_irn(edge);
+		if (is_Phi(succ) && get_irn_mode(succ) == mode_M)
+			return false;
+	}
+
+	ir_node *proj_m = NULL;
+	foreach_out_edge(store, edge) {
+		ir_node *succ = get_edge_src_irn(edge);
+		if (is_Proj(succ) && get_Proj_num(succ) == pn_Store_M)
+			proj_m = succ;
+	}
+	if (proj_m == NULL)
+		return false;
+
+	sink_env_t env = {
+		.exit_block = exit_block,
+		.store      = store,
+		.users      = NEW_ARR_F(ir_node*, 0),
+		.positions  = NEW_ARR_F(int, 0),
+	};
+	irg_walk_graph(get_irn_irg(store), NULL, collect_exit_mem_uses, &env);
+
+	size_t n_users = ARR_LEN(env.users);
+	if (n_users == 0) {
+		/* nobody observes memory after the loop, keep the Store */
+		DEL_ARR_F(env.users);
+		DEL_ARR_F(env.positions);
+		return false;
+	}
+
+	/* remove the Store from the memory chain of the loop */
+	edges_reroute(proj_m, get_Store_mem(store));
+
+	DB((dbg, LEVEL_1, "  sinking %+F into %+F\n", store, exit_block));
+	ir_node **ins = NEW_ARR_F(ir_node*, 0);
+	for (size_t i = 0; i < n_users; ++i) {
+		ir_node *in = get_irn_n(env.users[i], env.positions[i]);
+		bool     found = false;
+		for (size_t j = 0, n = ARR_LEN(ins); j < n; ++j) {
+			if (ins[j] == in)
+				found = true;
+		}
+		if (!found)
+			ARR_APP1(ir_node*, ins, in);
+	}
+	ir_node *new_mem = ARR_LEN(ins) == 1 ? ins[0]
+		: new_r_Sync(exit_block, (int)ARR_LEN(ins), ins);
+	DEL_ARR_F(ins);
+
+	set_Store_mem(store, new_mem);
+	set_nodes_block(store, exit_block);
+	move_projs(store, exit_block);
+	for (size_t i = 0; i < n_users; ++i)
+		set_irn_n(env.users[i], env.positions[i], proj_m);
+	memssa_invalidate(ll->memssa);
+
+	DEL_ARR_F(env.users);
+	DEL_ARR_F(env.positions);
+	return true;
+}
+
+static void optimize_loop(licm_env_t *env, ir_loop *loop)
+{
+	licm_loop_t ll = {
+		.loop          = loop,
+		.entry_pos     = -1,
+		.exiting       = NEW_ARR_F(ir_node*, 0),
+		.latches       = NEW_ARR_F(ir_node*, 0),
+		.memops        = NEW_ARR_F(ir_node*, 0),
+		.memssa        = env->memssa,
+		.regular_exits = true,
+	};
+	foreach_loop_node(loop, loop, analyze_loop_node, &ll);
+
+	/* we need a single entry from a block with a single successor */
+	if (ll.n_entries != 1
+	    || !is_Jmp(get_Block_cfgpred(ll.header, ll.entry_pos)))
+		goto end;
+	DB((dbg, LEVEL_2, "processing loop %ld (header %+F)\n",
+	    get_loop_loop_nr(loop), ll.header));
+	find_latches(&ll);
+	ll.pressure = estimate_loop_pressure(loop);
+	ll.budget   = env->budget;
+
+	/* hoisting one Load might make the address of another one invariant */
+	bool changed;
+	do {
+		changed = false;
+		for (size_t i = 0, n = ARR_LEN(ll.memops); i < n; ++i) {
+			ir_node *op = ll.memops[i];
+			if (is_Load(op) && is_node_in_loop(op, loop)
+			    && try_hoist_load(&ll, op)) {
+				ll.memops[i--] = ll.memops[--n];
+				ARR_SHRINKLEN(ll.memops, n);
+				changed = true;
+			}
+		}
+		env->changed |= changed;
+	} while (changed);
+
+	for (size_t i = 0, n = ARR_LEN(ll.memops); i < n; ++i) {
+		ir_node *op = ll.memops[i];
+		if (is_Store(op) && try_sink_store(&ll, op)) {
+			ll.memops[i--] = ll.memops[--n];
+			ARR_SHRINKLEN(ll.memops, n);
+			env->changed = true;
+		}
+	}
+
+end:
+	DEL_ARR_F(ll.exiting);
+	DEL_ARR_F(ll.latches);
+	DEL_ARR_F(ll.memops);
+}
+
+/** Processes the loop tree bottom up, so inner loops are handled first. */
+static void optimize_loops(licm_env_t *env, ir_loop *loop)
+{
+	for (size_t i = 0, n = get_loop_n_elements(loop); i < n; ++i) {
+		loop_element elem = get_loop_element(loop, i);
+		if (*elem.kind == k_ir_loop)
+			optimize_loops(env, elem.son);
+	}
+	if (get_loop_depth(loop) > 0)
+		optimize_loop(env, loop);
+}
+
+void opt_licm(ir_graph *irg)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.opt.licm");
+
+	assure_irg_properties(irg,
+		IR_GRAPH_PROPERTY_NO_CRITICAL_EDGES |
+		IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE |
+		IR_GRAPH_PROPERTY_NO_BADS |
+		IR_GRAPH_PROPERTY_NO_TUPLES |
+		IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES |
+		IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE |
+		IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO |
+		IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE |
+		IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_ORACLE);
+
+	const ir_disambiguator_options opts =
+		get_irg_memory_disambiguator_options(irg);
+	if ((opts & aa_opt_always_alias) == 0)
+		assure_irp_globals_entity_usage_computed();
+
+	licm_env_t env = {
+		.infos  = NEW_ARR_F(loop_info_t*, 0),
+		.budget = get_register_budget(),
+	};
+	obstack_init(&env.obst);
+
+	ir_loop *root = get_irg_loop(irg);
+	clear_loop_links(root);
+	irg_walk_graph(irg, collect_nodes, NULL, &env);
+	env.memssa = memssa_new(irg);
+	optimize_loops(&env, root);
+	memssa_free(env.memssa);
+	clear_loop_links(root);
+
+	for (size_t i = 0, n = ARR_LEN(env.infos); i < n; ++i) {
+		DEL_ARR_F(env.infos[i]->blocks);
+		DEL_ARR_F(env.infos[i]->nodes);
+	}
+	DEL_ARR_F(env.infos);
+	obstack_free(&env.obst, NULL);
+
+	confirm_irg_properties(irg, env.changed
+		? IR_GRAPH_PROPERTIES_CONTROL_FLOW | IR_GRAPH_PROPERTY_NO_BADS
+		  | IR_GRAPH_PROPERTY_NO_TUPLES | IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
+		  | IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE
+		  | IR_GRAPH_PROPERTY_MANY_RETURNS
+		: IR_GRAPH_PROPERTIES_ALL);
+}
@@ -18,7 +18,7 @@
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
 
-pset_new_t loop_blocks;
+static FIRM_THREAD_LOCAL pset_new_t loop_blocks;
 
 static void add_edge(ir_node *const node, ir_node *const pred)
 {
@@ -545,7 +545,7 @@ static void rewire_fully_unrolled(ir_loop *const loop, ir_node *header) {
 	DB((dbg, LEVEL_2, "fully unrolled %+F\n", loop));
 }
 
-static unsigned n_loops_unrolled = 0;
+static FIRM_THREAD_LOCAL unsigned n_loops_unrolled = 0;
 
 static bool unroll_loop(ir_loop *const loop, unsigned factor)
 {
@@ -624,7 +624,7 @@ static size_t count_nodes(ir_loop *const loop)
 	return n_nodes;
 }
 
-static bool reanalyze = false;
+static FIRM_THREAD_LOCAL bool reanalyze = false;
 
 static bool duplicate_innermost_loops(ir_loop *const loop, unsigned const factor, unsigned const maxsize, bool const container)
 {
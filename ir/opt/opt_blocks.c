@@ -136,7 +136,7 @@ typedef struct listmap_t {
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 
 /** Next partition number. */
-DEBUG_ONLY(static unsigned part_nr = 0;)
+DEBUG_ONLY(static FIRM_THREAD_LOCAL unsigned part_nr = 0;)
 
 #ifdef DEBUG_libfirm
 /**
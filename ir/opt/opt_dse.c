@@ -0,0 +1,678 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Dead store elimination for local variables.
+ *
+ * A local variable whose address is never taken is only accessed by Loads,
+ * Stores, CopyBs and Calls receiving it as an aggregate argument, which reach
+ * it through Members, Sels and constant offsets from the frame. So the
+ * accessed bytes are known, and a backward liveness analysis over the memory
+ * graph finds the Stores whose bytes are overwritten on every path or never
+ * read again before the function returns. These are removed.
+ *
+ * A Store whose bytes are read after some but not all successors of its block
+ * is sunk into the successors reading them, if nothing between the Store and
+ * the end of its block accesses its bytes.
+ */
+#include "array.h"
+#include "debug.h"
+#include "hashptr.h"
+#include "ircons.h"
+#include "irdom.h"
+#include "iredges_t.h"
+#include "irgmod.h"
+#include "irgraph_t.h"
+#include "irgwalk.h"
+#include "irmemory.h"
+#include "irnode_t.h"
+#include "iroptimize.h"
+#include "irtools.h"
+#include "obst.h"
+#include "raw_bitset.h"
+#include "set.h"
+#include "tv.h"
+#include "type_t.h"
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+
+/** A local variable whose accesses are tracked. */
+typedef struct dse_entity_t {
+	unsigned *slots;  /**< the slots inside the variable */
+	bool      opaque; /**< the address is used in an unexpected way */
+} dse_entity_t;
+
+/** The bytes written by a Store. */
+typedef struct dse_slot_t {
+	dse_entity_t *ent;
+	long          offset;
+	unsigned      size;
+	unsigned      nr;
+} dse_slot_t;
+
+/** An address inside a local variable. */
+typedef struct dse_addr_t {
+	dse_entity_t *ent;
+	long          offset;
+	bool          known;  /**< the offset is constant */
+} dse_addr_t;
+
+/** An access of a memory operation to a local variable. */
+typedef struct dse_access_t {
+	struct dse_access_t *next;
+	dse_addr_t const    *addr;
+	unsigned             size;  /**< 0 if unknown */
+	bool                 write;
+	unsigned             slot;  /**< slot of a Store or ~0u */
+} dse_access_t;
+
+/** The liveness of a memory value. */
+typedef struct dse_mem_t {
+	unsigned *live;   /**< slots which may be read later */
+	bool      queued;
+} dse_mem_t;
+
+typedef struct dse_env_t {
+	struct obstack obst;
+	ir_graph      *irg;
+	set           *slot_set; /**< all slots */
+	dse_slot_t   **slots;    /**< slots by number */
+	ir_node      **stores;   /**< Stores to local variables */
+	ir_node      **mems;     /**< memory values */
+	unsigned      *live;     /**< scratch sets */
+	unsigned      *after;
+	bool           changed;
+} dse_env_t;
+
+static int cmp_slot(void const *const elt, void const *const key,
+                    size_t const size)
+{
+	(void)size;
+	dse_slot_t const *const s1 = (dse_slot_t const*)elt;
+	dse_slot_t const *const s2 = (dse_slot_t const*)key;
+	return s1->ent != s2->ent || s1->offset != s2->offset
+	    || s1->size != s2->size;
+}
+
+static unsigned get_n_slots(dse_env_t const *const env)
+{
+	return ARR_LEN(env->slots);
+}
+
+static void add_access(dse_env_t *const env, ir_node *const node,
+                       dse_addr_t const *const addr, unsigned const size,
+                       bool const write)
+{
+	dse_access_t *const access = OALLOC(&env->obst, dse_access_t);
+	access->next  = (dse_access_t*)get_irn_link(node);
+	access->addr  = addr;
+	access->size  = size;
+	access->write = write;
+	access->slot  = ~0u;
+	set_irn_link(node, access);
+	if (write && is_Store(node))
+		ARR_APP1(ir_node*, env->stores, node);
+}
+
+static void analyze_addr(dse_env_t *env, ir_node *node, dse_addr_t *addr);
+
+static void derive_addr(dse_env_t *const env, ir_node *const node,
+                        dse_addr_t const *const base, long const offset,
+                        bool const known)
+{
+	dse_addr_t *const addr = OALLOC(&env->obst, dse_addr_t);
+	addr->ent    = base->ent;
+	addr->offset = base->offset + offset;
+	addr->known  = base->known && known;
+	analyze_addr(env, node, addr);
+}
+
+static bool get_const_long(ir_node const *const node, long *const value)
+{
+	if (!is_Const(node))
+		return false;
+	ir_tarval *const tv = get_Const_tarval(node);
+	if (!tarval_is_long(tv))
+		return false;
+	*value = get_tarval_long(tv);
+	return true;
+}
+
+/**
+ * Records the accesses through @p node, which is the address @p addr, and
+ * continues with the addresses computed from it.
+ */
+static void analyze_addr(dse_env_t *const env, ir_node *const node,
+                         dse_addr_t *const addr)
+{
+	dse_entity_t *const ent = addr->ent;
+	if (get_irn_link(node) != NULL) {
+		ent->opaque = true;
+		return;
+	}
+	set_irn_link(node, addr);
+
+	foreach_out_edge(node, edge) {
+		ir_node *const user = get_edge_src_irn(edge);
+		int      const pos  = get_edge_src_pos(edge);
+		switch (get_irn_opcode(user)) {
+		case iro_Member: {
+			ir_entity *const member = get_Member_entity(user);
+			bool const known = get_type_state(get_entity_owner(member))
+			                   == layout_fixed;
+			derive_addr(env, user, addr, known ? get_entity_offset(member) : 0,
+			            known);
+			break;
+		}
+
+		case iro_Sel: {
+			if (pos != n_Sel_ptr) {
+				ent->opaque = true;
+				break;
+			}
+			ir_type *const type = get_Sel_type(user);
+			long           index;
+			bool     const known = get_const_long(get_Sel_index(user), &index);
+			derive_addr(env, user, addr,
+			            known ? index * (long)get_type_size(
+			                        get_array_element_type(type)) : 0,
+			            known);
+			break;
+		}
+
+		case iro_Add: {
+			ir_node *const other = get_irn_n(user, 1 - pos);
+			long           offset;
+			if (mode_is_reference(get_irn_mode(other))) {
+				ent->opaque = true;
+				break;
+			}
+			bool const known = get_const_long(other, &offset);
+			derive_addr(env, user, addr, known ? offset : 0, known);
+			break;
+		}
+
+		case iro_Sub: {
+			long offset;
+			if (pos != n_Sub_left
+			    || !mode_is_reference(get_irn_mode(user))) {
+				ent->opaque = true;
+				break;
+			}
+			bool const known = get_const_long(get_Sub_right(user), &offset);
+			derive_addr(env, user, addr, known ? -offset : 0, known);
+			break;
+		}
+
+		case iro_Id:
+			derive_addr(env, user, addr, 0, true);
+			break;
+
+		case iro_Load:
+			add_access(env, user, addr,
+			           get_mode_size_bytes(get_Load_mode(user)), false);
+			break;
+
+		case iro_Store:
+			if (pos != n_Store_ptr) {
+				ent->opaque = true;
+				break;
+			}
+			add_access(env, user, addr,
+			           get_mode_size_bytes(get_irn_mode(get_Store_value(user))),
+			           true);
+			break;
+
+		case iro_CopyB:
+			add_access(env, user, addr, get_type_size(get_CopyB_type(user)),
+			           pos == n_CopyB_dst);
+			break;
+
+		case iro_Call: {
+			if (pos < n_Call_max + 1) {
+				ent->opaque = true;
+				break;
+			}
+			ir_type *const type
+				= get_method_param_type(get_Call_type(user), pos - n_Call_max - 1);
+			add_access(env, user, addr,
+			           is_aggregate_type(type) ? get_type_size(type) : 0, false);
+			break;
+		}
+
+		case iro_Builtin:
+			if (get_Builtin_kind(user) != ir_bk_may_alias)
+				ent->opaque = true;
+			break;
+
+		default:
+			ent->opaque = true;
+			break;
+		}
+	}
+}
+
+/** Creates the slot of a Store to a local variable. */
+static void add_slot(dse_env_t *const env, ir_node *const store)
+{
+	dse_access_t *const access = (dse_access_t*)get_irn_link(store);
+	dse_addr_t   const *addr   = access->addr;
+	if (addr->ent->opaque || !addr->known)
+		return;
+
+	dse_slot_t const key = {
+		.ent    = addr->ent,
+		.offset = addr->offset,
+		.size   = access->size,
+		.nr     = get_n_slots(env),
+	};
+	unsigned const hash = hash_combine(hash_ptr(key.ent),
+	                                   hash_combine(key.offset, key.size));
+	dse_slot_t *const slot
+		= set_insert(dse_slot_t, env->slot_set, &key, sizeof(key), hash);
+	if (slot->nr == get_n_slots(env)) {
+		ARR_APP1(dse_slot_t*, env->slots, slot);
+		ARR_APP1(unsigned, addr->ent->slots, slot->nr);
+	}
+	access->slot = slot->nr;
+}
+
+static bool overlaps(dse_slot_t const *const slot, long const offset,
+                     unsigned const size)
+{
+	return slot->offset < offset + (long)size
+	    && offset < slot->offset + (long)slot->size;
+}
+
+static bool contains(long const offset, unsigned const size,
+                     dse_slot_t const *const slot)
+{
+	return offset <= slot->offset
+	    && slot->offset + (long)slot->size <= offset + (long)size;
+}
+
+/**
+ * Turns the slots @p live live after @p node into the ones live before it.
+ * Writes are applied before reads, as a CopyB reads its source first.
+ */
+static void apply_accesses(dse_env_t const *const env, ir_node const *const node,
+                           unsigned *const live)
+{
+	dse_access_t const *const accesses = (dse_access_t const*)get_irn_link(node);
+	for (dse_access_t const *a = accesses; a != NULL; a = a->next) {
+		dse_addr_t const *const addr = a->addr;
+		if (!a->write || !addr->known || a->size == 0)
+			continue;
+		unsigned const *const slots = addr->ent->slots;
+		for (size_t i = 0, n = ARR_LEN(slots); i < n; ++i) {
+			if (contains(addr->offset, a->size, env->slots[slots[i]]))
+				rbitset_clear(live, slots[i]);
+		}
+	}
+	for (dse_access_t const *a = accesses; a != NULL; a = a->next) {
+		dse_addr_t const *const addr = a->addr;
+		if (a->write)
+			continue;
+		unsigned const *const slots = addr->ent->slots;
+		for (size_t i = 0, n = ARR_LEN(slots); i < n; ++i) {
+			dse_slot_t const *const slot = env->slots[slots[i]];
+			if (!addr->known || a->size == 0
+			    || overlaps(slot, addr->offset, a->size))
+				rbitset_set(live, slots[i]);
+		}
+	}
+}
+
+/** Returns the memory Proj of @p node or NULL. */
+static ir_node *get_mem_proj(ir_node const *const node)
+{
+	foreach_out_edge(node, edge) {
+		ir_node *const proj = get_edge_src_irn(edge);
+		if (is_Proj(proj) && get_irn_mode(proj) == mode_M)
+			return proj;
+	}
+	return NULL;
+}
+
+/** Adds the slots of memory value @p mem to @p live. */
+static void add_live_mem(dse_env_t const *const env, ir_node const *const mem,
+                         unsigned *const live)
+{
+	dse_mem_t const *const info = (dse_mem_t const*)get_irn_link(mem);
+	/* a memory value created by this pass */
+	if (info == NULL)
+		rbitset_set_all(live, get_n_slots(env));
+	else
+		rbitset_or(live, info->live, get_n_slots(env));
+}
+
+/** Adds the slots live before @p user of a memory value to @p live. */
+static void add_live_in(dse_env_t const *const env, ir_node const *const user,
+                        unsigned *const live)
+{
+	if (get_irn_mode(user) == mode_M) {
+		add_live_mem(env, user, live);
+		return;
+	}
+
+	unsigned *const after = env->after;
+	rbitset_clear_all(after, get_n_slots(env));
+	if (get_irn_mode(user) == mode_T) {
+		foreach_out_edge(user, edge) {
+			ir_node *const proj = get_edge_src_irn(edge);
+			if (is_Proj(proj) && get_irn_mode(proj) == mode_M)
+				add_live_mem(env, proj, after);
+		}
+	}
+	apply_accesses(env, user, after);
+	rbitset_or(live, after, get_n_slots(env));
+}
+
+static void compute_live(dse_env_t const *const env, ir_node const *const mem,
+                         unsigned *const live)
+{
+	rbitset_clear_all(live, get_n_slots(env));
+	foreach_out_edge(mem, edge) {
+		add_live_in(env, get_edge_src_irn(edge), live);
+	}
+}
+
+static void collect_mem(ir_node *const node, void *const data)
+{
+	dse_env_t *const env = (dse_env_t*)data;
+	if (get_irn_mode(node) != mode_M)
+		return;
+	dse_mem_t *const info = OALLOC(&env->obst, dse_mem_t);
+	info->live   = rbitset_obstack_alloc(&env->obst, get_n_slots(env));
+	info->queued = true;
+	set_irn_link(node, info);
+	ARR_APP1(ir_node*, env->mems, node);
+}
+
+/** Computes the live slots of all memory values. */
+static void compute_liveness(dse_env_t *const env)
+{
+	/* the walk visits users after their operands, so process it backwards */
+	irg_walk_graph(env->irg, NULL, collect_mem, env);
+	unsigned *const live = env->live;
+	while (ARR_LEN(env->mems) > 0) {
+		size_t     const last = ARR_LEN(env->mems) - 1;
+		ir_node   *const mem  = env->mems[last];
+		dse_mem_t *const info = (dse_mem_t*)get_irn_link(mem);
+		ARR_SHRINKLEN(env->mems, last);
+		info->queued = false;
+
+		compute_live(env, mem, live);
+		if (rbitsets_equal(live, info->live, get_n_slots(env)))
+			continue;
+		rbitset_copy(info->live, live, get_n_slots(env));
+
+		ir_node *const producer = is_Proj(mem) ? get_Proj_pred(mem) : mem;
+		foreach_irn_in(producer, i, pred) {
+			if (get_irn_mode(pred) != mode_M)
+				continue;
+			dse_mem_t *const pred_info = (dse_mem_t*)get_irn_link(pred);
+			if (!pred_info->queued) {
+				pred_info->queued = true;
+				ARR_APP1(ir_node*, env->mems, pred);
+			}
+		}
+	}
+}
+
+static bool is_removable(ir_node const *const store)
+{
+	return get_Store_volatility(store) != volatility_is_volatile
+	    && !ir_throws_exception(store);
+}
+
+static void remove_store(dse_env_t *const env, ir_node *const store)
+{
+	exchange(get_mem_proj(store), get_Store_mem(store));
+	kill_node(store);
+	env->changed = true;
+}
+
+/** Removes the Stores whose slot is dead afterwards. */
+static void remove_dead_stores(dse_env_t *const env)
+{
+	for (size_t i = 0, n = ARR_LEN(env->stores); i < n; ++i) {
+		ir_node      *const store  = env->stores[i];
+		dse_access_t *const access = (dse_access_t*)get_irn_link(store);
+		ir_node      *const proj   = get_mem_proj(store);
+		if (access->slot == ~0u || proj == NULL || !is_removable(store))
+			continue;
+
+		dse_mem_t const *const info = (dse_mem_t const*)get_irn_link(proj);
+		if (rbitset_is_set(info->live, access->slot))
+			continue;
+		DB((dbg, LEVEL_1, "removing dead %+F\n", store));
+		remove_store(env, store);
+		env->stores[i] = NULL;
+	}
+}
+
+/** Returns true if @p node may access the bytes of @p slot. */
+static bool accesses_slot(ir_node const *const node,
+                          dse_slot_t const *const slot)
+{
+	for (dse_access_t const *a = (dse_access_t const*)get_irn_link(node);
+	     a != NULL; a = a->next) {
+		dse_addr_t const *const addr = a->addr;
+		if (addr->ent == slot->ent
+		    && (!addr->known || a->size == 0
+		        || overlaps(slot, addr->offset, a->size)))
+			return true;
+	}
+	return false;
+}
+
+/** A use of the memory leaving a block. */
+typedef struct dse_use_t {
+	ir_node *user;
+	int      pos;
+	size_t   succ;  /**< the successor dominating the use */
+} dse_use_t;
+
+/**
+ * Sinks @p store into the successors of its block after which its slot is
+ * live, if there are others after which it is dead.
+ */
+static void sink_store(dse_env_t *const env, ir_node *const store)
+{
+	dse_access_t const *const access = (dse_access_t const*)get_irn_link(store);
+	if (access->slot == ~0u || !is_removable(store))
+		return;
+	ir_node *const block   = get_nodes_block(store);
+	unsigned       n_succs = 0;
+	foreach_block_succ(block, edge) {
+		++n_succs;
+	}
+	if (n_succs < 2)
+		return;
+
+	/* find the memory leaving the block, nothing on the way may access the
+	 * slot */
+	dse_slot_t const *const slot = env->slots[access->slot];
+	ir_node                *mem  = get_mem_proj(store);
+	for (;;) {
+		if (mem == NULL)
+			return;
+		ir_node *next   = NULL;
+		bool     leaves = false;
+		foreach_out_edge(mem, edge) {
+			ir_node *const user = get_edge_src_irn(edge);
+			if (get_nodes_block(user) != block) {
+				leaves = true;
+			} else if (next != NULL || !is_memop(user)
+			           || accesses_slot(user, slot)) {
+				return;
+			} else {
+				next = user;
+			}
+		}
+		if (next == NULL)
+			break;
+		if (leaves)
+			return;
+		mem = get_mem_proj(next);
+	}
+
+	ir_node  **const succs = ALLOCAN(ir_node*, n_succs);
+	unsigned **const live  = ALLOCAN(unsigned*, n_succs);
+	unsigned         i     = 0;
+	foreach_block_succ(block, edge) {
+		succs[i] = get_edge_src_irn(edge);
+		live[i]  = rbitset_obstack_alloc(&env->obst, get_n_slots(env));
+		++i;
+	}
+	dse_use_t *uses = NEW_ARR_F(dse_use_t, 0);
+	bool       ok   = true;
+	foreach_out_edge(mem, edge) {
+		ir_node *const user = get_edge_src_irn(edge);
+		int      const pos  = get_edge_src_pos(edge);
+		ir_node       *use_block;
+		if (is_End(user)) {
+			ok = false;
+			break;
+		} else if (is_Phi(user)) {
+			use_block = get_Block_cfgpred_block(get_nodes_block(user), pos);
+		} else {
+			use_block = get_nodes_block(user);
+		}
+
+		unsigned succ = 0;
+		while (succ < n_succs && !block_dominates(succs[succ], use_block))
+			++succ;
+		if (succ == n_succs) {
+			ok = false;
+			break;
+		}
+		add_live_in(env, user, live[succ]);
+		ARR_APP1(dse_use_t, uses, ((dse_use_t){ user, pos, succ }));
+	}
+
+	unsigned n_live = 0;
+	for (unsigned i = 0; i < n_succs; ++i)
+		n_live += rbitset_is_set(live[i], access->slot);
+	if (ok && n_live > 0 && n_live < n_succs) {
+		DB((dbg, LEVEL_1, "sinking %+F into %u of %u successors\n", store,
+		    n_live, n_succs));
+		ir_node  **const projs = ALLOCANZ(ir_node*, n_succs);
+		dbg_info  *const dbgi  = get_irn_dbg_info(store);
+		ir_cons_flags const flags
+			= get_Store_unaligned(store) == align_non_aligned ? cons_unaligned
+			                                                  : cons_none;
+		for (unsigned i = 0; i < n_succs; ++i) {
+			if (!rbitset_is_set(live[i], access->slot))
+				continue;
+			ir_node *const copy = new_rd_Store(dbgi, succs[i], mem,
+			                                   get_Store_ptr(store),
+			                                   get_Store_value(store),
+			                                   get_Store_type(store), flags);
+			projs[i] = new_r_Proj(copy, mode_M, pn_Store_M);
+
+			/* keep the liveness for Stores sunk across the copy */
+			dse_mem_t *const info = OALLOC(&env->obst, dse_mem_t);
+			info->live   = live[i];
+			info->queued = false;
+			set_irn_link(copy, (void*)access);
+			set_irn_link(projs[i], info);
+		}
+		for (size_t i = 0, n = ARR_LEN(uses); i < n; ++i) {
+			dse_use_t const *const use = &uses[i];
+			if (projs[use->succ] != NULL)
+				set_irn_n(use->user, use->pos, projs[use->succ]);
+		}
+		remove_store(env, store);
+	}
+	DEL_ARR_F(uses);
+}
+
+void opt_dse(ir_graph *irg)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.opt.dse");
+
+	assure_irg_properties(irg,
+		IR_GRAPH_PROPERTY_NO_CRITICAL_EDGES |
+		IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE |
+		IR_GRAPH_PROPERTY_NO_TUPLES |
+		IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES |
+		IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE |
+		IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE);
+
+	dse_env_t env = {
+		.irg      = irg,
+		.slot_set = new_set(cmp_slot, 16),
+		.slots    = NEW_ARR_F(dse_slot_t*, 0),
+		.stores   = NEW_ARR_F(ir_node*, 0),
+		.mems     = NEW_ARR_F(ir_node*, 0),
+	};
+	obstack_init(&env.obst);
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
+	irg_walk_graph(irg, firm_clear_link, NULL, NULL);
+
+	/* collect the accesses to local variables whose address is not taken */
+	ir_type      *const frame_type = get_irg_frame_type(irg);
+	dse_entity_t      **ents       = NEW_ARR_F(dse_entity_t*, 0);
+	irp_reserve_resources(irp, IRP_RESOURCE_ENTITY_LINK);
+	for (size_t i = 0, n = get_compound_n_members(frame_type); i < n; ++i)
+		set_entity_link(get_compound_member(frame_type, i), NULL);
+	foreach_out_edge(get_irg_frame(irg), edge) {
+		ir_node   *const member = get_edge_src_irn(edge);
+		if (!is_Member(member))
+			continue;
+		ir_entity *const entity = get_Member_entity(member);
+		if (get_entity_owner(entity) != frame_type
+		    || is_parameter_entity(entity)
+		    || (get_entity_usage(entity) & ir_usage_address_taken))
+			continue;
+
+		dse_entity_t *ent = (dse_entity_t*)get_entity_link(entity);
+		if (ent == NULL) {
+			ent        = OALLOCZ(&env.obst, dse_entity_t);
+			ent->slots = NEW_ARR_F(unsigned, 0);
+			set_entity_link(entity, ent);
+			ARR_APP1(dse_entity_t*, ents, ent);
+		}
+		dse_addr_t *const addr = OALLOCZ(&env.obst, dse_addr_t);
+		addr->ent   = ent;
+		addr->known = true;
+		analyze_addr(&env, member, addr);
+	}
+	for (size_t i = 0, n = ARR_LEN(env.stores); i < n; ++i)
+		add_slot(&env, env.stores[i]);
+
+	unsigned const n_slots = get_n_slots(&env);
+	DB((dbg, LEVEL_2, "%+F: %zu variables, %u slots\n", irg, ARR_LEN(ents),
+	    n_slots));
+	if (n_slots > 0) {
+		env.live  = rbitset_obstack_alloc(&env.obst, n_slots);
+		env.after = rbitset_obstack_alloc(&env.obst, n_slots);
+		compute_liveness(&env);
+		remove_dead_stores(&env);
+		for (size_t i = 0, n = ARR_LEN(env.stores); i < n; ++i) {
+			if (env.stores[i] != NULL)
+				sink_store(&env, env.stores[i]);
+		}
+	}
+
+	for (size_t i = 0, n = ARR_LEN(ents); i < n; ++i)
+		DEL_ARR_F(ents[i]->slots);
+	DEL_ARR_F(ents);
+	irp_free_resources(irp, IRP_RESOURCE_ENTITY_LINK);
+	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
+	obstack_free(&env.obst, NULL);
+	DEL_ARR_F(env.mems);
+	DEL_ARR_F(env.stores);
+	DEL_ARR_F(env.slots);
+	del_set(env.slot_set);
+
+	confirm_irg_properties(irg, env.changed
+		? IR_GRAPH_PROPERTIES_CONTROL_FLOW | IR_GRAPH_PROPERTY_NO_TUPLES
+		  | IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
+		: IR_GRAPH_PROPERTIES_ALL);
+}
@@ -119,7 +119,7 @@ typedef struct ldst_env_t {
 } ldst_env;
 
 /* the one and only environment */
-static ldst_env env;
+static FIRM_THREAD_LOCAL ldst_env env;
 
 #ifdef DEBUG_libfirm
 
@@ -1762,7 +1762,8 @@ void opt_ldst(ir_graph *irg)
 		| IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE
 		| IR_GRAPH_PROPERTY_CONSISTENT_OUTS
 		| IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE
-		| IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+		| IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
+		| IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_ORACLE);
 
 	const ir_disambiguator_options opts =
 		get_irg_memory_disambiguator_options(irg);
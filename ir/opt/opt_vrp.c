@@ -0,0 +1,83 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Folds values and comparisons decided by value range propagation.
+ *
+ * Comparisons whose result follows from the value ranges, e.g. bounds checks
+ * of induction variables against the loop bound or overflow checks like
+ * x + 1 < x, and values whose range contains a single value are replaced by
+ * constants. The following local optimization removes the branches depending
+ * on them.
+ */
+#include "array.h"
+#include "debug.h"
+#include "ircons.h"
+#include "irgmod.h"
+#include "irgopt.h"
+#include "irgraph_t.h"
+#include "irgwalk.h"
+#include "irnode_t.h"
+#include "iropt.h"
+#include "iroptimize.h"
+#include "tv.h"
+#include "vrp.h"
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+
+/** A node together with its constant value. */
+typedef struct constant_t {
+	ir_node   *node;
+	ir_tarval *tv;
+} constant_t;
+
+static void collect_constants(ir_node *node, void *data)
+{
+	constant_t **const constants = (constant_t**)data;
+	if (is_Const(node))
+		return;
+	ir_mode *const mode = get_irn_mode(node);
+	if (!mode_is_int(mode) && mode != mode_b)
+		return;
+
+	ir_tarval *const tv = computed_value(node);
+	if (!tarval_is_constant(tv))
+		return;
+	DB((dbg, LEVEL_2, "%+F is %T\n", node, tv));
+	constant_t const constant = { node, tv };
+	ARR_APP1(constant_t, *constants, constant);
+}
+
+void opt_vrp(ir_graph *irg)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.opt.vrp");
+
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE
+	                         | IR_GRAPH_PROPERTY_CONSISTENT_OUTS
+	                         | IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+
+	set_vrp_data(irg);
+
+	/* collect first, so all values are computed on the analyzed graph */
+	constant_t *constants = NEW_ARR_F(constant_t, 0);
+	irg_walk_graph(irg, NULL, collect_constants, &constants);
+
+	size_t const n_constants = ARR_LEN(constants);
+	for (size_t i = 0; i < n_constants; ++i) {
+		ir_node *const node = constants[i].node;
+		exchange(node, new_rd_Const(get_irn_dbg_info(node), irg,
+		                            constants[i].tv));
+	}
+	DEL_ARR_F(constants);
+	free_vrp_data(irg);
+
+	if (n_constants > 0) {
+		confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_NONE);
+		local_optimize_graph(irg);
+	} else {
+		confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_ALL);
+	}
+}
@@ -0,0 +1,450 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Runs graph optimizations on several threads.
+ */
+#include <pthread.h>
+#include <string.h>
+
+#include "array.h"
+#include "bitfiddle.h"
+#include "irconsconfirm.h"
+#include "irflag_t.h"
+#include "irgopt.h"
+#include "irgraph_t.h"
+#include "irmemory.h"
+#include "iroptimize.h"
+#include "irprog_t.h"
+#include "irthread.h"
+#include "panic.h"
+#include "tv.h"
+#include "util.h"
+#include "xmalloc.h"
+
+#define NO_CRITICAL_EDGES    IR_GRAPH_PROPERTY_NO_CRITICAL_EDGES
+#define NO_BADS              IR_GRAPH_PROPERTY_NO_BADS
+#define NO_TUPLES            IR_GRAPH_PROPERTY_NO_TUPLES
+#define NO_UNREACHABLE_CODE  IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE
+#define ONE_RETURN           IR_GRAPH_PROPERTY_ONE_RETURN
+#define MANY_RETURNS         IR_GRAPH_PROPERTY_MANY_RETURNS
+#define DOMINANCE            IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
+#define POSTDOMINANCE        IR_GRAPH_PROPERTY_CONSISTENT_POSTDOMINANCE
+#define OUT_EDGES            IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
+#define OUTS                 IR_GRAPH_PROPERTY_CONSISTENT_OUTS
+#define LOOPINFO             IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO
+#define ENTITY_USAGE         IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE
+#define ALIAS_ORACLE         IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_ORACLE
+#define NONE                 IR_GRAPH_PROPERTIES_NONE
+#define CONTROL_FLOW         IR_GRAPH_PROPERTIES_CONTROL_FLOW
+
+/**
+ * A pass which can be named in a pipeline description.
+ *
+ * The required properties are the ones a graph pass always assures before it
+ * starts, the preserved properties the ones it keeps even if it changes the
+ * graph.
+ */
+typedef struct pass_description_t {
+	char const           *name;
+	opt_ptr               graph_opt;
+	void                (*prog_opt)(void);
+	ir_graph_properties_t required;
+	ir_graph_properties_t preserved;
+} pass_description_t;
+
+/** Specialization threshold of the named ipsccp pass, see proc_cloning(). */
+#define IPSCCP_THRESHOLD 20.0f
+
+static void run_ipsccp(void)
+{
+	ipsccp(IPSCCP_THRESHOLD);
+}
+
+static void points_to_andersen(void)
+{
+	compute_irp_points_to(ir_points_to_andersen);
+}
+
+static void points_to_steensgaard(void)
+{
+	compute_irp_points_to(ir_points_to_steensgaard);
+}
+
+static pass_description_t const passes[] = {
+	{ "local",           optimize_graph_df,      NULL, NONE,
+	  ONE_RETURN | MANY_RETURNS | NO_CRITICAL_EDGES },
+	{ "combo",           combo,                  NULL,
+	  NO_BADS | NO_TUPLES | OUTS | LOOPINFO, NONE },
+	{ "cf",              optimize_cf,            NULL,
+	  NO_UNREACHABLE_CODE | ONE_RETURN, NONE },
+	{ "gvn_pre",         do_gvn_pre,             NULL,
+	  NO_BADS | NO_UNREACHABLE_CODE | LOOPINFO | OUTS | NO_CRITICAL_EDGES
+	  | DOMINANCE, NONE },
+	{ "ldst",            optimize_load_store,    NULL,
+	  NO_UNREACHABLE_CODE | OUT_EDGES | NO_CRITICAL_EDGES | NO_TUPLES
+	  | DOMINANCE | POSTDOMINANCE | ENTITY_USAGE | ALIAS_ORACLE, NONE },
+	{ "dse",             opt_dse,                NULL,
+	  NO_CRITICAL_EDGES | NO_UNREACHABLE_CODE | NO_TUPLES | OUT_EDGES
+	  | DOMINANCE | ENTITY_USAGE, CONTROL_FLOW | NO_TUPLES | OUT_EDGES },
+	{ "vrp",             opt_vrp,                NULL,
+	  NO_UNREACHABLE_CODE | OUTS | DOMINANCE, NONE },
+	{ "ifconv",          opt_if_conv,            NULL,
+	  NO_CRITICAL_EDGES | NO_UNREACHABLE_CODE | NO_BADS | ONE_RETURN
+	  | DOMINANCE, NO_CRITICAL_EDGES | ONE_RETURN },
+	{ "place",           place_code,             NULL,
+	  NO_CRITICAL_EDGES | NO_UNREACHABLE_CODE | OUT_EDGES | DOMINANCE
+	  | LOOPINFO, CONTROL_FLOW },
+	{ "scalar_replace",  scalar_replacement_opt, NULL,
+	  NO_UNREACHABLE_CODE | OUTS | NO_TUPLES, NONE },
+	{ "jumpthreading",   opt_jumpthreading,      NULL,
+	  NO_UNREACHABLE_CODE | OUT_EDGES | NO_CRITICAL_EDGES, NONE },
+	{ "bool",            opt_bool,               NULL, DOMINANCE, NONE },
+	{ "conv",            conv_opt,               NULL, OUT_EDGES, NONE },
+	{ "reassoc",         optimize_reassociation, NULL,
+	  DOMINANCE | LOOPINFO | OUT_EDGES, CONTROL_FLOW },
+	{ "licm",            opt_licm,               NULL,
+	  NO_CRITICAL_EDGES | NO_UNREACHABLE_CODE | NO_BADS | NO_TUPLES
+	  | OUT_EDGES | DOMINANCE | LOOPINFO | ENTITY_USAGE | ALIAS_ORACLE,
+	  CONTROL_FLOW | NO_BADS | NO_TUPLES | OUT_EDGES | ENTITY_USAGE
+	  | MANY_RETURNS },
+	{ "frame",           opt_frame_irg,          NULL, NONE,
+	  CONTROL_FLOW | NO_BADS | NO_TUPLES | OUT_EDGES | OUTS | ENTITY_USAGE
+	  | MANY_RETURNS },
+	{ "tailrec",         opt_tail_rec_irg,       NULL,
+	  MANY_RETURNS | NO_BADS | OUTS, NONE },
+	{ "parallelize_mem", opt_parallelize_mem,    NULL,
+	  OUT_EDGES | DOMINANCE | ALIAS_ORACLE, CONTROL_FLOW | ALIAS_ORACLE },
+	{ "loop_inversion",  do_loop_inversion,      NULL,
+	  OUT_EDGES | OUTS | LOOPINFO, NONE },
+	{ "loop_unrolling",  do_loop_unrolling,      NULL,
+	  OUT_EDGES | OUTS | LOOPINFO, NONE },
+	{ "loop_peeling",    do_loop_peeling,        NULL,
+	  OUT_EDGES | OUTS | LOOPINFO, NONE },
+	{ "confirm",         construct_confirms,     NULL,
+	  OUT_EDGES | DOMINANCE | NO_BADS | NO_CRITICAL_EDGES, CONTROL_FLOW },
+	{ "remove_confirms", remove_confirms,        NULL, NONE, CONTROL_FLOW },
+	{ "dead_nodes",      dead_node_elimination,  NULL, NONE, NONE },
+	{ "compact_nodes",   dead_node_compaction,   NULL, NONE, NONE },
+	{ "unreachable",     remove_unreachable_code, NULL, NONE, NONE },
+	{ "bads",            remove_bads,            NULL, NONE, NONE },
+	{ "tuples",          remove_tuples,          NULL, NONE, NONE },
+	{ "critical_edges",  remove_critical_cf_edges, NULL, NONE, NONE },
+	{ "one_return",      normalize_one_return,   NULL, NONE, NONE },
+	{ "many_returns",    normalize_n_returns,    NULL, NONE, NONE },
+	{ "funccalls",       NULL, optimize_funccalls,       NONE, NONE },
+	{ "private_methods", NULL, mark_private_methods,     NONE, NONE },
+	{ "escape",          NULL, escape_analysis,          NONE, NONE },
+	{ "ipsccp",          NULL, run_ipsccp,               NONE, NONE },
+	{ "gc",              NULL, garbage_collect_entities, NONE, NONE },
+	{ "points_to",       NULL, points_to_andersen,       NONE, NONE },
+	{ "points_to_steensgaard", NULL, points_to_steensgaard, NONE, NONE },
+	{ "free_points_to",  NULL, free_irp_points_to,       NONE, NONE },
+};
+
+/** Names of the graph properties, indexed by their bit number. */
+static char const *const property_names[IR_GRAPH_N_PROPERTIES] = {
+	"no_critical_edges", "no_bads", "no_tuples", "no_unreachable_code",
+	"one_return", "dominance", "postdominance", "dominance_frontiers",
+	"out_edges", "outs", "loopinfo", "entity_usage", "many_returns",
+	"alias_oracle",
+};
+
+/** Statistics about the analyses used by a pipeline step. */
+typedef struct step_stats_t {
+	unsigned n_runs;        /**< number of times the step ran */
+	unsigned n_valid;       /**< required analyses which were already valid */
+	unsigned n_computed;    /**< required analyses which were computed */
+	unsigned n_invalidated; /**< analyses the step did not keep */
+	/** assure calls of the step which found an analysis valid, by property */
+	unsigned n_avoided[IR_GRAPH_N_PROPERTIES];
+} step_stats_t;
+
+/** A step of a pipeline, either a graph or a program optimization. */
+typedef struct pipeline_step_t {
+	char const           *name;      /**< NULL if not added by name */
+	opt_ptr               graph_opt;
+	prog_opt_ptr          prog_opt;
+	void                 *data;
+	ir_graph_properties_t required;  /**< assured before graph_opt runs */
+	ir_graph_properties_t preserved; /**< kept by graph_opt in any case */
+	step_stats_t          stats;
+} pipeline_step_t;
+
+struct ir_parallel_pipeline {
+	pipeline_step_t *steps; /**< ARR_F of the steps */
+};
+
+/** The graph optimizations of one stage, shared by the worker threads. */
+typedef struct stage_t {
+	pipeline_step_t       *steps;
+	size_t                 n_steps;
+	ir_graph             **graphs;     /**< graphs sorted by decreasing size */
+	size_t                 n_graphs;
+	size_t                 next_graph; /**< first graph not taken yet */
+	pthread_mutex_t        lock;       /**< protects next_graph and stats */
+	optimization_state_t   opt_state;  /**< flags of the calling thread */
+	bool                   wrap_on_overflow;
+} stage_t;
+
+ir_parallel_pipeline *new_parallel_pipeline(void)
+{
+	ir_parallel_pipeline *const res = XMALLOCZ(ir_parallel_pipeline);
+	res->steps = NEW_ARR_F(pipeline_step_t, 0);
+	return res;
+}
+
+void free_parallel_pipeline(ir_parallel_pipeline *pipeline)
+{
+	DEL_ARR_F(pipeline->steps);
+	free(pipeline);
+}
+
+static void add_step(ir_parallel_pipeline *pipeline,
+                     pipeline_step_t const *step)
+{
+	ARR_APP1(pipeline_step_t, pipeline->steps, *step);
+}
+
+void parallel_pipeline_add_graph_opt(ir_parallel_pipeline *pipeline,
+                                     opt_ptr opt)
+{
+	pipeline_step_t const step = { .graph_opt = opt };
+	add_step(pipeline, &step);
+}
+
+void parallel_pipeline_add_prog_opt(ir_parallel_pipeline *pipeline,
+                                    prog_opt_ptr opt, void *data)
+{
+	pipeline_step_t const step = { .prog_opt = opt, .data = data };
+	add_step(pipeline, &step);
+}
+
+static void run_named_prog_opt(void *data)
+{
+	pass_description_t const *const pass = (pass_description_t const*)data;
+	pass->prog_opt();
+}
+
+static pass_description_t const *find_pass(char const *name, size_t len)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(passes); ++i) {
+		if (strlen(passes[i].name) == len
+		    && strncmp(passes[i].name, name, len) == 0)
+			return &passes[i];
+	}
+	return NULL;
+}
+
+int parallel_pipeline_add_passes(ir_parallel_pipeline *pipeline,
+                                 char const *description)
+{
+	/* Check all names first, so the pipeline is unchanged on errors. */
+	for (int append = 0; append < 2; ++append) {
+		for (char const *c = description; *c != '\0';) {
+			char const *const end = c + strcspn(c, ",");
+			char const *first = c;
+			char const *last  = end;
+			while (first < last && *first == ' ')
+				++first;
+			while (last > first && last[-1] == ' ')
+				--last;
+			c = *end == ',' ? end + 1 : end;
+			if (first == last)
+				continue;
+
+			pass_description_t const *const pass
+				= find_pass(first, last - first);
+			if (pass == NULL)
+				return 0;
+			if (!append)
+				continue;
+
+			pipeline_step_t const step = {
+				.name      = pass->name,
+				.graph_opt = pass->graph_opt,
+				.prog_opt  = pass->prog_opt != NULL ? run_named_prog_opt : NULL,
+				.data      = (void*)pass,
+				.required  = pass->required,
+				.preserved = pass->preserved,
+			};
+			add_step(pipeline, &step);
+		}
+	}
+	return 1;
+}
+
+/** Adds the statistics @p stats to @p total. */
+static void add_stats(step_stats_t *total, step_stats_t const *stats)
+{
+	total->n_runs        += stats->n_runs;
+	total->n_valid       += stats->n_valid;
+	total->n_computed    += stats->n_computed;
+	total->n_invalidated += stats->n_invalidated;
+	for (size_t p = 0; p < IR_GRAPH_N_PROPERTIES; ++p)
+		total->n_avoided[p] += stats->n_avoided[p];
+}
+
+static unsigned get_n_avoided(step_stats_t const *stats)
+{
+	unsigned n_avoided = 0;
+	for (size_t p = 0; p < IR_GRAPH_N_PROPERTIES; ++p)
+		n_avoided += stats->n_avoided[p];
+	return n_avoided;
+}
+
+void parallel_pipeline_print_statistics(ir_parallel_pipeline const *pipeline,
+                                        FILE *out)
+{
+	step_stats_t total;
+	memset(&total, 0, sizeof(total));
+	fprintf(out, "%-16s %8s %8s %8s %11s %8s\n",
+	        "pass", "runs", "valid", "computed", "invalidated", "avoided");
+	for (size_t i = 0, n = ARR_LEN(pipeline->steps); i < n; ++i) {
+		pipeline_step_t const *const step  = &pipeline->steps[i];
+		step_stats_t    const *const stats = &step->stats;
+		char const *const name = step->name != NULL ? step->name
+		                       : step->graph_opt != NULL ? "<graph opt>"
+		                       : "<prog opt>";
+		fprintf(out, "%-16s %8u %8u %8u %11u %8u\n", name, stats->n_runs,
+		        stats->n_valid, stats->n_computed, stats->n_invalidated,
+		        get_n_avoided(stats));
+		add_stats(&total, stats);
+	}
+	fprintf(out, "%-16s %8u %8u %8u %11u %8u\n", "total", total.n_runs,
+	        total.n_valid, total.n_computed, total.n_invalidated,
+	        get_n_avoided(&total));
+
+	fprintf(out, "\n%-20s %8s\n", "analysis", "avoided");
+	for (size_t p = 0; p < IR_GRAPH_N_PROPERTIES; ++p) {
+		if (total.n_avoided[p] > 0)
+			fprintf(out, "%-20s %8u\n", property_names[p], total.n_avoided[p]);
+	}
+}
+
+static int cmp_graph_size(void const *a, void const *b)
+{
+	ir_graph const *const irg_a = *(ir_graph const**)a;
+	ir_graph const *const irg_b = *(ir_graph const**)b;
+	unsigned const size_a = get_irg_last_idx(irg_a);
+	unsigned const size_b = get_irg_last_idx(irg_b);
+	if (size_a != size_b)
+		return size_a < size_b ? 1 : -1;
+	return irg_a->index < irg_b->index ? -1 : irg_a->index > irg_b->index;
+}
+
+static ir_graph *take_graph(stage_t *stage)
+{
+	pthread_mutex_lock(&stage->lock);
+	size_t const i = stage->next_graph;
+	if (i < stage->n_graphs)
+		++stage->next_graph;
+	pthread_mutex_unlock(&stage->lock);
+	return i < stage->n_graphs ? stage->graphs[i] : NULL;
+}
+
+static void run_step(pipeline_step_t const *step, ir_graph *irg,
+                     step_stats_t *stats)
+{
+	ir_graph_properties_t const valid = irg->properties;
+	irg_assure_hits = stats->n_avoided;
+	assure_irg_properties(irg, step->required);
+	ir_graph_properties_t const before = irg->properties;
+	step->graph_opt(irg);
+	irg_assure_hits = NULL;
+	ir_graph_properties_t const after = irg->properties;
+	assert((before & step->preserved & ~after) == 0
+	       && "pass lost a property it declares as preserved");
+
+	++stats->n_runs;
+	stats->n_valid       += popcount(step->required & valid);
+	stats->n_computed    += popcount(step->required & ~valid);
+	stats->n_invalidated += popcount(before & ~after);
+}
+
+static void *run_worker(void *data)
+{
+	stage_t *const stage = (stage_t*)data;
+	restore_optimization_state(&stage->opt_state);
+	tarval_set_wrap_on_overflow(stage->wrap_on_overflow);
+
+	step_stats_t *const stats = XMALLOCNZ(step_stats_t, stage->n_steps);
+	for (ir_graph *irg; (irg = take_graph(stage)) != NULL;) {
+		for (size_t i = 0; i < stage->n_steps; ++i)
+			run_step(&stage->steps[i], irg, &stats[i]);
+	}
+
+	pthread_mutex_lock(&stage->lock);
+	for (size_t i = 0; i < stage->n_steps; ++i)
+		add_stats(&stage->steps[i].stats, &stats[i]);
+	pthread_mutex_unlock(&stage->lock);
+	free(stats);
+	return NULL;
+}
+
+static void run_stage(pipeline_step_t *steps, size_t n_steps,
+                      unsigned n_threads)
+{
+	stage_t stage;
+	stage.steps      = steps;
+	stage.n_steps    = n_steps;
+	stage.n_graphs   = get_irp_n_irgs();
+	stage.graphs     = XMALLOCN(ir_graph*, stage.n_graphs);
+	stage.next_graph = 0;
+	for (size_t i = 0; i < stage.n_graphs; ++i)
+		stage.graphs[i] = get_irp_irg(i);
+	QSORT(stage.graphs, stage.n_graphs, cmp_graph_size);
+	save_optimization_state(&stage.opt_state);
+	stage.wrap_on_overflow = tarval_get_wrap_on_overflow();
+	pthread_mutex_init(&stage.lock, NULL);
+
+	n_threads = MIN(n_threads, stage.n_graphs);
+	if (n_threads <= 1) {
+		run_worker(&stage);
+	} else {
+		/* The entity usage is a program wide analysis, so graph passes must not
+		 * compute it while other graphs change. Graph passes only remove uses
+		 * of entities, so the result stays conservative during the stage. */
+		assure_irp_globals_entity_usage_computed();
+		pthread_t *const threads = XMALLOCN(pthread_t, n_threads - 1);
+		ir_threads_active = true;
+		for (unsigned i = 0; i < n_threads - 1; ++i) {
+			if (pthread_create(&threads[i], NULL, run_worker, &stage) != 0)
+				panic("could not create optimization thread");
+		}
+		/* the calling thread works on graphs, too */
+		run_worker(&stage);
+		for (unsigned i = 0; i < n_threads - 1; ++i)
+			pthread_join(threads[i], NULL);
+		ir_threads_active = false;
+		free(threads);
+		set_irp_globals_entity_usage_state(ir_entity_usage_not_computed);
+	}
+
+	pthread_mutex_destroy(&stage.lock);
+	free(stage.graphs);
+}
+
+void run_parallel_pipeline(ir_parallel_pipeline *pipeline, unsigned n_threads)
+{
+	assert(!ir_threads_active && "parallel pipelines must not be nested");
+	pipeline_step_t *const steps   = pipeline->steps;
+	size_t           const n_steps = ARR_LEN(steps);
+	for (size_t i = 0; i < n_steps;) {
+		if (steps[i].prog_opt != NULL) {
+			irg_assure_hits = steps[i].stats.n_avoided;
+			steps[i].prog_opt(steps[i].data);
+			irg_assure_hits = NULL;
+			++steps[i].stats.n_runs;
+			++i;
+			continue;
+		}
+		size_t const first = i;
+		while (i < n_steps && steps[i].graph_opt != NULL)
+			++i;
+		run_stage(&steps[first], i - first, n_threads);
+	}
+}
@@ -495,10 +495,13 @@ static void eliminate_sync_edges(ir_graph *irg)
 void opt_parallelize_mem(ir_graph *irg)
 {
 	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
-	                           | IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+	                           | IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
+	                           | IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_ORACLE);
 	irg_walk_blkwise_dom_top_down(irg, NULL, walker, NULL);
 	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
 	eliminate_sync_edges(irg);
 	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
-	confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_CONTROL_FLOW);
+	/* Only memory edges changed, the addresses are the same. */
+	confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_CONTROL_FLOW
+	                       | IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_ORACLE);
 }
@@ -20,6 +20,7 @@
 #include "util.h"
 #include "xmalloc.h"
 #include <stdlib.h>
+#include <string.h>
 
 /** The name of the unknown entity. */
 #define UNKNOWN_ENTITY_NAME "unknown_entity"
@@ -268,9 +269,11 @@ void set_entity_ld_ident(ir_entity *const ent, ident *const ld_ident)
 		if (is_segment_type(owner) && !(owner->flags & tf_info)
 		 && get_entity_visibility(ent) != ir_visibility_private) {
 			pmap *globals = irp->globals;
+			ir_lock();
 			pmap_insert(globals, old_ident, NULL);
 			assert(NULL == pmap_get(ir_entity, globals, ld_ident));
 			pmap_insert(globals, ld_ident, ent);
+			ir_unlock();
 		}
 	}
 }
@@ -425,6 +428,7 @@ const char *get_initializer_kind_name(ir_initializer_kind_t ini)
 	X(IR_INITIALIZER_TARVAL);
 	X(IR_INITIALIZER_NULL);
 	X(IR_INITIALIZER_COMPOUND);
+	X(IR_INITIALIZER_BYTES);
 	}
 #undef X
 	return "BAD VALUE";
@@ -481,6 +485,34 @@ ir_initializer_t *create_initializer_compound(size_t n_entries)
 	return initializer;
 }
 
+ir_initializer_t *create_initializer_bytes(size_t size, const void *data)
+{
+	struct obstack *obst = get_irg_obstack(get_const_code_irg());
+
+	ir_initializer_t *initializer = (ir_initializer_t*)obstack_alloc(obst,
+		sizeof(ir_initializer_bytes_t) + size);
+	unsigned char *copy = (unsigned char*)(&initializer->bytes + 1);
+	memcpy(copy, data, size);
+	initializer->kind       = IR_INITIALIZER_BYTES;
+	initializer->bytes.size = size;
+	initializer->bytes.data = copy;
+
+	return initializer;
+}
+
+ir_initializer_t *create_initializer_bytes_ref(size_t size, const void *data)
+{
+	struct obstack *obst = get_irg_obstack(get_const_code_irg());
+
+	ir_initializer_t *initializer
+		= (ir_initializer_t*)OALLOC(obst, ir_initializer_bytes_t);
+	initializer->kind       = IR_INITIALIZER_BYTES;
+	initializer->bytes.size = size;
+	initializer->bytes.data = (unsigned char const*)data;
+
+	return initializer;
+}
+
 ir_node *get_initializer_const_value(const ir_initializer_t *initializer)
 {
 	assert(initializer->kind == IR_INITIALIZER_CONST);
@@ -517,6 +549,19 @@ ir_initializer_t *get_initializer_compound_value(
 	return initializer->compound.initializers[index];
 }
 
+size_t get_initializer_bytes_size(const ir_initializer_t *initializer)
+{
+	assert(initializer->kind == IR_INITIALIZER_BYTES);
+	return initializer->bytes.size;
+}
+
+const unsigned char *get_initializer_bytes_data(
+		const ir_initializer_t *initializer)
+{
+	assert(initializer->kind == IR_INITIALIZER_BYTES);
+	return initializer->bytes.data;
+}
+
 ir_initializer_kind_t get_initializer_kind(const ir_initializer_t *initializer)
 {
 	return initializer->kind;
@@ -540,6 +585,7 @@ static void check_entity_initializer(ir_entity *entity)
 		break;
 
 	case IR_INITIALIZER_NULL:
+	case IR_INITIALIZER_BYTES:
 		break;
 	}
 #else
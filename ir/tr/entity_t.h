@@ -90,12 +90,22 @@ typedef struct ir_initializer_tarval_t {
 	ir_tarval             *value;
 } ir_initializer_tarval_t ;
 
+/**
+ * An initializer containing a raw memory image.
+ */
+typedef struct ir_initializer_bytes_t {
+	ir_initializer_base_t  base;
+	size_t                 size;
+	unsigned char const   *data; /**< either behind this struct or external */
+} ir_initializer_bytes_t;
+
 union ir_initializer_t {
 	ir_initializer_kind_t      kind;
 	ir_initializer_base_t      base;
 	ir_initializer_compound_t  compound;
 	ir_initializer_const_t     consti;
 	ir_initializer_tarval_t    tarval;
+	ir_initializer_bytes_t     bytes;
 };
 
 typedef struct global_ent_attr {
@@ -194,6 +194,17 @@ static bool check_initializer(const ir_initializer_t *initializer,
 		}
 		return fine;
 	}
+	case IR_INITIALIZER_BYTES: {
+		/* arrays of unknown size (flexible array members) take any size */
+		size_t size = get_initializer_bytes_size(initializer);
+		if (size > get_type_size(type)
+		    && !(is_Array_type(type) && get_array_size(type) == 0)) {
+			report_error("bytes initializer for entity %+F is larger than its type %+F",
+			             context, type);
+			fine = false;
+		}
+		return fine;
+	}
 	}
 	report_error("invalid initializer for entity %+F", context);
 	return false;
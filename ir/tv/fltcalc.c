@@ -11,6 +11,7 @@
  */
 #include "fltcalc.h"
 
+#include "compiler.h"
 #include "panic.h"
 #include "strcalc.h"
 #include "xmalloc.h"
@@ -49,7 +50,7 @@ static unsigned value_size;
 static unsigned max_precision;
 
 /** Exact flag. */
-static bool fc_exact = true;
+static FIRM_THREAD_LOCAL bool fc_exact = true;
 
 static float_descriptor_t long_double_desc;
 
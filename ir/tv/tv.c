@@ -27,6 +27,7 @@
 #include "irmode_t.h"
 #include "irnode_t.h"
 #include "irprintf.h"
+#include "irthread.h"
 #include "panic.h"
 #include "set.h"
 #include "strcalc.h"
@@ -49,7 +50,7 @@ static unsigned sc_value_length;
 static unsigned fp_value_size;
 
 /** The integer overflow mode. */
-static bool wrap_on_overflow = true;
+static FIRM_THREAD_LOCAL bool wrap_on_overflow = true;
 
 /** Hash a tarval. */
 static unsigned hash_tv(ir_tarval const *const tv)
@@ -71,8 +72,11 @@ static int cmp_tv(const void *p1, const void *p2, size_t n)
 static ir_tarval *identify_tarval(ir_tarval const *const tv)
 {
 	unsigned hash = hash_tv(tv);
-	return set_insert(ir_tarval, tarvals, tv, sizeof(ir_tarval) + tv->length,
-	                  hash);
+	ir_lock();
+	ir_tarval *const res = set_insert(ir_tarval, tarvals, tv,
+	                                  sizeof(ir_tarval) + tv->length, hash);
+	ir_unlock();
+	return res;
 }
 
 static ir_tarval *get_fp_tarval(const fp_value *value, ir_mode *mode)
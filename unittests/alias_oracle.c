@@ -0,0 +1,71 @@
+/*
+ * Checks that the alias oracle answers repeated queries from its cache and
+ * invalidates the cache when an address is exchanged.
+ */
+#include "firm.h"
+#include <assert.h>
+#include <stdbool.h>
+
+int main(void)
+{
+	ir_init();
+
+	ir_type   *int_type = new_type_primitive(mode_Is);
+	ir_type   *mtp      = new_type_method(1, 0, false, cc_cdecl_set,
+	                                      mtp_no_property);
+	set_method_param_type(mtp, 0, int_type);
+	ir_entity *ent      = new_entity(get_glob_type(), new_id_from_str("f"),
+	                                 mtp);
+	ir_graph  *irg      = new_ir_graph(ent, 0);
+	set_current_ir_graph(irg);
+	ir_type   *frame    = get_irg_frame_type(irg);
+	ir_entity *a        = new_entity(frame, new_id_from_str("a"), int_type);
+	ir_entity *b        = new_entity(frame, new_id_from_str("b"), int_type);
+	ir_entity *c        = new_entity(frame, new_id_from_str("c"), int_type);
+
+	ir_node *block = get_irg_start_block(irg);
+	ir_node *x     = new_Proj(get_irg_args(irg), mode_Is, 0);
+	ir_node *pa    = new_r_Member(block, get_irg_frame(irg), a);
+	ir_node *pb    = new_r_Member(block, get_irg_frame(irg), b);
+	ir_node *ret   = new_Return(get_store(), 0, NULL);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+
+	assert(get_alias_relation(pa, int_type, 4, pb, int_type, 4) == ir_no_alias);
+
+	/* Miss: the first query with the oracle computes the relation. */
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_ORACLE);
+	assert(get_alias_relation(pa, int_type, 4, pb, int_type, 4) == ir_no_alias);
+
+	/* Hit: modifying the address in place is not noticed, so the memoized
+	 * relation is returned for both orders of the addresses. */
+	set_Member_entity(pb, a);
+	assert(get_alias_relation(pa, int_type, 4, pb, int_type, 4) == ir_no_alias);
+	assert(get_alias_relation(pb, int_type, 4, pa, int_type, 4) == ir_no_alias);
+
+	/* Exchanging a value that is not an address keeps the cache. */
+	ir_node *x1 = new_r_Add(block, x, new_r_Const_long(irg, mode_Is, 1));
+	exchange(x1, new_r_Add(block, x, new_r_Const_long(irg, mode_Is, 2)));
+	assert(irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_ORACLE));
+	assert(get_alias_relation(pa, int_type, 4, pb, int_type, 4) == ir_no_alias);
+
+	/* Exchanging an address invalidates it, the next query is a miss again. */
+	ir_mode *offset_mode = get_reference_offset_mode(mode_P);
+	ir_node *pc          = new_r_Member(block, get_irg_frame(irg), c);
+	ir_node *pc4         = new_r_Add(block, pc,
+	                                 new_r_Const_long(irg, offset_mode, 4));
+	exchange(pc4, new_r_Add(block, pc, new_r_Const_long(irg, offset_mode, 8)));
+	assert(irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_ORACLE));
+	assert(get_alias_relation(pa, int_type, 4, pb, int_type, 4) == ir_may_alias);
+
+	/* The recomputed relation is memoized again. */
+	set_Member_entity(pb, b);
+	assert(get_alias_relation(pb, int_type, 4, pa, int_type, 4) == ir_may_alias);
+
+	/* Without the oracle every query is computed. */
+	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_ORACLE);
+	assert(get_alias_relation(pa, int_type, 4, pb, int_type, 4) == ir_no_alias);
+
+	return 0;
+}
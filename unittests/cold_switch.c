@@ -0,0 +1,142 @@
+/*
+ * Compiles a function whose rarely executed part contains a switch with a
+ * jump table, with be-blocksched-splitcold. The code following the table must
+ * stay in the cold section, otherwise the size of the cold part spans two
+ * sections and the assembler rejects it. Skipped if binutils are missing.
+ */
+#include "firm.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Number of nested tests, each halving the frequency. */
+#define N_TESTS 12
+
+static ir_mode *mi;
+static ir_type *t_int;
+
+static ir_node *load_global(char const *name)
+{
+	ir_entity *ent = new_global_entity(get_glob_type(), new_id_from_str(name),
+	                                   t_int, ir_visibility_external,
+	                                   IR_LINKAGE_DEFAULT);
+	ir_node   *ld  = new_Load(get_store(), new_Address(ent), mi, t_int,
+	                          cons_none);
+	set_store(new_Proj(ld, mode_M, pn_Load_M));
+	return new_Proj(ld, mi, pn_Load_res);
+}
+
+static ir_node *enter(ir_node *pred)
+{
+	ir_node *block = new_immBlock();
+	add_immBlock_pred(block, pred);
+	mature_immBlock(block);
+	set_cur_block(block);
+	return block;
+}
+
+/*
+ * int f(int x)
+ * {
+ *     if (g0 && g1 && ...)
+ *         switch (x) { case 0: return 3; ... case 4: return 55; }
+ *     return 1;
+ * }
+ */
+static void build_module(void)
+{
+	mi    = mode_Is;
+	t_int = new_type_primitive(mi);
+	ir_type *mtp = new_type_method(1, 1, false, cc_cdecl_set,
+	                               mtp_no_property);
+	set_method_param_type(mtp, 0, t_int);
+	set_method_res_type(mtp, 0, t_int);
+	ir_entity *f   = new_global_entity(get_glob_type(), new_id_from_str("f"),
+	                                   mtp, ir_visibility_external,
+	                                   IR_LINKAGE_DEFAULT);
+	ir_graph  *irg = new_ir_graph(f, 1);
+	set_current_ir_graph(irg);
+	ir_node   *x   = new_Proj(get_irg_args(irg), mi, 0);
+
+	ir_node *join = new_immBlock();
+	set_value(0, new_Const_long(mi, 1));
+	for (int i = 0; i < N_TESTS; ++i) {
+		char name[16];
+		snprintf(name, sizeof(name), "g%d", i);
+		ir_node *cmp  = new_Cmp(load_global(name), new_Const_long(mi, 0),
+		                        ir_relation_less_greater);
+		ir_node *cond = new_Cond(cmp);
+		add_immBlock_pred(join, new_Proj(cond, mode_X, pn_Cond_false));
+		enter(new_Proj(cond, mode_X, pn_Cond_true));
+	}
+
+	ir_switch_table *table = ir_new_switch_table(irg, 5);
+	for (int i = 0; i < 5; ++i) {
+		ir_tarval *tv = new_tarval_from_long(i, mi);
+		ir_switch_table_set(table, i, tv, tv, i + 1);
+	}
+	ir_node *sw = new_Switch(x, 6, table);
+	for (int i = 0; i < 6; ++i) {
+		enter(new_Proj(sw, mode_X, i));
+		set_value(0, new_Const_long(mi, i * 13 + 3));
+		add_immBlock_pred(join, new_Jmp());
+	}
+	mature_immBlock(join);
+	set_cur_block(join);
+
+	ir_node *res = get_value(0, mi);
+	ir_node *ret = new_Return(get_store(), 1, &res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+	assert(irg_verify(irg));
+}
+
+static int emit(char const *file)
+{
+	ir_init();
+	if (!ir_target_set("x86_64-linux-gnu")
+	    || !ir_target_option("blocksched-splitcold=1"))
+		return 1;
+	ir_target_init();
+	build_module();
+	be_lower_for_target();
+
+	FILE *out = fopen(file, "wb");
+	if (out == NULL)
+		return 1;
+	be_main(out, "cold_switch");
+	fclose(out);
+	ir_finish();
+	return 0;
+}
+
+static void run(char const *command)
+{
+	if (system(command) != 0) {
+		fprintf(stderr, "failed: %s\n", command);
+		exit(1);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	if (argc == 2)
+		return emit(argv[1]);
+
+	if (system("as --64 --version > /dev/null 2>&1") != 0) {
+		printf("binutils not found, skipped\n");
+		return 0;
+	}
+
+	char command[1024];
+	snprintf(command, sizeof(command), "\"%s\" cold_switch.s", argv[0]);
+	run(command);
+	/* the switch is in the cold part */
+	run("grep -q 'f.cold:' cold_switch.s");
+	run("sed -n '/f.cold:/,$p' cold_switch.s | grep -q rodata");
+	run("as --64 cold_switch.s -o cold_switch.o");
+	return 0;
+}
@@ -0,0 +1,205 @@
+/*
+ * Checks that graph fingerprints are stable across runs and unrelated graphs
+ * but change with the graph, and that the compile cache reuses the code of
+ * unchanged functions only. Compilations run in child processes, as
+ * be_main() consumes the program.
+ */
+#include "firm.h"
+#include "hashptr.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CACHE_DIR "compile_cache.dir"
+#define MARKER    "# from cache"
+
+static ir_node *f_const;
+
+static ir_entity *new_function(char const *name)
+{
+	ir_type *int_type = new_type_primitive(mode_Is);
+	ir_type *mtp      = new_type_method(1, 1, false, cc_cdecl_set,
+	                                    mtp_no_property);
+	set_method_param_type(mtp, 0, int_type);
+	set_method_res_type(mtp, 0, int_type);
+	return new_global_entity(get_glob_type(), new_id_from_str(name), mtp,
+	                         ir_visibility_external, IR_LINKAGE_DEFAULT);
+}
+
+/** Builds a function returning param * mul + add. */
+static ir_graph *build_function(char const *name, long mul, long add)
+{
+	ir_graph *irg = new_ir_graph(new_function(name), 0);
+	set_current_ir_graph(irg);
+	ir_node *x   = new_Proj(get_irg_args(irg), mode_Is, 0);
+	ir_node *c   = new_Const_long(mode_Is, add);
+	ir_node *res = new_Add(new_Mul(x, new_Const_long(mode_Is, mul)), c);
+	ir_node *ret = new_Return(get_store(), 1, &res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+	f_const = c;
+	return irg;
+}
+
+/** Builds the program: f depends on @p variant, g does not. With @p extra
+ * an unrelated function is created first. */
+static ir_graph *build_program(int variant, bool extra)
+{
+	ir_init();
+	ir_target_set("x86_64-linux-gnu");
+	ir_target_init();
+	if (extra)
+		build_function("h", 11, 13);
+	build_function("g", 5, 1);
+	return build_function("f", 3, variant == 0 ? 5 : 7);
+}
+
+static void run(char const *command)
+{
+	if (system(command) != 0) {
+		fprintf(stderr, "failed: %s\n", command);
+		exit(1);
+	}
+}
+
+static char *read_file(char const *file)
+{
+	FILE *in = fopen(file, "rb");
+	assert(in != NULL);
+	fseek(in, 0, SEEK_END);
+	long size = ftell(in);
+	fseek(in, 0, SEEK_SET);
+	char *content = (char*)malloc(size + 1);
+	size_t n = fread(content, 1, size, in);
+	assert(n == (size_t)size);
+	content[size] = '\0';
+	fclose(in);
+	return content;
+}
+
+static unsigned long long child_fingerprint(char const *self, char const *args)
+{
+	char command[1024];
+	snprintf(command, sizeof(command),
+	         "\"%s\" fingerprint %s > compile_cache.txt", self, args);
+	run(command);
+	char *text = read_file("compile_cache.txt");
+	unsigned long long fingerprint = strtoull(text, NULL, 16);
+	free(text);
+	return fingerprint;
+}
+
+static char *compile(char const *self, int variant)
+{
+	char command[1024];
+	snprintf(command, sizeof(command), "\"%s\" emit %d", self, variant);
+	run(command);
+	return read_file("compile_cache.s");
+}
+
+static unsigned count_occurrences(char const *text, char const *pattern)
+{
+	unsigned n = 0;
+	for (char const *c = text; (c = strstr(c, pattern)) != NULL; ++c)
+		++n;
+	return n;
+}
+
+/** Lists the entries of the cache into compile_cache.txt and counts them. */
+static unsigned list_cache(void)
+{
+	run("ls " CACHE_DIR " > compile_cache.txt");
+	char *list = read_file("compile_cache.txt");
+	unsigned n = count_occurrences(list, ".s\n");
+	free(list);
+	return n;
+}
+
+/** Appends a marker comment to every cached function, so reused code can be
+ * recognized in the output. */
+static void mark_cache_entries(void)
+{
+	list_cache();
+	char *list = read_file("compile_cache.txt");
+	for (char *name = strtok(list, "\n"); name != NULL;
+	     name = strtok(NULL, "\n")) {
+		char path[256];
+		snprintf(path, sizeof(path), CACHE_DIR "/%s", name);
+		char *entry = read_file(path);
+		char *text  = strchr(entry, '\n') + 1;
+
+		unsigned version, n_block_nrs;
+		sscanf(entry, "libfirm-cache %u %u", &version, &n_block_nrs);
+		size_t len    = strlen(text) + strlen("\t" MARKER "\n");
+		char  *marked = (char*)malloc(len + 1);
+		snprintf(marked, len + 1, "%s\t" MARKER "\n", text);
+
+		FILE *out = fopen(path, "wb");
+		assert(out != NULL);
+		fprintf(out, "libfirm-cache %u %u %lu %u\n", version, n_block_nrs,
+		        (unsigned long)len,
+		        hash_data((unsigned char const*)marked, len));
+		fwrite(marked, 1, len, out);
+		fclose(out);
+		free(marked);
+		free(entry);
+	}
+	free(list);
+}
+
+int main(int argc, char **argv)
+{
+	if (argc >= 3 && strcmp(argv[1], "fingerprint") == 0) {
+		ir_graph *irg = build_program(atoi(argv[2]), argc > 3);
+		printf("%llx\n", ir_fingerprint_irg(irg));
+		return 0;
+	}
+	if (argc == 3 && strcmp(argv[1], "emit") == 0) {
+		build_program(atoi(argv[2]), false);
+		be_set_compile_cache(CACHE_DIR);
+		be_lower_for_target();
+		FILE *out = fopen("compile_cache.s", "w");
+		assert(out != NULL);
+		be_main(out, "compile_cache");
+		fclose(out);
+		return 0;
+	}
+
+	/* fingerprints */
+	ir_graph *irg = build_program(0, false);
+	unsigned long long const fingerprint = ir_fingerprint_irg(irg);
+	assert(fingerprint != 0);
+	assert(ir_fingerprint_irg(irg) == fingerprint);
+	assert(child_fingerprint(argv[0], "0") == fingerprint);
+	assert(child_fingerprint(argv[0], "0 extra") == fingerprint);
+	assert(child_fingerprint(argv[0], "1") != fingerprint);
+
+	exchange(f_const, new_r_Const_long(irg, mode_Is, 7));
+	unsigned long long const changed = ir_fingerprint_irg(irg);
+	assert(changed != 0 && changed != fingerprint);
+
+	/* compile cache */
+	run("rm -rf " CACHE_DIR " && mkdir " CACHE_DIR);
+	char *uncached = compile(argv[0], 0);
+	assert(count_occurrences(uncached, MARKER) == 0);
+	assert(list_cache() == 2);
+
+	/* both functions are reused */
+	mark_cache_entries();
+	char *cached = compile(argv[0], 0);
+	assert(count_occurrences(cached, MARKER) == 2);
+	assert(list_cache() == 2);
+
+	/* only g is reused, f is compiled and stored again */
+	char *changed_f = compile(argv[0], 1);
+	assert(count_occurrences(changed_f, MARKER) == 1);
+	assert(list_cache() == 3);
+
+	free(uncached);
+	free(cached);
+	free(changed_f);
+	return 0;
+}
@@ -0,0 +1,199 @@
+/*
+ * Checks that opt_dse() removes Stores to local variables which are
+ * overwritten or never read, sinks Stores read on some paths only, and keeps
+ * Stores which a call may read or whose variable escapes.
+ */
+#include "firm.h"
+#include <assert.h>
+#include <stdbool.h>
+
+static ir_type   *int_type;
+static ir_type   *pair_type;
+static ir_graph  *irg;
+static ir_entity *local;
+
+static ir_graph *new_function(char const *name, ir_type *local_type)
+{
+	ir_type   *mtp = new_type_method(1, 1, false, cc_cdecl_set,
+	                                 mtp_no_property);
+	set_method_param_type(mtp, 0, int_type);
+	set_method_res_type(mtp, 0, int_type);
+	ir_entity *ent = new_global_entity(get_glob_type(), new_id_from_str(name),
+	                                   mtp, ir_visibility_external,
+	                                   IR_LINKAGE_DEFAULT);
+	irg = new_ir_graph(ent, 0);
+	set_current_ir_graph(irg);
+	/* keep the Loads of stored values */
+	set_optimize(0);
+	local = new_entity(get_irg_frame_type(irg), new_id_from_str("local"),
+	                   local_type);
+	return irg;
+}
+
+static ir_node *local_addr(void)
+{
+	return new_Member(get_irg_frame(irg), local);
+}
+
+static ir_node *store_local(long value)
+{
+	ir_node *st = new_Store(get_store(), local_addr(),
+	                        new_Const_long(mode_Is, value), int_type,
+	                        cons_none);
+	set_store(new_Proj(st, mode_M, pn_Store_M));
+	return st;
+}
+
+static ir_node *load_local(void)
+{
+	ir_node *ld = new_Load(get_store(), local_addr(), mode_Is, int_type,
+	                       cons_none);
+	set_store(new_Proj(ld, mode_M, pn_Load_M));
+	return new_Proj(ld, mode_Is, pn_Load_res);
+}
+
+static void add_return(ir_node *res)
+{
+	ir_node *ret = new_Return(get_store(), 1, &res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+}
+
+static void finish_function(void)
+{
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+	set_optimize(1);
+}
+
+/** Calls an external function of type @p mtp with the argument @p arg. */
+static void call_external(char const *name, ir_type *mtp, ir_node *arg)
+{
+	ir_entity *callee = new_global_entity(get_glob_type(),
+	                                      new_id_from_str(name), mtp,
+	                                      ir_visibility_external,
+	                                      IR_LINKAGE_DEFAULT);
+	ir_node   *call   = new_Call(get_store(), new_Address(callee), 1, &arg,
+	                             mtp);
+	set_store(new_Proj(call, mode_M, pn_Call_M));
+}
+
+static void count_store(ir_node *node, void *env)
+{
+	if (is_Store(node))
+		++*(unsigned*)env;
+}
+
+static unsigned count_stores(void)
+{
+	unsigned n_stores = 0;
+	irg_walk_graph(irg, count_store, NULL, &n_stores);
+	return n_stores;
+}
+
+/* local = 1; local = 2; r = local; local = 3; return r; */
+static void test_dead_stores(void)
+{
+	new_function("dead", int_type);
+	store_local(1);
+	ir_node *live = store_local(2);
+	ir_node *res  = load_local();
+	store_local(3);
+	add_return(res);
+	finish_function();
+
+	opt_dse(irg);
+	assert(count_stores() == 1);
+	ir_node *load = get_Proj_pred(res);
+	assert(get_Proj_pred(get_Load_mem(load)) == live);
+	assert(get_Store_mem(live) == get_irg_initial_mem(irg));
+}
+
+/* local = 1; if (x < 0) return local; return 0; */
+static void test_partially_dead_store(void)
+{
+	new_function("partial", int_type);
+	ir_node *x     = new_Proj(get_irg_args(irg), mode_Is, 0);
+	store_local(1);
+	ir_node *cond  = new_Cond(new_Cmp(x, new_Const_long(mode_Is, 0),
+	                                  ir_relation_less));
+	ir_node *mem   = get_store();
+
+	ir_node *reads = new_immBlock();
+	add_immBlock_pred(reads, new_Proj(cond, mode_X, pn_Cond_true));
+	mature_immBlock(reads);
+	set_cur_block(reads);
+	add_return(load_local());
+
+	ir_node *skips = new_immBlock();
+	add_immBlock_pred(skips, new_Proj(cond, mode_X, pn_Cond_false));
+	mature_immBlock(skips);
+	set_cur_block(skips);
+	set_store(mem);
+	add_return(new_Const_long(mode_Is, 0));
+	finish_function();
+
+	opt_dse(irg);
+	assert(count_stores() == 1);
+	ir_node *ret   = get_Block_cfgpred(get_irg_end_block(irg), 0);
+	ir_node *load  = get_Proj_pred(get_Return_res(ret, 0));
+	ir_node *store = get_Proj_pred(get_Load_mem(load));
+	assert(is_Store(store) && get_nodes_block(store) == reads);
+}
+
+/* local.x = 1; consume(local); return 0; */
+static void test_store_read_by_call(void)
+{
+	new_function("by_value", pair_type);
+	ir_node *addr = new_Member(local_addr(), get_compound_member(pair_type, 0));
+	ir_node *st   = new_Store(get_store(), addr, new_Const_long(mode_Is, 1),
+	                          int_type, cons_none);
+	set_store(new_Proj(st, mode_M, pn_Store_M));
+
+	ir_type *mtp = new_type_method(1, 0, false, cc_cdecl_set,
+	                               mtp_no_property);
+	set_method_param_type(mtp, 0, pair_type);
+	call_external("consume", mtp, local_addr());
+	add_return(new_Const_long(mode_Is, 0));
+	finish_function();
+
+	opt_dse(irg);
+	assert(count_stores() == 1);
+}
+
+/* local = 1; escape(&local); local = 2; return 0; */
+static void test_store_to_escaping_local(void)
+{
+	new_function("escaping", int_type);
+	store_local(1);
+	ir_type *mtp = new_type_method(1, 0, false, cc_cdecl_set,
+	                               mtp_no_property);
+	set_method_param_type(mtp, 0, new_type_pointer(int_type));
+	call_external("escape", mtp, local_addr());
+	store_local(2);
+	add_return(new_Const_long(mode_Is, 0));
+	finish_function();
+
+	opt_dse(irg);
+	assert(count_stores() == 2);
+}
+
+int main(void)
+{
+	ir_init();
+
+	int_type  = new_type_primitive(mode_Is);
+	pair_type = new_type_struct(new_id_from_str("pair"));
+	ir_entity *x = new_entity(pair_type, new_id_from_str("x"), int_type);
+	ir_entity *y = new_entity(pair_type, new_id_from_str("y"), int_type);
+	set_entity_offset(x, 0);
+	set_entity_offset(y, 4);
+	set_type_size(pair_type, 8);
+	set_type_alignment(pair_type, 4);
+	set_type_state(pair_type, layout_fixed);
+
+	test_dead_stores();
+	test_partially_dead_store();
+	test_store_read_by_call();
+	test_store_to_escaping_local();
+	return 0;
+}
@@ -0,0 +1,327 @@
+/*
+ * Compiles the same module once to assembler, which is assembled with the
+ * GNU assembler, and once with the direct ELF writer (ia32 option objfile).
+ * Symbols, sections, data, relocations and the disassembly of both objects
+ * as printed by objdump and readelf must match, apart from instruction
+ * lengths, padding and code addresses. Skipped if binutils are missing.
+ * Compiling with SSE floating point, which the encoder does not support, must
+ * fail with a message.
+ */
+#include "firm.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static ir_mode *mi;
+static ir_type *t_int;
+
+static ir_entity *new_global(char const *name, ir_type *type,
+                             ir_visibility visibility)
+{
+	return new_global_entity(get_glob_type(), new_id_from_str(name), type,
+	                         visibility, IR_LINKAGE_DEFAULT);
+}
+
+static ir_initializer_t *int_init(long value)
+{
+	return create_initializer_tarval(new_tarval_from_long(value, mi));
+}
+
+static ir_type *new_int_method(size_t n_params)
+{
+	ir_type *mtp = new_type_method(n_params, 1, false, cc_cdecl_set,
+	                               mtp_no_property);
+	for (size_t i = 0; i < n_params; ++i)
+		set_method_param_type(mtp, i, t_int);
+	set_method_res_type(mtp, 0, t_int);
+	return mtp;
+}
+
+static ir_graph *begin_function(ir_entity *entity, int n_locals)
+{
+	ir_graph *irg = new_ir_graph(entity, n_locals);
+	set_current_ir_graph(irg);
+	return irg;
+}
+
+static void end_function(ir_graph *irg, ir_node *res)
+{
+	ir_node *ret = new_Return(get_store(), 1, &res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+}
+
+static ir_node *load(ir_node *ptr, ir_mode *mode, ir_type *type)
+{
+	ir_node *ld = new_Load(get_store(), ptr, mode, type, cons_none);
+	set_store(new_Proj(ld, mode_M, pn_Load_M));
+	return new_Proj(ld, mode, pn_Load_res);
+}
+
+static void store(ir_node *ptr, ir_node *value, ir_type *type)
+{
+	ir_node *st = new_Store(get_store(), ptr, value, type, cons_none);
+	set_store(new_Proj(st, mode_M, pn_Store_M));
+}
+
+static ir_node *call(ir_node *callee, ir_type *mtp, ir_node *arg)
+{
+	ir_node *c = new_Call(get_store(), callee, 1, &arg, mtp);
+	set_store(new_Proj(c, mode_M, pn_Call_M));
+	return new_Proj(new_Proj(c, mode_T, pn_Call_T_result), mi, 0);
+}
+
+static void build_module(void)
+{
+	mi    = mode_Is;
+	t_int = new_type_primitive(mi);
+	ir_type  *t_char  = new_type_primitive(mode_Bs);
+	ir_type  *t_short = new_type_primitive(mode_Hs);
+	ir_type  *t_dbl   = new_type_primitive(mode_D);
+	ir_type  *t_ptr   = new_type_pointer(t_int);
+	ir_graph *cirg    = get_const_code_irg();
+
+	ir_entity *gi = new_global("gi", t_int, ir_visibility_external);
+	set_entity_initializer(gi, int_init(5));
+	ir_entity *sl = new_global("sl", t_int, ir_visibility_local);
+	set_entity_initializer(sl, int_init(7));
+	ir_entity *gz = new_global("gz", t_int, ir_visibility_external);
+	set_entity_initializer(gz, get_initializer_null());
+	ir_entity *gc = new_global("gc", t_int, ir_visibility_external);
+	set_entity_initializer(gc, get_initializer_null());
+	add_entity_linkage(gc, IR_LINKAGE_MERGE);
+	ir_entity *ext = new_global("ext", t_int, ir_visibility_external);
+	ir_entity *hs  = new_global("hs", t_short, ir_visibility_local);
+	set_entity_initializer(hs, create_initializer_tarval(
+		new_tarval_from_long(-3, mode_Hs)));
+
+	ir_entity        *arr  = new_global("arr", new_type_array(t_int, 4),
+	                                    ir_visibility_external);
+	ir_initializer_t *ainit = create_initializer_compound(4);
+	for (int i = 0; i < 4; ++i)
+		set_initializer_compound_value(ainit, i, int_init(i * 10 + 1));
+	set_entity_initializer(arr, ainit);
+
+	char const       *hello = "hello";
+	ir_entity        *str   = new_global("str", new_type_array(t_char, 6),
+	                                     ir_visibility_private);
+	ir_initializer_t *sinit = create_initializer_compound(6);
+	for (int i = 0; i < 6; ++i) {
+		set_initializer_compound_value(sinit, i, create_initializer_tarval(
+			new_tarval_from_long(hello[i], mode_Bs)));
+	}
+	set_entity_initializer(str, sinit);
+
+	ir_entity *gp = new_global("gp", t_ptr, ir_visibility_external);
+	set_entity_initializer(gp, create_initializer_const(
+		new_r_Add(get_irg_start_block(cirg), new_r_Address(cirg, arr),
+		          new_r_Const_long(cirg, mode_Is, 8))));
+	ir_entity *sp = new_global("sp", t_ptr, ir_visibility_local);
+	set_entity_initializer(sp, create_initializer_const(
+		new_r_Address(cirg, str)));
+	ir_entity *dv = new_global("dv", t_dbl, ir_visibility_external);
+	set_entity_initializer(dv, create_initializer_tarval(
+		new_tarval_from_double(2.5, mode_D)));
+
+	ir_type   *mtp1 = new_int_method(1);
+	ir_entity *sq   = new_global("sq", mtp1, ir_visibility_local);
+	ir_entity *ef   = new_global("ef", mtp1, ir_visibility_external);
+	ir_entity *sw   = new_global("sw", mtp1, ir_visibility_external);
+	ir_entity *test = new_global("test", new_int_method(0),
+	                             ir_visibility_external);
+
+	ir_entity *fp = new_global("fp", new_type_pointer(mtp1),
+	                           ir_visibility_local);
+	set_entity_initializer(fp, create_initializer_const(
+		new_r_Address(cirg, ef)));
+
+	/* sq(x) = x * x + sl */
+	ir_graph *irg = begin_function(sq, 0);
+	ir_node  *x   = new_Proj(get_irg_args(irg), mi, 0);
+	end_function(irg, new_Add(new_Mul(x, x), load(new_Address(sl), mi, t_int)));
+
+	/* ef(x) = sq(x + 1) + gi */
+	irg = begin_function(ef, 0);
+	x   = new_Proj(get_irg_args(irg), mi, 0);
+	ir_node *sq_res = call(new_Address(sq), mtp1,
+	                       new_Add(x, new_Const_long(mi, 1)));
+	end_function(irg, new_Add(sq_res, load(new_Address(gi), mi, t_int)));
+
+	/* sw(x) = switch (x) with a jump table */
+	irg = begin_function(sw, 1);
+	x   = new_Proj(get_irg_args(irg), mi, 0);
+	ir_switch_table *table = ir_new_switch_table(irg, 5);
+	for (int i = 0; i < 5; ++i) {
+		ir_tarval *tv = new_tarval_from_long(i, mi);
+		ir_switch_table_set(table, i, tv, tv, i + 1);
+	}
+	ir_node *sw_node = new_Switch(x, 6, table);
+	ir_node *join    = new_immBlock();
+	for (int i = 0; i < 6; ++i) {
+		ir_node *block = new_immBlock();
+		add_immBlock_pred(block, new_Proj(sw_node, mode_X, i));
+		mature_immBlock(block);
+		set_cur_block(block);
+		set_value(0, new_Const_long(mi, i * 13 + 3));
+		add_immBlock_pred(join, new_Jmp());
+	}
+	mature_immBlock(join);
+	set_cur_block(join);
+	end_function(irg, get_value(0, mi));
+
+	irg = begin_function(test, 0);
+	ir_node *sum = load(new_Address(gi), mi, t_int);
+	sum = new_Add(sum, load(new_Address(sl), mi, t_int));
+	store(new_Address(gz), new_Const_long(mi, 9), t_int);
+	store(new_Address(gc), new_Const_long(mi, 4), t_int);
+	sum = new_Add(sum, load(new_Address(gz), mi, t_int));
+	sum = new_Add(sum, load(new_Address(gc), mi, t_int));
+	sum = new_Add(sum, load(new_Address(ext), mi, t_int));
+	sum = new_Add(sum, load(load(new_Address(gp), mode_P, t_ptr), mi, t_int));
+	ir_node *sp1 = new_Add(load(new_Address(sp), mode_P, t_ptr),
+	                       new_Const_long(mode_Is, 1));
+	sum = new_Add(sum, new_Conv(load(sp1, mode_Bs, t_char), mi));
+	sum = new_Add(sum, new_Conv(load(new_Address(hs), mode_Hs, t_short), mi));
+	ir_node *callee = load(new_Address(fp), mode_P, get_entity_type(fp));
+	sum = new_Add(sum, call(callee, mtp1, new_Const_long(mi, 3)));
+	for (int i = 0; i < 7; ++i) {
+		ir_node *sw_res = call(new_Address(sw), mtp1, new_Const_long(mi, i));
+		sum = new_Add(new_Mul(sum, new_Const_long(mi, 3)), sw_res);
+	}
+	/* x87 conversion: control word handling with 16 bit loads and
+	 * operations on 8 bit high registers */
+	sum = new_Add(sum, new_Conv(load(new_Address(dv), mode_D, t_dbl), mi));
+	end_function(irg, sum);
+
+	for (size_t i = 0, n = get_irp_n_irgs(); i < n; ++i) {
+		ir_graph *g = get_irp_irg(i);
+		assert(irg_verify(g));
+		optimize_graph_df(g);
+	}
+}
+
+static int emit(char const *mode, char const *file)
+{
+	ir_init();
+	if (!ir_target_set("i686-linux-gnu"))
+		return 1;
+	if (strcmp(mode, "asm") != 0 && !ir_target_option("objfile"))
+		return 1;
+	if (strcmp(mode, "sse") == 0
+	    && (!ir_target_option("arch=pentium4")
+	        || !ir_target_option("fpmath=sse")))
+		return 1;
+	ir_target_init();
+	build_module();
+	be_lower_for_target();
+
+	FILE *out = fopen(file, "wb");
+	if (out == NULL)
+		return 1;
+	be_main(out, "elf_object");
+	fclose(out);
+	ir_finish();
+	return 0;
+}
+
+static void run(char const *command)
+{
+	if (system(command) != 0) {
+		fprintf(stderr, "failed: %s\n", command);
+		exit(1);
+	}
+}
+
+static char *read_file(char const *file)
+{
+	FILE *in = fopen(file, "rb");
+	assert(in != NULL);
+	fseek(in, 0, SEEK_END);
+	long size = ftell(in);
+	fseek(in, 0, SEEK_SET);
+	char *content = (char*)malloc(size + 1);
+	size_t n = fread(content, 1, size, in);
+	assert(n == (size_t)size);
+	content[size] = '\0';
+	fclose(in);
+	return content;
+}
+
+/** objdump and readelf views of an object which must agree between the
+ * assembler and the ELF writer. %s is replaced by the object file. */
+static char const *const views[] = {
+	/* file header */
+	"readelf -h %s | grep -E 'Class|Data|Type|Machine'",
+	/* section names, sizes except for code, alignment and flags */
+	"objdump -h %s | awk '/^ +[0-9]+ / { name = $2; size = $2 == \".text\""
+	" ? \"-\" : $3; align = $7; getline; print name, size, align, $0 }'"
+	" | sort",
+	/* symbol binding, type, section and name; the assembler only emits
+	 * section symbols which are referenced */
+	"objdump -t %s | awk '/^[0-9a-f]+ / && substr($0, 10, 7) !~ /d/"
+	" { print substr($0, 10, 7), $(NF-2), $NF }' | sort",
+	/* initialized data */
+	"objdump -s -j .data %s | grep '^ '",
+	/* relocation types and symbols per section, in address order */
+	"objdump -r -j .text %s | awk '/^[0-9a-f]+ / { print $2, $3 }'",
+	"objdump -r -j .data %s | awk '/^[0-9a-f]+ / { print $2, $3 }'",
+	"objdump -r -j .rodata %s | awk '/^[0-9a-f]+ / { print $2, $3 }'",
+	/* instructions without addresses and padding */
+	"objdump -d --no-show-raw-insn %s | awk -F '\\t' 'NF >= 2 { print $2 }'"
+	" | sed -E 's/[0-9a-f]+ <[^>]*>//; s/ +$//'"
+	" | grep -Ev '^(nop|xchg +%%ax,%%ax|lea +0x0\\(%%esi(,%%eiz,1)?\\),%%esi"
+	"|data16|cs nop)'",
+};
+
+int main(int argc, char **argv)
+{
+	if (argc == 3)
+		return emit(argv[1], argv[2]);
+
+	char command[1024];
+	snprintf(command, sizeof(command),
+	         "\"%s\" sse elf_object.sse.o 2> elf_object.sse.txt", argv[0]);
+	if (system(command) == 0) {
+		fprintf(stderr, "SSE configuration not rejected\n");
+		return 1;
+	}
+	run("grep -q 'SSE floating point not supported' elf_object.sse.txt");
+
+	if (system("as --32 --version > /dev/null 2>&1") != 0
+	    || system("objdump --version > /dev/null 2>&1") != 0
+	    || system("readelf --version > /dev/null 2>&1") != 0) {
+		printf("binutils not found, skipped\n");
+		return 0;
+	}
+
+	snprintf(command, sizeof(command), "\"%s\" asm elf_object.s", argv[0]);
+	run(command);
+	run("as --32 elf_object.s -o elf_object.as.o");
+	snprintf(command, sizeof(command), "\"%s\" obj elf_object.o", argv[0]);
+	run(command);
+
+	int failed = 0;
+	for (size_t i = 0; i < sizeof(views) / sizeof(views[0]); ++i) {
+		char view[768];
+		snprintf(view, sizeof(view), views[i], "elf_object.as.o");
+		snprintf(command, sizeof(command), "%s > elf_object.as.txt", view);
+		run(command);
+		snprintf(view, sizeof(view), views[i], "elf_object.o");
+		snprintf(command, sizeof(command), "%s > elf_object.txt", view);
+		run(command);
+
+		char *expected = read_file("elf_object.as.txt");
+		char *actual   = read_file("elf_object.txt");
+		if (expected[0] == '\0' || strcmp(expected, actual) != 0) {
+			fprintf(stderr, "mismatch in: %s\n", views[i]);
+			fprintf(stderr, "assembler:\n%s\nwriter:\n%s\n", expected, actual);
+			failed = 1;
+		}
+		free(expected);
+		free(actual);
+	}
+	return failed;
+}
@@ -0,0 +1,184 @@
+/*
+ * Checks that escape_analysis() moves objects to the stack frame whose address
+ * does not escape, also if it is passed to a method of the program, and keeps
+ * objects which escape directly or through a chain of callees.
+ */
+#include "firm.h"
+#include <assert.h>
+#include <stdbool.h>
+
+static ir_type   *int_type;
+static ir_type   *ptr_type;
+static ir_type   *ptr_param_type;
+static ir_entity *malloc_ent;
+static ir_entity *free_ent;
+static ir_entity *leaked;
+
+static ir_entity *new_function(char const *name, ir_type *mtp,
+                               ir_visibility visibility)
+{
+	return new_global_entity(get_glob_type(), new_id_from_str(name), mtp,
+	                         visibility, IR_LINKAGE_DEFAULT);
+}
+
+static ir_graph *begin_function(ir_entity *ent)
+{
+	ir_graph *irg = new_ir_graph(ent, 0);
+	set_current_ir_graph(irg);
+	return irg;
+}
+
+static void finish_function(ir_graph *irg, ir_node *res)
+{
+	ir_node *ret = new_Return(get_store(), 1, &res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+}
+
+static ir_node *param(ir_graph *irg)
+{
+	return new_Proj(get_irg_args(irg), mode_P, 0);
+}
+
+static ir_node *call(ir_entity *callee, ir_node *arg)
+{
+	ir_type *mtp  = get_entity_type(callee);
+	ir_node *node = new_Call(get_store(), new_Address(callee), 1, &arg, mtp);
+	set_store(new_Proj(node, mode_M, pn_Call_M));
+	if (get_method_n_ress(mtp) == 0)
+		return NULL;
+	ir_node *res = new_Proj(node, mode_T, pn_Call_T_result);
+	return new_Proj(res, get_type_mode(get_method_res_type(mtp, 0)), 0);
+}
+
+static ir_node *new_object(bool use_malloc)
+{
+	ir_node *size = new_Const_long(mode_Iu, 4);
+	if (use_malloc)
+		return call(malloc_ent, size);
+	ir_node *alloc = new_Alloc(get_store(), size, 4);
+	set_store(new_Proj(alloc, mode_M, pn_Alloc_M));
+	return new_Proj(alloc, mode_P, pn_Alloc_res);
+}
+
+static void store(ir_node *addr, ir_node *value, ir_type *type)
+{
+	ir_node *st = new_Store(get_store(), addr, value, type, cons_none);
+	set_store(new_Proj(st, mode_M, pn_Store_M));
+}
+
+/** int *keep(int *p) { *p = 1; return 0; } */
+static void build_keep(ir_entity *keep)
+{
+	ir_graph *irg = begin_function(keep);
+	store(param(irg), new_Const_long(mode_Is, 1), int_type);
+	finish_function(irg, new_Const(get_mode_null(mode_P)));
+}
+
+/** int *leak(int *p) { leaked = p; return 0; } */
+static void build_leak(ir_entity *leak)
+{
+	ir_graph *irg = begin_function(leak);
+	store(new_Address(leaked), param(irg), ptr_type);
+	finish_function(irg, new_Const(get_mode_null(mode_P)));
+}
+
+/** int *pass(int *p) { return leak(p); } */
+static void build_pass(ir_entity *pass, ir_entity *leak)
+{
+	ir_graph *irg = begin_function(pass);
+	finish_function(irg, call(leak, param(irg)));
+}
+
+/**
+ * int *name(int *unused)
+ * { int *o = new object; callee(o); free(o); return 0; }
+ */
+static ir_graph *build_user(char const *name, ir_entity *callee,
+                            bool use_malloc)
+{
+	ir_entity *ent = new_function(name, ptr_param_type,
+	                              ir_visibility_external);
+	ir_graph  *irg = begin_function(ent);
+	ir_node   *obj = new_object(use_malloc);
+	call(callee, obj);
+	if (use_malloc)
+		call(free_ent, obj);
+	finish_function(irg, new_Const(get_mode_null(mode_P)));
+	return irg;
+}
+
+static void find_allocation(ir_node *node, void *env)
+{
+	if (is_Alloc(node) || (is_Call(node) && (get_Call_callee(node) == malloc_ent
+	                                      || get_Call_callee(node) == free_ent)))
+		*(bool*)env = true;
+}
+
+/** Returns true if @p irg still allocates (or frees) its object. */
+static bool has_allocation(ir_graph *irg)
+{
+	bool found = false;
+	irg_walk_graph(irg, find_allocation, NULL, &found);
+	return found;
+}
+
+static bool has_frame_entity(ir_graph *irg)
+{
+	return get_compound_n_members(get_irg_frame_type(irg)) > 0;
+}
+
+int main(void)
+{
+	ir_init();
+	ir_target_set("x86_64-linux-gnu");
+	ir_target_init();
+
+	int_type       = new_type_primitive(mode_Is);
+	ptr_type       = new_type_pointer(int_type);
+	ptr_param_type = new_type_method(1, 1, false, cc_cdecl_set,
+	                                 mtp_no_property);
+	set_method_param_type(ptr_param_type, 0, ptr_type);
+	set_method_res_type(ptr_param_type, 0, ptr_type);
+	leaked = new_global_entity(get_glob_type(), new_id_from_str("leaked"),
+	                           ptr_type, ir_visibility_external,
+	                           IR_LINKAGE_DEFAULT);
+
+	ir_type *malloc_type = new_type_method(1, 1, false, cc_cdecl_set,
+	                                       mtp_property_malloc);
+	set_method_param_type(malloc_type, 0, new_type_primitive(mode_Iu));
+	set_method_res_type(malloc_type, 0, new_type_pointer(int_type));
+	malloc_ent = new_function("malloc", malloc_type, ir_visibility_external);
+	add_entity_additional_properties(malloc_ent, mtp_property_malloc);
+	ir_type *free_type = new_type_method(1, 0, false, cc_cdecl_set,
+	                                     mtp_no_property);
+	set_method_param_type(free_type, 0, ptr_type);
+	free_ent = new_function("free", free_type, ir_visibility_external);
+
+	ir_entity *keep = new_function("keep", ptr_param_type, ir_visibility_local);
+	ir_entity *leak = new_function("leak", ptr_param_type, ir_visibility_local);
+	ir_entity *pass = new_function("pass", ptr_param_type, ir_visibility_local);
+	/* pass() precedes leak(), so it is first evaluated with the optimistic
+	 * summary of leak() and must be evaluated again. */
+	build_keep(keep);
+	build_pass(pass, leak);
+	build_leak(leak);
+
+	ir_graph *kept_malloc  = build_user("kept_malloc", keep, true);
+	ir_graph *kept_alloc   = build_user("kept_alloc", keep, false);
+	ir_graph *leaks_malloc = build_user("leaks_malloc", leak, true);
+	ir_graph *passes_alloc = build_user("passes_alloc", pass, false);
+
+	escape_analysis();
+
+	/* keep() does not let its parameter escape: the objects live on the
+	 * frame, the free() is removed. */
+	assert(!has_allocation(kept_malloc) && has_frame_entity(kept_malloc));
+	assert(!has_allocation(kept_alloc) && has_frame_entity(kept_alloc));
+	/* The address escapes in leak() and through pass() into leak(). */
+	assert(has_allocation(leaks_malloc) && !has_frame_entity(leaks_malloc));
+	assert(has_allocation(passes_alloc) && !has_frame_entity(passes_alloc));
+
+	return 0;
+}
@@ -0,0 +1,160 @@
+/*
+ * Compiles three functions with be-funcorder-algo=c3: caller() calls leaf()
+ * in a loop, other() is defined between them and calls nothing. The C3
+ * layout must place leaf() right after its caller and move other() behind
+ * them, while the default keeps the source order.
+ */
+#include "firm.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static ir_mode *mi;
+static ir_type *t_int;
+static ir_type *t_method;
+
+static ir_entity *new_function(char const *name)
+{
+	return new_global_entity(get_glob_type(), new_id_from_str(name), t_method,
+	                         ir_visibility_external, IR_LINKAGE_DEFAULT);
+}
+
+static void finish_function(ir_graph *irg, ir_node *res)
+{
+	ir_node *ret = new_Return(get_store(), 1, &res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+}
+
+/* int name(int x) { return x * 3 + 1; } */
+static void build_simple(ir_entity *ent)
+{
+	ir_graph *irg = new_ir_graph(ent, 0);
+	set_current_ir_graph(irg);
+	ir_node  *x   = new_Proj(get_irg_args(irg), mi, 0);
+	ir_node  *res = new_Add(new_Mul(x, new_Const_long(mi, 3)),
+	                        new_Const_long(mi, 1));
+	finish_function(irg, res);
+}
+
+/* int caller(int n) { int s = 0; for (int i = 0; i != n; ++i) s += leaf(i);
+ *                     return s; } */
+static void build_caller(ir_entity *ent, ir_entity *leaf)
+{
+	ir_graph *irg = new_ir_graph(ent, 2);
+	set_current_ir_graph(irg);
+	ir_node  *n   = new_Proj(get_irg_args(irg), mi, 0);
+	set_value(0, new_Const_long(mi, 0));
+	set_value(1, new_Const_long(mi, 0));
+
+	ir_node *header = new_immBlock();
+	add_immBlock_pred(header, new_Jmp());
+	set_cur_block(header);
+	ir_node *cond = new_Cond(new_Cmp(get_value(1, mi), n,
+	                                 ir_relation_less_greater));
+
+	ir_node *body = new_immBlock();
+	add_immBlock_pred(body, new_Proj(cond, mode_X, pn_Cond_true));
+	mature_immBlock(body);
+	set_cur_block(body);
+	ir_node *i    = get_value(1, mi);
+	ir_node *call = new_Call(get_store(), new_Address(leaf), 1, &i, t_method);
+	set_store(new_Proj(call, mode_M, pn_Call_M));
+	ir_node *res  = new_Proj(new_Proj(call, mode_T, pn_Call_T_result), mi, 0);
+	set_value(0, new_Add(get_value(0, mi), res));
+	set_value(1, new_Add(i, new_Const_long(mi, 1)));
+	add_immBlock_pred(header, new_Jmp());
+	mature_immBlock(header);
+
+	ir_node *exit = new_immBlock();
+	add_immBlock_pred(exit, new_Proj(cond, mode_X, pn_Cond_false));
+	mature_immBlock(exit);
+	set_cur_block(exit);
+	finish_function(irg, get_value(0, mi));
+}
+
+static int emit(char const *algo, char const *file)
+{
+	ir_init();
+	char option[64];
+	snprintf(option, sizeof(option), "funcorder-algo=%s", algo);
+	if (!ir_target_set("x86_64-linux-gnu") || !ir_target_option(option))
+		return 1;
+	ir_target_init();
+	mi       = mode_Is;
+	t_int    = new_type_primitive(mi);
+	t_method = new_type_method(1, 1, false, cc_cdecl_set, mtp_no_property);
+	set_method_param_type(t_method, 0, t_int);
+	set_method_res_type(t_method, 0, t_int);
+
+	ir_entity *caller = new_function("caller");
+	ir_entity *other  = new_function("other");
+	ir_entity *leaf   = new_function("leaf");
+	build_caller(caller, leaf);
+	build_simple(other);
+	build_simple(leaf);
+	be_lower_for_target();
+
+	FILE *out = fopen(file, "wb");
+	if (out == NULL)
+		return 1;
+	be_main(out, "funcorder");
+	fclose(out);
+	ir_finish();
+	return 0;
+}
+
+static char *read_file(char const *file)
+{
+	FILE *in = fopen(file, "rb");
+	assert(in != NULL);
+	fseek(in, 0, SEEK_END);
+	long size = ftell(in);
+	fseek(in, 0, SEEK_SET);
+	char *content = (char*)malloc(size + 1);
+	size_t n = fread(content, 1, size, in);
+	assert(n == (size_t)size);
+	content[size] = '\0';
+	fclose(in);
+	return content;
+}
+
+/** Returns the position of the label of @p name in @p text. */
+static long find_label(char const *text, char const *name)
+{
+	char label[32];
+	snprintf(label, sizeof(label), "\n%s:", name);
+	char const *pos = strstr(text, label);
+	assert(pos != NULL);
+	return pos - text;
+}
+
+/** Compiles the functions with @p algo and checks their order. */
+static void check_order(char const *self, char const *algo,
+                        char const *first, char const *second,
+                        char const *third)
+{
+	char command[1024];
+	snprintf(command, sizeof(command), "\"%s\" %s funcorder.s", self, algo);
+	if (system(command) != 0) {
+		fprintf(stderr, "failed: %s\n", command);
+		exit(1);
+	}
+	char *text = read_file("funcorder.s");
+	assert(find_label(text, first) < find_label(text, second));
+	assert(find_label(text, second) < find_label(text, third));
+	free(text);
+}
+
+int main(int argc, char **argv)
+{
+	if (argc == 3)
+		return emit(argv[1], argv[2]);
+
+	check_order(argv[0], "source", "caller", "other", "leaf");
+	check_order(argv[0], "c3", "caller", "leaf", "other");
+	return 0;
+}
@@ -0,0 +1,111 @@
+/*
+ * Checks that do_gvn_pre() removes a partially redundant Load whose memory
+ * differs from the earlier Load only by Stores to other addresses: the Loads
+ * get the same memory version, the Load after the join is replaced by a Phi
+ * and a new Load is inserted on the path which had none.
+ */
+#include "firm.h"
+#include <assert.h>
+#include <stdbool.h>
+
+static ir_type   *int_type;
+static ir_entity *a;
+static ir_entity *b;
+
+static ir_entity *new_global(char const *name)
+{
+	return new_global_entity(get_glob_type(), new_id_from_str(name), int_type,
+	                         ir_visibility_external, IR_LINKAGE_DEFAULT);
+}
+
+static ir_node *load(ir_entity *ent)
+{
+	ir_node *ld = new_Load(get_store(), new_Address(ent), mode_Is, int_type,
+	                       cons_none);
+	set_store(new_Proj(ld, mode_M, pn_Load_M));
+	return new_Proj(ld, mode_Is, pn_Load_res);
+}
+
+static void store(ir_entity *ent, ir_node *value)
+{
+	ir_node *st = new_Store(get_store(), new_Address(ent), value, int_type,
+	                        cons_none);
+	set_store(new_Proj(st, mode_M, pn_Store_M));
+}
+
+static ir_node *enter(ir_node *pred)
+{
+	ir_node *block = new_immBlock();
+	add_immBlock_pred(block, pred);
+	mature_immBlock(block);
+	set_cur_block(block);
+	return block;
+}
+
+static void count_load(ir_node *node, void *env)
+{
+	if (is_Load(node))
+		++*(unsigned*)env;
+}
+
+/*
+ * int f(int c)
+ * {
+ *     if (c) b = a; else b = 2;
+ *     return a;
+ * }
+ */
+int main(void)
+{
+	ir_init();
+	int_type = new_type_primitive(mode_Is);
+	a        = new_global("a");
+	b        = new_global("b");
+
+	ir_type   *mtp = new_type_method(1, 1, false, cc_cdecl_set,
+	                                 mtp_no_property);
+	set_method_param_type(mtp, 0, int_type);
+	set_method_res_type(mtp, 0, int_type);
+	ir_entity *f   = new_global_entity(get_glob_type(), new_id_from_str("f"),
+	                                   mtp, ir_visibility_external,
+	                                   IR_LINKAGE_DEFAULT);
+	ir_graph  *irg = new_ir_graph(f, 1);
+	set_current_ir_graph(irg);
+
+	ir_node *c    = new_Proj(get_irg_args(irg), mode_Is, 0);
+	ir_node *cond = new_Cond(new_Cmp(c, new_Const_long(mode_Is, 0),
+	                                 ir_relation_less_greater));
+	ir_node *join = new_immBlock();
+
+	enter(new_Proj(cond, mode_X, pn_Cond_true));
+	store(b, load(a));
+	add_immBlock_pred(join, new_Jmp());
+
+	enter(new_Proj(cond, mode_X, pn_Cond_false));
+	store(b, new_Const_long(mode_Is, 2));
+	add_immBlock_pred(join, new_Jmp());
+
+	mature_immBlock(join);
+	set_cur_block(join);
+	ir_node *res = load(a);
+	ir_node *ret = new_Return(get_store(), 1, &res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+	assert(irg_verify(irg));
+
+	do_gvn_pre(irg);
+	assert(irg_verify(irg));
+
+	/* the Load after the join became a Phi of the Loads in both branches */
+	ir_node *phi = get_Return_res(ret, 0);
+	assert(is_Phi(phi) && get_nodes_block(phi) == join);
+	for (int i = 0; i < 2; ++i) {
+		ir_node *pred = get_Phi_pred(phi, i);
+		assert(is_Proj(pred) && is_Load(get_Proj_pred(pred)));
+	}
+	unsigned n_loads = 0;
+	irg_walk_graph(irg, count_load, NULL, &n_loads);
+	assert(n_loads == 2);
+	return 0;
+}
@@ -0,0 +1,105 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/* A pointer set using group probing with a weak hash function, so groups
+ * overflow and probe sequences get long. */
+#define HashSet          test_set_t
+#define HashSetIterator  test_set_iterator_t
+#define ValueType        void*
+#define DO_REHASH
+#define GROUP_PROBING
+#include "hashset.h"
+
+typedef struct test_set_t          test_set_t;
+typedef struct test_set_iterator_t test_set_iterator_t;
+
+#define ID_HASH
+#define NullValue                 NULL
+#define Hash(self,key)            ((unsigned)((uintptr_t)(key) % 61))
+#define KeysEqual(self,key1,key2) (key1) == (key2)
+
+#define hashset_init            test_set_init
+#define hashset_init_size       test_set_init_size
+#define hashset_destroy         test_set_destroy
+#define hashset_insert          test_set_insert
+#define hashset_remove          test_set_remove
+#define hashset_find            test_set_contains
+#define hashset_size            test_set_size
+#define hashset_iterator_init   test_set_iterator_init
+#define hashset_iterator_next   test_set_iterator_next
+#define hashset_remove_iterator test_set_remove_iterator
+#include "hashset.c.h"
+
+#define N_KEYS 2000
+
+static char keys[N_KEYS];
+static bool in_set[N_KEYS];
+
+static void check_set(test_set_t *set)
+{
+	size_t n_elements = 0;
+	for (size_t i = 0; i < N_KEYS; ++i) {
+		assert(test_set_contains(set, &keys[i]) == in_set[i]);
+		n_elements += in_set[i];
+	}
+	assert(test_set_size(set) == n_elements);
+
+	size_t n_iterated = 0;
+	test_set_iterator_t iter;
+	test_set_iterator_init(&iter, set);
+	for (char *key; (key = (char*)test_set_iterator_next(&iter)) != NULL;) {
+		assert(in_set[key - keys]);
+		++n_iterated;
+	}
+	assert(n_iterated == n_elements);
+}
+
+int main(void)
+{
+	test_set_t set;
+	test_set_init(&set);
+	check_set(&set);
+
+	srand(42);
+	for (int round = 0; round < 20; ++round) {
+		for (int i = 0; i < 1000; ++i) {
+			size_t const k = (size_t)rand() % N_KEYS;
+			if (rand() % 3 == 0) {
+				test_set_remove(&set, &keys[k]);
+				in_set[k] = false;
+			} else {
+				bool const inserted = test_set_insert(&set, &keys[k]);
+				assert(inserted == !in_set[k]);
+				in_set[k] = true;
+			}
+		}
+		check_set(&set);
+	}
+
+	/* remove every second element while iterating */
+	bool remove = false;
+	test_set_iterator_t iter;
+	test_set_iterator_init(&iter, &set);
+	for (char *key; (key = (char*)test_set_iterator_next(&iter)) != NULL;) {
+		if (remove) {
+			test_set_remove_iterator(&set, &iter);
+			in_set[key - keys] = false;
+		}
+		remove = !remove;
+	}
+	check_set(&set);
+
+	/* shrink */
+	for (size_t i = 0; i < N_KEYS; ++i) {
+		test_set_remove(&set, &keys[i]);
+		in_set[i] = false;
+	}
+	test_set_insert(&set, &keys[0]);
+	in_set[0] = true;
+	check_set(&set);
+
+	test_set_destroy(&set);
+	return 0;
+}
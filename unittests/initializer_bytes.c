@@ -0,0 +1,133 @@
+/*
+ * Checks IR_INITIALIZER_BYTES: create_initializer_bytes() copies the image,
+ * create_initializer_bytes_ref() references it, and the accessors return both
+ * unchanged. The gas emitter writes an image as .quad and .byte directives
+ * padded to the size of the entity, at the top level and inside a compound
+ * initializer.
+ */
+#include "firm.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static unsigned char const image[] = {
+	0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b
+};
+
+static void test_accessors(void)
+{
+	unsigned char data[sizeof(image)];
+	memcpy(data, image, sizeof(image));
+
+	ir_initializer_t *copy = create_initializer_bytes(sizeof(data), data);
+	ir_initializer_t *ref  = create_initializer_bytes_ref(sizeof(data), data);
+	assert(get_initializer_kind(copy) == IR_INITIALIZER_BYTES);
+	assert(get_initializer_kind(ref) == IR_INITIALIZER_BYTES);
+	assert(get_initializer_bytes_size(copy) == sizeof(data));
+	assert(get_initializer_bytes_size(ref) == sizeof(data));
+	assert(get_initializer_bytes_data(ref) == data);
+	assert(get_initializer_bytes_data(copy) != data);
+
+	/* the copy does not see later changes */
+	data[0] = 0xff;
+	assert(get_initializer_bytes_data(copy)[0] == 0x01);
+	assert(get_initializer_bytes_data(ref)[0] == 0xff);
+	assert(memcmp(get_initializer_bytes_data(copy), image, sizeof(image)) == 0);
+}
+
+static ir_entity *new_constant(char const *name, ir_type *type,
+                               ir_initializer_t *initializer)
+{
+	ir_entity *ent = new_global_entity(get_glob_type(), new_id_from_str(name),
+	                                   type, ir_visibility_external,
+	                                   IR_LINKAGE_CONSTANT);
+	set_entity_initializer(ent, initializer);
+	return ent;
+}
+
+/*
+ * const unsigned char table[16] = { 1, 2, ..., 11 };
+ * const unsigned char pairs[2][4] = { { 1, 2, 3 }, { 4, 5, 6, 7 } };
+ */
+static void build_module(void)
+{
+	ir_type *byte_type = new_type_primitive(mode_Bu);
+	new_constant("table", new_type_array(byte_type, 16),
+	             create_initializer_bytes(sizeof(image), image));
+
+	ir_type          *row_type = new_type_array(byte_type, 4);
+	ir_initializer_t *rows     = create_initializer_compound(2);
+	set_initializer_compound_value(rows, 0,
+	                               create_initializer_bytes(3, image));
+	set_initializer_compound_value(rows, 1,
+	                               create_initializer_bytes(4, image + 3));
+	new_constant("pairs", new_type_array(row_type, 2), rows);
+}
+
+static char *read_file(char const *file)
+{
+	FILE *in = fopen(file, "rb");
+	assert(in != NULL);
+	fseek(in, 0, SEEK_END);
+	long size = ftell(in);
+	fseek(in, 0, SEEK_SET);
+	char *content = (char*)malloc(size + 1);
+	size_t n = fread(content, 1, size, in);
+	assert(n == (size_t)size);
+	content[size] = '\0';
+	fclose(in);
+	return content;
+}
+
+/** Returns the text following the label of @p name in @p text. */
+static char const *find_label(char const *text, char const *name)
+{
+	char label[32];
+	snprintf(label, sizeof(label), "\n%s:\n", name);
+	char const *pos = strstr(text, label);
+	assert(pos != NULL);
+	return pos + strlen(label);
+}
+
+static bool starts_with(char const *text, char const *prefix)
+{
+	return strncmp(text, prefix, strlen(prefix)) == 0;
+}
+
+static void test_emission(void)
+{
+	build_module();
+
+	FILE *out = fopen("initializer_bytes.s", "wb");
+	assert(out != NULL);
+	be_main(out, "initializer_bytes");
+	fclose(out);
+	ir_finish();
+
+	char *text = read_file("initializer_bytes.s");
+	/* little endian quads, the remainder as bytes, padded to 16 bytes */
+	assert(starts_with(find_label(text, "table"),
+	                   "\t.quad\t0x0807060504030201\n"
+	                   "\t.byte\t0x09,0x0a,0x0b\n"
+	                   "\t.space\t5, 0\n"));
+	/* each row image is padded to the size of the row */
+	assert(starts_with(find_label(text, "pairs"),
+	                   "\t.byte\t0x01,0x02,0x03\n"
+	                   "\t.space\t1, 0\n"
+	                   "\t.byte\t0x04,0x05,0x06,0x07\n"));
+	free(text);
+}
+
+int main(void)
+{
+	ir_init();
+	if (!ir_target_set("x86_64-linux-gnu"))
+		return 1;
+	ir_target_init();
+
+	test_accessors();
+	test_emission();
+	return 0;
+}
@@ -0,0 +1,128 @@
+/*
+ * Checks that the ipsccp pass of the parallel pipeline propagates a constant
+ * argument into a private method, removes the branch it decides and
+ * propagates the constant result back to the caller.
+ */
+#include "firm.h"
+#include <assert.h>
+#include <stdbool.h>
+
+static ir_type *int_type;
+
+static ir_type *new_method_type(size_t n_params)
+{
+	ir_type *mtp = new_type_method(n_params, 1, false, cc_cdecl_set,
+	                               mtp_no_property);
+	for (size_t i = 0; i < n_params; ++i)
+		set_method_param_type(mtp, i, int_type);
+	set_method_res_type(mtp, 0, int_type);
+	return mtp;
+}
+
+static ir_graph *new_function(char const *name, ir_type *mtp,
+                              ir_visibility visibility)
+{
+	ir_entity *ent = new_global_entity(get_glob_type(), new_id_from_str(name),
+	                                   mtp, visibility, IR_LINKAGE_DEFAULT);
+	ir_graph  *irg = new_ir_graph(ent, 0);
+	set_current_ir_graph(irg);
+	return irg;
+}
+
+static void finish_function(ir_graph *irg, ir_node *res)
+{
+	ir_node *ret = new_Return(get_store(), 1, &res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+}
+
+/* static int callee(int x) { if (x != 2) return x * 7; return x + 1; } */
+static ir_graph *build_callee(void)
+{
+	ir_graph *irg  = new_function("callee", new_method_type(1),
+	                              ir_visibility_local);
+	ir_node  *x    = new_Proj(get_irg_args(irg), mode_Is, 0);
+	ir_node  *cmp  = new_Cmp(x, new_Const_long(mode_Is, 2),
+	                         ir_relation_less_greater);
+	ir_node  *cond = new_Cond(cmp);
+
+	ir_node *other = new_immBlock();
+	add_immBlock_pred(other, new_Proj(cond, mode_X, pn_Cond_true));
+	mature_immBlock(other);
+	set_cur_block(other);
+	ir_node *mul = new_Mul(x, new_Const_long(mode_Is, 7));
+	ir_node *ret = new_Return(get_store(), 1, &mul);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+
+	ir_node *two = new_immBlock();
+	add_immBlock_pred(two, new_Proj(cond, mode_X, pn_Cond_false));
+	mature_immBlock(two);
+	set_cur_block(two);
+	finish_function(irg, new_Add(x, new_Const_long(mode_Is, 1)));
+	return irg;
+}
+
+/* int caller(void) { return callee(2); } */
+static ir_graph *build_caller(ir_graph *callee)
+{
+	ir_graph *irg  = new_function("caller", new_method_type(0),
+	                              ir_visibility_external);
+	ir_node  *arg  = new_Const_long(mode_Is, 2);
+	ir_node  *call = new_Call(get_store(),
+	                          new_Address(get_irg_entity(callee)), 1, &arg,
+	                          get_entity_type(get_irg_entity(callee)));
+	set_store(new_Proj(call, mode_M, pn_Call_M));
+	ir_node  *res  = new_Proj(new_Proj(call, mode_T, pn_Call_T_result),
+	                          mode_Is, 0);
+	finish_function(irg, res);
+	return irg;
+}
+
+static void count_cond(ir_node *node, void *env)
+{
+	if (is_Cond(node))
+		++*(unsigned*)env;
+}
+
+static unsigned count_conds(ir_graph *irg)
+{
+	unsigned n_conds = 0;
+	irg_walk_graph(irg, count_cond, NULL, &n_conds);
+	return n_conds;
+}
+
+/** Returns the value returned by the only Return of @p irg. */
+static ir_node *get_result(ir_graph *irg)
+{
+	ir_node *end_block = get_irg_end_block(irg);
+	assert(get_Block_n_cfgpreds(end_block) == 1);
+	ir_node *ret = get_Block_cfgpred(end_block, 0);
+	return get_Return_res(ret, 0);
+}
+
+int main(void)
+{
+	ir_init();
+	int_type = new_type_primitive(mode_Is);
+
+	ir_graph *callee = build_callee();
+	ir_graph *caller = build_caller(callee);
+	assert(count_conds(callee) == 1);
+	assert(!is_Const(get_result(caller)));
+
+	ir_parallel_pipeline *pipeline = new_parallel_pipeline();
+	assert(parallel_pipeline_add_passes(pipeline, "ipsccp,bads"));
+	run_parallel_pipeline(pipeline, 1);
+	free_parallel_pipeline(pipeline);
+
+	/* the argument decides the branch */
+	assert(count_conds(callee) == 0);
+	ir_node *res = get_result(callee);
+	assert(is_Const(res) && get_tarval_long(get_Const_tarval(res)) == 3);
+	/* the result is known to the caller */
+	res = get_result(caller);
+	assert(is_Const(res) && get_tarval_long(get_Const_tarval(res)) == 3);
+	assert(irg_verify(callee) && irg_verify(caller));
+	return 0;
+}
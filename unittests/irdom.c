@@ -0,0 +1,153 @@
+#include "firm.h"
+#include "irdom.h"
+#include <assert.h>
+#include <stdbool.h>
+
+enum { S, A, B, C, D, R, X, N_BLOCKS };
+
+static ir_node *blocks[N_BLOCKS];
+
+static ir_node *new_block(ir_node *pred)
+{
+	ir_node *block = new_immBlock();
+	add_immBlock_pred(block, pred);
+	mature_immBlock(block);
+	return block;
+}
+
+static void new_cond(ir_node *left, ir_node *right, ir_relation relation,
+                     ir_node **true_proj, ir_node **false_proj)
+{
+	ir_node *cond = new_Cond(new_Cmp(left, right, relation));
+	*true_proj  = new_Proj(cond, mode_X, pn_Cond_true);
+	*false_proj = new_Proj(cond, mode_X, pn_Cond_false);
+}
+
+static void add_return(ir_graph *irg)
+{
+	ir_node *ret = new_Return(get_store(), 0, NULL);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+}
+
+/*
+ * S -> A, X
+ * A -> B, C
+ * B -> D
+ * C -> D, R
+ */
+static ir_graph *build_graph(void)
+{
+	ir_type   *int_type = new_type_primitive(mode_Is);
+	ir_type   *mtp      = new_type_method(1, 0, false, cc_cdecl_set,
+	                                      mtp_no_property);
+	set_method_param_type(mtp, 0, int_type);
+	ir_entity *ent      = new_entity(get_glob_type(), new_id_from_str("f"),
+	                                 mtp);
+	ir_graph  *irg      = new_ir_graph(ent, 0);
+	set_current_ir_graph(irg);
+	ir_node   *param    = new_Proj(get_irg_args(irg), mode_Is, 0);
+
+	ir_node *s_true, *s_false;
+	blocks[S] = get_irg_start_block(irg);
+	new_cond(param, new_Const_long(mode_Is, 0), ir_relation_less,
+	         &s_true, &s_false);
+
+	blocks[A] = new_block(s_true);
+	set_cur_block(blocks[A]);
+	ir_node *a_true, *a_false;
+	new_cond(param, new_Const_long(mode_Is, -5), ir_relation_less,
+	         &a_true, &a_false);
+
+	blocks[B] = new_block(a_true);
+	set_cur_block(blocks[B]);
+	ir_node *b_jmp = new_Jmp();
+
+	blocks[C] = new_block(a_false);
+	set_cur_block(blocks[C]);
+	ir_node *c_true, *c_false;
+	new_cond(param, new_Const_long(mode_Is, -3), ir_relation_equal,
+	         &c_true, &c_false);
+
+	blocks[D] = new_immBlock();
+	add_immBlock_pred(blocks[D], b_jmp);
+	add_immBlock_pred(blocks[D], c_true);
+	mature_immBlock(blocks[D]);
+	set_cur_block(blocks[D]);
+	add_return(irg);
+
+	blocks[R] = new_block(c_false);
+	set_cur_block(blocks[R]);
+	add_return(irg);
+
+	blocks[X] = new_block(s_false);
+	set_cur_block(blocks[X]);
+	add_return(irg);
+
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+	return irg;
+}
+
+typedef struct dom_state_t {
+	ir_node *idom[N_BLOCKS];
+	bool     dominates[N_BLOCKS][N_BLOCKS];
+} dom_state_t;
+
+static void get_dom_state(dom_state_t *state)
+{
+	for (int i = 0; i < N_BLOCKS; ++i) {
+		state->idom[i] = get_Block_idom(blocks[i]);
+		for (int j = 0; j < N_BLOCKS; ++j)
+			state->dominates[i][j] = block_dominates(blocks[i], blocks[j]);
+	}
+}
+
+/** Checks the maintained dominance info against a full recomputation. */
+static void check_against_recompute(ir_graph *irg)
+{
+	dom_state_t updated;
+	get_dom_state(&updated);
+
+	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
+	                        | IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+	dom_state_t recomputed;
+	get_dom_state(&recomputed);
+
+	for (int i = 0; i < N_BLOCKS; ++i) {
+		assert(updated.idom[i] == recomputed.idom[i]);
+		for (int j = 0; j < N_BLOCKS; ++j)
+			assert(updated.dominates[i][j] == recomputed.dominates[i][j]);
+	}
+}
+
+int main(void)
+{
+	ir_init();
+
+	ir_graph *irg = build_graph();
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+	assert(get_Block_idom(blocks[D]) == blocks[A]);
+	check_against_recompute(irg);
+
+	/* Remove C -> D: only the subtree of A below the start block changes
+	 * and is renumbered in place. */
+	set_irn_n(blocks[D], 1, new_r_Bad(irg, mode_X));
+	dom_delete_edge(blocks[C], blocks[D]);
+	assert(get_Block_idom(blocks[D]) == blocks[B]);
+	assert(!block_dominates(blocks[A], blocks[S]));
+	assert(!block_dominates(blocks[A], blocks[X]));
+	assert(!block_dominates(blocks[X], blocks[D]));
+	assert(block_dominates(blocks[S], blocks[D]));
+	check_against_recompute(irg);
+
+	/* The same update checked by the verifier. */
+	set_irn_n(blocks[D], 1, new_r_Proj(get_irn_n(get_irn_n(blocks[R], 0), 0),
+	                                   mode_X, pn_Cond_true));
+	dom_set_verify_updates(true);
+	dom_insert_edge(blocks[C], blocks[D]);
+	assert(get_Block_idom(blocks[D]) == blocks[A]);
+	check_against_recompute(irg);
+
+	return 0;
+}
@@ -0,0 +1,93 @@
+/*
+ * Checks that optimize_load_store() removes a Store overwritten by a later
+ * Store across a CopyB which does not alias it, and keeps it if the CopyB may
+ * read or write it.
+ */
+#include "firm.h"
+#include <assert.h>
+#include <stdbool.h>
+
+static ir_type *int_type;
+static ir_type *struct_type;
+
+static ir_entity *new_global(char const *name, ir_type *type)
+{
+	return new_global_entity(get_glob_type(), new_id_from_str(name), type,
+	                         ir_visibility_external, IR_LINKAGE_DEFAULT);
+}
+
+static void store(ir_entity *ent, long value)
+{
+	ir_node *st = new_Store(get_store(), new_Address(ent),
+	                        new_Const_long(mode_Is, value), int_type,
+	                        cons_none);
+	set_store(new_Proj(st, mode_M, pn_Store_M));
+}
+
+static void count_store(ir_node *node, void *env)
+{
+	if (is_Store(node))
+		++*(unsigned*)env;
+}
+
+/**
+ * Builds g = 1; *dst = *src; g = 2; with a struct copy, optimizes it and
+ * returns the number of remaining Stores. With @p dst_is_param the copy
+ * writes through a pointer parameter.
+ */
+static unsigned optimize_copy_between_stores(char const *name,
+                                             ir_entity *g, ir_entity *src,
+                                             ir_entity *dst, bool dst_is_param)
+{
+	ir_type   *mtp = new_type_method(1, 0, false, cc_cdecl_set,
+	                                 mtp_no_property);
+	set_method_param_type(mtp, 0, new_type_pointer(struct_type));
+	ir_entity *ent = new_global(name, mtp);
+	ir_graph  *irg = new_ir_graph(ent, 0);
+	set_current_ir_graph(irg);
+
+	store(g, 1);
+	ir_node *dst_addr = dst_is_param
+		? new_Proj(get_irg_args(irg), mode_P, 0) : new_Address(dst);
+	ir_node *copyb    = new_CopyB(get_store(), dst_addr, new_Address(src),
+	                              struct_type, cons_none);
+	set_store(copyb);
+	store(g, 2);
+
+	ir_node *ret = new_Return(get_store(), 0, NULL);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+
+	optimize_load_store(irg);
+
+	unsigned n_stores = 0;
+	irg_walk_graph(irg, count_store, NULL, &n_stores);
+	return n_stores;
+}
+
+int main(void)
+{
+	ir_init();
+
+	int_type    = new_type_primitive(mode_Is);
+	struct_type = new_type_struct(new_id_from_str("pair"));
+	ir_entity *x = new_entity(struct_type, new_id_from_str("x"), int_type);
+	ir_entity *y = new_entity(struct_type, new_id_from_str("y"), int_type);
+	set_entity_offset(x, 0);
+	set_entity_offset(y, 4);
+	set_type_size(struct_type, 8);
+	set_type_alignment(struct_type, 4);
+	set_type_state(struct_type, layout_fixed);
+
+	ir_entity *g  = new_global("g", int_type);
+	ir_entity *s1 = new_global("s1", struct_type);
+	ir_entity *s2 = new_global("s2", struct_type);
+
+	/* The copy between other globals is stepped over. */
+	assert(optimize_copy_between_stores("f", g, s1, s2, false) == 1);
+	/* A copy through an unknown pointer may overwrite g. */
+	assert(optimize_copy_between_stores("h", g, s1, NULL, true) == 2);
+
+	return 0;
+}
@@ -0,0 +1,146 @@
+/*
+ * Checks that opt_licm() hoists a loop invariant Load into the preheader and
+ * sinks a Store executed in every iteration into the loop exit, but keeps a
+ * Store inside the loop if the loop reads the stored location.
+ */
+#include "firm.h"
+#include <assert.h>
+#include <stdbool.h>
+
+static ir_type   *int_type;
+static ir_entity *global;
+static ir_graph  *irg;
+static ir_node   *preheader;
+static ir_node   *header;
+static ir_node   *exit_block;
+
+static void new_function(char const *name)
+{
+	ir_type   *mtp = new_type_method(1, 1, false, cc_cdecl_set,
+	                                 mtp_no_property);
+	set_method_param_type(mtp, 0, int_type);
+	set_method_res_type(mtp, 0, int_type);
+	ir_entity *ent = new_global_entity(get_glob_type(), new_id_from_str(name),
+	                                   mtp, ir_visibility_external,
+	                                   IR_LINKAGE_DEFAULT);
+	irg = new_ir_graph(ent, 2);
+	set_current_ir_graph(irg);
+	/* keep the tests as they are written */
+	set_optimize(0);
+}
+
+static void finish_function(ir_node *res)
+{
+	ir_node *ret = new_Return(get_store(), 1, &res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+	set_optimize(1);
+	assert(irg_verify(irg));
+}
+
+/** Enters the body of the loop do { ... } while (i != n) counting i. */
+static ir_node *begin_loop(void)
+{
+	set_value(0, new_Const_long(mode_Is, 0));
+	set_value(1, new_Const_long(mode_Is, 0));
+	preheader = get_cur_block();
+	header    = new_immBlock();
+	add_immBlock_pred(header, new_Jmp());
+	set_cur_block(header);
+	return get_value(1, mode_Is);
+}
+
+static void end_loop(ir_node *i)
+{
+	ir_node *n    = new_Proj(get_irg_args(irg), mode_Is, 0);
+	ir_node *next = new_Add(i, new_Const_long(mode_Is, 1));
+	set_value(1, next);
+	ir_node *cond = new_Cond(new_Cmp(next, n, ir_relation_less_greater));
+	add_immBlock_pred(header, new_Proj(cond, mode_X, pn_Cond_true));
+	mature_immBlock(header);
+
+	exit_block = new_immBlock();
+	add_immBlock_pred(exit_block, new_Proj(cond, mode_X, pn_Cond_false));
+	mature_immBlock(exit_block);
+	set_cur_block(exit_block);
+}
+
+static ir_node *load_global(void)
+{
+	ir_node *ld = new_Load(get_store(), new_Address(global), mode_Is,
+	                       int_type, cons_none);
+	set_store(new_Proj(ld, mode_M, pn_Load_M));
+	set_value(0, new_Add(get_value(0, mode_Is), new_Proj(ld, mode_Is,
+	                                                     pn_Load_res)));
+	return ld;
+}
+
+static ir_node *store_global(ir_node *value)
+{
+	ir_node *st = new_Store(get_store(), new_Address(global), value,
+	                        int_type, cons_none);
+	set_store(new_Proj(st, mode_M, pn_Store_M));
+	return st;
+}
+
+/* int s = 0, i = 0; do { s += global; } while (++i != n); return s; */
+static void test_hoist_load(void)
+{
+	new_function("hoist_load");
+	ir_node *i  = begin_loop();
+	ir_node *ld = load_global();
+	end_loop(i);
+	finish_function(get_value(0, mode_Is));
+	assert(get_nodes_block(ld) == header);
+
+	opt_licm(irg);
+	assert(irg_verify(irg));
+	assert(get_nodes_block(ld) == preheader);
+}
+
+/* int i = 0; do { global = i; } while (++i != n); return 0; */
+static void test_sink_store(void)
+{
+	new_function("sink_store");
+	ir_node *i  = begin_loop();
+	ir_node *st = store_global(i);
+	end_loop(i);
+	finish_function(get_value(0, mode_Is));
+
+	opt_licm(irg);
+	assert(irg_verify(irg));
+	assert(get_nodes_block(st) == exit_block);
+}
+
+/* int s = 0, i = 0; do { s += global; global = i; } while (++i != n);
+ * return s; */
+static void test_keep_store(void)
+{
+	new_function("keep_store");
+	ir_node *i  = begin_loop();
+	ir_node *ld = load_global();
+	ir_node *st = store_global(i);
+	end_loop(i);
+	finish_function(get_value(0, mode_Is));
+
+	opt_licm(irg);
+	assert(irg_verify(irg));
+	/* the Load sees the value of the previous iteration */
+	assert(get_nodes_block(ld) == header);
+	assert(get_nodes_block(st) == header);
+}
+
+int main(void)
+{
+	ir_init();
+	int_type = new_type_primitive(mode_Is);
+	global   = new_global_entity(get_glob_type(), new_id_from_str("global"),
+	                             int_type, ir_visibility_external,
+	                             IR_LINKAGE_DEFAULT);
+
+	test_hoist_load();
+	test_sink_store();
+	test_keep_store();
+	return 0;
+}
@@ -0,0 +1,136 @@
+#include "firm.h"
+#include <assert.h>
+#include <stdbool.h>
+
+enum { START, HEADER, BODY, EXIT, N_BLOCKS };
+
+static ir_node *blocks[N_BLOCKS];
+static ir_node *cmp;
+static ir_node *incr;
+
+/*
+ * i = 0; while (i < n) ++i; return i;
+ */
+static ir_graph *build_graph(void)
+{
+	ir_type   *int_type = new_type_primitive(mode_Is);
+	ir_type   *mtp      = new_type_method(1, 1, false, cc_cdecl_set,
+	                                      mtp_no_property);
+	set_method_param_type(mtp, 0, int_type);
+	set_method_res_type(mtp, 0, int_type);
+	ir_entity *ent      = new_entity(get_glob_type(), new_id_from_str("f"),
+	                                 mtp);
+	ir_graph  *irg      = new_ir_graph(ent, 1);
+	set_current_ir_graph(irg);
+	ir_node   *n        = new_Proj(get_irg_args(irg), mode_Is, 0);
+
+	blocks[START] = get_irg_start_block(irg);
+	set_value(0, new_Const_long(mode_Is, 0));
+	ir_node *entry = new_Jmp();
+
+	blocks[HEADER] = new_immBlock();
+	add_immBlock_pred(blocks[HEADER], entry);
+	set_cur_block(blocks[HEADER]);
+	cmp = new_Cmp(get_value(0, mode_Is), n, ir_relation_less);
+	ir_node *cond = new_Cond(cmp);
+
+	blocks[BODY] = new_immBlock();
+	add_immBlock_pred(blocks[BODY], new_Proj(cond, mode_X, pn_Cond_true));
+	mature_immBlock(blocks[BODY]);
+	set_cur_block(blocks[BODY]);
+	incr = new_Add(get_value(0, mode_Is), new_Const_long(mode_Is, 1));
+	set_value(0, incr);
+	add_immBlock_pred(blocks[HEADER], new_Jmp());
+	mature_immBlock(blocks[HEADER]);
+
+	blocks[EXIT] = new_immBlock();
+	add_immBlock_pred(blocks[EXIT], new_Proj(cond, mode_X, pn_Cond_false));
+	mature_immBlock(blocks[EXIT]);
+	set_cur_block(blocks[EXIT]);
+	ir_node *res = get_value(0, mode_Is);
+	ir_node *ret = new_Return(get_store(), 1, &res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+
+	irg_finalize_cons(irg);
+	return irg;
+}
+
+typedef struct loop_state_t {
+	unsigned depth[N_BLOCKS];
+	bool     same_loop[N_BLOCKS][N_BLOCKS];
+	bool     backedge[N_BLOCKS][2];
+} loop_state_t;
+
+static void get_loop_state(loop_state_t *state)
+{
+	for (int i = 0; i < N_BLOCKS; ++i) {
+		ir_loop *loop = get_irn_loop(blocks[i]);
+		assert(loop != NULL);
+		state->depth[i] = get_loop_depth(loop);
+		for (int j = 0; j < N_BLOCKS; ++j)
+			state->same_loop[i][j] = loop == get_irn_loop(blocks[j]);
+		for (int p = 0; p < 2; ++p) {
+			state->backedge[i][p] = p < get_Block_n_cfgpreds(blocks[i])
+			                     && is_backedge(blocks[i], p);
+		}
+	}
+}
+
+/** Checks that the loop information kept valid matches a recomputation. */
+static void check_loopinfo(ir_graph *irg)
+{
+	assert(irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO));
+	loop_state_t kept;
+	get_loop_state(&kept);
+
+	free_loop_information(irg);
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+	loop_state_t recomputed;
+	get_loop_state(&recomputed);
+
+	for (int i = 0; i < N_BLOCKS; ++i) {
+		assert(kept.depth[i] == recomputed.depth[i]);
+		for (int j = 0; j < N_BLOCKS; ++j)
+			assert(kept.same_loop[i][j] == recomputed.same_loop[i][j]);
+		for (int p = 0; p < 2; ++p)
+			assert(kept.backedge[i][p] == recomputed.backedge[i][p]);
+	}
+}
+
+int main(void)
+{
+	ir_init();
+
+	ir_graph *irg = build_graph();
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+	assert(get_irn_loop(blocks[HEADER]) == get_irn_loop(blocks[BODY]));
+	assert(get_irn_loop(blocks[HEADER]) != get_irn_loop(blocks[EXIT]));
+	assert(is_backedge(blocks[HEADER], 1));
+	check_loopinfo(irg);
+
+	/* Exchanging data nodes keeps the loop information. */
+	ir_node *phi   = get_Add_left(incr);
+	ir_node *incr2 = new_r_Add(blocks[BODY], phi,
+	                           new_r_Const_long(irg, mode_Is, 2));
+	exchange(incr, incr2);
+	check_loopinfo(irg);
+
+	/* So does rewiring data inputs, including those of Phis. */
+	set_irn_n(cmp, 1, new_r_Const_long(irg, mode_Is, 10));
+	set_irn_n(phi, 0, new_r_Const_long(irg, mode_Is, 1));
+	check_loopinfo(irg);
+
+	/* Changing the predecessors of a block invalidates it. */
+	set_irn_n(blocks[EXIT], 0, get_irn_n(blocks[EXIT], 0));
+	assert(irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO));
+	set_irn_n(blocks[HEADER], 1, new_r_Bad(irg, mode_X));
+	assert(!irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO));
+
+	/* As does exchanging a control flow node. */
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+	exchange(get_irn_n(blocks[BODY], 0), new_r_Bad(irg, mode_X));
+	assert(!irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO));
+
+	return 0;
+}
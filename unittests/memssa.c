@@ -0,0 +1,112 @@
+/*
+ * Checks that the memory SSA overlay skips the memory operations of other
+ * alias classes and looks through memory Phis which are trivial for a class.
+ */
+#include "firm.h"
+#include "memssa.h"
+#include <assert.h>
+#include <stdbool.h>
+
+static ir_type *int_type;
+
+static ir_node *store(ir_node *addr, long value)
+{
+	ir_node *st = new_Store(get_store(), addr, new_Const_long(mode_Is, value),
+	                        int_type, cons_none);
+	set_store(new_Proj(st, mode_M, pn_Store_M));
+	return st;
+}
+
+static ir_node *load(ir_node *addr)
+{
+	ir_node *ld = new_Load(get_store(), addr, mode_Is, int_type, cons_none);
+	set_store(new_Proj(ld, mode_M, pn_Load_M));
+	return ld;
+}
+
+int main(void)
+{
+	ir_init();
+
+	int_type = new_type_primitive(mode_Is);
+	ir_type   *ptr_type = new_type_pointer(int_type);
+	ir_type   *mtp      = new_type_method(1, 0, false, cc_cdecl_set,
+	                                      mtp_no_property);
+	set_method_param_type(mtp, 0, ptr_type);
+	ir_entity *ent      = new_entity(get_glob_type(), new_id_from_str("f"),
+	                                 mtp);
+	ir_graph  *irg      = new_ir_graph(ent, 0);
+	set_current_ir_graph(irg);
+	ir_type   *frame    = get_irg_frame_type(irg);
+	ir_entity *a        = new_entity(frame, new_id_from_str("a"), int_type);
+	ir_entity *b        = new_entity(frame, new_id_from_str("b"), int_type);
+
+	/*
+	 * a = 1; b = 2; t = a; *p = 3;
+	 * if (t < 0) b = 4;
+	 * return;
+	 */
+	ir_node *pa = new_Member(get_irg_frame(irg), a);
+	ir_node *pb = new_Member(get_irg_frame(irg), b);
+	ir_node *p  = new_Proj(get_irg_args(irg), mode_P, 0);
+	ir_node *store_a  = store(pa, 1);
+	ir_node *store_b  = store(pb, 2);
+	ir_node *load_a   = load(pa);
+	ir_node *store_p  = store(p, 3);
+	ir_node *mem_top  = get_store();
+	ir_node *t        = new_Proj(load_a, mode_Is, pn_Load_res);
+	ir_node *cond     = new_Cond(new_Cmp(t, new_Const_long(mode_Is, 0),
+	                                     ir_relation_less));
+	ir_node *then_blk = new_immBlock();
+	add_immBlock_pred(then_blk, new_Proj(cond, mode_X, pn_Cond_true));
+	mature_immBlock(then_blk);
+	set_cur_block(then_blk);
+	ir_node *store_b2 = store(pb, 4);
+	ir_node *then_jmp = new_Jmp();
+	ir_node *join     = new_immBlock();
+	add_immBlock_pred(join, then_jmp);
+	add_immBlock_pred(join, new_Proj(cond, mode_X, pn_Cond_false));
+	mature_immBlock(join);
+	set_cur_block(join);
+	ir_node *mem_join = get_store();
+	ir_node *ret      = new_Return(mem_join, 0, NULL);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+	assert(is_Phi(mem_join));
+
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE);
+	ir_memssa_t *ms = memssa_new(irg);
+
+	unsigned const cls_a = memssa_get_class(ms, pa);
+	unsigned const cls_b = memssa_get_class(ms, pb);
+	unsigned const cls_p = memssa_get_class(ms, p);
+	assert(cls_a != MEMSSA_ANY_CLASS && cls_b != MEMSSA_ANY_CLASS);
+	assert(cls_a != cls_b);
+	assert(cls_p != cls_a && cls_p != cls_b);
+
+	/* Operations of other classes are skipped, Loads stop only queries for
+	 * definitions. */
+	assert(memssa_skip(ms, mem_top, cls_a, memssa_clobber) == store_a);
+	assert(memssa_skip(ms, mem_top, cls_a, memssa_def) == load_a);
+	assert(memssa_skip(ms, mem_top, cls_b, memssa_clobber) == store_b);
+	assert(memssa_skip(ms, mem_top, cls_p, memssa_clobber) == store_p);
+	assert(memssa_skip(ms, mem_top, MEMSSA_ANY_CLASS, memssa_clobber)
+	       == store_p);
+
+	/* The Phi merges different states of b only. */
+	assert(memssa_skip(ms, mem_join, cls_a, memssa_clobber) == store_a);
+	assert(memssa_skip(ms, mem_join, cls_b, memssa_clobber) == mem_join);
+	assert(memssa_skip(ms, get_Store_mem(store_b2), cls_b, memssa_clobber)
+	       == store_b);
+
+	/* Removed operations are skipped after the query was memoized. */
+	exchange(new_r_Proj(store_b, mode_M, pn_Store_M), get_Store_mem(store_b));
+	kill_node(store_b);
+	assert(memssa_skip(ms, get_Store_mem(store_b2), cls_b, memssa_clobber)
+	       == get_irg_start(irg));
+	assert(memssa_skip(ms, mem_top, cls_a, memssa_clobber) == store_a);
+
+	memssa_free(ms);
+	return 0;
+}
@@ -0,0 +1,132 @@
+/*
+ * Checks that the memory of dead nodes is recycled: irg_free_node_memory()
+ * puts a node onto the free list of its size class, where
+ * irg_alloc_node_memory() finds it again. dead_node_compaction() frees the
+ * unreachable nodes and renumbers the others in place. Nodes created after
+ * the compaction reuse the memory of the dead ones, in arrays included.
+ */
+#include "firm.h"
+#include "irgraph_t.h"
+#include "irnode_t.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+
+/** Number of dead Subs created, each with a dead Const. */
+#define N_DEAD 16
+
+static ir_node *dead[2 * N_DEAD];
+static ir_node *param;
+static ir_node *one;
+
+static void count_node(ir_node *node, void *env)
+{
+	(void)node;
+	++*(unsigned*)env;
+}
+
+static void check_index(ir_node *node, void *env)
+{
+	ir_graph *irg = (ir_graph*)env;
+	assert(get_irn_idx(node) < get_irg_last_idx(irg));
+	assert(get_idx_irn(irg, get_irn_idx(node)) == node);
+}
+
+static bool is_dead(ir_node const *node)
+{
+	for (int i = 0; i < 2 * N_DEAD; ++i) {
+		if (dead[i] == node)
+			return true;
+	}
+	return false;
+}
+
+/* int f(int x) { x - 0; ...; x - 15; return x + 1; } */
+static ir_graph *build_function(void)
+{
+	ir_type   *type = new_type_primitive(mode_Is);
+	ir_type   *mtp  = new_type_method(1, 1, false, cc_cdecl_set,
+	                                  mtp_no_property);
+	set_method_param_type(mtp, 0, type);
+	set_method_res_type(mtp, 0, type);
+	ir_entity *ent  = new_global_entity(get_glob_type(), new_id_from_str("f"),
+	                                    mtp, ir_visibility_external,
+	                                    IR_LINKAGE_DEFAULT);
+	ir_graph  *irg  = new_ir_graph(ent, 0);
+	set_current_ir_graph(irg);
+	param = new_Proj(get_irg_args(irg), mode_Is, 0);
+	one   = new_Const_long(mode_Is, 1);
+	for (int i = 0; i < N_DEAD; ++i) {
+		dead[2 * i]     = new_Const_long(mode_Is, i);
+		dead[2 * i + 1] = new_Sub(param, dead[2 * i]);
+	}
+	ir_node   *res  = new_Add(param, one);
+	ir_node   *ret  = new_Return(get_store(), 1, &res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+	return irg;
+}
+
+static void test_free_list(ir_graph *irg)
+{
+	ir_node *const node = new_r_Minus(get_irg_start_block(irg), param);
+	unsigned const idx  = get_irn_idx(node);
+	unsigned char  cls  = irg->idx_alloc_class[idx];
+	assert(cls != 0);
+
+	irg_free_node_memory(irg, node);
+	irg->idx_irn_map[idx] = NULL;
+	/* Any size of the class gets the freed memory, cleared. */
+	size_t   const size = (cls & ~NODE_ALLOC_RECYCLED) * NODE_ALLOC_GRANULE;
+	unsigned char  new_cls;
+	char    *const mem  = (char*)irg_alloc_node_memory(irg, size - 1, &new_cls);
+	assert(mem == (char*)node);
+	assert(new_cls == ((cls & ~NODE_ALLOC_RECYCLED) | NODE_ALLOC_RECYCLED));
+	for (size_t i = 0; i < size; ++i)
+		assert(mem[i] == 0);
+	/* The list is empty now. */
+	assert(irg_alloc_node_memory(irg, size, &new_cls) != mem);
+	assert(!(new_cls & NODE_ALLOC_RECYCLED));
+
+	/* Large memory is not recycled. */
+	size_t const large = N_NODE_ALLOC_CLASSES * NODE_ALLOC_GRANULE;
+	irg_alloc_node_memory(irg, large, &new_cls);
+	assert(new_cls == 0);
+}
+
+static void test_compaction(ir_graph *irg)
+{
+	unsigned n_live = 0;
+	irg_walk_in_or_dep(irg->anchor, count_node, NULL, &n_live);
+	assert(get_irg_last_idx(irg) > n_live + 2 * N_DEAD);
+
+	dead_node_compaction(irg);
+	assert(irg_verify(irg));
+	/* The reachable nodes are numbered densely. */
+	assert(get_irg_last_idx(irg) == n_live);
+	irg_walk_graph(irg, check_index, NULL, irg);
+
+	/* New nodes of the same kind take the memory of the dead ones and do not
+	 * grow the obstack, not even for their in arrays. */
+	ir_node *const block = get_irg_start_block(irg);
+	size_t   const used  = obstack_memory_used(&irg->obst);
+	for (int i = 0; i < N_DEAD; ++i) {
+		ir_node *const sub = new_r_Sub(block, param, one);
+		assert(is_dead(sub));
+		assert(get_Sub_left(sub) == param && get_Sub_right(sub) == one);
+	}
+	assert(obstack_memory_used(&irg->obst) == used);
+}
+
+int main(void)
+{
+	ir_init();
+	/* keep the dead nodes as they are created */
+	set_optimize(0);
+	ir_graph *irg = build_function();
+	test_free_list(irg);
+	test_compaction(irg);
+	ir_finish();
+	return 0;
+}
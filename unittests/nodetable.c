@@ -0,0 +1,99 @@
+/*
+ * Checks the dense node table: entries are found by node, stay in place when
+ * the table grows, are invalidated by ir_nodetable_clear() and do not become
+ * valid again when the generation counter wraps around.
+ */
+#include "firm.h"
+#include "irnodetable.h"
+#include <assert.h>
+#include <limits.h>
+
+/** Number of nodes, enough for several chunks. */
+#define N_NODES (3 * IR_NODETABLE_CHUNK_SIZE)
+
+typedef struct entry_t {
+	int  value;
+	char padding[9];
+} entry_t;
+
+static ir_node *nodes[N_NODES];
+
+static void test_insert(ir_nodetable *table, ir_graph *irg)
+{
+	/* only the first chunk exists when the table is created */
+	ir_nodetable_init(table, irg, sizeof(entry_t));
+	assert(table->elem_size % sizeof(void*) == 0);
+	for (int i = 1; i < N_NODES; ++i)
+		nodes[i] = new_r_Const_long(irg, mode_Is, i);
+
+	entry_t *first = ir_nodetable_insert(entry_t, table, nodes[1]);
+	first->value = 1;
+	for (int i = 2; i < N_NODES; i += 2)
+		ir_nodetable_insert(entry_t, table, nodes[i])->value = i;
+
+	/* growing the table did not move the first entry */
+	assert(ir_nodetable_get(entry_t, table, nodes[1]) == first);
+	assert(first->value == 1);
+	for (int i = 2; i < N_NODES; ++i) {
+		entry_t const *entry = ir_nodetable_get(entry_t, table, nodes[i]);
+		if (i % 2 != 0) {
+			assert(entry == NULL);
+		} else {
+			assert(entry != NULL && entry->value == i);
+			assert(ir_nodetable_get_idx(entry_t, table, get_irn_idx(nodes[i]))
+			       == entry);
+		}
+	}
+	assert(ir_nodetable_get_idx(entry_t, table, UINT_MAX) == NULL);
+
+	/* inserting again replaces the entry by a zeroed one */
+	entry_t *again = ir_nodetable_insert(entry_t, table, nodes[2]);
+	assert(again->value == 0);
+}
+
+static void test_clear(ir_nodetable *table)
+{
+	ir_nodetable_clear(table);
+	for (int i = 1; i < N_NODES; ++i)
+		assert(ir_nodetable_get(entry_t, table, nodes[i]) == NULL);
+	ir_nodetable_insert(entry_t, table, nodes[3])->value = 3;
+	assert(ir_nodetable_get(entry_t, table, nodes[3])->value == 3);
+}
+
+static void test_wrap_around(ir_nodetable *table)
+{
+	/* nodes[3] was inserted in the generation after the first */
+	unsigned const old_generation = table->generation;
+	assert(old_generation == 2);
+
+	/* skip ahead to the last generation */
+	table->generation = UINT_MAX;
+	assert(ir_nodetable_get(entry_t, table, nodes[3]) == NULL);
+	ir_nodetable_insert(entry_t, table, nodes[4])->value = 4;
+
+	/* The counter wraps around to the first generations. Neither the entry
+	 * from the last generation nor the one from the early generation must
+	 * become valid again. */
+	ir_nodetable_clear(table);
+	assert(ir_nodetable_get(entry_t, table, nodes[4]) == NULL);
+	for (unsigned i = table->generation; i <= old_generation; ++i) {
+		assert(ir_nodetable_get(entry_t, table, nodes[3]) == NULL);
+		ir_nodetable_clear(table);
+	}
+	ir_nodetable_insert(entry_t, table, nodes[3])->value = 5;
+	assert(ir_nodetable_get(entry_t, table, nodes[3])->value == 5);
+}
+
+int main(void)
+{
+	ir_init();
+	/* keep the Consts apart */
+	set_optimize(0);
+
+	ir_nodetable table;
+	test_insert(&table, get_const_code_irg());
+	test_clear(&table);
+	test_wrap_around(&table);
+	ir_nodetable_destroy(&table);
+	return 0;
+}
@@ -0,0 +1,207 @@
+/*
+ * Checks that opt_vrp() folds bound checks of induction variables and
+ * overflow checks decided by the value ranges, and that the ranges of loop
+ * header Phis are widened such that the analysis terminates.
+ */
+#include "firm.h"
+#include <assert.h>
+#include <stdbool.h>
+
+static ir_type   *int_type;
+static ir_entity *global;
+static ir_graph  *irg;
+
+static void new_function(char const *name, ir_mode *mode)
+{
+	ir_type   *type = new_type_primitive(mode);
+	ir_type   *mtp  = new_type_method(1, 1, false, cc_cdecl_set,
+	                                  mtp_no_property);
+	set_method_param_type(mtp, 0, type);
+	set_method_res_type(mtp, 0, type);
+	ir_entity *ent  = new_global_entity(get_glob_type(), new_id_from_str(name),
+	                                    mtp, ir_visibility_external,
+	                                    IR_LINKAGE_DEFAULT);
+	irg = new_ir_graph(ent, 1);
+	set_current_ir_graph(irg);
+	/* keep the tests as they are written */
+	set_optimize(0);
+}
+
+static void finish_function(ir_node *res)
+{
+	ir_node *ret = new_Return(get_store(), 1, &res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+	set_optimize(1);
+}
+
+static ir_node *param(ir_mode *mode)
+{
+	return new_Proj(get_irg_args(irg), mode, 0);
+}
+
+/** Ends the current block with a test of @p cmp, returns the false exit. */
+static ir_node *branch(ir_node *cmp, ir_node **exit)
+{
+	ir_node *cond = new_Cond(cmp);
+	*exit = new_Proj(cond, mode_X, pn_Cond_false);
+	return new_Proj(cond, mode_X, pn_Cond_true);
+}
+
+static ir_node *enter(ir_node *pred)
+{
+	ir_node *block = new_immBlock();
+	add_immBlock_pred(block, pred);
+	mature_immBlock(block);
+	set_cur_block(block);
+	return block;
+}
+
+/**
+ * Builds a loop counting the local variable 0 from @p init by @p step while
+ * @p test(value, bound) holds, returns the header Phi.  With @p check the body
+ * contains if (i > bound) global = i;
+ */
+static ir_node *build_loop(ir_mode *mode, long init, long step,
+                           ir_node *(*test)(ir_node *value, ir_node *bound),
+                           ir_node *bound, bool check)
+{
+	set_value(0, new_Const_long(mode, init));
+	ir_node *header = new_immBlock();
+	add_immBlock_pred(header, new_Jmp());
+	set_cur_block(header);
+	ir_node *i = get_value(0, mode);
+
+	ir_node *exit;
+	enter(branch(test(i, bound), &exit));
+	if (check) {
+		ir_node *skip;
+		ir_node *taken = branch(new_Cmp(i, bound, ir_relation_greater), &skip);
+		enter(taken);
+		ir_node *st = new_Store(get_store(), new_Address(global),
+		                        new_Conv(i, mode_Is), int_type, cons_none);
+		set_store(new_Proj(st, mode_M, pn_Store_M));
+		ir_node *latch = new_immBlock();
+		add_immBlock_pred(latch, new_Jmp());
+		add_immBlock_pred(latch, skip);
+		mature_immBlock(latch);
+		set_cur_block(latch);
+	}
+	set_value(0, new_Add(i, new_Const_long(mode, step)));
+	add_immBlock_pred(header, new_Jmp());
+	mature_immBlock(header);
+
+	enter(exit);
+	return i;
+}
+
+static ir_node *less(ir_node *value, ir_node *bound)
+{
+	return new_Cmp(value, bound, ir_relation_less);
+}
+
+static ir_node *not_equal(ir_node *value, ir_node *bound)
+{
+	return new_Cmp(value, bound, ir_relation_less_greater);
+}
+
+static void count_cond(ir_node *node, void *env)
+{
+	if (is_Cond(node))
+		++*(unsigned*)env;
+}
+
+static unsigned count_conds(void)
+{
+	unsigned n_conds = 0;
+	irg_walk_graph(irg, count_cond, NULL, &n_conds);
+	return n_conds;
+}
+
+/* for (unsigned i = 0; i < n; ++i) if (i > n) global = i; return n; */
+static void test_iv_check(void)
+{
+	new_function("iv_check", mode_Iu);
+	ir_node *n = param(mode_Iu);
+	build_loop(mode_Iu, 0, 1, less, n, true);
+	finish_function(n);
+	assert(count_conds() == 2);
+
+	opt_vrp(irg);
+	assert(count_conds() == 1);
+}
+
+/* int x = p & mask; return x + 1 < x ? 1 : 0; */
+static unsigned optimize_overflow_check(char const *name, long mask)
+{
+	new_function(name, mode_Is);
+	ir_node *x = new_And(param(mode_Is), new_Const_long(mode_Is, mask));
+	ir_node *sum = new_Add(x, new_Const_long(mode_Is, 1));
+	ir_node *overflow;
+	ir_node *no_overflow;
+	overflow = branch(new_Cmp(sum, x, ir_relation_less), &no_overflow);
+	ir_node *join = new_immBlock();
+	add_immBlock_pred(join, overflow);
+	add_immBlock_pred(join, no_overflow);
+	mature_immBlock(join);
+	set_cur_block(join);
+	ir_node *ins[] = { new_Const_long(mode_Is, 1), new_Const_long(mode_Is, 0) };
+	finish_function(new_Phi(2, ins, mode_Is));
+	assert(count_conds() == 1);
+
+	opt_vrp(irg);
+	return count_conds();
+}
+
+static void test_overflow_check(void)
+{
+	/* x + 1 cannot overflow for x in [0, 255] */
+	assert(optimize_overflow_check("small", 0xFF) == 0);
+	/* but it can for any positive x */
+	assert(optimize_overflow_check("positive", 0x7FFFFFFF) == 1);
+}
+
+/** Computes the ranges of a loop and returns the range of its counter. */
+static vrp_attr compute_counter_range(char const *name, long step,
+                                      ir_node *(*test)(ir_node*, ir_node*))
+{
+	new_function(name, mode_Is);
+	ir_node *bound = test == less ? new_Const_long(mode_Is, 100)
+	                              : param(mode_Is);
+	ir_node *i = build_loop(mode_Is, 0, step, test, bound, false);
+	finish_function(bound);
+
+	set_vrp_data(irg);
+	vrp_attr const range = *vrp_get_info(i);
+	free_vrp_data(irg);
+	return range;
+}
+
+static void test_widening(void)
+{
+	/* The loop test bounds the counter after widening. */
+	vrp_attr range = compute_counter_range("bounded", 1, less);
+	assert(range.range_type == VRP_RANGE);
+	assert(get_tarval_long(range.range_bottom) == 0);
+	assert(get_tarval_long(range.range_top) == 100);
+
+	/* A counter stepping over its bound may wrap around, its range covers
+	 * the whole mode. */
+	range = compute_counter_range("unbounded", 3, not_equal);
+	assert(range.range_type == VRP_VARYING);
+}
+
+int main(void)
+{
+	ir_init();
+	int_type = new_type_primitive(mode_Is);
+	global   = new_global_entity(get_glob_type(), new_id_from_str("global"),
+	                             int_type, ir_visibility_external,
+	                             IR_LINKAGE_DEFAULT);
+
+	test_iv_check();
+	test_overflow_check();
+	test_widening();
+	return 0;
+}
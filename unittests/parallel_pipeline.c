@@ -0,0 +1,102 @@
+/*
+ * Runs the parallel pipeline with several threads on more than one graph:
+ * every graph must pass every graph optimization exactly once, and a program
+ * optimization between two stages must see all graphs done with the first.
+ */
+#include "firm.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/** Number of graphs, more than threads. */
+#define N_GRAPHS  12
+#define N_THREADS 4
+
+typedef struct graph_runs_t {
+	unsigned first;
+	unsigned second;
+} graph_runs_t;
+
+static graph_runs_t runs[N_GRAPHS];
+static ir_node     *results[N_GRAPHS];
+
+/*
+ * int f<k>(int x) { return (x + 1) * 1 + ... + 0; }
+ * The graphs grow with k, so they are processed in a different order than
+ * they were created.
+ */
+static void build_function(int k)
+{
+	ir_type   *type = new_type_primitive(mode_Is);
+	ir_type   *mtp  = new_type_method(1, 1, false, cc_cdecl_set,
+	                                  mtp_no_property);
+	set_method_param_type(mtp, 0, type);
+	set_method_res_type(mtp, 0, type);
+	char name[16];
+	snprintf(name, sizeof(name), "f%d", k);
+	ir_entity *ent  = new_global_entity(get_glob_type(), new_id_from_str(name),
+	                                    mtp, ir_visibility_external,
+	                                    IR_LINKAGE_DEFAULT);
+	ir_graph  *irg  = new_ir_graph(ent, 0);
+	set_current_ir_graph(irg);
+	ir_node   *res  = new_Proj(get_irg_args(irg), mode_Is, 0);
+	for (int i = 0; i <= k; ++i) {
+		res = new_Mul(res, new_Const_long(mode_Is, 1));
+		res = new_Add(res, new_Const_long(mode_Is, 0));
+	}
+	ir_node   *ret  = new_Return(get_store(), 1, &res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+	set_irg_link(irg, &runs[k]);
+	results[k] = ret;
+}
+
+static void count_first(ir_graph *irg)
+{
+	++((graph_runs_t*)get_irg_link(irg))->first;
+}
+
+static void count_second(ir_graph *irg)
+{
+	graph_runs_t *const graph_runs = (graph_runs_t*)get_irg_link(irg);
+	assert(graph_runs->first == 1);
+	++graph_runs->second;
+}
+
+static void check_first_stage(void *data)
+{
+	++*(unsigned*)data;
+	for (int k = 0; k < N_GRAPHS; ++k)
+		assert(runs[k].first == 1 && runs[k].second == 0);
+}
+
+int main(void)
+{
+	ir_init();
+	/* keep the computations for optimize_graph_df() */
+	set_optimize(0);
+	for (int k = 0; k < N_GRAPHS; ++k)
+		build_function(k);
+	set_optimize(1);
+
+	unsigned              prog_runs = 0;
+	ir_parallel_pipeline *pipeline  = new_parallel_pipeline();
+	parallel_pipeline_add_graph_opt(pipeline, count_first);
+	parallel_pipeline_add_graph_opt(pipeline, optimize_graph_df);
+	parallel_pipeline_add_prog_opt(pipeline, check_first_stage, &prog_runs);
+	parallel_pipeline_add_graph_opt(pipeline, count_second);
+	run_parallel_pipeline(pipeline, N_THREADS);
+	free_parallel_pipeline(pipeline);
+
+	assert(prog_runs == 1);
+	for (int k = 0; k < N_GRAPHS; ++k) {
+		assert(runs[k].first == 1 && runs[k].second == 1);
+		/* optimize_graph_df() removed the computations */
+		ir_graph *irg = get_irn_irg(results[k]);
+		ir_node  *res = get_Return_res(results[k], 0);
+		assert(is_Proj(res) && get_Proj_pred(res) == get_irg_args(irg));
+		assert(irg_verify(irg));
+	}
+	return 0;
+}
@@ -0,0 +1,74 @@
+/*
+ * Checks that the pipeline statistics count the assure calls which found an
+ * analysis valid: opt_bool() assures the dominance, which is still valid when
+ * it runs a second time.
+ */
+#include "firm.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/* int f(int x) { return x + 1; } */
+static void build_function(void)
+{
+	ir_type *type = new_type_primitive(mode_Is);
+	ir_type *mtp  = new_type_method(1, 1, false, cc_cdecl_set,
+	                                mtp_no_property);
+	set_method_param_type(mtp, 0, type);
+	set_method_res_type(mtp, 0, type);
+	ir_entity *ent = new_global_entity(get_glob_type(), new_id_from_str("f"),
+	                                   mtp, ir_visibility_external,
+	                                   IR_LINKAGE_DEFAULT);
+	ir_graph  *irg = new_ir_graph(ent, 0);
+	set_current_ir_graph(irg);
+	ir_node   *x   = new_Proj(get_irg_args(irg), mode_Is, 0);
+	ir_node   *res = new_Add(x, new_Const_long(mode_Is, 1));
+	ir_node   *ret = new_Return(get_store(), 1, &res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+}
+
+/**
+ * Returns the number in the column @p column (0 is the first after the name)
+ * of the statistics line starting with @p name, or -1 if there is none.
+ */
+static int find_count(FILE *stats, char const *name, int column)
+{
+	char line[256];
+	rewind(stats);
+	while (fgets(line, sizeof(line), stats) != NULL) {
+		char first[64];
+		int  counts[6];
+		int  n = sscanf(line, "%63s %d %d %d %d %d", first, &counts[0],
+		                &counts[1], &counts[2], &counts[3], &counts[4]);
+		if (n > column + 1 && strcmp(first, name) == 0)
+			return counts[column];
+	}
+	return -1;
+}
+
+int main(void)
+{
+	ir_init();
+	build_function();
+
+	ir_parallel_pipeline *pipeline = new_parallel_pipeline();
+	assert(parallel_pipeline_add_passes(pipeline, "bool,bool"));
+	run_parallel_pipeline(pipeline, 1);
+
+	FILE *stats = tmpfile();
+	assert(stats != NULL);
+	parallel_pipeline_print_statistics(pipeline, stats);
+	free_parallel_pipeline(pipeline);
+
+	/* runs, valid, computed, invalidated, avoided */
+	assert(find_count(stats, "total", 0) == 2);
+	assert(find_count(stats, "total", 4) > 0);
+	/* the analysis table lists the dominance */
+	assert(find_count(stats, "dominance", 0) > 0);
+	assert(find_count(stats, "loopinfo", 0) == -1);
+	fclose(stats);
+	return 0;
+}
@@ -0,0 +1,196 @@
+/*
+ * Checks the points-to sets of addresses loaded from memory and their use by
+ * get_alias_relation() and cgana(), with both solvers and as pipeline pass.
+ */
+#include "firm.h"
+#include "array.h"
+#include "irmemory_t.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+static ir_type   *int_type;
+static ir_type   *callee_type;
+static ir_entity *g1;
+static ir_entity *g2;
+static ir_node   *loaded_ptr;
+static ir_node   *loaded_fp;
+static ir_node   *call;
+
+static ir_entity *new_private_global(char const *name, ir_type *type)
+{
+	return new_global_entity(get_glob_type(), new_id_from_str(name), type,
+	                         ir_visibility_local, IR_LINKAGE_DEFAULT);
+}
+
+static ir_graph *new_function(char const *name, ir_type *type,
+                              ir_visibility visibility)
+{
+	ir_entity *ent = new_global_entity(get_glob_type(), new_id_from_str(name),
+	                                   type, visibility, IR_LINKAGE_DEFAULT);
+	ir_graph  *irg = new_ir_graph(ent, 0);
+	set_current_ir_graph(irg);
+	return irg;
+}
+
+static void finish_function(ir_graph *irg, int n_res, ir_node **res)
+{
+	ir_node *ret = new_Return(get_store(), n_res, res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+}
+
+static void store(ir_entity *slot, ir_node *value, ir_type *type)
+{
+	ir_node *st = new_Store(get_store(), new_Address(slot), value, type,
+	                        cons_none);
+	set_store(new_Proj(st, mode_M, pn_Store_M));
+}
+
+static ir_node *load(ir_entity *slot, ir_type *type)
+{
+	ir_node *ld = new_Load(get_store(), new_Address(slot), mode_P, type,
+	                       cons_none);
+	set_store(new_Proj(ld, mode_M, pn_Load_M));
+	return new_Proj(ld, mode_P, pn_Load_res);
+}
+
+/*
+ * static int g1, g2, *ptr;
+ * static int (*fp)(int);
+ * static int callee(int x) { return x; }
+ * static int other(int x) { return x; }
+ * void init(void) { ptr = &g1; fp = callee; }
+ * int use(int x) { int *q = ptr; return fp(x) + *q + g1 + g2; }
+ */
+static void build_program(void)
+{
+	int_type    = new_type_primitive(mode_Is);
+	callee_type = new_type_method(1, 1, false, cc_cdecl_set, mtp_no_property);
+	set_method_param_type(callee_type, 0, int_type);
+	set_method_res_type(callee_type, 0, int_type);
+	ir_type *ptr_type  = new_type_pointer(int_type);
+	ir_type *fptr_type = new_type_pointer(callee_type);
+
+	g1 = new_private_global("g1", int_type);
+	g2 = new_private_global("g2", int_type);
+	ir_entity *ptr = new_private_global("ptr", ptr_type);
+	ir_entity *fp  = new_private_global("fp", fptr_type);
+
+	ir_graph *callee_irg = new_function("callee", callee_type,
+	                                    ir_visibility_local);
+	ir_node  *x          = new_Proj(get_irg_args(callee_irg), mode_Is, 0);
+	finish_function(callee_irg, 1, &x);
+
+	ir_graph *other_irg = new_function("other", callee_type,
+	                                   ir_visibility_local);
+	x = new_Proj(get_irg_args(other_irg), mode_Is, 0);
+	finish_function(other_irg, 1, &x);
+
+	ir_type  *init_type = new_type_method(0, 0, false, cc_cdecl_set,
+	                                      mtp_no_property);
+	ir_graph *init_irg  = new_function("init", init_type,
+	                                   ir_visibility_external);
+	store(ptr, new_Address(g1), ptr_type);
+	store(fp, new_Address(get_irg_entity(callee_irg)), fptr_type);
+	finish_function(init_irg, 0, NULL);
+
+	ir_graph *use_irg = new_function("use", callee_type,
+	                                 ir_visibility_external);
+	x          = new_Proj(get_irg_args(use_irg), mode_Is, 0);
+	loaded_ptr = load(ptr, ptr_type);
+	loaded_fp  = load(fp, fptr_type);
+	call       = new_Call(get_store(), loaded_fp, 1, &x, callee_type);
+	set_store(new_Proj(call, mode_M, pn_Call_M));
+	ir_node *res = new_Proj(new_Proj(call, mode_T, pn_Call_T_result),
+	                        mode_Is, 0);
+	ir_node *ld  = new_Load(get_store(), loaded_ptr, mode_Is, int_type,
+	                        cons_none);
+	set_store(new_Proj(ld, mode_M, pn_Load_M));
+	res = new_Add(res, new_Proj(ld, mode_Is, pn_Load_res));
+	for (int i = 0; i < 2; ++i) {
+		ld  = new_Load(get_store(), new_Address(i == 0 ? g1 : g2), mode_Is,
+		               int_type, cons_none);
+		set_store(new_Proj(ld, mode_M, pn_Load_M));
+		res = new_Add(res, new_Proj(ld, mode_Is, pn_Load_res));
+	}
+	finish_function(use_irg, 1, &res);
+}
+
+/** Queries the alias relation of *q with @p global, whose address must have
+ * been used by the program to have a points-to set. */
+static ir_alias_relation alias_with(ir_entity *global)
+{
+	ir_graph *irg  = get_irn_irg(loaded_ptr);
+	ir_node  *addr = new_r_Address(irg, global);
+	return get_alias_relation(loaded_ptr, int_type, 4, addr, int_type, 4);
+}
+
+static void check_points_to(void)
+{
+	void const **objs = get_points_to_objects(loaded_ptr);
+	assert(objs != NULL && ARR_LEN(objs) == 1 && objs[0] == g1);
+	DEL_ARR_F(objs);
+
+	assert(alias_with(g2) == ir_no_alias);
+	assert(alias_with(g1) != ir_no_alias);
+
+	ir_entity **callees = get_points_to_callees(loaded_fp);
+	assert(callees != NULL && ARR_LEN(callees) == 1);
+	assert(get_entity_ident(callees[0]) == new_id_from_str("callee"));
+	DEL_ARR_F(callees);
+}
+
+static void check_no_points_to(void)
+{
+	assert(get_points_to_objects(loaded_ptr) == NULL);
+	assert(alias_with(g2) == ir_may_alias);
+}
+
+/** Returns true if cgana() resolves the indirect call to callee only. */
+static bool cgana_resolves_call(void)
+{
+	ir_entity **free_methods;
+	cgana(&free_methods);
+	free(free_methods);
+	bool const resolved = cg_get_call_n_callees(call) == 1
+	    && get_entity_ident(cg_get_call_callee(call, 0))
+	       == new_id_from_str("callee");
+	free_irp_callee_info();
+	return resolved;
+}
+
+int main(void)
+{
+	ir_init();
+	build_program();
+
+	check_no_points_to();
+	assert(!cgana_resolves_call());
+
+	compute_irp_points_to(ir_points_to_andersen);
+	check_points_to();
+	assert(cgana_resolves_call());
+	free_irp_points_to();
+	check_no_points_to();
+
+	compute_irp_points_to(ir_points_to_steensgaard);
+	check_points_to();
+	free_irp_points_to();
+
+	/* The result of the pipeline pass is used by the passes following it. */
+	ir_parallel_pipeline *pipeline = new_parallel_pipeline();
+	assert(parallel_pipeline_add_passes(pipeline, "points_to"));
+	run_parallel_pipeline(pipeline, 1);
+	free_parallel_pipeline(pipeline);
+	check_points_to();
+
+	pipeline = new_parallel_pipeline();
+	assert(parallel_pipeline_add_passes(pipeline, "free_points_to"));
+	run_parallel_pipeline(pipeline, 1);
+	free_parallel_pipeline(pipeline);
+	check_no_points_to();
+
+	return 0;
+}
@@ -0,0 +1,251 @@
+/*
+ * Compiles a function with be-postsched on x86_64 and runs it. The function
+ * keeps more values alive than there are registers, so spilling inserts
+ * reloads for the scheduler to move, and uses saturating increments, which
+ * read the flags of an addition, between other flag clobbering additions.
+ * A comparison for a branch is ready long before the jump, which reads its
+ * flags. The output must differ from the one without the scheduler, no
+ * instruction writing the flags may come between a flags reader and its
+ * writer, and the program must compute the right results. Running it is
+ * skipped if no C compiler is found.
+ */
+#include "firm.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Number of values loaded, more than the general purpose registers. */
+#define N_VALUES 20
+
+static ir_mode *mi;
+static ir_type *t_int;
+
+static ir_node *saturating_increment(ir_node *value)
+{
+	ir_type *mtp = new_type_method(1, 1, false, cc_cdecl_set,
+	                               mtp_no_property);
+	set_method_param_type(mtp, 0, t_int);
+	set_method_res_type(mtp, 0, t_int);
+	ir_node *in[] = { value };
+	ir_node *inc  = new_Builtin(get_store(), 1, in,
+	                            ir_bk_saturating_increment, mtp);
+	/* the backend does not support a memory result */
+	return new_Proj(inc, mi, pn_Builtin_max + 1);
+}
+
+/*
+ * unsigned f(unsigned a, unsigned const *p)
+ * {
+ *     unsigned v0 = p[0], ..., v19 = p[19];
+ *     unsigned s  = a;
+ *     s += inc(v0) * 3 ^ v19; ...; s += inc(v19) * 3 ^ v0;
+ *     return a < 3 ? s : s ^ 0x5555;
+ * }
+ * with inc(x) = x == UINT_MAX ? x : x + 1.
+ */
+static void build_function(void)
+{
+	ir_type *t_ptr = new_type_pointer(t_int);
+	ir_type *mtp   = new_type_method(2, 1, false, cc_cdecl_set,
+	                                 mtp_no_property);
+	set_method_param_type(mtp, 0, t_int);
+	set_method_param_type(mtp, 1, t_ptr);
+	set_method_res_type(mtp, 0, t_int);
+	ir_entity *f   = new_global_entity(get_glob_type(), new_id_from_str("f"),
+	                                   mtp, ir_visibility_external,
+	                                   IR_LINKAGE_DEFAULT);
+	ir_graph  *irg = new_ir_graph(f, 0);
+	set_current_ir_graph(irg);
+
+	ir_node *args = get_irg_args(irg);
+	ir_node *a    = new_Proj(args, mi, 0);
+	ir_node *p    = new_Proj(args, mode_P, 1);
+	ir_mode *mo   = get_reference_offset_mode(mode_P);
+	ir_node *v[N_VALUES];
+	for (int k = 0; k < N_VALUES; ++k) {
+		ir_node *addr = new_Add(p, new_Const_long(mo, k * 4));
+		ir_node *ld   = new_Load(get_store(), addr, mi, t_int, cons_none);
+		set_store(new_Proj(ld, mode_M, pn_Load_M));
+		v[k] = new_Proj(ld, mi, pn_Load_res);
+	}
+
+	ir_node *s = a;
+	for (int k = 0; k < N_VALUES; ++k) {
+		ir_node *inc = saturating_increment(v[k]);
+		ir_node *mul = new_Mul(inc, new_Const_long(mi, 3));
+		s = new_Add(s, new_Eor(mul, v[N_VALUES - 1 - k]));
+	}
+
+	/* the comparison is ready early, but the additions between it and the
+	 * jump clobber the flags */
+	ir_node *cond = new_Cond(new_Cmp(a, new_Const_long(mi, 3),
+	                                 ir_relation_less));
+	ir_node *end  = get_irg_end_block(irg);
+	for (unsigned pn = pn_Cond_false; pn <= pn_Cond_true; ++pn) {
+		ir_node *block = new_immBlock();
+		add_immBlock_pred(block, new_Proj(cond, mode_X, pn));
+		mature_immBlock(block);
+		set_cur_block(block);
+		ir_node *res = pn == pn_Cond_true ? s
+		             : new_Eor(s, new_Const_long(mi, 0x5555));
+		add_immBlock_pred(end, new_Return(get_store(), 1, &res));
+	}
+	mature_immBlock(end);
+	irg_finalize_cons(irg);
+	assert(irg_verify(irg));
+}
+
+static int emit(char const *postsched, char const *file)
+{
+	ir_init();
+	char option[32];
+	snprintf(option, sizeof(option), "postsched=%s", postsched);
+	if (!ir_target_set("x86_64-linux-gnu") || !ir_target_option(option))
+		return 1;
+	ir_target_init();
+	mi    = mode_Iu;
+	t_int = new_type_primitive(mi);
+
+	build_function();
+	be_lower_for_target();
+
+	FILE *out = fopen(file, "wb");
+	if (out == NULL)
+		return 1;
+	be_main(out, "postsched");
+	fclose(out);
+	ir_finish();
+	return 0;
+}
+
+/** Calls f() for several inputs and compares with the C version. */
+static char const driver[] =
+	"#include <stdio.h>\n"
+	"unsigned f(unsigned a, unsigned const *p);\n"
+	"static unsigned ref(unsigned a, unsigned const *p)\n"
+	"{\n"
+	"\tunsigned s = a;\n"
+	"\tfor (int k = 0; k < 20; ++k) {\n"
+	"\t\tunsigned inc = p[k] == 0xFFFFFFFFu ? p[k] : p[k] + 1;\n"
+	"\t\ts += (inc * 3) ^ p[19 - k];\n"
+	"\t}\n"
+	"\treturn a < 3 ? s : s ^ 0x5555;\n"
+	"}\n"
+	"int main(void)\n"
+	"{\n"
+	"\tunsigned p[20];\n"
+	"\tfor (unsigned a = 0; a < 7; ++a) {\n"
+	"\t\tfor (unsigned i = 0; i < 20; ++i)\n"
+	"\t\t\tp[i] = (i + a) % 3 == 0 ? 0xFFFFFFFFu : i * 7919 + a;\n"
+	"\t\tif (f(a, p) != ref(a, p)) {\n"
+	"\t\t\tprintf(\"wrong result for %u\\n\", a);\n"
+	"\t\t\treturn 1;\n"
+	"\t\t}\n"
+	"\t}\n"
+	"\treturn 0;\n"
+	"}\n";
+
+static char *read_file(char const *file)
+{
+	FILE *in = fopen(file, "rb");
+	assert(in != NULL);
+	fseek(in, 0, SEEK_END);
+	long size = ftell(in);
+	fseek(in, 0, SEEK_SET);
+	char *content = (char*)malloc(size + 1);
+	size_t n = fread(content, 1, size, in);
+	assert(n == (size_t)size);
+	content[size] = '\0';
+	fclose(in);
+	return content;
+}
+
+static bool starts_with(char const *text, char const *prefix)
+{
+	return strncmp(text, prefix, strlen(prefix)) == 0;
+}
+
+/** Returns whether the instruction @p insn writes the flags. */
+static bool writes_flags(char const *insn)
+{
+	static char const *const mnemonics[] = {
+		"add", "adc", "and", "cmp", "dec", "imul", "inc", "neg", "or",
+		"sar", "sbb", "shl", "shr", "sub", "test", "xor",
+	};
+	for (size_t i = 0; i < sizeof(mnemonics) / sizeof(mnemonics[0]); ++i) {
+		if (starts_with(insn, mnemonics[i]))
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Checks that the flags read by each sbb come from the increment of its
+ * register and the flags read by each conditional jump from a comparison:
+ * no other instruction writing the flags may be scheduled in between.
+ */
+static void check_flags(char *text)
+{
+	char const *writer = NULL;
+	for (char *line = strtok(text, "\n"); line != NULL;
+	     line = strtok(NULL, "\n")) {
+		if (line[0] != '\t') {
+			/* a label starts a new block */
+			writer = NULL;
+			continue;
+		}
+		char const *const insn = line + 1;
+		if (starts_with(insn, "sbbl\t$0, ")) {
+			char expected[32];
+			snprintf(expected, sizeof(expected), "addl $1, %.4s",
+			         insn + strlen("sbbl\t$0, "));
+			assert(writer != NULL && starts_with(writer, expected));
+		} else if (insn[0] == 'j' && !starts_with(insn, "jmp")) {
+			assert(writer != NULL && starts_with(writer, "cmp"));
+		}
+		if (writes_flags(insn))
+			writer = insn;
+	}
+}
+
+static void run(char const *command)
+{
+	if (system(command) != 0) {
+		fprintf(stderr, "failed: %s\n", command);
+		exit(1);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	if (argc == 3)
+		return emit(argv[1], argv[2]);
+
+	char command[1024];
+	snprintf(command, sizeof(command), "\"%s\" 0 postsched.off.s", argv[0]);
+	run(command);
+	snprintf(command, sizeof(command), "\"%s\" 1 postsched.s", argv[0]);
+	run(command);
+
+	/* the scheduler changed something */
+	char *off = read_file("postsched.off.s");
+	char *on  = read_file("postsched.s");
+	assert(strcmp(off, on) != 0);
+	check_flags(on);
+	free(off);
+	free(on);
+
+	if (system("cc --version > /dev/null 2>&1") != 0) {
+		printf("C compiler not found, skipped running\n");
+		return 0;
+	}
+	FILE *out = fopen("postsched_main.c", "wb");
+	assert(out != NULL);
+	fputs(driver, out);
+	fclose(out);
+	run("cc -std=c99 postsched_main.c postsched.s -o postsched_test");
+	run("./postsched_test");
+	return 0;
+}
@@ -0,0 +1,155 @@
+/*
+ * Checks the x86_64 machine model and compiles a loop with the latency
+ * scheduler. The loop header Phis are placed by the list scheduler without
+ * being issued, the register pressure estimate must account them. The body
+ * loads more values than half the registers, which makes the scheduler
+ * reduce the pressure. The output is assembled if binutils are found.
+ */
+#include "firm.h"
+#include "bearch.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Number of values loaded in the loop body. */
+#define N_LOADS 20
+
+static ir_mode *mi;
+static ir_type *t_int;
+
+static ir_op *find_op(char const *name)
+{
+	for (unsigned i = 0, n = ir_get_n_opcodes(); i < n; ++i) {
+		ir_op *const op = ir_get_opcode(i);
+		if (op != NULL && strcmp(get_op_name(op), name) == 0)
+			return op;
+	}
+	return NULL;
+}
+
+/** Returns the machine model of a dummy node with opcode @p name. */
+static arch_machine_info_t const *get_machine_info(char const *name)
+{
+	ir_op *const op = find_op(name);
+	assert(op != NULL);
+	ir_graph *const irg  = get_const_code_irg();
+	ir_node  *const node = new_ir_node(NULL, irg, get_irg_start_block(irg),
+	                                   op, mode_T, 0, NULL);
+	return arch_get_irn_machine_info(node);
+}
+
+static void test_machine_model(void)
+{
+	/* p0 only */
+	arch_machine_info_t const *div = get_machine_info("amd64_div");
+	assert(div->latency == 26 && div->throughput == 6 && div->units == 1U << 0);
+	/* p0, p1, p5, p6 */
+	arch_machine_info_t const *add = get_machine_info("amd64_add");
+	assert(add->latency == 1 && add->units == 0x63);
+	/* nodes without a model can go to any unit */
+	arch_machine_info_t const *phi = get_machine_info("Phi");
+	assert(phi->latency == 1 && phi->throughput == 1 && phi->units == 0);
+}
+
+static ir_node *load_global(char const *name)
+{
+	ir_entity *ent = new_global_entity(get_glob_type(), new_id_from_str(name),
+	                                   t_int, ir_visibility_external,
+	                                   IR_LINKAGE_DEFAULT);
+	ir_node   *ld  = new_Load(get_store(), new_Address(ent), mi, t_int,
+	                          cons_none);
+	set_store(new_Proj(ld, mode_M, pn_Load_M));
+	return new_Proj(ld, mi, pn_Load_res);
+}
+
+/*
+ * int f(int n)
+ * {
+ *     int s = 0;
+ *     for (int i = 0; i != n; ++i)
+ *         s = s / (i + 1) + g0 * i + ... + g19 * i;
+ *     return s;
+ * }
+ */
+static void build_function(void)
+{
+	ir_type *mtp = new_type_method(1, 1, false, cc_cdecl_set,
+	                               mtp_no_property);
+	set_method_param_type(mtp, 0, t_int);
+	set_method_res_type(mtp, 0, t_int);
+	ir_entity *f   = new_global_entity(get_glob_type(), new_id_from_str("f"),
+	                                   mtp, ir_visibility_external,
+	                                   IR_LINKAGE_DEFAULT);
+	ir_graph  *irg = new_ir_graph(f, 2);
+	set_current_ir_graph(irg);
+	ir_node   *n   = new_Proj(get_irg_args(irg), mi, 0);
+
+	set_value(0, new_Const_long(mi, 0));
+	set_value(1, new_Const_long(mi, 0));
+	ir_node *header = new_immBlock();
+	add_immBlock_pred(header, new_Jmp());
+	set_cur_block(header);
+	ir_node *cond = new_Cond(new_Cmp(get_value(1, mi), n,
+	                                 ir_relation_less_greater));
+
+	ir_node *body = new_immBlock();
+	add_immBlock_pred(body, new_Proj(cond, mode_X, pn_Cond_true));
+	mature_immBlock(body);
+	set_cur_block(body);
+	ir_node *i    = get_value(1, mi);
+	ir_node *next = new_Add(i, new_Const_long(mi, 1));
+	ir_node *div  = new_Div(get_store(), get_value(0, mi), next, false);
+	set_store(new_Proj(div, mode_M, pn_Div_M));
+	ir_node *sum  = new_Proj(div, mi, pn_Div_res);
+	for (int k = 0; k < N_LOADS; ++k) {
+		char name[16];
+		snprintf(name, sizeof(name), "g%d", k);
+		sum = new_Add(sum, new_Mul(load_global(name), i));
+	}
+	set_value(0, sum);
+	set_value(1, next);
+	add_immBlock_pred(header, new_Jmp());
+	mature_immBlock(header);
+
+	ir_node *exit = new_immBlock();
+	add_immBlock_pred(exit, new_Proj(cond, mode_X, pn_Cond_false));
+	mature_immBlock(exit);
+	set_cur_block(exit);
+	ir_node *res = get_value(0, mi);
+	ir_node *ret = new_Return(get_store(), 1, &res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+	assert(irg_verify(irg));
+}
+
+int main(void)
+{
+	ir_init();
+	if (!ir_target_set("x86_64-linux-gnu")
+	    || !ir_target_option("scheduler=latency"))
+		return 1;
+	ir_target_init();
+	mi    = mode_Is;
+	t_int = new_type_primitive(mi);
+
+	test_machine_model();
+	build_function();
+	be_lower_for_target();
+
+	FILE *out = fopen("sched_latency.s", "wb");
+	if (out == NULL)
+		return 1;
+	be_main(out, "sched_latency");
+	fclose(out);
+	ir_finish();
+
+	if (system("as --64 --version > /dev/null 2>&1") != 0) {
+		printf("binutils not found, skipped assembling\n");
+		return 0;
+	}
+	if (system("as --64 sched_latency.s -o sched_latency.o") != 0)
+		return 1;
+	return 0;
+}